@@ -332,6 +332,12 @@ namespace eutelescope
      */
     static const char * FIXEDWEIGHT;
 
+    //! Exponentially weighted pedestal and noise tracking
+    /*! The name for the pedestal and noise tracking algorithm. @see
+     *  EUTelUpdatePedestalNoiseProcessor
+     */
+    static const char * EXPONENTIALWEIGHT;
+
     //! Cluster separation algorithm with only flagging capability
     /*! The name for the cluster separation algorithm that is not
      *  really dividing merging clusters, but only flagging their
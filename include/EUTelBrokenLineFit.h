@@ -0,0 +1,91 @@
+/*
+ *   This source code is part of the Eutelescope package of Marlin.
+ *   You are free to use this source files for your own development as
+ *   long as it stays in a public research context. You are not
+ *   allowed to use it for commercial purpose. You must put this
+ *   header with author names in all development based on this file.
+ *
+ */
+#ifndef EUTELBROKENLINEFIT_H
+#define EUTELBROKENLINEFIT_H
+
+// system includes <>
+#include <vector>
+
+namespace eutelescope {
+
+  //! Track fit without magnetic field, with multiple scattering
+  /*! The fitted track positions on all planes are the parameters, the
+   *  \f$ \chi^{2} \f$ sums the measurements and the kinks of the track
+   *  at every inner plane, weighted with the scattering angle, as in
+   *  EUTelTestFitter. Optionally the first segment is constrained to
+   *  the beam slope. X and Y are independent fits.
+   *
+   *  The matrix of the fit is band diagonal with two bands. It is
+   *  eliminated plane after plane, and the state of the elimination
+   *  after every plane is kept: when only the measurements from some
+   *  plane on change, as for consecutive hit selections of the track
+   *  search, the fit restarts from that plane. The minimum
+   *  \f$ \chi^{2} \f$ follows from the elimination, the fitted
+   *  positions and their errors are only calculated on request.
+   */
+  class EUTelBrokenLineFit {
+
+  public:
+    EUTelBrokenLineFit();
+
+    //! Define the planes, clears all measurements
+    /*! @param nPlanes Number of planes, ordered along the beam
+     *  @param planeDist Inverse distance to the next plane, nPlanes-1 values
+     *  @param planeScat Inverse variance of the scattering angle on every plane,
+     *         on the first plane the one of the beam constraint
+     *  @param useBeamConstraint Constrain the first segment to the beam slopes
+     */
+    void setPlanes(int nPlanes, const double * planeDist, const double * planeScat,
+                   bool useBeamConstraint, double beamSlopeX, double beamSlopeY);
+
+    //! Set the measurement of a plane, an error <= 0 means no measurement
+    void setMeasurement(int plane, double x, double ex, double y, double ey);
+
+    //! Minimum \f$ \chi^{2} \f$ of the fit, -1 if the fit is singular
+    double getChi2();
+
+    //! Fitted positions and their errors on every plane, after getChi2() succeeded
+    void getFit(double * x, double * ex, double * y, double * ey) const;
+
+  private:
+    //! Measurements and elimination of one projection
+    struct Projection {
+      std::vector<double> weight;
+      std::vector<double> position;
+      //! Hit independent part of the right hand side and the chi2, the beam slope
+      std::vector<double> beamRhs;
+      double beamChi2;
+      //! Eliminated rows: pivot, first off diagonal element, right hand side
+      std::vector<double> pivot;
+      std::vector<double> upper;
+      std::vector<double> rhs;
+      //! Changes to the next two rows and the chi2 after eliminating a plane, 6 per plane
+      std::vector<double> carry;
+    };
+
+    void resize(Projection & projection);
+    bool eliminate(Projection & projection, int plane);
+    void solve(const Projection & projection, double * pos, double * err) const;
+
+    int _nPlanes;
+
+    //! Hit independent band of the fit matrix: diagonal and the two upper diagonals
+    std::vector<double> _diagonal;
+    std::vector<double> _upper1;
+    std::vector<double> _upper2;
+
+    Projection _x;
+    Projection _y;
+
+    //! Elimination is valid up to this plane
+    int _firstChanged;
+  };
+
+}
+#endif
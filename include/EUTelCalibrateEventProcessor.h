@@ -25,6 +25,7 @@
 // system includes <>
 #include <string>
 #include <map>
+#include <vector>
 
 namespace eutelescope {
 
@@ -58,6 +59,12 @@ namespace eutelescope {
    *  considered as the input collection for the cluster search
    *  processor
    *
+   *  \li Optionally, the calibrated pixels are zero suppressed in the
+   *  same pass, as done by EUTelRawDataSparsifier but after the common
+   *  mode correction, and stored as EUTelGenericSparsePixel. The full
+   *  frame output can then be switched off, saving the intermediate
+   *  float frame and most of the LCIO output volume of NZS runs.
+   *
    *  <h4>Input collections</h4>
    *  <br><b>RawDataCollection</b>. This is a collection of
    *  TrackerRawData containing all pixel signals as they are readout
@@ -88,6 +95,10 @@ namespace eutelescope {
    *  this output collection via the steering parameter
    *  DataCollectionName
    *
+   *  <br><b>SparsifiedDataCollection</b>. Only if its name is not
+   *  empty: a collection of TrackerData with the calibrated pixels of
+   *  each sensor exceeding the sigma cut times their noise.
+   *
    *  @param RawDataCollectionName Name of the input raw data collection
    *
    *  @param PedestalCollectionName Name of the input (condition)
@@ -119,6 +130,17 @@ namespace eutelescope {
    *  @param HistoInfoFileName The name of the XML containing the
    *  histogram information file.
    *
+   *  @param SparsifiedDataCollectionName The name of the output zero
+   *  suppressed collection, empty (default) to switch the zero
+   *  suppression off
+   *
+   *  @param SigmaCut One multiplicative factor of the noise per
+   *  plane for the zero suppression threshold, as in
+   *  EUTelRawDataSparsifier
+   *
+   *  @param WriteCalibratedData Set to false to write only the zero
+   *  suppressed collection
+   *
    *  @author Antonio Bulgheroni, INFN <mailto:antonio.bulgheroni@gmail.com>
    *  @version $Id$
    *
@@ -322,6 +344,24 @@ namespace eutelescope {
      */
     std::string _histoInfoFileName;
 
+    //! Sparsified data collection name.
+    /*! The name of the output zero suppressed data collection. If
+     *  empty, no zero suppression is done.
+     */
+    std::string _sparsifiedDataCollectionName;
+
+    //! Sigma cut vector
+    /*! One component per plane, it is used for the zero suppression
+     *  threshold.
+     */
+    std::vector<float > _sigmaCutVec;
+
+    //! Write the full frame calibrated data
+    /*! If false and the zero suppression is on, only the zero
+     *  suppressed collection is added to the event.
+     */
+    bool _writeCalibratedData;
+
   private:
 
     //! First pixel along X
@@ -348,6 +388,15 @@ namespace eutelescope {
      */
     IntVec _maxY;
 
+    //! Position of the pixels selected by the zero suppression
+    /*! Together with _selectedSignal, kept as a data member to avoid
+     *  an allocation for each detector and event.
+     */
+    std::vector< unsigned int > _selectedPixel;
+
+    //! Calibrated signal of the pixels selected by the zero suppression
+    FloatVec _selectedSignal;
+
     //! Maximum number of consecutive missing events
     /*! This processor only applies to RAW data input collections, but
      *  not to break the generality, it will be active also in the
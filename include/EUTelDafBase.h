@@ -113,6 +113,9 @@ namespace eutelescope {
      */
     float _chi2cutoff;
     float _nXdz, _nYdz, _nXdzMaxDeviance, _nYdzMaxDeviance;
+    //! Run the CKF track finder as a beam search, and the number of branches it keeps per plane
+    bool _ckfBeamSearch;
+    int _ckfBeamWidth;
     int _nDutHits;
    
     float _nSkipMax;
@@ -0,0 +1,198 @@
+#include "EUTelDafTrackerSystem.h"
+#include <Eigen/Core>
+#include <float.h>
+#include <cmath>
+
+using namespace daffitter;
+
+// Batched information filter. Every method is the EigenFitter method of the same name with
+// a loop over the lanes, written out for the non zero elements and with the same order of
+// operations, so each lane gives the result of the EigenFitter for its candidate.
+
+template <typename T, size_t L>
+void BatchEstimate<T,L>::makeSeedInfo(){
+  // Make a seed for all lanes, zero information
+  for(size_t l = 0; l < L; l++){
+    p0[l] = p1[l] = p2[l] = p3[l] = 0;
+    c00[l] = c11[l] = c22[l] = c33[l] = c02[l] = c13[l] = 0;
+  }
+}
+
+template <typename T, size_t L>
+inline void BatchEstimate<T,L>::assign(const BatchEstimate<T,L>& e, const bool* mask){
+  // Masked copy, lanes that are not fitted keep their estimates
+  for(size_t l = 0; l < L; l++){
+    if(not mask[l]) { continue; }
+    p0[l] = e.p0[l]; p1[l] = e.p1[l]; p2[l] = e.p2[l]; p3[l] = e.p3[l];
+    c00[l] = e.c00[l]; c11[l] = e.c11[l]; c22[l] = e.c22[l]; c33[l] = e.c33[l];
+    c02[l] = e.c02[l]; c13[l] = e.c13[l];
+  }
+}
+
+template <typename T, size_t L>
+template <size_t N>
+void BatchEstimate<T,L>::get(size_t lane, TrackEstimate<T,N>& e) const {
+  // Fill a full estimate from one lane
+  e.params.setZero();
+  e.cov.setZero();
+  e.params(0) = p0[lane]; e.params(1) = p1[lane];
+  e.params(2) = p2[lane]; e.params(3) = p3[lane];
+  e.cov(0,0) = c00[lane]; e.cov(1,1) = c11[lane];
+  e.cov(2,2) = c22[lane]; e.cov(3,3) = c33[lane];
+  e.cov(0,2) = e.cov(2,0) = c02[lane];
+  e.cov(1,3) = e.cov(3,1) = c13[lane];
+}
+
+template <typename T, size_t L>
+void BatchFitter<T,L>::init(size_t nPlanes){
+  //Resize storage per plane
+  forward.resize(nPlanes);
+  backward.resize(nPlanes);
+  smoothed.resize(nPlanes);
+  weights.resize(nPlanes);
+  totWeight.resize(nPlanes * L);
+  measZ.resize(nPlanes * L);
+}
+
+template <typename T, size_t L>
+void BatchFitter<T,L>::calculatePlaneWeight(const FitPlane<T>& pl, size_t plane, T tval, T chi2cutoff, const bool* mask){
+  //Calculate measurement weights based on residuals to the smoothed estimates
+  const size_t nMeas = pl.meas.size();
+  const BatchEstimate<T,L>& e = smoothed[plane];
+  std::vector<T>& w = weights[plane];
+  w.resize(nMeas * L);
+  const T varX = pl.getSigmaX() * pl.getSigmaX();
+  const T varY = pl.getSigmaY() * pl.getSigmaY();
+  //Get the value exp( -chi2 / 2t) for each measurement
+  for(size_t m = 0; m < nMeas; m++){
+    const T x = pl.meas[m].getX();
+    const T y = pl.meas[m].getY();
+    T* wm = &w[m * L];
+    for(size_t l = 0; l < L; l++){
+      if(not mask[l]) { continue; }
+      T rx = e.p0[l] - x;
+      T ry = e.p1[l] - y;
+      T chi2 = rx * rx / (varX + e.c00[l]) + ry * ry / (varY + e.c11[l]);
+      wm[l] = exp( -1 * chi2 / (2 * tval));
+    }
+  }
+  //Normalize with the Eigen sums of EigenFitter, their order of additions differs from a plain loop
+  T cutWeight = exp( -1 * chi2cutoff / (2 * tval));
+  laneWeights.resize(nMeas);
+  for(size_t l = 0; l < L; l++){
+    if(not mask[l]) { continue; }
+    for(size_t m = 0; m < nMeas; m++){ laneWeights(m) = w[m * L + l]; }
+    if(nMeas > 0) { laneWeights /= (cutWeight + laneWeights.sum() + FLT_MIN); }
+    for(size_t m = 0; m < nMeas; m++){ w[m * L + l] = laneWeights(m); }
+    totWeight[plane * L + l] = laneWeights.sum();
+  }
+}
+
+template <typename T, size_t L>
+inline void BatchFitter<T,L>::predictInfo(size_t prev, size_t cur, BatchEstimate<T,L>& e){
+  //New weight matrix is inv(F)' inv(C) inv(F), see EigenFitter::predictInfo
+  const T* zPrev = &measZ[prev * L];
+  const T* zCur = &measZ[cur * L];
+  for(size_t l = 0; l < L; l++){
+    T dz = zPrev[l] - zCur[l];
+    T c02 = e.c02[l];
+    T c13 = e.c13[l];
+    e.c02[l] += dz * e.c00[l];
+    e.c13[l] += dz * e.c11[l];
+    e.c22[l] += dz * c02 + dz * e.c02[l];
+    e.c33[l] += dz * c13 + dz * e.c13[l];
+    e.p2[l] += dz * e.p0[l];
+    e.p3[l] += dz * e.p1[l];
+  }
+}
+
+template <typename T, size_t L>
+inline void BatchFitter<T,L>::addScatteringInfo(const FitPlane<T>& pl, BatchEstimate<T,L>& e){
+  //Add scattering to weight matrix using Woodbury matrix identity, see EigenFitter::addScatteringInfo
+  const T invScatter = 1.0f / pl.getScatterThetaSqr();
+  for(size_t l = 0; l < L; l++){
+    T scattervar2 = 1.0f/(e.c22[l] + invScatter);
+    T scattervar3 = 1.0f/(e.c33[l] + invScatter);
+    T c20 = e.c02[l];
+    T c31 = e.c13[l];
+    T c22 = e.c22[l];
+    T c33 = e.c33[l];
+    e.c00[l] -= c20 * c20 * scattervar2;
+    e.c02[l] -= c22 * c20 * scattervar2;
+    e.c11[l] -= c31 * c31 * scattervar3;
+    e.c13[l] -= c31 * c33 * scattervar3;
+    e.c22[l] -= c22 * c22 * scattervar2;
+    e.c33[l] -= c33 * c33 * scattervar3;
+
+    T p2 = e.p2[l];
+    T p3 = e.p3[l];
+    e.p0[l] -= scattervar2 * c20 * p2;
+    e.p1[l] -= scattervar3 * c31 * p3;
+    e.p2[l] -= scattervar2 * c22 * p2;
+    e.p3[l] -= scattervar3 * c33 * p3;
+  }
+}
+
+template <typename T, size_t L>
+inline void BatchFitter<T,L>::updateInfoDaf(const FitPlane<T>& pl, size_t plane, BatchEstimate<T,L>& e){
+  //Read the weighted measurements into the information filter
+  if(pl.isExcluded()) { return;}
+  const T invVarX = pl.invMeasVar(0);
+  const T invVarY = pl.invMeasVar(1);
+  const T* tot = &totWeight[plane * L];
+  for(size_t l = 0; l < L; l++){
+    e.c00[l] += invVarX * tot[l];
+    e.c11[l] += invVarY * tot[l];
+  }
+  const std::vector<T>& w = weights[plane];
+  for(size_t m = 0; m < pl.meas.size(); m++){
+    const T x = pl.meas[m].getX() * invVarX;
+    const T y = pl.meas[m].getY() * invVarY;
+    const T* wm = &w[m * L];
+    for(size_t l = 0; l < L; l++){
+      e.p0[l] += wm[l] * x;
+      e.p1[l] += wm[l] * y;
+    }
+  }
+}
+
+template <typename T, size_t L>
+inline void BatchFitter<T,L>::getAvgInfo(const BatchEstimate<T,L>& e1, const BatchEstimate<T,L>& e2, BatchEstimate<T,L>& result, const bool* mask){
+  //Get the weighted average of two estimates, see EigenFitter::getAvgInfo
+  for(size_t l = 0; l < L; l++){
+    if(not mask[l]) { continue; }
+    //Invert the x-dx/dz and y-dy/dz blocks
+    T a = e1.c00[l] + e2.c00[l], d = e1.c22[l] + e2.c22[l], b = e1.c02[l] + e2.c02[l];
+    T det = 1.0f / (a * d - b * b);
+    T c00 = det * d, c22 = det * a, c02 = det * -b;
+    a = e1.c11[l] + e2.c11[l]; d = e1.c33[l] + e2.c33[l]; b = e1.c13[l] + e2.c13[l];
+    det = 1.0f / (a * d - b * b);
+    T c11 = det * d, c33 = det * a, c13 = det * -b;
+
+    T x = e1.p0[l] + e2.p0[l], y = e1.p1[l] + e2.p1[l];
+    T dx = e1.p2[l] + e2.p2[l], dy = e1.p3[l] + e2.p3[l];
+    result.p0[l] = c00 * x + c02 * dx;
+    result.p1[l] = c11 * y + c13 * dy;
+    result.p2[l] = c02 * x + c22 * dx;
+    result.p3[l] = c13 * y + c33 * dy;
+    result.c00[l] = c00; result.c11[l] = c11; result.c22[l] = c22;
+    result.c33[l] = c33; result.c02[l] = c02; result.c13[l] = c13;
+  }
+}
+
+template <typename T, size_t L>
+void BatchFitter<T,L>::intersect(FitPlane<T>& pl, size_t plane, const bool* mask){
+  //Move the measurement z of each lane to the intersection of its smoothed track with the plane
+  const BatchEstimate<T,L>& e = smoothed[plane];
+  const Eigen::Matrix<T, 3, 1>& refPoint = pl.getRef0();
+  const Eigen::Matrix<T, 3, 1>& normVec = pl.getPlaneNorm();
+  T* z = &measZ[plane * L];
+  for(size_t l = 0; l < L; l++){
+    if(not mask[l]) { continue; }
+    T length = std::sqrt(e.p2[l] * e.p2[l] + e.p3[l] * e.p3[l] + 1.0f);
+    T dirX = e.p2[l] / length, dirY = e.p3[l] / length, dirZ = 1.0f / length;
+    T d = ( normVec(0) * (refPoint(0) - e.p0[l]) + normVec(1) * (refPoint(1) - e.p1[l]) + normVec(2) * (refPoint(2) - z[l]) )
+      / ( normVec(0) * dirX + normVec(1) * dirY + normVec(2) * dirZ );
+    z[l] += d * dirZ;
+  }
+}
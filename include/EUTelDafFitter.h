@@ -68,6 +68,8 @@ namespace eutelescope {
     void addToLCIO(daffitter::TrackCandidate<float,4>& track, LCCollectionVec *lcvec);
     //! LCIO switch
     bool _addToLCIO, _fitDuts;
+    //! Fit the candidates of an event together with the batched DAF
+    bool _batchedFit;
 
   };
   //! A global instance of the processor
@@ -2,8 +2,8 @@
 #define TRACKERSYSTEM_H
 
 #include <Eigen/Core>
-#include <list>
 #include <vector>
+#include <unordered_map>
 #include <cmath>
 #include <iostream>
 
@@ -58,6 +58,8 @@ namespace daffitter{
     //Results from fit
     T chi2, ndof;
     std::vector<TrackEstimate<T,N> > estimates;
+    //z of the track intersection with each plane, as the fit left it
+    std::vector<T> measZ;
     void print();
     void init(int nPlanes);
     TrackCandidate(int nPlanes);
@@ -183,6 +185,62 @@ namespace daffitter{
     void predictB(const FitPlane<T>  &prev, const FitPlane<T>  &cur, TrackEstimate<T,N>& e);
   };
 
+  //Number of track candidates fitted at once by BatchFitter, one SIMD register of floats
+#if defined(__AVX__)
+  const size_t batchLanes = 8;
+#else
+  const size_t batchLanes = 4;
+#endif
+
+  template <typename T, size_t L>
+  class BatchEstimate{
+  public:
+    //Information filter estimates of L candidates, one array per element. Only x-dx/dz and
+    //y-dy/dz are correlated, the other elements of the weight matrix stay zero.
+    T p0[L], p1[L], p2[L], p3[L];
+    T c00[L], c11[L], c22[L], c33[L], c02[L], c13[L];
+    void makeSeedInfo();
+    //Copy the lanes where mask is set
+    void assign(const BatchEstimate<T,L>& e, const bool* mask);
+    //Estimate of one lane
+    template <size_t N> void get(size_t lane, TrackEstimate<T,N>& e) const;
+  };
+
+  template <typename T, size_t L>
+  class BatchFitter{
+    //The EigenFitter information filter and DAF for L candidates sharing the planes.
+    //Everything is done in loops over the lanes, which the compiler maps to SIMD instructions.
+  public:
+    std::vector<BatchEstimate<T,L> > forward;
+    std::vector<BatchEstimate<T,L> > backward;
+    std::vector<BatchEstimate<T,L> > smoothed;
+    //DAF weights per plane, weights[plane][meas * L + lane]
+    std::vector< std::vector<T> > weights;
+    //Sum of the weights and z of the track intersection per plane, [plane * L + lane]
+    std::vector<T> totWeight;
+    std::vector<T> measZ;
+    //Weights of one lane on one plane
+    Eigen::Matrix<T, Eigen::Dynamic, 1> laneWeights;
+
+    void init(size_t nPlanes);
+    void calculatePlaneWeight(const FitPlane<T>& pl, size_t plane, T tval, T chi2cutoff, const bool* mask);
+    void predictInfo(size_t prev, size_t cur, BatchEstimate<T,L>& e);
+    void addScatteringInfo(const FitPlane<T>& pl, BatchEstimate<T,L>& e);
+    void updateInfoDaf(const FitPlane<T>& pl, size_t plane, BatchEstimate<T,L>& e);
+    void getAvgInfo(const BatchEstimate<T,L>& e1, const BatchEstimate<T,L>& e2, BatchEstimate<T,L>& result, const bool* mask);
+    void intersect(FitPlane<T>& pl, size_t plane, const bool* mask);
+  };
+
+  template <typename T, size_t N>
+  class CKFBranch{
+  public:
+    //Branch of the combinatorial KF beam search. Its hit indexes are kept in TrackerSystem::m_ckfIndexes.
+    TrackEstimate<T,N> est;
+    T chi2, score;
+    int nMeas;
+    size_t nSkipped;
+  };
+
   template <typename T, size_t N>
   class TrackerSystem{
     bool m_inited;
@@ -191,16 +249,56 @@ namespace daffitter{
     T m_nXdz, m_nYdz, m_nXdzdeviance, m_nYdzdeviance;
     T m_dafChi2, m_ckfChi2, m_chi2OverNdof, m_sqrClusterRadius;
     size_t m_skipMax;
+
+    //Cluster tracker buffers: hits projected to z = 0, grid cells of the size of the cluster radius
+    std::vector<PlaneHit<T> > m_clusterHits;
+    std::vector<char> m_clusterUsed;
+    std::vector<size_t> m_clusterMembers;
+    std::unordered_map<unsigned long long, std::vector<size_t> > m_clusterCells;
     
-    int addNeighbors(std::vector<PlaneHit<T> > &candidate, std::list<PlaneHit<T> > &hits);
+    unsigned long long clusterCell(long long cellX, long long cellY) const;
+    bool clusterCellIndex(const Eigen::Matrix<T, 2, 1>& xy, T cellSize, long long& cellX, long long& cellY) const;
+    void addNeighbors(size_t hit, T cellSize);
     T runTweight(T t, daffitter::TrackCandidate<T,N>& candidate);
     T fitPlanesInfoDafInner(daffitter::TrackCandidate<T,N>& candidate);
     T fitPlanesInfoDafBiased(daffitter::TrackCandidate<T,N>& candidate);
     size_t getMinClusterSize() const { return(m_minClusterSize); }
     void checkNan(TrackEstimate<T,N>& e);
-    //CKF
-    void finalizeCKFTrack(TrackEstimate<T,N>& est, std::vector<int>& indexes, int nMeas, T chi2);
+    //Depth first CKF
     void fitPermutation(int plane, TrackEstimate<T,N>& est, size_t nSkipped, std::vector<int> &indexes, int nMeas, T chi2);
+    //Beam search CKF: two layers, the current one and the next one. Each holds at most m_ckfBeamWidth
+    //branches with two or more measurements, as many with one, and the one without measurements.
+    bool m_ckfBeamSearch;
+    size_t m_ckfBeamWidth, m_ckfPruned, m_ckfHalfSize, m_ckfNextUsed;
+    void combinatorialKFBeam();
+    std::vector<CKFBranch<T,N> > m_ckfBranches;
+    std::vector<int> m_ckfIndexes;
+    std::vector<size_t> m_ckfLayer, m_ckfNextLayer, m_ckfNextSeeds;
+    //Hits of the current plane that passed the chi2 cut of a branch
+    std::vector<char> m_ckfHitUsed;
+    //Next layer bucketed by the hit taken on the current plane, and the slots found to be duplicates
+    std::vector<size_t> m_ckfHitStart, m_ckfByHit;
+    std::vector<char> m_ckfDuplicate;
+    //First hit of every plane in one list of all hits, and the hits of branches with three measurements
+    std::vector<size_t> m_ckfPlaneOffset;
+    std::vector<char> m_ckfHitTaken;
+    //Orders arena slots by score, the best first
+    class CKFBetter{
+    public:
+      const std::vector<CKFBranch<T,N> >* branches;
+      bool operator()(size_t a, size_t b) const {
+	const T sa = (*branches)[a].score, sb = (*branches)[b].score;
+	return( sa < sb or (sa == sb and a < b) );
+      }
+    };
+    size_t addCKFBranch(size_t half, T score, int nMeas, CKFBetter better);
+    void removeCKFDuplicates(size_t plane, CKFBetter better);
+    void expandCKFBranch(size_t parent, size_t plane, size_t half, CKFBetter better);
+    void finalizeCKFTrack(TrackEstimate<T,N>& est, const int* indexes, int nMeas, T chi2);
+    //Batched DAF
+    BatchFitter<T, batchLanes> m_batchFitter;
+    void fitBatchInfoDaf(size_t first, size_t nLanes);
+    void fitBatchInfoDafInner(const bool* mask, T* ndof);
     
   public: 
     EigenFitter<T,N> m_fitter;
@@ -237,6 +335,13 @@ namespace daffitter{
     void setMinClusterSize( size_t n) { m_minClusterSize = n; }
     void intersect();
     void setMaxSkippedHits(size_t n) { m_skipMax; }
+    //Use the beam search instead of the depth first CKF, the number of branches it keeps per plane,
+    //and the number of branches it dropped so far
+    void setCKFBeamSearch(bool beam) { m_ckfBeamSearch = beam; }
+    bool getCKFBeamSearch() const { return(m_ckfBeamSearch); }
+    void setCKFBeamWidth(size_t n) { m_ckfBeamWidth = n; }
+    size_t getCKFBeamWidth() const { return(m_ckfBeamWidth); }
+    size_t getCKFPrunedBranches() const { return(m_ckfPruned); }
 
     T getNominalXdz() const { return(m_nXdz); }
     T getNominalYdz() const { return(m_nYdz); }
@@ -253,6 +358,7 @@ namespace daffitter{
     void fitPlanesInfoBiased(daffitter::TrackCandidate<T,N>& candidate);
     void fitPlanesInfoUnBiased(daffitter::TrackCandidate<T,N>& candidate);
     void fitPlanesInfoDaf(daffitter::TrackCandidate<T,N>& candidate);
+    void fitPlanesInfoDafBatched();
     void fitPlanesKF(daffitter::TrackCandidate<T,N>& candidate);
     //partial fitters
     void fitInfoFWBiased(TrackCandidate<T,N>& candidate);
@@ -294,5 +400,6 @@ namespace daffitter{
 }
 #include <EUTelDafTrackerSystem.tcc>
 #include <EUTelDafEigenFitter.tcc>
+#include <EUTelDafBatchFitter.tcc>
 
 #endif
@@ -1,5 +1,6 @@
 #include <iostream>
 #include <algorithm>
+#include <cmath>
 #include <Eigen/Core>
 
 using namespace std;
@@ -71,6 +72,7 @@ void TrackCandidate<T,N>::init(int nPlanes){
   indexes.resize(nPlanes);
   weights.resize(nPlanes);
   estimates.resize(nPlanes);
+  measZ.resize(nPlanes);
 }
 
 template<typename T, size_t N>
@@ -144,7 +146,8 @@ void PlaneHit<T>::print() {
 
 template <typename T, size_t N>
 TrackerSystem<T, N>::TrackerSystem() : m_inited(false), m_maxCandidates(100), m_minClusterSize(3), m_nXdz(0.0f), m_nYdz(0.0),
-				       m_nXdzdeviance(0.01),m_nYdzdeviance(0.01), m_skipMax(2) {
+				       m_nXdzdeviance(0.01),m_nYdzdeviance(0.01), m_skipMax(2),
+				       m_ckfBeamSearch(false), m_ckfBeamWidth(256), m_ckfPruned(0), m_ckfHalfSize(0), m_ckfNextUsed(0) {
   //Constructor for the system of detector planes.
 }
 
@@ -155,7 +158,9 @@ TrackerSystem<T, N>::TrackerSystem(const TrackerSystem<T,N>& sys) : m_inited(fal
 								    m_nXdzdeviance(sys.m_nXdzdeviance), m_nYdzdeviance(sys.m_nYdzdeviance),
 								    m_dafChi2(sys.m_dafChi2), m_ckfChi2(sys.m_ckfChi2), 
 								    m_chi2OverNdof(sys.m_chi2OverNdof), m_sqrClusterRadius(sys.m_sqrClusterRadius),
-								    m_skipMax(sys.m_skipMax){
+								    m_skipMax(sys.m_skipMax), m_ckfBeamSearch(sys.m_ckfBeamSearch),
+								    m_ckfBeamWidth(sys.m_ckfBeamWidth), m_ckfPruned(0),
+								    m_ckfHalfSize(0), m_ckfNextUsed(0){
   //Copy constructor. Copy relevant info from sys, add planes and init.
   for(size_t ii = 0; ii < sys.planes.size(); ii++){
     //const FitPlane<T>& pl = sys.planes.at(ii);
@@ -220,6 +225,7 @@ void TrackerSystem<T, N>::init(bool quiet){
     }
   }
   m_fitter.init(planes.size());
+  m_batchFitter.init(planes.size());
   m_inited = true;
 }
 
@@ -255,20 +261,47 @@ inline bool clusterSort(PlaneHit<T>& a, PlaneHit<T>& b) {
 }
 
 template <typename T,size_t N>
-inline int TrackerSystem<T, N>::addNeighbors(vector<PlaneHit<T> > &candidate, list<PlaneHit<T> > &hits){
-  // Part of the cluster tracker. Checks distances to measurements, and adds measurement to cluster maybe.
-  int counter(0); //How many hits are added to the cluster this iteration?
-  for(typename list<PlaneHit<T> >::iterator hit = hits.begin(); hit != hits.end(); hit++ ){
-    for(typename vector<PlaneHit<T> >::iterator cand = candidate.begin(); cand != candidate.end(); cand++){
-      Eigen::Matrix<T, 2, 1> resids = (*hit).getM() - (*cand).getM();
-      if(resids.squaredNorm() > m_sqrClusterRadius ) { continue;}
-      candidate.push_back((*hit));
-      hit = hits.erase(hit);
-      counter ++;
-      break;
+inline unsigned long long TrackerSystem<T, N>::clusterCell(long long cellX, long long cellY) const {
+  // Part of the cluster tracker. Key of a grid cell, different cells sharing a key only cost time.
+  return( static_cast<unsigned long long>(cellX) * 0x9E3779B97F4A7C15ULL ^ static_cast<unsigned long long>(cellY) );
+}
+
+template <typename T,size_t N>
+inline bool TrackerSystem<T, N>::clusterCellIndex(const Eigen::Matrix<T, 2, 1>& xy, T cellSize, long long& cellX, long long& cellY) const {
+  // Part of the cluster tracker. Grid cell of a hit, false if the hit has no position.
+  if( not std::isfinite(xy(0)) or not std::isfinite(xy(1)) ) { return(false); }
+  cellX = static_cast<long long>( std::floor(xy(0) / cellSize) );
+  cellY = static_cast<long long>( std::floor(xy(1) / cellSize) );
+  return(true);
+}
+
+template <typename T,size_t N>
+inline void TrackerSystem<T, N>::addNeighbors(size_t hit, T cellSize){
+  // Part of the cluster tracker. Adds the free hits within the cluster radius of a hit to the cluster.
+  // The cells are not smaller than the radius, so only the surrounding cells are searched. Hits that
+  // are taken are removed from their cells.
+  const Eigen::Matrix<T, 2, 1>& xy = m_clusterHits[hit].getM();
+  long long cellX, cellY;
+  if( not clusterCellIndex(xy, cellSize, cellX, cellY) ) { return; }
+  for(long long dx = -1; dx <= 1; dx++){
+    for(long long dy = -1; dy <= 1; dy++){
+      typename unordered_map<unsigned long long, vector<size_t> >::iterator cell = m_clusterCells.find( clusterCell(cellX + dx, cellY + dy) );
+      if( cell == m_clusterCells.end() ) { continue; }
+      vector<size_t>& cellHits = cell->second;
+      size_t ii = 0;
+      while( ii < cellHits.size() ){
+	size_t other = cellHits[ii];
+	if( not m_clusterUsed[other] ){
+	  Eigen::Matrix<T, 2, 1> resids = m_clusterHits[other].getM() - xy;
+	  if(resids.squaredNorm() > m_sqrClusterRadius ) { ii++; continue; }
+	  m_clusterUsed[other] = 1;
+	  m_clusterMembers.push_back(other);
+	}
+	cellHits[ii] = cellHits.back();
+	cellHits.pop_back();
+      }
     }
   }
-  return (counter);
 }
 
 template <typename T,size_t N>
@@ -287,27 +320,42 @@ void TrackerSystem<T, N>::index0tracker(){
 template <typename T,size_t N>
 void TrackerSystem<T, N>::clusterTracker(){
   //A track fitter that propagates measurements into z = 0, then assumes measurement clusters are track candidates.
-  list<PlaneHit<T> > availableHits;
-  //Add all meas points to list
+  //A cluster holds all hits connected by steps shorter than the cluster radius, the hits are kept in a grid of
+  //cells as large as the radius to find the neighbours.
+  m_clusterHits.clear();
+  m_clusterCells.clear();
+  //Add all meas points to the grid
   for(size_t ii = 0; ii < planes.size(); ii++){
     if(planes.at(ii).isExcluded()) { continue;}
     T xShift = -1 * getNominalXdz() * planes.at(ii).getZpos();
     T yShift = -1 * getNominalYdz() * planes.at(ii).getZpos();
     for(size_t mm = 0; mm < planes.at(ii).meas.size(); mm++){
       PlaneHit<T> a(planes.at(ii).meas.at(mm).getX() + xShift, planes.at(ii).meas.at(mm).getY() + yShift, ii, mm);
-      availableHits.push_back( a );
+      m_clusterHits.push_back( a );
     }
   }
-  //Sort by radius from origin
-  //availableHits.sort(clusterSort<T>);
-  while( not availableHits.empty() ){
-    vector<PlaneHit<T> > candidate;
-    candidate.push_back( availableHits.front() );
-    availableHits.pop_front();
-    while( addNeighbors( candidate , availableHits ) > 0) {;}
+  T cellSize = std::sqrt(m_sqrClusterRadius);
+  //Any cell size works for a zero radius
+  if( not (cellSize > 0) ) { cellSize = 1; }
+  for(size_t hit = 0; hit < m_clusterHits.size(); hit++){
+    long long cellX, cellY;
+    if( not clusterCellIndex(m_clusterHits[hit].getM(), cellSize, cellX, cellY) ) { continue; }
+    m_clusterCells[ clusterCell(cellX, cellY) ].push_back(hit);
+  }
+  m_clusterUsed.assign(m_clusterHits.size(), 0);
+
+  //Clusters are started from the hits in the order they were added
+  for(size_t seed = 0; seed < m_clusterHits.size(); seed++){
+    if( m_clusterUsed[seed] ) { continue; }
+    m_clusterUsed[seed] = 1;
+    m_clusterMembers.clear();
+    m_clusterMembers.push_back(seed);
+    for(size_t member = 0; member < m_clusterMembers.size(); member++){
+      addNeighbors( m_clusterMembers[member], cellSize );
+    }
     //If we find enough hits, we make a candidate
 
-    if(candidate.size() < getMinClusterSize() ){ continue; }
+    if(m_clusterMembers.size() < getMinClusterSize() ){ continue; }
     if(m_nTracks >= m_maxCandidates) {
       std::cout << "Maximum number of track candidates(" << m_maxCandidates 
 		<< ") reached in DAF fitter! If this happens a lot, your configuration is probably off." 
@@ -325,8 +373,8 @@ void TrackerSystem<T, N>::clusterTracker(){
 	cnd.weights.at(ii).setZero();
       }
     }
-    for(size_t ii = 0; ii < candidate.size(); ii++){
-      PlaneHit<T>& hit = candidate.at(ii);
+    for(size_t ii = 0; ii < m_clusterMembers.size(); ii++){
+      PlaneHit<T>& hit = m_clusterHits.at( m_clusterMembers.at(ii) );
       cnd.weights.at( hit.getPlane() )( hit.getIndex()) = 1.0;
     }
     tracks.push_back(cnd);
@@ -620,6 +668,162 @@ void TrackerSystem<T, N>::fitPlanesInfoDaf(TrackCandidate<T, N>& candidate){
     candidate.ndof = ndof;
     candidate.chi2 = 0;
   }
+  for(int ii = 0; ii <(int)  planes.size() ; ii++ ){
+    candidate.measZ.at(ii) = planes.at(ii).getMeasZ();
+  }
+}
+
+template <typename T,size_t N>
+void TrackerSystem<T, N>::fitPlanesInfoDafBatched(){
+  // Run fitPlanesInfoDaf on all track candidates, batchLanes candidates at a time.
+  // Each candidate starts from the plane z positions left by the previous batch, not by the
+  // previous candidate. This only matters for planes that are not normal to the beam.
+  for(size_t first = 0; first < getNtracks(); first += batchLanes){
+    size_t nLanes = std::min(batchLanes, getNtracks() - first);
+    //A single candidate is faster alone, and gets the same result
+    if(nLanes == 1) { fitPlanesInfoDaf(tracks.at(first)); }
+    else { fitBatchInfoDaf(first, nLanes); }
+  }
+}
+
+template <typename T,size_t N>
+void TrackerSystem<T, N>::fitBatchInfoDaf(size_t first, size_t nLanes){
+  // fitPlanesInfoDaf for the candidates first to first + nLanes. Each step of the annealing
+  // is run for the lanes that would run it in fitPlanesInfoDaf, the others are masked.
+  const size_t L = batchLanes;
+  BatchFitter<T, batchLanes>& bf = m_batchFitter;
+  bool active[batchLanes], run[batchLanes];
+  T ndof[batchLanes], stepNdof[batchLanes];
+
+  //Load weights, unused lanes get a copy of the last candidate
+  for(size_t l = 0; l < L; l++){
+    active[l] = l < nLanes;
+    ndof[l] = -4.0f;
+  }
+  for(size_t plane = 0; plane < planes.size(); plane++){
+    const size_t nMeas = planes.at(plane).meas.size();
+    std::vector<T>& w = bf.weights.at(plane);
+    w.resize(nMeas * L);
+    for(size_t l = 0; l < L; l++){
+      const Eigen::Matrix<T, Eigen::Dynamic, 1>& cw = tracks.at(first + std::min(l, nLanes - 1)).weights.at(plane);
+      //set tot weight per plane
+      T totWeight = cw.size() > 0 ? cw.sum() : 0.0f;
+      T scale = totWeight > 1.0f ? 1.0f / totWeight : 1.0f;
+      for(size_t m = 0; m < nMeas; m++){
+	w[m * L + l] = m < (size_t) cw.size() ? cw(m) * scale : 0.0f;
+      }
+      if(totWeight > 1.0f){ totWeight = 1.0f; }
+      bf.totWeight[plane * L + l] = totWeight;
+      bf.measZ[plane * L + l] = planes.at(plane).getMeasZ();
+      ndof[l] += totWeight * 2.0;
+    }
+  }
+  fitBatchInfoDafInner(active, stepNdof);
+  for(size_t l = 0; l < L; l++){
+    if(isnan(ndof[l])) { ndof[l] = -10.0; }
+  }
+
+  // Running with fixed annealing schedule.
+  const T temperatures[] = { 25.0, 20.0, 14.0, 8.0, 4.0, 1.0 };
+  const T ndofCuts[] = { -1.0f, -1.0f, -1.9f, -1.9f, -1.9f, -1.9f };
+  for(size_t step = 0; step < 6; step++){
+    bool any = false;
+    for(size_t l = 0; l < L; l++){
+      run[l] = active[l] and ndof[l] > ndofCuts[step];
+      any = any or run[l];
+    }
+    if(not any) { continue; }
+    //runTweight
+    for(size_t plane = 0; plane < planes.size(); plane++){
+      bf.calculatePlaneWeight( planes.at(plane), plane, temperatures[step], getDAFChi2Cut(), run);
+    }
+    fitBatchInfoDafInner(run, stepNdof);
+    for(size_t plane = 0; plane < planes.size(); plane++){
+      bf.intersect( planes.at(plane), plane, run);
+    }
+    for(size_t l = 0; l < L; l++){
+      if(run[l]) { ndof[l] = stepNdof[l]; }
+    }
+  }
+
+  //Store estimates and weights in the candidates
+  for(size_t l = 0; l < nLanes; l++){
+    TrackCandidate<T,N>& candidate = tracks.at(first + l);
+    for(size_t plane = 0; plane < planes.size(); plane++){
+      const size_t nMeas = planes.at(plane).meas.size();
+      candidate.weights.at(plane).resize(nMeas);
+      for(size_t m = 0; m < nMeas; m++){
+	candidate.weights.at(plane)(m) = bf.weights.at(plane)[m * L + l];
+      }
+      candidate.measZ.at(plane) = bf.measZ[plane * L + l];
+    }
+    if(ndof[l] > -1.9f) {
+      for(size_t plane = 0; plane < planes.size(); plane++){
+	bf.smoothed.at(plane).get(l, candidate.estimates.at(plane));
+	bf.forward.at(plane).get(l, m_fitter.forward.at(plane));
+      }
+      getChi2UnBiasedInfoDaf(candidate);
+      weightToIndex(candidate);
+    } else{
+      candidate.ndof = ndof[l];
+      candidate.chi2 = 0;
+    }
+  }
+  //Leave the planes as the last candidate left them
+  for(size_t plane = 0; plane < planes.size(); plane++){
+    planes.at(plane).setMeasZ( bf.measZ[plane * L + nLanes - 1] );
+    planes.at(plane).setTotWeight( bf.totWeight[plane * L + nLanes - 1] );
+  }
+}
+
+template <typename T,size_t N>
+void TrackerSystem<T, N>::fitBatchInfoDafInner(const bool* mask, T* ndof){
+  // fitPlanesInfoDafInner for the lanes in mask
+  const size_t L = batchLanes;
+  BatchFitter<T, batchLanes>& bf = m_batchFitter;
+  size_t nPlanes = planes.size();
+  BatchEstimate<T, batchLanes> e;
+  e.makeSeedInfo();
+
+  //Forward fitter
+  bf.forward.at(0).assign(e, mask);
+  bf.updateInfoDaf( planes.at(0), 0, e);
+  for(size_t l = 0; l < L; l++){
+    ndof[l] = -1.0f * N;
+    ndof[l] += 2 * bf.totWeight[l];
+  }
+  for(size_t ii = 1; ii < nPlanes ; ii++ ){
+    if(not planes.at(ii).isExcluded()){
+      for(size_t l = 0; l < L; l++){ ndof[l] += 2 * bf.totWeight[ii * L + l]; }
+    }
+    bf.predictInfo( ii - 1, ii, e );
+    bf.forward.at(ii).assign(e, mask);
+    bf.updateInfoDaf( planes.at(ii), ii, e );
+    bf.addScatteringInfo( planes.at(ii), e);
+  }
+  //No reason to complete unless >1 measurements are in
+  bool smooth[batchLanes];
+  bool any = false;
+  for(size_t l = 0; l < L; l++){
+    smooth[l] = mask[l] and not (ndof[l] < -2.1);
+    any = any or smooth[l];
+  }
+  if(not any) { return; }
+
+  //Backward fitter, never bias
+  e.makeSeedInfo();
+  bf.backward.at( nPlanes -1 ).assign(e, smooth);
+  bf.updateInfoDaf( planes.at(nPlanes -1 ), nPlanes - 1, e);
+  for(int ii = nPlanes -2; ii >= 0; ii-- ){
+    bf.predictInfo( ii + 1, ii, e );
+    bf.addScatteringInfo( planes.at(ii), e);
+    bf.backward.at(ii).assign(e, smooth);
+    bf.updateInfoDaf( planes.at(ii), ii, e );
+  }
+
+  for(size_t ii = 0 ; ii < nPlanes; ii++){
+    bf.getAvgInfo( bf.forward.at(ii), bf.backward.at(ii), bf.smoothed.at(ii), smooth);
+  }
 }
 
 template <typename T,size_t N>
@@ -808,7 +1012,8 @@ void TrackerSystem<T, N>::fitPlanesKF(TrackCandidate<T, N>& candidate){
 //Combinatorial KF
 template <typename T,size_t N>
 void TrackerSystem<T, N>::combinatorialKF(){
-  // Combinatorial Kalman filter track finder.
+  // Combinatorial Kalman filter track finder. Depth first, unless the beam search is switched on.
+  if(m_ckfBeamSearch) { combinatorialKFBeam(); return; }
   vector<int> indexes(planes.size(), -1);
   TrackEstimate<T,N> e;
 
@@ -834,31 +1039,6 @@ void TrackerSystem<T, N>::combinatorialKF(){
   }
 }
 
-template <typename T,size_t N>
-void TrackerSystem<T, N>::finalizeCKFTrack(TrackEstimate<T, N>& est, vector<int>& indexes, int nMeas, T chi2){
-  //Check the fitted tracl for chi2/ndof
-  fastInvert(est.cov);
-  est.params = est.cov * est.params;
-  if(( fabs( est.getXdz() - getNominalXdz()) > getXdzMaxDeviance() ) or
-     ( fabs( est.getYdz() - getNominalYdz()) > getYdzMaxDeviance())){
-    return;
-  }
-  // Either reject the track, or save it
-  TrackCandidate<T,N> candidate(planes.size());
-
-  candidate.ndof = nMeas * 2 - 4;
-  candidate.chi2 = chi2;
-  if(candidate.chi2/candidate.ndof > getChi2OverNdofCut()) { return;}
-  
-  //Copy indexes, assign weights
-  for(int plane = 0; plane < (int) planes.size(); plane++){
-    candidate.indexes.at(plane) = indexes.at(plane);
-  }
-  indexToWeight( candidate );
-  tracks.push_back(candidate);
-  m_nTracks++;
-}
-
 template <typename T,size_t N>
 void TrackerSystem<T, N>::fitPermutation(int plane, TrackEstimate<T, N> &est, size_t nSkipped, vector<int> &indexes, int nMeas, T chi2){
   //Check a branch of the track tree. Either kill it or, let it live.
@@ -868,7 +1048,7 @@ void TrackerSystem<T, N>::fitPermutation(int plane, TrackEstimate<T, N> &est, si
   }
   //Last plane, save and quit
   if(plane == (int) planes.size()){
-    finalizeCKFTrack(est, indexes, nMeas, chi2);
+    finalizeCKFTrack(est, &indexes.at(0), nMeas, chi2);
     return;
   }
   //Propagate
@@ -941,3 +1121,305 @@ void TrackerSystem<T, N>::fitPermutation(int plane, TrackEstimate<T, N> &est, si
     fitPermutation(plane + 1, est, nSkipped + 1, indexes, nMeas, chi2);
   }
 }
+
+template <typename T,size_t N>
+void TrackerSystem<T, N>::combinatorialKFBeam(){
+  // Combinatorial Kalman filter track finder, a beam search. The branches are extended plane by
+  // plane, keeping the m_ckfBeamWidth branches with the lowest score on each plane. The score is
+  // the chi2, a skipped plane costs as much as a measurement at the chi2 cut. Branches with one
+  // measurement have no chi2 to be ranked by, up to m_ckfBeamWidth of them are kept next to the
+  // beam, as is the one branch without measurements. The arena for the branches is sized by the
+  // beam width alone, so time and memory per event are bounded by it whatever the occupancy.
+  const size_t nPlanes = planes.size();
+  if(nPlanes == 0 or m_ckfBeamWidth == 0) { return; }
+  m_ckfPlaneOffset.assign(nPlanes + 1, 0);
+  for(size_t plane = 0; plane < nPlanes; plane++) { m_ckfPlaneOffset.at(plane + 1) = m_ckfPlaneOffset.at(plane) + planes.at(plane).meas.size(); }
+  if(m_ckfHalfSize != 2 * m_ckfBeamWidth + 1 or m_ckfIndexes.size() != 2 * m_ckfHalfSize * nPlanes){
+    m_ckfHalfSize = 2 * m_ckfBeamWidth + 1;
+    m_ckfBranches.resize(2 * m_ckfHalfSize);
+    m_ckfDuplicate.resize(2 * m_ckfHalfSize);
+    m_ckfIndexes.resize(2 * m_ckfHalfSize * nPlanes);
+    m_ckfLayer.reserve(m_ckfHalfSize);
+    m_ckfNextLayer.reserve(m_ckfHalfSize);
+    m_ckfNextSeeds.reserve(m_ckfHalfSize);
+  }
+  CKFBetter better;
+  better.branches = &m_ckfBranches;
+
+  //Start from a single branch without measurements, the first hit of a branch is its seed
+  CKFBranch<T,N>& root = m_ckfBranches.at(0);
+  root.chi2 = root.score = 0.0f;
+  root.nMeas = 0;
+  root.nSkipped = 0;
+  std::fill(m_ckfIndexes.begin(), m_ckfIndexes.begin() + nPlanes, -1);
+  m_ckfLayer.assign(1, 0);
+
+  //Layers alternate between the two halves of the arena
+  for(size_t plane = 0; plane < nPlanes; plane++){
+    size_t half = ((plane + 1) % 2) * m_ckfHalfSize;
+    m_ckfNextLayer.clear();
+    m_ckfNextSeeds.clear();
+    m_ckfNextUsed = 0;
+    m_ckfHitUsed.assign(planes.at(plane).meas.size(), 0);
+    //The branch without measurements goes last, it only seeds from hits no other branch took
+    size_t unseeded = size_t(-1);
+    for(size_t ii = 0; ii < m_ckfLayer.size(); ii++){
+      if(m_ckfBranches.at(m_ckfLayer.at(ii)).nMeas == 0) { unseeded = m_ckfLayer.at(ii); continue; }
+      expandCKFBranch(m_ckfLayer.at(ii), plane, half, better);
+    }
+    if(unseeded != size_t(-1)) { expandCKFBranch(unseeded, plane, half, better); }
+    m_ckfNextLayer.insert(m_ckfNextLayer.end(), m_ckfNextSeeds.begin(), m_ckfNextSeeds.end());
+    removeCKFDuplicates(plane, better);
+    m_ckfLayer.swap(m_ckfNextLayer);
+  }
+
+  //Accept the best tracks first, drop tracks whose hits are all part of an accepted track
+  std::sort(m_ckfLayer.begin(), m_ckfLayer.end(), better);
+  size_t firstTrack = getNtracks();
+  for(size_t ii = 0; ii < m_ckfLayer.size(); ii++){
+    if(getNtracks() >= m_maxCandidates) { break; }
+    CKFBranch<T,N>& br = m_ckfBranches.at(m_ckfLayer.at(ii));
+    if(br.nMeas < 2) { continue; }
+    const int* indexes = &m_ckfIndexes.at(m_ckfLayer.at(ii) * nPlanes);
+    bool subset(false);
+    for(size_t track = firstTrack; track < getNtracks() and not subset; track++){
+      subset = true;
+      for(size_t pl = 0; pl < nPlanes; pl++){
+	if(indexes[pl] >= 0 and indexes[pl] != tracks.at(track).indexes.at(pl)) { subset = false; break; }
+      }
+    }
+    if(subset) { continue; }
+    finalizeCKFTrack(br.est, indexes, br.nMeas, br.chi2);
+  }
+}
+
+template <typename T,size_t N>
+size_t TrackerSystem<T, N>::addCKFBranch(size_t half, T score, int nMeas, CKFBetter better){
+  //Get the arena slot for a new branch of the next layer. If the beam is full the worst branch
+  //is replaced, or the new one is dropped if it is not better. Returns the slot or size_t(-1).
+  if(nMeas < 2){
+    //At most one branch without measurements, the seeds are capped at the beam width
+    if(nMeas == 1 and m_ckfNextSeeds.size() >= m_ckfBeamWidth){
+      m_ckfPruned++;
+      return(size_t(-1));
+    }
+    size_t slot = half + m_ckfNextUsed++;
+    m_ckfBranches.at(slot).score = score;
+    m_ckfNextSeeds.push_back(slot);
+    return(slot);
+  }
+  if(m_ckfNextLayer.size() < m_ckfBeamWidth){
+    size_t slot = half + m_ckfNextUsed++;
+    m_ckfBranches.at(slot).score = score;
+    m_ckfNextLayer.push_back(slot);
+    std::push_heap(m_ckfNextLayer.begin(), m_ckfNextLayer.end(), better);
+    return(slot);
+  }
+  m_ckfPruned++;
+  if( not (score < m_ckfBranches.at(m_ckfNextLayer.front()).score)) { return(size_t(-1)); }
+  //The heap has the worst branch in front
+  std::pop_heap(m_ckfNextLayer.begin(), m_ckfNextLayer.end(), better);
+  size_t slot = m_ckfNextLayer.back();
+  m_ckfBranches.at(slot).score = score;
+  std::push_heap(m_ckfNextLayer.begin(), m_ckfNextLayer.end(), better);
+  return(slot);
+}
+
+template <typename T,size_t N>
+void TrackerSystem<T, N>::removeCKFDuplicates(size_t plane, CKFBetter better){
+  //Drop branches of the next layer whose hits are all part of a better branch taking the same hit
+  //on this plane. The better branch needs three measurements, so that its other hits passed the
+  //chi2 cut. This removes the copies of a track seeded on later planes or skipping a plane. Also
+  //drop the branches with less than three measurements whose first hit is part of such a branch.
+  const size_t nPlanes = planes.size();
+  const size_t nHits = planes.at(plane).meas.size();
+  //Bucket the branches by hit
+  m_ckfHitStart.assign(nHits + 1, 0);
+  for(size_t ii = 0; ii < m_ckfNextLayer.size(); ii++){
+    int hit = m_ckfIndexes.at(m_ckfNextLayer.at(ii) * nPlanes + plane);
+    if(hit >= 0) { m_ckfHitStart.at(hit + 1)++; }
+  }
+  for(size_t hit = 0; hit < nHits; hit++){ m_ckfHitStart.at(hit + 1) += m_ckfHitStart.at(hit); }
+  m_ckfByHit.resize(m_ckfHitStart.at(nHits));
+  for(size_t ii = m_ckfNextLayer.size(); ii > 0; ii--){
+    size_t slot = m_ckfNextLayer.at(ii - 1);
+    int hit = m_ckfIndexes.at(slot * nPlanes + plane);
+    if(hit >= 0) { m_ckfByHit.at(--m_ckfHitStart.at(hit + 1) ) = slot; }
+  }
+  //After filling, bucket hit spans [m_ckfHitStart[hit + 1], m_ckfHitStart[hit + 2])
+  for(size_t hit = 0; hit < nHits; hit++){
+    size_t begin = m_ckfHitStart.at(hit + 1);
+    size_t end = (hit + 1 < nHits) ? m_ckfHitStart.at(hit + 2) : m_ckfByHit.size();
+    for(size_t ii = begin; ii < end; ii++){
+      const size_t slot = m_ckfByHit.at(ii);
+      const int* indexes = &m_ckfIndexes.at(slot * nPlanes);
+      bool duplicate(false);
+      for(size_t jj = begin; jj < end and not duplicate; jj++){
+	const size_t other = m_ckfByHit.at(jj);
+	if(other == slot or m_ckfBranches.at(other).nMeas < 3 or not better(other, slot)) { continue; }
+	const int* otherIndexes = &m_ckfIndexes.at(other * nPlanes);
+	duplicate = true;
+	for(size_t pl = 0; pl < plane; pl++){
+	  if(indexes[pl] >= 0 and indexes[pl] != otherIndexes[pl]) { duplicate = false; break; }
+	}
+      }
+      m_ckfDuplicate.at(slot) = duplicate;
+    }
+  }
+  //Hits taken by a branch with three or more measurements. As in the depth first search, a seed
+  //which leads to such a branch is not tried again skipping a plane or with another second hit,
+  //and a hit of such a branch does not seed a new one.
+  m_ckfHitTaken.assign(m_ckfPlaneOffset.back(), 0);
+  for(size_t ii = 0; ii < m_ckfNextLayer.size(); ii++){
+    const size_t slot = m_ckfNextLayer.at(ii);
+    if(m_ckfBranches.at(slot).nMeas < 3) { continue; }
+    const int* indexes = &m_ckfIndexes.at(slot * nPlanes);
+    for(size_t pl = 0; pl <= plane; pl++){
+      if(indexes[pl] >= 0) { m_ckfHitTaken.at(m_ckfPlaneOffset.at(pl) + indexes[pl]) = 1; }
+    }
+  }
+  //Remove the duplicates and the branches seeded by a taken hit
+  size_t nKept(0);
+  for(size_t ii = 0; ii < m_ckfNextLayer.size(); ii++){
+    const size_t slot = m_ckfNextLayer.at(ii);
+    if(m_ckfIndexes.at(slot * nPlanes + plane) >= 0 and m_ckfDuplicate.at(slot)) { continue; }
+    if(m_ckfBranches.at(slot).nMeas > 0 and m_ckfBranches.at(slot).nMeas < 3){
+      const int* indexes = &m_ckfIndexes.at(slot * nPlanes);
+      bool taken(false);
+      for(size_t pl = 0; pl <= plane; pl++){
+	if(indexes[pl] >= 0) { taken = m_ckfHitTaken.at(m_ckfPlaneOffset.at(pl) + indexes[pl]); break; }
+      }
+      if(taken) { continue; }
+    }
+    m_ckfNextLayer.at(nKept++) = slot;
+  }
+  m_ckfNextLayer.resize(nKept);
+}
+
+template <typename T,size_t N>
+void TrackerSystem<T, N>::expandCKFBranch(size_t parent, size_t plane, size_t half, CKFBetter better){
+  //Propagate a branch to the plane and offer one new branch per accepted measurement, and one
+  //skipping the plane, to the next layer.
+  const size_t nPlanes = planes.size();
+  CKFBranch<T,N>& br = m_ckfBranches.at(parent);
+  //Propagate
+  if(br.nMeas > 0){
+    if(br.nMeas > 1) { m_fitter.addScatteringInfo( planes.at(plane - 1), br.est);}
+    m_fitter.predictInfo(planes.at( plane - 1), planes.at(plane), br.est);
+  }
+
+  //Excluded plane, propagate without looking for measurement
+  if( planes.at(plane).isExcluded()){
+    size_t slot = addCKFBranch(half, br.score, br.nMeas, better);
+    if(slot == size_t(-1)) { return; }
+    m_ckfBranches.at(slot) = br;
+    std::copy(&m_ckfIndexes.at(parent * nPlanes), &m_ckfIndexes.at(parent * nPlanes) + nPlanes, &m_ckfIndexes.at(slot * nPlanes));
+    m_ckfIndexes.at(slot * nPlanes + plane) = -1;
+    return;
+  }
+
+  //Prepare for branch generation
+  const T skipScore = getCKFChi2Cut();
+  Eigen::Matrix<T,2,1> resv, errv;
+  Eigen::Matrix<T,4,1> state;
+  double oldX(0.0), oldY(0.0), oldZ(0.0);
+  size_t nAccepted(0);
+  //Get prediction explicitly if needed
+  if(br.nMeas > 1){
+    Eigen::Matrix<T, N, N> tmp4x4 = br.est.cov;
+    fastInvert(tmp4x4);
+    state = tmp4x4 * br.est.params;
+    errv = planes.at(plane).getSigmas().array().square() + tmp4x4.diagonal().head(2).array();
+  }
+  //If only one measurement has been read in. prepare for checking angles
+  if(br.nMeas == 1){
+    for(size_t ii = 0; ii < plane; ii++){
+      int index = m_ckfIndexes.at(parent * nPlanes + ii);
+      if( index >= 0){
+	oldX = planes.at(ii).meas.at(index).getX();
+	oldY = planes.at(ii).meas.at(index).getY();
+	oldZ = planes.at(ii).getZpos();
+	break;
+      }
+    }
+  }
+
+  for(int hit = 0; hit < (int)planes.at(plane).meas.size(); hit++){
+    Measurement<T>& mm = planes.at(plane).meas.at(hit);
+    bool filterMeas = false;
+    double chi2m = 0, angleScore = 0;
+    if( br.nMeas > 1) {
+      //If more than 1 measurements, get chi2
+      resv = (state.head(2) - mm.getM()).array().square();
+      chi2m = (resv.array() / errv.array()).sum();
+      if (chi2m <  getCKFChi2Cut() ) {
+	filterMeas = true;
+      }
+    } else if(br.nMeas == 1){
+      //Check angle of second plane
+      double newZ = planes.at(plane).getZpos();
+      double dx = ((mm.getX() - oldX)/(newZ - oldZ) - getNominalXdz()) / getXdzMaxDeviance();
+      double dy = ((mm.getY() - oldY)/(newZ - oldZ) - getNominalYdz()) / getYdzMaxDeviance();
+      if ( fabs(dx) < 1.0 and fabs(dy) < 1.0 ){ filterMeas = true;}
+      //There is no chi2 yet, rank the branch by its angle, at most one skipped plane. Such branches
+      //only compete with each other and the ones with a chi2, the seeds are kept outside the beam.
+      angleScore = 0.5 * skipScore * (dx * dx + dy * dy);
+    } else {
+      //Seed
+      filterMeas = not m_ckfHitUsed.at(hit);
+    }
+    if( not filterMeas ) { continue; }
+    nAccepted++;
+    //Did the measurement pass cuts? If so, and the branch is good enough, propagate it
+    size_t slot = addCKFBranch(half, br.score + chi2m + angleScore, br.nMeas + 1, better);
+    if(slot == size_t(-1)) { continue; }
+    CKFBranch<T,N>& child = m_ckfBranches.at(slot);
+    if(br.nMeas > 0) { child.est = br.est; }
+    else { child.est.makeSeedInfo(); }
+    m_fitter.updateInfo(planes.at(plane), hit, child.est);
+    child.chi2 = br.chi2 + chi2m;
+    child.nMeas = br.nMeas + 1;
+    child.nSkipped = br.nSkipped;
+    std::copy(&m_ckfIndexes.at(parent * nPlanes), &m_ckfIndexes.at(parent * nPlanes) + nPlanes, &m_ckfIndexes.at(slot * nPlanes));
+    m_ckfIndexes.at(slot * nPlanes + plane) = hit;
+    if(br.nMeas > 1) { m_ckfHitUsed.at(hit) = 1; }
+  }
+  //Skip plane if we are allowed to skip more measurements, and no measurement passed the chi2 cut.
+  //Before the chi2 cut applies, the angle cut is too loose to tell, the branch always skips.
+  if( br.nSkipped < m_skipMax and (nAccepted == 0 or br.nMeas < 2)){
+    size_t slot = addCKFBranch(half, br.score + skipScore, br.nMeas, better);
+    if(slot == size_t(-1)) { return; }
+    CKFBranch<T,N>& child = m_ckfBranches.at(slot);
+    child.est = br.est;
+    child.chi2 = br.chi2;
+    child.nMeas = br.nMeas;
+    child.nSkipped = br.nSkipped + 1;
+    std::copy(&m_ckfIndexes.at(parent * nPlanes), &m_ckfIndexes.at(parent * nPlanes) + nPlanes, &m_ckfIndexes.at(slot * nPlanes));
+    m_ckfIndexes.at(slot * nPlanes + plane) = -1;
+  }
+}
+
+template <typename T,size_t N>
+void TrackerSystem<T, N>::finalizeCKFTrack(TrackEstimate<T, N>& est, const int* indexes, int nMeas, T chi2){
+  //Check the fitted tracl for chi2/ndof
+  fastInvert(est.cov);
+  est.params = est.cov * est.params;
+  if(( fabs( est.getXdz() - getNominalXdz()) > getXdzMaxDeviance() ) or
+     ( fabs( est.getYdz() - getNominalYdz()) > getYdzMaxDeviance())){
+    return;
+  }
+  // Either reject the track, or save it
+  TrackCandidate<T,N> candidate(planes.size());
+
+  candidate.ndof = nMeas * 2 - 4;
+  candidate.chi2 = chi2;
+  if(candidate.chi2/candidate.ndof > getChi2OverNdofCut()) { return;}
+  
+  //Copy indexes, assign weights
+  for(int plane = 0; plane < (int) planes.size(); plane++){
+    candidate.indexes.at(plane) = indexes[plane];
+  }
+  indexToWeight( candidate );
+  tracks.push_back(candidate);
+  m_nTracks++;
+}
@@ -0,0 +1,216 @@
+/*
+ *   This source code is part of the Eutelescope package of Marlin.
+ *   You are free to use this source files for your own development as
+ *   long as it stays in a public research context. You are not
+ *   allowed to use it for commercial purpose. You must put this
+ *   header with author names in all development based on this file.
+ *
+ */
+#ifndef EUTELEUDRBDECODER_H
+#define EUTELEUDRBDECODER_H
+
+// system includes <>
+#include <cstddef>
+#include <string>
+#include <vector>
+
+namespace eutelescope {
+
+  //! This is the file header. 
+  /*! There is a structure like this at the beginning of the file and
+   *  contains many information about the current setup.
+   *  
+   *  @author Antonio Bulgheroni, INFN <mailto:antonio.bulgheroni@gmail.com>
+   *  @version $Id$
+   */
+  struct EUDRBFileHeader {
+    
+    //! The total number of events stored in the file
+    /*! This number represents how many events are saved into the
+     *  file. This number is not terribly important from the point of
+     *  view of this file structure, since the input file is read
+     *  within a while loop until the EOF is reached, but it is
+     *  important for the following analysis steps where it is
+     *  important to know the number of events in the file. For the
+     *  time being neither the BORE not the EORE are implemented (see
+     *  <a
+     *  href=http://forum.linearcollider.org/index.php?t=tree&th=295&rid=239&S=a6eba1d4660c56539adfcabc48017ce9#page_top>the
+     *  linear collider forum</a>)
+     *
+     *  <code>
+     *  sizeof(EUDRBFileHeader) = 32
+     *  </code>
+     */ 
+    int  numberOfEvent;  //  4 bytes
+    
+    //! The number of separate detector 
+    /*! For the time being this number is going to be equal to one; in
+     *  fact only one detector is read with one EUDRB board. As soon
+     *  as multiple detectors will be read, this number can be
+     *  different by 1, but for that time I hope we will have already
+     *  the final data format (LCIO based) not using anymore this
+     *  basic debug format
+     */ 
+    int  numberOfDetector; // 4 bytes
+
+    //! The number of pixel along x 
+    /*! This is the number of pixel along the x direction for each
+     *  single channel. So for example this is 66 for a MimoTel
+     *  detector
+     */ 
+    int nXPixel; // 4 bytes
+
+    //! The number of pixel along y
+    /*! This is the number of pixel along the y direction for each
+     *  single channel. So for example this is 256 for a MimoTel
+     *  detector
+     */ 
+    int nYPixel; // 4 bytes
+    
+    //! The total event size
+    /*! This is the number of bytes contained in one event
+     *  structure. This is actually equivalent to: <code>
+     *  sizeof(EUDRBEventHeader) + sizeof(EUDRBDataBlock) +
+     *  sizeof(EUDRBTrailer)</code>. For the time being this is
+     *  equivalent to:
+     *
+     *  \li @c sizeof(EUDRBEventHeader) 8 bytes
+     *  \li @c dataSize
+     *  \li @c sizeof(EUDRBTrailer) 4 bytes
+     */ 
+    int eventSize;
+    
+    //! The total data size
+    /*! This is the size in bytes of the data block. It is equal to
+     *  the following: <code> 4 channel * nXPixel * nYPixel * 3 frame
+     *  / 2 samples per record </code>
+     */
+    int dataSize;
+
+    //! Data bit-mask for channel A and C
+    /*! This integer number is used to mask the data part for channels
+     *  A and C in the transferred bus. This mask has to applied to
+     *  each record and then a right shift must be applied to obtained
+     *  the ADC value.
+     *
+     *  For the time being this bit mask is 0x0FFF0000;
+     */ 
+    int chACBitMask; // 4 bytes
+
+    //! Right shift for the channel A/C data
+    /*! To obtain the ADC value for channels A and C from the
+     *  transferred buffer record, first the chACBitMask has to be
+     *  applied, and then a right shift of @a chACRightShift must be
+     *  applied
+     *
+     *  For the time being this number is 16
+     */
+    int chACRightShift; // 4 bytes
+
+    //! Data bit-mask for channel B and C
+    /*! This integer number is used to mask the data part for channels
+     *  B and D in the transferred bus. This mask has to applied to
+     *  each record and then a right shift must be applied to obtained
+     *  the ADC value.
+     *
+     *  For the time being this bit mask is 0x00000FFF;
+     */ 
+    int chBDBitMask; // 4 bytes
+
+    //! Right shift for the channel B/D data
+    /*! To obtain the ADC value for channels B and D from the
+     *  transferred buffer record, first the chBDBitMask has to be
+     *  applied, and then a right shift of @a chBDRightShift must be
+     *  applied
+     *
+     *  For the time being this number is 0
+     */
+    int chBDRightShift; // 4 bytes
+
+  };
+
+  //! This is the event file header.
+  /*! There is a structure like this at the beginning of each
+   *  event. The total size is 8 bytes.
+   * 
+   *  @author Antonio Bulgheroni, INFN <mailto:antonio.bulgheroni@gmail.com>
+   *  @version $Id$
+   */ 
+  struct EUDRBEventHeader {
+    
+    //! The current event number (starting from 0)
+    int eventNumber;     //  4 bytes
+    
+    //! The current trigger number if available 
+    int triggerNumber;   //  4 bytes
+    
+  };
+
+
+  //! This is the EUDRB trailer
+  /*! This is the trailer appended at the end of each event.
+   *
+   *  @author Antonio Bulgheroni, INFN <mailto:antonio.bulgheroni@gmail.com>
+   *  @version $Id$   
+   */
+  struct EUDRBTrailer {
+    //! The trailer
+    unsigned int trailer;  // 4 bytes
+  };
+
+  //! Decodes the data block of one EUDRB debug event
+  /*! The four channels of the data block are written straight into the
+   *  ADC vectors of the output TrackerRawData, the block itself can be
+   *  anywhere in memory: in a read buffer or in a memory mapped input
+   *  file. See EUTelEUDRBReader for the record layout and the
+   *  calculation algorithms.
+   */
+  class EUTelEUDRBDecoder {
+
+  public:
+    //! Default constructor
+    EUTelEUDRBDecoder();
+
+    //! Set up for the data described by the file header
+    /*! @param header The file header
+     *  @param algo One of CDS32, CDS21, LF1, LF2 or LF3
+     *  @return false if the algorithm is not known, nothing is decoded
+     *  in this case
+     */
+    bool configure(EUDRBFileHeader const& header, std::string const& algo);
+
+    //! Number of 32 bit records of one event data block
+    size_t getBlockRecords() const { return _blockRecords; }
+
+    //! Number of values written into every channel
+    size_t getValuesPerChannel() const;
+
+    //! Decode one event data block
+    /*! The values are appended to the four channel vectors.
+     */
+    void decode(int const* block, std::vector<short>& channelA, std::vector<short>& channelB,
+                std::vector<short>& channelC, std::vector<short>& channelD) const;
+
+  private:
+    int _chACBitMask;
+    int _chACRightShift;
+    int _chBDBitMask;
+    int _chBDRightShift;
+
+    //! Records of one frame
+    int _frameRecords;
+
+    //! Records of the whole data block
+    size_t _blockRecords;
+
+    //! First and last (excluded) frame to be decoded
+    int _firstFrame;
+    int _secondFrame;
+
+    //! True for CDS, false for LF
+    bool _cds;
+  };
+
+}                               // end namespace eutelescope
+
+#endif
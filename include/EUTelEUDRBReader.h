@@ -11,6 +11,8 @@
 #define EUTELEUDRBREADER_H 1
 
 // personal includes ".h"
+#include "EUTelEUDRBDecoder.h"
+#include "EUTelMappedFile.h"
 
 // marlin includes ".h"
 #include "marlin/DataSourceProcessor.h"
@@ -18,154 +20,12 @@
 // lcio includes <.h>
 
 // system includes <>
+#include <string>
+#include <vector>
 
 
 namespace eutelescope {
 
-  //! This is the file header. 
-  /*! There is a structure like this at the beginning of the file and
-   *  contains many information about the current setup.
-   *  
-   *  @author Antonio Bulgheroni, INFN <mailto:antonio.bulgheroni@gmail.com>
-   *  @version $Id$
-   */
-  struct EUDRBFileHeader {
-    
-    //! The total number of events stored in the file
-    /*! This number represents how many events are saved into the
-     *  file. This number is not terribly important from the point of
-     *  view of this file structure, since the input file is read
-     *  within a while loop until the EOF is reached, but it is
-     *  important for the following analysis steps where it is
-     *  important to know the number of events in the file. For the
-     *  time being neither the BORE not the EORE are implemented (see
-     *  <a
-     *  href=http://forum.linearcollider.org/index.php?t=tree&th=295&rid=239&S=a6eba1d4660c56539adfcabc48017ce9#page_top>the
-     *  linear collider forum</a>)
-     *
-     *  <code>
-     *  sizeof(EUDRBFileHeader) = 32
-     *  </code>
-     */ 
-    int  numberOfEvent;  //  4 bytes
-    
-    //! The number of separate detector 
-    /*! For the time being this number is going to be equal to one; in
-     *  fact only one detector is read with one EUDRB board. As soon
-     *  as multiple detectors will be read, this number can be
-     *  different by 1, but for that time I hope we will have already
-     *  the final data format (LCIO based) not using anymore this
-     *  basic debug format
-     */ 
-    int  numberOfDetector; // 4 bytes
-
-    //! The number of pixel along x 
-    /*! This is the number of pixel along the x direction for each
-     *  single channel. So for example this is 66 for a MimoTel
-     *  detector
-     */ 
-    int nXPixel; // 4 bytes
-
-    //! The number of pixel along y
-    /*! This is the number of pixel along the y direction for each
-     *  single channel. So for example this is 256 for a MimoTel
-     *  detector
-     */ 
-    int nYPixel; // 4 bytes
-    
-    //! The total event size
-    /*! This is the number of bytes contained in one event
-     *  structure. This is actually equivalent to: <code>
-     *  sizeof(EUDRBEventHeader) + sizeof(EUDRBDataBlock) +
-     *  sizeof(EUDRBTrailer)</code>. For the time being this is
-     *  equivalent to:
-     *
-     *  \li @c sizeof(EUDRBEventHeader) 8 bytes
-     *  \li @c dataSize
-     *  \li @c sizeof(EUDRBTrailer) 4 bytes
-     */ 
-    int eventSize;
-    
-    //! The total data size
-    /*! This is the size in bytes of the data block. It is equal to
-     *  the following: <code> 4 channel * nXPixel * nYPixel * 3 frame
-     *  / 2 samples per record </code>
-     */
-    int dataSize;
-
-    //! Data bit-mask for channel A and C
-    /*! This integer number is used to mask the data part for channels
-     *  A and C in the transferred bus. This mask has to applied to
-     *  each record and then a right shift must be applied to obtained
-     *  the ADC value.
-     *
-     *  For the time being this bit mask is 0x0FFF0000;
-     */ 
-    int chACBitMask; // 4 bytes
-
-    //! Right shift for the channel A/C data
-    /*! To obtain the ADC value for channels A and C from the
-     *  transferred buffer record, first the chACBitMask has to be
-     *  applied, and then a right shift of @a chACRightShift must be
-     *  applied
-     *
-     *  For the time being this number is 16
-     */
-    int chACRightShift; // 4 bytes
-
-    //! Data bit-mask for channel B and C
-    /*! This integer number is used to mask the data part for channels
-     *  B and D in the transferred bus. This mask has to applied to
-     *  each record and then a right shift must be applied to obtained
-     *  the ADC value.
-     *
-     *  For the time being this bit mask is 0x00000FFF;
-     */ 
-    int chBDBitMask; // 4 bytes
-
-    //! Right shift for the channel B/D data
-    /*! To obtain the ADC value for channels B and D from the
-     *  transferred buffer record, first the chBDBitMask has to be
-     *  applied, and then a right shift of @a chBDRightShift must be
-     *  applied
-     *
-     *  For the time being this number is 0
-     */
-    int chBDRightShift; // 4 bytes
-
-  };
-
-  //! This is the event file header.
-  /*! There is a structure like this at the beginning of each
-   *  event. The total size is 8 bytes.
-   * 
-   *  @author Antonio Bulgheroni, INFN <mailto:antonio.bulgheroni@gmail.com>
-   *  @version $Id$
-   */ 
-  struct EUDRBEventHeader {
-    
-    //! The current event number (starting from 0)
-    int eventNumber;     //  4 bytes
-    
-    //! The current trigger number if available 
-    int triggerNumber;   //  4 bytes
-    
-  };
-
-
-  //! This is the EUDRB trailer
-  /*! This is the trailer appended at the end of each event.
-   *
-   *  @author Antonio Bulgheroni, INFN <mailto:antonio.bulgheroni@gmail.com>
-   *  @version $Id$   
-   */
-  struct EUDRBTrailer {
-    //! The trailer
-    unsigned int trailer;  // 4 bytes
-  };
-  
-  
-  
   //!  Reads test data set written with the EUDRB board
   /*!  During the debug phase of the EUDRB in non zero suppressed
    *   mode, data are saved on disk as they are coming from the VME
@@ -219,6 +79,13 @@ namespace eutelescope {
    *   @param CalculationAlgorithm The algorithm to be used to fill
    *   the TrackerRawData
    *
+   *   @param UseMemoryMap Decode the events directly from the memory
+   *   mapped input file instead of reading them into a buffer, off
+   *   by default
+   *
+   *   @param ReadAheadSize Size in MB of the window read in the
+   *   background in front of the decoded event, memory map only
+   *
    *   @author  Antonio Bulgheroni, INFN <mailto:antonio.bulgheroni@gmail.com>
    *   @version $Id$
    *
@@ -261,7 +128,7 @@ namespace eutelescope {
     virtual void init ();
     
     //! End method
-    /*! It deletes the EUTelEUDRBReader::_buffer array
+    /*! It releases the EUTelEUDRBReader::_buffer array
      */
     virtual void end ();
     
@@ -272,18 +139,42 @@ namespace eutelescope {
     
     //! Calculation algorithm
     std::string _algo;
+
+    //! Decode from the memory mapped file
+    bool _useMemoryMap;
+
+    //! Read-ahead window in MB
+    int _readAheadSize;
     
   private:
+
+    //! Reads the input file with an ifstream, one event at a time
+    void readStream();
+
+    //! Decodes the input file directly from its memory mapping
+    void readMappedFile();
+
+    //! Sends the run header built from the file header
+    void processRunHeader();
+
+    //! Creates and processes the event of one data block
+    void processDataBlock(int iEvent, int const* block);
+
+    //! Creates and processes the End Of Run Event
+    void processEORE(int iEvent);
     
     //! A EUDRBFileHeader instance
     /*! This object is used to read the file header from the input
      *  file and the content is used to keep all the useful
      *  information for the data processing
      */ 
-    EUDRBFileHeader * _fileHeader;
+    EUDRBFileHeader _fileHeader;
+
+    //! Decodes the data blocks into the TrackerRawData
+    EUTelEUDRBDecoder _decoder;
     
-    //! The buffer container
-    int * _buffer;
+    //! The buffer container, only used when reading with an ifstream
+    std::vector<int> _buffer;
         
   };
 
@@ -0,0 +1,104 @@
+/*
+ *   This source code is part of the Eutelescope package of Marlin.
+ *   You are free to use this source files for your own development as
+ *   long as it stays in a public research context. You are not
+ *   allowed to use it for commercial purpose. You must put this
+ *   header with author names in all development based on this file.
+ *
+ */
+#ifndef EUTELFRAMEBUFFER_H
+#define EUTELFRAMEBUFFER_H
+
+// eutelescope includes ".h"
+#include "EUTelMappedFile.h"
+
+// system includes <>
+#include <cstddef>
+#include <cstdio>
+#include <string>
+#include <vector>
+
+namespace eutelescope {
+
+  //! Buffer of full ADC frames for processors looping several times over the same events
+  /*! Every frame has the same number of ADC values, those of all
+   *  detectors one after the other, and carries the number of the
+   *  event it comes from. The frames are kept in one contiguous block
+   *  of memory. Once a memory limit is reached the following frames
+   *  are written to a spill file, which is mapped into memory by
+   *  finish(); frame() then returns a pointer into the mapping, so
+   *  the loops over the frames do not care where a frame is.
+   */
+  class EUTelFrameBuffer {
+
+  public:
+    //! Default constructor
+    EUTelFrameBuffer();
+
+    //! Releases the frames and removes the spill file
+    ~EUTelFrameBuffer();
+
+    //! Prepare the buffer, any previous frames are released
+    /*! @param frameSize Number of ADC values in a frame
+     *  @param maxMemory Bytes of frames kept in memory, the others go to the spill file
+     *  @param spillFileName The spill file, created only if needed
+     */
+    void open(size_t frameSize, size_t maxMemory, std::string const& spillFileName);
+
+    //! Append a frame of frameSize() ADC values
+    /*! @return false if the spill file could not be written, see getErrorMessage()
+     */
+    bool append(short const* adcValues, int eventNumber);
+
+    //! Stop appending and map the spill file, to be called before reading the frames
+    /*! @return false if the spill file could not be mapped, see getErrorMessage()
+     */
+    bool finish();
+
+    //! Release the frames and remove the spill file
+    void close();
+
+    //! Number of frames
+    size_t size() const { return _eventNumbers.size(); }
+
+    //! Number of ADC values in a frame
+    size_t frameSize() const { return _frameSize; }
+
+    //! Number of frames in the spill file
+    size_t getNSpilled() const { return _eventNumbers.size() - _nInMemory; }
+
+    //! The ADC values of a frame, after finish()
+    short const* frame(size_t i) const {
+      return ( i < _nInMemory ) ? &_memory[ i * _frameSize ]
+        : reinterpret_cast<short const*>( _mapped.data() ) + ( i - _nInMemory ) * _frameSize;
+    }
+
+    //! The event number of a frame
+    int eventNumber(size_t i) const { return _eventNumbers[i]; }
+
+    //! The reason why append() or finish() failed
+    std::string const& getErrorMessage() const { return _errorMessage; }
+
+  private:
+    EUTelFrameBuffer(EUTelFrameBuffer const&);
+    void operator=(EUTelFrameBuffer const&);
+
+    size_t _frameSize;
+
+    //! Frames which fit into the memory limit
+    size_t _maxInMemory;
+    size_t _nInMemory;
+    std::vector<short> _memory;
+
+    std::vector<int> _eventNumbers;
+
+    std::string _spillFileName;
+    FILE* _spill;
+    EUTelMappedFile _mapped;
+
+    std::string _errorMessage;
+  };
+
+} //namespace
+
+#endif
@@ -17,6 +17,7 @@
 #include "EUTelTrack.h"
 #include "EUTelState.h"
 #include "EUTelMillepede.h"
+#include "EUTelNavMatrix.h"
 
 // EVENT includes
 #include <IMPL/TrackerHitImpl.h>
@@ -50,6 +51,16 @@
 
 namespace eutelescope {
 
+	//! Residual of a fitted track at one measurement
+	struct EUTelGBLResidual {
+		int location;
+		float resX;
+		float resY;
+		//Error of the residual, not of the measurement
+		float errX;
+		float errY;
+	};
+
 	class EUTelGBLFitter :  public EUTelTrackFitter {
         
     private:
@@ -61,9 +72,9 @@ namespace eutelescope {
 			//SET
 			void setMomentsAndStartEndScattering(EUTelState& state);
 			void setInformationForGBLPointList(EUTelTrack& track, std::vector< gbl::GblPoint >& pointList);
-			void setMeasurementGBL(gbl::GblPoint& point, const double *hitPos, double statePos[3], double combinedCov[4], TMatrixD projection);
+			void setMeasurementGBL(gbl::GblPoint& point, const double *hitPos, double statePos[3], double combinedCov[4], Eigen::Matrix2d const& projection);
 			void getKinkInformationToTrack(gbl::GblTrajectory* traj, std::vector< gbl::GblPoint >& pointList,EUTelTrack &track);
-            TMatrixD getFullJacobian(TVector3 momStart, TVector3 momEnd, int locationStart, int locationEnd, double distance, double min );
+            Matrix5d getFullJacobian(TVector3 momStart, TVector3 momEnd, int locationStart, int locationEnd, double distance, double min );
 			void setPointVec( std::vector< gbl::GblPoint >& pointList, gbl::GblPoint& point);
 			void setPairAnyStateAndPointLabelVec(gbl::GblTrajectory*);
 			void setPairMeasurementStateAndPointLabelVec(std::vector< gbl::GblPoint >& pointList);
@@ -98,8 +109,9 @@ namespace eutelescope {
 			void setMEstimatorType( const std::string& _mEstimatorType );
 			//GET
 			float getPositionOfSecondScatter(float start, float end);
-			gbl::GblPoint getLabelToPoint(std::vector<gbl::GblPoint> & pointList, unsigned  int label);
-			void getResidualOfTrackandHits(gbl::GblTrajectory* traj, std::vector< gbl::GblPoint > pointList, EUTelTrack& track, std::map< int, std::map< float, float > > & SensorResidual, std::map< int, std::map< float, float > >& sensorResidualError);
+			gbl::GblPoint const& getLabelToPoint(std::vector<gbl::GblPoint> const& pointList, unsigned  int label);
+			//Appends one residual per measurement location to residuals, the first measurement on a location wins.
+			void getResidualOfTrackandHits(gbl::GblTrajectory* traj, std::vector< gbl::GblPoint > const& pointList, EUTelTrack& track, std::vector< EUTelGBLResidual >& residuals);
 			inline int getAlignmentMode() const {
 				return _alignmentMode;
 			}
@@ -129,7 +141,7 @@ namespace eutelescope {
 			//OTHER FUNCTIONS
 			void resetPerTrack();
 			void findScattersZPositionBetweenTwoStates();
-			TMatrixD findScattersJacobians(EUTelState state, EUTelState nextTrack);
+			Matrix5d findScattersJacobians(EUTelState state, EUTelState nextTrack);
 			void updateTrackFromGBLTrajectory(gbl::GblTrajectory* traj, EUTelTrack& track, std::map<int,std::vector<double> >& mapSensorIDToCorrectionVec );
 			void prepareLCIOTrack( gbl::GblTrajectory*, std::vector<const IMPL::TrackImpl*>::const_iterator&, double, int); 
 			void prepareMilleOut( gbl::GblTrajectory* );
@@ -156,7 +168,7 @@ namespace eutelescope {
 			gbl::MilleBinary* _mille;
 			std::string _binaryname;
 			TMatrixD _jacobianAlignment;
-			std::vector<TMatrixD> _scattererJacobians;
+			std::vector<Matrix5d> _scattererJacobians;
 			std::vector<float> _scattererPositions;
 			std::vector<int> _globalLabels;
 			/** Parameter resolutions */
@@ -0,0 +1,77 @@
+/*
+ *   This source code is part of the Eutelescope package of Marlin.
+ *   You are free to use this source files for your own development as
+ *   long as it stays in a public research context. You are not
+ *   allowed to use it for commercial purpose. You must put this
+ *   header with author names in all development based on this file.
+ *
+ */
+#ifndef EUTELGEOMETRICPIXELINDEX_H
+#define EUTELGEOMETRICPIXELINDEX_H
+
+// personal includes ".h"
+#include "EUTelGeometricPixel.h"
+
+// system includes <>
+#include <cstddef>
+#include <vector>
+
+namespace eutelescope {
+
+  //! Uniform grid over the physical pixel positions of one sensor
+  /*! Used by EUTelProcessorGeometricClustering to find the pixels which
+   *  may touch a given pixel without comparing it to all other hit
+   *  pixels. The cell size is chosen such that two pixels touching
+   *  according to the clustering criterion
+   *
+   *    |dX| <= (boundX1 + boundX2) * 1.01
+   *
+   *  (and the same along y) always sit in the same or in adjacent
+   *  cells. Non-uniform pitches are supported, the largest pixel of the
+   *  event sets the cell size. getCandidates() returns a superset of
+   *  the touching pixels, the caller applies the exact criterion, so
+   *  the clustering result does not depend on the index.
+   */
+  class EUTelGeometricPixelIndex {
+
+  public:
+    //! Default constructor
+    EUTelGeometricPixelIndex();
+
+    //! Build the index over the hit pixels of one sensor
+    /*! The pixel vector has to stay unchanged as long as the index is
+     *  used, candidates are returned as indices into it.
+     */
+    void build(std::vector<EUTelGeometricPixel> const& pixels);
+
+    //! Append all pixels which may touch pixel @c index
+    /*! The returned candidates are in no particular order and include
+     *  @c index itself.
+     */
+    void getCandidates(size_t index, std::vector<int>& candidates) const;
+
+  private:
+    //! Relative safety margin on the cell size against rounding
+    static const double _cellMargin;
+
+    double _originX;
+    double _originY;
+    double _cellX;
+    double _cellY;
+    int _nX;
+    int _nY;
+
+    //! First pixel of each cell or -1
+    std::vector<int> _cellHead;
+
+    //! Next pixel in the same cell or -1
+    std::vector<int> _nextInCell;
+
+    //! Cell coordinates of each pixel
+    std::vector<int> _cellXOfPixel;
+    std::vector<int> _cellYOfPixel;
+  };
+
+} //namespace
+
+#endif
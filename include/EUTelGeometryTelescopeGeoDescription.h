@@ -10,6 +10,8 @@
 #include <string>
 #include <array>
 #include <memory>
+#include <vector>
+#include <atomic>
 
 // MARLIN
 #include "marlin/Global.h"
@@ -25,6 +27,9 @@
 // EUTELESCOPE
 #include "EUTelUtility.h"
 #include "EUTelGenericPixGeoMgr.h"
+#include "EUTelSensorTransform.h"
+#include "EUTelSensorLookup.h"
+#include "EUTelRadLengthTable.h"
 
 
 // ROOT
@@ -162,8 +167,8 @@ class EUTelGeometryTelescopeGeoDescription
 	/** Map containing plane path (string) and corresponding planeID */
 	std::map<int, std::string> _planePath;
 
-	/** */
-	static unsigned _counter;
+	/** Shared by all threads which call gGeometry() */
+	static std::atomic<unsigned> _counter;
 
   public:
 	/** Retrieves the instanstance of geometry.
@@ -336,17 +341,52 @@ class EUTelGeometryTelescopeGeoDescription
 	void initializeTGeoDescription( std::string const & geomName, bool dumpRoot );
 
 	// Geometry operations
+	/** Radiation length between two points split into sensors and air.
+	 * Taken from the radiation length table if it is filled and covers the
+	 * slope of the segment, otherwise integrated through TGeo. Changing the
+	 * geometry clears the table until useRadLengthTable() or
+	 * updateRadLengthTable() fills it again.
+	 */
 	float findRad(	const std::map<int,int>& sensorIDToZOrderWithoutExcludedPlanes, 
 			const double globalPosStart[], const double globalPosFinish[], 
 			std::map<const int,double> &sensors, std::map<const int,double> &air );
 
+	/** findRad always integrating through TGeo */
+	float findRadTGeo( const std::map<int,int>& sensorIDToZOrderWithoutExcludedPlanes, 
+			   const double globalPosStart[], const double globalPosFinish[], 
+			   std::map<const int,double> &sensors, std::map<const int,double> &air );
+
+	/** Switch findRad to the tabulated material budget.
+	 * The table is filled right away for slopes up to maxSlope with nSlopeBins grid
+	 * points per slope and compared to the TGeo integration. If the interpolation
+	 * deviates by more than the relative tolerance the table is not used.
+	 * Call after the TGeo geometry is initialised and before any thread uses
+	 * findRad.
+	 *
+	 * @return true if the table is used
+	 */
+	bool useRadLengthTable( bool use, double maxSlope = 0.05, int nSlopeBins = 21, double tolerance = 0.01 );
+
+	/** Refill the radiation length table if it is used but was cleared by
+	 * a change of the geometry. Call before findRad is used from several
+	 * threads, it is never filled on the way.
+	 */
+	void updateRadLengthTable();
+
+	/** The radiation length table, empty unless it is used */
+	EUTelRadLengthTable const& getRadLengthTable() const { return _radLengthTable; }
+
 	int getSensorID(float const globalPos[] ) const;
 	int getSensorID(double const globalPos[] ) const;
 
 	int getSensorID(std::array<double,3> const globalPos) const;
 	int getSensorID(std::array<float,3> const globalPos) const;
+
+	/** Batched getSensorID for nPoints consecutive (x,y,z) triplets */
+	void getSensorID(size_t nPoints, double const globalPos[], int sensorIDs[]) const;
 	
 	int getSensorIDFromManager();
+	int getSensorIDFromManager( TGeoNavigator* nav );
 
 	double FindRad(Eigen::Vector3d const & startPt, Eigen::Vector3d const & endPt);
 
@@ -358,10 +398,33 @@ class EUTelGeometryTelescopeGeoDescription
 	void local2MasterVec( int sensorID, std::array<double,3> const & localVec, std::array<double,3>& globalVec);
 	void master2LocalVec( int sensorID, std::array<double,3> const & globalVec, std::array<double,3>& localVec);
 
-	void local2Master( int, const double[], double[] );
-	void master2Local(int, const double[], double[] );
-	void local2MasterVec( int, const double[], double[] );
-	void master2LocalVec( int, const double[], double[] );
+	/** Coordinate transformations between the local frame of a sensor and the global frame.
+	 * They use the cached transformation of the sensor node, see getSensorTransform().
+	 */
+	inline void local2Master( int sensorID, const double localPos[], double globalPos[] ) { getSensorTransform(sensorID).local2Master( localPos, globalPos ); }
+	inline void master2Local( int sensorID, const double globalPos[], double localPos[] ) { getSensorTransform(sensorID).master2Local( globalPos, localPos ); }
+	inline void local2MasterVec( int sensorID, const double localVec[], double globalVec[] ) { getSensorTransform(sensorID).local2MasterVec( localVec, globalVec ); }
+	inline void master2LocalVec( int sensorID, const double globalVec[], double localVec[] ) { getSensorTransform(sensorID).master2LocalVec( globalVec, localVec ); }
+
+	/** Batched transformations of nPoints consecutive (x,y,z) triplets */
+	inline void local2Master( int sensorID, size_t nPoints, const double localPos[], double globalPos[] ) { getSensorTransform(sensorID).local2Master( nPoints, localPos, globalPos ); }
+	inline void master2Local( int sensorID, size_t nPoints, const double globalPos[], double localPos[] ) { getSensorTransform(sensorID).master2Local( nPoints, globalPos, localPos ); }
+	inline void local2MasterVec( int sensorID, size_t nPoints, const double localVec[], double globalVec[] ) { getSensorTransform(sensorID).local2MasterVec( nPoints, localVec, globalVec ); }
+	inline void master2LocalVec( int sensorID, size_t nPoints, const double globalVec[], double localVec[] ) { getSensorTransform(sensorID).master2LocalVec( nPoints, globalVec, localVec ); }
+
+	/** Local-to-global transformation of the given sensor.
+	 * The matrices are extracted from the TGeo nodes once, after the TGeo geometry is built
+	 * and whenever the plane layout is updated, instead of navigating the TGeo tree for each point.
+	 * They are extracted again together with the sensor lookup whenever alignment constants are
+	 * applied. The reference is valid until the next call. Nodes without a cache entry are
+	 * navigated with the navigator of the calling thread.
+	 */
+	inline EUTelSensorTransform const& getSensorTransform( int sensorID ) const {
+		if( sensorID >= 0 && static_cast<size_t>(sensorID) < _sensorTransforms.size() && _sensorTransforms[sensorID].valid ) {
+			return _sensorTransforms[sensorID];
+		}
+		return uncachedSensorTransform(sensorID);
+	}
 
 	bool findIntersectionWithCertainID(	float x0, float y0, float z0, 
 						float px, float py, float pz, 
@@ -404,6 +467,22 @@ class EUTelGeometryTelescopeGeoDescription
 
 	int findNextPlane(  double* lpoint,  double* ldir,  float* newpoint );
 
+	/** Enable TGeo navigation from nThreads threads at the same time.
+	 * Must be called once after the TGeo geometry is initialised and before
+	 * worker threads use the geometry, it fills all caches with fillCaches().
+	 * The alignment setters must not be called while worker threads run.
+	 */
+	void setMaxThreads( int nThreads );
+
+	/** Fill the memoized plane axes, radiation lengths and the radiation
+	 * length table for all sensors, so that worker threads only read them.
+	 * Call again after the alignment changed and before threads start.
+	 */
+	void fillCaches();
+
+	/** Navigator of the calling thread, created on first use */
+	TGeoNavigator* getNavigator() const;
+
 private:
 	/** reading initial info from gear: part of contructor */
 	void readSiPlanesLayout();
@@ -424,11 +503,39 @@ private:
 
 	void translateSiPlane2TGeo(TGeoVolume*,int );
 
-	void clearMemoizedValues() { _planeNormalMap.clear(); _planeXMap.clear(); _planeYMap.clear(); _planeRadMap.clear(); }
+	/** Extract the transformation of a sensor from its TGeo node */
+	void extractSensorTransform( int sensorID, EUTelSensorTransform& transform ) const;
+
+	/** Transformation of a node without a cache entry, per thread */
+	EUTelSensorTransform const& uncachedSensorTransform( int sensorID ) const;
+
+	/** Re-extract the transformations of all sensors and rebuild the sensor lookup */
+	void updateSensorTransforms();
+
+	/** getSensorID by TGeo navigation, used if there is no sensor lookup */
+	int getSensorIDFromTGeo( double const globalPos[] ) const;
+
+	/** Tabulate the radiation lengths and check them against TGeo */
+	void fillRadLengthTable();
+
+	void clearMemoizedValues() { _planeNormalMap.clear(); _planeXMap.clear(); _planeYMap.clear(); _planeRadMap.clear(); updateSensorTransforms(); _radLengthTable.clear(); }
 	std::map<int, TVector3> _planeNormalMap;
 	std::map<int, TVector3> _planeXMap;
 	std::map<int, TVector3> _planeYMap;
 	std::map<int, double> _planeRadMap;
+
+	/** Cached sensor transformations, indexed by sensorID */
+	std::vector<EUTelSensorTransform> _sensorTransforms;
+
+	/** Oriented boxes of all sensor planes for getSensorID */
+	EUTelSensorLookup _sensorLookup;
+
+	/** Tabulated material budget used by findRad */
+	EUTelRadLengthTable _radLengthTable;
+	bool _useRadLengthTable;
+	double _radLengthTableMaxSlope;
+	int _radLengthTableBins;
+	double _radLengthTableTolerance;
 };
         
 inline EUTelGeometryTelescopeGeoDescription& gGeometry( gear::GearMgr* _g = marlin::Global::GEAR )
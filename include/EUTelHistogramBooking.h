@@ -0,0 +1,29 @@
+/*
+ *   This source code is part of the Eutelescope package of Marlin.
+ *   You are free to use this source files for your own development as
+ *   long as it stays in a public research context. You are not
+ *   allowed to use it for commercial purpose. You must put this
+ *   header with author names in all development based on this file.
+ *
+ */
+#ifndef EUTELHISTOGRAMBOOKING_H
+#define EUTELHISTOGRAMBOOKING_H
+
+// system includes <>
+#include <mutex>
+
+namespace eutelescope {
+
+  //! Mutex to be held while booking histograms
+  /*! AIDA histogram factories cannot be used by several threads at
+   *  the same time. Processors which book histograms outside of init()
+   *  and of their first event have to lock this mutex when they may run
+   *  event parallel, see EUTelProcessorEventPipeline. It is recursive
+   *  as the pipeline already holds it during the first event of every
+   *  processor copy.
+   */
+  std::recursive_mutex& histogramBookingMutex();
+
+}
+
+#endif
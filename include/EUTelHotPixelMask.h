@@ -0,0 +1,85 @@
+/*
+ *   This source code is part of the Eutelescope package of Marlin.
+ *   You are free to use this source files for your own development as
+ *   long as it stays in a public research context. You are not
+ *   allowed to use it for commercial purpose. You must put this
+ *   header with author names in all development based on this file.
+ *
+ */
+#ifndef EUTELHOTPIXELMASK_H
+#define EUTELHOTPIXELMASK_H
+
+// system includes <>
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <utility>
+#include <vector>
+
+namespace eutelescope {
+
+  //! Per sensor hot pixel bitmask with constant time lookups
+  /*! Every sensor with hot pixels gets a dense bitmask over the
+   *  bounding box of its hot pixels, so the memory is bounded by the
+   *  pixel count of the sensor divided by eight. Sensors whose
+   *  bounding box would exceed _maxDenseBits keep a sorted list of
+   *  packed pixel indices instead, looked up by binary search.
+   *
+   *  Sensors are indexed directly by their ID, a lookup is a bounds
+   *  check and a bit test. Filled once per run, see
+   *  Utility::FillHotPixelMask.
+   */
+  class EUTelHotPixelMask {
+
+  public:
+    //! Default constructor
+    EUTelHotPixelMask();
+
+    //! Remove all hot pixels
+    void clear();
+
+    //! Set the hot pixels of one sensor, replacing previous ones
+    void setHotPixels(int sensorID, std::vector<std::pair<int, int> > const& pixels);
+
+    //! True if no sensor has hot pixels
+    bool empty() const { return _nHotPixels == 0; }
+
+    //! Total number of hot pixels
+    size_t size() const { return _nHotPixels; }
+
+    //! Membership test
+    inline bool isHot(int sensorID, int x, int y) const {
+      if( sensorID < 0 || static_cast<size_t>(sensorID) >= _sensors.size() ) return false;
+      SensorMask const& mask = _sensors[sensorID];
+      unsigned int const dX = static_cast<unsigned int>( x - mask.minX );
+      unsigned int const dY = static_cast<unsigned int>( y - mask.minY );
+      if( dX >= mask.nX || dY >= mask.nY ) return false;
+      if( mask.sparse ) return std::binary_search( mask.sorted.begin(), mask.sorted.end(), static_cast<uint64_t>(dY)*mask.nX + dX );
+      size_t const bit = static_cast<size_t>(dY)*mask.nX + dX;
+      return ( mask.bits[bit >> 6] >> (bit & 63) ) & 1;
+    }
+
+  private:
+    struct SensorMask {
+      SensorMask(): minX(0), minY(0), nX(0), nY(0), sparse(false), bits(), sorted() {}
+      int minX;
+      int minY;
+      unsigned int nX;
+      unsigned int nY;
+      bool sparse;
+      std::vector<uint64_t> bits;
+      std::vector<uint64_t> sorted;
+    };
+
+    //! Largest bounding box which is stored as a dense bitmask
+    static const uint64_t _maxDenseBits;
+
+    //! Masks indexed by sensor ID, empty for sensors without hot pixels
+    std::vector<SensorMask> _sensors;
+
+    size_t _nHotPixels;
+  };
+
+} //namespace
+
+#endif
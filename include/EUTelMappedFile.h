@@ -0,0 +1,103 @@
+/*
+ *   This source code is part of the Eutelescope package of Marlin.
+ *   You are free to use this source files for your own development as
+ *   long as it stays in a public research context. You are not
+ *   allowed to use it for commercial purpose. You must put this
+ *   header with author names in all development based on this file.
+ *
+ */
+#ifndef EUTELMAPPEDFILE_H
+#define EUTELMAPPEDFILE_H
+
+// system includes <>
+#include <condition_variable>
+#include <cstddef>
+#include <mutex>
+#include <string>
+#include <thread>
+
+namespace eutelescope {
+
+  //! Read only memory mapping of a whole input file
+  /*! Used by EUTelFrameBuffer to address the frames it spilled to disk
+   *  like those kept in memory, and by EUTelEUDRBReader with UseMemoryMap
+   *  to decode the records directly from the mapped pages instead of
+   *  copying every event into a buffer first.
+   *
+   *  With a read-ahead window a background thread faults in the pages
+   *  up to that many bytes in front of the last position passed to
+   *  consumed(), so the decoding thread rarely waits for the disk.
+   *  Pages well behind that position are given back to the kernel,
+   *  therefore files much larger than the memory can be streamed.
+   */
+  class EUTelMappedFile {
+
+  public:
+    //! Default constructor
+    EUTelMappedFile();
+
+    //! Unmaps the file and stops the read-ahead thread
+    ~EUTelMappedFile();
+
+    //! Map a file
+    /*! @param fileName The file to be mapped
+     *  @param readAhead Size of the read-ahead window in bytes, 0 to
+     *  disable the background thread
+     *  @return false if the file could not be opened or mapped, see
+     *  getErrorMessage()
+     */
+    bool open(std::string const& fileName, size_t readAhead = 0);
+
+    //! Unmap the file
+    void close();
+
+    //! True if a file is mapped
+    bool isOpen() const { return _data != 0; }
+
+    //! First byte of the file
+    char const* data() const { return _data; }
+
+    //! Size of the file in bytes
+    size_t size() const { return _size; }
+
+    //! The reason why open() failed
+    std::string const& getErrorMessage() const { return _errorMessage; }
+
+    //! Report that the bytes in front of @c offset have been decoded
+    /*! Moves the read-ahead window. Has to be called from one thread
+     *  only, the one decoding the data.
+     */
+    void consumed(size_t offset);
+
+  private:
+    EUTelMappedFile(EUTelMappedFile const&);
+    void operator=(EUTelMappedFile const&);
+
+    //! Body of the read-ahead thread
+    void readAhead();
+
+    int _fileDescriptor;
+    char const* _data;
+    size_t _size;
+    std::string _errorMessage;
+
+    //! Read-ahead window in bytes
+    size_t _readAheadSize;
+
+    //! Offset below which pages have already been released
+    size_t _released;
+
+    std::thread _readAheadThread;
+    std::mutex _mutex;
+    std::condition_variable _condition;
+
+    //! Last offset passed to consumed()
+    size_t _position;
+
+    //! Tells the read-ahead thread to finish
+    bool _stop;
+  };
+
+} //namespace
+
+#endif
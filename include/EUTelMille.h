@@ -14,6 +14,8 @@
 #ifdef USE_GEAR
 // eutelescope includes ".h"
 #include "EUTelUtility.h"
+#include "EUTelMilleWriter.h"
+#include "EUTelMilleTrackFinder.h"
 
 //#include "TrackerHitImpl2.h"
 #include "IMPL/TrackerHitImpl.h"
@@ -21,9 +23,6 @@
 // marlin includes ".h"
 #include "marlin/Processor.h"
 
-// marlin util includes
-#include "mille/Mille.h"
-
 // lcio includes <.h>
 #include <EVENT/LCRunHeader.h>
 #include <EVENT/LCEvent.h>
@@ -207,27 +206,7 @@ namespace eutelescope {
     };
 
     //! Variables for hit parameters
-    class HitsInPlane {
-    public:
-      HitsInPlane(){
-        measuredX = 0.0;
-        measuredY = 0.0;
-        measuredZ = 0.0;
-      }
-      HitsInPlane(double x, double y, double z)
-      {
-        measuredX = x;
-        measuredY = y;
-        measuredZ = z;
-      }
-      bool operator<(const HitsInPlane& b) const
-      {
-        return (measuredZ < b.measuredZ);
-      }
-      double measuredX;
-      double measuredY;
-      double measuredZ;
-    };
+    typedef EUTelMilleTrackFinder::HitsInPlane HitsInPlane;
 
     virtual void FitTrack(
                           unsigned int nPlanesFitter,
@@ -243,14 +222,14 @@ namespace eutelescope {
                           );
 
 
-    //recursive method which searches for track candidates - with omits!
+    //! Search the track candidates, planes may be missed
+    /*! Uses the original recursive search, or the pruned one if
+     *  PrunedTrackSearch is set. The two accept different candidates,
+     *  see EUTelMilleTrackFinder.
+     */
     virtual void findtracks2(
-                            int missinghits,
                             std::vector<IntVec > &indexarray, //resulting vector of hit indizes
-                            IntVec vec, //for internal use
-                            std::vector<std::vector<EUTelMille::HitsInPlane> > &_hitsArray, //contains all hits for each plane
-                            unsigned int i, //plane number
-                            int y //hit index number
+                            std::vector<std::vector<EUTelMille::HitsInPlane> > &_hitsArray //contains all hits for each plane
                             );
 
 
@@ -385,16 +364,11 @@ namespace eutelescope {
      */
     std::string _hotPixelCollectionName;
 
-    //! Vector of map arrays, keeps record of hit pixels 
-    /*! The vector elements are sorted by Detector ID
-     *  For each Detector unique ID element a map of pixels is created. 
-     *  first level key   sensor unique 
-     *              value sensor map
-     *  sensor map key    unique row number
-     *             value  vector of column numbers.
+    //! Hot pixels of all sensors
+    /*! Filled from the hot pixel collection on the first event, one
+     *  bitmask per sensor, see EUTelHotPixelMask.
      */
-    
-    std::map<std::string, bool > _hotPixelMap;
+    EUTelHotPixelMask _hotPixelMask;
 
     //! Sensor ID vector
     IntVec _sensorIDVec;
@@ -419,8 +393,23 @@ namespace eutelescope {
     int _maxTrackCandidates;
     int _maxTrackCandidatesTotal;
 
+    //! Use EUTelMilleTrackFinder::findPruned() instead of the original search
+    bool _prunedTrackSearch;
+
+    //! Largest slope between two hits of a candidate, no cut if zero
+    float _maxTrackSlope;
+
+    //! Largest number of branches findtracks2 visits per event
+    int _maxTrackFinderBranches;
+
     std::string _binaryFilename;
 
+    //! Write a gzip compressed Millepede binary
+    bool _compressBinary;
+
+    //! Write the index of the Millepede binary for milleselect
+    bool _writeBinaryIndex;
+
     float _telescopeResolution;
     bool _onlySingleHitEvents;
     bool _onlySingleTrackEvents;
@@ -487,8 +476,11 @@ namespace eutelescope {
     int _nMilleDataPoints;
     int _nMilleTracks;
 
+    //! Track candidate search, kept from event to event for its buffers
+    EUTelMilleTrackFinder _trackFinder;
+
     // Mille
-    Mille * _mille;
+    EUTelMilleWriter * _mille;
 
     //! Conversion ID map.
     /*! In the data file, each cluster is tagged with a detector ID
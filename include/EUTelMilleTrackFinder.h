@@ -0,0 +1,143 @@
+/*
+ *   This source code is part of the Eutelescope package of Marlin.
+ *   You are free to use this source files for your own development as
+ *   long as it stays in a public research context. You are not
+ *   allowed to use it for commercial purpose. You must put this
+ *   header with author names in all development based on this file.
+ *
+ */
+#ifndef EUTELMILLETRACKFINDER_H
+#define EUTELMILLETRACKFINDER_H
+
+// system includes <>
+#include <vector>
+
+namespace eutelescope {
+
+  //! Track candidate search of EUTelMille
+  /*! A candidate holds for each plane, ordered in z, the index of its
+   *  hit on that plane or -1 if the plane is missed. Two searches are
+   *  available:
+   *
+   *  \li findLegacy() is the original recursive search. A hit failing
+   *  the ResidualsX/YMin/Max cut with respect to the hit on the plane
+   *  before is replaced by a missed plane, one branch per rejected
+   *  hit, so the same candidate can be found several times. After a
+   *  missed plane every following hit fails the cut. The hit on the
+   *  last plane is stored whether it passes the cut or not.
+   *
+   *  \li findPruned() is an iterative search with an explicit stack.
+   *  After a missed plane the hits are compared with the last real hit
+   *  of the candidate, with the sum of the maximal residuals of the
+   *  planes in between; the cut applies on the last plane as well. A
+   *  plane is missed only if none of its hits passes, so candidates are
+   *  not duplicated, each has one entry per plane and at least two
+   *  hits. The hits of each plane are sorted in x and only those inside
+   *  the window are looked at. Optionally the slope between two hits is
+   *  limited and the number of branches visited per event capped.
+   */
+  class EUTelMilleTrackFinder {
+
+  public:
+    //! A hit in the global frame
+    class HitsInPlane {
+    public:
+      HitsInPlane(){
+        measuredX = 0.0;
+        measuredY = 0.0;
+        measuredZ = 0.0;
+      }
+      HitsInPlane(double x, double y, double z)
+      {
+        measuredX = x;
+        measuredY = y;
+        measuredZ = z;
+      }
+      bool operator<(const HitsInPlane& b) const
+      {
+        return (measuredZ < b.measuredZ);
+      }
+      double measuredX;
+      double measuredY;
+      double measuredZ;
+    };
+
+    //! The hits of each plane
+    typedef std::vector<std::vector<HitsInPlane> > HitsArray;
+
+    //! Default constructor
+    EUTelMilleTrackFinder();
+
+    //! Residual cuts between consecutive planes, in the order of the planes
+    void setResidualCuts(std::vector<float> const& xMin, std::vector<float> const& xMax,
+                         std::vector<float> const& yMin, std::vector<float> const& yMax);
+
+    //! Number of planes a candidate may miss
+    void setAllowedMissingHits(int allowedMissingHits) { _allowedMissingHits = allowedMissingHits; }
+
+    //! Largest number of candidates per event
+    void setMaxTrackCandidates(int maxTrackCandidates) { _maxTrackCandidates = maxTrackCandidates; }
+
+    //! Largest slope between two hits of a candidate, findPruned() only, no cut if zero
+    void setMaxTrackSlope(double maxTrackSlope) { _maxTrackSlope = maxTrackSlope; }
+
+    //! Largest number of branches visited per event, findPruned() only, no limit if zero
+    void setMaxBranches(long long maxBranches) { _maxBranches = maxBranches; }
+
+    //! The original recursive search
+    void findLegacy(HitsArray const& hits, std::vector<std::vector<int> >& indexarray);
+
+    //! The iterative windowed search
+    /*! @return false if the search was stopped at the branch limit
+     */
+    bool findPruned(HitsArray const& hits, std::vector<std::vector<int> >& indexarray);
+
+    //! Branches visited by findPruned() so far
+    long long getNBranches() const { return _nBranches; }
+
+    //! Hits findPruned() did not follow because of the cuts
+    long long getNPrunedBranches() const { return _nPrunedBranches; }
+
+    //! Events in which findPruned() stopped at the branch limit
+    int getNTruncatedEvents() const { return _nTruncatedEvents; }
+
+  private:
+    //! One level of the recursion of findLegacy()
+    void findLegacy(int missinghits, std::vector<std::vector<int> >& indexarray, std::vector<int> vec,
+                    HitsArray const& hits, unsigned int i, int y);
+
+    //! Hits of plane i passing the cuts with respect to the candidate built so far
+    void selectHits(HitsArray const& hits, int i);
+
+    std::vector<float> _residualsXMin;
+    std::vector<float> _residualsXMax;
+    std::vector<float> _residualsYMin;
+    std::vector<float> _residualsYMax;
+    int _allowedMissingHits;
+    int _maxTrackCandidates;
+    double _maxTrackSlope;
+    long long _maxBranches;
+
+    long long _nBranches;
+    long long _nPrunedBranches;
+    int _nTruncatedEvents;
+
+    //! Buffers of findPruned(), kept from event to event
+    /*! Hit indices of each plane sorted in x, their z range, and for
+     *  each plane of the candidate being built its hit, the last plane
+     *  with a hit before it, the planes missed before it, the hits
+     *  passing the cuts and the next of them to try.
+     */
+    std::vector<std::vector<int> > _hitsSortedInX;
+    std::vector<double> _zMin;
+    std::vector<double> _zMax;
+    std::vector<int> _candidate;
+    std::vector<int> _lastHitPlane;
+    std::vector<int> _missingHits;
+    std::vector<std::vector<int> > _choices;
+    std::vector<int> _nextChoice;
+  };
+
+} //namespace
+
+#endif
@@ -0,0 +1,176 @@
+/*
+ *   This source code is part of the Eutelescope package of Marlin.
+ *   You are free to use this source files for your own development as
+ *   long as it stays in a public research context. You are not
+ *   allowed to use it for commercial purpose. You must put this
+ *   header with author names in all development based on this file.
+ *
+ */
+#ifndef EUTELMILLEWRITER_H
+#define EUTELMILLEWRITER_H
+
+// system includes <>
+#include <atomic>
+#include <cstddef>
+#include <functional>
+#include <stdint.h>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace eutelescope {
+
+  //! Millepede binary writer with a background I/O thread
+  /*! Records are built with the same calls as with Mille and written in
+   *  the same binary format, so pede reads the file as before. end()
+   *  only hands the record to a single producer, single consumer ring
+   *  of record buffers; a dedicated thread writes them to the file, so
+   *  the processor does not wait for the disk. The buffers are swapped,
+   *  not copied, and reused, therefore no memory is allocated once the
+   *  records stop growing.
+   *
+   *  Optionally the binary is gzip compressed, pede has to be built
+   *  with zlib support to read it. Eutelescope needs zlib as well,
+   *  otherwise the file is written uncompressed.
+   *
+   *  Next to the binary an index is written, with the run, event,
+   *  plane topology, \f$ \chi^{2} \f$ and ndf of every record. The
+   *  records passing tighter cuts can then be copied into a new binary
+   *  with copyRecords() or the milleselect tool, for the next pede
+   *  iteration, without running the Marlin chain again.
+   */
+  class EUTelMilleWriter {
+
+  public:
+    //! Index entry of one record
+    struct RecordInfo {
+      //! Byte offset of the record in the uncompressed binary
+      uint64_t offset;
+      //! Size of the record in bytes, including its length word
+      uint32_t size;
+      int32_t run;
+      int32_t event;
+      //! Bit i is set if plane i contributed measurements
+      uint32_t topology;
+      int32_t ndf;
+      float chi2;
+    };
+
+    //! Selection of records for copyRecords()
+    typedef std::function<bool(RecordInfo const&)> Selection;
+
+    //! Default constructor
+    EUTelMilleWriter();
+
+    //! Writes the queued records and closes the files
+    ~EUTelMilleWriter();
+
+    //! Open the binary and start the I/O thread
+    /*! @param fileName The Millepede binary file
+     *  @param compress Write a gzip compressed binary
+     *  @param writeIndex Write the index into indexFileName( fileName )
+     *  @param queueSize Number of records which can wait for the I/O thread
+     *  @return false if a file could not be opened, see getErrorMessage()
+     */
+    bool open(std::string const& fileName, bool compress = false, bool writeIndex = true, size_t queueSize = 1024);
+
+    //! Write the queued records and close the files
+    /*! @return false if writing failed, see getErrorMessage()
+     */
+    bool close();
+
+    //! True if a binary is open
+    bool isOpen() const { return _writer.joinable(); }
+
+    //! The reason why open() or close() failed
+    std::string const& getErrorMessage() const { return _errorMessage; }
+
+    //! Name of the index belonging to a binary
+    static std::string indexFileName(std::string const& fileName) { return fileName + ".idx"; }
+
+    //! Add a measurement to the current record, the arguments are those of Mille::mille
+    /*! Zero derivatives are suppressed, a measurement with sigma <= 0
+     *  is ignored.
+     */
+    void mille(int nLocal, float const* derLocal, int nGlobal, float const* derGlobal,
+               int const* label, float measurement, float sigma);
+
+    //! Describe the current record for the index
+    void setRecordInfo(int run, int event, unsigned int topology, float chi2, int ndf);
+
+    //! Drop the current record
+    void kill();
+
+    //! Queue the current record for writing
+    void end();
+
+    //! Number of records queued
+    size_t getNRecords() const { return _nRecords; }
+
+    //! Number of records for which end() had to wait for a free buffer
+    size_t getNQueueFull() const { return _nQueueFull; }
+
+    //! Read the index of a binary
+    /*! @return false if the index could not be read, see errorMessage
+     */
+    static bool readIndex(std::string const& fileName, std::vector<RecordInfo>& records, std::string& errorMessage);
+
+    //! Copy the selected records of a binary into a new binary with its index
+    /*! @param input Binary with an index next to it
+     *  @param output New binary, its index is written next to it
+     *  @param selection True for the records to be copied
+     *  @param compress Write a gzip compressed binary
+     *  @return The number of records copied, -1 on errors, see errorMessage
+     */
+    static long copyRecords(std::string const& input, std::string const& output, Selection const& selection,
+                            bool compress, std::string& errorMessage);
+
+  private:
+    EUTelMilleWriter(EUTelMilleWriter const&);
+    void operator=(EUTelMilleWriter const&);
+
+    //! Binary file, plain or compressed
+    class File;
+
+    //! One Mille record: the measurements, derivatives and labels
+    struct Record {
+      std::vector<float> floats;
+      std::vector<int> ints;
+      RecordInfo info;
+    };
+
+    //! Body of the I/O thread
+    void write();
+
+    //! Record being built
+    Record _current;
+
+    //! Ring of records waiting for the I/O thread
+    std::vector<Record> _queue;
+
+    //! Records queued, only changed by the producer
+    alignas(64) std::atomic<size_t> _head;
+
+    //! Records written, only changed by the I/O thread, on its own cache line
+    alignas(64) std::atomic<size_t> _tail;
+
+    //! Tells the I/O thread to finish once the queue is empty
+    std::atomic<bool> _stop;
+
+    //! Set by the I/O thread if writing failed
+    std::atomic<bool> _failed;
+
+    File* _file;
+    File* _index;
+    std::thread _writer;
+
+    std::string _fileName;
+    std::string _errorMessage;
+
+    size_t _nRecords;
+    size_t _nQueueFull;
+  };
+
+} //namespace
+
+#endif
@@ -5,6 +5,7 @@
 #include "EUTelTrack.h"
 #include "EUTelState.h"
 #include "EUTelPStream.h"
+#include "EUTelPedeDriver.h"
 
 // MARLIN
 #include "marlin/Exceptions.h"
@@ -74,8 +75,6 @@ public:
 	TMatrixD const& getAlignmentJacobian(){ return _jacobian; }
 	std::vector<int> getGlobalParameters(){ return _globalLabels; }
 	
-	///////find stuff
-	bool findTooManyRejects(std::string output);
 	gbl::MilleBinary * _milleGBL;
 	void CreateBinary();
 
@@ -0,0 +1,120 @@
+/*
+ *   This source code is part of the Eutelescope package of Marlin.
+ *   You are free to use this source files for your own development as
+ *   long as it stays in a public research context. You are not
+ *   allowed to use it for commercial purpose. You must put this
+ *   header with author names in all development based on this file.
+ *
+ */
+#ifndef EUTELNAVMATRIX_H
+#define EUTELNAVMATRIX_H
+
+// ROOT
+#include "TMatrixD.h"
+#include "TMatrixDSym.h"
+#include "TVectorD.h"
+
+// system includes <>
+#include <cmath>
+#include <Eigen/Core>
+#include <Eigen/LU>
+
+namespace eutelescope {
+
+  //! Fixed size matrices of the track propagation
+  /*! Jacobians, projections and covariances of a track state have sizes
+   *  known at compile time. These types keep them on the stack, so fitting
+   *  a track does not allocate. ROOT matrices are only built where GBL asks
+   *  for them, see the adapters in Utility below.
+   */
+  typedef Eigen::Matrix<double, 5, 5> Matrix5d;
+  typedef Eigen::Matrix<double, 5, 1> Vector5d;
+  typedef Eigen::Matrix<double, 5, 2> Matrix52d;
+  typedef Eigen::Matrix<double, 2, 3> Matrix23d;
+  typedef Eigen::Matrix<double, 3, 2> Matrix32d;
+
+  //! Geometry independent kernels of EUTelNav
+  /*! The magnetic field and the plane orientation are passed in, which
+   *  keeps this class free of Marlin, GEAR and TGeo. EUTelNav looks them
+   *  up and forwards to these functions.
+   */
+  class EUTelNavMatrix
+  {
+  public:
+    //! Jacobian of (q/p, tx, ty, x, y) for a step dz in parabolic approximation
+    /*! @param momentum Momentum of the particle in GeV/c
+     *  @param bField Magnetic field at the start in kG
+     */
+    static Matrix5d propagationJacobianF(Eigen::Vector3d const& momentum, Eigen::Vector3d const& bField, double beamQ, double dz);
+
+    //! Transformation from the local frame of a plane to the curvilinear frame
+    /*! @param bField Magnetic field in the global frame in T
+     *  @param normal,xAxis,yAxis Axes of the plane in the global frame
+     */
+    static Matrix5d localToCurvilinear(Eigen::Vector3d const& globalMomentum, Eigen::Vector3d const& bField,
+                                       Eigen::Vector3d const& normal, Eigen::Vector3d const& xAxis,
+                                       Eigen::Vector3d const& yAxis, double charge);
+
+    //! Relates changes of the local state to changes of the global one
+    /*! @param rotation Local to global rotation of the plane
+     */
+    static Matrix5d measToGlobal(Eigen::Vector3d const& t1w, Eigen::Matrix3d const& rotation);
+
+    //! Curvilinear propagation jacobian, bField in the global frame in T
+    static Matrix5d propagationJacobianCurvilinear(double ds, double qbyp, Eigen::Vector3d const& t1w,
+                                                   Eigen::Vector3d const& t2w, Eigen::Vector3d const& bField);
+
+    //! Jacobian between two states in the global frame, bField in T
+    static Matrix5d propagationJacobianGlobalToGlobal(double ds, Eigen::Vector3d const& t1w, Eigen::Vector3d const& bField);
+
+    //! Set all elements smaller than min in magnitude to zero
+    template<typename Derived>
+    static void setPrecision(Eigen::MatrixBase<Derived>& mat, double min) {
+      for( int j = 0; j < mat.cols(); ++j ) {
+        for( int i = 0; i < mat.rows(); ++i ) {
+          if( std::abs( mat(i,j) ) < min ) mat(i,j) = 0;
+        }
+      }
+    }
+
+  private:
+    EUTelNavMatrix();
+  };
+
+  namespace Utility {
+
+    //! Copy a fixed size matrix into a ROOT matrix, for the GBL interface
+    template<typename Derived>
+    TMatrixD toTMatrixD(Eigen::MatrixBase<Derived> const& mat) {
+      TMatrixD out( mat.rows(), mat.cols() );
+      for( int i = 0; i < mat.rows(); ++i ) {
+        for( int j = 0; j < mat.cols(); ++j ) out[i][j] = mat(i,j);
+      }
+      return out;
+    }
+
+    //! Copy a square fixed size matrix into a ROOT symmetric matrix, for the GBL interface
+    /*! All elements are copied as they are, a matrix filled only below the
+     *  diagonal stays so, as GBL received it before.
+     */
+    template<typename Derived>
+    TMatrixDSym toTMatrixDSym(Eigen::MatrixBase<Derived> const& mat) {
+      TMatrixDSym out( mat.rows() );
+      for( int i = 0; i < mat.rows(); ++i ) {
+        for( int j = 0; j < mat.cols(); ++j ) out[i][j] = mat(i,j);
+      }
+      return out;
+    }
+
+    //! Copy a fixed size vector into a ROOT vector, for the GBL interface
+    template<typename Derived>
+    TVectorD toTVectorD(Eigen::MatrixBase<Derived> const& vec) {
+      TVectorD out( vec.size() );
+      for( int i = 0; i < vec.size(); ++i ) out[i] = vec(i);
+      return out;
+    }
+  }
+
+} //namespace
+
+#endif
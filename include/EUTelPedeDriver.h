@@ -0,0 +1,164 @@
+/*
+ *   This source code is part of the Eutelescope package of Marlin.
+ *   You are free to use this source files for your own development as
+ *   long as it stays in a public research context. You are not
+ *   allowed to use it for commercial purpose. You must put this
+ *   header with author names in all development based on this file.
+ *
+ */
+#ifndef EUTELPEDEDRIVER_H
+#define EUTELPEDEDRIVER_H
+
+// system includes <>
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <string>
+#include <sys/types.h>
+#include <thread>
+#include <utility>
+#include <vector>
+
+namespace eutelescope {
+
+  //! Runs pede in the background and parses its output while it runs
+  /*! start() forks pede with its stdout and stderr connected to pipes
+   *  and returns at once. A reader thread sleeps in poll() until pede
+   *  writes, splits the output into lines and parses every line as it
+   *  comes in: the number of records, the rejected records, the
+   *  "Too many rejects" stop and the final
+   *  \f$ \sum\chi^{2} / \sum ndf \f$ end up in Statistics instead of
+   *  having to be searched in the text afterwards. Once pede has
+   *  exited successfully, the reader thread also parses millepede.res.
+   *
+   *  wait() hands the lines to the calling thread as they arrive, so
+   *  they can go to streamlog from there, and returns when pede has
+   *  exited. Nothing polls in between.
+   *
+   *  pede writes millepede.res and its other output files into its
+   *  working directory. Fits which are to run at the same time, for
+   *  example one per DUT, therefore get a working directory each; all
+   *  of them are started first and waited for afterwards.
+   */
+  class EUTelPedeDriver {
+
+  public:
+    //! What pede reported, filled while it runs
+    struct Statistics {
+      //! True once pede has exited and its output is read
+      bool finished;
+      //! Exit code of pede, 128 + signal if it was killed, 127 if it could not be executed, -1 while running
+      int exitStatus;
+      //! Number of records read by pede, -1 if not reported
+      long nRecords;
+      //! Records rejected in the last iteration: rank deficit or NaN, ndf = 0, huge and large \f$ \chi^{2} \f$
+      long rejected[4];
+      //! pede stopped because of too many rejects
+      bool tooManyRejects;
+      //! Final \f$ \sum\chi^{2} / \sum ndf \f$, valid if hasChi2Ndf
+      double chi2Ndf;
+      bool hasChi2Ndf;
+      //! Number of lines pede wrote to stderr
+      int nErrorLines;
+    };
+
+    //! One line of millepede.res
+    struct Parameter {
+      int label;
+      double value;
+      double presigma;
+      double difference;
+      //! Error of the parameter, 0 if it was fixed
+      double error;
+      bool fixed;
+    };
+
+    //! Receives the output lines of pede in the thread calling wait()
+    typedef std::function<void(std::string const& line, bool isError)> LineHandler;
+
+    //! Default constructor
+    EUTelPedeDriver();
+
+    //! Terminates pede if it is still running
+    ~EUTelPedeDriver();
+
+    //! Start pede in the background
+    /*! @param steeringFile The steering file, relative to the working directory
+     *  @param workingDirectory Directory pede runs in, the current one if empty
+     *  @param program The pede executable, searched in the PATH
+     *  @return false if pede could not be started, see getErrorMessage()
+     */
+    bool start(std::string const& steeringFile, std::string const& workingDirectory = "",
+               std::string const& program = "pede");
+
+    //! Wait for pede to exit
+    /*! @param handler Called for every output line, in this thread, while pede runs
+     *  @return The final statistics
+     */
+    Statistics const& wait(LineHandler const& handler = LineHandler());
+
+    //! Send SIGTERM to pede
+    void terminate();
+
+    //! True between start() and the end of wait()
+    bool isRunning() const { return _reader.joinable(); }
+
+    //! Snapshot of the statistics, can be called while pede runs
+    Statistics getStatistics() const;
+
+    //! The parameters of millepede.res, once wait() returned with exit status 0
+    std::vector<Parameter> const& getParameters() const { return _parameters; }
+
+    //! Path of millepede.res written by this run
+    std::string getResultFileName() const;
+
+    //! The reason why start() failed or millepede.res could not be read
+    std::string const& getErrorMessage() const { return _errorMessage; }
+
+    //! Parse a millepede.res file
+    /*! @return false if the file could not be opened, see errorMessage
+     */
+    static bool readResults(std::string const& fileName, std::vector<Parameter>& parameters,
+                            std::string& errorMessage);
+
+  private:
+    EUTelPedeDriver(EUTelPedeDriver const&);
+    void operator=(EUTelPedeDriver const&);
+
+    //! Body of the reader thread
+    void read();
+
+    //! Update the statistics with one output line, called with the mutex locked
+    void parseLine(std::string const& line, bool isError);
+
+    pid_t _pid;
+
+    //! Read ends of the stdout and stderr pipes
+    int _fd[2];
+
+    std::thread _reader;
+
+    //! Protects everything below, shared with the reader thread
+    mutable std::mutex _mutex;
+    std::condition_variable _changed;
+
+    //! Lines not yet passed to wait(), with true for stderr
+    std::deque< std::pair<std::string, bool> > _lines;
+
+    Statistics _statistics;
+    std::vector<Parameter> _parameters;
+
+    //! Waiting for the value after the next '=' of a \f$ \sum\chi^{2} / \sum ndf \f$ line
+    bool _chi2NdfPending;
+
+    //! Number of rejected record counts still expected
+    int _rejectedPending;
+
+    std::string _workingDirectory;
+    std::string _errorMessage;
+  };
+
+} //namespace
+
+#endif
@@ -10,6 +10,8 @@
 #define EUTELPEDESTALNOISEPROCESSOR_H 1
 
 // eutelescope includes ".h"
+#include "EUTelFrameBuffer.h"
+#include "EUTelPixelAccumulator.h"
 
 // marlin includes ".h"
 #include "marlin/Processor.h"
@@ -167,6 +169,24 @@ namespace eutelescope {
    *  additional loop to better identify hit candidate; to be
    *  performed when calculating pedestal from beam runs.
    *
+   *  <h2>MeanRMS noise</h2>
+   *  @param ExactMeanRMSNoise Calculate the MeanRMS noise as the RMS
+   *  of the population with the Welford recursion. By default the
+   *  original running estimate is kept, which takes the deviation of
+   *  each event from the already updated pedestal and gives a smaller
+   *  noise. Switching this on changes the noise and therefore the
+   *  bad pixel masking and the calibration downstream.
+   *
+   *  <h2>Single pass</h2>
+   *  @param SinglePass Read the input only once. The ADC values of
+   *  the selected events are kept in an EUTelFrameBuffer and the pre
+   *  loop, the common mode iterations and the additional masking loop
+   *  run on the buffered frames instead of rewinding the input. Only
+   *  available with the MeanRMS algorithm.
+   *  @param SinglePassMaxMemory Memory for the buffered frames in MB;
+   *  further frames are written next to the output pedestal file and
+   *  mapped into memory for the loops.
+   *
    *  <h2>Other controls</h2>
    *  @param FirstEvent First event to be used for pedestal calculation
    *  @param LastEvent Last event to be used for pedestal calculation
@@ -485,6 +505,52 @@ namespace eutelescope {
     //! Performs a pre loop
     virtual void preLoop( LCEvent * event );
 
+    //! Common mode correction of one detector
+    /*! Calculates the correction of every pixel of the detector with
+     *  the current common mode algorithm, using the current pedestal,
+     *  noise and status. Used by the otherLoop and by the single pass.
+     *
+     *  @param iDetector The detector index, including the collection offset
+     *  @param eventNumber The event number, for the messages
+     *  @param adcValues The ADC values of the detector
+     *  @param commonModeCorrection Filled with the correction of every pixel
+     *  @return false if the event has to be skipped for this detector
+     */
+    bool calculateCommonMode( size_t iDetector, int eventNumber, const short * adcValues, float * commonModeCorrection );
+
+    //! Sets _tempWeight to 0 for the pixels excluded by the pre loop in the current event, to 1 otherwise
+    void setPreLoopWeight( size_t iDetector, size_t noOfPixel );
+
+    //! Adds a common mode corrected event of one detector to its running average and sigma
+    /*! Bad pixels and pixels beyond the hit rejection cut are not
+     *  used, their weight is set to 0.
+     *
+     *  @param iDetector The detector index, including the collection offset
+     *  @param adcValues The ADC values of the detector
+     *  @param commonModeCorrection The correction of every pixel
+     *  @param weight 1 for the pixels to be used if they pass the cuts, 0 for the others
+     */
+    void accumulateCorrected( size_t iDetector, const short * adcValues, const float * commonModeCorrection, float * weight );
+
+    //! Buffers the ADC values of an event in the single pass mode
+    /*! When the end of the pedestal events is reached, all the loops
+     *  are run on the buffered frames by singlePass() and the
+     *  processing is stopped.
+     */
+    void bufferEvent( LCEvent * event );
+
+    //! Runs all the loops on the buffered frames and writes the output file
+    void singlePass();
+
+    //! Moves the results of the current loop into pedestal and noise, masks and fills the histograms
+    /*! This is the first part of finalizeProcessor(), it increments
+     *  the loop counter.
+     */
+    void finalizeLoop( bool fromMaskingLoop );
+
+    //! Writes pedestal, noise and status into the output file
+    void writePedestalFile();
+
     //! Simple rewind
     virtual void simpleRewind();
 
@@ -833,35 +899,23 @@ namespace eutelescope {
      */
     IntVec _maxY;
 
-    //! Temporary array to store the running average
-    /*! This a vector of vectors of doubles. The outern layer represents
-     * the detector, while the inner layer is used to temporary store
-     * the running average of pixel output signal.  The outer layer is
-     * properly sized in the runHeader(), when the number of detector
-     * plane in the run is discovered.  The inner layer is done in the
-     * firstEvent of each detector module.
+    //! Running average and sigma of the MeanRMS algorithm
+    /*! One accumulator for each detector, with the number of
+     * entries, the running average and the running variance of every
+     * pixel output signal. The number of entries is needed because
+     * not every pixel is used in every event when applying "hit
+     * rejection" in common mode suppression algorithm. The
+     * accumulators are started in the first event of each loop and
+     * moved to _pedestal and _noise at the end of the loop.
      */
-    std::vector < FloatVec > _tempPede;
+    std::vector < EUTelPixelAccumulator< double > > _tempAccumulator;
 
-    //! Temporary array to store the running sigma
-    /*! This a vector of vectors of doubles. The outern layer represents
-     * the detector, while the inner layer is used to temporary store
-     * the running sigma of pixel output signal.  The outer layer is
-     * properly sized in the runHeader(), when the number of detector
-     * plane in the run is discovered.  The inner layer is done in the
-     * firstEvent of each detector module.
+    //! Signal and weight of every pixel of a detector in the current event
+    /*! Scratch arrays for the accumulator updates, kept to avoid an
+     *  allocation per detector and event.
      */
-    std::vector < FloatVec > _tempNoise;
-
-    //! Temporary array to store the number of entries
-    /*! In order to have both the running average and sigma working,
-     * another array to store how many "entries" a pixel has should be
-     * recorded. This might be useless there is an entry for each event,
-     * but this is not the case when applying "hit rejection" in common
-     * mode suppression algorithm. The underlying philosophy is the same
-     * used for _tempPede and _tempNoise
-     */
-    std::vector < IntVec > _tempEntries;
+    FloatVec _tempValue;
+    FloatVec _tempWeight;
 
     //! Array to store the intermediate/final pedestal value
     /*! At the end of the first loop on events, a first approximation
@@ -897,6 +951,24 @@ namespace eutelescope {
     //! Preloop minimum value
     std::vector < ShortVec > _minValue;
 
+    //! Exact RMS switch of the MeanRMS noise
+    bool _exactMeanRMSNoise;
+
+    //! Single pass switch
+    bool _singlePass;
+
+    //! Memory for the buffered frames in the single pass mode, in MB
+    int _singlePassMaxMemory;
+
+    //! The ADC values of the selected events in the single pass mode
+    EUTelFrameBuffer _frameBuffer;
+
+    //! First ADC value of every detector in a buffered frame, and the frame size at the end
+    std::vector< size_t > _frameOffset;
+
+    //! The frame being buffered
+    ShortVec _frame;
+
     //! Event loop counter
     /*! This is a counter for the number of loops. The processor will
      * loop the first time (_iLoop == 0) for pedestal and noise
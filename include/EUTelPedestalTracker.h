@@ -0,0 +1,96 @@
+/*
+ *   This source code is part of the Eutelescope package of Marlin.
+ *   You are free to use this source files for your own development as
+ *   long as it stays in a public research context. You are not
+ *   allowed to use it for commercial purpose. You must put this
+ *   header with author names in all development based on this file.
+ *
+ */
+#ifndef EUTELPEDESTALTRACKER_H
+#define EUTELPEDESTALTRACKER_H
+
+// system includes <>
+#include <cstddef>
+#include <vector>
+
+namespace eutelescope {
+
+  //! Drift of the tracked pedestal and noise of one detector
+  /*! All the quantities are computed with respect to the reference,
+   *  i.e. the pedestal and noise the tracker was started with.
+   */
+  struct EUTelPedestalDrift {
+    //! Number of events since the start of the tracker
+    long   noOfEvents;
+    //! Mean of the pedestal shift over the pixels
+    double meanShift;
+    //! RMS of the pedestal shift over the pixels
+    double rmsShift;
+    //! Largest absolute pedestal shift
+    double maxShift;
+    //! Mean ratio of the tracked to the reference noise
+    double meanNoiseRatio;
+    //! Pixels whose pedestal moved by more than hitRejectionCut reference sigma
+    int    noOfDriftedPixel;
+    //! Fraction of the pixels used for the update since the previous drift
+    double updatedFraction;
+  };
+
+  //! Exponentially weighted pedestal and noise tracker of a detector
+  /*! The tracker keeps its own copy of the pedestal and of the noise
+   *  variance of every pixel. update() folds one event into them
+   *  with exponentialWeightUpdate(), i.e. in a single pass over the
+   *  pixels, using only the good pixels which are not hits. alpha =
+   *  1 / weight, so that the time constant is weight events.
+   *
+   *  The tracked values are copied to the pedestal and noise arrays
+   *  used by the other processors only by snapshot(), while getDrift()
+   *  compares them to the reference. Both are meant to be called
+   *  every few hundred events, their cost is one more pass with a
+   *  square root per pixel.
+   */
+  class EUTelPedestalTracker {
+
+  public:
+    //! Default constructor, no pixels
+    EUTelPedestalTracker();
+
+    //! Start from a pedestal and noise, which become the reference
+    void start(size_t noOfPixel, float const* pedestal, float const* noise, float weight, float hitRejectionCut);
+
+    //! Update with one event
+    void update(short const* adcValues, short const* status);
+
+    //! Copy the tracked pedestal and noise
+    void snapshot(float* pedestal, float* noise) const;
+
+    //! Drift with respect to the reference
+    /*! The fraction of updated pixels refers to the events since the
+     *  previous call, whose counters are reset.
+     */
+    EUTelPedestalDrift getDrift();
+
+    //! Number of pixels
+    size_t size() const { return _pedestal.size(); }
+
+    //! The tracked pedestal
+    float const* pedestal() const { return _pedestal.empty() ? 0 : &_pedestal[0]; }
+
+    //! The tracked noise variance
+    float const* variance() const { return _variance.empty() ? 0 : &_variance[0]; }
+
+  private:
+    std::vector<float> _pedestal;
+    std::vector<float> _variance;
+    std::vector<float> _refPedestal;
+    std::vector<float> _refNoise;
+    float _alpha;
+    float _hitRejectionCut;
+    long _noOfEvents;
+    long _noOfEventsSinceDrift;
+    double _noOfUpdatedSinceDrift;
+  };
+
+} //namespace
+
+#endif
@@ -0,0 +1,146 @@
+/*
+ *   This source code is part of the Eutelescope package of Marlin.
+ *   You are free to use this source files for your own development as
+ *   long as it stays in a public research context. You are not
+ *   allowed to use it for commercial purpose. You must put this
+ *   header with author names in all development based on this file.
+ *
+ */
+#ifndef EUTELPIXELACCUMULATOR_H
+#define EUTELPIXELACCUMULATOR_H
+
+// system includes <>
+#include <cstddef>
+#include <vector>
+
+namespace eutelescope {
+
+  //! Running mean and variance of every pixel of a detector
+  /*! The number of entries, the mean and the variance are kept in
+   *  three contiguous arrays of T, float or double, one element per
+   *  pixel. add() updates all the pixels of one event with the
+   *  recursion of the MeanRMS algorithm
+   *
+   *  \f[ n_{k} = n_{k-1} + 1, \quad
+   *      \mu_{k} = \mu_{k-1} + \frac{x - \mu_{k-1}}{n_{k}}, \quad
+   *      \sigma^{2}_{k} = \sigma^{2}_{k-1} + \frac{(x - \mu_{k})^{2} - \sigma^{2}_{k-1}}{n_{k}} \f]
+   *
+   *  in a single loop without branches: every pixel comes with a
+   *  weight of 1 or 0, and pixels with weight 0 (hits, bad pixels,
+   *  excluded events) are left as they are. The compiler can
+   *  therefore vectorise the update of a whole frame (gcc does it
+   *  from -O3, i.e. in the Release build).
+   *
+   *  This variance is smaller than the one of the population, as the
+   *  deviations are taken from the updated mean. With
+   *  setExactVariance() the Welford recursion is used instead,
+   *
+   *  \f[ \sigma^{2}_{k} = \sigma^{2}_{k-1} + \frac{(x - \mu_{k-1})(x - \mu_{k}) - \sigma^{2}_{k-1}}{n_{k}}, \f]
+   *
+   *  which gives the variance of the population.
+   */
+  template <typename T>
+  class EUTelPixelAccumulator {
+
+  public:
+    //! Default constructor, no pixels
+    EUTelPixelAccumulator();
+
+    //! Use the Welford recursion, the variance of the population, instead of the MeanRMS one
+    void setExactVariance(bool exactVariance) { _exactVariance = exactVariance; }
+
+    //! Start from one event: one entry, the mean is the value and the variance 0
+    void start(size_t noOfPixel, short const* value);
+    void start(size_t noOfPixel, float const* value);
+
+    //! Start from a previous mean and sigma, counted as one entry
+    void start(size_t noOfPixel, float const* mean, float const* sigma);
+
+    //! Add one event
+    /*! @param value The signal of every pixel
+     *  @param weight 1 for the pixels to be used, 0 for the others
+     */
+    void add(short const* value, float const* weight);
+    void add(float const* value, float const* weight);
+
+    //! Number of pixels
+    size_t size() const { return _mean.size(); }
+
+    //! The arrays, one element per pixel
+    T const* entries()  const { return _entries.empty()  ? 0 : &_entries[0]; }
+    T const* mean()     const { return _mean.empty()     ? 0 : &_mean[0]; }
+    T const* variance() const { return _variance.empty() ? 0 : &_variance[0]; }
+
+    //! The mean of every pixel, e.g. the pedestal
+    std::vector<float> getMean() const;
+
+    //! The square root of the variance of every pixel, e.g. the noise
+    std::vector<float> getSigma() const;
+
+  private:
+    bool _exactVariance;
+    std::vector<T> _entries;
+    std::vector<T> _mean;
+    std::vector<T> _variance;
+  };
+
+  //! The pieces of a common mode calculation on a group of pixels
+  struct EUTelCommonModeSum {
+    //! Sum of the pedestal subtracted signals of the good pixels which are not hits
+    double sum;
+    //! Number of pixels in sum
+    int goodPixel;
+    //! Number of pixels above the hit rejection cut, good or not
+    int skippedPixel;
+  };
+
+  //! Masked reduction for the common mode of a row or of a full frame
+  /*! A pixel is a hit if its pedestal subtracted signal exceeds
+   *  hitRejectionCut times its noise. The common mode of the group is
+   *  then sum / goodPixel, the processors decide from goodPixel and
+   *  skippedPixel whether it can be used.
+   */
+  EUTelCommonModeSum commonModeSum(size_t noOfPixel, short const* adcValues, float const* pedestal,
+                                   float const* noise, short const* status, float hitRejectionCut);
+
+  //! Calibration and zero suppression of a group of pixels in one pass
+  /*! The calibrated signal of every pixel is
+   *  \f$ s = (x - p) - c \f$ with c the common mode of the group. It is
+   *  written to corrected, unless corrected is 0.
+   *
+   *  If selected is not 0, the good pixels with s above sigmaCut
+   *  times their noise are also selected: their position in the group
+   *  and their signal are written to the first elements of selected
+   *  and selectedSignal, which need room for noOfPixel elements.
+   *
+   *  @return The number of selected pixels
+   */
+  size_t calibrateAndSelect(size_t noOfPixel, short const* adcValues, float const* pedestal, float const* noise,
+                            short const* status, float commonMode, float sigmaCut, float* corrected,
+                            unsigned int* selected, float* selectedSignal);
+
+  //! Fixed weight update of pedestal and noise with one event
+  /*! Only the good pixels are updated:
+   *  \f$ p = ((w - 1) p + x) / w \f$ and
+   *  \f$ \sigma^{2} = ((w - 1) \sigma^{2} + (x - p)^{2}) / w \f$
+   */
+  void fixedWeightUpdate(size_t noOfPixel, short const* adcValues, short const* status, float weight,
+                         float* pedestal, float* noise);
+
+  //! Exponentially weighted update of pedestal and variance with one event
+  /*! The good pixels whose signal is within hitRejectionCut sigma of
+   *  their pedestal are updated with
+   *  \f$ d = x - p, \quad p = p + \alpha d, \quad
+   *      \sigma^{2} = (1 - \alpha)(\sigma^{2} + \alpha d^{2}) \f$,
+   *  the others (hits, bad pixels) are left as they are. The variance
+   *  is kept instead of the noise, so that there is no square root
+   *  per pixel.
+   *
+   *  @return The number of updated pixels
+   */
+  size_t exponentialWeightUpdate(size_t noOfPixel, short const* adcValues, short const* status, float alpha,
+                                 float hitRejectionCut, float* pedestal, float* variance);
+
+} //namespace
+
+#endif
@@ -0,0 +1,196 @@
+/*
+ *   This source code is part of the Eutelescope package of Marlin.
+ *   You are free to use this source files for your own development as
+ *   long as it stays in a public research context. You are not
+ *   allowed to use it for commercial purpose. You must put this
+ *   header with author names in all development based on this file.
+ *
+ */
+#ifndef EUTELPROCESSOREVENTPIPELINE_H
+#define EUTELPROCESSOREVENTPIPELINE_H
+
+// eutelescope includes ".h"
+#include "EUTELESCOPE.h"
+#include "EUTelWorkerPool.h"
+
+// marlin includes ".h"
+#include "marlin/DataSourceProcessor.h"
+
+// lcio includes <.h>
+#include <EVENT/LCEvent.h>
+#include <IMPL/LCEventImpl.h>
+#include <IMPL/LCRunHeaderImpl.h>
+
+// system includes <>
+#include <condition_variable>
+#include <deque>
+#include <exception>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+namespace eutelescope {
+
+  //! Event parallel execution of the first processors of a chain
+  /*! This data source replaces the LCIO input of Marlin (do not set
+   *  LCIOInputFiles in the global section) and has to be put in the
+   *  execute section in front of the processors it feeds. The
+   *  processors listed in ParallelProcessors have to follow it directly
+   *  in the execute section, in the same order, init() fails otherwise.
+   *  They run on NumberOfThreads worker threads, several events at a
+   *  time. All other active processors are called by Marlin as usual,
+   *  strictly one event after the other and in the order of the input
+   *  files, so an LCIOOutputProcessor writes the events in their
+   *  original order.
+   *
+   *  Suited are processors which only look at the event they are given,
+   *  like EUTelProcessorSparseClustering, EUTelProcessorHitMaker,
+   *  EUTelProcessorCoordinateTransformHits or EUTelProcessorGBLTrackFit
+   *  used as a fitter only. Order sensitive processors (noisy pixel
+   *  finders, alignment, anything writing a binary file) must not be
+   *  listed, they stay serialised.
+   *
+   *  Every worker owns a private copy of each parallel processor, created
+   *  in init() with its own copy of the parameters of the one in the
+   *  steering file and initialised by Marlin after the processors of the
+   *  steering file. Histograms are thus filled per thread and added into
+   *  the histograms of the original processor once all events are read,
+   *  before the AIDA file is written. Each copy gets its end() call right after the last event,
+   *  before its histograms are merged and it is deleted; the original
+   *  gets its end() call at the end of the job. Every one of these calls
+   *  only sees the events of its own worker, so processors which fit,
+   *  normalise or write job wide results in end() (as opposed to
+   *  printing their own statistics) must not be listed in
+   *  ParallelProcessors. The alignment, noisy pixel and pedestal
+   *  processors of EUTelescope are refused.
+   *
+   *  The input is read by a single LCReader in its own thread, which
+   *  queues a few events per worker ahead. The collections of every
+   *  event are moved into an event owned by the pipeline, so nothing is
+   *  copied. The calling thread takes the events in batches: the
+   *  parallel processors run on the batch first, then the batch is
+   *  passed through the serial processors in order.
+   *
+   *  streamlog is not thread safe, so the parallel processors run with
+   *  their log output switched off. Errors reach the job as exceptions,
+   *  run a processor serially to see its messages.
+   *
+   *  Processors which book histograms after their first event have to
+   *  hold histogramBookingMutex() while doing so.
+   *
+   *  <h4>Input</h4>
+   *  LCIO files given in InputFiles.
+   *
+   *  @param InputFiles LCIO files to be read
+   *  @param ParallelProcessors Names of the active processors to run event parallel
+   *  @param NumberOfThreads Worker threads, 0 means one per core
+   */
+  class EUTelProcessorEventPipeline : public marlin::DataSourceProcessor {
+
+  public:
+    //! Default constructor
+    EUTelProcessorEventPipeline();
+
+    //! New processor
+    virtual EUTelProcessorEventPipeline * newProcessor();
+
+    //! Init method
+    /*! Checks the parameters, reads all run headers of the input files
+     *  and creates the worker copies of the parallel processors.
+     */
+    virtual void init();
+
+    //! Reads the input files and processes their events
+    /*! @param numEvents Maximum number of events, 0 or less for all
+     */
+    virtual void readDataSource(int numEvents);
+
+    //! End method
+    /*! Calls end() of the parallel processors and releases them.
+     */
+    virtual void end();
+
+  private:
+    DISALLOW_COPY_AND_ASSIGN(EUTelProcessorEventPipeline)
+
+    //! Check that the parallel processors directly follow the pipeline
+    void checkProcessorOrder() const;
+
+    //! Add a copy of each parallel processor per worker to the Marlin chain
+    void createWorkerProcessors();
+
+    //! Take the parallel processors and their copies out of the Marlin chain
+    void setUpWorkerProcessors();
+
+    //! Fill the memoized geometry values and the radiation length table before threads use them
+    void prepareGeometry();
+
+    //! Body of the reader thread
+    void readInput(int numEvents);
+
+    //! Run the parallel processors of one worker on an event
+    /*! @return false if a processor skipped the rest of the event
+     */
+    bool processParallel(int iWorker, IMPL::LCEventImpl * event);
+
+    //! Record the first error and stop reading, the pipeline mutex has to be held
+    void stop(std::exception_ptr error);
+
+    //! Hand an event to the serial part of the chain
+    void commitEvent(EVENT::LCEvent * event);
+
+    //! End the processor copies and add their histograms to the originals
+    void mergeWorkerHistograms();
+
+    //! Input files
+    std::vector<std::string> _inputFiles;
+
+    //! Names of the processors running event parallel
+    std::vector<std::string> _parallelProcessorNames;
+
+    //! Number of worker threads
+    int _nThreads;
+
+    //! Processors of each worker, the first worker uses the originals
+    std::vector<std::vector<marlin::Processor*> > _workerProcessors;
+
+    //! Run number last passed to the processors of each worker
+    std::vector<int> _workerRuns;
+
+    //! Set until the processors of a worker had their first event
+    std::vector<std::vector<char> > _workerFirstEvent;
+
+    //! Threads running the parallel processors, the calling one included
+    std::unique_ptr<EUTelWorkerPool> _workerPool;
+
+    //! Copies of the run headers, by run number
+    std::map<int, std::unique_ptr<IMPL::LCRunHeaderImpl> > _runHeaders;
+
+    //! Run number last passed to the serial part of the chain
+    int _committedRun;
+
+    //! Events read but not yet taken for a batch
+    std::deque<IMPL::LCEventImpl*> _eventQueue;
+
+    //! Set once the reader has queued its last event
+    bool _endOfInput;
+
+    //! Guards the queue
+    std::mutex _pipelineMutex;
+    std::condition_variable _pipelineCondition;
+
+    //! Set if processing has to end early
+    bool _stop;
+
+    //! First exception of the reader or the processors, rethrown after the reader is done
+    std::exception_ptr _error;
+  };
+
+  //! A global instance of the processor
+  EUTelProcessorEventPipeline gEUTelProcessorEventPipeline;
+
+}
+
+#endif
@@ -2,6 +2,9 @@
 #ifndef EUTelProcessorFilteringHitFilter_h
 #define EUTelProcessorFilteringHitFilter_h 1
 
+// EUTelescope
+#include "EUTelHotPixelMask.h"
+
 // LCIO
 #include "lcio.h"
 
@@ -63,7 +66,7 @@ namespace eutelescope {
         int _nProcessedEvents;
 
         // treat hits with hotpixels
-        std::map<std::string, bool > _hotPixelMap;
+        EUTelHotPixelMask _hotPixelMask;
  
     };
 
@@ -10,6 +10,7 @@
 #include <vector>
 #include <cstdio>
 #include <algorithm>
+#include <thread>
 
 // LCIO
 #include <EVENT/LCCollection.h>
@@ -43,6 +44,7 @@
 #include "EUTelEventImpl.h"
 #include "EUTelHistogramManager.h"
 #include "EUTelReaderGenericLCIO.h"
+#include "EUTelWorkerPool.h"
 
 namespace eutelescope {
 
@@ -115,14 +117,39 @@ namespace eutelescope {
 			/** y Resolution of planes in PlaneIds */
 			FloatVec _SteeringyResolutions;
 
-			/** Track fitter */
-			EUTelGBLFitter *_trackFitter;
+			/** Number of threads fitting the tracks of an event */
+			int _nThreads;
+
+			/** Fit of one track, filled by the threads and read in track order afterwards */
+			struct FitResult {
+				EUTelTrack track;
+				int ierr;
+				double chi2;
+				int ndf;
+				std::vector< EUTelGBLResidual > residuals;
+			};
+
+			/** Track fitters, one per thread since they keep the state of the track being fitted */
+			std::vector< std::unique_ptr<EUTelGBLFitter> > _trackFitters;
+
+			/** GBL points of the track being fitted, one list per thread. Cleared but never freed between tracks */
+			std::vector< std::vector< gbl::GblPoint > > _pointLists;
+
+			/** Fits of the current event. Only grows, so the residual buffers are reused by the next events */
+			std::vector< FitResult > _fitResults;
+
+			/** Threads fitting the tracks of an event */
+			std::unique_ptr<EUTelWorkerPool> _workerPool;
+
 			//Function defined now for the processor////////////////////////////
 			void outputLCIO(LCEvent* evt, std::vector< EUTelTrack >& tracks);
 
 			void bookHistograms();
 
-			void plotResidual(std::map< int, std::map<float, float > >  & sensorResidual, std::map< int, std::map<float, float > >  & sensorResidualError);
+			/** Fit one track with the fitter of the given thread */
+			void fitTrack(EUTelTrack const& track, bool curved, int thread, FitResult& result);
+
+			void plotResidual(std::vector< EUTelGBLResidual > const& residuals);
 				
 //TO DO: Fix all this histogramming stuff.
 #if defined(USE_AIDA) || defined(MARLIN_USE_AIDA)
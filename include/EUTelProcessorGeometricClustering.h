@@ -13,6 +13,9 @@
 // eutelescope includes ".h"
 #include "EUTelExceptions.h"
 #include "EUTELESCOPE.h"
+#include "EUTelGeometricPixel.h"
+#include "EUTelGeometricPixelIndex.h"
+#include "EUTelGenericPixGeoDescr.h"
 
 // marlin includes ".h"
 #include "marlin/EventModifier.h"
@@ -230,6 +233,25 @@ protected:
      */
     void geometricClustering(LCEvent* evt, LCCollectionVec* pulse);
 
+    //! Set position and boundaries of a hit pixel
+    /*! The values are taken from a per sensor cache indexed by the
+     *  pixel indices. Only the first time a pixel is seen they are
+     *  computed via computePixelGeometry().
+     */
+    void setPixelGeometry(int sensorID, std::string const& planePath, geo::EUTelGenericPixGeoDescr* geoDescr,
+                          float sizeX, float sizeY, int minX, int maxX, int minY, int maxY,
+                          EUTelGeometricPixel& hitPixel);
+
+    //! Compute position and boundaries of a hit pixel from the TGeo description
+    void computePixelGeometry(int sensorID, std::string const& planePath, geo::EUTelGenericPixGeoDescr* geoDescr,
+                              float sizeX, float sizeY, EUTelGeometricPixel& hitPixel);
+
+    //! Proximity criterion of two pixels
+    /*! Two pixels touch if their boundaries (enlarged by 1%) overlap
+     *  and they pass the time cut.
+     */
+    bool pixelsTouch(EUTelGeometricPixel const& newlyAdded, EUTelGeometricPixel const& hitPixel) const;
+
     //! Input collection name for ZS data
     /*! The input collection is the calibrated data one coming from
      *  the EUTelCalibrateEventProcessor. It is, usually, called
@@ -345,7 +367,22 @@ private:
     
     //! pulse Collection 
     LCCollectionVec* _pulseCollectionVec;
-  
+
+    //! Position and boundaries of a pixel as computed from the geometry
+    struct CachedPixelGeometry {
+      CachedPixelGeometry(): valid(false), posX(0), posY(0), boundaryX(0), boundaryY(0) {}
+      bool valid;
+      float posX;
+      float posY;
+      float boundaryX;
+      float boundaryY;
+    };
+
+    //! Pixel geometry cache per sensorID, indexed by (y-minY)*nX+(x-minX)
+    std::map<int, std::vector<CachedPixelGeometry> > _pixelGeometryCache;
+
+    //! Spatial index over the hit pixels of the sensor being clustered
+    EUTelGeometricPixelIndex _pixelIndex;
 };
 
 //! A global instance of the processor
@@ -13,6 +13,8 @@
 // eutelescope includes ".h"
 #include "EUTelExceptions.h"
 #include "EUTELESCOPE.h"
+#include "EUTelTrackerDataView.h"
+#include "EUTelSparseClusterEngine.h"
 
 // marlin includes ".h"
 #include "marlin/EventModifier.h"
@@ -230,6 +232,15 @@ protected:
      */
     void sparseClustering(LCEvent* evt, LCCollectionVec* pulse);
 
+    //! Get the clustering engine of a sensor
+    /*! The engine is created on first use and its occupancy grid is
+     *  sized from the pixel index range of the sensor.
+     *
+     *  @param sensorID The sensor the engine is used for
+     *  @return The clustering engine of this sensor
+     */
+    EUTelSparseClusterEngine& getClusterEngine(int sensorID);
+
     //! Input collection name for ZS data
     /*! The input collection is the calibrated data one coming from
      *  the EUTelCalibrateEventProcessor. It is, usually, called
@@ -348,6 +359,12 @@ private:
  
     //! Squared cut value for distance in pixel index count (integer!)
     int _sparseMinDistanceSquared;
+
+    //! Reusable buffer for the decoded hit pixels of one sensor
+    EUTelSparsePixelColumns _pixelColumns;
+
+    //! Grid based clustering engine per sensorID
+    std::map<int, EUTelSparseClusterEngine> _clusterEngineMap;
 };
 
 //! A global instance of the processor
@@ -0,0 +1,108 @@
+/*
+ * File:   EUTelRadLengthTable.h
+ *
+ */
+#ifndef EUTELRADLENGTHTABLE_H
+#define	EUTELRADLENGTHTABLE_H
+
+// C++
+#include <cmath>
+#include <functional>
+#include <map>
+#include <vector>
+
+//Eigen
+#include <Eigen/Core>
+
+namespace eutelescope {
+namespace geo{
+
+/** @class EUTelRadLengthTable
+ * Tabulated material budget of the telescope as a function of the track slope.
+ *
+ * For every plane the radiation length traversed through the plane and through
+ * the gap to the next plane in z are integrated once on a grid of global slopes
+ * (dx/dz, dy/dz) and interpolated bilinearly afterwards. The material is assumed
+ * to be uniform across each plane, the same assumption the plane radiation
+ * lengths at normal incidence already make. The gap value is the integral from
+ * the centre of a plane to the z of the next plane centre minus the halves of
+ * both planes.
+ *
+ * The integration itself is passed in, so the table does not depend on TGeo.
+ */
+class EUTelRadLengthTable
+{
+  public:
+	/** Radiation length in units of X0 along the straight line between two points */
+	typedef std::function<double( Eigen::Vector3d const&, Eigen::Vector3d const& )> Integrator;
+
+	EUTelRadLengthTable();
+
+	void clear();
+
+	bool isFilled() const { return !_entries.empty(); }
+
+	/** Tabulate all planes, the vectors are in z order
+	 *
+	 * @param sensorIDs ids of the planes
+	 * @param centres global plane centres
+	 * @param normals global plane normals
+	 * @param thickness plane thickness
+	 * @param maxSlope table covers slopes in [-maxSlope, maxSlope]
+	 * @param nBins number of grid points per slope, at least 2
+	 * @param integrate exact integration
+	 */
+	void fill( std::vector<int> const& sensorIDs, std::vector<Eigen::Vector3d> const& centres,
+		   std::vector<Eigen::Vector3d> const& normals, std::vector<double> const& thickness,
+		   double maxSlope, int nBins, Integrator const& integrate );
+
+	/** Largest relative deviation of the interpolation from the exact integration,
+	 * evaluated in the middle of each grid cell where it is worst
+	 */
+	double check( Integrator const& integrate ) const;
+
+	/** True if the slopes are covered by the table */
+	bool inRange( double tx, double ty ) const { return std::abs(tx) <= _maxSlope && std::abs(ty) <= _maxSlope; }
+
+	/** X/X0 of the plane and of the gap behind it for the given global slopes */
+	double planeRadLength( int sensorID, double tx, double ty ) const;
+	double gapRadLength( int sensorID, double tx, double ty ) const;
+
+	/** Same splitting into sensor and air contributions as
+	 * EUTelGeometryTelescopeGeoDescription::findRad, from the table
+	 */
+	float findRad( std::map<int,int> const& sensorIDToZOrderWithoutExcludedPlanes, double tx, double ty,
+		       std::map<const int,double>& sensors, std::map<const int,double>& air ) const;
+
+  private:
+	struct Entry
+	{
+		int sensorID;
+		std::vector<double> plane;
+		std::vector<double> gap;
+	};
+
+	/** Exact values of one plane and its gap for the given slopes */
+	void integrate( size_t i, double tx, double ty, Integrator const& integrate, double& plane, double& gap ) const;
+
+	double interpolate( std::vector<double> const& values, double tx, double ty ) const;
+
+	Entry const& getEntry( int sensorID ) const { return _entries.at( _index.at(sensorID) ); }
+
+	/** Entries in z order */
+	std::vector<Entry> _entries;
+	std::map<int, size_t> _index;
+
+	/** Plane geometry the table was filled with */
+	std::vector<Eigen::Vector3d> _centres;
+	std::vector<Eigen::Vector3d> _normals;
+	std::vector<double> _thickness;
+
+	double _maxSlope;
+	int _nBins;
+	double _step;
+};
+
+} // namespace geo
+} // namespace eutelescope
+#endif	/* EUTELRADLENGTHTABLE_H */
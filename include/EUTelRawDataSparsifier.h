@@ -41,6 +41,9 @@ namespace eutelescope {
    *
    *  @see EUTelBaseSparsePixel
    *  @see SparsePixelType
+   *  @see EUTelCalibrateEventProcessor, which can zero suppress the
+   *  common mode corrected data in the calibration pass, without
+   *  writing the full frame.
    *
    *
    *  the calibration (mainly pedestal value) as previously saved into
@@ -0,0 +1,65 @@
+/*
+ * File:   EUTelSensorLookup.h
+ *
+ */
+#ifndef EUTELSENSORLOOKUP_H
+#define	EUTELSENSORLOOKUP_H
+
+// EUTELESCOPE
+#include "EUTelSensorTransform.h"
+
+// C++
+#include <cstddef>
+#include <vector>
+
+namespace eutelescope {
+namespace geo{
+
+/** @class EUTelSensorLookup
+ * Analytic point-in-sensor queries without TGeo navigation.
+ *
+ * Every sensor is stored as an oriented box: its cached local-to-global
+ * transformation together with the half sizes of the TGeo box. The boxes
+ * are kept as a list of slabs ordered by their lowest global z, so a
+ * query only transforms the point into the local frame of the planes
+ * whose z range contains it. The containment test is the one of
+ * TGeoBBox::Contains, a point on the surface is inside.
+ */
+class EUTelSensorLookup
+{
+  public:
+	EUTelSensorLookup();
+
+	/** Remove all sensors */
+	void clear();
+
+	/** Add a sensor box, halfSize holds the half widths along the local axes */
+	void addSensor( int sensorID, EUTelSensorTransform const& transform, const double halfSize[] );
+
+	/** Number of sensors in the lookup */
+	size_t size() const { return _slabs.size(); }
+
+	/** Id of the sensor containing the global point or -999 if there is none */
+	int findSensor( const double globalPos[] ) const;
+
+	/** Batched version for nPoints consecutive (x,y,z) triplets */
+	void findSensor( size_t nPoints, const double globalPos[], int sensorIDs[] ) const;
+
+  private:
+	struct Slab
+	{
+		double zMin, zMax;
+		int sensorID;
+		EUTelSensorTransform transform;
+		double halfSize[3];
+	};
+
+	static bool lowerZ( Slab const& a, Slab const& b ) { return a.zMin < b.zMin; }
+
+	/** Slabs ordered by zMin */
+	std::vector<Slab> _slabs;
+};
+
+} // namespace geo
+} // namespace eutelescope
+#endif	/* EUTELSENSORLOOKUP_H */
@@ -0,0 +1,92 @@
+/*
+ * File:   EUTelSensorTransform.h
+ *
+ */
+#ifndef EUTELSENSORTRANSFORM_H
+#define	EUTELSENSORTRANSFORM_H
+
+// C++
+#include <cstddef>
+
+namespace eutelescope {
+namespace geo{
+
+/** @class EUTelSensorTransform
+ * Dense local <-> global transformation of one sensor.
+ *
+ * Holds the homogeneous 4x4 matrix of the sensor node as it is used by
+ * TGeoNode::LocalToMaster, i.e. global = R*local + T. The last row is
+ * always (0,0,0,1) and therefore not stored. R is a rotation, possibly
+ * combined with a reflection, so its inverse is its transpose, exactly
+ * as TGeoHMatrix::MasterToLocal assumes.
+ *
+ * Points and vectors are passed as (x,y,z) triplets, batched arrays are
+ * nPoints consecutive triplets.
+ */
+struct EUTelSensorTransform
+{
+	/** Rotation part, row major */
+	double rot[9];
+	/** Translation part */
+	double tr[3];
+	/** False until filled from the TGeo node */
+	bool valid;
+
+	EUTelSensorTransform(): rot{1,0,0, 0,1,0, 0,0,1}, tr{0,0,0}, valid(false) {}
+
+	/** Set from a TGeo style rotation matrix (row major) and translation */
+	void set( const double rotation[], const double translation[] ) {
+		for( int i = 0; i < 9; ++i ) rot[i] = rotation[i];
+		for( int i = 0; i < 3; ++i ) tr[i] = translation[i];
+		valid = true;
+	}
+
+	inline void local2Master( const double local[], double master[] ) const {
+		double const x = local[0], y = local[1], z = local[2];
+		master[0] = tr[0] + rot[0]*x + rot[1]*y + rot[2]*z;
+		master[1] = tr[1] + rot[3]*x + rot[4]*y + rot[5]*z;
+		master[2] = tr[2] + rot[6]*x + rot[7]*y + rot[8]*z;
+	}
+
+	inline void master2Local( const double master[], double local[] ) const {
+		double const x = master[0] - tr[0], y = master[1] - tr[1], z = master[2] - tr[2];
+		local[0] = rot[0]*x + rot[3]*y + rot[6]*z;
+		local[1] = rot[1]*x + rot[4]*y + rot[7]*z;
+		local[2] = rot[2]*x + rot[5]*y + rot[8]*z;
+	}
+
+	inline void local2MasterVec( const double local[], double master[] ) const {
+		double const x = local[0], y = local[1], z = local[2];
+		master[0] = rot[0]*x + rot[1]*y + rot[2]*z;
+		master[1] = rot[3]*x + rot[4]*y + rot[5]*z;
+		master[2] = rot[6]*x + rot[7]*y + rot[8]*z;
+	}
+
+	inline void master2LocalVec( const double master[], double local[] ) const {
+		double const x = master[0], y = master[1], z = master[2];
+		local[0] = rot[0]*x + rot[3]*y + rot[6]*z;
+		local[1] = rot[1]*x + rot[4]*y + rot[7]*z;
+		local[2] = rot[2]*x + rot[5]*y + rot[8]*z;
+	}
+
+	/** Batched versions, input and output may be the same array */
+	void local2Master( std::size_t nPoints, const double local[], double master[] ) const {
+		for( std::size_t i = 0; i < 3*nPoints; i += 3 ) local2Master( local+i, master+i );
+	}
+
+	void master2Local( std::size_t nPoints, const double master[], double local[] ) const {
+		for( std::size_t i = 0; i < 3*nPoints; i += 3 ) master2Local( master+i, local+i );
+	}
+
+	void local2MasterVec( std::size_t nPoints, const double local[], double master[] ) const {
+		for( std::size_t i = 0; i < 3*nPoints; i += 3 ) local2MasterVec( local+i, master+i );
+	}
+
+	void master2LocalVec( std::size_t nPoints, const double master[], double local[] ) const {
+		for( std::size_t i = 0; i < 3*nPoints; i += 3 ) master2LocalVec( master+i, local+i );
+	}
+};
+
+} // namespace geo
+} // namespace eutelescope
+#endif	/* EUTELSENSORTRANSFORM_H */
@@ -0,0 +1,116 @@
+/*
+ *   This source code is part of the Eutelescope package of Marlin.
+ *   You are free to use this source files for your own development as
+ *   long as it stays in a public research context. You are not
+ *   allowed to use it for commercial purpose. You must put this
+ *   header with author names in all development based on this file.
+ *
+ */
+#ifndef EUTELSPARSECLUSTERENGINE_H
+#define EUTELSPARSECLUSTERENGINE_H
+
+// system includes <>
+#include <cstddef>
+#include <vector>
+
+namespace eutelescope {
+
+  //! Linear time connected component labelling of sparse pixels
+  /*! The hit pixels of one sensor are binned into an occupancy grid
+   *  which covers the pixel index range of the sensor. Every cell
+   *  holds the head of a singly linked list of the pixels fired in it,
+   *  so neighbour lookups only visit the cells within the clustering
+   *  distance instead of all the remaining pixels. The grid is
+   *  allocated once per sensor and only the cells touched in an event
+   *  are reset afterwards, hence the cost per event is proportional to
+   *  the number of fired pixels.
+   *
+   *  The output is identical to the original
+   *  EUTelProcessorSparseClustering algorithm: clusters are seeded by
+   *  the first not yet clustered pixel in input order, grown in
+   *  breadth-first order and the neighbours of each pixel are
+   *  appended in input order. Two pixels are neighbours if the squared
+   *  distance of their indices does not exceed the configured value.
+   *
+   *  \code{.cpp}
+   *  engine.setPixelIndexRange(minX, maxX, minY, maxY);
+   *  engine.setMinDistanceSquared(2);
+   *  size_t nClusters = engine.cluster(&columns.x[0], &columns.y[0], columns.size());
+   *  for(size_t i = 0; i < nClusters; ++i)
+   *    for(int const* it = engine.clusterBegin(i); it != engine.clusterEnd(i); ++it) { ... columns.x[*it] ... }
+   *  \endcode
+   */
+  class EUTelSparseClusterEngine {
+
+  public:
+    //! Default constructor
+    EUTelSparseClusterEngine();
+
+    //! Set the pixel index range of the sensor
+    /*! Used to size the occupancy grid. Pixels outside this range are
+     *  still handled, the grid is enlarged on the first occurrence.
+     */
+    void setPixelIndexRange(int minX, int maxX, int minY, int maxY);
+
+    //! Set the maximum squared distance of two neighbouring pixels
+    void setMinDistanceSquared(int distanceSquared);
+
+    //! Group the given pixels into clusters
+    /*! @param x Array of the x indices of the pixels
+     *  @param y Array of the y indices of the pixels
+     *  @param nPixel Number of pixels in the arrays
+     *  @return The number of clusters found
+     */
+    size_t cluster(short const* x, short const* y, size_t nPixel);
+
+    //! Number of clusters found in the last call to cluster()
+    size_t getNumberOfClusters() const { return _clusterStart.size() - 1; }
+
+    //! First pixel index of cluster @c i
+    int const* clusterBegin(size_t i) const { return &_clusterPixel[0] + _clusterStart[i]; }
+
+    //! One past the last pixel index of cluster @c i
+    int const* clusterEnd(size_t i) const { return &_clusterPixel[0] + _clusterStart[i+1]; }
+
+    //! Number of pixels in cluster @c i
+    size_t getClusterSize(size_t i) const { return _clusterStart[i+1] - _clusterStart[i]; }
+
+  private:
+    //! Make sure the grid covers the pixels of the current event
+    void adjustGrid(short const* x, short const* y, size_t nPixel);
+
+    //! Cell index of the pixel with the given indices
+    size_t cellIndex(int x, int y) const { return static_cast<size_t>(y - _minY)*_nX + static_cast<size_t>(x - _minX); }
+
+    int _minX;
+    int _minY;
+    int _nX;
+    int _nY;
+
+    //! Squared neighbour distance and the corresponding cell offsets
+    int _distanceSquared;
+    std::vector<int> _offsetX;
+    std::vector<int> _offsetY;
+
+    //! Occupancy grid, first pixel of each cell or -1
+    std::vector<int> _cellHead;
+
+    //! Next pixel in the same cell or -1
+    std::vector<int> _nextInCell;
+
+    //! Pixel already assigned to a cluster
+    std::vector<char> _assigned;
+
+    //! Pixel indices of all clusters, concatenated in cluster order
+    std::vector<int> _clusterPixel;
+
+    //! Start of each cluster in _clusterPixel, plus the final end
+    std::vector<size_t> _clusterStart;
+
+    //! Scratch buffer for the neighbours of one pixel
+    std::vector<int> _neighbours;
+  };
+
+} //namespace
+
+#endif
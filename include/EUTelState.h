@@ -12,6 +12,7 @@
 #endif
 #include "EUTelHit.h"
 #include "EUTelGeometryTelescopeGeoDescription.h"
+#include "EUTelNavMatrix.h"
 
 namespace eutelescope {
 
@@ -23,7 +24,7 @@ namespace eutelescope {
 			EUTelHit getHit();
 			int getDimensionSize() const ;
 			int	getLocation() const;
-			TMatrixDSym getStateCov() const;
+			Matrix5d getStateCov() const;
 			TVectorD getStateVec();
             TVector3 getMomLocal();
 			float getMomLocalX() const {return _momLocalX;}
@@ -36,10 +37,10 @@ namespace eutelescope {
 			TVector3 getPositionGlobal() const; 
 			void getCombinedHitAndStateCovMatrixInLocalFrame(double (&cov)[4]) const;
 			bool getStateHasHit() const;
-			TMatrixD getProjectionMatrix() const;
+			Eigen::Matrix2d getProjectionMatrix() const;
 			TVector3 getIncidenceUnitMomentumVectorInLocalFrame();
-			TMatrixDSym getScatteringVarianceInLocalFrame();
-			TMatrixDSym getScatteringVarianceInLocalFrame(float variance);
+			Eigen::Matrix2d getScatteringVarianceInLocalFrame();
+			Eigen::Matrix2d getScatteringVarianceInLocalFrame(float variance);
 			TVectorD getKinks() const;
 			TVectorD getKinksMedium1() const;
 			TVectorD getKinksMedium2() const;
@@ -15,6 +15,7 @@
 // eutelescope includes ".h"
 #include "EUTELESCOPE.h"
 #include "EUTelAlignmentConstant.h"
+#include "EUTelBrokenLineFit.h"
 
 #include "marlin/Processor.h"
 
@@ -392,44 +393,6 @@ namespace eutelescope {
     bool _isFirstEvent;   
         
   protected:
-    // Fitting functions
-
-    //! Find track in XZ and YZ
-    /*! Fit track in two planes (XZ and YZ) by solving two matrix
-     * equations and calculate \f$ \chi^{2} \f$
-     */
-    double MatrixFit();
-
-    //! Find track in XZ and YZ assuming nominal errors
-    /*! Fit track in two planes: XZ and YZ. When nominal position errors
-     * are used, only one matrix equation has to be solved and the
-     * inverse matrix can be applied to the second equation.
-     */
-    double SingleFit();
-
-
-    //! Find track in all planes assuming nominal errors
-    /*! Fit track in two planes: XZ and YZ. When nominal position errors
-     * are assumed and hits are found in all sensor planes, same inverse
-     * matrix can be used for all events.
-     */
-    double NominalFit();
-
-    //! Fit particle track in one plane (XZ or YZ), taking into
-    //! account beam slope
-    int DoAnalFit(double * pos, double *err, double slope=0.);
-
-    //! Calculate \f$ \chi^{2} \f$ of the fit
-    /*! Calculate \f$ \chi^{2} \f$ of the fit taking into account measured particle
-     *  positions in X and Y and fitted scattering angles in XZ and YZ
-     *  planes
-     */
-    double GetFitChi2();
-
-    //! Solve matrix equation
-    int GaussjSolve(double * alfa, double * beta, int n);
-
-
     //! Silicon planes parameters as described in GEAR
     /*! This structure actually contains the following:
      *  @li A reference to the telescope geoemtry and layout
@@ -592,12 +555,12 @@ namespace eutelescope {
     double * _fitY  ;
     double * _fitEy ;
 
-    double * _fitArray ;
-    double * _nominalFitArrayX ;
     double * _nominalErrorX ;
-    double * _nominalFitArrayY ;
     double * _nominalErrorY ;
 
+    //! Track fit of the hit selections
+    EUTelBrokenLineFit _brokenLineFit;
+
     // few counter to show the final summary
 
     //! Number of event w/o input hit
@@ -13,23 +13,20 @@ namespace eutelescope {
 
 	//default constructor
 	template<class PixelType>
-	EUTelTrackerDataInterfacerImpl<PixelType>::EUTelTrackerDataInterfacerImpl(IMPL::TrackerDataImpl* data): _trackerData(data), _nElement(), _type(), _pixelVec()
+	EUTelTrackerDataInterfacerImpl<PixelType>::EUTelTrackerDataInterfacerImpl(IMPL::TrackerDataImpl* data): _trackerData(data), _nElement(), _type()
 	{
 		auto pixel = std::make_unique<PixelType>();
 		_nElement = pixel->getNoOfElements();
 		_type = pixel->getSparsePixelType();
-		_pixelVec.clear();
-		fillPixelVec();
 	}
 
-	//the amount of pixels is the same as the ones stored in the local copy, the _pixelVec
+	//the amount of pixels follows directly from the chargeValues, no local copy is kept
 	template<class PixelType>
 	size_t EUTelTrackerDataInterfacerImpl<PixelType>::size() const
 	{
-		return _pixelVec.size();
+		return _trackerData->getChargeValues().size() / _nElement;
 	}
 
-	//the amount of pixels is the same as the ones stored in the local copy, the _pixelVec
 	template<class PixelType>
 	void EUTelTrackerDataInterfacerImpl<PixelType>::addSparsePixel(EUTelBaseSparsePixel* pixel)
 	{
@@ -0,0 +1,247 @@
+/*
+ *   This source code is part of the Eutelescope package of Marlin.
+ *   You are free to use this source files for your own development as
+ *   long as it stays in a public research context. You are not
+ *   allowed to use it for commercial purpose. You must put this
+ *   header with author names in all development based on this file.
+ *
+ */
+#ifndef EUTELTRACKERDATAVIEW_H
+#define EUTELTRACKERDATAVIEW_H
+
+// personal includes ".h"
+#include "EUTELESCOPE.h"
+#include "EUTelExceptions.h"
+#include "EUTelSimpleSparsePixel.h"
+#include "EUTelGenericSparsePixel.h"
+#include "EUTelGeometricPixel.h"
+#include "EUTelMuPixel.h"
+
+// lcio includes <.h>
+#include <LCIOTypes.h>
+#include <IMPL/TrackerDataImpl.h>
+
+// system includes <>
+#include <cstddef>
+#include <iterator>
+#include <vector>
+
+namespace eutelescope {
+
+  //! Compile time description of the sparse pixel layout
+  /*! Every sparse pixel type is stored in the TrackerData chargeValues
+   *  as a fixed number of interleaved floats. The first three of them
+   *  are always x, y and signal; all types but the simple one store
+   *  the time as fourth element.
+   */
+  template<class PixelType> struct EUTelSparsePixelLayout;
+
+  template<> struct EUTelSparsePixelLayout<EUTelSimpleSparsePixel> {
+    static const unsigned int nElement = 3;
+    static const bool hasTime = false;
+  };
+
+  template<> struct EUTelSparsePixelLayout<EUTelGenericSparsePixel> {
+    static const unsigned int nElement = 4;
+    static const bool hasTime = true;
+  };
+
+  template<> struct EUTelSparsePixelLayout<EUTelGeometricPixel> {
+    static const unsigned int nElement = 8;
+    static const bool hasTime = true;
+  };
+
+  template<> struct EUTelSparsePixelLayout<EUTelMuPixel> {
+    static const unsigned int nElement = 7;
+    static const bool hasTime = true;
+  };
+
+  //! Number of floats per pixel for a run time sparse pixel type
+  /*! Throws UnknownDataTypeException for types without a layout. */
+  inline unsigned int sparsePixelNoOfElements(SparsePixelType type) {
+    switch( type ) {
+      case kEUTelSimpleSparsePixel:  return EUTelSparsePixelLayout<EUTelSimpleSparsePixel>::nElement;
+      case kEUTelGenericSparsePixel: return EUTelSparsePixelLayout<EUTelGenericSparsePixel>::nElement;
+      case kEUTelGeometricPixel:     return EUTelSparsePixelLayout<EUTelGeometricPixel>::nElement;
+      case kEUTelMuPixel:            return EUTelSparsePixelLayout<EUTelMuPixel>::nElement;
+      default:
+        throw UnknownDataTypeException("Unknown sparsified pixel");
+    }
+  }
+
+  //! Read-only strided column over the interleaved chargeValues
+  /*! A column is one field (x, y, signal, ...) of every pixel stored
+   *  in a TrackerData. No data is copied: the column only keeps a
+   *  pointer to the first element and the distance between two
+   *  consecutive pixels. A stride of zero is used to represent a
+   *  field which is not stored for a given pixel type, in which case
+   *  every element reads as zero.
+   */
+  class EUTelStridedColumn {
+
+  public:
+    //! Random access iterator over a strided column
+    class const_iterator : public std::iterator<std::random_access_iterator_tag, float, std::ptrdiff_t, float const*, float const&> {
+    public:
+      const_iterator(): _ptr(NULL), _stride(0) {}
+      const_iterator(float const* ptr, std::ptrdiff_t stride): _ptr(ptr), _stride(stride) {}
+
+      float const& operator*() const { return *_ptr; }
+      float const& operator[](std::ptrdiff_t n) const { return *(_ptr + n*_stride); }
+
+      const_iterator& operator++() { _ptr += _stride; return *this; }
+      const_iterator operator++(int) { const_iterator tmp(*this); _ptr += _stride; return tmp; }
+      const_iterator& operator--() { _ptr -= _stride; return *this; }
+      const_iterator operator--(int) { const_iterator tmp(*this); _ptr -= _stride; return tmp; }
+      const_iterator& operator+=(std::ptrdiff_t n) { _ptr += n*_stride; return *this; }
+      const_iterator& operator-=(std::ptrdiff_t n) { _ptr -= n*_stride; return *this; }
+      const_iterator operator+(std::ptrdiff_t n) const { return const_iterator(_ptr + n*_stride, _stride); }
+      const_iterator operator-(std::ptrdiff_t n) const { return const_iterator(_ptr - n*_stride, _stride); }
+      std::ptrdiff_t operator-(const_iterator const& other) const { return _stride ? (_ptr - other._ptr)/_stride : 0; }
+
+      bool operator==(const_iterator const& other) const { return _ptr == other._ptr; }
+      bool operator!=(const_iterator const& other) const { return _ptr != other._ptr; }
+      bool operator<(const_iterator const& other) const { return _ptr < other._ptr; }
+
+    private:
+      float const* _ptr;
+      std::ptrdiff_t _stride;
+    };
+
+    EUTelStridedColumn(): _first(NULL), _size(0), _stride(0) {}
+    EUTelStridedColumn(float const* first, size_t size, size_t stride): _first(first), _size(size), _stride(stride) {}
+
+    //! Number of pixels in the column
+    size_t size() const { return _size; }
+
+    //! True if the column does not contain any pixel
+    bool empty() const { return _size == 0; }
+
+    //! Distance in floats between two consecutive pixels
+    size_t stride() const { return _stride; }
+
+    //! Value of the field for pixel @c index, no range check
+    float operator[](size_t index) const { return _first[index*_stride]; }
+
+    const_iterator begin() const { return const_iterator(_first, _stride); }
+    //! For zero stride columns begin() == end(), use size() to loop over them
+    const_iterator end() const { return const_iterator(_first + _size*_stride, _stride); }
+
+  private:
+    float const* _first;
+    size_t _size;
+    size_t _stride;
+  };
+
+  //! Caller-owned structure-of-arrays buffer for decoded pixels
+  /*! Meant to be kept as a member of a processor and reused for every
+   *  detector and every event. Decoding into it only allocates if the
+   *  capacity reached so far is not sufficient.
+   */
+  struct EUTelSparsePixelColumns {
+    std::vector<short> x;
+    std::vector<short> y;
+    std::vector<float> signal;
+    std::vector<short> time;
+
+    EUTelSparsePixelColumns(): x(), y(), signal(), time() {}
+
+    size_t size() const { return x.size(); }
+
+    void resize(size_t n) {
+      x.resize(n);
+      y.resize(n);
+      signal.resize(n);
+      time.resize(n);
+    }
+
+    void clear() {
+      x.clear();
+      y.clear();
+      signal.clear();
+      time.clear();
+    }
+  };
+
+  //! Zero-copy read-only view of the sparse pixels in a TrackerData
+  /*! In contrast to EUTelTrackerDataInterfacerImpl this view does not
+   *  construct any pixel object and does not use virtual
+   *  dispatch. It exposes the common fields of all sparse pixel types
+   *  as strided columns directly on top of the chargeValues vector,
+   *  and can decode them in bulk into caller-owned arrays.
+   *
+   *  The view is only valid as long as the chargeValues of the
+   *  underlying TrackerData are not modified.
+   *
+   *  \code{.cpp}
+   *  EUTelTrackerDataView<EUTelGenericSparsePixel> view(zsData);
+   *  view.decode(_pixelColumns);
+   *  for(size_t i = 0; i < _pixelColumns.size(); ++i) { ... _pixelColumns.x[i] ... }
+   *  \endcode
+   */
+  template<class PixelType>
+  class EUTelTrackerDataView {
+
+  public:
+    typedef EUTelSparsePixelLayout<PixelType> Layout;
+
+    //! Construct the view on the chargeValues of a TrackerData
+    explicit EUTelTrackerDataView(IMPL::TrackerDataImpl const* data):
+      EUTelTrackerDataView(data->getChargeValues()) {}
+
+    //! Construct the view on an interleaved float vector
+    explicit EUTelTrackerDataView(std::vector<float> const& chargeValues):
+      _values(chargeValues.empty() ? NULL : &chargeValues[0]), _size(chargeValues.size()/Layout::nElement) {}
+
+    //! Number of sparse pixels in the TrackerData
+    size_t size() const { return _size; }
+
+    EUTelStridedColumn x() const { return column(0); }
+    EUTelStridedColumn y() const { return column(1); }
+    EUTelStridedColumn signal() const { return column(2); }
+    //! The time column, reads as zero for pixel types without time
+    EUTelStridedColumn time() const { return Layout::hasTime ? column(3) : EUTelStridedColumn(&_zero, _size, 0); }
+
+    //! Column of an arbitrary field, @c field < Layout::nElement
+    EUTelStridedColumn column(unsigned int field) const { return EUTelStridedColumn(_size ? _values + field : NULL, _size, Layout::nElement); }
+
+    //! Single field accessors, no range check
+    short getX(size_t index) const { return static_cast<short>(_values[index*Layout::nElement]); }
+    short getY(size_t index) const { return static_cast<short>(_values[index*Layout::nElement + 1]); }
+    float getSignal(size_t index) const { return _values[index*Layout::nElement + 2]; }
+    short getTime(size_t index) const { return Layout::hasTime ? static_cast<short>(_values[index*Layout::nElement + 3]) : 0; }
+
+    //! Bulk decode into caller-owned arrays
+    /*! Each of the arrays has to hold at least size() elements. Any of
+     *  them can be NULL if the field is not needed. For pixel types
+     *  without time the time array is filled with zeros.
+     */
+    void decode(short* x, short* y, float* signal, short* time) const {
+      float const* src = _values;
+      for(size_t i = 0; i < _size; ++i, src += Layout::nElement) {
+        if(x) x[i] = static_cast<short>(src[0]);
+        if(y) y[i] = static_cast<short>(src[1]);
+        if(signal) signal[i] = src[2];
+        if(time) time[i] = Layout::hasTime ? static_cast<short>(src[3]) : 0;
+      }
+    }
+
+    //! Bulk decode into a reusable structure-of-arrays buffer
+    void decode(EUTelSparsePixelColumns& columns) const {
+      columns.resize(_size);
+      if(_size == 0) return;
+      decode(&columns.x[0], &columns.y[0], &columns.signal[0], &columns.time[0]);
+    }
+
+  private:
+    float const* _values;
+    size_t _size;
+    static float const _zero;
+  };
+
+  template<class PixelType>
+  float const EUTelTrackerDataView<PixelType>::_zero = 0.0f;
+
+} //namespace
+
+#endif
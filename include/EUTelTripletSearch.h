@@ -0,0 +1,163 @@
+/*
+ *   This source code is part of the Eutelescope package of Marlin.
+ *   You are free to use this source files for your own development as
+ *   long as it stays in a public research context. You are not
+ *   allowed to use it for commercial purpose. You must put this
+ *   header with author names in all development based on this file.
+ *
+ */
+#ifndef EUTELTRIPLETSEARCH_H
+#define EUTELTRIPLETSEARCH_H
+
+// system includes <>
+#include <cstddef>
+#include <utility>
+#include <vector>
+
+namespace eutelescope {
+
+  //! Pattern recognition with triplet seeds
+  /*! Three planes at the start of the telescope (the upstream arm) and
+   *  three at its end (the downstream arm) give seeds: every hit of the
+   *  first plane of an arm is combined with the hits of the last plane
+   *  inside the slope window, the middle plane has to have a hit close to
+   *  the straight line between them. Upstream and downstream triplets are
+   *  matched in the middle of the telescope, a matched pair is followed
+   *  through all planes with a straight line Kalman filter. On planes
+   *  outside of the arms, e.g. the DUTs, the hit closest to the prediction
+   *  is added if its chi2 is below the cut.
+   *
+   *  The hits of every plane are sorted along x and all windows are
+   *  searched by bisection, so the time grows nearly linearly with the
+   *  number of hits per plane instead of with their product.
+   *
+   *  Candidates sharing hits are resolved in favour of the one with more
+   *  hits, then the lower chi2/ndf. With less than six planes only the
+   *  upstream arm is used and the remaining planes are searched like DUTs.
+   *
+   *  This class knows nothing about LCIO, EUTelTripletTrackFinder feeds it
+   *  with the hits of an event.
+   */
+  class EUTelTripletSearch {
+
+  public:
+    //! Hit position in the global frame in mm
+    struct Hit {
+      double x;
+      double y;
+      double z;
+    };
+
+    //! A track found by search()
+    struct Track {
+      //! Index of the hit on every plane, -1 if the plane has none
+      std::vector<int> hits;
+      int nHits;
+      double chi2;
+      int ndf;
+    };
+
+    //! Default constructor, cuts are suited for a few GeV electrons
+    EUTelTripletSearch();
+
+    //! Largest track slope with respect to the z axis, used for the seed windows
+    void setMaxSlope(double maxSlope) { _maxSlope = maxSlope; }
+
+    //! Largest distance in x and y of the middle hit of a triplet to the line through the outer ones in mm
+    void setTripletCut(double cut) { _tripletCut = cut; }
+
+    //! Largest distance in x and y of upstream and downstream triplets in the middle of the telescope in mm
+    void setMatchCut(double cut) { _matchCut = cut; }
+
+    //! Largest difference of the upstream and downstream slopes
+    void setMatchSlopeCut(double cut) { _matchSlopeCut = cut; }
+
+    //! Hit resolution in mm
+    void setResolution(double resolution) { _resolution = resolution; }
+
+    //! RMS of the scattering angle at each plane
+    void setScatteringAngle(double angle) { _scatteringAngle = angle; }
+
+    //! Largest chi2 (two degrees of freedom) of a hit added on a plane outside of the arms
+    void setExtensionChi2Cut(double cut) { _extensionChi2Cut = cut; }
+
+    //! Search the tracks of one event
+    /*! @param hits Hits of every plane, planes ordered along the beam
+     */
+    void search(std::vector< std::vector<Hit> > const& hits);
+
+    //! Tracks found by the last search()
+    std::vector<Track> const& getTracks() const { return _tracks; }
+
+  private:
+    //! Hit with its index in the input, planes are sorted along x
+    struct PlaneHit {
+      double x;
+      double y;
+      double z;
+      int index;
+    };
+
+    //! Three hits of an arm and the line through them
+    struct Triplet {
+      //! Positions in the sorted planes
+      int hits[3];
+      //! Position at z of the middle hit
+      double x;
+      double y;
+      double z;
+      double tx;
+      double ty;
+    };
+
+    //! Straight line in one projection with its covariance
+    struct Line {
+      double pos;
+      double slope;
+      double c00;
+      double c01;
+      double c11;
+      void propagate(double dz);
+      double update(double measurement, double variance);
+    };
+
+    //! Hits of a plane with x in [xMin, xMax]
+    void window(int plane, double xMin, double xMax, PlaneHit const*& first, PlaneHit const*& last) const;
+
+    void findTriplets(int const arm[3], std::vector<Triplet>& triplets) const;
+
+    //! Follow a seed through all planes, downstream may be 0
+    /*! The hits of the track are positions in the sorted planes.
+     */
+    void followTrack(Triplet const& upstream, Triplet const* downstream, Track& track) const;
+
+    //! Keep the best of the candidates sharing hits
+    void resolveAmbiguities();
+
+    double _maxSlope;
+    double _tripletCut;
+    double _matchCut;
+    double _matchSlopeCut;
+    double _resolution;
+    double _scatteringAngle;
+    double _extensionChi2Cut;
+
+    int _nPlanes;
+    int _upstreamArm[3];
+    int _downstreamArm[3];
+
+    //! Buffers are kept from event to event
+    std::vector< std::vector<PlaneHit> > _planes;
+    std::vector<double> _planeZ;
+    std::vector<Triplet> _upstream;
+    std::vector<Triplet> _downstream;
+    std::vector< std::pair<double, int> > _downstreamX;
+    std::vector<Track> _candidates;
+    std::vector<size_t> _order;
+    std::vector< std::vector<char> > _usedHits;
+    std::vector<Track> _tracks;
+  };
+
+} //namespace
+
+#endif
@@ -0,0 +1,50 @@
+/*
+ *   This source code is part of the Eutelescope package of Marlin.
+ *   You are free to use this source files for your own development as
+ *   long as it stays in a public research context. You are not
+ *   allowed to use it for commercial purpose. You must put this
+ *   header with author names in all development based on this file.
+ *
+ */
+#ifndef EUTELTRIPLETTRACKFINDER_H
+#define EUTELTRIPLETTRACKFINDER_H
+
+// eutelescope includes ".h"
+#include "EUTelTrackFinder.h"
+#include "EUTelTripletSearch.h"
+
+// system includes <>
+#include <string>
+#include <vector>
+
+namespace eutelescope {
+
+    //! Track finder seeded by hit triplets
+    /*! The hits given to SetAllHits() are the hits of every plane, planes
+     *  ordered along the beam. Every track candidate holds at most one hit
+     *  per plane, in the order of the planes. The search itself is done by
+     *  EUTelTripletSearch, see there for the algorithm and its cuts.
+     */
+    class EUTelTripletTrackFinder : public EUTelTrackFinder {
+
+    public:
+        EUTelTripletTrackFinder();
+        explicit EUTelTripletTrackFinder( std::string name );
+
+        virtual ~EUTelTripletTrackFinder();
+
+        //! The search, to set its cuts
+        inline EUTelTripletSearch& GetSearch() { return _search; }
+
+    protected:
+        virtual EUTelTrackFinder::SearchResult DoTrackSearch();
+
+    private:
+        EUTelTripletSearch _search;
+
+        //! Positions of _allHits, kept between events
+        std::vector< std::vector<EUTelTripletSearch::Hit> > _hitPositions;
+    };
+
+}
+#endif
@@ -10,6 +10,7 @@
 #define EUTELUPDATEPEDESTALNOISEPROCESSOR 1
 
 // eutelescope includes ".h"
+#include "EUTelPedestalTracker.h"
 
 // marlin includes ".h"
 #include "marlin/Processor.h"
@@ -19,7 +20,8 @@
 #include <IMPL/LCCollectionVec.h>
 
 // system includes <>
-
+#include <map>
+#include <vector>
 
 
 namespace eutelescope {
@@ -62,6 +64,17 @@ namespace eutelescope {
    *  elements is kept constant to weight value. An analogous approach
    *  is used for the noise calculation.
    *
+   *  \li <b>ExponentialWeight</b>: corresponding to
+   *  EUTELESCOPE::EXPONENTIALWEIGHT. Meant for long runs with a
+   *  pedestal drift, it does not need the hit flags of the
+   *  clustering. An EUTelPedestalTracker per detector follows every
+   *  event with the same weight W, but only on the good pixels whose
+   *  signal is within HitRejectionCut sigma of their pedestal. Its
+   *  pedestal and noise are copied into the pedestal and noise
+   *  collections every UpdateFrequency events, and the drift with
+   *  respect to the starting values is printed at the same time (and
+   *  saved in histograms at the end if AIDA is available).
+   *
    *  <h4>Input collections</h4>
    *
    *  <b>Raw data collection</b> the collection with the full raw data matrix.
@@ -85,6 +98,8 @@ namespace eutelescope {
    *  @param UpdateAlgorithm name of the algorithm to be used
    *  @param UpdateFrequency update frequency in events
    *  @param FixedWeightValue the value of the fixed weight
+   *  @param HitRejectionCut SNR above which a pixel is not used by
+   *  the exponential weight algorithm
    *
    *  @author Antonio Bulgheroni, INFN <mailto:antonio.bulgheroni@gmail.com>
    *  @version $Id$
@@ -182,6 +197,22 @@ namespace eutelescope {
      */
     void fixedWeightUpdate(LCEvent * evt);
 
+    //! Exponential weight tracking
+    /*! This method is called by processEvent for every event if the
+     *  _updateAlgo has been set to EUTELESCOPE::EXPONENTIALWEIGHT.
+     *  Each detector tracker is updated with the current event, and if
+     *  @c publish is true, its snapshot is copied into the pedestal
+     *  and noise collections and its drift is recorded.
+     *
+     *  @param evt The current LCEvent event as passed by the
+     *  processEvent
+     *  @param publish Whether the snapshot has to be published
+     *
+     *  @throw IncompatibleDataSetException if the raw data and the
+     *  pedestal have a different number of pixels
+     */
+    void trackPedestal(LCEvent * evt, bool publish);
+
     //! Pixel monitoring
     /*! This method is used to collect some information about the
      *  pedestal and noise update. Updating pedestal values is of
@@ -223,6 +254,12 @@ namespace eutelescope {
      *  when using this AIDA implementation
      */
     void saveMonitoring();
+
+    //! Fill in AIDA histograms with the drift of the trackers
+    /*! The mean pedestal shift and the mean noise ratio of each
+     *  detector are saved versus the snapshot number.
+     */
+    void saveDrift();
 #endif
 
     //! Raw data collection name
@@ -297,6 +334,23 @@ namespace eutelescope {
      */
     int _fixedWeight;
 
+    //! Hit rejection threshold
+    /*! Used by the ExponentialWeight algorithm: the pixels with a
+     *  signal exceeding this value times their noise are not used for
+     *  the update.
+     */
+    float _hitRejectionCut;
+
+    //! Pedestal trackers
+    /*! One for each detector, the key is the sensorID
+     */
+    std::map< int, EUTelPedestalTracker > _trackerMap;
+
+    //! Drift history
+    /*! For each detector, the drift at each snapshot
+     */
+    std::map< int, std::vector< EUTelPedestalDrift > > _driftMap;
+
     //! Current run number.
     /*! This number is used to store the current run number
      */
@@ -14,6 +14,7 @@
 #include "EUTELESCOPE.h"
 #include "EUTelVirtualCluster.h"
 #include "EUTelTrackerDataInterfacerImpl.h"
+#include "EUTelHotPixelMask.h"
 
 // lcio includes <.h>
 #include "IMPL/TrackerHitImpl.h"
@@ -193,9 +194,9 @@ namespace eutelescope {
 	std::unique_ptr<EUTelTrackerDataInterfacer> getSparseData(IMPL::TrackerDataImpl* const data, SparsePixelType type);
 	std::unique_ptr<EUTelTrackerDataInterfacer> getSparseData(IMPL::TrackerDataImpl* const data, int type);
 
-        std::map<std::string, bool > FillHotPixelMap(EVENT::LCEvent *event, const std::string& hotPixelCollectionName);
+        EUTelHotPixelMask FillHotPixelMask(EVENT::LCEvent *event, const std::string& hotPixelCollectionName);
 
-        bool HitContainsHotPixels(const IMPL::TrackerHitImpl * hit, const std::map<std::string, bool >& hotPixelMap);
+        bool HitContainsHotPixels(const IMPL::TrackerHitImpl * hit, const EUTelHotPixelMask& hotPixelMask);
 
 		std::unique_ptr<EUTelVirtualCluster> GetClusterFromHit(const IMPL::TrackerHitImpl*);
 
@@ -0,0 +1,94 @@
+/*
+ *   This source code is part of the Eutelescope package of Marlin.
+ *   You are free to use this source files for your own development as
+ *   long as it stays in a public research context. You are not
+ *   allowed to use it for commercial purpose. You must put this
+ *   header with author names in all development based on this file.
+ *
+ */
+#ifndef EUTELWORKERPOOL_H
+#define EUTELWORKERPOOL_H
+
+// system includes <>
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <exception>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace eutelescope {
+
+  //! Threads kept alive for running many small batches of tasks
+  /*! Processors hand over the work of one event, e.g. the tracks to be
+   *  fitted, as a batch. Starting threads for every event would cost more
+   *  than the work itself, so the threads wait for the next batch instead.
+   *
+   *  The calling thread takes part in every batch as thread 0, a pool of
+   *  one thread runs the tasks in order without any synchronisation.
+   */
+  class EUTelWorkerPool {
+
+  public:
+    //! Task of a batch, called with the task index and the thread number
+    typedef std::function<void(size_t, int)> Task;
+
+    //! Starts nThreads-1 threads next to the calling one
+    explicit EUTelWorkerPool(int nThreads);
+
+    //! Stops and joins the threads
+    ~EUTelWorkerPool();
+
+    //! Number of threads including the calling one
+    int getNThreads() const { return static_cast<int>( _threads.size() ) + 1; }
+
+    //! Run task(i, thread) for all i in [0, nTasks)
+    /*! Returns when all tasks are done. Every thread number is used by one
+     *  thread at a time only, so tasks may use per thread resources
+     *  indexed by it. The first exception thrown by a task is passed on
+     *  to the caller once the batch has finished.
+     */
+    void run(size_t nTasks, Task const& task);
+
+  private:
+    EUTelWorkerPool(EUTelWorkerPool const&);
+    void operator=(EUTelWorkerPool const&);
+
+    //! Body of the pool threads
+    void work(int thread);
+
+    //! Take tasks of the current batch until none is left
+    void process(int thread);
+
+    std::vector<std::thread> _threads;
+    std::mutex _mutex;
+
+    //! Signals a new batch or the stop to the pool threads
+    std::condition_variable _start;
+
+    //! Signals the end of a batch to the caller
+    std::condition_variable _done;
+
+    Task const* _task;
+    size_t _nTasks;
+
+    //! Next task index to be taken
+    std::atomic<size_t> _next;
+
+    //! Pool threads still working on the current batch
+    int _busy;
+
+    //! Counts the batches, tells the pool threads that a new one is there
+    unsigned long _batch;
+
+    bool _stop;
+
+    //! First exception of the current batch
+    std::exception_ptr _error;
+  };
+
+} //namespace
+
+#endif
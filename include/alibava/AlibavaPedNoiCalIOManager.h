@@ -18,6 +18,7 @@
 #include <IMPL/LCCollectionVec.h>
 
 // system includes <>
+#include <map>
 #include <string>
 
 namespace alibava {
@@ -31,6 +32,13 @@ namespace alibava {
 		void createFile(std::string filename, lcio::LCRunHeaderImpl* runHeader);
 		
 		void addToFile(std::string filename, std::string collectionName, int chipnum, lcio::FloatVec datavec);
+
+		// the data vector of each chip of each collection: the key of the outer map is the collection name,
+		// the one of the inner map the chip number
+		typedef std::map< std::string, std::map< int, lcio::FloatVec > > CollectionData;
+
+		// adds all the data to the file in one go: the file is read and written only once
+		void addToFile(std::string filename, const CollectionData& data);
 		
 		lcio::FloatVec getPedNoiCalForChip(std::string filename, std::string collectionName, unsigned int chipnum);
 		
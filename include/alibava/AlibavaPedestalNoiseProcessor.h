@@ -11,6 +11,9 @@
 // alibava includes ".h"
 #include "AlibavaBaseProcessor.h"
 
+// eutelescope includes ".h"
+#include "EUTelPixelAccumulator.h"
+
 // marlin includes ".h"
 #include "marlin/Processor.h"
 
@@ -24,12 +27,29 @@
 // system includes <>
 #include <string>
 #include <list>
+#include <map>
 
 
 namespace alibava {
 	
 	//! Pedestal and noise  processor for Marlin.
-
+	/*! The pedestal and noise of each channel are calculated at the
+	 *  end of the run with the CalculationMethod:
+	 *
+	 *  \li Fit: a gaussian is fitted to the histogram of the channel.
+	 *  The fits are independent and run on NumberOfThreads threads.
+	 *
+	 *  \li Moments: the mean and RMS of each channel are accumulated
+	 *  while the events are read, with no fit at all.
+	 *
+	 *  \li TrimmedMoments: the mean and RMS of the histogram of each
+	 *  channel are iterated within TrimSigma sigma of the mean, so
+	 *  that the tails (e.g. signal) do not bias them. The RMS is
+	 *  corrected for the truncation of a gaussian.
+	 *
+	 *  The pedestal and noise collections of all the chips are written
+	 *  to the PedestalOutputFile at once.
+	 */
 	
 	class AlibavaPedestalNoiseProcessor:public alibava::AlibavaBaseProcessor   {
 		
@@ -188,6 +208,36 @@ namespace alibava {
 		 */		
 		void calculatePedestalNoise();
 
+		//! Fits a gaussian to the histogram of each channel
+		/*! The fits are run on _nThreads threads, the results are
+		 *  stored in pedestalMap and noiseMap. With more than one
+		 *  thread these fits use Minuit2, the default minimizer of the
+		 *  job is not changed.
+		 */
+		void fitPedestalNoise(std::map<int, EVENT::FloatVec> & pedestalMap, std::map<int, EVENT::FloatVec> & noiseMap);
+
+		//! Takes the pedestal and noise from the moments of each channel
+		void momentsPedestalNoise(std::map<int, EVENT::FloatVec> & pedestalMap, std::map<int, EVENT::FloatVec> & noiseMap);
+
+		//! The method used to calculate pedestal and noise
+		/*! "Fit", "Moments" or "TrimmedMoments"
+		 */
+		std::string _calculationMethod;
+
+		//! The range of the trimmed moments in sigma
+		float _trimSigma;
+
+		//! Number of threads for the fits, 0 for one per core
+		int _nThreads;
+
+		//! The running mean and variance of each channel of each chip
+		/*! Filled only for the Moments method
+		 */
+		std::map<int, eutelescope::EUTelPixelAccumulator<double> > _chanDataAccumulator;
+
+		//! The weight of each channel of each chip, 0 for the masked ones
+		std::map<int, EVENT::FloatVec> _chanWeight;
+
 		
 	};
 	
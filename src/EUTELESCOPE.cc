@@ -83,6 +83,7 @@ const char *   EUTELESCOPE::ZSDATADEFAULTENCODING    = "sensorID:7,sparsePixelTy
 const char *   EUTELESCOPE::ZSCLUSTERDEFAULTENCODING = "sensorID:7,sparsePixelType:5,quality:5";
 const char *   EUTELESCOPE::HITENCODING              = "sensorID:7,properties:7";
 const char *   EUTELESCOPE::FIXEDWEIGHT              = "FixedWeight";
+const char *   EUTELESCOPE::EXPONENTIALWEIGHT        = "ExponentialWeight";
 
 
 namespace eutelescope {
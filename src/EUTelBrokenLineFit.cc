@@ -0,0 +1,152 @@
+/*
+ *   This source code is part of the Eutelescope package of Marlin.
+ *   You are free to use this source files for your own development as
+ *   long as it stays in a public research context. You are not
+ *   allowed to use it for commercial purpose. You must put this
+ *   header with author names in all development based on this file.
+ *
+ */
+
+// eutelescope includes ".h"
+#include "EUTelBrokenLineFit.h"
+
+// system includes <>
+#include <algorithm>
+#include <cmath>
+
+namespace eutelescope {
+
+  EUTelBrokenLineFit::EUTelBrokenLineFit() : _nPlanes(0),
+                                             _diagonal(),
+                                             _upper1(),
+                                             _upper2(),
+                                             _x(),
+                                             _y(),
+                                             _firstChanged(0) { }
+
+  void EUTelBrokenLineFit::setPlanes(int nPlanes, const double * planeDist, const double * planeScat,
+                                     bool useBeamConstraint, double beamSlopeX, double beamSlopeY) {
+    _nPlanes = nPlanes;
+    _diagonal.assign( nPlanes, 0. );
+    _upper1.assign( nPlanes, 0. );
+    _upper2.assign( nPlanes, 0. );
+
+    // The kink on plane i is d(i-1)*f(i-1) - (d(i-1)+d(i))*f(i) + d(i)*f(i+1)
+    for( int ipl = 1; ipl < nPlanes - 1; ipl++ ) {
+      double const v0 = planeDist[ipl-1];
+      double const v1 = -( planeDist[ipl-1] + planeDist[ipl] );
+      double const v2 = planeDist[ipl];
+      double const scat = planeScat[ipl];
+      _diagonal[ipl-1] += scat * v0 * v0;
+      _diagonal[ipl]   += scat * v1 * v1;
+      _diagonal[ipl+1] += scat * v2 * v2;
+      _upper1[ipl-1]   += scat * v0 * v1;
+      _upper1[ipl]     += scat * v1 * v2;
+      _upper2[ipl-1]   += scat * v0 * v2;
+    }
+
+    resize( _x );
+    resize( _y );
+
+    // Slope of the first segment: d(0)*(f(1) - f(0)) - beam slope
+    if( useBeamConstraint && nPlanes > 1 ) {
+      double const scat = planeScat[0] * planeDist[0] * planeDist[0];
+      _diagonal[0] += scat;
+      _diagonal[1] += scat;
+      _upper1[0]   -= scat;
+      _x.beamRhs[0] = - beamSlopeX * planeDist[0] * planeScat[0];
+      _x.beamRhs[1] =   beamSlopeX * planeDist[0] * planeScat[0];
+      _x.beamChi2   =   beamSlopeX * beamSlopeX * planeScat[0];
+      _y.beamRhs[0] = - beamSlopeY * planeDist[0] * planeScat[0];
+      _y.beamRhs[1] =   beamSlopeY * planeDist[0] * planeScat[0];
+      _y.beamChi2   =   beamSlopeY * beamSlopeY * planeScat[0];
+    }
+    _firstChanged = 0;
+  }
+
+  void EUTelBrokenLineFit::resize(Projection & projection) {
+    projection.weight.assign( _nPlanes, 0. );
+    projection.position.assign( _nPlanes, 0. );
+    projection.beamRhs.assign( _nPlanes, 0. );
+    projection.beamChi2 = 0.;
+    projection.pivot.assign( _nPlanes, 0. );
+    projection.upper.assign( _nPlanes, 0. );
+    projection.rhs.assign( _nPlanes, 0. );
+    projection.carry.assign( 6 * _nPlanes, 0. );
+  }
+
+  void EUTelBrokenLineFit::setMeasurement(int plane, double x, double ex, double y, double ey) {
+    double const wx = ( ex > 0. ) ? 1. / ex / ex : 0.;
+    double const wy = ( ey > 0. ) ? 1. / ey / ey : 0.;
+    if( wx == _x.weight[plane] && x == _x.position[plane] &&
+        wy == _y.weight[plane] && y == _y.position[plane] ) return;
+    _x.weight[plane] = wx;
+    _x.position[plane] = x;
+    _y.weight[plane] = wy;
+    _y.position[plane] = y;
+    _firstChanged = std::min( _firstChanged, plane );
+  }
+
+  bool EUTelBrokenLineFit::eliminate(Projection & p, int plane) {
+    // Changes carried over from the elimination of the previous planes
+    double const start[6] = { 0., 0., 0., 0., 0., p.beamChi2 };
+    const double * in = ( plane > 0 ) ? &p.carry[ 6 * ( plane - 1 ) ] : start;
+
+    double const w = p.weight[plane];
+    double const m = p.position[plane];
+    double const pivot = _diagonal[plane] + w + in[0];
+    if( !( pivot > 0. ) ) return false;
+    double const u1 = _upper1[plane] + in[1];
+    double const u2 = _upper2[plane];
+    double const b = p.beamRhs[plane] + w * m + in[3];
+
+    p.pivot[plane] = pivot;
+    p.upper[plane] = u1;
+    p.rhs[plane] = b;
+
+    double * out = &p.carry[ 6 * plane ];
+    out[0] = in[2] - u1 * u1 / pivot;
+    out[1] = - u1 * u2 / pivot;
+    out[2] = - u2 * u2 / pivot;
+    out[3] = in[4] - u1 * b / pivot;
+    out[4] = - u2 * b / pivot;
+    out[5] = in[5] + w * m * m - b * b / pivot;
+    return true;
+  }
+
+  double EUTelBrokenLineFit::getChi2() {
+    if( _nPlanes == 0 ) return -1.;
+    for( ; _firstChanged < _nPlanes; _firstChanged++ ) {
+      if( !eliminate( _x, _firstChanged ) || !eliminate( _y, _firstChanged ) ) return -1.;
+    }
+    int const last = 6 * ( _nPlanes - 1 ) + 5;
+    return _x.carry[last] + _y.carry[last];
+  }
+
+  void EUTelBrokenLineFit::solve(const Projection & p, double * pos, double * err) const {
+    // Back substitution, and the diagonal of the inverse matrix from the bottom up.
+    // s11, s12, s22 are the inverse elements of the two planes after the current one.
+    double s11 = 0., s12 = 0., s22 = 0.;
+    for( int ipl = _nPlanes - 1; ipl >= 0; ipl-- ) {
+      double const f1 = ( ipl + 1 < _nPlanes ) ? pos[ipl+1] : 0.;
+      double const f2 = ( ipl + 2 < _nPlanes ) ? pos[ipl+2] : 0.;
+      pos[ipl] = ( p.rhs[ipl] - p.upper[ipl] * f1 - _upper2[ipl] * f2 ) / p.pivot[ipl];
+
+      double const l1 = p.upper[ipl] / p.pivot[ipl];
+      double const l2 = _upper2[ipl] / p.pivot[ipl];
+      double const t2 = - ( l1 * s12 + l2 * s22 );
+      double const t1 = - ( l1 * s11 + l2 * s12 );
+      double const s00 = 1. / p.pivot[ipl] - ( l1 * t1 + l2 * t2 );
+      err[ipl] = std::sqrt( s00 );
+      s22 = s11;
+      s12 = t1;
+      s11 = s00;
+    }
+  }
+
+  void EUTelBrokenLineFit::getFit(double * x, double * ex, double * y, double * ey) const {
+    solve( _x, x, ex );
+    solve( _y, y, ey );
+  }
+
+}
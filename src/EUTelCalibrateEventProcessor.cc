@@ -16,6 +16,9 @@
 #include "EUTelRunHeaderImpl.h"
 #include "EUTelEventImpl.h"
 #include "EUTelHistogramManager.h"
+#include "EUTelPixelAccumulator.h"
+#include "EUTelTrackerDataInterfacerImpl.h"
+#include "EUTelGenericSparsePixel.h"
 
 // marlin includes ".h"
 #include "marlin/Processor.h"
@@ -41,6 +44,7 @@
 #include <iostream>
 #include <iomanip>
 #include <memory>
+#include <algorithm>
 
 using namespace std;
 using namespace lcio;
@@ -114,6 +118,25 @@ EUTelCalibrateEventProcessor::EUTelCalibrateEventProcessor () :Processor("EUTelC
 
   registerProcessorParameter("HistoInfoFileName", "This is the name of the histogram information file",
                              _histoInfoFileName, string( "histoinfo.xml" ) );
+
+  // the zero suppression done in the same pass
+  registerOutputCollection (LCIO::TRACKERDATA, "SparsifiedDataCollectionName",
+                            "Name of the output zero suppressed data collection (empty to switch the zero suppression off)",
+                            _sparsifiedDataCollectionName, string(""));
+
+  vector<float > sigmaCutVecExample;
+  sigmaCutVecExample.push_back(2.5);
+  sigmaCutVecExample.push_back(2.5);
+  sigmaCutVecExample.push_back(2.5);
+  sigmaCutVecExample.push_back(2.5);
+  sigmaCutVecExample.push_back(2.5);
+
+  registerProcessorParameter("SigmaCut","A vector of float containing for each plane the multiplication factor for the noise (zero suppression only)",
+                             _sigmaCutVec, sigmaCutVecExample);
+
+  registerProcessorParameter("WriteCalibratedData",
+                             "Write the full frame calibrated data collection (false to write only the zero suppressed one)",
+                             _writeCalibratedData, static_cast<bool> (true));
 }
 
 
@@ -126,6 +149,17 @@ void EUTelCalibrateEventProcessor::init () {
     streamlog_out( WARNING2 ) << "Filling debug histograms is slowing down the procedure" << endl;
   }
 
+  if ( !_writeCalibratedData && _sparsifiedDataCollectionName.empty() ) {
+    streamlog_out( WARNING2 ) << "WriteCalibratedData is false but the zero suppression is off.\n"
+                              << "Writing the calibrated data anyway" << endl;
+    _writeCalibratedData = true;
+  }
+
+  if ( !_sparsifiedDataCollectionName.empty() && _sigmaCutVec.empty() ) {
+    streamlog_out( ERROR4 ) << "The zero suppression needs at least one SigmaCut value. Sorry for quitting." << endl;
+    exit(-1);
+  }
+
   // set to zero the run counter
   _iRun = 0;
 
@@ -428,10 +462,24 @@ void EUTelCalibrateEventProcessor::processEvent (LCEvent * event) {
 
 #endif
       }
+
+      if ( !_sparsifiedDataCollectionName.empty() && _sigmaCutVec.size() != inputCollectionVec->size() ) {
+        streamlog_out( WARNING2 ) << "The number of values in the sigma cut does not match the number of detectors\n"
+                                  << "Changing SigmaCutVec consequently." << endl;
+        _sigmaCutVec.resize( inputCollectionVec->size(), _sigmaCutVec.back() );
+      }
       _isFirstEvent = false;
     }
 
-    LCCollectionVec * correctedDataCollection = new LCCollectionVec(LCIO::TRACKERDATA);
+    const bool doSparsify = !_sparsifiedDataCollectionName.empty();
+
+    // the output collections are owned here until they are added to
+    // the event, so that a skipped event does not leak them
+    std::unique_ptr<LCCollectionVec> correctedDataCollection = std::make_unique<LCCollectionVec>(LCIO::TRACKERDATA);
+    std::unique_ptr<LCCollectionVec> sparsifiedDataCollection;
+    if ( doSparsify ) {
+      sparsifiedDataCollection = std::make_unique<LCCollectionVec>(LCIO::TRACKERDATA);
+    }
 
     _minX.clear();
     _maxX.clear();
@@ -439,15 +487,10 @@ void EUTelCalibrateEventProcessor::processEvent (LCEvent * event) {
     _maxY.clear();
 
     for (unsigned int iDetector = 0; iDetector < inputCollectionVec->size(); iDetector++) {
-      vector< float > commonModeCorVec;
-      commonModeCorVec.clear();
 
       // reset quantity for the common mode.
-      double pixelSum      = 0.;
-      double commonMode    = 0.;
-      int    goodPixel     = 0;
       int    skippedPixel  = 0;
-      int    skippedRow   = 0;
+      int    skippedRow    = 0;
 
 
       TrackerRawDataImpl  * rawData   = dynamic_cast < TrackerRawDataImpl * >(inputCollectionVec->getElementAt(iDetector));
@@ -459,8 +502,8 @@ void EUTelCalibrateEventProcessor::processEvent (LCEvent * event) {
       TrackerDataImpl     * noise     = dynamic_cast < TrackerDataImpl * >   (noiseCollectionVec->getElementAt( ancillaryPos ));
       TrackerRawDataImpl  * status    = dynamic_cast < TrackerRawDataImpl * >(statusCollectionVec->getElementAt( ancillaryPos ));
 
-      TrackerDataImpl     * corrected = new TrackerDataImpl;
-      CellIDEncoder<TrackerDataImpl> idDataEncoder(EUTELESCOPE::MATRIXDEFAULTENCODING, correctedDataCollection);
+      std::unique_ptr<TrackerDataImpl> corrected = std::make_unique<TrackerDataImpl>();
+      CellIDEncoder<TrackerDataImpl> idDataEncoder(EUTELESCOPE::MATRIXDEFAULTENCODING, correctedDataCollection.get());
       idDataEncoder["sensorID"] = sensorID;
       idDataEncoder["xMin"]     = static_cast<int > (cellDecoder(rawData)["xMin"]);
       idDataEncoder["xMax"]     = static_cast<int > (cellDecoder(rawData)["xMax"]);
@@ -471,43 +514,75 @@ void EUTelCalibrateEventProcessor::processEvent (LCEvent * event) {
       _minY.push_back( cellDecoder( rawData ) ["yMin"] ) ;
       _maxY.push_back( cellDecoder( rawData ) ["yMax"] ) ;
 
-      idDataEncoder.setCellID(corrected);
+      idDataEncoder.setCellID(corrected.get());
+
+      // the ancillary values are used in place, without copies
+      const ShortVec & adcValues   = rawData->getADCValues();
+      const FloatVec & pedestalVec = pedestal->getChargeValues();
+      const FloatVec & noiseVec    = noise->getChargeValues();
+      const ShortVec & statusVec   = status->getADCValues();
+      size_t noOfPixel             = adcValues.size();
+      size_t rowLength             = max( _maxX[iDetector] -  _minX[iDetector] + 1, 1 );
 
-      ShortVec::const_iterator rawIter     = rawData->getADCValues().begin();
-      FloatVec::const_iterator pedIter     = pedestal->getChargeValues().begin();
-      FloatVec::const_iterator noiseIter   = noise->getChargeValues().begin();
-      ShortVec::const_iterator statusIter  = status->getADCValues().begin();
+      // the full frame calibrated values are needed for the output
+      // collection and for the debug histograms only
+      bool fillCorrected = _writeCalibratedData;
+#if defined(USE_AIDA) || defined(MARLIN_USE_AIDA)
+      fillCorrected = fillCorrected || _fillDebugHisto;
+#endif
+      FloatVec & correctedValues = corrected->chargeValues();
+      if ( fillCorrected ) correctedValues.resize( noOfPixel );
+
+      // the zero suppressed pixels are written as EUTelRawDataSparsifier does
+      std::unique_ptr<TrackerDataImpl> sparsified;
+      std::unique_ptr< EUTelTrackerDataInterfacerImpl<EUTelGenericSparsePixel> > sparseData;
+      float sigmaCut = 0.;
+      if ( doSparsify ) {
+        sparsified = std::make_unique<TrackerDataImpl>();
+        CellIDEncoder<TrackerDataImpl> sparseDataEncoder(EUTELESCOPE::ZSDATADEFAULTENCODING, sparsifiedDataCollection.get());
+        sparseDataEncoder["sensorID"]        = sensorID;
+        sparseDataEncoder["sparsePixelType"] = static_cast<int> ( kEUTelGenericSparsePixel );
+        sparseDataEncoder.setCellID( sparsified.get() );
+        sparseData = std::make_unique< EUTelTrackerDataInterfacerImpl<EUTelGenericSparsePixel> >( sparsified.get() );
+        sigmaCut = _sigmaCutVec[ iDetector ];
+        _selectedPixel.resize( noOfPixel );
+        _selectedSignal.resize( noOfPixel );
+      }
 
+      // calibrate and zero suppress the pixels from first to first +
+      // length with the common mode of this group, in a single pass
+      EUTelGenericSparsePixel sparsePixel;
+      auto calibrateGroup = [&]( size_t first, size_t length, float commonMode ) {
+        size_t noOfSelected = calibrateAndSelect( length, &adcValues[first], &pedestalVec[first], &noiseVec[first], &statusVec[first],
+                                                  commonMode, sigmaCut, fillCorrected ? &correctedValues[first] : 0,
+                                                  doSparsify ? &_selectedPixel[0] : 0, doSparsify ? &_selectedSignal[0] : 0 );
+        for ( size_t iSelected = 0; iSelected < noOfSelected; ++iSelected ) {
+          size_t iPixel = first + _selectedPixel[iSelected];
+          sparsePixel.setXCoord( _minX[iDetector] + iPixel % rowLength );
+          sparsePixel.setYCoord( _minY[iDetector] + iPixel / rowLength );
+          sparsePixel.setSignal( static_cast<short> ( _selectedSignal[iSelected] ) );
+          streamlog_out ( DEBUG0 ) << sparsePixel << endl;
+          sparseData->addSparsePixel( &sparsePixel );
+        }
+      };
 
       bool isEventValid = true;
       if ( _doCommonMode == 1 ) {
 
         // FULLFRAME common mode
-        while ( rawIter != rawData->getADCValues().end() ) {
-          bool isHit   = ( ((*rawIter) - (*pedIter)) > _hitRejectionCut * (*noiseIter) );
-          bool isGood  = ( (*statusIter) == EUTELESCOPE::GOODPIXEL );
-
-          if ( !isHit && isGood ) {
-            pixelSum += (*rawIter) - (*pedIter);
-            ++goodPixel;
-          } else if ( isHit ) {
-            ++skippedPixel;
-          }
-          ++rawIter;
-          ++pedIter;
-          ++noiseIter;
-          ++statusIter;
-        }
+        EUTelCommonModeSum frame = commonModeSum( noOfPixel, &adcValues[0], &pedestalVec[0], &noiseVec[0], &statusVec[0], _hitRejectionCut );
+        skippedPixel = frame.skippedPixel;
 
         if ( ( ( _maxNoOfRejectedPixels == -1 )  ||  ( skippedPixel < _maxNoOfRejectedPixels ) ) &&
-             ( goodPixel != 0 ) ) {
+             ( frame.goodPixel != 0 ) ) {
 
-          commonMode = pixelSum / goodPixel;
+          double commonMode = frame.sum / frame.goodPixel;
 #if defined(USE_AIDA) || defined(MARLIN_USE_AIDA)
           string tempHistoName = _commonModeDistHistoName + "_d" + to_string( sensorID );
           if ( AIDA::IHistogram1D* histo = dynamic_cast<AIDA::IHistogram1D*>(_aidaHistoMap[tempHistoName]) )
             histo->fill(commonMode);
 #endif
+          calibrateGroup( 0, noOfPixel, commonMode );
 
         } else {
           isEventValid = false;
@@ -522,40 +597,19 @@ void EUTelCalibrateEventProcessor::processEvent (LCEvent * event) {
       } else if ( _doCommonMode == 2 ) {
 
         // ROWWISE common mode
-        ShortVec adcValues = rawData->getADCValues ();
-        FloatVec _pedestal     = pedestal->getChargeValues();
-        ShortVec _status  = status->getADCValues();
-        FloatVec  _noise   = noise->getChargeValues();
-        int    iPixel       = 0;
-        int    colCounter   = 0;
-        int    rowLength    = _maxX[iDetector] -  _minX[iDetector] + 1;
-
-        for (int yPixel = _minY[iDetector]; yPixel <= _maxY[iDetector]; yPixel++) {
-
-          double pixelSum           = 0.;
-          double commonMode         = 0.;
-          int    goodPixel          = 0;
-          int    skippedPixelPerRow = 0;
-
-          for ( int xPixel = _minX[iDetector]; xPixel <= _maxX[iDetector]; xPixel++) {
-            bool isHit  = ( ( adcValues[iPixel] - _pedestal[iPixel] ) > _hitRejectionCut * _noise[iPixel] );
-            bool isGood = ( _status[iPixel] == EUTELESCOPE::GOODPIXEL );
-            if ( !isHit && isGood ) {
-              pixelSum += adcValues[iPixel] - _pedestal[iPixel];
-              ++goodPixel;
-            } else if ( isHit ) {
-              ++skippedPixelPerRow;
-              ++skippedPixel;
-            }
-            ++iPixel;
-          }
+        for ( size_t first = 0; first < noOfPixel; first += rowLength ) {
+
+          size_t length = min( rowLength, noOfPixel - first );
+          EUTelCommonModeSum row = commonModeSum( length, &adcValues[first], &pedestalVec[first], &noiseVec[first], &statusVec[first],
+                                                  _hitRejectionCut );
+          skippedPixel += row.skippedPixel;
 
           // we are now at the end of the row, so let's calculate the
           // common mode
-          if ( ( skippedPixelPerRow < _maxNoOfRejectedPixelPerRow ) &&
-               ( goodPixel != 0 ) ) {
-            commonMode = pixelSum / goodPixel ;
-            commonModeCorVec.insert( commonModeCorVec.begin() + colCounter * rowLength, rowLength, commonMode );
+          double commonMode = 0.;
+          if ( ( row.skippedPixel < _maxNoOfRejectedPixelPerRow ) &&
+               ( row.goodPixel != 0 ) ) {
+            commonMode = row.sum / row.goodPixel ;
 
 #if defined(USE_AIDA) || defined(MARLIN_USE_AIDA)
             string tempHistoName = _commonModeDistHistoName + "_d" + to_string( sensorID );
@@ -563,96 +617,44 @@ void EUTelCalibrateEventProcessor::processEvent (LCEvent * event) {
               histo->fill(commonMode);
 #endif
           } else {
-            commonModeCorVec.insert( commonModeCorVec.begin() + colCounter * rowLength, rowLength, 0. );
             ++skippedRow;
           }
 
-          ++colCounter;
+          // the row is still in the cache, calibrate it right away
+          calibrateGroup( first, length, commonMode );
         }
         if ( skippedRow > _maxNoOfSkippedRow ) {
           isEventValid = false;
         }
 
-      } // end if on _doCommonMode
-
-      if(isEventValid) {
-        if(_doCommonMode == 2) {
-          ShortVec adcValues = rawData->getADCValues ();
-          FloatVec _pedestal = pedestal->getChargeValues();
-
-          int iPixel = 0;
-
-          for (int yPixel = _minY[iDetector]; yPixel <= _maxY[iDetector]; yPixel++) {
-            for ( int xPixel = _minX[iDetector]; xPixel <= _maxX[iDetector]; xPixel++) {
-
-              double correctedValue = adcValues[iPixel] - _pedestal[iPixel] - commonModeCorVec[iPixel];
-              corrected->chargeValues().push_back(correctedValue);
-
-              ++iPixel;
-#if defined(USE_AIDA) || defined(MARLIN_USE_AIDA)
-              if (_fillDebugHisto == 1) {
-                string tempHistoName = _rawDataDistHistoName + "_d" + to_string( sensorID );
-                if ( AIDA::IHistogram1D* histo = dynamic_cast<AIDA::IHistogram1D*>(_aidaHistoMap[tempHistoName]) ) {
-                  histo->fill(adcValues[iPixel]);
-                } else {
-                  streamlog_out ( ERROR1 ) << "Not able to retrieve histogram pointer for " << tempHistoName
-                                           << ".\nDisabling histogramming from now on " << endl;
-                  _fillDebugHisto = 0 ;
-                }
-
-                tempHistoName = _dataDistHistoName + "_d" + to_string( sensorID );
-                if ( AIDA::IHistogram1D * histo = dynamic_cast<AIDA::IHistogram1D*>(_aidaHistoMap[tempHistoName]) ) {
-                  histo->fill(correctedValue);
-                } else {
-                  streamlog_out ( ERROR1 ) << "Not able to retrieve histogram pointer for " << tempHistoName
-                                           << ".\nDisabling histogramming from now on " << endl;
-                  _fillDebugHisto = 0 ;
-                }
-              }
-#endif
-            }
-          }
-        } else {
-
-          // that's the case the user wants to apply the FullFrame
-          // common mode or doesn't want to apply any correction at
-          // all. In this last case the value of the commonMode
-          // variable is taken directly from the initialization ( = 0 ).
-
-          rawIter     = rawData->getADCValues().begin();
-          pedIter     = pedestal->getChargeValues().begin();
+      } else {
 
-          while ( rawIter != rawData->getADCValues().end() )  {
+        // no common mode correction at all
+        calibrateGroup( 0, noOfPixel, 0. );
 
-            double correctedValue = (*rawIter) - (*pedIter) - commonMode;
-            corrected->chargeValues().push_back(correctedValue);
+      } // end if on _doCommonMode
 
+      if(isEventValid) {
 
 #if defined(USE_AIDA) || defined(MARLIN_USE_AIDA)
-            if (_fillDebugHisto == 1) {
-              string tempHistoName = _rawDataDistHistoName + "_d" + to_string( sensorID );
-              if ( AIDA::IHistogram1D* histo = dynamic_cast<AIDA::IHistogram1D*>(_aidaHistoMap[tempHistoName]) ) {
-                histo->fill(*rawIter);
-              } else {
-                streamlog_out ( ERROR1 ) << "Not able to retrieve histogram pointer for " << tempHistoName
-                                         << ".\nDisabling histogramming from now on " << endl;
-                _fillDebugHisto = 0 ;
-              }
-
-              tempHistoName = _dataDistHistoName + "_d" + to_string( sensorID );
-              if ( AIDA::IHistogram1D * histo = dynamic_cast<AIDA::IHistogram1D*>(_aidaHistoMap[tempHistoName]) ) {
-                histo->fill(correctedValue);
-              } else {
-                streamlog_out ( ERROR1 ) << "Not able to retrieve histogram pointer for " << tempHistoName
-                                         << ".\nDisabling histogramming from now on " << endl;
-                _fillDebugHisto = 0 ;
-              }
+        if (_fillDebugHisto == 1) {
+          string rawDataHistoName = _rawDataDistHistoName + "_d" + to_string( sensorID );
+          string dataHistoName    = _dataDistHistoName + "_d" + to_string( sensorID );
+          AIDA::IHistogram1D * rawDataHisto = dynamic_cast<AIDA::IHistogram1D*>(_aidaHistoMap[rawDataHistoName]);
+          AIDA::IHistogram1D * dataHisto    = dynamic_cast<AIDA::IHistogram1D*>(_aidaHistoMap[dataHistoName]);
+          if ( rawDataHisto && dataHisto ) {
+            for ( size_t iPixel = 0; iPixel < noOfPixel; ++iPixel ) {
+              rawDataHisto->fill(adcValues[iPixel]);
+              dataHisto->fill(correctedValues[iPixel]);
             }
-#endif
-            ++rawIter;
-            ++pedIter;
+          } else {
+            streamlog_out ( ERROR1 ) << "Not able to retrieve histogram pointer for "
+                                     << ( rawDataHisto ? dataHistoName : rawDataHistoName )
+                                     << ".\nDisabling histogramming from now on " << endl;
+            _fillDebugHisto = 0 ;
           }
         }
+#endif
 
       } else {
         // this is the case the event is not valid because of common
@@ -673,9 +675,11 @@ void EUTelCalibrateEventProcessor::processEvent (LCEvent * event) {
 
 
 
-      correctedDataCollection->push_back(corrected);
+      if ( _writeCalibratedData ) correctedDataCollection->push_back( corrected.release() );
+      if ( doSparsify ) sparsifiedDataCollection->push_back( sparsified.release() );
     }
-    evt->addCollection(correctedDataCollection, _calibratedDataCollectionName);
+    if ( _writeCalibratedData ) evt->addCollection( correctedDataCollection.release(), _calibratedDataCollectionName );
+    if ( doSparsify ) evt->addCollection( sparsifiedDataCollection.release(), _sparsifiedDataCollectionName );
 
 
   } catch (DataNotAvailableException& e) {
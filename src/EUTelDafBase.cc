@@ -153,6 +153,8 @@ EUTelDafBase::EUTelDafBase(std::string name) : marlin::Processor(name) {
   registerOptionalParameter("NominalDydz", "dy/dz assumed by track finder", _nYdz, static_cast<float>(0.0f));
   registerOptionalParameter("MaxXdxDeviance", "maximum devianve for dx/dz in CKF track finder", _nXdzMaxDeviance, static_cast<float>(0.01f));
   registerOptionalParameter("MaxYdxDeviance", "maximum devianve for dy/dz in CKF track finder", _nYdzMaxDeviance, static_cast<float>(0.01f));
+  registerOptionalParameter("CKFBeamSearch", "Run the CKF track finder as a beam search instead of depth first, limits its time and memory per event at high occupancy", _ckfBeamSearch, static_cast<bool>(false));
+  registerOptionalParameter("CKFBeamWidth", "Number of track candidates with the best chi2 the CKF beam search keeps per plane", _ckfBeamWidth, static_cast<int>(256));
 
   
   //Track quality parameters
@@ -331,6 +333,9 @@ void EUTelDafBase::init() {
   } else {
 	throw std::runtime_error("DAF-Fitter: Choosen cluster finder: "+_clusterFinderName+"does not exist");
   }
+  if(_ckfBeamWidth <= 0) {
+	throw std::runtime_error("DAF-Fitter: CKFBeamWidth must be positive");
+  }
 
   //Geometry description
   _siPlanesParameters  = const_cast<gear::SiPlanesParameters* > (&(Global::GEAR->getSiPlanesParameters()));
@@ -396,7 +401,11 @@ void EUTelDafBase::init() {
  
   //Prepare track finder
   switch( _trackFinderType ) {
-	case combinatorialKF: _system.setCKFChi2Cut(_normalizedRadius*_normalizedRadius); break;
+	case combinatorialKF:
+	  _system.setCKFChi2Cut(_normalizedRadius*_normalizedRadius);
+	  _system.setCKFBeamSearch(_ckfBeamSearch);
+	  _system.setCKFBeamWidth(_ckfBeamWidth);
+	  break;
 	case simpleCluster: _system.setClusterRadius(_normalizedRadius); break;
   }
   _system.setNominalXdz(_nXdz); //What is the tangent angle of the beam? (Probably zero)
@@ -675,25 +684,25 @@ void EUTelDafBase::fillPlots(daffitter::TrackCandidate<float,4>& track){
       _aidaHistoMapProf1D[bname + "residualdYvsX"]->fill(estim.getX(), estim.getY() - meas.getY() );
       _aidaHistoMapProf1D[bname + "residualdXvsY"]->fill(estim.getY(), estim.getX() - meas.getX() );
       _aidaHistoMapProf1D[bname + "residualdYvsY"]->fill(estim.getY(), estim.getY() - meas.getY() );
-      _aidaHistoMapProf1D[bname + "residualdZvsX"]->fill(estim.getX(), plane.getMeasZ() - meas.getZ()  );
-      _aidaHistoMapProf1D[bname + "residualdZvsY"]->fill(estim.getY(), plane.getMeasZ() - meas.getZ()  );
+      _aidaHistoMapProf1D[bname + "residualdZvsX"]->fill(estim.getX(), track.measZ.at(ii) - meas.getZ()  );
+      _aidaHistoMapProf1D[bname + "residualdZvsY"]->fill(estim.getY(), track.measZ.at(ii) - meas.getZ()  );
       _aidaHistoMap2D[bname + "residualmeasZvsmeasX"]->fill(  meas.getZ()/1000., meas.getX()  );
       _aidaHistoMap2D[bname + "residualmeasZvsmeasY"]->fill(  meas.getZ()/1000., meas.getY()  );
-      _aidaHistoMap2D[bname + "residualfitZvsmeasX"]->fill( plane.getMeasZ()/1000., meas.getX() );
-      _aidaHistoMap2D[bname + "residualfitZvsmeasY"]->fill( plane.getMeasZ()/1000., meas.getY() );
+      _aidaHistoMap2D[bname + "residualfitZvsmeasX"]->fill( track.measZ.at(ii)/1000., meas.getX() );
+      _aidaHistoMap2D[bname + "residualfitZvsmeasY"]->fill( track.measZ.at(ii)/1000., meas.getY() );
  
       _aidaHistoMap2D[ "AllResidmeasZvsmeasX"]->fill(  meas.getZ()/1000., meas.getX()  );
       _aidaHistoMap2D[ "AllResidmeasZvsmeasY"]->fill(  meas.getZ()/1000., meas.getY()  );
-      _aidaHistoMap2D[ "AllResidfitZvsmeasX"]->fill( plane.getMeasZ()/1000., meas.getX() );
-      _aidaHistoMap2D[ "AllResidfitZvsmeasY"]->fill( plane.getMeasZ()/1000., meas.getY() );
+      _aidaHistoMap2D[ "AllResidfitZvsmeasX"]->fill( track.measZ.at(ii)/1000., meas.getX() );
+      _aidaHistoMap2D[ "AllResidfitZvsmeasY"]->fill( track.measZ.at(ii)/1000., meas.getY() );
       //Angles
       _aidaHistoMap[bname + "dxdz"]->fill( estim.getXdz() );
       _aidaHistoMap[bname + "dydz"]->fill( estim.getYdz() );
       if( ii != 4) { continue; }
       _aidaZvHitX->fill(estim.getX(), meas.getZ() - plane.getZpos());
-      _aidaZvFitX->fill(estim.getX(), (plane.getMeasZ() - plane.getZpos()) - (meas.getZ() - plane.getZpos()));
+      _aidaZvFitX->fill(estim.getX(), (track.measZ.at(ii) - plane.getZpos()) - (meas.getZ() - plane.getZpos()));
       _aidaZvHitY->fill(estim.getY(), meas.getZ() - plane.getZpos());
-      _aidaZvFitY->fill(estim.getY(), (plane.getMeasZ() - plane.getZpos()) - (meas.getZ() - plane.getZpos()));
+      _aidaZvFitY->fill(estim.getY(), (track.measZ.at(ii) - plane.getZpos()) - (meas.getZ() - plane.getZpos()));
     }
   }
 }
@@ -819,6 +828,9 @@ void EUTelDafBase::end() {
   streamlog_out ( MESSAGE5 ) << "Tracks with no NaNs: " << n_passedIsnan<< endl;
   streamlog_out ( MESSAGE5 ) << "Tracks with NaNs: " << n_failedIsnan<< endl;
   streamlog_out ( MESSAGE5 ) << "Number of fitted tracks: " << _nTracks << endl;
+  if( _trackFinderType == combinatorialKF ){
+    streamlog_out ( MESSAGE5 ) << "CKF branches dropped from the beam: " << _system.getCKFPrunedBranches() << endl;
+  }
   streamlog_out ( MESSAGE5 ) << "Successfully finished" << endl;
   for( size_t ii = 0; ii < _system.planes.size() ; ii++){
     daffitter::FitPlane<float>& plane = _system.planes.at(ii);
@@ -107,6 +107,7 @@ void EUTelDafFitter::dafParams(){
   //Tracker system options
   registerOptionalParameter("AddToLCIO", "Should plots be made and filled?", _addToLCIO, static_cast<bool>(true));
   registerOptionalParameter("FitDuts","Set this to true if you want DUTs to be included in the track fit", _fitDuts, static_cast<bool>(false)); 
+  registerOptionalParameter("BatchedFit","Set this to true to fit several track candidates at once with SIMD instructions. Planes tilted against the beam can give slightly different results.", _batchedFit, static_cast<bool>(false));
   //Track fitter options
   registerOutputCollection(LCIO::TRACK,"TrackCollectionName", "Collection name for fitted tracks", _trackCollectionName, string ("fittracks"));
 }
@@ -134,12 +135,15 @@ void EUTelDafFitter::dafEvent (LCEvent * event) {
     _fittrackvec->setFlag(flag.getFlag());
   }
   
+  //Fit all candidates at once
+  if(_batchedFit){ _system.fitPlanesInfoDafBatched(); }
+
   //Check found tracks
   for(size_t ii = 0; ii < _system.getNtracks(); ii++ ){
     //run track fitte
     _nCandidates++;
     //Prepare track for DAF fit
-    _system.fitPlanesInfoDaf(_system.tracks.at(ii));
+    if(not _batchedFit){ _system.fitPlanesInfoDaf(_system.tracks.at(ii)); }
     //Check resids, intime, angles
     if(not checkTrack( _system.tracks.at(ii))) { continue;};
     int inTimeHits = checkInTime(_system.tracks.at(ii));
@@ -210,7 +214,7 @@ void EUTelDafFitter::addToLCIO(daffitter::TrackCandidate<float,4>& track, LCColl
     double pos[3];
     pos[0]= estim.getX() / 1000.0;
     pos[1]= estim.getY() / 1000.0;
-    pos[2]= pl.getMeasZ() / 1000.0;
+    pos[2]= track.measZ.at(plane) / 1000.0;
 
     // overload z coordinate calculation -> important for proper sensor Identification by the hit coordinates based onthe refhit collection
     // if( fabs(pos[2] - getZfromRefHit(plane, sensorID, pos)) > 0.0002 ){
@@ -0,0 +1,103 @@
+/*
+ *   This source code is part of the Eutelescope package of Marlin.
+ *   You are free to use this source files for your own development as
+ *   long as it stays in a public research context. You are not
+ *   allowed to use it for commercial purpose. You must put this
+ *   header with author names in all development based on this file.
+ *
+ */
+
+// eutelescope includes ".h"
+#include "EUTelEUDRBDecoder.h"
+
+using namespace eutelescope;
+
+EUTelEUDRBDecoder::EUTelEUDRBDecoder():
+  _chACBitMask(0),
+  _chACRightShift(0),
+  _chBDBitMask(0),
+  _chBDRightShift(0),
+  _frameRecords(0),
+  _blockRecords(0),
+  _firstFrame(0),
+  _secondFrame(0),
+  _cds(false)
+{}
+
+bool EUTelEUDRBDecoder::configure(EUDRBFileHeader const& header, std::string const& algo)
+{
+  _chACBitMask    = header.chACBitMask;
+  _chACRightShift = header.chACRightShift;
+  _chBDBitMask    = header.chBDBitMask;
+  _chBDRightShift = header.chBDRightShift;
+  _frameRecords   = header.nXPixel * header.nYPixel * 4 /*channel*/ / 2 /*pixel per record*/;
+  _blockRecords   = header.dataSize / sizeof(int);
+  _cds            = ( algo.compare(0, 3, "CDS") == 0 );
+
+  _firstFrame  = 0;
+  _secondFrame = 0;
+  if( ( algo == "CDS32" ) || ( algo == "LF2" ) ) {
+    _firstFrame  = 1;
+    _secondFrame = 2;
+  } else if( ( algo == "CDS21" ) || ( algo == "LF1" ) ) {
+    _firstFrame  = 0;
+    _secondFrame = 1;
+  } else if( algo == "LF3" ) {
+    _firstFrame  = 2;
+    _secondFrame = 3;
+  } else {
+    return false;
+  }
+
+  // the frames read have to be inside of the data block
+  size_t const lastRecord = static_cast<size_t>( ( _secondFrame + ( _cds ? 1 : 0 ) ) * _frameRecords );
+  if( lastRecord > _blockRecords ) {
+    _secondFrame = _firstFrame;
+    return false;
+  }
+  return true;
+}
+
+size_t EUTelEUDRBDecoder::getValuesPerChannel() const
+{
+  return static_cast<size_t>( ( _secondFrame - _firstFrame ) * _frameRecords / 2 );
+}
+
+void EUTelEUDRBDecoder::decode(int const* block, std::vector<short>& channelA, std::vector<short>& channelB,
+                               std::vector<short>& channelC, std::vector<short>& channelD) const
+{
+  size_t const nValues = getValuesPerChannel();
+  channelA.reserve( channelA.size() + nValues );
+  channelB.reserve( channelB.size() + nValues );
+  channelC.reserve( channelC.size() + nValues );
+  channelD.reserve( channelD.size() + nValues );
+
+  int const* first  = block + _firstFrame * _frameRecords;
+  int const* end    = block + _secondFrame * _frameRecords;
+
+  //odd records hold channels A and B, even records channels C and D
+  if( _cds ) {
+    int const* second = first + _frameRecords;
+    for( ; first < end; first += 2, second += 2 ) {
+      short pixelA1 = static_cast< short > ( ( first[0] & _chACBitMask ) >> _chACRightShift );
+      short pixelB1 = static_cast< short > ( ( first[0] & _chBDBitMask ) >> _chBDRightShift );
+      short pixelC1 = static_cast< short > ( ( first[1] & _chACBitMask ) >> _chACRightShift );
+      short pixelD1 = static_cast< short > ( ( first[1] & _chBDBitMask ) >> _chBDRightShift );
+      short pixelA2 = static_cast< short > ( ( second[0] & _chACBitMask ) >> _chACRightShift );
+      short pixelB2 = static_cast< short > ( ( second[0] & _chBDBitMask ) >> _chBDRightShift );
+      short pixelC2 = static_cast< short > ( ( second[1] & _chACBitMask ) >> _chACRightShift );
+      short pixelD2 = static_cast< short > ( ( second[1] & _chBDBitMask ) >> _chBDRightShift );
+      channelA.push_back( pixelA2 - pixelA1 );
+      channelB.push_back( pixelB2 - pixelB1 );
+      channelC.push_back( pixelC2 - pixelC1 );
+      channelD.push_back( pixelD2 - pixelD1 );
+    }
+  } else {
+    for( ; first < end; first += 2 ) {
+      channelA.push_back( static_cast< short > ( ( first[0] & _chACBitMask ) >> _chACRightShift ) );
+      channelB.push_back( static_cast< short > ( ( first[0] & _chBDBitMask ) >> _chBDRightShift ) );
+      channelC.push_back( static_cast< short > ( ( first[1] & _chACBitMask ) >> _chACRightShift ) );
+      channelD.push_back( static_cast< short > ( ( first[1] & _chBDBitMask ) >> _chBDRightShift ) );
+    }
+  }
+}
@@ -30,6 +30,7 @@
 // #include <UTIL/LCTOOLS.h>
 
 // system includes 
+#include <cstring>
 #include <fstream>
 
 using namespace std;
@@ -45,7 +46,15 @@ namespace eutelescope {
 using namespace eutelescope;
 
 
-EUTelEUDRBReader::EUTelEUDRBReader ():DataSourceProcessor  ("EUTelEUDRBReader"), _fileHeader(NULL) {
+EUTelEUDRBReader::EUTelEUDRBReader ():DataSourceProcessor  ("EUTelEUDRBReader"),
+  _fileName(""),
+  _algo(""),
+  _useMemoryMap(false),
+  _readAheadSize(64),
+  _fileHeader(),
+  _decoder(),
+  _buffer()
+{
   
   _description =
     "Reads data files and creates LCEvent with TrackerRawData collection.\n"
@@ -56,6 +65,12 @@ EUTelEUDRBReader::EUTelEUDRBReader ():DataSourceProcessor  ("EUTelEUDRBReader"),
 
   registerProcessorParameter ("CalculationAlgorithm", "Select if you want CDS or LF",
 			      _algo, std::string("CDS"));
+
+  registerProcessorParameter ("UseMemoryMap", "Decode the events directly from the memory mapped input file, read ahead by a background thread",
+			      _useMemoryMap, static_cast<bool>(false));
+
+  registerProcessorParameter ("ReadAheadSize", "Size in MB of the input read in the background in front of the current event (memory map only)",
+			      _readAheadSize, static_cast<int>(64));
   
 }
 
@@ -69,7 +84,14 @@ void EUTelEUDRBReader::init () {
 }
 
 
-void EUTelEUDRBReader::readDataSource (int numEvents) {
+void EUTelEUDRBReader::readDataSource (int /* numEvents */) {
+
+  if ( _useMemoryMap ) readMappedFile();
+  else readStream();
+
+}
+
+void EUTelEUDRBReader::readStream () {
 
   ifstream inputFile;
   inputFile.exceptions (ifstream::failbit | ifstream::badbit );
@@ -83,62 +105,25 @@ void EUTelEUDRBReader::readDataSource (int numEvents) {
   }
   
   // read the file header
-  _fileHeader = new EUDRBFileHeader;
-
   try {
-    inputFile.read(reinterpret_cast<char*>(_fileHeader), sizeof(EUDRBFileHeader));
+    inputFile.read(reinterpret_cast<char*>(&_fileHeader), sizeof(EUDRBFileHeader));
   } catch (exception & e) {
     message<ERROR5> ( log() << "Problem reading the file header" );
     exit(-1);
   }
 
-  if (isFirstEvent() ) {
-
-    IMPL::LCRunHeaderImpl rdr      = new IMPL::LCRunHeaderImpl;
-    EUTelRunHeaderImpl * runHeader = new EUTelRunHeaderImpl(rdr)
-    runHeader->setDAQHWName( "EUDRB" );
-    runHeader->setNoOfEvent( _fileHeader->numberOfEvent + 1);
-    runHeader->setNoOfDetector( _fileHeader->numberOfDetector * 4);
-    IntVec minX, minY, maxX, maxY;
-    for (int iDetector = 0; iDetector < _fileHeader->numberOfDetector * 4; iDetector++) {
-      minX.push_back( ( _fileHeader->nXPixel ) * iDetector );
-      maxX.push_back( ( _fileHeader->nXPixel ) * iDetector +  ( _fileHeader->nXPixel - 1 ) );
-      minY.push_back( 0 );
-      maxY.push_back( _fileHeader->nYPixel - 1 );
-    }
-    runHeader->setMinX( minX );
-    runHeader->setMaxX( maxX );
-    runHeader->setMinY( minY );
-    runHeader->setMaxY( maxY );
-
-    ProcessorMgr::instance()->processRunHeader( rdr ) ;
-
-    _isFirstEvent = false;
-
-    delete runHeader;
-    delete rdr;
-
-    _buffer = new int[ _fileHeader->dataSize / sizeof(int) ];
+  if ( !_decoder.configure( _fileHeader, _algo ) ) {
+    message<WARNING> ( log() << "Unknown calculation algorithm " << _algo << ", the TrackerRawData will be empty" );
+  }
 
+  if (isFirstEvent() ) {
+    processRunHeader();
+    _buffer.resize( _fileHeader.dataSize / sizeof(int) );
   }
 
   int iEvent;
-  for ( iEvent = 0; iEvent < _fileHeader->numberOfEvent; iEvent++ ) {
+  for ( iEvent = 0; iEvent < _fileHeader.numberOfEvent; iEvent++ ) {
 
-    EUTelEventImpl     * event = new EUTelEventImpl;
-    event->setDetectorName("debug_detector");
-    event->setRunNumber(0);
-    event->setEventNumber(iEvent);
-    event->setEventType(kDE);
-    
-    LCTime * now = new LCTime;
-    event->setTimeStamp(now->timeStamp());
-    delete now;
-
-    LCCollectionVec * rawData = new LCCollectionVec (LCIO::TRACKERRAWDATA);
-    CellIDEncoder < TrackerRawDataImpl > idEncoder (EUTELESCOPE::MATRIXDEFAULTENCODING, rawData);
-    
-    
     EUDRBEventHeader eventHeader;
     try {
       inputFile.read(reinterpret_cast<char*>(&eventHeader), sizeof(eventHeader));
@@ -151,105 +136,14 @@ void EUTelEUDRBReader::readDataSource (int numEvents) {
     if ( iEvent != eventHeader.eventNumber ) {
       message<WARNING> ( log() << "Event number not corresponding " << eventHeader.eventNumber );
     }
-    event->setRunNumber(0);
-    event->setEventNumber(iEvent);
-    
     
     try {
-      inputFile.read(reinterpret_cast<char*>(_buffer), _fileHeader->dataSize );
+      inputFile.read(reinterpret_cast<char*>(&_buffer[0]), _fileHeader.dataSize );
     } catch (exception& e) {
       message<ERROR5> ( log() << "Problem reading the data block for event " << iEvent );
       exit(-1);
     }
     
-      
-    // this is made between frame 3 and frame 2
-    int frameRecordSize = _fileHeader->nXPixel * _fileHeader->nYPixel * 4 /*frame*/ / 2 /*pixel per record*/;
-    
-    TrackerRawDataImpl * channelA = new TrackerRawDataImpl;
-    idEncoder["sensorID"] = 0;
-    idEncoder["xMin"]     = 0;
-    idEncoder["xMax"]     = _fileHeader->nXPixel - 1;
-    idEncoder["yMin"]     = 0;
-    idEncoder["yMax"]     = _fileHeader->nYPixel - 1;
-    idEncoder.setCellID( channelA );
-    
-    TrackerRawDataImpl * channelB = new TrackerRawDataImpl;
-    idEncoder["sensorID"] = 1;
-    idEncoder["xMin"]     = _fileHeader->nXPixel;
-    idEncoder["xMax"]     = 2 * _fileHeader->nXPixel - 1;
-    idEncoder["yMin"]     = 0;
-    idEncoder["yMax"]     = _fileHeader->nYPixel - 1;
-    idEncoder.setCellID( channelB );
-      
-    TrackerRawDataImpl * channelC = new TrackerRawDataImpl;
-    idEncoder["sensorID"] = 2;
-    idEncoder["xMin"]     = 2 * _fileHeader->nXPixel;
-    idEncoder["xMax"]     = 3 * _fileHeader->nXPixel - 1;
-    idEncoder["yMin"]     = 0;
-    idEncoder["yMax"]     = _fileHeader->nYPixel - 1;
-    idEncoder.setCellID( channelC );
-    
-    TrackerRawDataImpl * channelD = new TrackerRawDataImpl;
-    idEncoder["sensorID"] = 3;
-    idEncoder["xMin"]     = 3 * _fileHeader->nXPixel;
-    idEncoder["xMax"]     = 4 * _fileHeader->nXPixel - 1;
-    idEncoder["yMin"]     = 0;
-    idEncoder["yMax"]     = _fileHeader->nYPixel - 1;
-    idEncoder.setCellID( channelD );
-    
-    int firstFrame = -1;
-    int secondFrame = -1;
-    if ( ( _algo == "CDS32" ) || ( _algo == "LF2") ) {
-      firstFrame  = 1;
-      secondFrame = 2;
-    } else if ( ( _algo == "CDS21" ) || ( _algo == "LF1" ) ) {
-      firstFrame  = 0;
-      secondFrame = 1;
-    } else if ( _algo == "LF3" ) {
-      firstFrame = 2;
-      secondFrame = 3;
-    } 
-    
-    for (int iRecord = firstFrame * frameRecordSize; iRecord < secondFrame * frameRecordSize; iRecord++ ) {
-      
-      short pixelA1 = static_cast< short > ( ( _buffer[iRecord] & _fileHeader->chACBitMask ) >> _fileHeader->chACRightShift ) ;
-      short pixelB1 = static_cast< short > ( ( _buffer[iRecord] & _fileHeader->chBDBitMask ) >> _fileHeader->chBDRightShift ) ;
-      if ( _algo.compare(0, 3, "CDS") == 0 ) {
-	short pixelA2 = static_cast< short > ( ( _buffer[iRecord + frameRecordSize] & _fileHeader->chACBitMask ) >> 
-					       _fileHeader->chACRightShift  );
-	short pixelB2 = static_cast< short > ( ( _buffer[iRecord + frameRecordSize] & _fileHeader->chBDBitMask ) >> 
-					       _fileHeader->chBDRightShift  );
-	channelA->adcValues().push_back( pixelA2 - pixelA1 );
-	channelB->adcValues().push_back( pixelB2 - pixelB1 );
-      } else if ( _algo.compare(0, 2, "LF") == 0 ) {
-	channelA->adcValues().push_back( pixelA1 );
-	channelB->adcValues().push_back( pixelB1 );
-      }
-
-
-      ++iRecord;      
-      short pixelC1 = static_cast< short > ( ( _buffer[iRecord] & _fileHeader->chACBitMask ) >> _fileHeader->chACRightShift ) ;
-      short pixelD1 = static_cast< short > ( ( _buffer[iRecord] & _fileHeader->chBDBitMask ) >> _fileHeader->chBDRightShift ) ;
-      if ( _algo.compare(0, 3, "CDS") == 0 ) {
-	short pixelC2 = static_cast< short > ( ( _buffer[iRecord + frameRecordSize] & _fileHeader->chACBitMask ) >> 
-					       _fileHeader->chACRightShift  );
-	short pixelD2 = static_cast< short > ( ( _buffer[iRecord + frameRecordSize] & _fileHeader->chBDBitMask ) >> 
-					       _fileHeader->chBDRightShift  );
-	channelC->adcValues().push_back( pixelC2 - pixelC1 );
-	channelD->adcValues().push_back( pixelD2 - pixelD1 );
-      } else if ( _algo.compare(0, 2, "LF" ) == 0 ) {
-	channelC->adcValues().push_back( pixelC1 );
-	channelD->adcValues().push_back( pixelD1 );
-      }
-
-    }
-    
-    rawData->push_back(channelA);
-    rawData->push_back(channelB);
-    rawData->push_back(channelC);
-    rawData->push_back(channelD);
-    
     EUDRBTrailer eventTrailer;
     try {
       inputFile.read(reinterpret_cast<char*>(&eventTrailer), sizeof(eventTrailer));
@@ -262,36 +156,159 @@ void EUTelEUDRBReader::readDataSource (int numEvents) {
       message<WARNING> ( log() << "The trailer is not correct on event " << iEvent ) ;
     }
     
-    event->addCollection(rawData, "rawdata");
-
-    ProcessorMgr::instance()->processEvent(static_cast<LCEventImpl*> (event) );
-    delete event;
+    processDataBlock( iEvent, &_buffer[0] );
 
     if ( inputFile.eof() ) break;
   }
 
-  // add the EORE event
-  EUTelEventImpl     * event = new EUTelEventImpl;
+  processEORE( iEvent );
+
+  inputFile.close();
+}
+
+void EUTelEUDRBReader::readMappedFile () {
+
+  EUTelMappedFile inputFile;
+  if ( !inputFile.open( _fileName, static_cast<size_t>( _readAheadSize ) << 20 ) ) {
+    message<ERROR5> ( log() << inputFile.getErrorMessage() << ". Exiting." );
+    exit (-1);
+  }
+
+  if ( inputFile.size() < sizeof(EUDRBFileHeader) ) {
+    message<ERROR5> ( log() << "Problem reading the file header" );
+    exit(-1);
+  }
+  memcpy( &_fileHeader, inputFile.data(), sizeof(EUDRBFileHeader) );
+
+  // the data blocks are read in place, so they have to stay aligned
+  if ( _fileHeader.dataSize < 0 || static_cast<size_t>( _fileHeader.dataSize ) % sizeof(int) != 0 ) {
+    message<ERROR5> ( log() << "Data block size " << _fileHeader.dataSize << " is not a multiple of the record size" );
+    exit(-1);
+  }
+
+  if ( !_decoder.configure( _fileHeader, _algo ) ) {
+    message<WARNING> ( log() << "Unknown calculation algorithm " << _algo << ", the TrackerRawData will be empty" );
+  }
+
+  if (isFirstEvent() ) processRunHeader();
+
+  size_t const eventSize = sizeof(EUDRBEventHeader) + _fileHeader.dataSize + sizeof(EUDRBTrailer);
+  size_t offset = sizeof(EUDRBFileHeader);
+
+  int iEvent;
+  for ( iEvent = 0; iEvent < _fileHeader.numberOfEvent; iEvent++ ) {
+
+    if ( offset + eventSize > inputFile.size() ) {
+      message<ERROR5> ( log() << "The input file ends in the middle of event " << iEvent );
+      break;
+    }
+
+    char const* eventStart = inputFile.data() + offset;
+
+    EUDRBEventHeader eventHeader;
+    memcpy( &eventHeader, eventStart, sizeof(eventHeader) );
+    
+    // check the event number consistency
+    if ( iEvent != eventHeader.eventNumber ) {
+      message<WARNING> ( log() << "Event number not corresponding " << eventHeader.eventNumber );
+    }
+
+    EUDRBTrailer eventTrailer;
+    memcpy( &eventTrailer, eventStart + sizeof(EUDRBEventHeader) + _fileHeader.dataSize, sizeof(eventTrailer) );
+    // crosscheck the trailer
+    if (eventTrailer.trailer != 0x89abcdef ) {
+      message<WARNING> ( log() << "The trailer is not correct on event " << iEvent ) ;
+    }
+
+    processDataBlock( iEvent, reinterpret_cast<int const*>( eventStart + sizeof(EUDRBEventHeader) ) );
+
+    offset += eventSize;
+    inputFile.consumed( offset );
+  }
+
+  processEORE( iEvent );
+}
+
+void EUTelEUDRBReader::processRunHeader () {
+
+  auto rdr = std::make_unique<IMPL::LCRunHeaderImpl>();
+  auto runHeader = std::make_unique<EUTelRunHeaderImpl>(rdr.get());
+  runHeader->setDAQHWName( "EUDRB" );
+  runHeader->setNoOfEvent( _fileHeader.numberOfEvent + 1);
+  runHeader->setNoOfDetector( _fileHeader.numberOfDetector * 4);
+  IntVec minX, minY, maxX, maxY;
+  for (int iDetector = 0; iDetector < _fileHeader.numberOfDetector * 4; iDetector++) {
+    minX.push_back( ( _fileHeader.nXPixel ) * iDetector );
+    maxX.push_back( ( _fileHeader.nXPixel ) * iDetector +  ( _fileHeader.nXPixel - 1 ) );
+    minY.push_back( 0 );
+    maxY.push_back( _fileHeader.nYPixel - 1 );
+  }
+  runHeader->setMinX( minX );
+  runHeader->setMaxX( maxX );
+  runHeader->setMinY( minY );
+  runHeader->setMaxY( maxY );
+
+  ProcessorMgr::instance()->processRunHeader( rdr.get() ) ;
+
+  _isFirstEvent = false;
+
+}
+
+void EUTelEUDRBReader::processDataBlock (int iEvent, int const* block) {
+
+  std::unique_ptr<EUTelEventImpl> event = std::make_unique<EUTelEventImpl>();
   event->setDetectorName("debug_detector");
   event->setRunNumber(0);
   event->setEventNumber(iEvent);
+  event->setEventType(kDE);
+  
+  LCTime now;
+  event->setTimeStamp(now.timeStamp());
+
+  LCCollectionVec * rawData = new LCCollectionVec (LCIO::TRACKERRAWDATA);
+  CellIDEncoder < TrackerRawDataImpl > idEncoder (EUTELESCOPE::MATRIXDEFAULTENCODING, rawData);
+
+  TrackerRawDataImpl * channel[4];
+  for ( int iChannel = 0; iChannel < 4; iChannel++ ) {
+    channel[iChannel] = new TrackerRawDataImpl;
+    idEncoder["sensorID"] = iChannel;
+    idEncoder["xMin"]     = iChannel * _fileHeader.nXPixel;
+    idEncoder["xMax"]     = ( iChannel + 1 ) * _fileHeader.nXPixel - 1;
+    idEncoder["yMin"]     = 0;
+    idEncoder["yMax"]     = _fileHeader.nYPixel - 1;
+    idEncoder.setCellID( channel[iChannel] );
+  }
+
+  // straight from the data block into the output
+  _decoder.decode( block, channel[0]->adcValues(), channel[1]->adcValues(), channel[2]->adcValues(), channel[3]->adcValues() );
+
+  for ( int iChannel = 0; iChannel < 4; iChannel++ ) rawData->push_back( channel[iChannel] );
+
+  event->addCollection(rawData, "rawdata");
+
+  ProcessorMgr::instance()->processEvent(static_cast<LCEventImpl*> (event.get()) );
+
+}
+
+void EUTelEUDRBReader::processEORE (int iEvent) {
+
+  // add the EORE event
+  std::unique_ptr<EUTelEventImpl> event = std::make_unique<EUTelEventImpl>();
+  event->setDetectorName("debug_detector");
   event->setEventType(kEORE);
-  LCTime * now = new LCTime;
-  event->setTimeStamp(now->timeStamp());
-  delete now;
+  LCTime now;
+  event->setTimeStamp(now.timeStamp());
   event->setRunNumber(0);
   event->setEventNumber(iEvent + 1);
 
-  ProcessorMgr::instance()->processEvent(static_cast<LCEventImpl*> (event) );
-  delete event;
+  ProcessorMgr::instance()->processEvent(static_cast<LCEventImpl*> (event.get()) );
 
-  inputFile.close();
 }
 
 
 void EUTelEUDRBReader::end () {
 
-  delete [] _buffer;
+  _buffer.clear();
   message<MESSAGE5> ( "Successfully finished" );
 
 }
@@ -0,0 +1,93 @@
+/*
+ *   This source code is part of the Eutelescope package of Marlin.
+ *   You are free to use this source files for your own development as
+ *   long as it stays in a public research context. You are not
+ *   allowed to use it for commercial purpose. You must put this
+ *   header with author names in all development based on this file.
+ *
+ */
+
+// eutelescope includes ".h"
+#include "EUTelFrameBuffer.h"
+
+// system includes <>
+#include <cerrno>
+#include <cstring>
+
+using namespace eutelescope;
+
+EUTelFrameBuffer::EUTelFrameBuffer():
+  _frameSize(0),
+  _maxInMemory(0),
+  _nInMemory(0),
+  _memory(),
+  _eventNumbers(),
+  _spillFileName(),
+  _spill(0),
+  _mapped(),
+  _errorMessage()
+{
+}
+
+EUTelFrameBuffer::~EUTelFrameBuffer()
+{
+  close();
+}
+
+void EUTelFrameBuffer::open(size_t frameSize, size_t maxMemory, std::string const& spillFileName)
+{
+  close();
+  _frameSize = frameSize;
+  _maxInMemory = ( frameSize > 0 ) ? maxMemory / ( frameSize * sizeof( short ) ) : 0;
+  _spillFileName = spillFileName;
+  _errorMessage.clear();
+}
+
+bool EUTelFrameBuffer::append(short const* adcValues, int eventNumber)
+{
+  if( _nInMemory < _maxInMemory && getNSpilled() == 0 ) {
+    _memory.insert( _memory.end(), adcValues, adcValues + _frameSize );
+    ++_nInMemory;
+  } else {
+    if( !_spill ) {
+      _spill = fopen( _spillFileName.c_str(), "wb" );
+      if( !_spill ) {
+        _errorMessage = "Cannot open " + _spillFileName + ": " + strerror( errno );
+        return false;
+      }
+    }
+    if( fwrite( adcValues, sizeof( short ), _frameSize, _spill ) != _frameSize ) {
+      _errorMessage = "Cannot write " + _spillFileName + ": " + strerror( errno );
+      return false;
+    }
+  }
+  _eventNumbers.push_back( eventNumber );
+  return true;
+}
+
+bool EUTelFrameBuffer::finish()
+{
+  if( !_spill ) return true;
+  bool const written = fclose( _spill ) == 0;
+  _spill = 0;
+  if( !written ) {
+    _errorMessage = "Cannot write " + _spillFileName;
+    return false;
+  }
+  if( !_mapped.open( _spillFileName ) ) {
+    _errorMessage = _mapped.getErrorMessage();
+    return false;
+  }
+  return true;
+}
+
+void EUTelFrameBuffer::close()
+{
+  _mapped.close();
+  if( _spill ) fclose( _spill );
+  if( _spill || getNSpilled() > 0 ) remove( _spillFileName.c_str() );
+  _spill = 0;
+  _nInMemory = 0;
+  std::vector<short>().swap( _memory );
+  _eventNumbers.clear();
+}
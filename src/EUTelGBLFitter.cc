@@ -85,19 +85,19 @@ namespace eutelescope {
 	//Note that we take the planes themselfs at scatters and also add scatterers to simulate the medium inbetween. 
 	void EUTelGBLFitter::setScattererGBL(gbl::GblPoint& point, EUTelState & state ) {
 		streamlog_out(DEBUG1) << " setScattererGBL ------------- BEGIN --------------  " << std::endl;
-		TMatrixDSym precisionMatrix =  state.getScatteringVarianceInLocalFrame();
+		Eigen::Matrix2d precisionMatrix =  state.getScatteringVarianceInLocalFrame();
 		streamlog_out(MESSAGE1) << "The precision matrix being used for the sensor  "<<state.getLocation()<<":" << std::endl;
-		streamlog_message( DEBUG0, precisionMatrix.Print();, std::endl; );
-		point.addScatterer(state.getKinks(), precisionMatrix);
+		streamlog_out(DEBUG0) << precisionMatrix << std::endl;
+		point.addScatterer(state.getKinks(), Utility::toTMatrixDSym(precisionMatrix));
 		streamlog_out(DEBUG1) << "  setScattererGBL  ------------- END ----------------- " << std::endl;
 	}
 		//This is used when the we know the radiation length already
 		void EUTelGBLFitter::setScattererGBL(gbl::GblPoint& point,EUTelState & state, float variance,TVectorD scat ) {
 		streamlog_out(MESSAGE1) << " setScattererGBL ------------- BEGIN --------------  " << std::endl;
-		TMatrixDSym precisionMatrix =  state.getScatteringVarianceInLocalFrame(variance);
+		Eigen::Matrix2d precisionMatrix =  state.getScatteringVarianceInLocalFrame(variance);
 		streamlog_out(MESSAGE1) << "The precision matrix being used for the scatter:  " << std::endl;
-		streamlog_message( DEBUG0, precisionMatrix.Print();, std::endl; );
-		point.addScatterer(scat, precisionMatrix);
+		streamlog_out(DEBUG0) << precisionMatrix << std::endl;
+		point.addScatterer(scat, Utility::toTMatrixDSym(precisionMatrix));
 		streamlog_out(MESSAGE1) << "  setScattererGBL  ------------- END ----------------- " << std::endl;
 	}
 	void EUTelGBLFitter::setLocalDerivativesToPoint(gbl::GblPoint& point, float distanceFromKinkTargetToNextPlane){
@@ -110,7 +110,7 @@ namespace eutelescope {
 	}
 	//This will add measurement information to the GBL point
 	//Note that if we have a strip sensor then y will be ignored using projection matrix.
-	void EUTelGBLFitter::setMeasurementGBL(gbl::GblPoint& point, const double *hitPos,  double statePos[3], double combinedCov[4], TMatrixD projection){
+	void EUTelGBLFitter::setMeasurementGBL(gbl::GblPoint& point, const double *hitPos,  double statePos[3], double combinedCov[4], Eigen::Matrix2d const& projection){
 		streamlog_out(DEBUG1) << " setMeasurementGBL ------------- BEGIN --------------- " << std::endl;
 		TVectorD meas(2);//Remember we need to pass the same 5 since gbl expects this due to jacobian
 		meas.Zero();
@@ -125,9 +125,9 @@ namespace eutelescope {
 		streamlog_out(DEBUG4) << "X:" << std::setw(20) << meas[0] << std::setw(20) << measPrec[0] <<"," << std::endl;
 		streamlog_out(DEBUG4) << "Y:" << std::setw(20) << meas[1] << std::setw(20)  <<"," << measPrec[1] << std::endl;
 		streamlog_out(DEBUG4) << "This H matrix:" << std::endl;
-		streamlog_message( DEBUG0, projection.Print();, std::endl; );
+		streamlog_out(DEBUG0) << projection << std::endl;
 		//The gbl library creates 5 measurement vector and 5x5 propagation matrix automatically. If  
-		point.addMeasurement(projection, meas, measPrec, 0);//The last zero is the minimum precision before this is set to 0. TO DO:Remove this magic number
+		point.addMeasurement(Utility::toTMatrixD(projection), meas, measPrec, 0);//The last zero is the minimum precision before this is set to 0. TO DO:Remove this magic number
 		streamlog_out(DEBUG1) << " setMeasurementsGBL ------------- END ----------------- " << std::endl;
 	}
 
@@ -182,7 +182,7 @@ namespace eutelescope {
 		}
         TVectorD kinksMedium[2] = {state.getKinksMedium1(),state.getKinksMedium2()};
 		for(size_t i = 0 ;i < _scattererJacobians.size()-1;++i){//The last jacobain is used to get to the plane! So only loop over to (_scatterJacobians-1)
-			gbl::GblPoint point(_scattererJacobians[i]);
+			gbl::GblPoint point(Utility::toTMatrixD(_scattererJacobians[i]));
 			point.setLabel(_counter_num_pointer);
 			_counter_num_pointer++;
 			if(variance.at(i) == 0){
@@ -308,16 +308,15 @@ namespace eutelescope {
 	// This is done using the geometry setup, the scattering and the hits + predicted states.
 	void EUTelGBLFitter::setInformationForGBLPointList(EUTelTrack& track, std::vector< gbl::GblPoint >& pointList){
 		streamlog_out(DEBUG4)<<"EUTelGBLFitter::setInformationForGBLPointList-------------------------------------BEGIN"<<std::endl;
-		TMatrixD jacPointToPoint(5, 5);
-		jacPointToPoint.UnitMatrix();
+		Matrix5d jacPointToPoint = Matrix5d::Identity();
 		//We place this variable here since we want to set it every new track to false and then true again after we get to the scattering plane.
 		bool kinkAnglePlaneEstimationAddedNow=false;
 		float distanceFromKinkTargetToNextPlane=0;
 //		float totVar = track.getTotalVariance(); 
 		for(size_t i=0;i < track.getStates().size(); i++){		
 			streamlog_out(DEBUG3) << "The jacobian to get to this state jacobian on state number: " << i<<" Out of a total of states "<<track.getStates().size() << std::endl;
-			streamlog_message( DEBUG0, jacPointToPoint.Print();, std::endl; );
-			gbl::GblPoint point(jacPointToPoint);
+			streamlog_out(DEBUG0) << jacPointToPoint << std::endl;
+			gbl::GblPoint point(Utility::toTMatrixD(jacPointToPoint));
 			EUTelState state = track.getStates().at(i);
 			EUTelState nextState;
 			if(i != (track.getStates().size()-1)){//Since we don't want to propagate from the last state.
@@ -365,7 +364,7 @@ namespace eutelescope {
 	}
 
 	//THIS IS THE GETTERS
-	gbl::GblPoint EUTelGBLFitter::getLabelToPoint(std::vector<gbl::GblPoint> & pointList, unsigned int label)
+	gbl::GblPoint const& EUTelGBLFitter::getLabelToPoint(std::vector<gbl::GblPoint> const& pointList, unsigned int label)
 	{
 		for(size_t i = 0; i< pointList.size();++i)
 		{
@@ -378,8 +377,9 @@ namespace eutelescope {
 		//if no match after loop this label must belong to no point 
 		throw(lcio::Exception("There is no point with this label"));
 	}
-	//This used after trackfit will fill a map between (sensor ID and residualx/y). 
-  void EUTelGBLFitter::getResidualOfTrackandHits(gbl::GblTrajectory* traj, std::vector< gbl::GblPoint > pointList,EUTelTrack& track, std::map< int, std::map< float, float > > &  SensorResidual, std::map< int, std::map< float, float > >& sensorResidualError){
+	//This used after trackfit will fill the residuals x/y of every sensor with a hit. 
+  void EUTelGBLFitter::getResidualOfTrackandHits(gbl::GblTrajectory* traj, std::vector< gbl::GblPoint > const& pointList,EUTelTrack& track, std::vector< EUTelGBLResidual >& residuals){
+	       size_t const firstResidual = residuals.size();
 	  
 	       for(size_t j=0 ; j< _vectorOfPairsMeasurementStatesAndLabels.size();j++){
 			EUTelState state = _vectorOfPairsMeasurementStatesAndLabels.at(j).first;
@@ -395,12 +395,14 @@ namespace eutelescope {
 			streamlog_out(DEBUG0)<<"To get residual of states we use label: "<<_vectorOfPairsMeasurementStatesAndLabels.at(j).second<<std::endl; 
 			traj->getMeasResults(_vectorOfPairsMeasurementStatesAndLabels.at(j).second, numData, aResiduals, aMeasErrors, aResErrors, aDownWeights);
 			streamlog_out(DEBUG0) <<"State location: "<<state.getLocation()<<" The residual x " <<aResiduals[0]<<" The residual y " <<aResiduals[1]<<std::endl;
-			std::map<float, float> res; //This is create on the stack but will pass thisa by value to the new map so it 
-			res.insert(std::make_pair(aResiduals[0],aResiduals[1]));
-			SensorResidual.insert(std::make_pair(state.getLocation(), res));		
-			std::map<float, float> resError; //This is create on the stack but will pass thisa by value to the new map so it 
-			resError.insert(std::make_pair(aResErrors[0],aResErrors[1]));
-			sensorResidualError.insert(std::make_pair(state.getLocation(), resError));	
+			bool locationFilled = false;
+			for(size_t k = firstResidual; k < residuals.size(); ++k){
+				if(residuals[k].location == state.getLocation()) locationFilled = true;
+			}
+			if(!locationFilled){
+				EUTelGBLResidual residual = { state.getLocation(), static_cast<float>(aResiduals[0]), static_cast<float>(aResiduals[1]), static_cast<float>(aResErrors[0]), static_cast<float>(aResErrors[1]) };
+				residuals.push_back(residual);
+			}
 		}
 	}
 	std::string EUTelGBLFitter::getMEstimatorType( ) const {
@@ -471,11 +473,11 @@ namespace eutelescope {
      * \return Jacobain 5x5  from scatter->plane 
      */
 
-	TMatrixD EUTelGBLFitter::findScattersJacobians(EUTelState state, EUTelState nextState){
+	Matrix5d EUTelGBLFitter::findScattersJacobians(EUTelState state, EUTelState nextState){
 		streamlog_out(DEBUG1) << "CREATE JACOBIAN LINKS: Plane->scatter->scatter->plane  " << std::endl;
 
         double min = 1e-4;
-		_scattererJacobians.clear();
+		_scattererJacobians.clear();//Keeps the capacity, no allocation after the first track
 		TVector3 momStart = state.getMomGlobal();
 		TVector3 momEnd;
 		int locationStart = state.getLocation();
@@ -484,7 +486,7 @@ namespace eutelescope {
 		for(size_t i=0;i<_scattererPositions.size();i++){
 			momEnd = EUTelNav::getMomentumfromArcLength(momStart,charge, _scattererPositions[i]);
             //Input in global and linked to local internally. Output jacobian Local to local link. 
-            TMatrixD jac = getFullJacobian(momStart,momEnd,locationStart,locationEnd, _scattererPositions[i],min);
+            Matrix5d jac = getFullJacobian(momStart,momEnd,locationStart,locationEnd, _scattererPositions[i],min);
 			_scattererJacobians.push_back(jac);
 			momStart[0]=momEnd[0]; momStart[1]=momEnd[1];	momStart[2]=momEnd[2];
 			if(i == (_scattererPositions.size()-2)){//On the last loop we want to create the jacobain to the next plane
@@ -506,28 +508,25 @@ namespace eutelescope {
      * \return 5x5 Jacobian which links two GBL points or states in EUTelescope speak.
      */
 
-    TMatrixD EUTelGBLFitter::getFullJacobian(TVector3 momStart, TVector3 momEnd, int locationStart, int locationEnd, double distance, double min ){
+    Matrix5d EUTelGBLFitter::getFullJacobian(TVector3 momStart, TVector3 momEnd, int locationStart, int locationEnd, double distance, double min ){
             streamlog_out(DEBUG1) <<"CREATE JACOBIAN WITH THE FOLLOWING PROPERTIES  " << std::endl;
             streamlog_out(DEBUG1) <<"Intital momentum (Global) "<<momStart[0]<<","<<momStart[1]<<","<<momStart[2] <<" Final momentum "  <<momEnd[0]<<","<<momEnd[1]<<","<<momEnd[2]<< std::endl;
             streamlog_out(DEBUG1) <<"Local Systems are defined via the sensors "<< locationStart <<" " <<locationEnd << std::endl;
             streamlog_out(DEBUG1) <<"Distance between states "<<distance << std::endl;
             streamlog_out(DEBUG1) <<"Minimum value of jacobian accepted "<<min << std::endl;
 
-        TMatrixD simpleJacobian = EUTelNav::getPropagationJacobianGlobalToGlobal(distance, momStart.Unit());
+        const Matrix5d simpleJacobian = EUTelNav::getPropagationJacobianGlobalToGlobal(distance, momStart.Unit());
         TVector3 momStartLocal = transVecGlobalToLocal(momStart, locationStart);
-        TMatrixD localToGlobalJacobianStart =  EUTelNav::getMeasToGlobal(momStartLocal, locationStart);
+        const Matrix5d localToGlobalJacobianStart =  EUTelNav::getMeasToGlobal(momStartLocal, locationStart);
         TVector3 momEndLocal = transVecGlobalToLocal(momEnd, locationEnd);
-        TMatrixD localToGlobalJacobianEnd =  EUTelNav::getMeasToGlobal(momEndLocal,locationEnd );
+        const Matrix5d localToGlobalJacobianEnd =  EUTelNav::getMeasToGlobal(momEndLocal,locationEnd );
         streamlog_out( DEBUG0 ) << "Invert local matrix... " << std::endl;
-        TMatrixD globalToLocalJacobianEnd = localToGlobalJacobianEnd.Invert();
-        streamlog_out( DEBUG0 ) << "Global to local: " << std::endl;
-        streamlog_message( DEBUG0, globalToLocalJacobianEnd.Print();, std::endl; );
-        TMatrixD localToNextLocalJacobian = globalToLocalJacobianEnd*simpleJacobian*localToGlobalJacobianStart;
-        streamlog_out(DEBUG1) <<"Jacobian before min derivative removal: " << std::endl;
-        streamlog_message( DEBUG1, localToNextLocalJacobian.Print();, std::endl; );
-        localToNextLocalJacobian = Utility::setPrecision(localToNextLocalJacobian ,min);
-        streamlog_out(DEBUG1) <<"OUTPUT JACOBAIN  " <<locationStart<<"->"<<locationEnd <<":"  << std::endl;
-        streamlog_message( DEBUG1, localToNextLocalJacobian.Print();, std::endl; );
+        const Matrix5d globalToLocalJacobianEnd = localToGlobalJacobianEnd.inverse();
+        streamlog_out( DEBUG0 ) << "Global to local: " << std::endl << globalToLocalJacobianEnd << std::endl;
+        Matrix5d localToNextLocalJacobian = globalToLocalJacobianEnd*simpleJacobian*localToGlobalJacobianStart;
+        streamlog_out(DEBUG1) <<"Jacobian before min derivative removal: " << std::endl << localToNextLocalJacobian << std::endl;
+        EUTelNavMatrix::setPrecision(localToNextLocalJacobian ,min);
+        streamlog_out(DEBUG1) <<"OUTPUT JACOBAIN  " <<locationStart<<"->"<<locationEnd <<":"  << std::endl << localToNextLocalJacobian << std::endl;
         return localToNextLocalJacobian;
     }
     TVector3 EUTelGBLFitter::transVecGlobalToLocal(TVector3 input, int location){
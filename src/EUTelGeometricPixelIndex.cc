@@ -0,0 +1,106 @@
+/*
+ *   This source code is part of the Eutelescope package of Marlin.
+ *   You are free to use this source files for your own development as
+ *   long as it stays in a public research context. You are not
+ *   allowed to use it for commercial purpose. You must put this
+ *   header with author names in all development based on this file.
+ *
+ */
+
+// eutelescope includes ".h"
+#include "EUTelGeometricPixelIndex.h"
+
+// system includes <>
+#include <algorithm>
+#include <cmath>
+
+using namespace eutelescope;
+
+const double EUTelGeometricPixelIndex::_cellMargin = 1.0001;
+
+EUTelGeometricPixelIndex::EUTelGeometricPixelIndex():
+  _originX(0),
+  _originY(0),
+  _cellX(1),
+  _cellY(1),
+  _nX(0),
+  _nY(0),
+  _cellHead(),
+  _nextInCell(),
+  _cellXOfPixel(),
+  _cellYOfPixel()
+{}
+
+void EUTelGeometricPixelIndex::build(std::vector<EUTelGeometricPixel> const& pixels)
+{
+  size_t const nPixel = pixels.size();
+  _nextInCell.assign( nPixel, -1 );
+  _cellXOfPixel.resize( nPixel );
+  _cellYOfPixel.resize( nPixel );
+  _nX = _nY = 0;
+  if( nPixel == 0 ) return;
+
+  double minX = pixels[0].getPosX(), maxX = minX;
+  double minY = pixels[0].getPosY(), maxY = minY;
+  double maxBoundX = 0, maxBoundY = 0;
+  for( size_t i = 0; i < nPixel; ++i )
+  {
+    minX = std::min<double>( minX, pixels[i].getPosX() );
+    maxX = std::max<double>( maxX, pixels[i].getPosX() );
+    minY = std::min<double>( minY, pixels[i].getPosY() );
+    maxY = std::max<double>( maxY, pixels[i].getPosY() );
+    maxBoundX = std::max<double>( maxBoundX, std::fabs(pixels[i].getBoundaryX()) );
+    maxBoundY = std::max<double>( maxBoundY, std::fabs(pixels[i].getBoundaryY()) );
+  }
+
+  //the largest distance at which two pixels of this event may still touch
+  double const extentX = maxX - minX;
+  double const extentY = maxY - minY;
+  _cellX = 2*maxBoundX*1.01*_cellMargin;
+  _cellY = 2*maxBoundY*1.01*_cellMargin;
+  if( !(_cellX > 0) ) _cellX = std::max( extentX, 1.0 );
+  if( !(_cellY > 0) ) _cellY = std::max( extentY, 1.0 );
+
+  //enlarging the cells keeps the candidates a superset, this bounds the grid to O(nPixel) cells
+  size_t const maxCells = 4*nPixel + 16;
+  for(;;)
+  {
+    _nX = static_cast<int>( extentX/_cellX ) + 1;
+    _nY = static_cast<int>( extentY/_cellY ) + 1;
+    if( static_cast<size_t>(_nX)*static_cast<size_t>(_nY) <= maxCells ) break;
+    _cellX *= 2;
+    _cellY *= 2;
+  }
+
+  _originX = minX;
+  _originY = minY;
+  _cellHead.assign( static_cast<size_t>(_nX)*_nY, -1 );
+
+  //fill backwards so that every cell lists its pixels in input order
+  for( size_t i = nPixel; i-- > 0; )
+  {
+    int cX = std::min( _nX - 1, static_cast<int>( (pixels[i].getPosX() - _originX)/_cellX ) );
+    int cY = std::min( _nY - 1, static_cast<int>( (pixels[i].getPosY() - _originY)/_cellY ) );
+    _cellXOfPixel[i] = cX;
+    _cellYOfPixel[i] = cY;
+    size_t cell = static_cast<size_t>(cY)*_nX + cX;
+    _nextInCell[i] = _cellHead[cell];
+    _cellHead[cell] = static_cast<int>( i );
+  }
+}
+
+void EUTelGeometricPixelIndex::getCandidates(size_t index, std::vector<int>& candidates) const
+{
+  int const cX = _cellXOfPixel[index];
+  int const cY = _cellYOfPixel[index];
+  for( int y = std::max( 0, cY - 1 ); y <= std::min( _nY - 1, cY + 1 ); ++y )
+  {
+    for( int x = std::max( 0, cX - 1 ); x <= std::min( _nX - 1, cX + 1 ); ++x )
+    {
+      for( int other = _cellHead[static_cast<size_t>(y)*_nX + x]; other != -1; other = _nextInCell[other] )
+      {
+        candidates.push_back( other );
+      }
+    }
+  }
+}
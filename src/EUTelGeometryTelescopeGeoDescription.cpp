@@ -26,6 +26,7 @@
 
 // ROOT
 #include "TGeoManager.h"
+#include "TGeoNavigator.h"
 #include "TGeoMatrix.h"
 #include "TGeoNode.h"
 #include "TGeoMedium.h"
@@ -41,7 +42,7 @@
 using namespace eutelescope;
 using namespace geo;
 
-unsigned EUTelGeometryTelescopeGeoDescription::_counter = 0;
+std::atomic<unsigned> EUTelGeometryTelescopeGeoDescription::_counter(0);
 
 /**TODO: Replace me: NOP*/
 EUTelGeometryTelescopeGeoDescription& EUTelGeometryTelescopeGeoDescription::getInstance( gear::GearMgr* _g ) {
@@ -270,7 +271,14 @@ _trackerPlanesLayerLayout(nullptr),
 _sensorIDVec(),
 _nPlanes(0),
 _isGeoInitialized(false),
-_geoManager(nullptr)
+_geoManager(nullptr),
+_sensorTransforms(),
+_sensorLookup(),
+_radLengthTable(),
+_useRadLengthTable(false),
+_radLengthTableMaxSlope(0.05),
+_radLengthTableBins(21),
+_radLengthTableTolerance(0.01)
 {
 	//Set ROOTs verbosity to only display error messages or higher (so info will not be streamed to stderr)
 	gErrorIgnoreLevel =  kError;  
@@ -327,6 +335,7 @@ void EUTelGeometryTelescopeGeoDescription::initializeTGeoDescription( std::strin
     }
 
     _geoManager->CloseGeometry();
+    updateSensorTransforms();
 }
 
 /**
@@ -520,6 +529,7 @@ void EUTelGeometryTelescopeGeoDescription::initializeTGeoDescription( std::strin
    }
     _geoManager->CloseGeometry();
     _isGeoInitialized = true;
+    updateSensorTransforms();
     // Dump ROOT TGeo object into file
     if ( dumpRoot ) _geoManager->Export( geomName.c_str() );
     return;
@@ -590,82 +600,89 @@ Eigen::Matrix3d EUTelGeometryTelescopeGeoDescription::getFlipMatrix(int sensorID
 }
 
 int EUTelGeometryTelescopeGeoDescription::getSensorIDFromManager() {
+	return getSensorIDFromManager( getNavigator() );
+}
+
+/** Sensor id of the current node of the given navigator, -999 if it is not inside a sensor */
+int EUTelGeometryTelescopeGeoDescription::getSensorIDFromManager( TGeoNavigator* nav ) {
     std::vector<std::string> split;
  
     int sensorID = -999;
 
-  	int levelStart =	geo::gGeometry()._geoManager->GetLevel();
-    while( _geoManager->GetLevel() > 0 ) { 
-      const char* volName = const_cast < char* > ( geo::gGeometry( )._geoManager->GetCurrentVolume( )->GetName( ) );
+  	int levelStart =	nav->GetLevel();
+    while( nav->GetLevel() > 0 ) { 
+      const char* volName = const_cast < char* > ( nav->GetCurrentVolume( )->GetName( ) );
       split = Utility::stringSplit( std::string( volName ), "/", false);
       if ( split.size() > 0 && split[0].length() > 16 && (split[0].substr(0,16) == "volume_SensorID:") ) {
          int strLength = split[0].length(); 
          sensorID = strtol( (split[0].substr(16, strLength )).c_str(), NULL, 10 );
          break;
       }
-      _geoManager->CdUp();	////////////////////////////////////////THIS NEEDS TO BE FIXED. If partice falls in the pixel volume and to find sensor ID you need to be on the sensor volume
+      nav->CdUp();	////////////////////////////////////////THIS NEEDS TO BE FIXED. If partice falls in the pixel volume and to find sensor ID you need to be on the sensor volume
     }
-  	int levelEnd =	geo::gGeometry()._geoManager->GetLevel();
+  	int levelEnd =	nav->GetLevel();
 
-//		std::cout <<" node level end : " << _geoManager->GetLevel() <<std::endl;
+//		std::cout <<" node level end : " << nav->GetLevel() <<std::endl;
 
 		//Must return the manager pointing to the same node before we looked for the sensorID
 		for(int i =0 ; i < (levelStart - levelEnd); i++ ){
-			geo::gGeometry()._geoManager->CdDown(0);
+			nav->CdDown(0);
 		}
-//		std::cout <<" node level re : " << _geoManager->GetLevel() <<std::endl;
+//		std::cout <<" node level re : " << nav->GetLevel() <<std::endl;
 
 	return sensorID;
 }
 
 /**
- * Coordinate transformation from local reference frame of sensor with a given sensorID
- * to the global coordinate system
+ * Extract the local-to-global transformation of a sensor from its TGeo node.
+ * This is the matrix TGeoNode::LocalToMaster and friends apply, so the cached
+ * transformations give the same results as navigating to the sensor node.
+ * Navigates with the navigator of the calling thread.
  * 
  * @param sensorID Id of the sensor (specifies local coordinate system)
- * @param localPos (x,y,z) in local coordinate system
- * @param globalPos (x,y,z) in global coordinate system
+ * @param transform transformation to fill
  */
-void EUTelGeometryTelescopeGeoDescription::local2Master( int sensorID, const double localPos[], double globalPos[] ) {
-    _geoManager->cd( _planePath[sensorID].c_str() );
-    _geoManager->GetCurrentNode()->LocalToMaster( localPos, globalPos );
+void EUTelGeometryTelescopeGeoDescription::extractSensorTransform( int sensorID, EUTelSensorTransform& transform ) const {
+	std::map<int, std::string>::const_iterator pathIt = _planePath.find(sensorID);
+	TGeoNavigator* nav = getNavigator();
+	nav->cd( pathIt != _planePath.end() ? pathIt->second.c_str() : "" );
+	TGeoMatrix const* matrix = nav->GetCurrentNode()->GetMatrix();
+	transform.set( matrix->GetRotationMatrix(), matrix->GetTranslation() );
 }
 
 /**
- * Coordinate transformation from global reference frame to local reference frame.
- * Corresponding volume is determined automatically.
+ * Transformation of a node without a cache entry. The transformation of the
+ * current node is returned as the navigation always did, each thread keeps
+ * its own copy so the cache is never written from a worker thread.
  * 
  * @param sensorID Id of the sensor (specifies local coordinate system)
- * @param globalPos (x,y,z) in global coordinate system
- * @param localPos (x,y,z) in local coordinate system
+ * @return transformation, valid until the next call from the same thread
  */
-void EUTelGeometryTelescopeGeoDescription::master2Local(int sensorID, const double globalPos[], double localPos[] ) {
-    _geoManager->cd( _planePath[sensorID].c_str() );
-    _geoManager->GetCurrentNode()->MasterToLocal( globalPos, localPos );
+EUTelSensorTransform const& EUTelGeometryTelescopeGeoDescription::uncachedSensorTransform( int sensorID ) const {
+	static thread_local EUTelSensorTransform transform;
+	extractSensorTransform( sensorID, transform );
+	return transform;
 }
 
 /**
- * Vector coordinate transformation from global reference frame to local reference frame.
- * Corresponding volume is determined automatically.
- * 
- * @param globalVec (x,y,z) in global coordinate system
- * @param localVec (x,y,z) in local coordinate system
- */
-void EUTelGeometryTelescopeGeoDescription::local2MasterVec( int sensorID, const double localVec[], double globalVec[] ) {
-    _geoManager->cd( _planePath[sensorID].c_str() );
-    _geoManager->GetCurrentNode()->LocalToMasterVect( localVec, globalVec );
-}
-
-/**
- * Vector coordinate transformation from global reference frame to local reference frame.
- * Corresponding volume is determined automatically.
- * 
- * @param globalVec (x,y,z) in global coordinate system
- * @param localVec (x,y,z) in local coordinate system
+ * Re-extract the transformations of all sensor planes, called whenever the
+ * TGeo geometry or the plane layout changes.
  */
-void EUTelGeometryTelescopeGeoDescription::master2LocalVec( int sensorID, const double globalVec[], double localVec[] ) {
-    _geoManager->cd( _planePath[sensorID].c_str() );
-    _geoManager->GetCurrentNode()->MasterToLocalVect( globalVec, localVec );
+void EUTelGeometryTelescopeGeoDescription::updateSensorTransforms() {
+	_sensorTransforms.clear();
+	_sensorLookup.clear();
+	if( !_geoManager ) return;
+	for( std::map<int, std::string>::const_iterator it = _planePath.begin(); it != _planePath.end(); ++it ) {
+		int sensorID = it->first;
+		if( sensorID < 0 ) continue;
+		if( static_cast<size_t>(sensorID) >= _sensorTransforms.size() ) {
+			_sensorTransforms.resize( sensorID+1 );
+		}
+		extractSensorTransform( sensorID, _sensorTransforms[sensorID] );
+		//Same half widths as the TGeoBBox of the sensor, see translateSiPlane2TGeo
+		double const halfSize[3] = { siPlaneXSize(sensorID)/2., siPlaneYSize(sensorID)/2., siPlaneZSize(sensorID)/2. };
+		_sensorLookup.addSensor( sensorID, _sensorTransforms[sensorID], halfSize );
+	}
 }
 
 void EUTelGeometryTelescopeGeoDescription::local2Master( int sensorID, std::array<double,3> const & localPos, std::array<double,3>& globalPos) {
@@ -689,8 +706,9 @@ void EUTelGeometryTelescopeGeoDescription::master2LocalVec( int sensorID, std::a
  * @return 
  */
 const TGeoHMatrix* EUTelGeometryTelescopeGeoDescription::getHMatrix( const double globalPos[] ) {
-    _geoManager->FindNode( globalPos[0], globalPos[1], globalPos[2] );    
-    const TGeoHMatrix* globalH = _geoManager->GetCurrentMatrix();
+    TGeoNavigator* nav = getNavigator();
+    nav->FindNode( globalPos[0], globalPos[1], globalPos[2] );    
+    const TGeoHMatrix* globalH = nav->GetCurrentMatrix();
 	//	if(streamlog_out(DEBUG2)){
   //  streamlog_out(DEBUG2) << "Transformation matrix " << std::endl;
 	//	globalH->Print();
@@ -707,8 +725,9 @@ TMatrixD EUTelGeometryTelescopeGeoDescription::getRotMatrix( int sensorID ) {
 	TMatrixD TRotMatrix(3,3);
 	if(sensorID != SCATTER_IDENTIFIER) {
 		local2Master( sensorID, local, global );
-		_geoManager->FindNode( global[0], global[1], global[2] );    
-		const TGeoHMatrix* globalH = _geoManager->GetCurrentMatrix();
+		TGeoNavigator* nav = getNavigator();
+		nav->FindNode( global[0], global[1], global[2] );    
+		const TGeoHMatrix* globalH = nav->GetCurrentMatrix();
 		const double* rotMatrix = globalH->GetRotationMatrix();
 		TRotMatrix[0][0] = *rotMatrix; TRotMatrix[0][1] = *(rotMatrix+1);TRotMatrix[0][2] = *(rotMatrix+2);
 		TRotMatrix[1][0] = *(rotMatrix+3); TRotMatrix[1][1] = *(rotMatrix+4);TRotMatrix[1][2] = *(rotMatrix+5);
@@ -728,25 +747,51 @@ int EUTelGeometryTelescopeGeoDescription::getSensorID( float const globalPos[] )
     return getSensorID(pos);
 }
 /** Determine id of the sensor in which point is locate
+ *  * The sensor planes are looked up analytically from their oriented boxes,
+ *  * TGeo is only navigated for geometries which were imported from a file.
  *  * 
  *  * @param globalPos 3D point in global reference frame
  *  * @return sensorID or -999 if the point in outside of sensor volume
  *  */
 int EUTelGeometryTelescopeGeoDescription::getSensorID( double const globalPos[] ) const {
-    streamlog_out(DEBUG5) << "EUTelGeometryTelescopeGeoDescription::getSensorID() " << std::endl;
+    if( _sensorLookup.size() == 0 ) return getSensorIDFromTGeo( globalPos );
+
+    //Same single precision as the TGeo navigation used to have
     const float constPos[3] = {globalPos[0],globalPos[1],globalPos[2]};
-    _geoManager->FindNode( constPos[0], constPos[1], constPos[2] );
+    const double pos[3] = {constPos[0],constPos[1],constPos[2]};
+    int sensorID = _sensorLookup.findSensor( pos );
+    streamlog_out(DEBUG5) << "Point (" << globalPos[0] << "," << globalPos[1] << "," << globalPos[2] << ") sensorID = " << sensorID << std::endl;
+    return sensorID;
+}
+
+void EUTelGeometryTelescopeGeoDescription::getSensorID( size_t nPoints, double const globalPos[], int sensorIDs[] ) const {
+    if( _sensorLookup.size() == 0 ) {
+        for( size_t i = 0; i < nPoints; ++i ) sensorIDs[i] = getSensorIDFromTGeo( globalPos+3*i );
+        return;
+    }
+    for( size_t i = 0; i < nPoints; ++i ) {
+        const float constPos[3] = {globalPos[3*i],globalPos[3*i+1],globalPos[3*i+2]};
+        const double pos[3] = {constPos[0],constPos[1],constPos[2]};
+        sensorIDs[i] = _sensorLookup.findSensor( pos );
+    }
+}
+
+int EUTelGeometryTelescopeGeoDescription::getSensorIDFromTGeo( double const globalPos[] ) const {
+    streamlog_out(DEBUG5) << "EUTelGeometryTelescopeGeoDescription::getSensorIDFromTGeo() " << std::endl;
+    const float constPos[3] = {globalPos[0],globalPos[1],globalPos[2]};
+    TGeoNavigator* nav = getNavigator();
+    nav->FindNode( constPos[0], constPos[1], constPos[2] );
 
     std::vector<std::string> split;
 
     int sensorID = -999;
 
-    const char* volName1 = const_cast < char* > ( geo::gGeometry( )._geoManager->GetCurrentVolume( )->GetName( ) );
+    const char* volName1 = const_cast < char* > ( nav->GetCurrentVolume( )->GetName( ) );
     streamlog_out(DEBUG2) << "init sensorID  : " << sensorID  <<  " " << volName1 << std::endl;
 
-    while( _geoManager->GetLevel() > 0 ) {
-        const char* volName = const_cast < char* > ( geo::gGeometry( )._geoManager->GetCurrentVolume( )->GetName( ) );
-        streamlog_out( DEBUG1 ) << "Point (" << globalPos[0] << "," << globalPos[1] << "," << globalPos[2] << ") found in volume: " << volName << " level: " << _geoManager->GetLevel() << std::endl;
+    while( nav->GetLevel() > 0 ) {
+        const char* volName = const_cast < char* > ( nav->GetCurrentVolume( )->GetName( ) );
+        streamlog_out( DEBUG1 ) << "Point (" << globalPos[0] << "," << globalPos[1] << "," << globalPos[2] << ") found in volume: " << volName << " level: " << nav->GetLevel() << std::endl;
         split = Utility::stringSplit( std::string( volName ), "/", false);
         if ( split.size() > 0 && split[0].length() > 16 && (split[0].substr(0,16) == "volume_SensorID:") ) {
             int strLength = split[0].length();
@@ -754,10 +799,10 @@ int EUTelGeometryTelescopeGeoDescription::getSensorID( double const globalPos[]
             streamlog_out(DEBUG1) << "Point (" << globalPos[0] << "," << globalPos[1] << "," << globalPos[2] << ") was found at :" << sensorID << std::endl;
         break;
         }
-    _geoManager->CdUp();  ////////////////////////////////////////THIS NEEDS TO BE FIXED. If partice falls in the pixel volume and to find sensor ID you need to be on the sensor volume
+    nav->CdUp();  ////////////////////////////////////////THIS NEEDS TO BE FIXED. If partice falls in the pixel volume and to find sensor ID you need to be on the sensor volume
     }
 
-    const char* volName2 = const_cast < char* > ( geo::gGeometry( )._geoManager->GetCurrentVolume( )->GetName( ) );
+    const char* volName2 = const_cast < char* > ( nav->GetCurrentVolume( )->GetName( ) );
     streamlog_out( DEBUG2 ) << "Point (" << globalPos[0] << "," << globalPos[1] << "," << globalPos[2] << ") found in volume: " << volName2 << " no moving around any more" << std::endl;
 
     if( sensorID >= 0 )
@@ -792,6 +837,62 @@ int EUTelGeometryTelescopeGeoDescription::getSensorID(std::array<float,3> const
  */
 
 float EUTelGeometryTelescopeGeoDescription::findRad( const std::map<int,int>& sensorIDToZOrderWithoutExcludedPlanes, const double globalPosStart[], const double globalPosFinish[], std::map< const int, double> &sensors, 	std::map< const int, double> &air ){
+	//The table is only read here, it is filled by useRadLengthTable()
+	if( _useRadLengthTable && _radLengthTable.isFilled() ) {
+		double const dz = globalPosFinish[2] - globalPosStart[2];
+		if( dz != 0 ) {
+			double const tx = ( globalPosFinish[0] - globalPosStart[0] )/dz;
+			double const ty = ( globalPosFinish[1] - globalPosStart[1] )/dz;
+			if( _radLengthTable.inRange(tx, ty) ) {
+				return _radLengthTable.findRad( sensorIDToZOrderWithoutExcludedPlanes, tx, ty, sensors, air );
+			}
+		}
+	}
+	return findRadTGeo( sensorIDToZOrderWithoutExcludedPlanes, globalPosStart, globalPosFinish, sensors, air );
+}
+
+bool EUTelGeometryTelescopeGeoDescription::useRadLengthTable( bool use, double maxSlope, int nSlopeBins, double tolerance ) {
+	_useRadLengthTable = use;
+	_radLengthTableMaxSlope = maxSlope;
+	_radLengthTableBins = nSlopeBins;
+	_radLengthTableTolerance = tolerance;
+	_radLengthTable.clear();
+	if( _useRadLengthTable ) fillRadLengthTable();
+	return _useRadLengthTable;
+}
+
+void EUTelGeometryTelescopeGeoDescription::updateRadLengthTable() {
+	if( _useRadLengthTable && !_radLengthTable.isFilled() ) fillRadLengthTable();
+}
+
+void EUTelGeometryTelescopeGeoDescription::fillRadLengthTable() {
+	std::vector<Eigen::Vector3d> centres, normals;
+	std::vector<double> thickness;
+	for( size_t i = 0; i < _sensorIDVec.size(); ++i ) {
+		int sensorID = _sensorIDVec[i];
+		TVector3 normal = siPlaneNormal(sensorID);
+		centres.push_back( Eigen::Vector3d( siPlaneXPosition(sensorID), siPlaneYPosition(sensorID), siPlaneZPosition(sensorID) ) );
+		normals.push_back( Eigen::Vector3d( normal.X(), normal.Y(), normal.Z() ) );
+		thickness.push_back( siPlaneZSize(sensorID) );
+	}
+
+	EUTelRadLengthTable::Integrator integrate = [this]( Eigen::Vector3d const& start, Eigen::Vector3d const& end ) { return FindRad( start, end ); };
+	_radLengthTable.fill( _sensorIDVec, centres, normals, thickness, _radLengthTableMaxSlope, _radLengthTableBins, integrate );
+
+	double deviation = _radLengthTable.check( integrate );
+	if( deviation > _radLengthTableTolerance ) {
+		streamlog_out( WARNING5 ) << "Radiation length table deviates by up to " << deviation*100 << "% from the TGeo integration (tolerance "
+					  << _radLengthTableTolerance*100 << "%), findRad falls back to TGeo" << std::endl;
+		_radLengthTable.clear();
+		_useRadLengthTable = false;
+	} else {
+		streamlog_out( MESSAGE5 ) << "Radiation length table for slopes up to " << _radLengthTableMaxSlope << " filled, maximum deviation from TGeo "
+					  << deviation*100 << "%" << std::endl;
+	}
+}
+
+float EUTelGeometryTelescopeGeoDescription::findRadTGeo( const std::map<int,int>& sensorIDToZOrderWithoutExcludedPlanes, const double globalPosStart[], const double globalPosFinish[], std::map< const int, double> &sensors, 	std::map< const int, double> &air ){
+	TGeoNavigator* nav = getNavigator();
     streamlog_out(DEBUG5) << "/////////////////////////////////////////////////////////////////////////////////////////////////// " << std::endl;
     streamlog_out(DEBUG5) << "/////////////////////////////////////////////////////////////////////////////////////////////////// " << std::endl;
     streamlog_out(DEBUG5) << "              CALCULATING THE TOTAL RADIATION LENGTH BETWEEN TWO POINTS.                            " << std::endl;
@@ -812,16 +913,16 @@ float EUTelGeometryTelescopeGeoDescription::findRad( const std::map<int,int>& se
     const double yp  = ( globalPosFinish[1] - globalPosStart[1] )/stepLength;
     const double zp  = ( globalPosFinish[2] - globalPosStart[2] )/stepLength;
     //We get the object we are in currently on this track and begin to loop to each plane 
-    gGeoManager->InitTrack( globalPosStart[0]/*mm*/, globalPosStart[1]/*mm*/, globalPosStart[2]/*mm*/, xp, yp, zp ); //This the start point and direction
-    TGeoNode *nextnode = gGeoManager->GetCurrentNode( );
+    nav->InitTrack( globalPosStart[0]/*mm*/, globalPosStart[1]/*mm*/, globalPosStart[2]/*mm*/, xp, yp, zp ); //This the start point and direction
+    TGeoNode *nextnode = nav->GetCurrentNode( );
     while ( nextnode ) {
-        int sensorID = getSensorIDFromManager();
+        int sensorID = getSensorIDFromManager(nav);
         //If not in the first plane then look forward.
         if(sensorID == sensorIDToZOrderWithoutExcludedPlanes.at(0) or foundFirstPlane ){ //We want to make sure to add radiation length from first plane to last plane only;
             foundFirstPlane = true;
         }else{
             //nextnode is the next found and we can get the step using GetStep. stepLength is the max distance to travel before we find another node. 
-            nextnode = gGeoManager->FindNextBoundaryAndStep( stepLength /*mm*/ );  
+            nextnode = nav->FindNextBoundaryAndStep( stepLength /*mm*/ );  
         }
         //Don't do anything until we find the first sensor.
         if(foundFirstPlane){
@@ -830,8 +931,8 @@ float EUTelGeometryTelescopeGeoDescription::findRad( const std::map<int,int>& se
             else return 0.; //We return 0 to get rid of the track but not the event.
             double radlen = med->GetMaterial()->GetRadLen() /*cm*/;
             double lastrad = 1. / radlen * mm2cm; //calculate 1/radiationlength per cm. This will transform radlen to mm
-            nextnode = gGeoManager->FindNextBoundaryAndStep( stepLength /*mm*/ );  
-            double snext  = gGeoManager->GetStep() /*mm*/; //This will output the distance traveled by FindNextBoundaryAndStep
+            nextnode = nav->FindNextBoundaryAndStep( stepLength /*mm*/ );  
+            double snext  = nav->GetStep() /*mm*/; //This will output the distance traveled by FindNextBoundaryAndStep
             double rad = 0; //This is the calculated (rad per distance x distance)
             double delta = 0.01;//This is the minimum block size 
             streamlog_out(DEBUG5)<<std::endl <<std::endl  << "DECISION: Step size over min?  "  <<" Block width: " << snext << " delta: " << delta  << std::endl;
@@ -839,10 +940,10 @@ float EUTelGeometryTelescopeGeoDescription::findRad( const std::map<int,int>& se
                streamlog_out(DEBUG5) << "INCREASE TO MINIMUM DISTANCE!" << std::endl;
                 snext = delta;
                 double pt[3];
-                memcpy( pt, gGeoManager->GetCurrentPoint(), 3 * sizeof (double) ); //Get global position
-                const double *dir = gGeoManager->GetCurrentDirection();//Direction vector
+                memcpy( pt, nav->GetCurrentPoint(), 3 * sizeof (double) ); //Get global position
+                const double *dir = nav->GetCurrentDirection();//Direction vector
                 for ( Int_t i = 0; i < 3; i++ ) pt[i] += delta * dir[i]; //Move the current point slightly in the direction of motion. 
-                nextnode = gGeoManager->FindNode( pt[0], pt[1], pt[2] );//Move to new node where we will begin to look for more radiation length   
+                nextnode = nav->FindNode( pt[0], pt[1], pt[2] );//Move to new node where we will begin to look for more radiation length   
                 rad=lastrad*snext; //Calculate radiation length for the increased block.
                 blockEnd += snext;
            }else{
@@ -916,6 +1017,7 @@ double EUTelGeometryTelescopeGeoDescription::addKapton(std::map<const int, doubl
 
 
 double EUTelGeometryTelescopeGeoDescription::FindRad(Eigen::Vector3d const & startPt, Eigen::Vector3d const & endPt) {
+	TGeoNavigator* nav = getNavigator();
 
 	Eigen::Vector3d track = endPt-startPt;
 	double length = track.norm();
@@ -930,15 +1032,15 @@ double EUTelGeometryTelescopeGeoDescription::FindRad(Eigen::Vector3d const & sta
 	bool reachedEnd = false;
 
 	TGeoMedium* med;
-	gGeoManager->InitTrack(startPt(0), startPt(1), startPt(2), track(0), track(1), track(2));
-	TGeoNode* nextnode = gGeoManager->GetCurrentNode();
+	nav->InitTrack(startPt(0), startPt(1), startPt(2), track(0), track(1), track(2));
+	TGeoNode* nextnode = nav->GetCurrentNode();
 
 	while(nextnode && !reachedEnd) {
 		med = nullptr;
 		if (nextnode) med = nextnode->GetVolume()->GetMedium();
 
-		nextnode = gGeoManager->FindNextBoundaryAndStep(length);
-		snext  = gGeoManager->GetStep();
+		nextnode = nav->FindNextBoundaryAndStep(length);
+		snext  = nav->GetStep();
 
 		if( propagatedDistance+snext >= length ) {
 			snext = length - propagatedDistance;
@@ -947,16 +1049,16 @@ double EUTelGeometryTelescopeGeoDescription::FindRad(Eigen::Vector3d const & sta
 		//snext gets very small at a transition into a next node, in this case we need to manually propagate a small (epsil)
 		//step into the direction of propagation. This introduces a small systematic error, depending on the size of epsil as
 	    	if(snext < 1.e-8) {
-			const double * currDir = gGeoManager->GetCurrentDirection();
-			const double * currPt = gGeoManager->GetCurrentPoint();
+			const double * currDir = nav->GetCurrentDirection();
+			const double * currPt = nav->GetCurrentPoint();
 
 			direction(0) = currDir[0]; direction(1) = currDir[1]; direction(2) = currDir[2];
 			point(0) = currPt[0]; point(1) = currPt[1]; point(2) = currPt[2];
 
 			point = point + epsil*direction;
 
-			gGeoManager->CdTop();
-			nextnode = gGeoManager->FindNode(point(0),point(1),point(2));
+			nav->CdTop();
+			nextnode = nav->FindNode(point(0),point(1),point(2));
 			snext = epsil;
 		}	
 		if(med) {
@@ -1086,10 +1188,44 @@ void EUTelGeometryTelescopeGeoDescription::mapWeightsToSensor(std::map<const int
 //		}
 //	}
 }
+void EUTelGeometryTelescopeGeoDescription::setMaxThreads( int nThreads ) {
+	_geoManager->SetMaxThreads( nThreads );
+	fillCaches();
+}
+
+/**
+ * The memoizing getters insert into their maps on first use, so they are
+ * filled for all sensors here while only one thread runs. Afterwards the
+ * worker threads only read them.
+ */
+void EUTelGeometryTelescopeGeoDescription::fillCaches() {
+	if( !_geoManager ) return;
+	for( size_t i = 0; i < _sensorIDVec.size(); ++i ) {
+		int const sensorID = _sensorIDVec[i];
+		TVector3 const normal = siPlaneNormal( sensorID );
+		siPlaneXAxis( sensorID );
+		siPlaneYAxis( sensorID );
+		planeRadLengthGlobalIncidence( sensorID, Eigen::Vector3d( normal.X(), normal.Y(), normal.Z() ) );
+	}
+	updateRadLengthTable();
+}
+
+/**
+ * Once TGeo runs multi-threaded every thread needs its own navigator, the
+ * first call from a new thread creates it. Single threaded this is the
+ * default navigator of the manager.
+ */
+TGeoNavigator* EUTelGeometryTelescopeGeoDescription::getNavigator() const {
+	TGeoNavigator* nav = _geoManager->GetCurrentNavigator();
+	if( !nav ) nav = _geoManager->AddNavigator();
+	return nav;
+}
+
 //
 // straight line - shashlyk plane assembler
 //
 int EUTelGeometryTelescopeGeoDescription::findNextPlane(  double* lpoint,  double* ldir, float* newpoint ) {
+	TGeoNavigator* nav = getNavigator();
 	if( newpoint== nullptr) {
 		throw(lcio::Exception("You have passed a NULL pointer to findNextPlane.")); 	
 	}
@@ -1106,8 +1242,8 @@ int EUTelGeometryTelescopeGeoDescription::findNextPlane(  double* lpoint,  doubl
 	}  
 	int currentSensorID = getSensorID(newpoint); 
 	//initialise the track.
-	gGeoManager->InitTrack( lpoint, ldir );
-	TGeoNode *node = gGeoManager->GetCurrentNode( );
+	nav->InitTrack( lpoint, ldir );
+	TGeoNode *node = nav->GetCurrentNode( );
 
 	Int_t inode    = node->GetIndex();
 	Int_t i        = 0;
@@ -1115,11 +1251,11 @@ int EUTelGeometryTelescopeGeoDescription::findNextPlane(  double* lpoint,  doubl
 	streamlog_out( DEBUG0 ) << "::findNextPlane look for next node, starting at node: " << node << " id: " << inode  << " currentSensorID: " << currentSensorID << std::endl;
 
 	//   double kStep = 1e-03;
-	while( node = gGeoManager->FindNextBoundaryAndStep() ) {
+	while( node = nav->FindNextBoundaryAndStep() ) {
 		 inode = node->GetIndex();
 		 streamlog_out( DEBUG0 ) << "::findNextPlane found next node: " << node << " id: " << inode << std::endl;
-		 const double* point = gGeoManager->GetCurrentPoint();
-		 const double* dir   = gGeoManager->GetCurrentDirection();
+		 const double* point = nav->GetCurrentPoint();
+		 const double* dir   = nav->GetCurrentDirection();
 		 double ipoint[3] ;
 		 double idir[3]   ;
 
@@ -1132,8 +1268,8 @@ int EUTelGeometryTelescopeGeoDescription::findNextPlane(  double* lpoint,  doubl
 		 int sensorID = getSensorID(newpoint); 
 		 i++;     
 		
-		 gGeoManager->SetCurrentPoint( ipoint);
-		 gGeoManager->SetCurrentDirection( idir);
+		 nav->SetCurrentPoint( ipoint);
+		 nav->SetCurrentDirection( idir);
 
 		 streamlog_out( DEBUG0 ) << "::findNextPlane i=" << i  << " " << inode << " " << ipoint[0]  << " " << ipoint[1] << " " << ipoint[2]  << " sensorID:" << sensorID <<  std::endl;
 		 if(sensorID >= 0 && sensorID != currentSensorID ) return sensorID;
@@ -1144,6 +1280,7 @@ int EUTelGeometryTelescopeGeoDescription::findNextPlane(  double* lpoint,  doubl
 }
 //This will take in a global coordinate and direction and output the new global point on the next sensor. 
 bool EUTelGeometryTelescopeGeoDescription::findNextPlaneEntrance(  TVector3 lpoint,  TVector3 ldir, int nextSensorID, float* newpoint ){
+	TGeoNavigator* nav = getNavigator();
 	streamlog_out(DEBUG5) << "EUTelGeometryTelescopeGeoDescription::findNextPlaneEntrance()------BEGIN" << std::endl;
 	if( newpoint == nullptr ) {
 		throw(lcio::Exception("You have passed a NULL pointer to findNextPlane.")); 	
@@ -1154,19 +1291,19 @@ bool EUTelGeometryTelescopeGeoDescription::findNextPlaneEntrance(  TVector3 lpoi
 	double dlDir[3];
 	dlDir[0] = ldir[0];	dlDir[1] = ldir[1];	dlDir[2] = ldir[2];
 
-	_geoManager->InitTrack( dlPoint, dlDir );
+	nav->InitTrack( dlPoint, dlDir );
 
-	TGeoNode *node = _geoManager->GetCurrentNode( ); //Return the volume i.e 'node' that contains that point.
+	TGeoNode *node = nav->GetCurrentNode( ); //Return the volume i.e 'node' that contains that point.
 	Int_t inode =  node->GetIndex();
 	Int_t stepNumber=0;
 
 	streamlog_out( DEBUG0 ) << "findNextPlaneEntrance node: " << node << " id: " << inode << std::endl;
 
 	//Keep looping until you have left this plane volume and are at another. Note FindNextBoundaryAndStep will only take you to the next volume 'node' it will not enter it.
-	while( node = _geoManager->FindNextBoundaryAndStep() ) {
+	while( node = nav->FindNextBoundaryAndStep() ) {
 		inode = node->GetIndex();
-		const double* point = _geoManager->GetCurrentPoint(); //This will be the new global coordinates after the move
-		const double* dir   = _geoManager->GetCurrentDirection(); //This will be the same direction. Since we will only travel in a straight line.  
+		const double* point = nav->GetCurrentPoint(); //This will be the new global coordinates after the move
+		const double* dir   = nav->GetCurrentDirection(); //This will be the same direction. Since we will only travel in a straight line.  
 		double ipoint[3] ;
 		double idir[3]   ;
 		//Here we set the coordinates and move into the volume in the z direction.
@@ -1180,8 +1317,8 @@ bool EUTelGeometryTelescopeGeoDescription::findNextPlaneEntrance(  TVector3 lpoi
 		}
 		int sensorID = getSensorID(newpoint); 
 
-		_geoManager->SetCurrentPoint( ipoint);
-		_geoManager->SetCurrentDirection( idir);
+		nav->SetCurrentPoint( ipoint);
+		nav->SetCurrentDirection( idir);
 
 		streamlog_out( DEBUG0 ) << "Loop number: " << stepNumber  << ". Index of next boundary: " << inode << ". Current global point: " << ipoint[0]  << " " << ipoint[1] << " " << ipoint[2]  << " sensorID: " << sensorID << ". Input of expect next sensor: " << nextSensorID << std::endl;
 		streamlog_out(DEBUG5) << "EUTelGeometryTelescopeGeoDescription::findNextPlaneEntrance()------END" << std::endl;
@@ -1232,6 +1369,8 @@ void EUTelGeometryTelescopeGeoDescription::updateSiPlanesLayout() {
 	if( _gearManager != nullptr ) {
 		_gearManager->setSiPlanesParameters( siplanesParameters ) ;
 	}
+
+	updateSensorTransforms();
 }
 
 void EUTelGeometryTelescopeGeoDescription::updateTrackerPlanesLayout() {
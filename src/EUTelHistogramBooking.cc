@@ -0,0 +1,16 @@
+/*
+ *   This source code is part of the Eutelescope package of Marlin.
+ *   You are free to use this source files for your own development as
+ *   long as it stays in a public research context. You are not
+ *   allowed to use it for commercial purpose. You must put this
+ *   header with author names in all development based on this file.
+ *
+ */
+
+// eutelescope includes ".h"
+#include "EUTelHistogramBooking.h"
+
+std::recursive_mutex& eutelescope::histogramBookingMutex() {
+  static std::recursive_mutex bookingMutex;
+  return bookingMutex;
+}
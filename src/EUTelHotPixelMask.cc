@@ -0,0 +1,75 @@
+/*
+ *   This source code is part of the Eutelescope package of Marlin.
+ *   You are free to use this source files for your own development as
+ *   long as it stays in a public research context. You are not
+ *   allowed to use it for commercial purpose. You must put this
+ *   header with author names in all development based on this file.
+ *
+ */
+
+// eutelescope includes ".h"
+#include "EUTelHotPixelMask.h"
+
+using namespace eutelescope;
+
+const uint64_t EUTelHotPixelMask::_maxDenseBits = uint64_t(1) << 26;
+
+EUTelHotPixelMask::EUTelHotPixelMask():
+  _sensors(),
+  _nHotPixels(0)
+{}
+
+void EUTelHotPixelMask::clear()
+{
+  _sensors.clear();
+  _nHotPixels = 0;
+}
+
+void EUTelHotPixelMask::setHotPixels(int sensorID, std::vector<std::pair<int, int> > const& pixels)
+{
+  if( sensorID < 0 ) return;
+  if( static_cast<size_t>(sensorID) >= _sensors.size() ) _sensors.resize( sensorID + 1 );
+
+  SensorMask& mask = _sensors[sensorID];
+  if( mask.sparse ) _nHotPixels -= mask.sorted.size();
+  else for( size_t i = 0; i < mask.bits.size(); ++i ) _nHotPixels -= __builtin_popcountll( mask.bits[i] );
+  mask = SensorMask();
+  if( pixels.empty() ) return;
+
+  int maxX = pixels[0].first, maxY = pixels[0].second;
+  mask.minX = maxX;
+  mask.minY = maxY;
+  for( size_t i = 0; i < pixels.size(); ++i )
+  {
+    mask.minX = std::min( mask.minX, pixels[i].first );
+    mask.minY = std::min( mask.minY, pixels[i].second );
+    maxX = std::max( maxX, pixels[i].first );
+    maxY = std::max( maxY, pixels[i].second );
+  }
+  mask.nX = maxX - mask.minX + 1;
+  mask.nY = maxY - mask.minY + 1;
+
+  uint64_t const nBits = static_cast<uint64_t>(mask.nX)*mask.nY;
+  mask.sparse = nBits > _maxDenseBits;
+  if( mask.sparse )
+  {
+    for( size_t i = 0; i < pixels.size(); ++i )
+    {
+      mask.sorted.push_back( static_cast<uint64_t>(pixels[i].second - mask.minY)*mask.nX + (pixels[i].first - mask.minX) );
+    }
+    std::sort( mask.sorted.begin(), mask.sorted.end() );
+    mask.sorted.erase( std::unique( mask.sorted.begin(), mask.sorted.end() ), mask.sorted.end() );
+    _nHotPixels += mask.sorted.size();
+  }
+  else
+  {
+    mask.bits.assign( (nBits + 63)/64, 0 );
+    for( size_t i = 0; i < pixels.size(); ++i )
+    {
+      size_t const bit = static_cast<size_t>(pixels[i].second - mask.minY)*mask.nX + (pixels[i].first - mask.minX);
+      uint64_t const flag = uint64_t(1) << (bit & 63);
+      if( !(mask.bits[bit >> 6] & flag) ) ++_nHotPixels;
+      mask.bits[bit >> 6] |= flag;
+    }
+  }
+}
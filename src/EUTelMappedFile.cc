@@ -0,0 +1,154 @@
+/*
+ *   This source code is part of the Eutelescope package of Marlin.
+ *   You are free to use this source files for your own development as
+ *   long as it stays in a public research context. You are not
+ *   allowed to use it for commercial purpose. You must put this
+ *   header with author names in all development based on this file.
+ *
+ */
+
+// eutelescope includes ".h"
+#include "EUTelMappedFile.h"
+
+// system includes <>
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+using namespace eutelescope;
+
+namespace {
+  // pages are faulted in by the read-ahead thread in steps of this size
+  const size_t readAheadChunk = 1 << 20;
+}
+
+EUTelMappedFile::EUTelMappedFile():
+  _fileDescriptor(-1),
+  _data(0),
+  _size(0),
+  _errorMessage(),
+  _readAheadSize(0),
+  _released(0),
+  _readAheadThread(),
+  _mutex(),
+  _condition(),
+  _position(0),
+  _stop(false)
+{}
+
+EUTelMappedFile::~EUTelMappedFile()
+{
+  close();
+}
+
+bool EUTelMappedFile::open(std::string const& fileName, size_t readAhead)
+{
+  close();
+
+  _fileDescriptor = ::open( fileName.c_str(), O_RDONLY );
+  if( _fileDescriptor < 0 )
+  {
+    _errorMessage = "Cannot open " + fileName + ": " + std::strerror( errno );
+    return false;
+  }
+
+  struct stat fileStatus;
+  if( fstat( _fileDescriptor, &fileStatus ) != 0 || fileStatus.st_size == 0 )
+  {
+    _errorMessage = "Cannot map empty or unreadable file " + fileName;
+    close();
+    return false;
+  }
+  _size = static_cast<size_t>( fileStatus.st_size );
+
+  void* mapped = mmap( 0, _size, PROT_READ, MAP_PRIVATE, _fileDescriptor, 0 );
+  if( mapped == MAP_FAILED )
+  {
+    _errorMessage = "Cannot map " + fileName + ": " + std::strerror( errno );
+    _size = 0;
+    close();
+    return false;
+  }
+  _data = static_cast<char const*>( mapped );
+  madvise( mapped, _size, MADV_SEQUENTIAL );
+
+  _readAheadSize = readAhead;
+  _released = 0;
+  _position = 0;
+  _stop = false;
+  if( _readAheadSize > 0 ) _readAheadThread = std::thread( &EUTelMappedFile::readAhead, this );
+  return true;
+}
+
+void EUTelMappedFile::close()
+{
+  if( _readAheadThread.joinable() )
+  {
+    {
+      std::lock_guard<std::mutex> lock( _mutex );
+      _stop = true;
+    }
+    _condition.notify_all();
+    _readAheadThread.join();
+  }
+  if( _data ) munmap( const_cast<char*>( _data ), _size );
+  if( _fileDescriptor >= 0 ) ::close( _fileDescriptor );
+  _data = 0;
+  _size = 0;
+  _fileDescriptor = -1;
+}
+
+void EUTelMappedFile::consumed(size_t offset)
+{
+  {
+    std::lock_guard<std::mutex> lock( _mutex );
+    _position = std::min( offset, _size );
+  }
+  _condition.notify_all();
+
+  // keep one window behind the decoder, drop what is older
+  size_t const pageSize = static_cast<size_t>( sysconf( _SC_PAGESIZE ) );
+  size_t const keep = std::max( _readAheadSize, readAheadChunk );
+  if( offset > _released + 2*keep )
+  {
+    size_t const releaseEnd = ( ( offset - keep ) / pageSize ) * pageSize;
+    madvise( const_cast<char*>( _data ) + _released, releaseEnd - _released, MADV_DONTNEED );
+    _released = releaseEnd;
+  }
+}
+
+void EUTelMappedFile::readAhead()
+{
+  size_t const pageSize = static_cast<size_t>( sysconf( _SC_PAGESIZE ) );
+  size_t prefetched = 0;
+  volatile char sink = 0;
+
+  while( prefetched < _size )
+  {
+    size_t target;
+    {
+      std::unique_lock<std::mutex> lock( _mutex );
+      _condition.wait( lock, [&]{ return _stop || prefetched < std::min( _size, _position + _readAheadSize ); } );
+      if( _stop ) return;
+      // pages the decoder has already passed are not worth reading
+      prefetched = std::max( prefetched, ( _position / pageSize ) * pageSize );
+      target = std::min( _size, _position + _readAheadSize );
+    }
+
+    while( prefetched < target )
+    {
+      size_t const chunkEnd = std::min( target, prefetched + readAheadChunk );
+      // touching one byte per page makes the kernel read the page now
+      for( size_t offset = prefetched; offset < chunkEnd; offset += pageSize ) sink = _data[offset];
+      prefetched = chunkEnd;
+
+      std::lock_guard<std::mutex> lock( _mutex );
+      if( _stop ) return;
+    }
+  }
+  (void) sink;
+}
@@ -23,7 +23,7 @@
 #include "EUTelBrickedClusterImpl.h"
 #include "EUTelSparseClusterImpl.h"
 #include "EUTelExceptions.h"
-#include "EUTelPStream.h"
+#include "EUTelPedeDriver.h"
 #include "EUTelAlignmentConstant.h"
 #include "EUTelReferenceHit.h"
 #include "EUTelCDashMeasurement.h"
@@ -35,9 +35,6 @@
 #include "marlin/Exceptions.h"
 #include "marlin/AIDAProcessor.h"
 
-// marlin util includes
-#include "mille/Mille.h"
-
 // aida includes <.h>
 #if defined(USE_AIDA) || defined(MARLIN_USE_AIDA)
 #include <marlin/AIDAProcessor.h>
@@ -220,8 +217,18 @@ EUTelMille::EUTelMille () : Processor("EUTelMille") {
   registerOptionalParameter("MaxTrackCandidatesTotal","Stop processor after this maximum number of track candidates (Total) is reached.",_maxTrackCandidatesTotal, static_cast <int> (10000000));
   registerOptionalParameter("MaxTrackCandidates","Maximal number of track candidates in a event.",_maxTrackCandidates, static_cast <int> (2000));
 
+  registerOptionalParameter("PrunedTrackSearch","Search the track candidates (InputMode 0 and 2) with the pruned search: no duplicated candidates, residual cuts against the last hit after a missed plane and on the last plane, at least two hits per candidate. The default is the original search.",_prunedTrackSearch, static_cast <bool> (false));
+
+  registerOptionalParameter("MaxTrackSlope","Maximal slope between two hits of a track candidate (PrunedTrackSearch only), no cut if 0.",_maxTrackSlope, static_cast <float> (0.0));
+
+  registerOptionalParameter("MaxTrackFinderBranches","Maximal number of branches the track candidate search visits in a event (PrunedTrackSearch only), no limit if 0.",_maxTrackFinderBranches, static_cast <int> (1000000));
+
   registerOptionalParameter("BinaryFilename","Name of the Millepede binary file.",_binaryFilename, string ("mille.bin"));
 
+  registerOptionalParameter("CompressBinary","Write a gzip compressed Millepede binary, pede has to be built with zlib support to read it.",_compressBinary, static_cast <bool> (false));
+
+  registerOptionalParameter("WriteBinaryIndex","Write an index next to the Millepede binary, milleselect uses it to copy the tracks passing tighter cuts into a new binary.",_writeBinaryIndex, static_cast <bool> (true));
+
   registerOptionalParameter("TelescopeResolution","(default) Resolution of the telescope for Millepede (sigma_x=sigma_y) used only if plane dependent resolution is set inconsistently.",_telescopeResolution, static_cast <float> (3.0));
 
   registerOptionalParameter("OnlySingleHitEvents","Use only events with one hit in every plane.",_onlySingleHitEvents, static_cast <bool> (false));
@@ -464,6 +471,13 @@ void EUTelMille::init() {
   _nMilleDataPoints = 0;
   _nMilleTracks = 0;
 
+  _trackFinder = EUTelMilleTrackFinder();
+  _trackFinder.setResidualCuts(_residualsXMin, _residualsXMax, _residualsYMin, _residualsYMax);
+  _trackFinder.setAllowedMissingHits(getAllowedMissingHits());
+  _trackFinder.setMaxTrackCandidates(_maxTrackCandidates);
+  _trackFinder.setMaxTrackSlope(_maxTrackSlope);
+  _trackFinder.setMaxBranches(_maxTrackFinderBranches);
+
   _waferResidX = new double[_nPlanes];
   _waferResidY = new double[_nPlanes];
   _waferResidZ = new double[_nPlanes];
@@ -539,7 +553,10 @@ void EUTelMille::init() {
   bookHistos();
 
   streamlog_out ( MESSAGE5 ) << "Initialising Mille..." << endl;
-  _mille = new Mille(_binaryFilename.c_str());
+  _mille = new EUTelMilleWriter();
+  if( !_mille->open( _binaryFilename, _compressBinary, _writeBinaryIndex ) ) {
+    throw InvalidParameterException( _mille->getErrorMessage() );
+  }
 
   _xPos.clear();
   _yPos.clear();
@@ -607,158 +624,19 @@ void EUTelMille::processRunHeader (LCRunHeader * rdr) {
 
 
 void EUTelMille::findtracks2(
-                            int missinghits,
                             std::vector<IntVec > &indexarray,
-                            IntVec vec,
-                            std::vector<std::vector<EUTelMille::HitsInPlane> > &_allHitsArray,
-                            unsigned int i,
-                            int y
+                            std::vector<std::vector<EUTelMille::HitsInPlane> > &_allHitsArray
                             )
 {
- if(y==-1) missinghits++;
- streamlog_out(DEBUG9) << "Missing hits:" << missinghits << std::endl;
-
- if( missinghits > getAllowedMissingHits() ) 
- {
-   // recursive chain is dropped here;
-   streamlog_out(DEBUG9) << "indexarray size:" << indexarray.size() << std::endl;
-   return;
- }
-
- if(i>0)
- { 
-    vec.push_back(y); // recall hit id from the plane (i-1)
- }
-
-
- if( (_allHitsArray[i].size() == 0) && (i <_allHitsArray.size()-1) )
- {
-    findtracks2(missinghits,indexarray,vec, _allHitsArray, i+1, -1 ); 
- } 
-
- for(size_t j =0; j < _allHitsArray[i].size(); j++)
+  if( !_prunedTrackSearch )
     {
-      int ihit = static_cast< int >(j);
-      streamlog_out(DEBUG5) << "ihit:" << ihit << std::endl;
-
-      //if we are not in the last plane, call this method again
-      if(i < _allHitsArray.size()-1)
-        {
-          vec.push_back( ihit); //index of the cluster in the last plane
-         
-          //track candidate requirements
-          bool taketrack = true;
-          const int e = vec.size()-2;
-          if(e >= 0)
-            {
-              double residualX  = -999999.;
-              double residualY  = -999999.;
-              double residualZ  = -999999.;
-
-              // ACTIVE
-              // stop on the last non-zero hit
-
-              // now loop through all hits on a track candidate "vec"
-              // start at the end, stop on the first non-zero hit
-              for(int ivec=e; ivec>=e; --ivec)                  //     <-> OFF
-              {
-                if(vec[ivec]>=0) // non zero hit has id vec[ivec]>=0 {otherwise -1}
-                {
-                  double x = _allHitsArray[ivec][vec[ivec]].measuredX;
-                  double y = _allHitsArray[ivec][vec[ivec]].measuredY;
-                  double z = _allHitsArray[ivec][vec[ivec]].measuredZ;
-                  residualX  = abs(x - _allHitsArray[e+1][vec[e+1]].measuredX);
-                  residualY  = abs(y - _allHitsArray[e+1][vec[e+1]].measuredY);
-                  residualZ  = abs(z - _allHitsArray[e+1][vec[e+1]].measuredZ);
-		  streamlog_out(DEBUG9) << "residuals:" << std::endl;
-		  streamlog_out(DEBUG9) << residualX << std::endl;
-		  streamlog_out(DEBUG9) << residualY << std::endl;
-		  streamlog_out(DEBUG9) << residualZ << std::endl;
-
-                  break; 
-                }   
-              }
-           
-             if ( 
-                   residualX < _residualsXMin[e] || residualX > _residualsXMax[e] ||
-                   residualY < _residualsYMin[e] || residualY > _residualsYMax[e] 
-                 )
-                 taketrack = false;
-
-              if( taketrack == false )
-              {
-                taketrack = true; 
-                ihit=-1;
-              } 
-            }
-          vec.pop_back(); 
-
-          if(taketrack)
-          { 
-              findtracks2(missinghits, indexarray, vec, _allHitsArray, i+1, ihit );
-          }
-        }
-      else
-        {
-          //we are in the last plane
-          vec.push_back( ihit ); //index of the cluster in the last plane
-
-          //track candidate requirements
-          bool taketrack = true;
-          const int e = vec.size()-2;
-          if(e >= 0)
-            {
-              double residualX  = -999999.;
-              double residualY  = -999999.;
-              //double residualZ  = -999999.;
-
-              // now loop through all hits on a track candidate "vec"
-              // start at the end, stop on the first non-zero hit
-              for(int ivec=e; ivec>=e; --ivec)                        //   <-> OFF
-              {
-                if(vec[ivec]>=0) // non zero hit has id vec[ivec]>=0 {otherwise -1}
-                {
-                  double x = _allHitsArray[ivec][vec[ivec]].measuredX;
-                  double y = _allHitsArray[ivec][vec[ivec]].measuredY;
-                  //double z = _allHitsArray[ivec][vec[ivec]].measuredZ;
-                  residualX  = abs(x - _allHitsArray[e+1][vec[e+1]].measuredX);
-                  residualY  = abs(y - _allHitsArray[e+1][vec[e+1]].measuredY);
-                  //residualZ  = abs(z - _allHitsArray[e+1][vec[e+1]].measuredZ);
-                  break; 
-                }   
-              }
-           
-              if ( 
-                   residualX < _residualsXMin[e] || residualX > _residualsXMax[e] ||
-                   residualY < _residualsYMin[e] || residualY > _residualsYMax[e] 
-                 )
-                 taketrack = false;
- 
-              if( taketrack == false )
-              {
-                taketrack = true; 
-                ihit=-1;
-              } 
-            }
-
-          if(static_cast< int >(indexarray.size()) >= _maxTrackCandidates)
-            taketrack = false;
- 
-          if(taketrack)
-            {
-               indexarray.push_back(vec);
-	       streamlog_out(DEBUG9) << "indexarray size at last plane:" << indexarray.size() << std::endl;
-            }
-          vec.pop_back(); //last element must be removed because the
-                          //vector is still used -> we are in a last plane hit loop!
-
-        }
+      _trackFinder.findLegacy(_allHitsArray, indexarray);
     }
-
-  if( (_allHitsArray[i].size() == 0) && (i >= _allHitsArray.size()-1) )
-  {
-               indexarray.push_back(vec);
-  } 
+  else if( !_trackFinder.findPruned(_allHitsArray, indexarray) )
+    {
+      streamlog_out(DEBUG5) << "Track finder stopped after " << _maxTrackFinderBranches << " branches in event " << _iEvt << std::endl;
+    }
+  streamlog_out(DEBUG9) << "indexarray size:" << indexarray.size() << std::endl;
 }
 
 
@@ -999,54 +877,7 @@ double residYFit[], double angleFit[2]) {
 
 void  EUTelMille::FillHotPixelMap(LCEvent *event)
 {
-    LCCollectionVec *hotPixelCollectionVec = 0;
-    try 
-    {
-      hotPixelCollectionVec = static_cast< LCCollectionVec* > ( event->getCollection( _hotPixelCollectionName  ) );
-    }
-    catch (...)
-    {
-      if (!_hotPixelCollectionName.empty())
-	streamlog_out ( WARNING ) << "_hotPixelCollectionName " << _hotPixelCollectionName.c_str() << " not found" << endl; 
-      return;
-    }
-
-        CellIDDecoder<TrackerDataImpl> cellDecoder( hotPixelCollectionVec );
-	
-        for(int i=0; i<  hotPixelCollectionVec->getNumberOfElements(); i++)
-        {
-           TrackerDataImpl* hotPixelData = dynamic_cast< TrackerDataImpl *> ( hotPixelCollectionVec->getElementAt( i ) );
-	   SparsePixelType  type         = static_cast<SparsePixelType> (static_cast<int> (cellDecoder( hotPixelData )["sparsePixelType"]));
-
-	   int sensorID              = static_cast<int > ( cellDecoder( hotPixelData )["sensorID"] );
-
-           if( type  ==  kEUTelGenericSparsePixel ) {  
-				std::unique_ptr<EUTelSparseClusterImpl<EUTelGenericSparsePixel>> m26Data = std::make_unique<EUTelSparseClusterImpl<EUTelGenericSparsePixel>>(hotPixelData);
-
-              std::vector<EUTelGenericSparsePixel*> m26PixelVec;
-	      EUTelGenericSparsePixel m26Pixel;
-  	      //Push all single Pixels of one plane in the m26PixelVec
-
-             for ( unsigned int iPixel = 0; iPixel < m26Data->size(); iPixel++ ) 
-             {
-              IntVec m26ColVec();
-              m26Data->getSparsePixelAt( iPixel, &m26Pixel);
-              streamlog_out ( DEBUG3 ) << iPixel << " of " << m26Data->size() << " HotPixelInfo:  " << m26Pixel.getXCoord() << " " << m26Pixel.getYCoord() << " " << m26Pixel.getSignal() << endl;
-              try
-              {
-                 char ix[100];
-                 sprintf(ix, "%d,%d,%d", sensorID, m26Pixel.getXCoord(), m26Pixel.getYCoord() ); 
-                 _hotPixelMap[ix] = true;             
-              }
-              catch(...)
-              {
-                 std::cout << "can not add pixel " << std::endl;
-                 std::cout << sensorID << " " << m26Pixel.getXCoord() << " " << m26Pixel.getYCoord() << " " << std::endl;   
-              }
-             }
-           }
-       }
-
+  _hotPixelMask = Utility::FillHotPixelMask( event, _hotPixelCollectionName );
 }
 
 void  EUTelMille::findMatchedHits(int& _ntrack, Track* TrackHere) {
@@ -1285,7 +1116,7 @@ void EUTelMille::processEvent (LCEvent * event) {
     std::vector<IntVec > indexarray;
 
     streamlog_out( DEBUG5 ) << "Event #" << _iEvt << std::endl;
-    findtracks2(0, indexarray, IntVec(), _allHitsArray, 0, 0);
+    findtracks2(indexarray, _allHitsArray);
     for(size_t i = 0; i < indexarray.size(); i++)
       {
         for(size_t j = 0; j <  _nPlanes; j++)
@@ -2218,6 +2049,23 @@ else
 
         _nGoodTracks++;
 
+        // describe the track for the index of the binary
+        unsigned int topology = 0;
+        int nTrackHits = 0;
+        for (unsigned int help = 0; help < _nPlanes && help < 32; help++) {
+          bool excluded = false;
+          for (int helphelp = 0; helphelp < _nExcludePlanes; helphelp++) {
+            if (help == _excludePlanes[helphelp]) excluded = true;
+          }
+          bool const missing = abs(_xPosHere[help]) < 1e-06 && abs(_yPosHere[help]) < 1e-06 && abs(_zPosHere[help]) < 1e-06;
+          if (!excluded && !missing) {
+            topology |= 1u << help;
+            nTrackHits++;
+          }
+        }
+        _mille->setRecordInfo(event->getRunNumber(), event->getEventNumber(), topology,
+                              Chiquare[0] + Chiquare[1], 2 * nTrackHits - 4);
+
         // end local fit
         _mille->end();
 
@@ -2406,6 +2254,9 @@ TVector3 EUTelMille::Line2Plane(int iplane, const TVector3& lpoint, const TVecto
       
 bool EUTelMille::hitContainsHotPixels( TrackerHitImpl   * hit) 
 {
+  // if no hot pixel map was loaded, just return here
+  if( _hotPixelMask.empty() ) return 0;
+
   try
     {
       try{
@@ -2427,21 +2278,14 @@ bool EUTelMille::hitContainsHotPixels( TrackerHitImpl   * hit)
               {
                 EUTelGenericSparsePixel m26Pixel;
                 cluster->getSparsePixelAt( iPixel, &m26Pixel);
-                int pixelX, pixelY;
-                pixelX = m26Pixel.getXCoord();
-                pixelY = m26Pixel.getYCoord();
-
-		{                       
-		    char ix[100];
-		    sprintf(ix, "%d,%d,%d", sensorID, pixelX, pixelY ); 
-		    std::map<std::string, bool >::const_iterator z = _hotPixelMap.find(ix);
-		    if(z!=_hotPixelMap.end() && _hotPixelMap[ix] == true  )
-		      { 
-			streamlog_out(DEBUG3) << "Skipping hit as it was found in the hot pixel map." << endl;
-			return true; // if TRUE  this hit will be skipped
-		      }
-		} 
+                if( _hotPixelMask.isHot( sensorID, m26Pixel.getXCoord(), m26Pixel.getYCoord() ) )
+		  { 
+		    streamlog_out(DEBUG3) << "Skipping hit as it was found in the hot pixel map." << endl;
+		    delete cluster;
+		    return true; // if TRUE  this hit will be skipped
+		  }
 	      }
+	    delete cluster;
 
 	  } else if ( hit->getType() == kEUTelBrickedClusterImpl ) {
 
@@ -2492,7 +2336,11 @@ void EUTelMille::end() {
       delete []  hitsarray;
     }
 
-  // close the output file
+  // close the output file, the queued tracks are written first
+  if( !_mille->close() ) {
+    streamlog_out ( ERROR5 ) << _mille->getErrorMessage() << endl;
+  }
+  streamlog_out ( MESSAGE4 ) << "Tracks waiting for a free Millepede record buffer: " << _mille->getNQueueFull() << endl;
   delete _mille;
 
   // if write the pede steering file
@@ -2765,6 +2613,12 @@ void EUTelMille::end() {
   streamlog_out ( MESSAGE7 ) << "Number of data points used: " << _nMilleDataPoints << endl;
   streamlog_out ( MESSAGE7 ) << "Number of tracks used: " << _nMilleTracks << endl;
 
+  if ( (_inputMode == 0 || _inputMode == 2) && _prunedTrackSearch ) {
+    streamlog_out ( MESSAGE7 ) << "Track finder branches visited: " << _trackFinder.getNBranches()
+                               << ", pruned by the cuts: " << _trackFinder.getNPrunedBranches() << endl;
+    streamlog_out ( MESSAGE7 ) << "Events with the track finder stopped at MaxTrackFinderBranches: " << _trackFinder.getNTruncatedEvents() << endl;
+  }
+
   // monitor the number of tracks in CDash when running tests
   CDashMeasurement meas_ntracks("ntracks",_nMilleTracks); // cout << meas_ntracks;  // output only if DO_TESTING is set
 
@@ -2774,274 +2628,178 @@ void EUTelMille::end() {
     // check if steering file exists
     if (_generatePedeSteerfile == 1) {
 
-      std::string command = "pede " + _pedeSteerfileName;
-
-      streamlog_out ( MESSAGE5 ) << "Starting pede...: " << command.c_str() << endl;
+      streamlog_out ( MESSAGE5 ) << "Starting pede...: pede " << _pedeSteerfileName << endl;
 
-      bool encounteredError = false;
-      
-      // run pede and create a streambuf that reads its stdout and stderr
-      redi::ipstream pede( command.c_str(), redi::pstreams::pstdout|redi::pstreams::pstderr ); 
-      
-      if (!pede.is_open()) {
-	  streamlog_out( ERROR5 ) << "Pede cannot be executed: command not found in the path" << endl;
-	  encounteredError = true;	  
-      } else {
-
-	// output multiplexing: parse pede output in both stdout and stderr and echo messages accordingly
-	char buf[1024];
-	std::streamsize n;
-	std::stringstream pedeoutput; // store stdout to parse later
-	std::stringstream pedeerrors;
-	bool finished[2] = { false, false };
-	while (!finished[0] || !finished[1])
-	  {
-	    if (!finished[0])
-	      {
-		while ((n = pede.err().readsome(buf, sizeof(buf))) > 0){
-		  streamlog_out( ERROR5 ).write(buf, n).flush();
-		  string error (buf, n);
-		  pedeerrors << error;
-		  encounteredError = true;
-		}
-		if (pede.eof())
-		  {
-		    finished[0] = true;
-		    if (!finished[1])
-		      pede.clear();
-		  }
-	      }
-
-	    if (!finished[1])
-	      {
-		while ((n = pede.out().readsome(buf, sizeof(buf))) > 0){
-		  streamlog_out( MESSAGE4 ).write(buf, n).flush();
-		  string output (buf, n);
-		  pedeoutput << output;
-		}
-		if (pede.eof())
-		  {
-		    finished[1] = true;
-		    if (!finished[0])
-		      pede.clear();
-		  }
-	      }
-	  }
-
-	// pede does not return exit codes on some errors (in V03-04-00)
-	// check for some of those here by parsing the output
-	{
-	  const char * pch = strstr(pedeoutput.str().data(),"Too many rejects");
-	  if (pch){
-	    streamlog_out ( ERROR5 ) << "Pede stopped due to the large number of rejects. " << endl;
-	    encounteredError = true;
-	  }
-	}
-	
-	{
-	  const char* pch0 = strstr(pedeoutput.str().data(),"Sum(Chi^2)/Sum(Ndf) = ");
-	  if (pch0 != 0){
-	    streamlog_out ( DEBUG5 ) << " Parsing pede output for final chi2/ndf result.. " << endl;
-	    // search for the equal sign after which the result for chi2/ndf is stated within the next 80 chars 
-	    // (with offset of 22 chars since pch points to beginning of "Sum(..." string just found)
-	    char* pch = (char*)((memchr (pch0+22, '=', 180)));
-	    if (pch!=NULL){
-	      char str[16];
-	      // now copy the numbers after the equal sign
-	      strncpy ( str, pch+1, 15 );
-	      str[15] = '\0';   /* null character manually added */
-	      // monitor the chi2/ndf in CDash when running tests
-	      CDashMeasurement meas_chi2ndf("chi2_ndf",atof(str));  
-		  //std::cout << meas_chi2ndf; // output only if DO_TESTING is set
-	      streamlog_out ( MESSAGE6 ) << "Final Sum(Chi^2)/Sum(Ndf) = " << str << endl;
-	    }	    
-	  }
-	}
-
-        // wait for the pede execution to finish
-        pede.close();
-
-        // check the exit value of pede / react to previous errors
-        if ( pede.rdbuf()->status() == 0 && !encounteredError) 
-        {
-          streamlog_out ( MESSAGE7 ) << "Pede successfully finished" << endl;
-        } else {
-          streamlog_out ( ERROR5 ) << "Problem during Pede execution, exit status: " << pede.rdbuf()->status() << ", error messages (repeated here): " << endl;
-	  streamlog_out ( ERROR5 ) << pedeerrors.str() << endl;
-	  // TODO: decide what to do now; exit? and if, how?
-          streamlog_out ( ERROR5 ) << "Will exit now" << endl;
-	  //exit(EXIT_FAILURE); // FIXME: can lead to (ROOT?) seg faults - points to corrupt memory? run valgrind...
-	  return; // does fine for now
-	}
-
-        // reading back the millepede.res file and getting the
-        // results.
-        string millepedeResFileName = "millepede.res";
-
-        streamlog_out ( MESSAGE6 ) << "Reading back the " << millepedeResFileName << endl
-                                   << "Saving the alignment constant into " << _alignmentConstantLCIOFile << endl;
-
-        // open the millepede ASCII output file
-        ifstream millepede( millepedeResFileName.c_str() );
+      // run pede in the background, its output is echoed line by line
+      // while the driver parses the statistics
+      EUTelPedeDriver pede;
+      if ( !pede.start( _pedeSteerfileName ) ) {
+        streamlog_out( ERROR5 ) << "Pede cannot be executed: " << pede.getErrorMessage() << endl;
+        return;
+      }
 
+      std::stringstream pedeerrors;
+      EUTelPedeDriver::Statistics const& statistics = pede.wait( [&pedeerrors]( string const& line, bool isError ) {
+          if ( isError ) {
+            streamlog_out( ERROR5 ) << line << endl;
+            pedeerrors << line << endl;
+          } else {
+            streamlog_out( MESSAGE4 ) << line << endl;
+          }
+        } );
 
-        // reopen the LCIO file this time in append mode
-        LCWriter * lcWriter = LCFactory::getInstance()->createLCWriter();
+      // pede does not return exit codes on some errors (in V03-04-00)
+      // and anything on stderr is treated as an error as well
+      bool encounteredError = statistics.nErrorLines > 0;
+      if ( statistics.exitStatus == 127 ) {
+        streamlog_out( ERROR5 ) << "Pede cannot be executed: command not found in the path" << endl;
+      }
+      if ( statistics.tooManyRejects ) {
+        streamlog_out ( ERROR5 ) << "Pede stopped due to the large number of rejects. " << endl;
+        encounteredError = true;
+      }
+      if ( statistics.nRecords >= 0 ) {
+        streamlog_out ( MESSAGE6 ) << "Pede records: " << statistics.nRecords << ", rejected in the last iteration: "
+                                   << statistics.rejected[0] << " (rank deficit/NaN) "
+                                   << statistics.rejected[1] << " (Ndf=0) "
+                                   << statistics.rejected[2] << " (huge) "
+                                   << statistics.rejected[3] << " (large)" << endl;
+      }
+      if ( statistics.hasChi2Ndf ) {
+        // monitor the chi2/ndf in CDash when running tests
+        CDashMeasurement meas_chi2ndf("chi2_ndf",statistics.chi2Ndf);
+        streamlog_out ( MESSAGE6 ) << "Final Sum(Chi^2)/Sum(Ndf) = " << statistics.chi2Ndf << endl;
+      }
 
-        try 
-        {
-          lcWriter->open( _alignmentConstantLCIOFile, LCIO::WRITE_NEW );
-        }
-        catch ( IOException& e ) 
-        {
-          streamlog_out ( ERROR4 ) << e.what() << endl
-                                   << "Sorry for quitting. " << endl;
-          exit(-1);
-        }
+      // check the exit value of pede / react to previous errors
+      if ( statistics.exitStatus == 0 && !encounteredError)
+      {
+        streamlog_out ( MESSAGE7 ) << "Pede successfully finished" << endl;
+      } else {
+        streamlog_out ( ERROR5 ) << "Problem during Pede execution, exit status: " << statistics.exitStatus << ", error messages (repeated here): " << endl;
+        streamlog_out ( ERROR5 ) << pedeerrors.str() << endl;
+        // TODO: decide what to do now; exit? and if, how?
+        streamlog_out ( ERROR5 ) << "Will exit now" << endl;
+        //exit(EXIT_FAILURE); // FIXME: can lead to (ROOT?) seg faults - points to corrupt memory? run valgrind...
+        return; // does fine for now
+      }
 
+      // the driver has read back the millepede.res file
+      streamlog_out ( MESSAGE6 ) << "Reading back the " << pede.getResultFileName() << endl
+                                 << "Saving the alignment constant into " << _alignmentConstantLCIOFile << endl;
 
-        // write an almost empty run header
-        LCRunHeaderImpl * lcHeader  = new LCRunHeaderImpl;
-        lcHeader->setRunNumber( 0 );
+      // reopen the LCIO file this time in append mode
+      LCWriter * lcWriter = LCFactory::getInstance()->createLCWriter();
 
-        lcWriter->writeRunHeader(lcHeader);
+      try
+      {
+        lcWriter->open( _alignmentConstantLCIOFile, LCIO::WRITE_NEW );
+      }
+      catch ( IOException& e )
+      {
+        streamlog_out ( ERROR4 ) << e.what() << endl
+                                 << "Sorry for quitting. " << endl;
+        exit(-1);
+      }
 
-        delete lcHeader;
 
-        LCEventImpl * event = new LCEventImpl;
-        event->setRunNumber( 0 );
-        event->setEventNumber( 0 );
+      // write an almost empty run header
+      LCRunHeaderImpl * lcHeader  = new LCRunHeaderImpl;
+      lcHeader->setRunNumber( 0 );
 
-        LCTime * now = new LCTime;
-        event->setTimeStamp( now->timeStamp() );
-        delete now;
+      lcWriter->writeRunHeader(lcHeader);
 
-        LCCollectionVec * constantsCollection = new LCCollectionVec( LCIO::LCGENERICOBJECT );
+      delete lcHeader;
 
+      LCEventImpl * event = new LCEventImpl;
+      event->setRunNumber( 0 );
+      event->setEventNumber( 0 );
 
-        if ( millepede.bad() || !millepede.is_open() ) 
-        {
-          streamlog_out ( ERROR4 ) << "Error opening the " << millepedeResFileName << endl
-                                   << "The alignment slcio file cannot be saved" << endl;
-        }
-        else 
-        {
-          vector<double > tokens;
-          stringstream tokenizer;
-          string line;
+      LCTime * now = new LCTime;
+      event->setTimeStamp( now->timeStamp() );
+      delete now;
 
-          // get the first line and throw it away since it is a
-          // comment!
-          getline( millepede, line );
+      LCCollectionVec * constantsCollection = new LCCollectionVec( LCIO::LCGENERICOBJECT );
 
-          int counter = 0;
+      vector<EUTelPedeDriver::Parameter> const& parameters = pede.getParameters();
+      if ( !pede.getErrorMessage().empty() )
+      {
+        streamlog_out ( ERROR4 ) << pede.getErrorMessage() << endl
+                                 << "The alignment slcio file cannot be saved" << endl;
+      }
+      else
+      {
+        // the parameters of a sensor follow each other
+        unsigned int const numpars = ( _alignMode != 3 ) ? 3 : 6;
 
-          while ( ! millepede.eof() ) {
+        for ( size_t first = 0, counter = 0; first + numpars <= parameters.size(); first += numpars, ++counter ) {
 
-            EUTelAlignmentConstant * constant = new EUTelAlignmentConstant;
+          EUTelAlignmentConstant * constant = new EUTelAlignmentConstant;
 
-            bool goodLine = true;
-            unsigned int numpars = 0;
+          for ( unsigned int iParam = 0 ; iParam < numpars ; ++iParam )
+          {
+            EUTelPedeDriver::Parameter const& parameter = parameters[ first + iParam ];
+            bool isFixed = parameter.fixed;
             if(_alignMode != 3)
-              numpars = 3;
-            else
-              numpars = 6;
-
-            for ( unsigned int iParam = 0 ; iParam < numpars ; ++iParam ) 
-            {
-              getline( millepede, line );
-
-              if ( line.empty() ) {
-                goodLine = false;
-                continue;
-              }
-
-              tokens.clear();
-              tokenizer.clear();
-              tokenizer.str( line );
-
-	      double buffer;
-              // // check that all parts of the line are non zero
-              while ( tokenizer >> buffer ) {
-                tokens.push_back( buffer ) ;
+              {
+                if ( iParam == 0 ) {
+                  constant->setXOffset( parameter.value / 1000. );
+                  if ( ! isFixed ) constant->setXOffsetError( parameter.error / 1000. ) ;
+                }
+                if ( iParam == 1 ) {
+                  constant->setYOffset( parameter.value / 1000. ) ;
+                  if ( ! isFixed ) constant->setYOffsetError( parameter.error / 1000. ) ;
+                }
+                if ( iParam == 2 ) {
+                  constant->setGamma( parameter.value  ) ;
+                  if ( ! isFixed ) constant->setGammaError( parameter.error ) ;
+                }
               }
-
-              if ( ( tokens.size() == 3 ) || ( tokens.size() == 6 ) || (tokens.size() == 5) ) {
-                goodLine = true;
-              } else goodLine = false;
-
-              bool isFixed = ( tokens.size() == 3 );
-              if(_alignMode != 3)
-                {
-                 if ( iParam == 0 ) {
-                    constant->setXOffset( tokens[1] / 1000. );
-                    if ( ! isFixed ) constant->setXOffsetError( tokens[4] / 1000. ) ;
-                  }
-                  if ( iParam == 1 ) {
-                    constant->setYOffset( tokens[1] / 1000. ) ;
-                    if ( ! isFixed ) constant->setYOffsetError( tokens[4] / 1000. ) ;
-                  }
-                  if ( iParam == 2 ) {
-                    constant->setGamma( tokens[1]  ) ;
-                    if ( ! isFixed ) constant->setGammaError( tokens[4] ) ;
-                  }
+            else
+              {
+                if ( iParam == 0 ) {
+                  constant->setXOffset( parameter.value / 1000. );
+                  if ( ! isFixed ) constant->setXOffsetError( parameter.error / 1000. ) ;
                 }
-              else
-                {
-                 if ( iParam == 0 ) {
-                    constant->setXOffset( tokens[1] / 1000. );
-                    if ( ! isFixed ) constant->setXOffsetError( tokens[4] / 1000. ) ;                    
-                  }
-                  if ( iParam == 1 ) {
-                    constant->setYOffset( tokens[1] / 1000. ) ;
-                    if ( ! isFixed ) constant->setYOffsetError( tokens[4] / 1000. ) ;
-                  }
-                  if ( iParam == 2 ) {
-                    constant->setZOffset( tokens[1] / 1000. ) ;
-                    if ( ! isFixed ) constant->setZOffsetError( tokens[4] / 1000. ) ;
-                  }
-                  if ( iParam == 3 ) {
-                    constant->setAlpha( tokens[1]  ) ;
-                    if ( ! isFixed ) constant->setAlphaError( tokens[4] ) ;
-                  } 
-                  if ( iParam == 4 ) {
-                    constant->setBeta( tokens[1]  ) ;
-                    if ( ! isFixed ) constant->setBetaError( tokens[4] ) ;
-                  } 
-                  if ( iParam == 5 ) {
-                    constant->setGamma( tokens[1]  ) ;
-                    if ( ! isFixed ) constant->setGammaError( tokens[4] ) ;
-                  } 
-
+                if ( iParam == 1 ) {
+                  constant->setYOffset( parameter.value / 1000. ) ;
+                  if ( ! isFixed ) constant->setYOffsetError( parameter.error / 1000. ) ;
                 }
-              
-            }
-
-
-            // right place to add the constant to the collection
-            if ( goodLine  ) {
-//               constant->setSensorID( _orderedSensorID_wo_excluded.at( counter ) );
-              constant->setSensorID( _orderedSensorID.at( counter ) );
-              ++ counter;
-              constantsCollection->push_back( constant );
-              streamlog_out ( MESSAGE0 ) << (*constant) << endl;
-            }
-            else delete constant;
+                if ( iParam == 2 ) {
+                  constant->setZOffset( parameter.value / 1000. ) ;
+                  if ( ! isFixed ) constant->setZOffsetError( parameter.error / 1000. ) ;
+                }
+                if ( iParam == 3 ) {
+                  constant->setAlpha( parameter.value  ) ;
+                  if ( ! isFixed ) constant->setAlphaError( parameter.error ) ;
+                }
+                if ( iParam == 4 ) {
+                  constant->setBeta( parameter.value  ) ;
+                  if ( ! isFixed ) constant->setBetaError( parameter.error ) ;
+                }
+                if ( iParam == 5 ) {
+                  constant->setGamma( parameter.value  ) ;
+                  if ( ! isFixed ) constant->setGammaError( parameter.error ) ;
+                }
+              }
           }
 
+//           constant->setSensorID( _orderedSensorID_wo_excluded.at( counter ) );
+          constant->setSensorID( _orderedSensorID.at( counter ) );
+          constantsCollection->push_back( constant );
+          streamlog_out ( MESSAGE0 ) << (*constant) << endl;
         }
 
+      }
 
 
-        event->addCollection( constantsCollection, _alignmentConstantCollectionName );
-        lcWriter->writeEvent( event );
-        delete event;
 
-        lcWriter->close();
+      event->addCollection( constantsCollection, _alignmentConstantCollectionName );
+      lcWriter->writeEvent( event );
+      delete event;
 
-        millepede.close();
+      lcWriter->close();
 
-      }
     } else {
 
       streamlog_out ( ERROR2 ) << "Unable to run pede. No steering file has been generated." << endl;
@@ -0,0 +1,239 @@
+/*
+ *   This source code is part of the Eutelescope package of Marlin.
+ *   You are free to use this source files for your own development as
+ *   long as it stays in a public research context. You are not
+ *   allowed to use it for commercial purpose. You must put this
+ *   header with author names in all development based on this file.
+ *
+ */
+
+// eutelescope includes ".h"
+#include "EUTelMilleTrackFinder.h"
+
+// system includes <>
+#include <algorithm>
+#include <cmath>
+
+using namespace eutelescope;
+
+EUTelMilleTrackFinder::EUTelMilleTrackFinder():
+  _residualsXMin(),
+  _residualsXMax(),
+  _residualsYMin(),
+  _residualsYMax(),
+  _allowedMissingHits(0),
+  _maxTrackCandidates(2000),
+  _maxTrackSlope(0.),
+  _maxBranches(0),
+  _nBranches(0),
+  _nPrunedBranches(0),
+  _nTruncatedEvents(0),
+  _hitsSortedInX(),
+  _zMin(),
+  _zMax(),
+  _candidate(),
+  _lastHitPlane(),
+  _missingHits(),
+  _choices(),
+  _nextChoice()
+{
+}
+
+void EUTelMilleTrackFinder::setResidualCuts(std::vector<float> const& xMin, std::vector<float> const& xMax,
+                                            std::vector<float> const& yMin, std::vector<float> const& yMax)
+{
+  _residualsXMin = xMin;
+  _residualsXMax = xMax;
+  _residualsYMin = yMin;
+  _residualsYMax = yMax;
+}
+
+void EUTelMilleTrackFinder::findLegacy(HitsArray const& hits, std::vector<std::vector<int> >& indexarray)
+{
+  if( hits.empty() ) return;
+  findLegacy(0, indexarray, std::vector<int>(), hits, 0, 0);
+}
+
+void EUTelMilleTrackFinder::findLegacy(int missinghits, std::vector<std::vector<int> >& indexarray, std::vector<int> vec,
+                                       HitsArray const& hits, unsigned int i, int y)
+{
+  if( y == -1 ) missinghits++;
+  if( missinghits > _allowedMissingHits ) return;
+
+  // recall hit id from the plane (i-1)
+  if( i > 0 ) vec.push_back(y);
+
+  if( hits[i].empty() && i < hits.size()-1 ) findLegacy(missinghits, indexarray, vec, hits, i+1, -1);
+
+  for(size_t j = 0; j < hits[i].size(); j++)
+    {
+      int ihit = static_cast< int >(j);
+      vec.push_back(ihit);
+
+      // compare with the hit on the plane before, fails after a missed plane
+      const int e = vec.size()-2;
+      if( e >= 0 )
+        {
+          double residualX = -999999.;
+          double residualY = -999999.;
+          if( vec[e] >= 0 )
+            {
+              residualX = std::abs(hits[e][vec[e]].measuredX - hits[e+1][vec[e+1]].measuredX);
+              residualY = std::abs(hits[e][vec[e]].measuredY - hits[e+1][vec[e+1]].measuredY);
+            }
+          // a hit failing the cut makes the plane a missed one
+          if( residualX < _residualsXMin[e] || residualX > _residualsXMax[e] ||
+              residualY < _residualsYMin[e] || residualY > _residualsYMax[e] )
+            ihit = -1;
+        }
+
+      if( i < hits.size()-1 )
+        {
+          vec.pop_back();
+          findLegacy(missinghits, indexarray, vec, hits, i+1, ihit);
+        }
+      else
+        {
+          // on the last plane the hit is kept, ihit is not looked at
+          if( static_cast< int >(indexarray.size()) < _maxTrackCandidates ) indexarray.push_back(vec);
+          vec.pop_back();
+        }
+    }
+
+  if( hits[i].empty() && i >= hits.size()-1 ) indexarray.push_back(vec);
+}
+
+void EUTelMilleTrackFinder::selectHits(HitsArray const& hits, int i)
+{
+  std::vector<int>& choices = _choices[i];
+  std::vector<int> const& sorted = _hitsSortedInX[i];
+  const int last = _lastHitPlane[i];
+  _nextChoice[i] = 0;
+
+  if( last < 0 )
+    {
+      // no hit yet, nothing to cut on
+      choices = sorted;
+    }
+  else
+    {
+      HitsInPlane const& previous = hits[last][_candidate[last]];
+
+      // over missed planes the distances can add up
+      double windowX = 0.;
+      double windowY = 0.;
+      for(int k = last; k < i; k++)
+        {
+          windowX += _residualsXMax[k];
+          windowY += _residualsYMax[k];
+        }
+      if( _maxTrackSlope > 0. )
+        {
+          const double dz = std::max(std::fabs(_zMin[i] - previous.measuredZ), std::fabs(_zMax[i] - previous.measuredZ));
+          windowX = std::min(windowX, _maxTrackSlope * dz);
+          windowY = std::min(windowY, _maxTrackSlope * dz);
+        }
+
+      std::vector<HitsInPlane> const& planeHits = hits[i];
+      std::vector<int>::const_iterator first = std::lower_bound(sorted.begin(), sorted.end(), previous.measuredX - windowX,
+                                                                [&planeHits](int hit, double x) { return planeHits[hit].measuredX < x; });
+      std::vector<int>::const_iterator end = std::upper_bound(first, sorted.end(), previous.measuredX + windowX,
+                                                              [&planeHits](double x, int hit) { return x < planeHits[hit].measuredX; });
+
+      choices.clear();
+      for(std::vector<int>::const_iterator it = first; it != end; ++it)
+        {
+          HitsInPlane const& hit = planeHits[*it];
+          const double residualX = std::fabs(hit.measuredX - previous.measuredX);
+          const double residualY = std::fabs(hit.measuredY - previous.measuredY);
+
+          bool taketrack = residualY <= windowY;
+          if( taketrack && last == i - 1 )
+            {
+              taketrack = residualX >= _residualsXMin[last] && residualX <= _residualsXMax[last] &&
+                          residualY >= _residualsYMin[last] && residualY <= _residualsYMax[last];
+            }
+          if( taketrack && _maxTrackSlope > 0. )
+            {
+              const double dz = std::fabs(hit.measuredZ - previous.measuredZ);
+              taketrack = residualX <= _maxTrackSlope * dz && residualY <= _maxTrackSlope * dz;
+            }
+          if( taketrack ) choices.push_back(*it);
+        }
+      _nPrunedBranches += static_cast< long long >(sorted.size() - choices.size());
+    }
+
+  // the plane is missed only if none of its hits fits, so a full
+  // track does not come along with copies of itself missing a plane
+  if( choices.empty() && _missingHits[i] < _allowedMissingHits ) choices.push_back(-1);
+}
+
+bool EUTelMilleTrackFinder::findPruned(HitsArray const& hits, std::vector<std::vector<int> >& indexarray)
+{
+  const int nPlanes = static_cast< int >(hits.size());
+  if( nPlanes == 0 ) return true;
+
+  // sort the hits of every plane in x, the windows are then found by bisection
+  _hitsSortedInX.resize(nPlanes);
+  _zMin.assign(nPlanes, 0.);
+  _zMax.assign(nPlanes, 0.);
+  for(int i = 0; i < nPlanes; i++)
+    {
+      std::vector<HitsInPlane> const& planeHits = hits[i];
+      std::vector<int>& sorted = _hitsSortedInX[i];
+      sorted.resize(planeHits.size());
+      for(size_t j = 0; j < planeHits.size(); j++)
+        {
+          sorted[j] = static_cast< int >(j);
+          if( j == 0 || planeHits[j].measuredZ < _zMin[i] ) _zMin[i] = planeHits[j].measuredZ;
+          if( j == 0 || planeHits[j].measuredZ > _zMax[i] ) _zMax[i] = planeHits[j].measuredZ;
+        }
+      std::sort(sorted.begin(), sorted.end(),
+                [&planeHits](int a, int b) { return planeHits[a].measuredX < planeHits[b].measuredX; });
+    }
+
+  _candidate.assign(nPlanes, -1);
+  _lastHitPlane.assign(nPlanes, -1);
+  _missingHits.assign(nPlanes, 0);
+  _choices.resize(nPlanes);
+  _nextChoice.assign(nPlanes, 0);
+
+  bool complete = true;
+  long long branches = 0;
+  int i = 0;
+  selectHits(hits, 0);
+  while( i >= 0 )
+    {
+      if( _nextChoice[i] >= static_cast< int >(_choices[i].size()) )
+        {
+          --i;
+          continue;
+        }
+      _candidate[i] = _choices[i][_nextChoice[i]++];
+
+      if( ++branches > _maxBranches && _maxBranches > 0 )
+        {
+          _nTruncatedEvents++;
+          complete = false;
+          break;
+        }
+
+      if( i < nPlanes - 1 )
+        {
+          _lastHitPlane[i+1] = _candidate[i] >= 0 ? i : _lastHitPlane[i];
+          _missingHits[i+1] = _missingHits[i] + ( _candidate[i] < 0 ? 1 : 0 );
+          ++i;
+          selectHits(hits, i);
+          continue;
+        }
+
+      // we are in the last plane, a straight line needs two hits
+      const int nHits = nPlanes - _missingHits[i] - ( _candidate[i] < 0 ? 1 : 0 );
+      if( nHits < 2 ) continue;
+
+      if( static_cast< int >(indexarray.size()) >= _maxTrackCandidates ) break;
+      indexarray.push_back(_candidate);
+    }
+  _nBranches += branches;
+  return complete;
+}
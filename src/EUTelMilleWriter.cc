@@ -0,0 +1,343 @@
+/*
+ *   This source code is part of the Eutelescope package of Marlin.
+ *   You are free to use this source files for your own development as
+ *   long as it stays in a public research context. You are not
+ *   allowed to use it for commercial purpose. You must put this
+ *   header with author names in all development based on this file.
+ *
+ */
+
+// eutelescope includes ".h"
+#include "EUTelMilleWriter.h"
+
+// system includes <>
+#include <cerrno>
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+
+#ifdef USE_ZLIB
+#include <zlib.h>
+#endif
+
+using namespace eutelescope;
+
+namespace {
+  //! Identifies an index file and its layout
+  char const indexMagic[8] = { 'E', 'U', 'T', 'M', 'I', 'D', 'X', '1' };
+
+  //! Write buffer of the files
+  size_t const fileBufferSize = 1 << 20;
+}
+
+//! Binary file, gzip compressed when Eutelescope is built with zlib
+/*! Reading goes through zlib as well, which also reads uncompressed
+ *  files.
+ */
+class EUTelMilleWriter::File {
+
+public:
+  File() : _plain(0)
+#ifdef USE_ZLIB
+         , _compressed(0)
+#endif
+  { }
+
+  ~File() { close(); }
+
+  bool open(std::string const& fileName, bool forWriting, bool compress) {
+#ifdef USE_ZLIB
+    if( compress || !forWriting ) {
+      // Fast compression, the I/O thread has to keep up with the processor
+      _compressed = gzopen( fileName.c_str(), forWriting ? "wb1" : "rb" );
+      if( _compressed ) gzbuffer( _compressed, fileBufferSize );
+      return _compressed != 0;
+    }
+#else
+    (void) compress;
+#endif
+    _plain = fopen( fileName.c_str(), forWriting ? "wb" : "rb" );
+    if( _plain ) setvbuf( _plain, 0, _IOFBF, fileBufferSize );
+    return _plain != 0;
+  }
+
+  bool write(void const* data, size_t size) {
+#ifdef USE_ZLIB
+    if( _compressed ) return gzwrite( _compressed, data, size ) == static_cast<int>( size );
+#endif
+    return fwrite( data, 1, size, _plain ) == size;
+  }
+
+  bool read(void* data, size_t size) {
+#ifdef USE_ZLIB
+    if( _compressed ) return gzread( _compressed, data, size ) == static_cast<int>( size );
+#endif
+    return fread( data, 1, size, _plain ) == size;
+  }
+
+  bool close() {
+    bool ok = true;
+#ifdef USE_ZLIB
+    if( _compressed ) ok = gzclose( _compressed ) == Z_OK;
+    _compressed = 0;
+#endif
+    if( _plain ) ok = fclose( _plain ) == 0;
+    _plain = 0;
+    return ok;
+  }
+
+private:
+  FILE* _plain;
+#ifdef USE_ZLIB
+  gzFile _compressed;
+#endif
+};
+
+EUTelMilleWriter::EUTelMilleWriter():
+  _current(),
+  _queue(),
+  _head(0),
+  _tail(0),
+  _stop(false),
+  _failed(false),
+  _file(0),
+  _index(0),
+  _writer(),
+  _fileName(),
+  _errorMessage(),
+  _nRecords(0),
+  _nQueueFull(0)
+{
+}
+
+EUTelMilleWriter::~EUTelMilleWriter()
+{
+  close();
+}
+
+bool EUTelMilleWriter::open(std::string const& fileName, bool compress, bool writeIndex, size_t queueSize)
+{
+  close();
+  _fileName = fileName;
+  _errorMessage.clear();
+
+  _file = new File;
+  if( !_file->open( fileName, true, compress ) ) {
+    _errorMessage = "Cannot open " + fileName + ": " + strerror( errno );
+    delete _file;
+    _file = 0;
+    return false;
+  }
+  if( writeIndex ) {
+    _index = new File;
+    if( !_index->open( indexFileName( fileName ), true, false ) || !_index->write( indexMagic, sizeof( indexMagic ) ) ) {
+      _errorMessage = "Cannot open " + indexFileName( fileName ) + ": " + strerror( errno );
+      delete _index;
+      _index = 0;
+      delete _file;
+      _file = 0;
+      return false;
+    }
+  }
+
+  _queue.resize( queueSize > 0 ? queueSize : 1 );
+  _head = 0;
+  _tail = 0;
+  _stop = false;
+  _failed = false;
+  _nRecords = 0;
+  _nQueueFull = 0;
+  kill();
+  _writer = std::thread( &EUTelMilleWriter::write, this );
+  return true;
+}
+
+bool EUTelMilleWriter::close()
+{
+  if( !_writer.joinable() ) return _errorMessage.empty();
+
+  _stop.store( true, std::memory_order_release );
+  _writer.join();
+
+  bool ok = !_failed;
+  if( !_file->close() ) ok = false;
+  if( _index && !_index->close() ) ok = false;
+  delete _file;
+  delete _index;
+  _file = 0;
+  _index = 0;
+  if( !ok ) _errorMessage = "Writing " + _fileName + " failed";
+  return ok;
+}
+
+void EUTelMilleWriter::mille(int nLocal, float const* derLocal, int nGlobal, float const* derGlobal,
+                             int const* label, float measurement, float sigma)
+{
+  if( sigma <= 0. ) return;
+
+  // The first word of a record is an error counter, always zero
+  if( _current.floats.empty() ) {
+    _current.floats.push_back( 0. );
+    _current.ints.push_back( 0 );
+  }
+
+  _current.floats.push_back( measurement );
+  _current.ints.push_back( 0 );
+  for( int i = 0; i < nLocal; ++i ) {
+    if( derLocal[i] == 0. ) continue;
+    _current.floats.push_back( derLocal[i] );
+    _current.ints.push_back( i + 1 );
+  }
+  _current.floats.push_back( sigma );
+  _current.ints.push_back( 0 );
+  for( int i = 0; i < nGlobal; ++i ) {
+    if( derGlobal[i] == 0. || label[i] <= 0 ) continue;
+    _current.floats.push_back( derGlobal[i] );
+    _current.ints.push_back( label[i] );
+  }
+}
+
+void EUTelMilleWriter::setRecordInfo(int run, int event, unsigned int topology, float chi2, int ndf)
+{
+  _current.info.run = run;
+  _current.info.event = event;
+  _current.info.topology = topology;
+  _current.info.chi2 = chi2;
+  _current.info.ndf = ndf;
+}
+
+void EUTelMilleWriter::kill()
+{
+  _current.floats.clear();
+  _current.ints.clear();
+  _current.info = RecordInfo();
+}
+
+void EUTelMilleWriter::end()
+{
+  if( _current.floats.size() < 2 || !_writer.joinable() ) {
+    kill();
+    return;
+  }
+
+  // Wait for a free buffer, the I/O thread is behind
+  size_t const head = _head.load( std::memory_order_relaxed );
+  if( head - _tail.load( std::memory_order_acquire ) == _queue.size() ) {
+    ++_nQueueFull;
+    while( head - _tail.load( std::memory_order_acquire ) == _queue.size() ) std::this_thread::yield();
+  }
+
+  // Hand over the record and take the written buffers of the slot for the next one
+  Record& slot = _queue[ head % _queue.size() ];
+  slot.floats.swap( _current.floats );
+  slot.ints.swap( _current.ints );
+  slot.info = _current.info;
+  _head.store( head + 1, std::memory_order_release );
+  ++_nRecords;
+  kill();
+}
+
+void EUTelMilleWriter::write()
+{
+  uint64_t offset = 0;
+  int idle = 0;
+  for( ;; ) {
+    size_t const tail = _tail.load( std::memory_order_relaxed );
+    if( tail == _head.load( std::memory_order_acquire ) ) {
+      // Check the queue once more after the stop, records may have come in between
+      if( _stop.load( std::memory_order_acquire ) && tail == _head.load( std::memory_order_acquire ) ) break;
+      if( ++idle < 64 ) std::this_thread::yield();
+      else std::this_thread::sleep_for( std::chrono::microseconds( 200 ) );
+      continue;
+    }
+    idle = 0;
+
+    Record& record = _queue[ tail % _queue.size() ];
+    if( !_failed.load( std::memory_order_relaxed ) ) {
+      // Same layout as Mille: number of words, the floats, then the ints
+      int32_t const words = static_cast<int32_t>( 2 * record.floats.size() );
+      record.info.offset = offset;
+      record.info.size = sizeof( words ) + words * sizeof( float );
+      bool ok = _file->write( &words, sizeof( words ) )
+        && _file->write( &record.floats[0], record.floats.size() * sizeof( float ) )
+        && _file->write( &record.ints[0], record.ints.size() * sizeof( int ) );
+      if( ok && _index ) ok = _index->write( &record.info, sizeof( RecordInfo ) );
+      if( !ok ) _failed.store( true, std::memory_order_relaxed );
+      offset += record.info.size;
+    }
+    _tail.store( tail + 1, std::memory_order_release );
+  }
+}
+
+bool EUTelMilleWriter::readIndex(std::string const& fileName, std::vector<RecordInfo>& records, std::string& errorMessage)
+{
+  records.clear();
+  FILE* file = fopen( fileName.c_str(), "rb" );
+  if( !file ) {
+    errorMessage = "Cannot open " + fileName + ": " + strerror( errno );
+    return false;
+  }
+  char magic[ sizeof( indexMagic ) ];
+  if( fread( magic, 1, sizeof( magic ), file ) != sizeof( magic ) || memcmp( magic, indexMagic, sizeof( magic ) ) != 0 ) {
+    errorMessage = fileName + " is not a Millepede binary index";
+    fclose( file );
+    return false;
+  }
+  RecordInfo info;
+  while( fread( &info, sizeof( info ), 1, file ) == 1 ) records.push_back( info );
+  fclose( file );
+  return true;
+}
+
+long EUTelMilleWriter::copyRecords(std::string const& input, std::string const& output, Selection const& selection,
+                                   bool compress, std::string& errorMessage)
+{
+  std::vector<RecordInfo> records;
+  if( !readIndex( indexFileName( input ), records, errorMessage ) ) return -1;
+
+  File in, out, index;
+  if( !in.open( input, false, false ) ) {
+    errorMessage = "Cannot open " + input + ": " + strerror( errno );
+    return -1;
+  }
+  if( !out.open( output, true, compress ) || !index.open( indexFileName( output ), true, false )
+      || !index.write( indexMagic, sizeof( indexMagic ) ) ) {
+    errorMessage = "Cannot open " + output + " or its index: " + strerror( errno );
+    return -1;
+  }
+
+  // The records are read in file order, the index is in the same order
+  std::vector<char> buffer;
+  uint64_t inOffset = 0, outOffset = 0;
+  long copied = 0;
+  for( size_t i = 0; i < records.size(); ++i ) {
+    RecordInfo info = records[i];
+    int32_t words = 0;
+    if( info.offset != inOffset || !in.read( &words, sizeof( words ) )
+        || info.size != sizeof( words ) + words * sizeof( float ) ) {
+      errorMessage = "Index " + indexFileName( input ) + " does not match the binary";
+      return -1;
+    }
+    buffer.resize( info.size - sizeof( words ) );
+    if( !in.read( &buffer[0], buffer.size() ) ) {
+      errorMessage = "Cannot read " + input;
+      return -1;
+    }
+    inOffset += info.size;
+    if( !selection( info ) ) continue;
+
+    info.offset = outOffset;
+    if( !out.write( &words, sizeof( words ) ) || !out.write( &buffer[0], buffer.size() )
+        || !index.write( &info, sizeof( info ) ) ) {
+      errorMessage = "Cannot write " + output;
+      return -1;
+    }
+    outOffset += info.size;
+    ++copied;
+  }
+  if( !out.close() || !index.close() ) {
+    errorMessage = "Cannot write " + output;
+    return -1;
+  }
+  return copied;
+}
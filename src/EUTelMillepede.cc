@@ -132,62 +132,24 @@ void EUTelMillepede::copyFile(std::string _milleSteeringFilename, std::string _m
 //It also write the results of this into a log file. This is very important since we need the information that this log file provides to determine what is the next step in out iterative alignment
 //By this I mean if too many tracks were rejected by millepede then on the next iteration we need to increase increase the chi2 cut and increase the hit residual.
 bool EUTelMillepede::runPede(){
-	std::string command = "pede " + _milleSteeringFilename;//This is just the same as running a command line command pede <steering file> the minimisation would still be done.
-	streamlog_out ( MESSAGE5 ) << "Starting pede...: " << command.c_str( ) << std::endl;
-  redi::ipstream pede( command.c_str( ), redi::pstreams::pstdout | redi::pstreams::pstderr );// run pede and create a streambuf that reads its stdout and stderr
-
-	if ( !pede.is_open( ) ) {
-		throw(lcio::Exception("The pede file could not be openned."));
-  } else {
-    // output multiplexing: parse pede output in both stdout and stderr and echo messages accordingly
-    char buf[1024];
-		std::streamsize n;
-    std::stringstream pedeoutput; // store stdout to parse later
-    std::stringstream pedeerrors;
-    bool finished[2] = { false, false };
-    while ( !finished[0] || !finished[1] ) {
-			if ( !finished[0] ) {
-    		while ( ( n = pede.err( ).readsome( buf, sizeof (buf ) ) ) > 0 ) {
-    			streamlog_out( ERROR5 ).write( buf, n ).flush( );
-          string error ( buf, n );
-          pedeerrors << error;
-					streamlog_out( ERROR5 ) << error;
-                    //encounteredError = true;
-        }
-				if ( pede.eof( ) ) {
-					finished[0] = true;
-					if ( !finished[1] ) pede.clear( );
-				}
-    	}
-
-			if ( !finished[1] ) {
-				while ( ( n = pede.out( ).readsome( buf, sizeof (buf ) ) ) > 0 ) {
-					streamlog_out( MESSAGE0 ).write( buf, n ).flush( );
-					string output ( buf, n );
-					pedeoutput << output;
-					streamlog_out( MESSAGE9 )  << output;
-				}
-				if ( pede.eof( ) ) {
-					finished[1] = true;
-					if ( !finished[0] )
-					pede.clear( );
-				}
-			}
+	streamlog_out ( MESSAGE5 ) << "Starting pede...: pede " << _milleSteeringFilename << std::endl;
+	//This is just the same as running pede <steering file> on the command line, but the output is parsed while pede runs.
+	EUTelPedeDriver pede;
+	if ( !pede.start( _milleSteeringFilename ) ) {
+		throw(lcio::Exception("The pede file could not be openned. " + pede.getErrorMessage()));
+	}
+	EUTelPedeDriver::Statistics const& statistics = pede.wait( []( std::string const& line, bool isError ){
+		if ( isError ) {
+			streamlog_out( ERROR5 ) << line << std::endl;
+		} else {
+			streamlog_out( MESSAGE9 ) << line << std::endl;
 		}
-		pede.close( );
-		std::string output = pedeoutput.str();
-		bool found = findTooManyRejects(output);
-		//TO DO: Surely we can just specify the directory that we want this placed in. Need to check     
-		//  if ( parseMilleOutput( "millepede.res" ) ) //moveMilleResultFile( "millepede.res", _milleResultFileName );
-		return found;
-	}//END OF IF STATEMENT
-}
-bool EUTelMillepede::findTooManyRejects(std::string output){
-	int found = output.find("Too many rejects (>33.3%)");
-	if (found == std::string::npos){
+	} );
+	//TO DO: Surely we can just specify the directory that we want this placed in. Need to check     
+	//  if ( parseMilleOutput( "millepede.res" ) ) //moveMilleResultFile( "millepede.res", _milleResultFileName );
+	if ( !statistics.tooManyRejects ){
 		streamlog_out(MESSAGE5)<<endl<<"Number of rejects low. Continue with alignment."<<endl;
 		return false;
-
 	}else{
 		streamlog_out(MESSAGE5)<<endl<<"Number of rejects high. We can't use this binary for alignment"<<endl;
 		return true;
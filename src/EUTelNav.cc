@@ -3,6 +3,22 @@
 namespace eutelescope 
 {
 
+namespace
+{
+		Eigen::Vector3d toEigen(TVector3 const& vec)
+		{
+				return Eigen::Vector3d(vec[0], vec[1], vec[2]);
+		}
+
+		//Since field is homogeneous this seems silly but we need to specify a position to geometry to get B-field.
+		Eigen::Vector3d magneticField(double x = 0.1, double y = 0.1, double z = 0.1)
+		{
+				const gear::Vector3D vectorGlobal(x, y, z);
+				const gear::Vector3D B = geo::gGeometry().getMagneticField().at(vectorGlobal);
+				return Eigen::Vector3d(B.x(), B.y(), B.z());
+		}
+}
+
 /*This function given position/momentum of a particle. Will give you the approximate jacobian at any point along the track. 
  * This effectively relates changes in the particle position/momentum at the original to some distant point. 
  * So if I change the initial position by x amount how much will all the other variables position/momentum at the new position change? 
@@ -16,73 +32,16 @@ namespace eutelescope
  * @param dz propagation distance
  * @return 
  */
-TMatrix EUTelNav::getPropagationJacobianF( float x0, float y0, float z0, float px, float py, float pz, float beamQ, float dz )
+Matrix5d EUTelNav::getPropagationJacobianF( float x0, float y0, float z0, float px, float py, float pz, float beamQ, float dz )
 {
 		// The formulas below are derived from equations of motion of the particle in
 		// magnetic field under assumption |dz| small. Must be valid for |dz| < 10 cm
-
-		//Here is the conversion from k=(GeV/c) KG mm^-1
-		const double k = 0.299792458*pow(10,-4);
-
-		const double pxMomentum = px;//change momentum to GeV/c 
-		const double pyMomentum = py;//change momentum to GeV/c 
-		const double pzMomentum = pz;//change momentum to GeV/c 
-
-		TVector3 pVec(pxMomentum, pyMomentum, pzMomentum);	
-
-		//These are the track parameters
-		const double invP = beamQ/pVec.Mag();//This should be in 1/(GeV/c)
-		const double tx0 = px/pVec.Mag();//Unitless  
-		const double ty0 = py/pVec.Mag();
-
-		//And the magnetic field vector (assume uniform field)
-		gear::Vector3D vectorGlobal( x0, y0, z0 );
-		const gear::BField&   B =  geo::gGeometry().getMagneticField();
 		//times but 10 to convert from Tesla to KiloGauss. 1 T = 10^4 Gauss.
-		const double Bx         = (B.at( vectorGlobal ).x())*10;
-		const double By         = (B.at( vectorGlobal ).y())*10;
-		const double Bz         = (B.at( vectorGlobal ).z())*10;
-
-		const double sqrtFactor = sqrt( 1. + tx0*tx0 + ty0*ty0 );
+		const Eigen::Vector3d B = magneticField(x0, y0, z0)*10;
+		const Matrix5d jacobianF = EUTelNavMatrix::propagationJacobianF(Eigen::Vector3d(px, py, pz), B, beamQ, dz);
 
-		const double Ax = sqrtFactor * (  ty0 * ( tx0 * Bx + Bz ) - ( 1. + tx0*tx0 ) * By );
-		const double Ay = sqrtFactor * ( -tx0 * ( ty0 * By + Bz ) + ( 1. + ty0*ty0 ) * Bx );
-
-		// Partial derivatives
-		const double dAxdty0 = ty0 * Ax / (sqrtFactor*sqrtFactor) + sqrtFactor*( tx0*Bx + Bz );
-		const double dAydtx0 = tx0 * Ay / (sqrtFactor*sqrtFactor) + sqrtFactor*( -ty0*By - Bz );
-
-		const double dxdtx0 = dz;
-		const double dxdty0 = 0.5 * invP * k * dz*dz * dAxdty0;
-
-		const double dydtx0 = 0.5 * invP * k * dz*dz * dAydtx0;
-		const double dydty0 = dz;
-
-		const double dtxdty0 = invP * k * dz * dAxdty0;
-		const double dtydtx0 = invP * k * dz * dAydtx0;
-
-		const double dxdinvP0 = 0.5 * k * dz*dz * Ax;
-		const double dydinvP0 = 0.5 * k * dz*dz * Ay;
-
-		const double dtxdinvP0 = k * dz * Ax;
-		const double dtydinvP0 = k * dz * Ay;
-
-		//Fill-in matrix elements
-		TMatrix jacobianF(5,5);
-		jacobianF.UnitMatrix();
-
-		jacobianF[3][1] = dxdtx0;	jacobianF[3][2] = dxdty0;	jacobianF[3][0] = dxdinvP0;
-		jacobianF[4][1] = dydtx0;	jacobianF[4][2] = dydty0;	jacobianF[4][0] = dydinvP0;
-		jacobianF[1][2] = dtxdty0;	jacobianF[1][0] = dtxdinvP0;
-		jacobianF[2][1] = dtydtx0;	jacobianF[2][0] = dtydinvP0;
-
-		if( streamlog_level(DEBUG0) )
-		{
-				streamlog_out( DEBUG0 ) << "Propagation jacobian: " << std::endl;
-				jacobianF.Print();
-		}
+		streamlog_out( DEBUG0 ) << "Propagation jacobian: " << std::endl << jacobianF << std::endl;
 		return jacobianF;
-
 }   
 
 /* Here we define the transformation between the curvilinear and the local frame. Note the local frame we have is defined as the local frame of the telescope. 
@@ -94,120 +53,20 @@ TMatrix EUTelNav::getPropagationJacobianF( float x0, float y0, float z0, float p
  * This is a simple transform our x becomes their(curvilinear y), our y becomes their z and z becomes x
  * However, this is ok since we never directly access the curvilinear system. It is only a bridge between two local systems.
  */ 
-TMatrixD EUTelNav::getLocalToCurvilinearTransformMatrix(TVector3 globalMomentum, int  planeID, float charge)
+Matrix5d EUTelNav::getLocalToCurvilinearTransformMatrix(TVector3 globalMomentum, int  planeID, float charge)
 {
-		const gear::BField& Bfield = geo::gGeometry().getMagneticField();
-
-		//Since field is homogeneous this seems silly but we need to specify a position to geometry to get B-field.
-		gear::Vector3D vectorGlobal(0.1,0.1,0.1);
-		
-		//Magnetic field must be changed to curvilinear coordinate system, as this is used in the curvilinear jacobian
-		//We times bu 0.3 due to units of other variables. It is related to the speed of light over 1 ns.  See paper. Must be Tesla
-		//TO DO: CHECK THAT I CAN REMOVE THIS 0.3 TERM FROM B FIELDS NOW WITH CLAUS'S JACOBIAN LIMIT
-//		const double Bx = (Bfield.at( vectorGlobal ).z())*0.3;
-//		const double By = (Bfield.at( vectorGlobal ).y())*0.3;
-//		const double Bz = (Bfield.at( vectorGlobal ).x())*0.3;
-		const double Bx = (Bfield.at( vectorGlobal ).z());
-		const double By = (Bfield.at( vectorGlobal ).x());
-		const double Bz = (Bfield.at( vectorGlobal ).y());
-	
-		TVector3 B(Bx, By, Bz);
-		TVector3 H = B.Unit();
-
-		//We transform the momentum to curvilinear frame, as this is what is used to describe the curvilinear frame
-		TVector3 curvilinearGlobalMomentum(globalMomentum[2], globalMomentum[0], globalMomentum[1]);
-		//With no magnetic field this will point in z direction.	
-		TVector3 T = curvilinearGlobalMomentum.Unit();
-		//Note here we create the curvilinear frame using the implicit global frame which with zGlobalNormal. Note T,U, V is the actual curvilnear frame.	
-		//TO DO: I did not change T[1] here. Do in need to? Not sure. I assume not since it should be equivalent to T[2]
-		const float cosLambda = sqrt(T[0]*T[0] + T[1]*T[1]);
-		//We use the global curvilinear frame z direction to create the other unit axis
-		TVector3 zGlobalNormal(0, 0, 1); 
-		TVector3 U = (zGlobalNormal.Cross(T)).Unit(); 
-		TVector3 V = (T.Cross(U));
- 	
-		streamlog_out(DEBUG0)<<"The Z(V) axis of the curvilinear system in the global system (Note not the same as global telescope frame)."<< std::endl; 
-		streamlog_message( DEBUG0, V.Print();, std::endl; );
-		streamlog_out(DEBUG0)<<"The Y(U) axis of the curvilinear system in the global system (Note not the same as global telescope frame)"<< std::endl; 
-		streamlog_message( DEBUG0, U.Print();, std::endl; );
-		streamlog_out(DEBUG0)<<"The X(T) axis of the curvilinear system in the global system  (Note not the same as global telescope frame). Should be beam direction."<< std::endl; 
-		streamlog_message( DEBUG0, T.Print();, std::endl; );
-
-		TVector3 ITelescopeFrame;
-		TVector3 KTelescopeFrame;
-		TVector3 JTelescopeFrame;
-
 		///This is the EUTelescope local z direction.
 		//314 is the number we chose to specify a scattering plane.
+		Eigen::Vector3d normal(0,0,1), xAxis(1,0,0), yAxis(0,1,0);
 		if(planeID != 314)
 		{ 
-				ITelescopeFrame = geo::gGeometry().siPlaneNormal(planeID);       
-				KTelescopeFrame = geo::gGeometry().siPlaneXAxis(planeID);	
-				JTelescopeFrame = geo::gGeometry().siPlaneYAxis(planeID);
-		}
-		else
-		{
-				ITelescopeFrame.SetXYZ(0,0,1);
-				KTelescopeFrame.SetXYZ(1,0,0);
-				JTelescopeFrame.SetXYZ(0,1,0);
+				normal = toEigen(geo::gGeometry().siPlaneNormal(planeID));
+				xAxis = toEigen(geo::gGeometry().siPlaneXAxis(planeID));
+				yAxis = toEigen(geo::gGeometry().siPlaneYAxis(planeID));
 		}
 
-		TVector3 I(ITelescopeFrame[2], ITelescopeFrame[1], ITelescopeFrame[0]);
-		TVector3 K(KTelescopeFrame[2], KTelescopeFrame[1], KTelescopeFrame[0]);
-		TVector3 J(JTelescopeFrame[2], JTelescopeFrame[1], JTelescopeFrame[0]);
-
-		streamlog_out(DEBUG0)<<"The Z(J) axis of local system in the global curvilinear system"<< std::endl; 
-		streamlog_message( DEBUG0, J.Print();, std::endl; );
-		streamlog_out(DEBUG0)<<"The Y(K) axis of local system in the global curvilinear system"<< std::endl; 
-		streamlog_message( DEBUG0, K.Print();, std::endl; );
-		streamlog_out(DEBUG0)<<"The X(I) axis of local system in the global curvilinear system"<< std::endl; 
-		streamlog_message( DEBUG0, I.Print();, std::endl; );
-
-		TVector3 N = (H.Cross(T)).Unit();
-		
-		const double alpha = (H.Cross(T)).Mag();
-		const double Q = -(B.Mag())*(charge/(curvilinearGlobalMomentum.Mag()));//You could use end momentum since it must be constant
-		
-		const double TDotI = T.Dot(I);
-		const double TDotJ = T.Dot(J);
-		const double TDotK = T.Dot(K);
-		const double VDotJ = V.Dot(J);
-		const double VDotK = V.Dot(K);
-		const double VDotN = V.Dot(N);
-		const double UDotJ = U.Dot(J);
-		const double UDotK = U.Dot(K);
-		const double UDotN = U.Dot(N);
-	
-		TMatrix jacobian(5,5);
-		jacobian.Zero();
-	
-		/*	Matrix has following (X) entries set:
- 		 *	X 0 0 0 0
-		 *	0 X X X X
-		 *	0 X X X X
-		 *	0 0 0 X X
-		 *	0 0 0 X X
-		 */ 	
-
-		//First Row
-		jacobian[0][0]=1;
-		//Second Row 
-		jacobian[1][1]=TDotI*VDotJ;
-		jacobian[1][2]=TDotI*VDotK;
-		jacobian[1][3]=-alpha*Q*TDotJ*VDotN;
-		jacobian[1][4]=-alpha*Q*TDotK*VDotN;
-		//Third Row
-		jacobian[2][1]=(TDotI*UDotJ)/cosLambda;
-		jacobian[2][2]=(TDotI*UDotK)/cosLambda;
-		jacobian[2][3]=(-alpha*Q*TDotJ*UDotN)/cosLambda;
-		jacobian[2][4]=(-alpha*Q*TDotK*UDotN)/cosLambda;
-		//Forth Row
-		jacobian[3][3]=UDotJ;
-		jacobian[3][4]=UDotK;
-		//Fifth Row		
-		jacobian[4][3]=VDotJ;
-		jacobian[4][4]=VDotK;
-		
+		const Matrix5d jacobian = EUTelNavMatrix::localToCurvilinear(toEigen(globalMomentum), magneticField(), normal, xAxis, yAxis, charge);
+		streamlog_out( DEBUG0 ) << "Local to curvilinear jacobian: " << std::endl << jacobian << std::endl;
 		return jacobian;
 }
 ///This will relate infintesimal changes in the local state vector to the global one. 
@@ -215,56 +74,18 @@ TMatrixD EUTelNav::getLocalToCurvilinearTransformMatrix(TVector3 globalMomentum,
  * \param [in] t1w Momentum of the state
  * \return Jacobain 5x5 which links the local and global states.
  */
-
-
-TMatrixD EUTelNav::getMeasToGlobal(TVector3 t1w, int  planeID)
+Matrix5d EUTelNav::getMeasToGlobal(TVector3 t1w, int  planeID)
 {
-//	std::cout<<"Plane ID " << planeID <<std::endl;
-	TMatrixD transM2l(5,5);
-	transM2l.UnitMatrix();
-	std::vector<double> slope;
-	slope.push_back(t1w[0]/t1w[2]); slope.push_back(t1w[1]/t1w[2]);
-	double norm = std::sqrt(pow(slope.at(0),2) + pow(slope.at(1),2) + 1);//This works since we have in the curvinlinear frame (dx/dz)^2 +(dy/dz)^2 +1 so time through by dz^2
-	TVector3 direction;
-	direction[0] = (slope.at(0)/norm); direction[1] =(slope.at(1)/norm);	direction[2] = (1.0/norm);
-	TMatrixD xyDir(2, 3);
-	xyDir[0][0] = 1; xyDir[0][1]=0.0; xyDir[0][2]=-slope.at(0);  
-	xyDir[1][0] = 0; xyDir[1][1]=1.0; xyDir[1][2]=-slope.at(1);  
-	TMatrixD TRotMatrix(3,3);
-	TRotMatrix	=  geo::gGeometry().getRotMatrix( planeID );
-	TVector3 normalVec;
-	normalVec[0] = TRotMatrix[0][2];	normalVec[1] = TRotMatrix[1][2];	normalVec[2] = TRotMatrix[2][2];
-	double cosInc = direction*normalVec;
-//	std::cout<<"Here is cosInc " << cosInc <<std::endl;
-	TMatrixD measDir(3,2);
-	measDir[0][0] = TRotMatrix[0][0];	measDir[0][1] = TRotMatrix[0][1];
-	measDir[1][0] = TRotMatrix[1][0];	measDir[1][1] = TRotMatrix[1][1];
-	measDir[2][0] = TRotMatrix[2][0];	measDir[2][1] = TRotMatrix[2][1];
-    streamlog_out( DEBUG0 ) << "CALCULATE LOCAL TO GLOBAL STATE TRANSFORMATION... " << std::endl;
-    streamlog_out( DEBUG0 ) << "Inputs... " << std::endl;
-
-    streamlog_out( DEBUG0 ) << "The (X,Y)-axis of the global frame relative to the local  " << std::endl;
-    streamlog_message( DEBUG0, measDir.Print();, std::endl; );
-    streamlog_out( DEBUG0 ) << "The propagator (unit axis) (Dx,Dy)   " << std::endl;
-    streamlog_message( DEBUG0, xyDir.Print();, std::endl; );
-    double scaleFactor = cosInc/direction[2];
-    streamlog_out( DEBUG0 ) << "Scale factor (s) " << scaleFactor << std::endl;
-	TMatrixD proM2l(2,2);
-	proM2l = xyDir*measDir; 
-    streamlog_out( DEBUG0 ) << "Propagators... " << std::endl;
-
-    streamlog_out( DEBUG0 ) << "PROJECTION MATRIX (shifts) (Dx,Dy)x(X,Y)" << std::endl;
-    streamlog_message( DEBUG0, proM2l.Print();, std::endl; );
-    streamlog_out( DEBUG0 ) << "PROJECTION MATRIX (incidence) s(Dx,Dy)x(X,Y) " << std::endl;
-    TMatrixD proM2lInc = scaleFactor*proM2l;
-    streamlog_message( DEBUG0, proM2lInc.Print();, std::endl; );
-
-	transM2l.SetSub(1,1,proM2lInc);
-	transM2l.SetSub(3,3,proM2l);
-    streamlog_out( DEBUG0 ) << "OUTPUT:(Local to Global): " << std::endl;
-    streamlog_message( DEBUG0, transM2l.Print();, std::endl; );
-
-	return transM2l;
+		//The rotation is taken from the cached sensor transformation instead of navigating TGeo
+		Eigen::Matrix3d rotation = Eigen::Matrix3d::Identity();
+		if(planeID != 314)
+		{
+				rotation = Eigen::Map<const Eigen::Matrix<double, 3, 3, Eigen::RowMajor> >(geo::gGeometry().getSensorTransform(planeID).rot);
+		}
+
+		const Matrix5d transM2l = EUTelNavMatrix::measToGlobal(toEigen(t1w), rotation);
+		streamlog_out( DEBUG0 ) << "OUTPUT:(Local to Global): " << std::endl << transM2l << std::endl;
+		return transM2l;
 }
 ///This function creates a jacobain which links one state to another in the EUTelGlobal frame. 
 /**
@@ -272,68 +93,11 @@ TMatrixD EUTelNav::getMeasToGlobal(TVector3 t1w, int  planeID)
  * \param [in] t1w Momentum on the initial states 
  * \return Jacobain 5x5 which links the two states 
  */
-
-TMatrixD EUTelNav::getPropagationJacobianGlobalToGlobal(float ds, TVector3 t1w)
+Matrix5d EUTelNav::getPropagationJacobianGlobalToGlobal(float ds, TVector3 t1w)
 {
-	t1w.Unit();
-	std::vector<double> slope;
-	slope.push_back(t1w[0]/t1w[2]); slope.push_back(t1w[1]/t1w[2]);
-	double norm = std::sqrt(pow(slope.at(0),2) + pow(slope.at(1),2) + 1);//not this works since we have in the curvinlinear frame (dx/dz)^2 +(dy/dz)^2 +1 so time through by dz^2
-	TVector3 direction;
-	direction[0] = (slope.at(0)/norm); direction[1] =(slope.at(1)/norm);	direction[2] = (1.0/norm);
-//	std::cout <<"DIRECTION: "<< direction[0] <<"   " << direction[1]<< "  "<< direction[2] <<std::endl;
-	double sinLambda = direction[2]; 
-	const gear::BField& Bfield = geo::gGeometry().getMagneticField();
-	gear::Vector3D vectorGlobal(0.1,0.1,0.1);
-
-
-	const double Bx = (Bfield.at( vectorGlobal ).x());  
-	const double By = (Bfield.at( vectorGlobal ).y());
-	const double Bz = (Bfield.at( vectorGlobal ).z());
-
-	TVector3 b(Bx, By, Bz);
-	TVector3 BxT = b.Cross(direction);
-//	std::cout << "BxT" << BxT[0] << "  ,  " <<  BxT[1] <<"   ,  " <<BxT[2] << std::endl;
-	TMatrixD xyDir(2, 3);
-//    streamlog_out( DEBUG0 ) << "CALCULATE GLOBAL TO GLOBAL STATE TRANSFORMATION... " << std::endl;
-
-	xyDir[0][0] = 1.0; xyDir[0][1]=0.0; xyDir[0][2]=-slope.at(0);  
-	xyDir[1][0] = 0; xyDir[1][1]=1.0; xyDir[1][2]=-slope.at(1);  
-//    streamlog_out( DEBUG0 ) << "The propagator (Dx,Dy)   " << std::endl;
- //   streamlog_message( DEBUG0, xyDir.Print();, std::endl; );
-
-
-	TMatrixD bFac(2,1);
-	TMatrixD BxTMatrix(3,1);
-	BxTMatrix.Zero();
-	BxTMatrix[0][0] =BxT[0];	BxTMatrix[1][0] =BxT[1];	BxTMatrix[2][0] =BxT[2]; 
- 
-	bFac = -0.0002998 * (xyDir*BxTMatrix); 
-//	std::cout <<std::scientific<< "bFac" << bFac[0][0] << "  ,  " <<  bFac[1][0] << std::endl;
-	TMatrixD ajac(5, 5);
-	ajac.UnitMatrix();
-	if(b.Mag() < 0.001 ){
-			ajac[3][2] = ds * std::sqrt(t1w[0] * t1w[0] + t1w[2] * t1w[2]);
-			ajac[4][1] = ds;
-	}else{
-		ajac[1][0] = bFac[0][0]*ds/sinLambda;
-//		std::cout<<"Jacobian entries;" << ajac[1][0] << std::endl;
-//		std::cout<<"1,0 " << ajac[1][0] << std::endl;
-		ajac[2][0] = bFac[1][0]*ds/sinLambda;
-//		std::cout<< std::scientific <<"2,0 " << ajac[2][0] << std::endl;
-		ajac[3][0] = 0.5*bFac[0][0]*ds*ds;
-//		std::cout<<"3,0 " << ajac[3][0] << std::endl;
-		ajac[4][0] = 0.5*bFac[1][0]*ds*ds;
-//		std::cout<< std::scientific  <<"4,0 " << ajac[4][0] << std::endl;
-		ajac[3][1] = ds*sinLambda; 
-//		std::cout<<"3,1 " << ajac[3][1] << std::endl;
-		ajac[4][2] = ds*sinLambda; 
-//		std::cout<<"4,2 " << ajac[4][2] << std::endl;
-
-	}
-    streamlog_out( DEBUG0 ) << "Global to Global jacobian: " << std::endl;
-    streamlog_message( DEBUG0, ajac.Print();, std::endl; );
-	return ajac;
+		const Matrix5d ajac = EUTelNavMatrix::propagationJacobianGlobalToGlobal(ds, toEigen(t1w), magneticField());
+		streamlog_out( DEBUG0 ) << "Global to Global jacobian: " << std::endl << ajac << std::endl;
+		return ajac;
 }
 
 //TO DO: This used Z Y X system while claus and other limit jacobian uses Z X Y. 
@@ -343,147 +107,14 @@ TMatrixD EUTelNav::getPropagationJacobianGlobalToGlobal(float ds, TVector3 t1w)
  * This is ok since we never access the curvilinear system directly, but always through the local system which is defined 
  * in the local frame of the telescope; i.e Telescope x becomes y, y becomes z and z becomes x.
  */
-TMatrixD EUTelNav::getPropagationJacobianCurvilinear(float ds, float qbyp, TVector3 t1w, TVector3 t2w)
+Matrix5d EUTelNav::getPropagationJacobianCurvilinear(float ds, float qbyp, TVector3 t1w, TVector3 t2w)
 {
-		//This is needed to change to claus's coordinate system
-		TVector3 t1(t1w[2],t1w[1],t1w[0]);
-		TVector3 t2(t2w[2],t2w[1],t2w[0]);
-		t1.Unit();
-		t2.Unit();
-
-		//	if(t1.Mag() != 1.0 or t2.Mag() != 1.0){//TO DO: This statement does not work for some reason.
-		//		streamlog_out(MESSAGE9) << "The magnitude of the two vectors is:  "<< t1.Mag()<< " , "<<t2.Mag() << std::endl;
-		//		throw(lcio::Exception("The calculation of the jacobian must be performed by unit vectors!.")); 	
-		//	}
-
-        const gear::BField& Bfield = geo::gGeometry().getMagneticField();
-
-		//Must transform the B field to be in the frame used in the curvilinear frame.
-		///Since field is homogeneous this seems silly but we need to specify a position to geometry to get B-field.
-		gear::Vector3D vectorGlobal(0.1,0.1,0.1);
-
-		//Must also change the magnetic field to be in the correct coordinate system
-		//We times but 0.3 due to units of other variables. See paper. Must be Tesla
-//		const double Bx = (Bfield.at( vectorGlobal ).z())*0.3*pow(10,-3); 
-//		const double By = (Bfield.at( vectorGlobal ).y())*0.3*pow(10,-3);
-//		const double Bz = (Bfield.at( vectorGlobal ).x())*0.3*pow(10,-3);
-		const double Bx = (Bfield.at( vectorGlobal ).z())*pow(10,1);     ////////HERE CHANGE TO EXPRESS THE FIELD IN KGAUSS. CHANGE! 
-		const double By = (Bfield.at( vectorGlobal ).y())*pow(10,1);
-		const double Bz = (Bfield.at( vectorGlobal ).x())*pow(10,1);
-	
-		TVector3 b(Bx, By, Bz);
-		
 		streamlog_out( DEBUG2 ) << "EUTelGeometryTelescopeGeoDescription::getPropagationJacobianCurvilinear()------BEGIN" << std::endl;
-		streamlog_out( DEBUG2 ) <<"This is the input to the jacobian"<< std::endl;  
 		streamlog_out( DEBUG2 ) <<"The arc length: " <<ds << std::endl;
 		streamlog_out( DEBUG2 ) <<"The curvature: "<< qbyp << std::endl; 
-		streamlog_out(DEBUG0)<<"The unit momentum start "<< std::endl; 
-		streamlog_message( DEBUG0, t1.Print();, std::endl; );
-		streamlog_out(DEBUG0)<<"The unit momentum end "<< std::endl; 
-		streamlog_message( DEBUG0, t2.Print();, std::endl; );
-		streamlog_out(DEBUG0)<<"The unit Magnetic field  "<< std::endl; 
-		streamlog_message( DEBUG0, b.Print();, std::endl; );
-		
-		TMatrixD ajac(5, 5);
-		//This is b*c. speed of light in 1 nanosecond
-		TVector3 bc = b*0.3*pow(10,-3);     //CHANGE HERE.
-		ajac.UnitMatrix(); 
-		
-		// -|B*c|
-		const double qp = -bc.Mag();
 
-		// Q
-		const double q = qp * qbyp;
-		
-		//if q is zero -> line, otherwise a helix
-		if (q == 0.)
-		{
-				ajac[3][2] = ds * sqrt(t1[0] * t1[0] + t1[1] * t1[1]);
-				ajac[4][1] = ds;
-		}
-		else
-		{
-				// at start
-				const double cosl1 = sqrt(t1[0] * t1[0] + t1[1] * t1[1]);
-				// at end
-				const double cosl2 = sqrt(t2[0] * t2[0] + t2[1] * t2[1]);
-				const double cosl2Inv = 1. / cosl2;
-				// magnetic field direction
-				TVector3 hn(bc.Unit());
-				// (signed) momentum
-				const double pav = 1.0 / qbyp;
-				
-//				const double theta = q * ds;
-				const double theta = q * ds*0.1;//CONVERT DS TO CENTIMETRES. CHANGE!!!!!!!!!!!
-
-				const double sint = sin(theta);
-				const double cost = cos(theta);
-				// H*T
-				const double gamma = hn.Dot(t2);
-				// HxT0
-				TVector3 an1 = hn.Cross(t1);
-				// HxT
-				TVector3 an2 = hn.Cross(t2);
-				// U0, V0
-				const double au1 = 1. / sqrt(t1[0]*t1[0]+t1[1]*t1[1]);
-				TVector3 u1(-au1 * t1[1], au1 * t1[0], 0.);
-				TVector3 v1(-t1[2] * u1[1], t1[2] * u1[0], t1[0] * u1[1] - t1[1] * u1[0]);
-				// U, V
-				const double au2 = 1. /sqrt(t2[0]*t2[0]+t2[1]*t2[1]);
-				TVector3 u2(-au2 * t2[1], au2 * t2[0], 0.);
-				TVector3 v2(-t2[2] * u2[1], t2[2] * u2[0], t2[0] * u2[1] - t2[1] * u2[0]);
-				// N*V = -H*U
-				const double anv = -hn.Dot(u2);
-				// N*U = H*V
-				const double anu = hn.Dot(v2);
-				const double omcost = 1. - cost;
-				const double tmsint = theta - sint;
-				// M0-M
-				TVector3 dx(	-(gamma * tmsint * hn[0] + sint * t1[0] + omcost * an1[0]) / q,
-								-(gamma * tmsint * hn[1] + sint * t1[1] + omcost * an1[1]) / q,
-								-(gamma * tmsint * hn[2] + sint * t1[2] + omcost * an1[2]) / q	);
-				// HxU0
-				TVector3 hu1 = hn.Cross(u1);
-				// HxV0
-				TVector3 hv1 = hn.Cross(v1);
-				// some.Dot products
-				const double u1u2 = u1.Dot(u2), u1v2 = u1.Dot(v2), v1u2 = v1.Dot(u2), v1v2 = v1.Dot(v2);
-				const double hu1u2 = hu1.Dot(u2), hu1v2 = hu1.Dot(v2), hv1u2 = hv1.Dot(u2), hv1v2 = hv1.Dot(v2);
-				const double hnu1 = hn.Dot(u1), hnv1 = hn.Dot(v1), hnu2 = hn.Dot(u2), hnv2 = hn.Dot(v2);
-				const double t2u1 = t2.Dot(u1), t2v1 = t2.Dot(v1);
-				const double t2dx = t2.Dot(dx), u2dx = u2.Dot(dx), v2dx = v2.Dot(dx);
-				const double an2u1 = an2.Dot(u1), an2v1 = an2.Dot(v1);
-				// jacobian
-				// 1/P
-				ajac[0][0] = 1.;
-				// Lambda
-				ajac[1][0] = -qp * anv * t2dx;
-				ajac[1][1] = cost * v1v2 + sint * hv1v2 + omcost * hnv1 * hnv2 + anv * (-sint * t2v1 + omcost * an2v1 - gamma * tmsint * hnv1);
-				ajac[1][2] = cosl1
-						* (cost * u1v2 + sint * hu1v2 + omcost * hnu1 * hnv2 + anv * (-sint * t2u1 + omcost * an2u1 - gamma * tmsint * hnu1));
-				ajac[1][3] = -q * anv * t2u1;
-				ajac[1][4] = -q * anv * t2v1;
-				// Phi
-				ajac[2][0] = -qp * anu * t2dx * cosl2Inv;
-				ajac[2][1] = cosl2Inv
-						* (cost * v1u2 + sint * hv1u2 + omcost * hnv1 * hnu2 + anu * (-sint * t2v1 + omcost * an2v1 - gamma * tmsint * hnv1));
-				ajac[2][2] = cosl2Inv * cosl1
-						* (cost * u1u2 + sint * hu1u2 + omcost * hnu1 * hnu2 + anu * (-sint * t2u1 + omcost * an2u1 - gamma * tmsint * hnu1));
-				ajac[2][3] = -q * anu * t2u1 * cosl2Inv;
-				ajac[2][4] = -q * anu * t2v1 * cosl2Inv;
-				// Xt
-				ajac[3][0] = pav * u2dx;
-				ajac[3][1] = (sint * v1u2 + omcost * hv1u2 + tmsint * hnu2 * hnv1) / q;
-				ajac[3][2] = (sint * u1u2 + omcost * hu1u2 + tmsint * hnu2 * hnu1) * cosl1 / q;
-				ajac[3][3] = u1u2;
-				ajac[3][4] = v1u2;
-				// Yt
-				ajac[4][0] = pav * v2dx;
-				ajac[4][1] = (sint * v1v2 + omcost * hv1v2 + tmsint * hnv2 * hnv1) / q;
-				ajac[4][2] = (sint * u1v2 + omcost * hu1v2 + tmsint * hnv2 * hnu1) * cosl1 / q;
-				ajac[4][3] = u1v2;
-				ajac[4][4] = v1v2;
-		}
+		const Matrix5d ajac = EUTelNavMatrix::propagationJacobianCurvilinear(ds, qbyp, toEigen(t1w), toEigen(t2w), magneticField());
+		streamlog_out( DEBUG0 ) << "Curvilinear jacobian: " << std::endl << ajac << std::endl;
 		return ajac;
 }
 
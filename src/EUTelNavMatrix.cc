@@ -0,0 +1,278 @@
+/*
+ *   This source code is part of the Eutelescope package of Marlin.
+ *   You are free to use this source files for your own development as
+ *   long as it stays in a public research context. You are not
+ *   allowed to use it for commercial purpose. You must put this
+ *   header with author names in all development based on this file.
+ *
+ */
+
+// eutelescope includes ".h"
+#include "EUTelNavMatrix.h"
+
+// system includes <>
+#include <Eigen/Geometry>
+
+using namespace eutelescope;
+
+namespace {
+  //Same as TVector3::Unit(), a null vector stays null
+  Eigen::Vector3d unit(Eigen::Vector3d const& vec) {
+    double const mag2 = vec.squaredNorm();
+    return mag2 > 0 ? Eigen::Vector3d( vec/std::sqrt(mag2) ) : vec;
+  }
+}
+
+Matrix5d EUTelNavMatrix::propagationJacobianF(Eigen::Vector3d const& momentum, Eigen::Vector3d const& bField, double beamQ, double dz)
+{
+  //Here is the conversion from k=(GeV/c) KG mm^-1
+  const double k = 0.299792458*1e-4;
+
+  //These are the track parameters
+  const double p = momentum.norm();
+  const double invP = beamQ/p;//This should be in 1/(GeV/c)
+  const double tx0 = momentum[0]/p;//Unitless
+  const double ty0 = momentum[1]/p;
+
+  const double Bx = bField[0];
+  const double By = bField[1];
+  const double Bz = bField[2];
+
+  const double sqrtFactor = std::sqrt( 1. + tx0*tx0 + ty0*ty0 );
+
+  const double Ax = sqrtFactor * (  ty0 * ( tx0 * Bx + Bz ) - ( 1. + tx0*tx0 ) * By );
+  const double Ay = sqrtFactor * ( -tx0 * ( ty0 * By + Bz ) + ( 1. + ty0*ty0 ) * Bx );
+
+  // Partial derivatives
+  const double dAxdty0 = ty0 * Ax / (sqrtFactor*sqrtFactor) + sqrtFactor*( tx0*Bx + Bz );
+  const double dAydtx0 = tx0 * Ay / (sqrtFactor*sqrtFactor) + sqrtFactor*( -ty0*By - Bz );
+
+  Matrix5d jacobianF = Matrix5d::Identity();
+
+  jacobianF(3,1) = dz;                                jacobianF(3,2) = 0.5 * invP * k * dz*dz * dAxdty0;  jacobianF(3,0) = 0.5 * k * dz*dz * Ax;
+  jacobianF(4,1) = 0.5 * invP * k * dz*dz * dAydtx0;  jacobianF(4,2) = dz;                                jacobianF(4,0) = 0.5 * k * dz*dz * Ay;
+  jacobianF(1,2) = invP * k * dz * dAxdty0;           jacobianF(1,0) = k * dz * Ax;
+  jacobianF(2,1) = invP * k * dz * dAydtx0;           jacobianF(2,0) = k * dz * Ay;
+
+  return jacobianF;
+}
+
+Matrix5d EUTelNavMatrix::localToCurvilinear(Eigen::Vector3d const& globalMomentum, Eigen::Vector3d const& bField,
+                                            Eigen::Vector3d const& normal, Eigen::Vector3d const& xAxis,
+                                            Eigen::Vector3d const& yAxis, double charge)
+{
+  //Magnetic field and momentum in the curvilinear frame: our x becomes y, y becomes z and z becomes x
+  const Eigen::Vector3d B( bField[2], bField[0], bField[1] );
+  const Eigen::Vector3d H = unit( B );
+  const Eigen::Vector3d curvilinearGlobalMomentum( globalMomentum[2], globalMomentum[0], globalMomentum[1] );
+
+  const Eigen::Vector3d T = unit( curvilinearGlobalMomentum );
+  const float cosLambda = std::sqrt( T[0]*T[0] + T[1]*T[1] );
+  const Eigen::Vector3d U = unit( Eigen::Vector3d::UnitZ().cross( T ) );
+  const Eigen::Vector3d V = T.cross( U );
+
+  //The plane axes are reversed, as in the original curvilinear description
+  const Eigen::Vector3d I( normal[2], normal[1], normal[0] );
+  const Eigen::Vector3d K( xAxis[2], xAxis[1], xAxis[0] );
+  const Eigen::Vector3d J( yAxis[2], yAxis[1], yAxis[0] );
+
+  const Eigen::Vector3d N = unit( H.cross( T ) );
+
+  const double alpha = H.cross( T ).norm();
+  const double Q = -B.norm()*( charge/curvilinearGlobalMomentum.norm() );
+
+  const double TDotI = T.dot(I);
+  const double TDotJ = T.dot(J);
+  const double TDotK = T.dot(K);
+  const double VDotJ = V.dot(J);
+  const double VDotK = V.dot(K);
+  const double VDotN = V.dot(N);
+  const double UDotJ = U.dot(J);
+  const double UDotK = U.dot(K);
+  const double UDotN = U.dot(N);
+
+  /*  Matrix has following (X) entries set:
+   *  X 0 0 0 0
+   *  0 X X X X
+   *  0 X X X X
+   *  0 0 0 X X
+   *  0 0 0 X X
+   */
+  Matrix5d jacobian = Matrix5d::Zero();
+  jacobian(0,0) = 1;
+  jacobian(1,1) = TDotI*VDotJ;
+  jacobian(1,2) = TDotI*VDotK;
+  jacobian(1,3) = -alpha*Q*TDotJ*VDotN;
+  jacobian(1,4) = -alpha*Q*TDotK*VDotN;
+  jacobian(2,1) = (TDotI*UDotJ)/cosLambda;
+  jacobian(2,2) = (TDotI*UDotK)/cosLambda;
+  jacobian(2,3) = (-alpha*Q*TDotJ*UDotN)/cosLambda;
+  jacobian(2,4) = (-alpha*Q*TDotK*UDotN)/cosLambda;
+  jacobian(3,3) = UDotJ;
+  jacobian(3,4) = UDotK;
+  jacobian(4,3) = VDotJ;
+  jacobian(4,4) = VDotK;
+
+  return jacobian;
+}
+
+Matrix5d EUTelNavMatrix::measToGlobal(Eigen::Vector3d const& t1w, Eigen::Matrix3d const& rotation)
+{
+  const double slopeX = t1w[0]/t1w[2];
+  const double slopeY = t1w[1]/t1w[2];
+  //This works since we have in the curvinlinear frame (dx/dz)^2 +(dy/dz)^2 +1 so time through by dz^2
+  const double norm = std::sqrt( slopeX*slopeX + slopeY*slopeY + 1 );
+  const Eigen::Vector3d direction( slopeX/norm, slopeY/norm, 1.0/norm );
+
+  Matrix23d xyDir;
+  xyDir << 1, 0.0, -slopeX,
+           0, 1.0, -slopeY;
+
+  const double cosInc = direction.dot( rotation.col(2) );
+  const Matrix32d measDir = rotation.leftCols<2>();
+  const double scaleFactor = cosInc/direction[2];
+
+  const Eigen::Matrix2d proM2l = xyDir*measDir;
+
+  Matrix5d transM2l = Matrix5d::Identity();
+  transM2l.block<2,2>(1,1) = scaleFactor*proM2l;
+  transM2l.block<2,2>(3,3) = proM2l;
+  return transM2l;
+}
+
+Matrix5d EUTelNavMatrix::propagationJacobianGlobalToGlobal(double ds, Eigen::Vector3d const& t1w, Eigen::Vector3d const& bField)
+{
+  const double slopeX = t1w[0]/t1w[2];
+  const double slopeY = t1w[1]/t1w[2];
+  const double norm = std::sqrt( slopeX*slopeX + slopeY*slopeY + 1 );
+  const Eigen::Vector3d direction( slopeX/norm, slopeY/norm, 1.0/norm );
+  const double sinLambda = direction[2];
+
+  const Eigen::Vector3d BxT = bField.cross( direction );
+
+  Matrix23d xyDir;
+  xyDir << 1.0, 0.0, -slopeX,
+           0,   1.0, -slopeY;
+
+  const Eigen::Vector2d bFac = -0.0002998 * ( xyDir*BxT );
+
+  Matrix5d ajac = Matrix5d::Identity();
+  if( bField.norm() < 0.001 ) {
+    ajac(3,2) = ds * std::sqrt( t1w[0] * t1w[0] + t1w[2] * t1w[2] );
+    ajac(4,1) = ds;
+  } else {
+    ajac(1,0) = bFac[0]*ds/sinLambda;
+    ajac(2,0) = bFac[1]*ds/sinLambda;
+    ajac(3,0) = 0.5*bFac[0]*ds*ds;
+    ajac(4,0) = 0.5*bFac[1]*ds*ds;
+    ajac(3,1) = ds*sinLambda;
+    ajac(4,2) = ds*sinLambda;
+  }
+  return ajac;
+}
+
+Matrix5d EUTelNavMatrix::propagationJacobianCurvilinear(double ds, double qbyp, Eigen::Vector3d const& t1w,
+                                                        Eigen::Vector3d const& t2w, Eigen::Vector3d const& bField)
+{
+  //This is needed to change to claus's coordinate system
+  const Eigen::Vector3d t1( t1w[2], t1w[1], t1w[0] );
+  const Eigen::Vector3d t2( t2w[2], t2w[1], t2w[0] );
+
+  //The field in the same frame, expressed in kG
+  const Eigen::Vector3d b = Eigen::Vector3d( bField[2], bField[1], bField[0] )*10;
+
+  //This is b*c. speed of light in 1 nanosecond
+  const Eigen::Vector3d bc = b*0.3*1e-3;
+  Matrix5d ajac = Matrix5d::Identity();
+
+  // -|B*c|
+  const double qp = -bc.norm();
+  // Q
+  const double q = qp * qbyp;
+
+  //if q is zero -> line, otherwise a helix
+  if( q == 0. ) {
+    ajac(3,2) = ds * std::sqrt( t1[0] * t1[0] + t1[1] * t1[1] );
+    ajac(4,1) = ds;
+    return ajac;
+  }
+
+  // at start
+  const double cosl1 = std::sqrt( t1[0] * t1[0] + t1[1] * t1[1] );
+  // at end
+  const double cosl2 = std::sqrt( t2[0] * t2[0] + t2[1] * t2[1] );
+  const double cosl2Inv = 1. / cosl2;
+  // magnetic field direction
+  const Eigen::Vector3d hn = unit( bc );
+  // (signed) momentum
+  const double pav = 1.0 / qbyp;
+  //ds is converted to centimetres
+  const double theta = q * ds*0.1;
+
+  const double sint = std::sin( theta );
+  const double cost = std::cos( theta );
+  // H*T
+  const double gamma = hn.dot( t2 );
+  // HxT0
+  const Eigen::Vector3d an1 = hn.cross( t1 );
+  // HxT
+  const Eigen::Vector3d an2 = hn.cross( t2 );
+  // U0, V0
+  const double au1 = 1. / std::sqrt( t1[0]*t1[0] + t1[1]*t1[1] );
+  const Eigen::Vector3d u1( -au1 * t1[1], au1 * t1[0], 0. );
+  const Eigen::Vector3d v1( -t1[2] * u1[1], t1[2] * u1[0], t1[0] * u1[1] - t1[1] * u1[0] );
+  // U, V
+  const double au2 = 1. / std::sqrt( t2[0]*t2[0] + t2[1]*t2[1] );
+  const Eigen::Vector3d u2( -au2 * t2[1], au2 * t2[0], 0. );
+  const Eigen::Vector3d v2( -t2[2] * u2[1], t2[2] * u2[0], t2[0] * u2[1] - t2[1] * u2[0] );
+  // N*V = -H*U
+  const double anv = -hn.dot( u2 );
+  // N*U = H*V
+  const double anu = hn.dot( v2 );
+  const double omcost = 1. - cost;
+  const double tmsint = theta - sint;
+  // M0-M
+  const Eigen::Vector3d dx = -( gamma * tmsint * hn + sint * t1 + omcost * an1 ) / q;
+  // HxU0
+  const Eigen::Vector3d hu1 = hn.cross( u1 );
+  // HxV0
+  const Eigen::Vector3d hv1 = hn.cross( v1 );
+  // some dot products
+  const double u1u2 = u1.dot(u2), u1v2 = u1.dot(v2), v1u2 = v1.dot(u2), v1v2 = v1.dot(v2);
+  const double hu1u2 = hu1.dot(u2), hu1v2 = hu1.dot(v2), hv1u2 = hv1.dot(u2), hv1v2 = hv1.dot(v2);
+  const double hnu1 = hn.dot(u1), hnv1 = hn.dot(v1), hnu2 = hn.dot(u2), hnv2 = hn.dot(v2);
+  const double t2u1 = t2.dot(u1), t2v1 = t2.dot(v1);
+  const double t2dx = t2.dot(dx), u2dx = u2.dot(dx), v2dx = v2.dot(dx);
+  const double an2u1 = an2.dot(u1), an2v1 = an2.dot(v1);
+  // jacobian
+  // 1/P
+  ajac(0,0) = 1.;
+  // Lambda
+  ajac(1,0) = -qp * anv * t2dx;
+  ajac(1,1) = cost * v1v2 + sint * hv1v2 + omcost * hnv1 * hnv2 + anv * (-sint * t2v1 + omcost * an2v1 - gamma * tmsint * hnv1);
+  ajac(1,2) = cosl1
+      * (cost * u1v2 + sint * hu1v2 + omcost * hnu1 * hnv2 + anv * (-sint * t2u1 + omcost * an2u1 - gamma * tmsint * hnu1));
+  ajac(1,3) = -q * anv * t2u1;
+  ajac(1,4) = -q * anv * t2v1;
+  // Phi
+  ajac(2,0) = -qp * anu * t2dx * cosl2Inv;
+  ajac(2,1) = cosl2Inv
+      * (cost * v1u2 + sint * hv1u2 + omcost * hnv1 * hnu2 + anu * (-sint * t2v1 + omcost * an2v1 - gamma * tmsint * hnv1));
+  ajac(2,2) = cosl2Inv * cosl1
+      * (cost * u1u2 + sint * hu1u2 + omcost * hnu1 * hnu2 + anu * (-sint * t2u1 + omcost * an2u1 - gamma * tmsint * hnu1));
+  ajac(2,3) = -q * anu * t2u1 * cosl2Inv;
+  ajac(2,4) = -q * anu * t2v1 * cosl2Inv;
+  // Xt
+  ajac(3,0) = pav * u2dx;
+  ajac(3,1) = (sint * v1u2 + omcost * hv1u2 + tmsint * hnu2 * hnv1) / q;
+  ajac(3,2) = (sint * u1u2 + omcost * hu1u2 + tmsint * hnu2 * hnu1) * cosl1 / q;
+  ajac(3,3) = u1u2;
+  ajac(3,4) = v1u2;
+  // Yt
+  ajac(4,0) = pav * v2dx;
+  ajac(4,1) = (sint * v1v2 + omcost * hv1v2 + tmsint * hnv2 * hnv1) / q;
+  ajac(4,2) = (sint * u1v2 + omcost * hu1v2 + tmsint * hnv2 * hnu1) * cosl1 / q;
+  ajac(4,3) = u1v2;
+  ajac(4,4) = v1v2;
+  return ajac;
+}
@@ -0,0 +1,311 @@
+/*
+ *   This source code is part of the Eutelescope package of Marlin.
+ *   You are free to use this source files for your own development as
+ *   long as it stays in a public research context. You are not
+ *   allowed to use it for commercial purpose. You must put this
+ *   header with author names in all development based on this file.
+ *
+ */
+
+// eutelescope includes ".h"
+#include "EUTelPedeDriver.h"
+
+// system includes <>
+#include <cerrno>
+#include <cstdlib>
+#include <cstring>
+#include <fcntl.h>
+#include <fstream>
+#include <poll.h>
+#include <signal.h>
+#include <sstream>
+#include <sys/wait.h>
+#include <unistd.h>
+
+using namespace eutelescope;
+
+namespace {
+  //! Markers of the pede output lines which are parsed
+  char const chi2NdfMarker[]  = "Sum(Chi^2)/Sum(Ndf) =";
+  char const nRecordsMarker[] = "NREC =";
+  char const rejectedMarker[] = "Data rejected in last iteration";
+  char const rejectsMarker[]  = "Too many rejects";
+
+  //! Pipe whose ends are not inherited by other children, so that several pede runs see their own end of file
+  bool openPipe(int fd[2]) {
+    if( pipe( fd ) != 0 ) return false;
+    fcntl( fd[0], F_SETFD, FD_CLOEXEC );
+    fcntl( fd[1], F_SETFD, FD_CLOEXEC );
+    return true;
+  }
+}
+
+EUTelPedeDriver::EUTelPedeDriver():
+  _pid(-1),
+  _reader(),
+  _mutex(),
+  _changed(),
+  _lines(),
+  _statistics(),
+  _parameters(),
+  _chi2NdfPending(false),
+  _rejectedPending(0),
+  _workingDirectory(),
+  _errorMessage()
+{
+  _fd[0] = _fd[1] = -1;
+}
+
+EUTelPedeDriver::~EUTelPedeDriver()
+{
+  if( isRunning() ) {
+    terminate();
+    wait();
+  }
+}
+
+bool EUTelPedeDriver::start(std::string const& steeringFile, std::string const& workingDirectory,
+                            std::string const& program)
+{
+  if( isRunning() ) {
+    _errorMessage = "pede is already running";
+    return false;
+  }
+  _workingDirectory = workingDirectory;
+  _errorMessage.clear();
+  _lines.clear();
+  _parameters.clear();
+  _statistics = Statistics();
+  _statistics.exitStatus = -1;
+  _statistics.nRecords = -1;
+  _chi2NdfPending = false;
+  _rejectedPending = 0;
+
+  int out[2], err[2];
+  if( !openPipe( out ) ) {
+    _errorMessage = std::string( "Cannot create a pipe: " ) + strerror( errno );
+    return false;
+  }
+  if( !openPipe( err ) ) {
+    _errorMessage = std::string( "Cannot create a pipe: " ) + strerror( errno );
+    close( out[0] );
+    close( out[1] );
+    return false;
+  }
+
+  // Everything the child needs is prepared before the fork
+  char const* const argv[] = { program.c_str(), steeringFile.c_str(), 0 };
+  char const* const directory = workingDirectory.empty() ? 0 : workingDirectory.c_str();
+  static char const execFailed[] = "Cannot execute pede\n";
+
+  _pid = fork();
+  if( _pid < 0 ) {
+    _errorMessage = std::string( "Cannot start pede: " ) + strerror( errno );
+    close( out[0] );
+    close( out[1] );
+    close( err[0] );
+    close( err[1] );
+    return false;
+  }
+  if( _pid == 0 ) {
+    // Only async signal safe calls until exec, the parent may have other threads
+    dup2( out[1], STDOUT_FILENO );
+    dup2( err[1], STDERR_FILENO );
+    if( ( directory == 0 || chdir( directory ) == 0 ) ) execvp( argv[0], const_cast<char* const*>( argv ) );
+    ssize_t const ignored = ::write( STDERR_FILENO, execFailed, sizeof( execFailed ) - 1 );
+    (void) ignored;
+    _exit( 127 );
+  }
+
+  close( out[1] );
+  close( err[1] );
+  _fd[0] = out[0];
+  _fd[1] = err[0];
+  _reader = std::thread( &EUTelPedeDriver::read, this );
+  return true;
+}
+
+EUTelPedeDriver::Statistics const& EUTelPedeDriver::wait(LineHandler const& handler)
+{
+  if( !isRunning() ) return _statistics;
+
+  std::deque< std::pair<std::string, bool> > lines;
+  std::unique_lock<std::mutex> lock( _mutex );
+  for( ;; ) {
+    _changed.wait( lock, [this] { return !_lines.empty() || _statistics.finished; } );
+    bool const finished = _statistics.finished;
+    lines.swap( _lines );
+
+    // The handler runs without the lock, the reader thread goes on meanwhile
+    lock.unlock();
+    if( handler ) {
+      for( size_t i = 0; i < lines.size(); ++i ) handler( lines[i].first, lines[i].second );
+    }
+    lines.clear();
+    lock.lock();
+    if( finished && _lines.empty() ) break;
+  }
+  lock.unlock();
+
+  _reader.join();
+  return _statistics;
+}
+
+void EUTelPedeDriver::terminate()
+{
+  std::lock_guard<std::mutex> lock( _mutex );
+  if( isRunning() && !_statistics.finished && _pid > 0 ) kill( _pid, SIGTERM );
+}
+
+EUTelPedeDriver::Statistics EUTelPedeDriver::getStatistics() const
+{
+  std::lock_guard<std::mutex> lock( _mutex );
+  return _statistics;
+}
+
+std::string EUTelPedeDriver::getResultFileName() const
+{
+  return _workingDirectory.empty() ? "millepede.res" : _workingDirectory + "/millepede.res";
+}
+
+void EUTelPedeDriver::read()
+{
+  std::string pending[2];
+  char buffer[4096];
+  int open = 2;
+  while( open > 0 ) {
+    pollfd fds[2];
+    for( int i = 0; i < 2; ++i ) {
+      fds[i].fd = _fd[i];
+      fds[i].events = POLLIN;
+      fds[i].revents = 0;
+    }
+    // Sleeps until pede writes or closes its output
+    if( poll( fds, 2, -1 ) < 0 ) {
+      if( errno == EINTR ) continue;
+      break;
+    }
+    for( int i = 0; i < 2; ++i ) {
+      if( fds[i].fd < 0 || fds[i].revents == 0 ) continue;
+      ssize_t const n = ::read( _fd[i], buffer, sizeof( buffer ) );
+      if( n < 0 && errno == EINTR ) continue;
+
+      std::lock_guard<std::mutex> lock( _mutex );
+      if( n > 0 ) pending[i].append( buffer, n );
+      else if( !pending[i].empty() ) pending[i] += '\n';
+
+      size_t begin = 0, end;
+      while( ( end = pending[i].find( '\n', begin ) ) != std::string::npos ) {
+        std::string const line = pending[i].substr( begin, end - begin );
+        parseLine( line, i == 1 );
+        _lines.push_back( std::make_pair( line, i == 1 ) );
+        begin = end + 1;
+      }
+      pending[i].erase( 0, begin );
+      if( !_lines.empty() ) _changed.notify_one();
+
+      if( n <= 0 ) {
+        close( _fd[i] );
+        _fd[i] = -1;
+        --open;
+      }
+    }
+  }
+  for( int i = 0; i < 2; ++i ) {
+    if( _fd[i] >= 0 ) close( _fd[i] );
+    _fd[i] = -1;
+  }
+
+  int status = 0;
+  while( waitpid( _pid, &status, 0 ) < 0 && errno == EINTR ) {}
+  int const exitStatus = WIFEXITED( status ) ? WEXITSTATUS( status ) : 128 + WTERMSIG( status );
+
+  // The results are parsed here as well, other fits may still be running
+  std::vector<Parameter> parameters;
+  std::string errorMessage;
+  if( exitStatus == 0 ) readResults( getResultFileName(), parameters, errorMessage );
+
+  std::lock_guard<std::mutex> lock( _mutex );
+  _parameters.swap( parameters );
+  _errorMessage = errorMessage;
+  _statistics.exitStatus = exitStatus;
+  _statistics.finished = true;
+  _changed.notify_one();
+}
+
+void EUTelPedeDriver::parseLine(std::string const& line, bool isError)
+{
+  if( isError ) ++_statistics.nErrorLines;
+
+  if( line.find( rejectsMarker ) != std::string::npos ) _statistics.tooManyRejects = true;
+
+  // The value follows the next '=', which may be on one of the following lines
+  size_t start = std::string::npos;
+  size_t const chi2Ndf = line.find( chi2NdfMarker );
+  if( chi2Ndf != std::string::npos ) {
+    _chi2NdfPending = true;
+    start = chi2Ndf + sizeof( chi2NdfMarker ) - 1;
+  } else if( _chi2NdfPending ) {
+    start = 0;
+  }
+  if( start != std::string::npos ) {
+    size_t const equal = line.find( '=', start );
+    if( equal != std::string::npos ) {
+      _statistics.chi2Ndf = atof( line.c_str() + equal + 1 );
+      _statistics.hasChi2Ndf = true;
+      _chi2NdfPending = false;
+    }
+  }
+
+  size_t const nRecords = line.find( nRecordsMarker );
+  if( nRecords != std::string::npos ) {
+    _statistics.nRecords = atol( line.c_str() + nRecords + sizeof( nRecordsMarker ) - 1 );
+  }
+
+  // The four counts follow on the next lines, each before its reason in brackets
+  if( _rejectedPending > 0 ) {
+    std::istringstream tokens( line );
+    std::string token;
+    while( _rejectedPending > 0 && tokens >> token ) {
+      char* end = 0;
+      long const count = strtol( token.c_str(), &end, 10 );
+      if( *end == '\0' ) _statistics.rejected[ 4 - _rejectedPending-- ] = count;
+    }
+  }
+  if( line.find( rejectedMarker ) != std::string::npos ) _rejectedPending = 4;
+}
+
+bool EUTelPedeDriver::readResults(std::string const& fileName, std::vector<Parameter>& parameters,
+                                  std::string& errorMessage)
+{
+  parameters.clear();
+  std::ifstream file( fileName.c_str() );
+  if( !file.is_open() ) {
+    errorMessage = "Cannot open " + fileName;
+    return false;
+  }
+
+  // The first line is a comment, then label, value, presigma and, for
+  // free parameters, the difference and the error, sometimes followed
+  // by the global correlation
+  std::string line;
+  getline( file, line );
+  std::vector<double> tokens;
+  while( getline( file, line ) ) {
+    std::istringstream tokenizer( line );
+    tokens.clear();
+    double token;
+    while( tokenizer >> token ) tokens.push_back( token );
+    if( tokens.size() != 3 && tokens.size() != 5 && tokens.size() != 6 ) continue;
+
+    Parameter parameter;
+    parameter.label = static_cast<int>( tokens[0] );
+    parameter.value = tokens[1];
+    parameter.presigma = tokens[2];
+    parameter.fixed = tokens.size() == 3;
+    parameter.difference = parameter.fixed ? 0. : tokens[3];
+    parameter.error = parameter.fixed ? 0. : tokens[4];
+    parameters.push_back( parameter );
+  }
+  return true;
+}
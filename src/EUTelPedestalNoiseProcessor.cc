@@ -160,6 +160,15 @@ EUTelPedestalNoiseProcessor::EUTelPedestalNoiseProcessor () :Processor("EUTelPed
   registerOptionalParameter ("HitRejectionPreLoop",
                              "Perform a fast first loop to improve the efficiency of hit rejection",
                              _preLoopSwitch, static_cast< bool > ( true ) ) ;
+  registerOptionalParameter ("ExactMeanRMSNoise",
+                             "MeanRMS noise as the exact RMS of the population instead of the original running estimate (changes the noise values)",
+                             _exactMeanRMSNoise, static_cast< bool > ( false ) );
+  registerOptionalParameter ("SinglePass",
+                             "Read the input only once and run all the loops on the buffered ADC values (MeanRMS only)",
+                             _singlePass, static_cast< bool > ( false ) );
+  registerOptionalParameter ("SinglePassMaxMemory",
+                             "Memory for the buffered ADC values in MB, further events are spilled to a file next to the output",
+                             _singlePassMaxMemory, static_cast< int > ( 2048 ) );
 
 
   registerProcessorParameter ("FirstEvent",
@@ -208,15 +217,14 @@ void EUTelPedestalNoiseProcessor::init () {
   // set the geometry ready switch to false
   _isGeometryReady = false;
 
-  // set the loop counter
-  if ( _preLoopSwitch ) _iLoop = -1;
+  // set the loop counter. In the single pass mode the pre loop is
+  // done on the buffered frames
+  if ( _preLoopSwitch && !_singlePass ) _iLoop = -1;
   else _iLoop = 0;
 
   if ( _pedestalAlgo == EUTELESCOPE::MEANRMS ) {
     // reset the temporary arrays
-    _tempPede.clear ();
-    _tempNoise.clear ();
-    _tempEntries.clear ();
+    _tempAccumulator.clear ();
   }
 
 #ifndef MARLIN_USE_AIDA
@@ -229,6 +237,15 @@ void EUTelPedestalNoiseProcessor::init () {
   }
 #endif
 
+  if ( _singlePass && ( _pedestalAlgo != EUTELESCOPE::MEANRMS ) ) {
+    streamlog_out ( WARNING2 ) << "The single pass mode is only available with the " << EUTELESCOPE::MEANRMS
+                               << " algorithm, rewinding the input for every loop" << endl;
+    _singlePass = false;
+    if ( _preLoopSwitch ) _iLoop = -1;
+  }
+  _frameBuffer.close();
+  _frameOffset.clear();
+
   if ( _preLoopSwitch ) {
     _maxValuePos.clear();
     _maxValue.clear();
@@ -296,6 +313,10 @@ void EUTelPedestalNoiseProcessor::processRunHeader (LCRunHeader * rdr) {
   int additionalLoop = 0;
   if ( _additionalMaskingLoop ) additionalLoop = 1;
 
+  // in the single pass mode every record is read only once
+  int noOfPasses = _noOfCMIterations + 1 + additionalLoop;
+  if ( _singlePass ) noOfPasses = 1;
+
   if ( _lastEvent == -1 ) {
     // the user didn't select an upper limit for the event range, so
     // we don't know on how many events the calculation should be done
@@ -307,7 +328,7 @@ void EUTelPedestalNoiseProcessor::processRunHeader (LCRunHeader * rdr) {
       streamlog_out ( WARNING2 )  << "The MaxRecordNumber in the Global section of the steering file has been set to "
                                   << maxRecordNumber << ".\n"
                                   << "This means that in order to properly perform the pedestal calculation the maximum allowed number of events is "
-                                  << maxRecordNumber / ( _noOfCMIterations + 1 + additionalLoop ) << ".\n"
+                                  << maxRecordNumber / noOfPasses << ".\n"
                                   << "Let's hope it is correct and try to continue." << endl;
     }
   } else {
@@ -315,10 +336,10 @@ void EUTelPedestalNoiseProcessor::processRunHeader (LCRunHeader * rdr) {
     // we can compare this number with the maxRecordNumber if
     // different from 0
     if ( maxRecordNumber != 0 ) {
-      if ( (_lastEvent - _firstEvent) * ( _noOfCMIterations + 1 + additionalLoop ) > maxRecordNumber ) {
+      if ( (_lastEvent - _firstEvent) * noOfPasses > maxRecordNumber ) {
         streamlog_out ( ERROR4 ) << "The pedestal calculation should be done on " << _lastEvent - _firstEvent
-                                 << " times " <<  _noOfCMIterations + 1 << " iterations = "
-                                 << (_lastEvent - _firstEvent) * ( _noOfCMIterations + 1 + additionalLoop ) << " records.\n"
+                                 << " times " <<  noOfPasses << " iterations = "
+                                 << (_lastEvent - _firstEvent) * noOfPasses << " records.\n"
                                  << "The global variable MarRecordNumber is limited to " << maxRecordNumber << endl;
         throw InvalidParameterException("MaxRecordNumber");
       }
@@ -425,7 +446,8 @@ void EUTelPedestalNoiseProcessor::processEvent (LCEvent * evt) {
                                << " is of unknown type. Continue considering it as a normal Data Event." << endl;
   }
 
-  if ( _iLoop == -1 ) preLoop( evt );
+  if ( _singlePass ) bufferEvent( evt );
+  else if ( _iLoop == -1 ) preLoop( evt );
   else if ( _iLoop == 0 ) firstLoop(evt);
   else if ( _additionalMaskingLoop ) {
     if ( _iLoop == _noOfCMIterations + 1 ) {
@@ -448,6 +470,9 @@ void EUTelPedestalNoiseProcessor::check (LCEvent * /* evt */ ) {
 
 void EUTelPedestalNoiseProcessor::end() {
 
+  // the input finished without EORE before the last event, the
+  // buffered frames are still to be used
+  if ( _singlePass && ( _frameBuffer.size() != 0 ) ) singlePass();
 
   int additionalLoop = 0;
   if ( _additionalMaskingLoop ) additionalLoop = 1;
@@ -869,36 +894,22 @@ void EUTelPedestalNoiseProcessor::firstLoop(LCEvent * event) {
 
         for ( size_t iDetector = 0 ; iDetector < collectionVec->size() ; ++iDetector ) {
 
-          // _tempPedestal, _tempNoise, _tempEntries are vector of vector.
-          // they have been already cleared in the init() method we are
-          // already looping on detectors, so we just need to push back a
-          // vector empty for each cycle
-          //
-          // _tempPedestal should be initialized with the adcValues, while
-          // _tempNoise and _tempEntries must be initialized to zero. Since
-          // adcValues is a vector of shorts, we need to copy each
-          // elements into _tempPedestal with a suitable re-casting
+          // _tempAccumulator has been already cleared in the init()
+          // method we are already looping on detectors, so we just need
+          // to push back an accumulator for each cycle, started with
+          // the adcValues of this event
 
           // get the TrackerRawData object from the collection for this detector
 
           TrackerRawData *trackerRawData = dynamic_cast < TrackerRawData * >(collectionVec->getElementAt (iDetector));
-          ShortVec adcValues = trackerRawData->getADCValues ();
+          const ShortVec & adcValues = trackerRawData->getADCValues ();
 
           if ( _pedestalAlgo == EUTELESCOPE::MEANRMS ) {
-            // in the case of MEANRMS we have to deal with the standard
-            // vectors
-            ShortVec::iterator iter = adcValues.begin();
-            FloatVec tempDoubleVec;
-            while ( iter != adcValues.end() ) {
-              tempDoubleVec.push_back( static_cast< double > (*iter));
-              ++iter;
-            }
-            _tempPede.push_back(tempDoubleVec);
-
-            // initialize _tempNoise and _tempEntries with all zeros and
-            // ones
-            _tempNoise.push_back(FloatVec(adcValues.size(), 0.));
-            _tempEntries.push_back(IntVec(adcValues.size(), 1));
+            // in the case of MEANRMS we have to deal with the
+            // accumulators
+            _tempAccumulator.push_back( EUTelPixelAccumulator< double >() );
+            _tempAccumulator.back().setExactVariance( _exactMeanRMSNoise );
+            _tempAccumulator.back().start( adcValues.size(), &adcValues[0] );
 
 
           } else if ( _pedestalAlgo == EUTELESCOPE::AIDAPROFILE ) {
@@ -961,38 +972,14 @@ void EUTelPedestalNoiseProcessor::firstLoop(LCEvent * event) {
 
           // get the TrackerRawData object from the collection for this plane
           TrackerRawData *trackerRawData = dynamic_cast < TrackerRawData * >(collectionVec->getElementAt (iDetector));
-          ShortVec adcValues = trackerRawData->getADCValues ();
+          const ShortVec & adcValues = trackerRawData->getADCValues ();
 
           size_t detectorOffset = ( iCol == 0 ) ? 0 : _noOfDetectorVec.at( iCol - 1 );
 
           if ( _pedestalAlgo == EUTELESCOPE::MEANRMS ) {
 
-            // start looping on all pixels
-            int iPixel = 0;
-            for (int yPixel = _minY[ iDetector + detectorOffset ]; yPixel <= _maxY[ iDetector + detectorOffset ]; yPixel++) {
-              for (int xPixel = _minX[ iDetector + detectorOffset ]; xPixel <= _maxX[ iDetector + detectorOffset ]; xPixel++) {
-                short currentVal = adcValues[iPixel];
-                bool use = true;
-                if ( _preLoopSwitch && ( ( _iEvt == _maxValuePos[ iDetector + detectorOffset ] [ iPixel ] ) ||
-                                         ( _iEvt == _minValuePos[ iDetector + detectorOffset ] [ iPixel ] ) )  ) {
-                  use = false;
-                }
-
-                if ( use ) {
-
-                  _tempEntries[iDetector + detectorOffset][iPixel]    =   _tempEntries[iDetector + detectorOffset][iPixel] + 1;
-                  _tempPede   [iDetector + detectorOffset][iPixel]    = ((_tempEntries[iDetector + detectorOffset][iPixel] - 1)
-                                                                         * _tempPede[iDetector + detectorOffset][iPixel]
-                                                                         +  currentVal) / _tempEntries[iDetector+detectorOffset][iPixel];
-                  _tempNoise  [iDetector + detectorOffset][iPixel]   = sqrt(((_tempEntries[iDetector+detectorOffset][iPixel] - 1)
-                                                                             * pow(_tempNoise[iDetector+detectorOffset][iPixel],2)
-                                                                             + pow( currentVal - _tempPede[iDetector+detectorOffset][iPixel], 2)) /
-                                                                            _tempEntries[iDetector+detectorOffset][iPixel]);
-                }
-
-                ++iPixel;
-              } // end loop on xPixel
-            }   // end loop on yPixel
+            setPreLoopWeight( iDetector + detectorOffset, adcValues.size() );
+            _tempAccumulator[ iDetector + detectorOffset ].add( &adcValues[0], &_tempWeight[0] );
 
 
           } else if ( _pedestalAlgo == EUTELESCOPE::AIDAPROFILE ) {
@@ -1070,137 +1057,23 @@ void EUTelPedestalNoiseProcessor::otherLoop(LCEvent * event) {
 
         // get the TrackerRawData object from the collection for this detector
         TrackerRawData *trackerRawData = dynamic_cast < TrackerRawData * >(collectionVec->getElementAt (iDetector));
-        ShortVec adcValues = trackerRawData->getADCValues ();
+        const ShortVec & adcValues = trackerRawData->getADCValues ();
+
+        size_t detectorOffset = ( iCol == 0 ) ? 0 : _noOfDetectorVec.at( iCol - 1 );
 
         // new approach for a better common mode calculation. The idea
         // is that instead of using, as before, a single value of
         // common mode per matrix, we will have a vector of floats
         // containing the common mode correction for each pixel
-        vector< float > commonModeCorVec;
-        commonModeCorVec.clear();
-
-        bool isEventValid = true;
-        int    skippedPixel = 0;
-        int    skippedRow   = 0;
-
-        size_t detectorOffset = ( iCol == 0 ) ? 0 : _noOfDetectorVec.at( iCol - 1 );
-
-        if ( _commonModeAlgo == EUTELESCOPE::FULLFRAME ) {
-
-          double pixelSum     = 0.;
-          double commonMode   = 0.;
-          int    goodPixel    = 0;
-          int    iPixel       = 0;
-
-          // start looping on all pixels for hit rejection
-          for (int yPixel = _minY[iDetector + detectorOffset ]; yPixel <= _maxY[iDetector + detectorOffset ]; yPixel++) {
-            for (int xPixel = _minX[iDetector + detectorOffset ]; xPixel <= _maxX[iDetector + detectorOffset ]; xPixel++) {
-              bool isHit  = ( ( adcValues[iPixel] - _pedestal[iDetector + detectorOffset][iPixel] ) > _hitRejectionCut * _noise[iDetector + detectorOffset][iPixel] );
-              bool isGood = ( _status[iDetector + detectorOffset ][iPixel] == EUTELESCOPE::GOODPIXEL );
-              if ( !isHit && isGood ) {
-                pixelSum += adcValues[iPixel] - _pedestal[iDetector + detectorOffset ][iPixel];
-                ++goodPixel;
-              } else if ( isHit ) {
-                ++skippedPixel;
-              }
-              ++iPixel;
-            }
-          }
-
-          if ( ( skippedPixel < _maxNoOfRejectedPixels ) &&
-               ( goodPixel != 0 ) ) {
+        vector< float > commonModeCorVec( adcValues.size(), 0. );
+        bool isEventValid = calculateCommonMode( iDetector + detectorOffset, _iEvt, &adcValues[0], &commonModeCorVec[0] );
 
-            commonMode = pixelSum / goodPixel;
-            commonModeCorVec.insert( commonModeCorVec.begin(), iPixel + 1 , commonMode );
-            isEventValid = true;
+        if ( isEventValid && ( _pedestalAlgo == EUTELESCOPE::MEANRMS ) ) {
 
-#if defined(USE_AIDA) || defined(MARLIN_USE_AIDA)
-              string histoname = _commonModeHistoName + "_d" + to_string( _orderedSensorIDVec.at( iDetector + detectorOffset ) )
-                + "_l" + to_string( _iLoop );
-              AIDA::IHistogram1D * histo = (dynamic_cast<AIDA::IHistogram1D*>(_aidaHistoMap[ histoname ]));
-              if ( histo ) {
-                histo->fill(commonMode);
-              }
-#endif
+          setPreLoopWeight( iDetector + detectorOffset, adcValues.size() );
+          accumulateCorrected( iDetector + detectorOffset, &adcValues[0], &commonModeCorVec[0], &_tempWeight[0] );
 
-          } else {
-
-            isEventValid = false;
-
-          }
-
-        } else if ( _commonModeAlgo == EUTELESCOPE::ROWWISE ) {
-
-          int    iPixel       = 0;
-          int    colCounter   = 0;
-          int    rowLength    = _maxX[iDetector + detectorOffset] -  _minX[iDetector + detectorOffset] + 1;
-
-          for (int yPixel = _minY[iDetector + detectorOffset]; yPixel <= _maxY[iDetector + detectorOffset]; yPixel++) {
-
-            double pixelSum           = 0.;
-            double commonMode         = 0.;
-            int    goodPixel          = 0;
-            int    skippedPixelPerRow = 0;
-
-            for ( int xPixel = _minX[iDetector + detectorOffset]; xPixel <= _maxX[iDetector + detectorOffset]; xPixel++) {
-              bool isHit  = ( ( adcValues[iPixel] - _pedestal[iDetector + detectorOffset][iPixel] ) > _hitRejectionCut * _noise[iDetector + detectorOffset][iPixel] );
-              bool isGood = ( _status[iDetector + detectorOffset][iPixel] == EUTELESCOPE::GOODPIXEL );
-              if ( !isHit && isGood ) {
-                pixelSum += adcValues[iPixel] - _pedestal[iDetector + detectorOffset][iPixel];
-                ++goodPixel;
-              } else if ( isHit ) {
-                ++skippedPixelPerRow;
-                ++skippedPixel;
-              }
-              ++iPixel;
-            }
-
-            // we are now at the end of the row, so let's calculate the
-            // common mode
-            if ( ( skippedPixelPerRow < _maxNoOfRejectedPixelPerRow ) &&
-                 ( goodPixel != 0 ) ) {
-              commonMode = pixelSum / goodPixel ;
-              commonModeCorVec.insert( commonModeCorVec.begin() + colCounter * rowLength, rowLength, commonMode );
-
-#if defined(USE_AIDA) || defined(MARLIN_USE_AIDA)
-              string histoname = _commonModeHistoName + "_d" + to_string( _orderedSensorIDVec.at( iDetector + detectorOffset ) )
-                + "_l" + to_string( _iLoop );
-              AIDA::IHistogram1D * histo = (dynamic_cast<AIDA::IHistogram1D*>(_aidaHistoMap[ histoname ]));
-              if ( histo ) {
-                histo->fill(commonMode);
-              }
-#endif
-
-            } else {
-              commonModeCorVec.insert( commonModeCorVec.begin() + colCounter * rowLength, rowLength, 0. );
-              ++skippedRow;
-            }
-
-            ++colCounter;
-          }
-
-
-          if ( skippedRow < _maxNoOfSkippedRow ) {
-
-            isEventValid = true;
-
-          } else {
-
-            isEventValid = false;
-
-          }
-
-        } else {
-          streamlog_out ( ERROR4 ) << "Unknown common mode algorithm. Using flat null correction" << endl;
-          commonModeCorVec.insert( commonModeCorVec.begin(),
-                                   ( _maxY[iDetector + detectorOffset] - _minY[iDetector + detectorOffset] + 1 ) *
-                                   ( _maxX[iDetector + detectorOffset] - _minX[iDetector + detectorOffset] + 1 ),
-                                   0. );
-          isEventValid = true;
-        }
-
-
-        if ( isEventValid ) {
+        } else if ( isEventValid ) {
 
           int iPixel = 0;
           for (int yPixel = _minY[iDetector + detectorOffset]; yPixel <= _maxY[iDetector + detectorOffset]; yPixel++) {
@@ -1208,24 +1081,7 @@ void EUTelPedestalNoiseProcessor::otherLoop(LCEvent * event) {
               if ( _status[iDetector + detectorOffset][iPixel] == EUTELESCOPE::GOODPIXEL ) {
                 double pedeCorrected = adcValues[iPixel] - commonModeCorVec[iPixel];
                 if ( std::abs( pedeCorrected - _pedestal[iDetector + detectorOffset][iPixel] ) < _hitRejectionCut * _noise[iDetector + detectorOffset][iPixel] ) {
-                  if ( _pedestalAlgo == EUTELESCOPE::MEANRMS ) {
-
-                    bool use = true;
-                    if ( _preLoopSwitch && ( ( _iEvt == _maxValuePos[ iDetector  + detectorOffset ] [ iPixel ] ) ||
-                                             ( _iEvt == _minValuePos[ iDetector  + detectorOffset ] [ iPixel ] ) )  ) {
-                      use = false;
-                    }
-                    if ( use ) {
-                      _tempEntries[iDetector + detectorOffset][iPixel] = _tempEntries[iDetector + detectorOffset][iPixel] + 1;
-                      _tempPede[iDetector + detectorOffset][iPixel]    = ((_tempEntries[iDetector + detectorOffset][iPixel] - 1)
-                                                                          * _tempPede[iDetector + detectorOffset][iPixel]
-                                                                          + pedeCorrected) / _tempEntries[iDetector + detectorOffset][iPixel];
-                      _tempNoise[iDetector + detectorOffset][iPixel]   = sqrt(((_tempEntries[iDetector + detectorOffset][iPixel] - 1)
-                                                                               * pow(_tempNoise[iDetector + detectorOffset][iPixel],2)
-                                                                               + pow(pedeCorrected - _tempPede[iDetector + detectorOffset][iPixel], 2)) /
-                                                                              _tempEntries[iDetector + detectorOffset][iPixel]);
-                    }
-                  } else if ( _pedestalAlgo == EUTELESCOPE::AIDAPROFILE) {
+                  if ( _pedestalAlgo == EUTELESCOPE::AIDAPROFILE) {
 #if defined(USE_AIDA) || defined(MARLIN_USE_AIDA)
                     bool use = true;
                     if ( _preLoopSwitch && ( ( _iEvt == _maxValuePos[ iDetector  + detectorOffset ] [ iPixel ] ) ||
@@ -1246,14 +1102,6 @@ void EUTelPedestalNoiseProcessor::otherLoop(LCEvent * event) {
             }
           }
         } else {
-          if ( _commonModeAlgo == EUTELESCOPE::FULLFRAME ) {
-            streamlog_out ( WARNING2 ) <<  "Skipping event " << _iEvt << " because of max number of rejected pixels exceeded. ("
-                                       << skippedPixel << ") on detector " << _orderedSensorIDVec.at( iDetector ) << endl;
-          } else if ( _commonModeAlgo == EUTELESCOPE::ROWWISE ) {
-            streamlog_out ( WARNING2 ) <<  "Skipping event " << _iEvt << " because of max number of skipped rows is reached. ("
-                                       << skippedRow << ") on detector " << _orderedSensorIDVec.at( iDetector ) << endl;
-          }
-
           // the event has been skipped, so add this event number to the
           // skipped list
           _skippedEventList.push_back( _iEvt );
@@ -1267,6 +1115,109 @@ void EUTelPedestalNoiseProcessor::otherLoop(LCEvent * event) {
 
 }
 
+void EUTelPedestalNoiseProcessor::setPreLoopWeight( size_t iDetector, size_t noOfPixel ) {
+
+  // all pixels are used, but the ones with the maximum and minimum
+  // signal found in the pre loop
+  _tempWeight.assign( noOfPixel, 1. );
+  if ( _preLoopSwitch ) {
+    const ShortVec & maxValuePos = _maxValuePos[ iDetector ];
+    const ShortVec & minValuePos = _minValuePos[ iDetector ];
+    for ( size_t iPixel = 0; iPixel < noOfPixel; ++iPixel ) {
+      if ( ( _iEvt == maxValuePos[ iPixel ] ) || ( _iEvt == minValuePos[ iPixel ] ) ) _tempWeight[ iPixel ] = 0.;
+    }
+  }
+
+}
+
+void EUTelPedestalNoiseProcessor::accumulateCorrected( size_t iDetector, const short * adcValues, const float * commonModeCorrection, float * weight ) {
+
+  const FloatVec & pedestal = _pedestal[iDetector];
+  const FloatVec & noise    = _noise[iDetector];
+  const ShortVec & status   = _status[iDetector];
+  size_t noOfPixel = pedestal.size();
+
+  // only good pixels below the hit rejection cut are used
+  _tempValue.resize( noOfPixel );
+  for ( size_t iPixel = 0; iPixel < noOfPixel; ++iPixel ) {
+    float pedeCorrected = adcValues[iPixel] - commonModeCorrection[iPixel];
+    bool  use = ( status[iPixel] == EUTELESCOPE::GOODPIXEL ) &&
+      ( std::abs( static_cast< double >( pedeCorrected ) - pedestal[iPixel] ) < _hitRejectionCut * noise[iPixel] );
+    _tempValue[iPixel] = pedeCorrected;
+    if ( !use ) weight[iPixel] = 0.;
+  }
+  _tempAccumulator[iDetector].add( &_tempValue[0], weight );
+
+}
+
+bool EUTelPedestalNoiseProcessor::calculateCommonMode( size_t iDetector, int eventNumber, const short * adcValues, float * commonModeCorrection ) {
+
+  const float * pedestal = &_pedestal[iDetector][0];
+  const float * noise    = &_noise[iDetector][0];
+  const short * status   = &_status[iDetector][0];
+  int rowLength = _maxX[iDetector] - _minX[iDetector] + 1;
+  int noOfRows  = _maxY[iDetector] - _minY[iDetector] + 1;
+
+  if ( _commonModeAlgo == EUTELESCOPE::FULLFRAME ) {
+
+    // start looping on all pixels for hit rejection
+    EUTelCommonModeSum frame = commonModeSum( rowLength * noOfRows, adcValues, pedestal, noise, status, _hitRejectionCut );
+
+    if ( ( frame.skippedPixel >= _maxNoOfRejectedPixels ) || ( frame.goodPixel == 0 ) ) {
+      streamlog_out ( WARNING2 ) <<  "Skipping event " << eventNumber << " because of max number of rejected pixels exceeded. ("
+                                 << frame.skippedPixel << ") on detector " << _orderedSensorIDVec.at( iDetector ) << endl;
+      return false;
+    }
+
+    double commonMode = frame.sum / frame.goodPixel;
+    fill( commonModeCorrection, commonModeCorrection + rowLength * noOfRows, commonMode );
+
+#if defined(USE_AIDA) || defined(MARLIN_USE_AIDA)
+    string histoname = _commonModeHistoName + "_d" + to_string( _orderedSensorIDVec.at( iDetector ) ) + "_l" + to_string( _iLoop );
+    if ( AIDA::IHistogram1D * histo = dynamic_cast<AIDA::IHistogram1D*>(_aidaHistoMap[ histoname ]) ) histo->fill(commonMode);
+#endif
+    return true;
+
+  } else if ( _commonModeAlgo == EUTELESCOPE::ROWWISE ) {
+
+    int skippedRow = 0;
+
+    for ( int iRow = 0; iRow < noOfRows; ++iRow ) {
+
+      int    first      = iRow * rowLength;
+      double commonMode = 0.;
+      EUTelCommonModeSum row = commonModeSum( rowLength, adcValues + first, pedestal + first, noise + first, status + first,
+                                              _hitRejectionCut );
+
+      // we are now at the end of the row, so let's calculate the
+      // common mode
+      if ( ( row.skippedPixel < _maxNoOfRejectedPixelPerRow ) &&
+           ( row.goodPixel != 0 ) ) {
+        commonMode = row.sum / row.goodPixel ;
+#if defined(USE_AIDA) || defined(MARLIN_USE_AIDA)
+        string histoname = _commonModeHistoName + "_d" + to_string( _orderedSensorIDVec.at( iDetector ) ) + "_l" + to_string( _iLoop );
+        if ( AIDA::IHistogram1D * histo = dynamic_cast<AIDA::IHistogram1D*>(_aidaHistoMap[ histoname ]) ) histo->fill(commonMode);
+#endif
+      } else {
+        ++skippedRow;
+      }
+      fill( commonModeCorrection + first, commonModeCorrection + first + rowLength, commonMode );
+    }
+
+    if ( skippedRow >= _maxNoOfSkippedRow ) {
+      streamlog_out ( WARNING2 ) <<  "Skipping event " << eventNumber << " because of max number of skipped rows is reached. ("
+                                 << skippedRow << ") on detector " << _orderedSensorIDVec.at( iDetector ) << endl;
+      return false;
+    }
+    return true;
+
+  }
+
+  streamlog_out ( ERROR4 ) << "Unknown common mode algorithm. Using flat null correction" << endl;
+  fill( commonModeCorrection, commonModeCorrection + rowLength * noOfRows, 0. );
+  return true;
+}
+
 void EUTelPedestalNoiseProcessor::bookHistos() {
 
 #if defined(USE_AIDA) || defined(MARLIN_USE_AIDA)
@@ -1549,7 +1500,7 @@ void EUTelPedestalNoiseProcessor::simpleRewind() {
 
 }
 
-void EUTelPedestalNoiseProcessor::finalizeProcessor(bool fromMaskingLoop) {
+void EUTelPedestalNoiseProcessor::finalizeLoop(bool fromMaskingLoop) {
 
   if ( _iLoop > 0 ) {
     _skippedEventList.sort();
@@ -1566,15 +1517,17 @@ void EUTelPedestalNoiseProcessor::finalizeProcessor(bool fromMaskingLoop) {
 
     if ( _pedestalAlgo == EUTELESCOPE::MEANRMS ) {
 
-      // the loop on events is over so we need to move temporary vectors
-      // to final vectors
-      _pedestal = _tempPede;
-      _noise    = _tempNoise;
+      // the loop on events is over so we need to move the running
+      // average and sigma to final vectors
+      _pedestal.clear();
+      _noise.clear();
+      for ( size_t iDetector = 0; iDetector < _tempAccumulator.size(); ++iDetector ) {
+        _pedestal.push_back( _tempAccumulator[iDetector].getMean() );
+        _noise.push_back( _tempAccumulator[iDetector].getSigma() );
+      }
 
-      // clear the temporary vectors
-      _tempPede.clear();
-      _tempNoise.clear();
-      _tempEntries.clear();
+      // clear the temporary accumulators
+      _tempAccumulator.clear();
 
     } else if ( _pedestalAlgo == EUTELESCOPE::AIDAPROFILE ) {
 
@@ -1649,126 +1602,138 @@ void EUTelPedestalNoiseProcessor::finalizeProcessor(bool fromMaskingLoop) {
 
   // increment the loop counter
   ++_iLoop;
+}
 
-  // check if we need another loop or we can finish. Remember that we
-  // have a total number of loop of _noOfCMIteration + 1 + eventually
-  // the additional loop on bad pixel masking
-
-  int additionalLoop = 0;
-  if ( _additionalMaskingLoop ) additionalLoop = 1;
-  if ( _iLoop == _noOfCMIterations + 1 + additionalLoop ) {
+void EUTelPedestalNoiseProcessor::writePedestalFile() {
 
-    // ok this was last loop whatever kind of loop (first, other or
-    // additional) it was.
+  streamlog_out ( MESSAGE4 ) << "Writing the output condition file" << endl;
 
-    streamlog_out ( MESSAGE4 ) << "Writing the output condition file" << endl;
+  LCWriter * lcWriter = LCFactory::getInstance()->createLCWriter();
 
-    LCWriter * lcWriter = LCFactory::getInstance()->createLCWriter();
+  try {
+    lcWriter->open(_outputPedeFileName,LCIO::WRITE_APPEND);
+  } catch (IOException& e) {
+    cerr << e.what() << endl;
+    return;
+  }
 
-    try {
-      lcWriter->open(_outputPedeFileName,LCIO::WRITE_APPEND);
-    } catch (IOException& e) {
-      cerr << e.what() << endl;
-      return;
-    }
+  LCEventImpl * event = new LCEventImpl();
+  event->setDetectorName(_detectorName);
+  event->setRunNumber(_iRun);
+
+  LCTime * now = new LCTime;
+  event->setTimeStamp(now->timeStamp());
+  delete now;
+
+
+  LCCollectionVec * pedestalCollection = new LCCollectionVec(LCIO::TRACKERDATA);
+  LCCollectionVec * noiseCollection    = new LCCollectionVec(LCIO::TRACKERDATA);
+  LCCollectionVec * statusCollection   = new LCCollectionVec(LCIO::TRACKERRAWDATA);
+
+  for ( size_t iDetector = 0; iDetector < _noOfDetector; iDetector++) {
+
+    TrackerDataImpl    * pedestalMatrix = new TrackerDataImpl;
+    TrackerDataImpl    * noiseMatrix    = new TrackerDataImpl;
+    TrackerRawDataImpl * statusMatrix   = new TrackerRawDataImpl;
+
+    CellIDEncoder<TrackerDataImpl>    idPedestalEncoder(EUTELESCOPE::MATRIXDEFAULTENCODING, pedestalCollection);
+    CellIDEncoder<TrackerDataImpl>    idNoiseEncoder(EUTELESCOPE::MATRIXDEFAULTENCODING, noiseCollection);
+    CellIDEncoder<TrackerRawDataImpl> idStatusEncoder(EUTELESCOPE::MATRIXDEFAULTENCODING, statusCollection);
+
+    idPedestalEncoder["sensorID"] = _orderedSensorIDVec.at( iDetector );
+    idNoiseEncoder["sensorID"]    = _orderedSensorIDVec.at( iDetector );
+    idStatusEncoder["sensorID"]   = _orderedSensorIDVec.at( iDetector );
+    idPedestalEncoder["xMin"]     = _minX[iDetector];
+    idNoiseEncoder["xMin"]        = _minX[iDetector];
+    idStatusEncoder["xMin"]       = _minX[iDetector];
+    idPedestalEncoder["xMax"]     = _maxX[iDetector];
+    idNoiseEncoder["xMax"]        = _maxX[iDetector];
+    idStatusEncoder["xMax"]       = _maxX[iDetector];
+    idPedestalEncoder["yMin"]     = _minY[iDetector];
+    idNoiseEncoder["yMin"]        = _minY[iDetector];
+    idStatusEncoder["yMin"]       = _minY[iDetector];
+    idPedestalEncoder["yMax"]     = _maxY[iDetector];
+    idNoiseEncoder["yMax"]        = _maxY[iDetector];
+    idStatusEncoder["yMax"]       = _maxY[iDetector];
+    idPedestalEncoder.setCellID(pedestalMatrix);
+    idNoiseEncoder.setCellID(noiseMatrix);
+    idStatusEncoder.setCellID(statusMatrix);
+
+    pedestalMatrix->setChargeValues(_pedestal[iDetector]);
+    noiseMatrix->setChargeValues(_noise[iDetector]);
+    statusMatrix->setADCValues(_status[iDetector]);
+
+    pedestalCollection->push_back(pedestalMatrix);
+    noiseCollection->push_back(noiseMatrix);
+    statusCollection->push_back(statusMatrix);
+
+    if ( _asciiOutputSwitch ) {
+      if ( iDetector == 0 ) streamlog_out ( MESSAGE4 ) << "Writing the ASCII pedestal files" << endl;
+      stringstream ss;
+      ss << _outputPedeFileName << "-b" << iDetector << ".dat";
+      ofstream asciiPedeFile(ss.str().c_str());
+      asciiPedeFile << "# Pedestal and noise for board number " << iDetector << endl
+                    << "# calculated from run " << _outputPedeFileName << endl;
+
+      const int subMatrixWidth = 3;
+      const int xPixelWidth    = 4;
+      const int yPixelWidth    = 4;
+      const int pedeWidth      = 15;
+      const int noiseWidth     = 15;
+      const int statusWidth    = 3;
+      const int precision      = 8;
 
-    LCEventImpl * event = new LCEventImpl();
-    event->setDetectorName(_detectorName);
-    event->setRunNumber(_iRun);
-
-    LCTime * now = new LCTime;
-    event->setTimeStamp(now->timeStamp());
-    delete now;
-
-
-    LCCollectionVec * pedestalCollection = new LCCollectionVec(LCIO::TRACKERDATA);
-    LCCollectionVec * noiseCollection    = new LCCollectionVec(LCIO::TRACKERDATA);
-    LCCollectionVec * statusCollection   = new LCCollectionVec(LCIO::TRACKERRAWDATA);
-
-    for ( size_t iDetector = 0; iDetector < _noOfDetector; iDetector++) {
-
-      TrackerDataImpl    * pedestalMatrix = new TrackerDataImpl;
-      TrackerDataImpl    * noiseMatrix    = new TrackerDataImpl;
-      TrackerRawDataImpl * statusMatrix   = new TrackerRawDataImpl;
-
-      CellIDEncoder<TrackerDataImpl>    idPedestalEncoder(EUTELESCOPE::MATRIXDEFAULTENCODING, pedestalCollection);
-      CellIDEncoder<TrackerDataImpl>    idNoiseEncoder(EUTELESCOPE::MATRIXDEFAULTENCODING, noiseCollection);
-      CellIDEncoder<TrackerRawDataImpl> idStatusEncoder(EUTELESCOPE::MATRIXDEFAULTENCODING, statusCollection);
-
-      idPedestalEncoder["sensorID"] = _orderedSensorIDVec.at( iDetector );
-      idNoiseEncoder["sensorID"]    = _orderedSensorIDVec.at( iDetector );
-      idStatusEncoder["sensorID"]   = _orderedSensorIDVec.at( iDetector );
-      idPedestalEncoder["xMin"]     = _minX[iDetector];
-      idNoiseEncoder["xMin"]        = _minX[iDetector];
-      idStatusEncoder["xMin"]       = _minX[iDetector];
-      idPedestalEncoder["xMax"]     = _maxX[iDetector];
-      idNoiseEncoder["xMax"]        = _maxX[iDetector];
-      idStatusEncoder["xMax"]       = _maxX[iDetector];
-      idPedestalEncoder["yMin"]     = _minY[iDetector];
-      idNoiseEncoder["yMin"]        = _minY[iDetector];
-      idStatusEncoder["yMin"]       = _minY[iDetector];
-      idPedestalEncoder["yMax"]     = _maxY[iDetector];
-      idNoiseEncoder["yMax"]        = _maxY[iDetector];
-      idStatusEncoder["yMax"]       = _maxY[iDetector];
-      idPedestalEncoder.setCellID(pedestalMatrix);
-      idNoiseEncoder.setCellID(noiseMatrix);
-      idStatusEncoder.setCellID(statusMatrix);
-
-      pedestalMatrix->setChargeValues(_pedestal[iDetector]);
-      noiseMatrix->setChargeValues(_noise[iDetector]);
-      statusMatrix->setADCValues(_status[iDetector]);
-
-      pedestalCollection->push_back(pedestalMatrix);
-      noiseCollection->push_back(noiseMatrix);
-      statusCollection->push_back(statusMatrix);
-
-      if ( _asciiOutputSwitch ) {
-        if ( iDetector == 0 ) streamlog_out ( MESSAGE4 ) << "Writing the ASCII pedestal files" << endl;
-        stringstream ss;
-        ss << _outputPedeFileName << "-b" << iDetector << ".dat";
-        ofstream asciiPedeFile(ss.str().c_str());
-        asciiPedeFile << "# Pedestal and noise for board number " << iDetector << endl
-                      << "# calculated from run " << _outputPedeFileName << endl;
-
-        const int subMatrixWidth = 3;
-        const int xPixelWidth    = 4;
-        const int yPixelWidth    = 4;
-        const int pedeWidth      = 15;
-        const int noiseWidth     = 15;
-        const int statusWidth    = 3;
-        const int precision      = 8;
-
-        int iPixel = 0;
-        for (int yPixel = _minY[iDetector]; yPixel <= _maxY[iDetector]; yPixel++) {
-          for (int xPixel = _minX[iDetector]; xPixel <= _maxX[iDetector]; xPixel++) {
-            asciiPedeFile << setiosflags(ios::left)
-                          << setw(subMatrixWidth) << iDetector
-                          << setw(xPixelWidth)    << xPixel
-                          << setw(yPixelWidth)    << yPixel
-                          << resetiosflags(ios::left) << setiosflags(ios::fixed) << setprecision(precision)
-                          << setw(pedeWidth)      << _pedestal[iDetector][iPixel]
-                          << setw(noiseWidth)     << _noise[iDetector][iPixel]
-                          << resetiosflags(ios::fixed)
-                          << setw(statusWidth)    << _status[iDetector][iPixel]
-                          << endl;
-            ++iPixel;
-          }
+      int iPixel = 0;
+      for (int yPixel = _minY[iDetector]; yPixel <= _maxY[iDetector]; yPixel++) {
+        for (int xPixel = _minX[iDetector]; xPixel <= _maxX[iDetector]; xPixel++) {
+          asciiPedeFile << setiosflags(ios::left)
+                        << setw(subMatrixWidth) << iDetector
+                        << setw(xPixelWidth)    << xPixel
+                        << setw(yPixelWidth)    << yPixel
+                        << resetiosflags(ios::left) << setiosflags(ios::fixed) << setprecision(precision)
+                        << setw(pedeWidth)      << _pedestal[iDetector][iPixel]
+                        << setw(noiseWidth)     << _noise[iDetector][iPixel]
+                        << resetiosflags(ios::fixed)
+                        << setw(statusWidth)    << _status[iDetector][iPixel]
+                        << endl;
+          ++iPixel;
         }
-        asciiPedeFile.close();
       }
+      asciiPedeFile.close();
     }
+  }
 
-    event->addCollection(pedestalCollection, _pedestalCollectionName);
-    event->addCollection(noiseCollection, _noiseCollectionName);
-    event->addCollection(statusCollection, _statusCollectionName);
+  event->addCollection(pedestalCollection, _pedestalCollectionName);
+  event->addCollection(noiseCollection, _noiseCollectionName);
+  event->addCollection(statusCollection, _statusCollectionName);
 
-    lcWriter->writeEvent(event);
-    delete event;
+  lcWriter->writeEvent(event);
+  delete event;
 
-    lcWriter->close();
+  lcWriter->close();
+
+}
+
+void EUTelPedestalNoiseProcessor::finalizeProcessor(bool fromMaskingLoop) {
+
+  // the results of this loop, the masking and the histograms
+  finalizeLoop( fromMaskingLoop );
+
+  // check if we need another loop or we can finish. Remember that we
+  // have a total number of loop of _noOfCMIteration + 1 + eventually
+  // the additional loop on bad pixel masking
+
+  int additionalLoop = 0;
+  if ( _additionalMaskingLoop ) additionalLoop = 1;
+  if ( _iLoop == _noOfCMIterations + 1 + additionalLoop ) {
+
+    // ok this was last loop whatever kind of loop (first, other or
+    // additional) it was.
+
+    writePedestalFile();
 
-    throw StopProcessingException(this);
     setReturnValue("IsPedestalFinished", true);
+    throw StopProcessingException(this);
 
   } else if ( _iLoop < _noOfCMIterations + 1 ) {
 
@@ -1781,12 +1746,11 @@ void EUTelPedestalNoiseProcessor::finalizeProcessor(bool fromMaskingLoop) {
     if ( _pedestalAlgo == EUTELESCOPE::MEANRMS ) {
 
       // the collection contains several TrackerRawData
-      // move back the _pedestal and _noise to the _temp vector
-      _tempPede  = _pedestal;
-      _tempNoise = _noise;
-
+      // restart the running average and sigma from _pedestal and _noise
+      _tempAccumulator.resize( _noOfDetector );
       for ( size_t iDetector = 0; iDetector < _noOfDetector; iDetector++) {
-        _tempEntries.push_back(IntVec( _noise[iDetector].size(), 1));
+        _tempAccumulator[iDetector].setExactVariance( _exactMeanRMSNoise );
+        _tempAccumulator[iDetector].start( _noise[iDetector].size(), &_pedestal[iDetector][0], &_noise[iDetector][0] );
       }
 
     } else if ( _pedestalAlgo == EUTELESCOPE::AIDAPROFILE ) {
@@ -1881,6 +1845,219 @@ void EUTelPedestalNoiseProcessor::additionalMaskingLoop(LCEvent * event) {
 }
 
 
+void EUTelPedestalNoiseProcessor::bufferEvent( LCEvent * event ) {
+
+  EUTelEventImpl * evt = static_cast<EUTelEventImpl*> (event);
+
+  // at the end of the pedestal events all the loops are done on the
+  // buffered frames and the processing stops as after the last loop
+  if ( ( evt->getEventType() == kEORE ) || ( ( _lastEvent != -1 ) && ( _iEvt >= _lastEvent ) ) ) {
+    streamlog_out ( DEBUG4 ) << "End of the pedestal events: calling singlePass()." << endl;
+    singlePass();
+    setReturnValue("IsPedestalFinished", true);
+    throw StopProcessingException(this);
+  }
+
+  if ( _iEvt < _firstEvent ) {
+    ++_iEvt;
+    throw SkipEventException(this);
+  }
+
+  if ( _frameOffset.empty() ) {
+    // a frame contains all the pixels of every detector, one detector
+    // after the other
+    _frameOffset.push_back( 0 );
+    for ( size_t iDetector = 0; iDetector < _noOfDetector; ++iDetector ) {
+      _frameOffset.push_back( _frameOffset.back() +
+                              ( _maxX[iDetector] - _minX[iDetector] + 1 ) * ( _maxY[iDetector] - _minY[iDetector] + 1 ) );
+    }
+    _frame.assign( _frameOffset.back(), 0 );
+    _frameBuffer.open( _frameOffset.back(), static_cast< size_t >( _singlePassMaxMemory ) << 20,
+                       _outputPedeFileName + "-frames.tmp" );
+  }
+
+  for ( size_t iCol = 0 ; iCol < _rawDataCollectionNameVec.size(); ++iCol ) {
+
+    size_t detectorOffset = ( iCol == 0 ) ? 0 : _noOfDetectorVec.at( iCol - 1 );
+
+    try {
+      LCCollectionVec *collectionVec = dynamic_cast < LCCollectionVec * >(evt->getCollection (_rawDataCollectionNameVec.at( iCol )));
+
+      for ( size_t iDetector = 0; iDetector < collectionVec->size(); iDetector++) {
+        TrackerRawData *trackerRawData = dynamic_cast < TrackerRawData * >(collectionVec->getElementAt (iDetector));
+        const ShortVec & adcValues = trackerRawData->getADCValues ();
+        size_t first = _frameOffset.at( iDetector + detectorOffset );
+        if ( adcValues.size() != _frameOffset.at( iDetector + detectorOffset + 1 ) - first ) {
+          streamlog_out ( WARNING2 ) << "Event " << _iEvt << " has " << adcValues.size() << " pixels on detector "
+                                     << _orderedSensorIDVec.at( iDetector + detectorOffset ) << ". Event not used." << endl;
+          ++_iEvt;
+          return;
+        }
+        copy( adcValues.begin(), adcValues.end(), _frame.begin() + first );
+      }
+    } catch (DataNotAvailableException& e) {
+      streamlog_out ( WARNING2 ) << "No input collection " << _rawDataCollectionNameVec.at( iCol ) << " is not available in the current event ("
+                                 << event->getEventNumber() << "). Event not used." << endl;
+      ++_iEvt;
+      return;
+    }
+  }
+
+  if ( !_frameBuffer.append( &_frame[0], _iEvt ) ) {
+    streamlog_out ( ERROR4 ) << _frameBuffer.getErrorMessage() << "\nSorry for quitting." << endl;
+    exit(-1);
+  }
+  ++_iEvt;
+}
+
+void EUTelPedestalNoiseProcessor::singlePass() {
+
+  if ( !_frameBuffer.finish() || ( _frameBuffer.size() == 0 ) ) {
+    streamlog_out ( ERROR4 ) << "No events buffered for the pedestal calculation. " << _frameBuffer.getErrorMessage() << endl;
+    _frameBuffer.close();
+    return;
+  }
+
+  const size_t nFrames   = _frameBuffer.size();
+  const size_t frameSize = _frameBuffer.frameSize();
+  streamlog_out ( MESSAGE4 ) << "Running all the loops on " << nFrames << " buffered events ("
+                             << _frameBuffer.getNSpilled() << " spilled to disk)" << endl;
+
+  // the pre loop: the events with the maximum and the minimum signal
+  // of each pixel are not used
+  vector< int > maxValuePos( frameSize, -1 );
+  vector< int > minValuePos( frameSize, -1 );
+  if ( _preLoopSwitch ) {
+    ShortVec maxValue( frameSize, numeric_limits< short >::min() );
+    ShortVec minValue( frameSize, numeric_limits< short >::max() );
+    for ( size_t iFrame = 0; iFrame < nFrames; ++iFrame ) {
+      const short * adcValues = _frameBuffer.frame( iFrame );
+      int eventNumber = _frameBuffer.eventNumber( iFrame );
+      for ( size_t iPixel = 0; iPixel < frameSize; ++iPixel ) {
+        if ( adcValues[ iPixel ] > maxValue[ iPixel ] ) {
+          maxValue[ iPixel ]    = adcValues[ iPixel ];
+          maxValuePos[ iPixel ] = eventNumber;
+        }
+        if ( adcValues[ iPixel ] < minValue[ iPixel ] ) {
+          minValue[ iPixel ]    = adcValues[ iPixel ];
+          minValuePos[ iPixel ] = eventNumber;
+        }
+      }
+    }
+  }
+
+  // the same initialization as in the first event of firstLoop():
+  // the first event starts the running average and sigma
+  const short * firstFrame = _frameBuffer.frame( 0 );
+  _status.clear();
+  _hitCounter.clear();
+  _tempAccumulator.resize( _noOfDetector );
+  for ( size_t iDetector = 0; iDetector < _noOfDetector; ++iDetector ) {
+    size_t noOfPixel = _frameOffset[ iDetector + 1 ] - _frameOffset[ iDetector ];
+    _status.push_back( ShortVec( noOfPixel, EUTELESCOPE::GOODPIXEL ) );
+    if ( _additionalMaskingLoop ) _hitCounter.push_back( ShortVec( noOfPixel, 0 ) );
+    _tempAccumulator[ iDetector ].setExactVariance( _exactMeanRMSNoise );
+    _tempAccumulator[ iDetector ].start( noOfPixel, firstFrame + _frameOffset[ iDetector ] );
+  }
+  bookHistos();
+
+  // weight of each pixel of a frame, 0 in the events excluded by the
+  // pre loop
+  vector< float > weight( frameSize, 1. );
+
+  // first loop
+  for ( size_t iFrame = 1; iFrame < nFrames; ++iFrame ) {
+    const short * adcValues = _frameBuffer.frame( iFrame );
+    int eventNumber = _frameBuffer.eventNumber( iFrame );
+    if ( _preLoopSwitch ) {
+      for ( size_t iPixel = 0; iPixel < frameSize; ++iPixel ) {
+        bool excluded = ( eventNumber == maxValuePos[ iPixel ] ) || ( eventNumber == minValuePos[ iPixel ] );
+        weight[ iPixel ] = excluded ? 0. : 1.;
+      }
+    }
+    for ( size_t iDetector = 0; iDetector < _noOfDetector; ++iDetector ) {
+      size_t first = _frameOffset[ iDetector ];
+      _tempAccumulator[ iDetector ].add( adcValues + first, &weight[ first ] );
+    }
+  }
+  finalizeLoop( false );
+
+  // common mode iterations as in otherLoop(): the running average
+  // and sigma start from the results of the previous loop
+  vector< float > commonModeCorVec( frameSize, 0. );
+  for ( int iIteration = 0; iIteration < _noOfCMIterations; ++iIteration ) {
+
+    _tempAccumulator.resize( _noOfDetector );
+    for ( size_t iDetector = 0; iDetector < _noOfDetector; ++iDetector ) {
+      _tempAccumulator[ iDetector ].setExactVariance( _exactMeanRMSNoise );
+      _tempAccumulator[ iDetector ].start( _noise[ iDetector ].size(), &_pedestal[ iDetector ][0], &_noise[ iDetector ][0] );
+    }
+
+    for ( size_t iFrame = 0; iFrame < nFrames; ++iFrame ) {
+      const short * adcValues = _frameBuffer.frame( iFrame );
+      int eventNumber = _frameBuffer.eventNumber( iFrame );
+      for ( size_t iPixel = 0; iPixel < frameSize; ++iPixel ) {
+        bool excluded = _preLoopSwitch && ( ( eventNumber == maxValuePos[ iPixel ] ) || ( eventNumber == minValuePos[ iPixel ] ) );
+        weight[ iPixel ] = excluded ? 0. : 1.;
+      }
+
+      for ( size_t iDetector = 0; iDetector < _noOfDetector; ++iDetector ) {
+        size_t first = _frameOffset[ iDetector ];
+        if ( !calculateCommonMode( iDetector, eventNumber, adcValues + first, &commonModeCorVec[ first ] ) ) {
+          _skippedEventList.push_back( eventNumber );
+          continue;
+        }
+        accumulateCorrected( iDetector, adcValues + first, &commonModeCorVec[ first ], &weight[ first ] );
+      }
+    }
+    finalizeLoop( false );
+  }
+
+  // additional masking loop as in additionalMaskingLoop(), without
+  // the events skipped by the common mode
+  if ( _additionalMaskingLoop ) {
+    vector< int > skippedEvents( _skippedEventList.begin(), _skippedEventList.end() );
+    sort( skippedEvents.begin(), skippedEvents.end() );
+
+    for ( size_t iFrame = 0; iFrame < nFrames; ++iFrame ) {
+      const short * adcValues = _frameBuffer.frame( iFrame );
+      int eventNumber = _frameBuffer.eventNumber( iFrame );
+      if ( binary_search( skippedEvents.begin(), skippedEvents.end(), eventNumber ) ) continue;
+
+      for ( size_t iDetector = 0; iDetector < _noOfDetector; ++iDetector ) {
+        const short * detectorValues = adcValues + _frameOffset[ iDetector ];
+        size_t noOfPixel = _frameOffset[ iDetector + 1 ] - _frameOffset[ iDetector ];
+        for ( size_t iPixel = 0; iPixel < noOfPixel; ++iPixel ) {
+          if ( _status[iDetector][iPixel] == EUTELESCOPE::GOODPIXEL ) {
+            float correctedValue = detectorValues[iPixel] - _pedestal[iDetector][iPixel];
+            float threshold      = _noise[iDetector][iPixel] * 3.0 ;
+#if defined(MARLIN_USE_AIDA) || defined(USE_AIDA)
+            if ( _histogramSwitch  && iPixel == 1 + ( noOfPixel / 10 ) ) {
+              string tempHistoName = _aPixelHistoName + "_d" + to_string( _orderedSensorIDVec.at( iDetector ) ) + "_l" + to_string( _iLoop ) ;
+              if ( AIDA::IHistogram1D * histo = dynamic_cast< AIDA::IHistogram1D*> ( _aidaHistoMap[ tempHistoName ] ) )
+                histo->fill( correctedValue );
+              else {
+                streamlog_out ( ERROR1 )  << "Not able to retrieve histogram pointer for " << tempHistoName
+                                          << ".\nDisabling histogramming from now on " << endl;
+                _histogramSwitch = false;
+              }
+            }
+#endif
+            if ( correctedValue > threshold ) {
+              _hitCounter[iDetector][iPixel]++;
+            }
+          }
+        }
+      }
+    }
+    finalizeLoop( true );
+  }
+
+  writePedestalFile();
+  _frameBuffer.close();
+}
+
+
 void EUTelPedestalNoiseProcessor::setBadPixelAlgoSwitches() {
 
   if ( find( _badPixelAlgoVec.begin(), _badPixelAlgoVec.end(), EUTELESCOPE::NOISEDISTRIBUTION ) != _badPixelAlgoVec.end() ) {
@@ -0,0 +1,94 @@
+/*
+ *   This source code is part of the Eutelescope package of Marlin.
+ *   You are free to use this source files for your own development as
+ *   long as it stays in a public research context. You are not
+ *   allowed to use it for commercial purpose. You must put this
+ *   header with author names in all development based on this file.
+ *
+ */
+
+// eutelescope includes ".h"
+#include "EUTelPedestalTracker.h"
+#include "EUTelPixelAccumulator.h"
+
+// system includes <>
+#include <algorithm>
+#include <cmath>
+
+using namespace eutelescope;
+
+EUTelPedestalTracker::EUTelPedestalTracker():
+  _pedestal(),
+  _variance(),
+  _refPedestal(),
+  _refNoise(),
+  _alpha(0.),
+  _hitRejectionCut(0.),
+  _noOfEvents(0),
+  _noOfEventsSinceDrift(0),
+  _noOfUpdatedSinceDrift(0.)
+{
+}
+
+void EUTelPedestalTracker::start(size_t noOfPixel, float const* pedestal, float const* noise, float weight, float hitRejectionCut)
+{
+  _pedestal.assign( pedestal, pedestal + noOfPixel );
+  _refPedestal.assign( pedestal, pedestal + noOfPixel );
+  _refNoise.assign( noise, noise + noOfPixel );
+  _variance.resize( noOfPixel );
+  for( size_t iPixel = 0; iPixel < noOfPixel; ++iPixel ) {
+    _variance[iPixel] = noise[iPixel] * noise[iPixel];
+  }
+  _alpha = ( weight > 1 ) ? 1 / weight : 1;
+  _hitRejectionCut = hitRejectionCut;
+  _noOfEvents = 0;
+  _noOfEventsSinceDrift = 0;
+  _noOfUpdatedSinceDrift = 0.;
+}
+
+void EUTelPedestalTracker::update(short const* adcValues, short const* status)
+{
+  if( _pedestal.empty() ) return;
+  _noOfUpdatedSinceDrift += exponentialWeightUpdate( _pedestal.size(), adcValues, status, _alpha, _hitRejectionCut,
+                                                     &_pedestal[0], &_variance[0] );
+  ++_noOfEvents;
+  ++_noOfEventsSinceDrift;
+}
+
+void EUTelPedestalTracker::snapshot(float* pedestal, float* noise) const
+{
+  for( size_t iPixel = 0; iPixel < _pedestal.size(); ++iPixel ) {
+    pedestal[iPixel] = _pedestal[iPixel];
+    noise[iPixel] = std::sqrt( _variance[iPixel] );
+  }
+}
+
+EUTelPedestalDrift EUTelPedestalTracker::getDrift()
+{
+  EUTelPedestalDrift drift = { _noOfEvents, 0., 0., 0., 0., 0, 0. };
+  size_t const noOfPixel = _pedestal.size();
+  if( noOfPixel == 0 ) return drift;
+
+  double sum = 0., sum2 = 0., ratio = 0.;
+  int noOfRatio = 0;
+  for( size_t iPixel = 0; iPixel < noOfPixel; ++iPixel ) {
+    double const shift = _pedestal[iPixel] - _refPedestal[iPixel];
+    sum  += shift;
+    sum2 += shift * shift;
+    drift.maxShift = std::max( drift.maxShift, std::fabs( shift ) );
+    if( std::fabs( shift ) > _hitRejectionCut * _refNoise[iPixel] ) ++drift.noOfDriftedPixel;
+    if( _refNoise[iPixel] > 0 ) {
+      ratio += std::sqrt( _variance[iPixel] ) / _refNoise[iPixel];
+      ++noOfRatio;
+    }
+  }
+  drift.meanShift = sum / noOfPixel;
+  drift.rmsShift = std::sqrt( std::max( sum2 / noOfPixel - drift.meanShift * drift.meanShift, 0. ) );
+  drift.meanNoiseRatio = ( noOfRatio > 0 ) ? ratio / noOfRatio : 0.;
+  if( _noOfEventsSinceDrift > 0 ) {
+    drift.updatedFraction = _noOfUpdatedSinceDrift / ( static_cast<double>( _noOfEventsSinceDrift ) * noOfPixel );
+  }
+  _noOfEventsSinceDrift = 0;
+  _noOfUpdatedSinceDrift = 0.;
+  return drift;
+}
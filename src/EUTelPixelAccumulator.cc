@@ -0,0 +1,246 @@
+/*
+ *   This source code is part of the Eutelescope package of Marlin.
+ *   You are free to use this source files for your own development as
+ *   long as it stays in a public research context. You are not
+ *   allowed to use it for commercial purpose. You must put this
+ *   header with author names in all development based on this file.
+ *
+ */
+
+// eutelescope includes ".h"
+#include "EUTelPixelAccumulator.h"
+#include "EUTELESCOPE.h"
+
+// system includes <>
+#include <cmath>
+
+using namespace eutelescope;
+
+namespace {
+
+  //! The MeanRMS update of all pixels, the weight replaces any branch
+  template <typename T, typename V>
+  void meanRMS(size_t noOfPixel, V const* value, float const* weight, T* entries, T* mean, T* variance) {
+    for( size_t iPixel = 0; iPixel < noOfPixel; ++iPixel ) {
+      T const w = weight[iPixel];
+      T const n = entries[iPixel] + w;
+      T const x = value[iPixel];
+      // start() gives every pixel one entry, n is never 0
+      T const scale = w / n;
+      mean[iPixel] += scale * ( x - mean[iPixel] );
+      T const residual = x - mean[iPixel];
+      variance[iPixel] += scale * ( residual * residual - variance[iPixel] );
+      entries[iPixel] = n;
+    }
+  }
+
+  //! The Welford update of all pixels, the weight replaces any branch
+  template <typename T, typename V>
+  void welford(size_t noOfPixel, V const* value, float const* weight, T* entries, T* mean, T* variance) {
+    for( size_t iPixel = 0; iPixel < noOfPixel; ++iPixel ) {
+      T const w = weight[iPixel];
+      T const n = entries[iPixel] + w;
+      T const x = value[iPixel];
+      T const delta = x - mean[iPixel];
+      // start() gives every pixel one entry, n is never 0
+      T const scale = w / n;
+      mean[iPixel] += scale * delta;
+      variance[iPixel] += scale * ( delta * ( x - mean[iPixel] ) - variance[iPixel] );
+      entries[iPixel] = n;
+    }
+  }
+
+  //! Pixels handled at once by commonModeSum(), divides the rows of the Mimosa sensors
+  size_t const blockSize = 64;
+
+  //! The selection of calibrateAndSelect(), with or without the calibrated frame
+  /*! The selected pixels are always written and the count is
+   *  incremented by the result of the cut, there is no branch on the
+   *  signal.
+   */
+  template <bool writeCorrected>
+  size_t select(size_t noOfPixel, short const* adcValues, float const* pedestal, float const* noise, short const* status,
+                float commonMode, float sigmaCut, float* corrected, unsigned int* selected, float* selectedSignal) {
+    short const good = EUTELESCOPE::GOODPIXEL;
+    size_t noOfSelected = 0;
+    for( size_t iPixel = 0; iPixel < noOfPixel; ++iPixel ) {
+      float const value = ( adcValues[iPixel] - pedestal[iPixel] ) - commonMode;
+      if( writeCorrected ) corrected[iPixel] = value;
+      selected[noOfSelected] = iPixel;
+      selectedSignal[noOfSelected] = value;
+      noOfSelected += ( value > sigmaCut * noise[iPixel] ) & ( status[iPixel] == good );
+    }
+    return noOfSelected;
+  }
+}
+
+template <typename T>
+EUTelPixelAccumulator<T>::EUTelPixelAccumulator():
+  _exactVariance(false),
+  _entries(),
+  _mean(),
+  _variance()
+{
+}
+
+template <typename T>
+void EUTelPixelAccumulator<T>::start(size_t noOfPixel, short const* value)
+{
+  _entries.assign( noOfPixel, T(1) );
+  _mean.assign( value, value + noOfPixel );
+  _variance.assign( noOfPixel, T(0) );
+}
+
+template <typename T>
+void EUTelPixelAccumulator<T>::start(size_t noOfPixel, float const* value)
+{
+  _entries.assign( noOfPixel, T(1) );
+  _mean.assign( value, value + noOfPixel );
+  _variance.assign( noOfPixel, T(0) );
+}
+
+template <typename T>
+void EUTelPixelAccumulator<T>::start(size_t noOfPixel, float const* mean, float const* sigma)
+{
+  _entries.assign( noOfPixel, T(1) );
+  _mean.assign( mean, mean + noOfPixel );
+  _variance.resize( noOfPixel );
+  for( size_t iPixel = 0; iPixel < noOfPixel; ++iPixel ) {
+    _variance[iPixel] = static_cast<T>( sigma[iPixel] ) * sigma[iPixel];
+  }
+}
+
+template <typename T>
+void EUTelPixelAccumulator<T>::add(short const* value, float const* weight)
+{
+  if( _mean.empty() ) return;
+  if( _exactVariance ) welford( _mean.size(), value, weight, &_entries[0], &_mean[0], &_variance[0] );
+  else meanRMS( _mean.size(), value, weight, &_entries[0], &_mean[0], &_variance[0] );
+}
+
+template <typename T>
+void EUTelPixelAccumulator<T>::add(float const* value, float const* weight)
+{
+  if( _mean.empty() ) return;
+  if( _exactVariance ) welford( _mean.size(), value, weight, &_entries[0], &_mean[0], &_variance[0] );
+  else meanRMS( _mean.size(), value, weight, &_entries[0], &_mean[0], &_variance[0] );
+}
+
+template <typename T>
+std::vector<float> EUTelPixelAccumulator<T>::getMean() const
+{
+  return std::vector<float>( _mean.begin(), _mean.end() );
+}
+
+template <typename T>
+std::vector<float> EUTelPixelAccumulator<T>::getSigma() const
+{
+  std::vector<float> sigma( _variance.size() );
+  for( size_t iPixel = 0; iPixel < _variance.size(); ++iPixel ) {
+    sigma[iPixel] = std::sqrt( _variance[iPixel] );
+  }
+  return sigma;
+}
+
+namespace eutelescope {
+  template class EUTelPixelAccumulator<float>;
+  template class EUTelPixelAccumulator<double>;
+}
+
+EUTelCommonModeSum eutelescope::commonModeSum(size_t noOfPixel, short const* adcValues, float const* pedestal,
+                                              float const* noise, short const* status, float hitRejectionCut)
+{
+  EUTelCommonModeSum result = { 0., 0, 0 };
+  short const good = EUTELESCOPE::GOODPIXEL;
+
+  // full blocks: the masks and the counts are computed in a loop of
+  // known length the compiler vectorises, the masked signals are then
+  // summed in double by four independent chains
+  float signal[blockSize];
+  size_t iBlock = 0;
+  for( ; iBlock + blockSize <= noOfPixel; iBlock += blockSize ) {
+    int goodPixel = 0, skippedPixel = 0;
+    for( size_t iPixel = 0; iPixel < blockSize; ++iPixel ) {
+      float const value = adcValues[iBlock + iPixel] - pedestal[iBlock + iPixel];
+      int const isHit = value > hitRejectionCut * noise[iBlock + iPixel];
+      int const use = !isHit & ( status[iBlock + iPixel] == good );
+      signal[iPixel] = use ? value : 0.f;
+      goodPixel += use;
+      skippedPixel += isHit;
+    }
+    double sum[4] = { 0., 0., 0., 0. };
+    for( size_t iPixel = 0; iPixel < blockSize; iPixel += 4 ) {
+      sum[0] += signal[iPixel];
+      sum[1] += signal[iPixel + 1];
+      sum[2] += signal[iPixel + 2];
+      sum[3] += signal[iPixel + 3];
+    }
+    result.sum += ( sum[0] + sum[1] ) + ( sum[2] + sum[3] );
+    result.goodPixel += goodPixel;
+    result.skippedPixel += skippedPixel;
+  }
+
+  for( size_t iPixel = iBlock; iPixel < noOfPixel; ++iPixel ) {
+    float const value = adcValues[iPixel] - pedestal[iPixel];
+    bool const isHit = value > hitRejectionCut * noise[iPixel];
+    if( !isHit && status[iPixel] == good ) {
+      result.sum += value;
+      ++result.goodPixel;
+    } else if( isHit ) {
+      ++result.skippedPixel;
+    }
+  }
+  return result;
+}
+
+size_t eutelescope::calibrateAndSelect(size_t noOfPixel, short const* adcValues, float const* pedestal, float const* noise,
+                                       short const* status, float commonMode, float sigmaCut, float* corrected,
+                                       unsigned int* selected, float* selectedSignal)
+{
+  if( !selected ) {
+    if( corrected ) {
+      for( size_t iPixel = 0; iPixel < noOfPixel; ++iPixel ) {
+        corrected[iPixel] = ( adcValues[iPixel] - pedestal[iPixel] ) - commonMode;
+      }
+    }
+    return 0;
+  }
+  if( corrected ) {
+    return select<true>( noOfPixel, adcValues, pedestal, noise, status, commonMode, sigmaCut, corrected, selected, selectedSignal );
+  }
+  return select<false>( noOfPixel, adcValues, pedestal, noise, status, commonMode, sigmaCut, corrected, selected, selectedSignal );
+}
+
+void eutelescope::fixedWeightUpdate(size_t noOfPixel, short const* adcValues, short const* status, float weight,
+                                    float* pedestal, float* noise)
+{
+  short const good = EUTELESCOPE::GOODPIXEL;
+  for( size_t iPixel = 0; iPixel < noOfPixel; ++iPixel ) {
+    float const x = adcValues[iPixel];
+    float const newPedestal = ( ( weight - 1 ) * pedestal[iPixel] + x ) / weight;
+    float const residual = x - newPedestal;
+    float const newNoise = std::sqrt( ( ( weight - 1 ) * noise[iPixel] * noise[iPixel] + residual * residual ) / weight );
+    bool const isGood = status[iPixel] == good;
+    pedestal[iPixel] = isGood ? newPedestal : pedestal[iPixel];
+    noise[iPixel] = isGood ? newNoise : noise[iPixel];
+  }
+}
+
+size_t eutelescope::exponentialWeightUpdate(size_t noOfPixel, short const* adcValues, short const* status, float alpha,
+                                            float hitRejectionCut, float* pedestal, float* variance)
+{
+  short const good = EUTELESCOPE::GOODPIXEL;
+  float const cut2 = hitRejectionCut * hitRejectionCut;
+  unsigned int noOfUpdated = 0;
+  for( size_t iPixel = 0; iPixel < noOfPixel; ++iPixel ) {
+    float const delta = adcValues[iPixel] - pedestal[iPixel];
+    int const use = ( delta * delta <= cut2 * variance[iPixel] ) & ( status[iPixel] == good );
+    // the step is multiplied by 0 or 1 rather than selected, this
+    // keeps the loop free of control flow
+    float const step = use * alpha;
+    pedestal[iPixel] += step * delta;
+    variance[iPixel] += step * ( ( 1 - alpha ) * delta * delta - variance[iPixel] );
+    noOfUpdated += use;
+  }
+  return noOfUpdated;
+}
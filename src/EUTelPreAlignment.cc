@@ -9,6 +9,7 @@
 #include "EUTelBrickedClusterImpl.h"
 #include "EUTelSparseClusterImpl.h"
 #include "EUTelGeometryTelescopeGeoDescription.h"
+#include "EUTelUtility.h"
 
 // marlin includes ".h"
 #include "marlin/Processor.h"
@@ -146,55 +147,8 @@ void EUTelPreAlign::processRunHeader(LCRunHeader* rdr) {
 
 void  EUTelPreAlign::FillHotPixelMap(LCEvent *event)
 {
-
   if( _hotPixelCollectionName.empty()) return;
-
-  LCCollectionVec* hotPixelCollectionVec = nullptr;
-  try 
-    {
-      hotPixelCollectionVec = static_cast< LCCollectionVec* > ( event->getCollection( _hotPixelCollectionName  ) );
-      streamlog_out ( DEBUG5 ) << "Hotpixel database " << _hotPixelCollectionName.c_str() << " found" << endl; 
-    }
-  catch (...)
-    {
-      streamlog_out ( WARNING5 ) << "Hotpixel database " << _hotPixelCollectionName.c_str() << " not found" << endl; 
-      return;
-    }
-
-  CellIDDecoder<TrackerDataImpl> cellDecoder( hotPixelCollectionVec );
-	
-  for(int i=0; i<  hotPixelCollectionVec->getNumberOfElements(); i++)
-    {
-      TrackerDataImpl* hotPixelData = dynamic_cast< TrackerDataImpl *> ( hotPixelCollectionVec->getElementAt( i ) );
-      SparsePixelType  type         = static_cast<SparsePixelType> (static_cast<int> (cellDecoder( hotPixelData )["sparsePixelType"]));
-
-      int sensorID = static_cast<int>( cellDecoder( hotPixelData )["sensorID"] );
-
-      if( type  ==  kEUTelGenericSparsePixel )
-	{  
-	  auto m26Data = std::make_unique<EUTelSparseClusterImpl<EUTelGenericSparsePixel>>(hotPixelData);
-
-	  std::vector<EUTelGenericSparsePixel*> m26PixelVec;
-	  EUTelGenericSparsePixel m26Pixel;
-	  //Push all single Pixels of one plane in the m26PixelVec
-
-	  for(  unsigned int iPixel = 0; iPixel < m26Data->size(); iPixel++ ) 
-	    {
-              std::vector<int> m26ColVec();
-              m26Data->getSparsePixelAt( iPixel, &m26Pixel);
-
-              try
-		{
-		  _hotPixelMap[sensorID].push_back(std::make_pair(m26Pixel.getXCoord(), m26Pixel.getYCoord()));
-		}
-              catch(...)
-		{
-		  streamlog_out ( ERROR5 ) << " cannot add pixel to hotpixel map! SensorID: "  << sensorID << ", X:" << m26Pixel.getXCoord() << ", Y:" << m26Pixel.getYCoord() << endl; 
-		  abort();
-		}
-	    }
-	}          
-    }
+  _hotPixelMask = Utility::FillHotPixelMask( event, _hotPixelCollectionName );
 }
 
 void EUTelPreAlign::processEvent(LCEvent* event)
@@ -311,7 +265,7 @@ bool EUTelPreAlign::hitContainsHotPixels( TrackerHitImpl   * hit)
 {
 
   // if no hot pixel map was loaded, just return here
-  if( _hotPixelMap.size() == 0) return 0;
+  if( _hotPixelMask.empty() ) return 0;
 
   try
     {
@@ -328,21 +282,11 @@ bool EUTelPreAlign::hitContainsHotPixels( TrackerHitImpl   * hit)
 	    {
 	      EUTelGenericSparsePixel m26Pixel;
 	      cluster->getSparsePixelAt( iPixel, &m26Pixel);
-	      {
-		try{
-		  if( std::find(_hotPixelMap.at(sensorID).begin(), 
-				_hotPixelMap.at(sensorID).end(),
-				std::make_pair(m26Pixel.getXCoord(),m26Pixel.getYCoord()))
-		      != _hotPixelMap.at(sensorID).end()){ 
-		    delete cluster;                        			  
-		    return true; // if TRUE  this hit will be skipped
-		  }
-		}
-		catch(const std::out_of_range& oor){
-		  streamlog_out(DEBUG0) << " Could not find hot pixel map for sensor ID " 
-					<< sensorID << ": " << oor.what() << endl;
+	      if( _hotPixelMask.isHot( sensorID, m26Pixel.getXCoord(), m26Pixel.getYCoord() ) )
+		{
+		  delete cluster;
+		  return true; // if TRUE  this hit will be skipped
 		}
-	      }
 	    }
 
 	  delete cluster;
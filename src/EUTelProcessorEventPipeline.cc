@@ -0,0 +1,464 @@
+/*
+ *   This source code is part of the Eutelescope package of Marlin.
+ *   You are free to use this source files for your own development as
+ *   long as it stays in a public research context. You are not
+ *   allowed to use it for commercial purpose. You must put this
+ *   header with author names in all development based on this file.
+ *
+ */
+
+// eutelescope includes ".h"
+#include "EUTelProcessorEventPipeline.h"
+#include "EUTelHistogramBooking.h"
+#include "EUTelGeometryTelescopeGeoDescription.h"
+#include "EUTelExceptions.h"
+
+// marlin includes ".h"
+#include "marlin/Processor.h"
+#include "marlin/ProcessorMgr.h"
+#include "marlin/Exceptions.h"
+#include "marlin/Global.h"
+#include "marlin/StringParameters.h"
+
+#if defined(USE_AIDA) || defined(MARLIN_USE_AIDA)
+#include "marlin/AIDAProcessor.h"
+#include <AIDA/ITree.h>
+#include <AIDA/IManagedObject.h>
+#include <AIDA/IHistogram1D.h>
+#include <AIDA/IHistogram2D.h>
+#include <AIDA/IProfile1D.h>
+#include <AIDA/IProfile2D.h>
+#endif
+
+// lcio includes <.h>
+#include <lcio.h>
+#include <IO/LCReader.h>
+#include <IOIMPL/LCFactory.h>
+#include <EVENT/LCRunHeader.h>
+
+// system includes <>
+#include <algorithm>
+#include <sstream>
+#include <thread>
+
+using namespace std;
+using namespace marlin;
+using namespace eutelescope;
+
+namespace {
+
+  // processors whose end() derives job wide results (constants, masks,
+  // alignment) from what they accumulated, split over several copies
+  // every one of them would write a result from a part of the events
+  char const* const endOfJobProcessorTypes[] = {
+    "EUTelMille",
+    "EUTelProcessorGBLAlign",
+    "EUTelPreAlign",
+    "EUTelCorrelator",
+    "EUTelProcessorNoisyPixelFinder",
+    "EUTelPedestalNoiseProcessor",
+    "EUTelAutoPedestalNoiseProcessor",
+    "AlibavaPedestalNoiseProcessor"
+  };
+
+  void copyParameters(EVENT::LCParameters const& params, EVENT::LCParameters& copyParams) {
+    EVENT::StringVec keys;
+    params.getIntKeys( keys );
+    for( size_t i = 0; i < keys.size(); ++i ) {
+      EVENT::IntVec values;
+      copyParams.setValues( keys[i], params.getIntVals( keys[i], values ) );
+    }
+    keys.clear();
+    params.getFloatKeys( keys );
+    for( size_t i = 0; i < keys.size(); ++i ) {
+      EVENT::FloatVec values;
+      copyParams.setValues( keys[i], params.getFloatVals( keys[i], values ) );
+    }
+    keys.clear();
+    params.getStringKeys( keys );
+    for( size_t i = 0; i < keys.size(); ++i ) {
+      EVENT::StringVec values;
+      copyParams.setValues( keys[i], params.getStringVals( keys[i], values ) );
+    }
+  }
+
+  // run headers returned by an LCReader only live until its next read
+  IMPL::LCRunHeaderImpl* copyRunHeader(EVENT::LCRunHeader const* header) {
+    IMPL::LCRunHeaderImpl* copy = new IMPL::LCRunHeaderImpl;
+    copy->setRunNumber( header->getRunNumber() );
+    copy->setDetectorName( header->getDetectorName() );
+    copy->setDescription( header->getDescription() );
+    std::vector<std::string> const* subdetectors = header->getActiveSubdetectors();
+    for( size_t i = 0; i < subdetectors->size(); ++i ) copy->addActiveSubdetector( (*subdetectors)[i] );
+    copyParameters( header->getParameters(), copy->parameters() );
+    return copy;
+  }
+
+  // the same holds for events: their collections are moved into a new
+  // event, the reader then only deletes the empty shell
+  IMPL::LCEventImpl* detachEvent(EVENT::LCEvent* event) {
+    IMPL::LCEventImpl* detached = new IMPL::LCEventImpl;
+    detached->setRunNumber( event->getRunNumber() );
+    detached->setEventNumber( event->getEventNumber() );
+    detached->setDetectorName( event->getDetectorName() );
+    detached->setTimeStamp( event->getTimeStamp() );
+    detached->setWeight( event->getWeight() );
+    copyParameters( event->getParameters(), detached->parameters() );
+
+    std::vector<std::string> const names( *event->getCollectionNames() );
+    for( size_t i = 0; i < names.size(); ++i ) {
+      detached->addCollection( event->takeCollection( names[i] ), names[i] );
+    }
+    return detached;
+  }
+
+#if defined(USE_AIDA) || defined(MARLIN_USE_AIDA)
+  // add all histograms of the copy into the same named ones of the original and remove them
+  void mergeProcessorHistograms(Processor* original, Processor* copy) {
+    AIDA::ITree* tree = AIDAProcessor::tree( copy );
+    std::string const copyDir = "/" + copy->name();
+    std::string const originalDir = "/" + original->name();
+
+    std::vector<std::string> names = tree->listObjectNames( copyDir, true );
+    std::vector<std::string> types = tree->listObjectTypes( copyDir, true );
+    std::vector<std::string> dirs;
+
+    for( size_t i = 0; i < names.size() && i < types.size(); ++i ) {
+      std::string relative = names[i];
+      if( relative.compare( 0, copyDir.size(), copyDir ) == 0 ) relative.erase( 0, copyDir.size() );
+      if( !relative.empty() && relative[0] == '/' ) relative.erase( 0, 1 );
+      if( relative.empty() ) continue;
+
+      std::string const copyPath = copyDir + "/" + relative;
+      if( types[i] == "dir" ) {
+        dirs.push_back( copyPath );
+        continue;
+      }
+
+      AIDA::IManagedObject* from = tree->find( copyPath );
+      AIDA::IManagedObject* to = tree->find( originalDir + "/" + relative );
+      bool merged = false;
+      if( from && to ) {
+        if( AIDA::IHistogram1D* h = dynamic_cast<AIDA::IHistogram1D*>( to ) ) {
+          AIDA::IHistogram1D* f = dynamic_cast<AIDA::IHistogram1D*>( from );
+          merged = f && h->add( *f );
+        } else if( AIDA::IHistogram2D* h = dynamic_cast<AIDA::IHistogram2D*>( to ) ) {
+          AIDA::IHistogram2D* f = dynamic_cast<AIDA::IHistogram2D*>( from );
+          merged = f && h->add( *f );
+        } else if( AIDA::IProfile1D* h = dynamic_cast<AIDA::IProfile1D*>( to ) ) {
+          AIDA::IProfile1D* f = dynamic_cast<AIDA::IProfile1D*>( from );
+          merged = f && h->add( *f );
+        } else if( AIDA::IProfile2D* h = dynamic_cast<AIDA::IProfile2D*>( to ) ) {
+          AIDA::IProfile2D* f = dynamic_cast<AIDA::IProfile2D*>( from );
+          merged = f && h->add( *f );
+        }
+      }
+      if( !merged ) {
+        streamlog_out( WARNING2 ) << "Could not merge " << copyPath << " into " << originalDir << std::endl;
+      }
+      tree->rm( copyPath );
+    }
+
+    // innermost directories first
+    std::sort( dirs.begin(), dirs.end() );
+    for( std::vector<std::string>::reverse_iterator it = dirs.rbegin(); it != dirs.rend(); ++it ) tree->rmdir( *it );
+    tree->rmdir( copyDir );
+  }
+#endif
+
+}
+
+EUTelProcessorEventPipeline::EUTelProcessorEventPipeline():
+  DataSourceProcessor("EUTelProcessorEventPipeline"),
+  _inputFiles(),
+  _parallelProcessorNames(),
+  _nThreads(0),
+  _workerProcessors(),
+  _workerRuns(),
+  _workerFirstEvent(),
+  _workerPool(),
+  _runHeaders(),
+  _committedRun(-1),
+  _eventQueue(),
+  _endOfInput(false),
+  _pipelineMutex(),
+  _pipelineCondition(),
+  _stop(false),
+  _error()
+{
+  _description =
+    "Reads LCIO files and runs the listed processors on several events at the same time.\n"
+    "All other processors see the events one after the other in their original order.";
+
+  registerProcessorParameter("InputFiles", "LCIO files to be read",
+                             _inputFiles, std::vector<std::string>() );
+
+  registerProcessorParameter("ParallelProcessors", "Names of the active processors which only depend on the current event and can run event parallel",
+                             _parallelProcessorNames, std::vector<std::string>() );
+
+  registerProcessorParameter("NumberOfThreads", "Number of worker threads, 0 for one per core",
+                             _nThreads, static_cast<int>(0) );
+}
+
+EUTelProcessorEventPipeline * EUTelProcessorEventPipeline::newProcessor() {
+  return new EUTelProcessorEventPipeline;
+}
+
+void EUTelProcessorEventPipeline::init() {
+  printParameters();
+
+  if( _inputFiles.empty() ) {
+    throw InvalidParameterException("EUTelProcessorEventPipeline needs at least one input file");
+  }
+
+  if( _nThreads <= 0 ) {
+    _nThreads = std::max( 1u, std::thread::hardware_concurrency() );
+  }
+
+  std::unique_ptr<IO::LCReader> reader( IOIMPL::LCFactory::getInstance()->createLCReader() );
+  reader->open( _inputFiles );
+  while( EVENT::LCRunHeader* header = reader->readNextRunHeader() ) {
+    _runHeaders[header->getRunNumber()].reset( copyRunHeader( header ) );
+  }
+  reader->close();
+
+  checkProcessorOrder();
+  createWorkerProcessors();
+
+  streamlog_out( MESSAGE4 ) << "Running " << _parallelProcessorNames.size() << " processors on " << _nThreads
+                            << " threads, " << _runHeaders.size() << " runs found in the input" << std::endl;
+}
+
+void EUTelProcessorEventPipeline::checkProcessorOrder() const {
+  // the parallel processors see every event before all serial ones,
+  // which is only what the steering file says if they come first
+  EVENT::StringVec activeProcessors;
+  Global::parameters->getStringVals( "ActiveProcessors", activeProcessors );
+
+  EVENT::StringVec::const_iterator it = std::find( activeProcessors.begin(), activeProcessors.end(), name() );
+  if( it != activeProcessors.end() ) ++it;
+  for( size_t iProc = 0; iProc < _parallelProcessorNames.size(); ++iProc, ++it ) {
+    if( it == activeProcessors.end() || *it != _parallelProcessorNames[iProc] ) {
+      throw InvalidParameterException("EUTelProcessorEventPipeline: the processors in ParallelProcessors have to follow "
+                                      + name() + " directly in the execute section and in the same order, "
+                                      + _parallelProcessorNames[iProc] + " does not");
+    }
+  }
+}
+
+void EUTelProcessorEventPipeline::createWorkerProcessors() {
+  ProcessorMgr* mgr = ProcessorMgr::instance();
+
+  _workerProcessors.assign( _nThreads, std::vector<Processor*>() );
+  for( size_t iProc = 0; iProc < _parallelProcessorNames.size(); ++iProc ) {
+    std::string const& name = _parallelProcessorNames[iProc];
+    Processor* original = mgr->getActiveProcessor( name );
+    if( !original ) {
+      throw InvalidParameterException("EUTelProcessorEventPipeline: no active processor called " + name);
+    }
+    char const* const* const typesEnd = endOfJobProcessorTypes + sizeof(endOfJobProcessorTypes)/sizeof(endOfJobProcessorTypes[0]);
+    if( std::find( endOfJobProcessorTypes, typesEnd, original->type() ) != typesEnd ) {
+      throw InvalidParameterException("EUTelProcessorEventPipeline: " + name + " of type " + original->type()
+                                      + " computes its results in end() and cannot run in parallel");
+    }
+    _workerProcessors[0].push_back( original );
+
+    // the copies are appended to the active processors, so Marlin
+    // initialises them after the processors of the steering file; each
+    // owns its parameters, which its destructor deletes
+    for( int iWorker = 1; iWorker < _nThreads; ++iWorker ) {
+      std::stringstream copyName;
+      copyName << name << "_worker" << iWorker;
+      mgr->addActiveProcessor( original->type(), copyName.str(), new StringParameters( *original->parameters() ) );
+      _workerProcessors[iWorker].push_back( mgr->getActiveProcessor( copyName.str() ) );
+    }
+  }
+}
+
+void EUTelProcessorEventPipeline::setUpWorkerProcessors() {
+  // from now on the parallel processors are called by the pipeline only
+  ProcessorMgr* mgr = ProcessorMgr::instance();
+  for( size_t iWorker = 0; iWorker < _workerProcessors.size(); ++iWorker ) {
+    for( size_t iProc = 0; iProc < _workerProcessors[iWorker].size(); ++iProc ) {
+      mgr->removeActiveProcessor( _workerProcessors[iWorker][iProc]->name() );
+    }
+  }
+  _workerRuns.assign( _nThreads, -1 );
+  _workerFirstEvent.assign( _nThreads, std::vector<char>( _parallelProcessorNames.size(), 1 ) );
+  _workerPool = std::make_unique<EUTelWorkerPool>( _nThreads );
+}
+
+void EUTelProcessorEventPipeline::prepareGeometry() {
+  geo::EUTelGeometryTelescopeGeoDescription& geometry = geo::gGeometry();
+  // also fills the memoized values, alignment updates since init() may have cleared them
+  geometry.setMaxThreads( _nThreads );
+}
+
+void EUTelProcessorEventPipeline::readDataSource(int numEvents) {
+  setUpWorkerProcessors();
+  prepareGeometry();
+
+  _endOfInput = false;
+  _stop = false;
+  _error = std::exception_ptr();
+
+  std::thread reader( &EUTelProcessorEventPipeline::readInput, this, numEvents );
+
+  size_t const batchSize = 4 * _nThreads;
+  long long nProcessed = 0;
+  std::vector<IMPL::LCEventImpl*> batch;
+  std::vector<char> process;
+  while( true ) {
+    {
+      std::unique_lock<std::mutex> lock( _pipelineMutex );
+      _pipelineCondition.wait( lock, [&]{ return _eventQueue.size() >= batchSize || _endOfInput || _stop; } );
+      if( _stop ) break;
+      size_t const n = std::min( batchSize, _eventQueue.size() );
+      batch.assign( _eventQueue.begin(), _eventQueue.begin() + n );
+      _eventQueue.erase( _eventQueue.begin(), _eventQueue.begin() + n );
+      _pipelineCondition.notify_all();
+    }
+    if( batch.empty() ) break;
+
+    try {
+      process.assign( batch.size(), 1 );
+      {
+        // no thread may write to streamlog while the workers run
+        streamlog::logscope scope( streamlog::out );
+        scope.setLevel<streamlog::SILENT>();
+        _workerPool->run( batch.size(), [&]( size_t iEvent, int iWorker ) {
+          process[iEvent] = processParallel( iWorker, batch[iEvent] );
+        } );
+      }
+      for( size_t iEvent = 0; iEvent < batch.size(); ++iEvent ) {
+        if( process[iEvent] ) commitEvent( batch[iEvent] );
+        delete batch[iEvent];
+        batch[iEvent] = 0;
+        ++nProcessed;
+      }
+    } catch(...) {
+      for( size_t iEvent = 0; iEvent < batch.size(); ++iEvent ) delete batch[iEvent];
+      std::lock_guard<std::mutex> lock( _pipelineMutex );
+      stop( std::current_exception() );
+      break;
+    }
+  }
+  reader.join();
+
+  // left over if the processing stopped early
+  for( size_t iQueued = 0; iQueued < _eventQueue.size(); ++iQueued ) delete _eventQueue[iQueued];
+  _eventQueue.clear();
+
+  streamlog_out( MESSAGE4 ) << nProcessed << " events processed" << std::endl;
+
+  mergeWorkerHistograms();
+
+  if( _error ) std::rethrow_exception( _error );
+}
+
+void EUTelProcessorEventPipeline::readInput(int numEvents) {
+  // decodes the next events while the earlier ones are processed, a
+  // few events per worker ahead
+  size_t const maxQueuedEvents = 8 * _nThreads;
+  long long const maxEvents = numEvents > 0 ? numEvents : -1;
+  try {
+    std::unique_ptr<IO::LCReader> reader( IOIMPL::LCFactory::getInstance()->createLCReader() );
+    reader->open( _inputFiles );
+    for( long long iEvent = 0; maxEvents < 0 || iEvent < maxEvents; ++iEvent ) {
+      EVENT::LCEvent* event = reader->readNextEvent();
+      if( !event ) break;
+      std::unique_ptr<IMPL::LCEventImpl> detached( detachEvent( event ) );
+
+      std::unique_lock<std::mutex> lock( _pipelineMutex );
+      _pipelineCondition.wait( lock, [&]{ return _eventQueue.size() < maxQueuedEvents || _stop; } );
+      if( _stop ) break;
+      _eventQueue.push_back( detached.release() );
+      _pipelineCondition.notify_all();
+    }
+    reader->close();
+  } catch(...) {
+    std::lock_guard<std::mutex> lock( _pipelineMutex );
+    stop( std::current_exception() );
+  }
+
+  std::lock_guard<std::mutex> lock( _pipelineMutex );
+  _endOfInput = true;
+  _pipelineCondition.notify_all();
+}
+
+void EUTelProcessorEventPipeline::stop(std::exception_ptr error) {
+  if( !_error ) _error = error;
+  _stop = true;
+  _pipelineCondition.notify_all();
+}
+
+bool EUTelProcessorEventPipeline::processParallel(int iWorker, IMPL::LCEventImpl * event) {
+  std::vector<Processor*>& processors = _workerProcessors[iWorker];
+  std::vector<char>& firstEvent = _workerFirstEvent[iWorker];
+
+  if( event->getRunNumber() != _workerRuns[iWorker] ) {
+    _workerRuns[iWorker] = event->getRunNumber();
+    std::map<int, std::unique_ptr<IMPL::LCRunHeaderImpl> >::iterator header = _runHeaders.find( _workerRuns[iWorker] );
+    if( header != _runHeaders.end() ) {
+      for( size_t iProc = 0; iProc < processors.size(); ++iProc ) processors[iProc]->processRunHeader( header->second.get() );
+    }
+  }
+
+  try {
+    for( size_t iProc = 0; iProc < processors.size(); ++iProc ) {
+      if( firstEvent[iProc] ) {
+        // most processors book their histograms on their first event
+        std::lock_guard<std::recursive_mutex> lock( histogramBookingMutex() );
+        processors[iProc]->processEvent( event );
+        firstEvent[iProc] = 0;
+      } else {
+        processors[iProc]->processEvent( event );
+      }
+    }
+  } catch( SkipEventException& ) {
+    // the remaining processors do not see this event
+    return false;
+  }
+  return true;
+}
+
+void EUTelProcessorEventPipeline::commitEvent(EVENT::LCEvent * event) {
+  if( event->getRunNumber() != _committedRun ) {
+    _committedRun = event->getRunNumber();
+    std::map<int, std::unique_ptr<IMPL::LCRunHeaderImpl> >::iterator header = _runHeaders.find( _committedRun );
+    if( header != _runHeaders.end() ) ProcessorMgr::instance()->processRunHeader( header->second.get() );
+  }
+  ProcessorMgr::instance()->processEvent( event );
+}
+
+void EUTelProcessorEventPipeline::mergeWorkerHistograms() {
+  // the copies see only their share of the events, their end() must
+  // not write job wide results (see the class description)
+  for( size_t iWorker = 1; iWorker < _workerProcessors.size(); ++iWorker ) {
+    for( size_t iProc = 0; iProc < _workerProcessors[iWorker].size(); ++iProc ) _workerProcessors[iWorker][iProc]->end();
+  }
+
+#if defined(USE_AIDA) || defined(MARLIN_USE_AIDA)
+  for( size_t iWorker = 1; iWorker < _workerProcessors.size(); ++iWorker ) {
+    for( size_t iProc = 0; iProc < _workerProcessors[iWorker].size(); ++iProc ) {
+      mergeProcessorHistograms( _workerProcessors[0][iProc], _workerProcessors[iWorker][iProc] );
+    }
+  }
+#endif
+
+  for( size_t iWorker = 1; iWorker < _workerProcessors.size(); ++iWorker ) {
+    for( size_t iProc = 0; iProc < _workerProcessors[iWorker].size(); ++iProc ) delete _workerProcessors[iWorker][iProc];
+  }
+  if( !_workerProcessors.empty() ) _workerProcessors.resize( 1 );
+}
+
+void EUTelProcessorEventPipeline::end() {
+  if( !_workerProcessors.empty() ) {
+    for( size_t iProc = 0; iProc < _workerProcessors[0].size(); ++iProc ) {
+      _workerProcessors[0][iProc]->end();
+      delete _workerProcessors[0][iProc];
+    }
+    _workerProcessors.clear();
+  }
+  streamlog_out( MESSAGE4 ) << "Successfully finished" << std::endl;
+}
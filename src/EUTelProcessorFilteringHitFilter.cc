@@ -97,7 +97,7 @@ void EUTelProcessorFilteringHitFilter::processEvent( LCEvent * event ) {
 
      if ( isFirstEvent() )
     {
-      _hotPixelMap = Utility::FillHotPixelMap(event, _hotpixelCollectionName );
+      _hotPixelMask = Utility::FillHotPixelMask(event, _hotpixelCollectionName );
     }
 
 //cout << " processEvent continue: " << endl;
@@ -138,7 +138,7 @@ void EUTelProcessorFilteringHitFilter::processEvent( LCEvent * event ) {
           {
             TrackerHitImpl * hit = static_cast<TrackerHitImpl*> ( hitInputCollection->getElementAt(iHit) );
              
-            if( Utility::HitContainsHotPixels(  hit,  _hotPixelMap )  ) 
+            if( Utility::HitContainsHotPixels(  hit,  _hotPixelMask )  ) 
             {
               streamlog_out ( MESSAGE5 ) << "Hit " << iHit << " contains hot pixels; skip this one. " << std::endl;
               continue;
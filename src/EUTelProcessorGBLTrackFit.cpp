@@ -54,7 +54,12 @@ _beamQ(-1),
 _eBeam(4),
 _trackCandidatesInputCollectionName("Default_input"),
 _tracksOutputCollectionName("Default_output"),
-_mEstimatorType() //This is used by the GBL software for outliers down weighting
+_mEstimatorType(), //This is used by the GBL software for outliers down weighting
+_nThreads(1),
+_trackFitters(),
+_pointLists(),
+_fitResults(),
+_workerPool()
 {
 	// Processor description
 	_description = "EUTelProcessorGBLTrackFit this will fit gbl tracks and output them into LCIO file.";
@@ -73,6 +78,8 @@ _mEstimatorType() //This is used by the GBL software for outliers down weighting
 	//This is the estimated resolution of the planes and DUT in x/y direction
   registerOptionalParameter("xResolutionPlane", "x resolution of planes given in Planes", _SteeringxResolutions, FloatVec());
   registerOptionalParameter("yResolutionPlane", "y resolution of planes given in Planes", _SteeringyResolutions, FloatVec());
+	//The tracks of an event are fitted in parallel. The results do not depend on the number of threads.
+  registerOptionalParameter("NumberOfThreads", "Number of threads fitting the tracks of an event, 0 for one per core", _nThreads, static_cast<int>(1));
 }
 
 void EUTelProcessorGBLTrackFit::init() {
@@ -85,18 +92,27 @@ void EUTelProcessorGBLTrackFit::init() {
         
         geo::gGeometry().initializeTGeoDescription(EUTELESCOPE::GEOFILENAME, EUTELESCOPE::DUMPGEOROOT);
 		
+		if(_nThreads <= 0){
+			_nThreads = std::max(1u, std::thread::hardware_concurrency());
+		}
 		// Initialize GBL fitter. This is the class that does all the work. Seems to me a good practice for the most part create a class that does the work. Since then you can use the same functions in another processor.
-		EUTelGBLFitter* Fitter = new EUTelGBLFitter();
-		Fitter->setBeamCharge(_beamQ);
-		Fitter->setBeamEnergy(_eBeam);
-		Fitter->setMEstimatorType(_mEstimatorType);//As said before this is to do with how we deal with outliers and the function we use to weight them.
-		Fitter->setParamterIdXResolutionVec(_SteeringxResolutions);
-		Fitter->setParamterIdYResolutionVec(_SteeringyResolutions);
-		Fitter->testUserInput();
-		_trackFitter = Fitter;
-		if (!_trackFitter) {
-			throw(lcio::Exception("Could not create instance of fitter class."));
+		// The fitter keeps the state of the track it fits, so every thread gets its own.
+		_trackFitters.clear();
+		for(int thread = 0; thread < _nThreads; ++thread){
+			std::unique_ptr<EUTelGBLFitter> Fitter = std::make_unique<EUTelGBLFitter>();
+			Fitter->setBeamCharge(_beamQ);
+			Fitter->setBeamEnergy(_eBeam);
+			Fitter->setMEstimatorType(_mEstimatorType);//As said before this is to do with how we deal with outliers and the function we use to weight them.
+			Fitter->setParamterIdXResolutionVec(_SteeringxResolutions);
+			Fitter->setParamterIdYResolutionVec(_SteeringyResolutions);
+			Fitter->testUserInput();
+			_trackFitters.push_back(std::move(Fitter));
 		}
+		_pointLists.assign(_nThreads, std::vector< gbl::GblPoint >());
+		//The threads only read the geometry. This gives every thread its own TGeo navigator and fills the per sensor caches before the threads start.
+		geo::gGeometry().setMaxThreads(_nThreads);
+		_workerPool = std::make_unique<EUTelWorkerPool>(_nThreads);
+		streamlog_out(MESSAGE4) << "Fitting tracks on " << _nThreads << " threads" << std::endl;
 		//Create millepede output
 //		_Mille  = new EUTelMillepede(); 
 
@@ -148,57 +164,47 @@ void EUTelProcessorGBLTrackFit::processEvent(LCEvent* evt){
 		}
         EUTelReaderGenericLCIO reader = EUTelReaderGenericLCIO();
         std::vector<EUTelTrack> tracks = reader.getTracks(evt, _trackCandidatesInputCollectionName );
+        streamlog_out(DEBUG1)<<"Found "<<tracks.size()<<" tracks for event " << evt->getEventNumber() <<std::endl;
+		const gear::BField& B = geo::gGeometry().getMagneticField();//We need this to determine if we should fit a curve or a straight line.
+		const bool curved = ( B.at( TVector3(0.,0.,0.) ).r2() >= 1.E-6 );
+		//All tracks of the event are fitted first, in parallel if there are several threads. The fits are independent of each other.
+		if(_fitResults.size() < tracks.size()){
+			_fitResults.resize(tracks.size());
+		}
+		{
+			//streamlog is not thread safe, so the fitter is silent while several threads run it. The messages about the tracks are written below.
+			std::unique_ptr<streamlog::logscope> scope;
+			if(_workerPool->getNThreads() > 1){
+				scope = std::make_unique<streamlog::logscope>(streamlog::out);
+				scope->setLevel<streamlog::SILENT>();
+			}
+			_workerPool->run(tracks.size(), [&](size_t iTrack, int thread){ fitTrack(tracks[iTrack], curved, thread, _fitResults[iTrack]); });
+		}
+		//Histograms and output are filled in the order of the tracks, exactly as if they had been fitted one after the other.
 		std::vector<EUTelTrack> allTracksForThisEvent;//GBL will analysis the track one at a time. However we want to save to lcio per event.
 		for (size_t iTrack = 0; iTrack < tracks.size(); iTrack++) {
-			EUTelTrack track = tracks.at(iTrack); 
-            streamlog_out(DEBUG1)<<"Found "<<tracks.size()<<" tracks for event " << evt->getEventNumber() << "  This is track:  " << iTrack <<std::endl;
-            track.print();
+			FitResult& result = _fitResults[iTrack];
+			tracks[iTrack].print();
 			streamlog_out(DEBUG1) << "//////////////////////////////////// " << std::endl;
-			_trackFitter->resetPerTrack(); //Here we reset the label that connects state to GBL point to 1 again. Also we set the list of states->labels to 0
-			_trackFitter->testTrack(track);//Check the track has states and hits  
-			std::vector< gbl::GblPoint > pointList;
-			_trackFitter->setInformationForGBLPointList(track, pointList);//Here we describe the whole setup. Geometry, scattering, data...
-			const gear::BField& B = geo::gGeometry().getMagneticField();//We need this to determine if we should fit a curve or a straight line.
-			const double Bmag = B.at( TVector3(0.,0.,0.) ).r2();
-			_trackFitter->setPairMeasurementStateAndPointLabelVec(pointList);//This will create a link between the states that have a hit associated with them and the GBL label that is associated with the state.
-			gbl::GblTrajectory* traj = 0;
-			//Here we create the trajectory from the points created by setInformationForGBLPointList. This will take the points and propagation jacobian and split this into smaller matrices to describe the problem in terms of offsets. Here is the difference between GBL and other fitting algorithms.  
-			if ( Bmag < 1.E-6 ) {
-				traj = new gbl::GblTrajectory( pointList, false ); 
-			}else {
-				traj = new gbl::GblTrajectory( pointList, true );
-			}
-			_trackFitter->setPairAnyStateAndPointLabelVec(traj);//This will create a link between any state and it's GBL point label. 
-			double  chi2=0; 
-			int ndf=0;
-			int ierr=0;
-			_trackFitter->computeTrajectoryAndFit(traj, &chi2,&ndf, ierr);//This will do the minimisation of the chi2 and produce the most probable trajectory.
-			if(ierr == 0 ){
-				streamlog_out(DEBUG5) << "Ierr is: " << ierr << " Entering loop to update track information " << std::endl;
-				//If the fit succeeded then write into the binary file.
-//				traj->milleOut(*(_Mille->_milleGBL));
-				static_cast < AIDA::IHistogram1D* > ( _aidaHistoMap1D[ _histName::_chi2CandidateHistName ] ) -> fill( (chi2)/(ndf));
+			if(result.ierr == 0 ){
+				streamlog_out(DEBUG5) << "Ierr is: " << result.ierr << " Entering loop to update track information " << std::endl;
+				static_cast < AIDA::IHistogram1D* > ( _aidaHistoMap1D[ _histName::_chi2CandidateHistName ] ) -> fill( (result.chi2)/(result.ndf));
 				static_cast < AIDA::IHistogram1D* > ( _aidaHistoMap1D[ _histName::_fitsuccessHistName ] ) -> fill(1.0);
-				if(chi2 ==0 or ndf ==0){
+				if(result.chi2 ==0 or result.ndf ==0){
 					throw(lcio::Exception("Your fitted track has zero degrees of freedom or a chi2 of 0.")); 	
 					}
-				track.setChi2(chi2);
-				track.setNdf(ndf);
-				_chi2NdfVec.push_back(chi2/static_cast<float>(ndf));
-				std::map<int, std::vector<double> >  mapSensorIDToCorrectionVec;//This is not used now. However it maybe useful to be able to access the corrections that GBL makes to the original track. Since if this is too large then GBL may give th wrong trajectory. Since all the equations are only to first order. 
-				_trackFitter->updateTrackFromGBLTrajectory(traj,track,mapSensorIDToCorrectionVec);
-				std::map< int, std::map< float, float > >  SensorResidual; 
-				std::map< int, std::map< float, float > >  SensorResidualError; 
-				_trackFitter->getResidualOfTrackandHits(traj, pointList,track, SensorResidual, SensorResidualError);
-				if(chi2/static_cast<float>(ndf) < 5){
-				  plotResidual(SensorResidual,SensorResidualError);
+				result.track.setChi2(result.chi2);
+				result.track.setNdf(result.ndf);
+				_chi2NdfVec.push_back(result.chi2/static_cast<float>(result.ndf));
+				if(result.chi2/static_cast<float>(result.ndf) < 5){
+				  plotResidual(result.residuals);
 				}
 			}else{
-				streamlog_out(DEBUG5) << "Ierr is: " << ierr << " Do not update track information " << std::endl;
+				streamlog_out(DEBUG5) << "Ierr is: " << result.ierr << " Do not update track information " << std::endl;
 				static_cast < AIDA::IHistogram1D* > ( _aidaHistoMap1D[ _histName::_fitsuccessHistName ] ) -> fill(0.0);
 				continue;//We continue so we don't add an empty track
 			}	
-			allTracksForThisEvent.push_back(track);
+			allTracksForThisEvent.push_back(result.track);
 			}//END OF LOOP FOR ALL TRACKS IN AN EVENT
 			outputLCIO(evt, allTracksForThisEvent); 
 			allTracksForThisEvent.clear();//We clear this so we don't add the same track twice
@@ -225,11 +231,34 @@ void EUTelProcessorGBLTrackFit::processEvent(LCEvent* evt){
 }
 
 
+//This is called by the threads, it must only touch the fitter and point list of the given thread and the result. The messages about the track are written by processEvent.
+void EUTelProcessorGBLTrackFit::fitTrack(EUTelTrack const& track, bool curved, int thread, FitResult& result){
+	EUTelGBLFitter& fitter = *_trackFitters[thread];
+	std::vector< gbl::GblPoint >& pointList = _pointLists[thread];
+	pointList.clear();
+	result.track = track;
+	result.ierr = 0;
+	result.chi2 = 0;
+	result.ndf = 0;
+	result.residuals.clear();
+	fitter.resetPerTrack(); //Here we reset the label that connects state to GBL point to 1 again. Also we set the list of states->labels to 0
+	fitter.testTrack(result.track);//Check the track has states and hits  
+	fitter.setInformationForGBLPointList(result.track, pointList);//Here we describe the whole setup. Geometry, scattering, data...
+	fitter.setPairMeasurementStateAndPointLabelVec(pointList);//This will create a link between the states that have a hit associated with them and the GBL label that is associated with the state.
+	//Here we create the trajectory from the points created by setInformationForGBLPointList. This will take the points and propagation jacobian and split this into smaller matrices to describe the problem in terms of offsets. Here is the difference between GBL and other fitting algorithms.  
+	gbl::GblTrajectory traj( pointList, curved );
+	fitter.setPairAnyStateAndPointLabelVec(&traj);//This will create a link between any state and it's GBL point label. 
+	fitter.computeTrajectoryAndFit(&traj, &result.chi2, &result.ndf, result.ierr);//This will do the minimisation of the chi2 and produce the most probable trajectory.
+	if(result.ierr == 0){
+		std::map<int, std::vector<double> >  mapSensorIDToCorrectionVec;//This is not used now. However it maybe useful to be able to access the corrections that GBL makes to the original track. Since if this is too large then GBL may give th wrong trajectory. Since all the equations are only to first order. 
+		fitter.updateTrackFromGBLTrajectory(&traj, result.track, mapSensorIDToCorrectionVec);
+		fitter.getResidualOfTrackandHits(&traj, pointList, result.track, result.residuals);
+	}
+}
+
 //TO DO:This is a very stupid way to histogram but will add new class to do this is long run 
-void EUTelProcessorGBLTrackFit::plotResidual(std::map< int, std::map<float, float > >  & sensorResidual, std::map< int, std::map<float, float > >  & sensorResidualError){
-	//////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////Residual plot
+void EUTelProcessorGBLTrackFit::plotResidual(std::vector< EUTelGBLResidual > const& residuals){
 	/* Obtain DUT IDs */
-        std::map< int, int>::iterator planes_it;
 	int dut1 = -10;
 	int dut2 = -10;
 	bool flag = false;
@@ -243,71 +272,45 @@ void EUTelProcessorGBLTrackFit::plotResidual(std::map< int, std::map<float, floa
 	  }
 	  
 	}
-	/* Fill histograms */
-	std::map< int, std::map< float, float > >::iterator sensor_residual_it;
-	for(sensor_residual_it = sensorResidual.begin(); sensor_residual_it != sensorResidual.end(); sensor_residual_it++) {
-	  std::map<float, float> map = sensor_residual_it->second;
-	  if( !map.empty()){
-	    float res = map.begin()->first;
-	    if( sensor_residual_it->first == 0 ){static_cast < AIDA::IHistogram1D* > ( _aidaHistoMap1D[ _histName::_residGblFitHistNameX0 ] ) -> fill(res);}
-	    if( sensor_residual_it->first == 1 ){static_cast < AIDA::IHistogram1D* > ( _aidaHistoMap1D[ _histName::_residGblFitHistNameX1 ] ) -> fill(res);}
-	    if( sensor_residual_it->first == 2 ){static_cast < AIDA::IHistogram1D* > ( _aidaHistoMap1D[ _histName::_residGblFitHistNameX2 ] ) -> fill(res);}
-	    if( sensor_residual_it->first == 3 ){static_cast < AIDA::IHistogram1D* > ( _aidaHistoMap1D[ _histName::_residGblFitHistNameX3 ] ) -> fill(res);}
-	    if( sensor_residual_it->first == 4 ){static_cast < AIDA::IHistogram1D* > ( _aidaHistoMap1D[ _histName::_residGblFitHistNameX4 ] ) -> fill(res);}
-	    if( sensor_residual_it->first == 5 ){static_cast < AIDA::IHistogram1D* > ( _aidaHistoMap1D[ _histName::_residGblFitHistNameX5 ] ) -> fill(res);}
-	    if( sensor_residual_it->first == dut1 ){static_cast < AIDA::IHistogram1D* > ( _aidaHistoMap1D[ _histName::_residGblFitHistNameXDut1 ] ) -> fill(res);}
-	    if( sensor_residual_it->first == dut2 ){static_cast < AIDA::IHistogram1D* > ( _aidaHistoMap1D[ _histName::_residGblFitHistNameXDut2 ] ) -> fill(res);}
-	    
-		}else{
-			streamlog_out(DEBUG5) << "The map is NULL" <<std::endl;
-		}
-			float res2 = map.begin()->second;
-			if( sensor_residual_it->first == 0){static_cast < AIDA::IHistogram1D* > ( _aidaHistoMap1D[ _histName::_residGblFitHistNameY0 ] ) -> fill(res2);}
-			if( sensor_residual_it->first == 1){static_cast < AIDA::IHistogram1D* > ( _aidaHistoMap1D[ _histName::_residGblFitHistNameY1 ] ) -> fill(res2);}
-			if( sensor_residual_it->first == 2){static_cast < AIDA::IHistogram1D* > ( _aidaHistoMap1D[ _histName::_residGblFitHistNameY2 ] ) -> fill(res2);}
-			if( sensor_residual_it->first == 3){static_cast < AIDA::IHistogram1D* > ( _aidaHistoMap1D[ _histName::_residGblFitHistNameY3 ] ) -> fill(res2);}
-			if( sensor_residual_it->first == 4){static_cast < AIDA::IHistogram1D* > ( _aidaHistoMap1D[ _histName::_residGblFitHistNameY4 ] ) -> fill(res2);}
-			if( sensor_residual_it->first == 5){static_cast < AIDA::IHistogram1D* > ( _aidaHistoMap1D[ _histName::_residGblFitHistNameY5 ] ) -> fill(res2);}
-			if( sensor_residual_it->first == dut1){static_cast < AIDA::IHistogram1D* > ( _aidaHistoMap1D[ _histName::_residGblFitHistNameYDut1 ] ) -> fill(res2);}
-			if( sensor_residual_it->first == dut2){static_cast < AIDA::IHistogram1D* > ( _aidaHistoMap1D[ _histName::_residGblFitHistNameYDut2 ] ) -> fill(res2);}
-
-				
-	}
-	////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
-	//////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////Residual Error plot
-	std::map< int, std::map< float, float > >::iterator sensor_residualerror_it;
-	for(sensor_residualerror_it = sensorResidualError.begin(); sensor_residualerror_it != sensorResidualError.end(); sensor_residualerror_it++) {
-	  std::map<float, float> maperror = sensor_residualerror_it->second;
-	  std::map<float, float> mapres = sensorResidual.at(sensor_residualerror_it->first);
-
-	  if( !maperror.empty()){
-	    float res = mapres.begin()->first;	
-	    float reserror = maperror.begin()->first;
-	    if( sensor_residualerror_it->first == 0){static_cast < AIDA::IHistogram1D* > ( _aidaHistoMap1D[ _histName::_residGblFitHistNameX0p ] ) -> fill(res/reserror);}
-	    if( sensor_residualerror_it->first == 1){static_cast < AIDA::IHistogram1D* > ( _aidaHistoMap1D[ _histName::_residGblFitHistNameX1p ] ) -> fill(res/reserror);}
-	    if( sensor_residualerror_it->first == 2){static_cast < AIDA::IHistogram1D* > ( _aidaHistoMap1D[ _histName::_residGblFitHistNameX2p ] ) -> fill(res/reserror);}
-	    if( sensor_residualerror_it->first == 3){static_cast < AIDA::IHistogram1D* > ( _aidaHistoMap1D[ _histName::_residGblFitHistNameX3p ] ) -> fill(res/reserror);}
-	    if( sensor_residualerror_it->first == 4){static_cast < AIDA::IHistogram1D* > ( _aidaHistoMap1D[ _histName::_residGblFitHistNameX4p ] ) -> fill(res/reserror);}
-	    if( sensor_residualerror_it->first == 5){static_cast < AIDA::IHistogram1D* > ( _aidaHistoMap1D[ _histName::_residGblFitHistNameX5p ] ) -> fill(res/reserror);}
-	    if( sensor_residualerror_it->first == dut1){static_cast < AIDA::IHistogram1D* > ( _aidaHistoMap1D[ _histName::_residGblFitHistNameXDut1p ] ) -> fill(res/reserror);}
-	    if( sensor_residualerror_it->first == dut2){static_cast < AIDA::IHistogram1D* > ( _aidaHistoMap1D[ _histName::_residGblFitHistNameXDut2p ] ) -> fill(res/reserror);}
-	  }else{
-	    streamlog_out(DEBUG5) << "The map is NULL" <<std::endl;
-	  }
-	  float res2 = mapres.begin()->second;
-	  float res2error = maperror.begin()->second;
-	  if( sensor_residualerror_it->first == 0){static_cast < AIDA::IHistogram1D* > ( _aidaHistoMap1D[ _histName::_residGblFitHistNameY0p ] ) -> fill(res2/res2error);}
-	  if( sensor_residualerror_it->first == 1){static_cast < AIDA::IHistogram1D* > ( _aidaHistoMap1D[ _histName::_residGblFitHistNameY1p ] ) -> fill(res2/res2error);}
-	  if( sensor_residualerror_it->first == 2){static_cast < AIDA::IHistogram1D* > ( _aidaHistoMap1D[ _histName::_residGblFitHistNameY2p ] ) -> fill(res2/res2error);}
-	  if( sensor_residualerror_it->first == 3){static_cast < AIDA::IHistogram1D* > ( _aidaHistoMap1D[ _histName::_residGblFitHistNameY3p ] ) -> fill(res2/res2error);}
-	  if( sensor_residualerror_it->first == 4){static_cast < AIDA::IHistogram1D* > ( _aidaHistoMap1D[ _histName::_residGblFitHistNameY4p ] ) -> fill(res2/res2error);}
-	  if( sensor_residualerror_it->first == 5){static_cast < AIDA::IHistogram1D* > ( _aidaHistoMap1D[ _histName::_residGblFitHistNameY5p ] ) -> fill(res2/res2error);}
-	  if( sensor_residualerror_it->first == dut1){static_cast < AIDA::IHistogram1D* > ( _aidaHistoMap1D[ _histName::_residGblFitHistNameYDut1p ] ) -> fill(res2/res2error);}
-	  if( sensor_residualerror_it->first == dut2){static_cast < AIDA::IHistogram1D* > ( _aidaHistoMap1D[ _histName::_residGblFitHistNameYDut2p ] ) -> fill(res2/res2error);}
+	/* Fill histograms, residuals and pulls */
+	for(size_t i = 0; i < residuals.size(); ++i) {
+		EUTelGBLResidual const& residual = residuals[i];
+		if( residual.location == 0 ){static_cast < AIDA::IHistogram1D* > ( _aidaHistoMap1D[ _histName::_residGblFitHistNameX0 ] ) -> fill(residual.resX);}
+		if( residual.location == 1 ){static_cast < AIDA::IHistogram1D* > ( _aidaHistoMap1D[ _histName::_residGblFitHistNameX1 ] ) -> fill(residual.resX);}
+		if( residual.location == 2 ){static_cast < AIDA::IHistogram1D* > ( _aidaHistoMap1D[ _histName::_residGblFitHistNameX2 ] ) -> fill(residual.resX);}
+		if( residual.location == 3 ){static_cast < AIDA::IHistogram1D* > ( _aidaHistoMap1D[ _histName::_residGblFitHistNameX3 ] ) -> fill(residual.resX);}
+		if( residual.location == 4 ){static_cast < AIDA::IHistogram1D* > ( _aidaHistoMap1D[ _histName::_residGblFitHistNameX4 ] ) -> fill(residual.resX);}
+		if( residual.location == 5 ){static_cast < AIDA::IHistogram1D* > ( _aidaHistoMap1D[ _histName::_residGblFitHistNameX5 ] ) -> fill(residual.resX);}
+		if( residual.location == dut1 ){static_cast < AIDA::IHistogram1D* > ( _aidaHistoMap1D[ _histName::_residGblFitHistNameXDut1 ] ) -> fill(residual.resX);}
+		if( residual.location == dut2 ){static_cast < AIDA::IHistogram1D* > ( _aidaHistoMap1D[ _histName::_residGblFitHistNameXDut2 ] ) -> fill(residual.resX);}
+
+		if( residual.location == 0 ){static_cast < AIDA::IHistogram1D* > ( _aidaHistoMap1D[ _histName::_residGblFitHistNameY0 ] ) -> fill(residual.resY);}
+		if( residual.location == 1 ){static_cast < AIDA::IHistogram1D* > ( _aidaHistoMap1D[ _histName::_residGblFitHistNameY1 ] ) -> fill(residual.resY);}
+		if( residual.location == 2 ){static_cast < AIDA::IHistogram1D* > ( _aidaHistoMap1D[ _histName::_residGblFitHistNameY2 ] ) -> fill(residual.resY);}
+		if( residual.location == 3 ){static_cast < AIDA::IHistogram1D* > ( _aidaHistoMap1D[ _histName::_residGblFitHistNameY3 ] ) -> fill(residual.resY);}
+		if( residual.location == 4 ){static_cast < AIDA::IHistogram1D* > ( _aidaHistoMap1D[ _histName::_residGblFitHistNameY4 ] ) -> fill(residual.resY);}
+		if( residual.location == 5 ){static_cast < AIDA::IHistogram1D* > ( _aidaHistoMap1D[ _histName::_residGblFitHistNameY5 ] ) -> fill(residual.resY);}
+		if( residual.location == dut1 ){static_cast < AIDA::IHistogram1D* > ( _aidaHistoMap1D[ _histName::_residGblFitHistNameYDut1 ] ) -> fill(residual.resY);}
+		if( residual.location == dut2 ){static_cast < AIDA::IHistogram1D* > ( _aidaHistoMap1D[ _histName::_residGblFitHistNameYDut2 ] ) -> fill(residual.resY);}
+
+		if( residual.location == 0 ){static_cast < AIDA::IHistogram1D* > ( _aidaHistoMap1D[ _histName::_residGblFitHistNameX0p ] ) -> fill(residual.resX/residual.errX);}
+		if( residual.location == 1 ){static_cast < AIDA::IHistogram1D* > ( _aidaHistoMap1D[ _histName::_residGblFitHistNameX1p ] ) -> fill(residual.resX/residual.errX);}
+		if( residual.location == 2 ){static_cast < AIDA::IHistogram1D* > ( _aidaHistoMap1D[ _histName::_residGblFitHistNameX2p ] ) -> fill(residual.resX/residual.errX);}
+		if( residual.location == 3 ){static_cast < AIDA::IHistogram1D* > ( _aidaHistoMap1D[ _histName::_residGblFitHistNameX3p ] ) -> fill(residual.resX/residual.errX);}
+		if( residual.location == 4 ){static_cast < AIDA::IHistogram1D* > ( _aidaHistoMap1D[ _histName::_residGblFitHistNameX4p ] ) -> fill(residual.resX/residual.errX);}
+		if( residual.location == 5 ){static_cast < AIDA::IHistogram1D* > ( _aidaHistoMap1D[ _histName::_residGblFitHistNameX5p ] ) -> fill(residual.resX/residual.errX);}
+		if( residual.location == dut1 ){static_cast < AIDA::IHistogram1D* > ( _aidaHistoMap1D[ _histName::_residGblFitHistNameXDut1p ] ) -> fill(residual.resX/residual.errX);}
+		if( residual.location == dut2 ){static_cast < AIDA::IHistogram1D* > ( _aidaHistoMap1D[ _histName::_residGblFitHistNameXDut2p ] ) -> fill(residual.resX/residual.errX);}
+
+		if( residual.location == 0 ){static_cast < AIDA::IHistogram1D* > ( _aidaHistoMap1D[ _histName::_residGblFitHistNameY0p ] ) -> fill(residual.resY/residual.errY);}
+		if( residual.location == 1 ){static_cast < AIDA::IHistogram1D* > ( _aidaHistoMap1D[ _histName::_residGblFitHistNameY1p ] ) -> fill(residual.resY/residual.errY);}
+		if( residual.location == 2 ){static_cast < AIDA::IHistogram1D* > ( _aidaHistoMap1D[ _histName::_residGblFitHistNameY2p ] ) -> fill(residual.resY/residual.errY);}
+		if( residual.location == 3 ){static_cast < AIDA::IHistogram1D* > ( _aidaHistoMap1D[ _histName::_residGblFitHistNameY3p ] ) -> fill(residual.resY/residual.errY);}
+		if( residual.location == 4 ){static_cast < AIDA::IHistogram1D* > ( _aidaHistoMap1D[ _histName::_residGblFitHistNameY4p ] ) -> fill(residual.resY/residual.errY);}
+		if( residual.location == 5 ){static_cast < AIDA::IHistogram1D* > ( _aidaHistoMap1D[ _histName::_residGblFitHistNameY5p ] ) -> fill(residual.resY/residual.errY);}
+		if( residual.location == dut1 ){static_cast < AIDA::IHistogram1D* > ( _aidaHistoMap1D[ _histName::_residGblFitHistNameYDut1p ] ) -> fill(residual.resY/residual.errY);}
+		if( residual.location == dut2 ){static_cast < AIDA::IHistogram1D* > ( _aidaHistoMap1D[ _histName::_residGblFitHistNameYDut2p ] ) -> fill(residual.resY/residual.errY);}
 	}
-	
-	////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
-
 }
 
 
@@ -319,7 +322,11 @@ void EUTelProcessorGBLTrackFit::end() {
 		total= total + _chi2NdfVec.at(i);//TO DO: This is does not seem to output the correct average chi2. Plus do we really need this to fit?
 	}
 	//TO DO: We really should have a better way to look track per track	and see if the correction is too large. 
-	std::vector<double> correctionTotal = _trackFitter->getCorrectionsTotal();
+	std::vector<double> correctionTotal = _trackFitters.front()->getCorrectionsTotal();
+	for(size_t thread = 1; thread < _trackFitters.size(); ++thread){
+		std::vector<double> threadCorrectionTotal = _trackFitters[thread]->getCorrectionsTotal();
+		for(size_t i = 0; i < correctionTotal.size(); ++i) correctionTotal[i] += threadCorrectionTotal[i];
+	}
 	streamlog_out(MESSAGE9)<<"This is the average correction for omega: " <<correctionTotal.at(0)/sizeFittedTracks<<std::endl;	
 	streamlog_out(MESSAGE9)<<"This is the average correction for local xz inclination: " <<correctionTotal.at(1)/sizeFittedTracks<<std::endl;	
 	streamlog_out(MESSAGE9)<<"This is the average correction for local yz inclination: " <<correctionTotal.at(2)/sizeFittedTracks<<std::endl;	
@@ -328,6 +335,7 @@ void EUTelProcessorGBLTrackFit::end() {
 
   float average = total/sizeFittedTracks;
 	streamlog_out(MESSAGE9) << "This is the average chi2 -"<< average <<std::endl;
+	_workerPool.reset();
 
 }
 
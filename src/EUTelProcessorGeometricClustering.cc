@@ -24,6 +24,7 @@
 #include "EUTelTrackerDataInterfacerImpl.h"
 #include "EUTelGenericSparseClusterImpl.h"
 #include "EUTelGeometricClusterImpl.h"
+#include "EUTelGeometricPixelIndex.h"
 
 //eutel geometry
 #include "EUTelGeometryTelescopeGeoDescription.h"
@@ -59,6 +60,7 @@
 #include <memory>
 //#include <iostream>
 #include <cmath>
+#include <algorithm>
 
 using namespace lcio;
 using namespace marlin;
@@ -86,7 +88,9 @@ EUTelProcessorGeometricClustering::EUTelProcessorGeometricClustering():
   _isGeometryReady(false),
   _sensorIDVec(),
   _zsInputDataCollectionVec(NULL),
-  _pulseCollectionVec(NULL)
+  _pulseCollectionVec(NULL),
+  _pixelGeometryCache(),
+  _pixelIndex()
  {
   
   // modify processor description
@@ -128,6 +132,9 @@ void EUTelProcessorGeometricClustering::init() {
 
 	//the geometry is not yet initialized, so set the corresponding switch to false
 	_isGeometryReady = false;
+
+	//pixel positions are cached per geometry
+	_pixelGeometryCache.clear();
 }
 
 void EUTelProcessorGeometricClustering::processRunHeader(LCRunHeader* rdr) {
@@ -235,6 +242,191 @@ void EUTelProcessorGeometricClustering::processEvent(LCEvent* event) {
 	_isFirstEvent = false;
 }
 
+void EUTelProcessorGeometricClustering::setPixelGeometry(int sensorID, std::string const& planePath, geo::EUTelGenericPixGeoDescr* geoDescr,
+                                                         float sizeX, float sizeY, int minX, int maxX, int minY, int maxY,
+                                                         EUTelGeometricPixel& hitPixel)
+{
+	int const indexX = hitPixel.getXCoord() - minX;
+	int const indexY = hitPixel.getYCoord() - minY;
+	int const nX = maxX - minX + 1;
+	int const nY = maxY - minY + 1;
+
+	//pixels outside of the index range are not cached
+	if( indexX < 0 || indexX >= nX || indexY < 0 || indexY >= nY )
+	{
+		computePixelGeometry( sensorID, planePath, geoDescr, sizeX, sizeY, hitPixel );
+		return;
+	}
+
+	std::vector<CachedPixelGeometry>& sensorCache = _pixelGeometryCache[sensorID];
+	if( sensorCache.empty() )
+	{
+		sensorCache.resize( static_cast<size_t>(nX)*nY );
+	}
+
+	CachedPixelGeometry& cached = sensorCache[ static_cast<size_t>(indexY)*nX + indexX ];
+	if( !cached.valid )
+	{
+		computePixelGeometry( sensorID, planePath, geoDescr, sizeX, sizeY, hitPixel );
+		cached.posX = hitPixel.getPosX();
+		cached.posY = hitPixel.getPosY();
+		cached.boundaryX = hitPixel.getBoundaryX();
+		cached.boundaryY = hitPixel.getBoundaryY();
+		cached.valid = true;
+		return;
+	}
+
+	hitPixel.setPosX( cached.posX );
+	hitPixel.setPosY( cached.posY );
+	hitPixel.setBoundaryX( cached.boundaryX );
+	hitPixel.setBoundaryY( cached.boundaryY );
+}
+
+void EUTelProcessorGeometricClustering::computePixelGeometry(int sensorID, std::string const& planePath, geo::EUTelGenericPixGeoDescr* geoDescr,
+                                                             float sizeX, float sizeY, EUTelGeometricPixel& hitPixel)
+{
+	//And get the path to the given pixel
+	std::string pixelPath = geoDescr->getPixName(hitPixel.getXCoord(), hitPixel.getYCoord());
+
+	//Then navigate to this pixel with the TGeo manager
+	geo::gGeometry()._geoManager->cd( (planePath+pixelPath).c_str() );
+	//std::cout<<planePath+pixelPath<<std::endl;
+	//planePath=/volume_World_1/volume_SensorID:0_1
+
+	//get the imbedding box
+	TGeoShape* currentShape =  geo::gGeometry()._geoManager->GetCurrentVolume()->GetShape();
+	//std::cout<<"This is the currentShape "<<*currentShape <<std::endl;
+	TGeoBBox* bbox = dynamic_cast<TGeoBBox*>( currentShape );
+	//store the dimensions of this box in the GeometricPixel
+
+	hitPixel.setBoundaryX( bbox->GetDX() );
+	hitPixel.setBoundaryY( bbox->GetDY() );
+
+	//Get how deep the node description goes (this is how often we have to transform to get coordinates in the local plane coordinate system)
+	std::vector<std::string> split = Utility::stringSplit( planePath+pixelPath , "/", false);
+	std::cout<<"split: "<< planePath+pixelPath<<std::endl;
+
+	std::string Row_in,Col_in;
+	Double_t X_mid,Y_mid;
+	int int_Row_in,int_Col_in;
+
+	if(sensorID==0){//This is for the R0 sensor as I placed the R0 sensor as the first plane in the EUTEL telescope in AllPix
+	  Double_t RCentreOfPixel,thetaPitch,NumStrips,stereo,phi_i,b,c,r,R;
+	  Col_in=split[3].substr(14);
+	  Row_in=split[3][12];
+	  int_Row_in=atoi(Row_in.c_str())-1;
+	  int_Col_in=atoi(Col_in.c_str())-1;
+	  if(int_Row_in==0){
+		RCentreOfPixel=393.9905;
+		thetaPitch=0.0001932745;
+		NumStrips=1026;
+	  }
+	  if(int_Row_in==1){
+		RCentreOfPixel=415.4715;
+		thetaPitch=0.0001932745;
+		NumStrips=1026;
+	  }
+	  if(int_Row_in==2){
+		RCentreOfPixel=441.952;
+		thetaPitch=0.0001718368;
+		NumStrips=1154;
+	  }
+	  if(int_Row_in==3){
+		RCentreOfPixel=472.4325;
+		thetaPitch=0.0001718368;
+		NumStrips=1154;
+	  }
+	  stereo=0.02,R=438.614;
+	  phi_i=(int_Col_in-NumStrips/2+0.5)*thetaPitch;
+	  b=-2*(2*R*sin(stereo/2))*sin(stereo/2+phi_i);
+	  c=pow((2*R*sin(stereo/2)),2)-pow(RCentreOfPixel,2);
+	  r=0.5*(-b+sqrt(pow(b,2)-4*c));
+	  Y_mid=r*cos(phi_i+stereo) - R*cos(stereo);
+	  X_mid=-r*sin(phi_i+stereo) + R*sin(stereo);
+	}
+
+	else{
+	  Row_in=split[4].substr(10);
+	  Col_in=split[3].substr(8);
+	  int_Row_in=atoi(Row_in.c_str())-1;
+	  int_Col_in=atoi(Col_in.c_str())-1;
+	  X_mid=hitPixel.getBoundaryX()*2*int_Col_in-sizeX/2+hitPixel.getBoundaryX();
+	  Y_mid= hitPixel.getBoundaryY()*2*int_Row_in-sizeY/2+hitPixel.getBoundaryY();
+	}
+	if(sensorID==0 || sensorID==1 || sensorID==2){
+	  std::cout<<sensorID << ": getPixName input: ("<< hitPixel.getXCoord()<< "," << hitPixel.getYCoord()<<")"
+		       <<" row "<<int_Row_in <<" col "<<int_Col_in
+		       <<std::endl;}
+
+	//Three recursions for the telescope/plane
+	int recursionDepth = split.size() - 3;
+	//if(sensorID==0 || sensorID==1){
+	//  std::cout<<sensorID<<": recursionDepth: "<<planePath+pixelPath<<"   "<< recursionDepth <<std::endl;}
+	//The do the transformation
+	Double_t origin_pt[3] = {0,0,0};
+	Double_t transformed1_pt[3];
+	Double_t transformed2_pt[3];
+	gGeoManager->GetCurrentNode()->LocalToMaster(origin_pt, transformed1_pt);
+
+	//if (pixelPath[10]=='m' and sensorID==0){std::cout<<sensorID<<": "
+		//<<"delta: "<< bbox->GetDX() <<", "<<bbox->GetDY()
+	//						     <<"  pos1: "<<transformed1_pt[0] << ", "<<transformed1_pt[1] <<std::endl;}
+
+	transformed2_pt[0] = transformed1_pt[0];
+	transformed2_pt[1] = transformed1_pt[1];
+	transformed2_pt[2] = transformed1_pt[2];
+
+	//transform into local plane coordinate system
+	for(int i = 1 ; i < recursionDepth; ++i)
+	  {
+		gGeoManager->GetMother(i)->LocalToMaster(transformed1_pt, transformed2_pt);
+		transformed1_pt[0] = transformed2_pt[0];
+		transformed1_pt[1] = transformed2_pt[1];
+		transformed1_pt[2] = transformed2_pt[2];
+	  }
+	if (sensorID==0 || sensorID==1 || sensorID==2){
+	  std::cout<<sensorID<<": delta: "<< bbox->GetDX() <<", "<<bbox->GetDY()
+		       <<" pos2: "<<transformed2_pt[0] << ", "<<transformed2_pt[1]
+		       <<std::endl;
+	  std::cout<<sensorID<<": X_calc: "<< X_mid <<" Y_calc: "<< Y_mid
+		       <<std::endl;
+	}
+
+	//This was changed to take in the positions based on the pixGeo mapping
+	//store all the position information in the GeometricPixel
+	hitPixel.setPosX( X_mid);//transformed2_pt[0]
+	hitPixel.setPosY( Y_mid);//transformed2_pt[1]
+}
+
+bool EUTelProcessorGeometricClustering::pixelsTouch(EUTelGeometricPixel const& newlyAdded, EUTelGeometricPixel const& hitPixel) const
+{
+	float x1, x2, y1, y2, dX, dY, cx1, cy1, cx2, cy2, cutX, cutY, t1 , t2, dT;
+
+	//get the relevant infos from the newly added pixel
+	x1 = newlyAdded.getPosX();
+	y1 = newlyAdded.getPosY();
+	t1 =  newlyAdded.getTime();
+	cx1 = newlyAdded.getBoundaryX();
+	cy1 = newlyAdded.getBoundaryY();
+
+	//and the pixel we test against
+	x2 = hitPixel.getPosX();
+	y2 = hitPixel.getPosY();
+	t2 = hitPixel.getTime();
+	cx2 = hitPixel.getBoundaryX();
+	cy2 = hitPixel.getBoundaryY();
+
+	dX = x1 - x2;
+	dY = y1 - y2;
+	dT = t1 - t2;
+	cutX = (cx1+cx2)*1.01; //this additional 1% is accounting for precision
+	cutY = (cy1+cy2)*1.01; //uncertainty with the geo framework
+
+	//they touch if they pass the spatial and temporal cuts
+	//ie. if dx^2<=(pitchX*1.01)^2
+	return (dX*dX <= cutX*cutX) && (dY*dY <= cutY*cutY) && (dT*dT <= _cutT*_cutT);//NEEDS TO BE EDITED FOR R0 SENSOR
+}
+
 void EUTelProcessorGeometricClustering::geometricClustering(LCEvent * evt, LCCollectionVec * pulseCollection) {
 	// prepare some decoders
 	CellIDDecoder<TrackerDataImpl> cellDecoder( _zsInputDataCollectionVec );
@@ -296,200 +488,70 @@ void EUTelProcessorGeometricClustering::geometricClustering(LCEvent * evt, LCCol
 		
 		int hitPixelsInEvent = sparseData->size();
 		std::vector<EUTelGeometricPixel> hitPixelVec;
+		hitPixelVec.reserve( hitPixelsInEvent );
 		EUTelGenericSparsePixel* pixel = NULL;
 		
-			
 		//This for-loop loads all the hits of the given event and detector plane and stores them as GeometricPixels
 		for(int i = 0; i < hitPixelsInEvent; ++i )
 		  {
-		   
 		    pixel = dynamic_cast<EUTelGenericSparsePixel *>( sparseData->getSparsePixelAt( i, pixel ) );
 		    EUTelGeometricPixel hitPixel( *pixel );
-		    
-		    //And get the path to the given pixel
-		    std::string pixelPath = geoDescr->getPixName(hitPixel.getXCoord(), hitPixel.getYCoord());
-		    
-		    //Then navigate to this pixel with the TGeo manager
-		    geo::gGeometry()._geoManager->cd( (planePath+pixelPath).c_str() );
-		    //std::cout<<planePath+pixelPath<<std::endl;
-		    //planePath=/volume_World_1/volume_SensorID:0_1
-		    
-		    //get the imbedding box
-		    TGeoShape* currentShape =  geo::gGeometry()._geoManager->GetCurrentVolume()->GetShape();
-		    //std::cout<<"This is the currentShape "<<*currentShape <<std::endl;
-		    TGeoBBox* bbox = dynamic_cast<TGeoBBox*>( currentShape );
-		    //store the dimensions of this box in the GeometricPixel
-		    
-		    hitPixel.setBoundaryX( bbox->GetDX() );
-		    hitPixel.setBoundaryY( bbox->GetDY() );
-		
-		    //Get how deep the node description goes (this is how often we have to transform to get coordinates in the local plane coordinate system)
-		    std::vector<std::string> split = Utility::stringSplit( planePath+pixelPath , "/", false);
-		    std::cout<<"split: "<< planePath+pixelPath<<std::endl;
-		    
-		    std::string Row_in,Col_in;
-		    Double_t X_mid,Y_mid;
-		    int int_Row_in,int_Col_in;
-		    
-		    if(sensorID==0){//This is for the R0 sensor as I placed the R0 sensor as the first plane in the EUTEL telescope in AllPix
-		      Double_t RCentreOfPixel,thetaPitch,NumStrips,stereo,phi_i,b,c,r,R;
-		      Col_in=split[3].substr(14);
-		      Row_in=split[3][12];
-		      int_Row_in=atoi(Row_in.c_str())-1;
-		      int_Col_in=atoi(Col_in.c_str())-1;
-		      if(int_Row_in==0){
-			RCentreOfPixel=393.9905;
-			thetaPitch=0.0001932745;
-			NumStrips=1026;
-		      }
-		      if(int_Row_in==1){
-			RCentreOfPixel=415.4715;
-			thetaPitch=0.0001932745;
-			NumStrips=1026;
-		      }
-		      if(int_Row_in==2){
-			RCentreOfPixel=441.952;
-			thetaPitch=0.0001718368;
-			NumStrips=1154;
-		      }
-		      if(int_Row_in==3){
-			RCentreOfPixel=472.4325;
-			thetaPitch=0.0001718368;
-			NumStrips=1154;
-		      }
-		      stereo=0.02,R=438.614;
-		      phi_i=(int_Col_in-NumStrips/2+0.5)*thetaPitch;
-		      b=-2*(2*R*sin(stereo/2))*sin(stereo/2+phi_i);
-		      c=pow((2*R*sin(stereo/2)),2)-pow(RCentreOfPixel,2);
-		      r=0.5*(-b+sqrt(pow(b,2)-4*c));
-		      Y_mid=r*cos(phi_i+stereo) - R*cos(stereo);
-		      X_mid=-r*sin(phi_i+stereo) + R*sin(stereo);
-		    }
-		    
-		    else{
-		      Row_in=split[4].substr(10);
-		      Col_in=split[3].substr(8);
-		      int_Row_in=atoi(Row_in.c_str())-1;
-		      int_Col_in=atoi(Col_in.c_str())-1;
-		      X_mid=hitPixel.getBoundaryX()*2*int_Col_in-sizeX/2+hitPixel.getBoundaryX();
-		      Y_mid= hitPixel.getBoundaryY()*2*int_Row_in-sizeY/2+hitPixel.getBoundaryY();
-		    }
-		    if(sensorID==0 || sensorID==1 || sensorID==2){
-		      std::cout<<sensorID << ": getPixName input: ("<< hitPixel.getXCoord()<< "," << hitPixel.getYCoord()<<")"
-			       <<" row "<<int_Row_in <<" col "<<int_Col_in
-			       <<std::endl;}
 
+		    //position and boundaries are only computed via TGeo the first time a pixel fires
+		    setPixelGeometry( sensorID, planePath, geoDescr, sizeX, sizeY, minX, maxX, minY, maxY, hitPixel );
 
-		    
-		    //Three recursions for the telescope/plane
-		    int recursionDepth = split.size() - 3;
-		    //if(sensorID==0 || sensorID==1){
-		    //  std::cout<<sensorID<<": recursionDepth: "<<planePath+pixelPath<<"   "<< recursionDepth <<std::endl;}
-		    //The do the transformation
-		    Double_t origin_pt[3] = {0,0,0};
-		    Double_t transformed1_pt[3];
-		    Double_t transformed2_pt[3];
-		    gGeoManager->GetCurrentNode()->LocalToMaster(origin_pt, transformed1_pt);
-
-		    //if (pixelPath[10]=='m' and sensorID==0){std::cout<<sensorID<<": "
-			//<<"delta: "<< bbox->GetDX() <<", "<<bbox->GetDY()
-		    //						     <<"  pos1: "<<transformed1_pt[0] << ", "<<transformed1_pt[1] <<std::endl;}
-		    
-		    transformed2_pt[0] = transformed1_pt[0];
-		    transformed2_pt[1] = transformed1_pt[1];
-		    transformed2_pt[2] = transformed1_pt[2];
-
-		    //transform into local plane coordinate system
-		    for(int i = 1 ; i < recursionDepth; ++i)
-		      {
-			gGeoManager->GetMother(i)->LocalToMaster(transformed1_pt, transformed2_pt);
-			transformed1_pt[0] = transformed2_pt[0];
-			transformed1_pt[1] = transformed2_pt[1];
-			transformed1_pt[2] = transformed2_pt[2];
-		      }
-		    if (sensorID==0 || sensorID==1 || sensorID==2){
-		      std::cout<<sensorID<<": delta: "<< bbox->GetDX() <<", "<<bbox->GetDY()
-			       <<" pos2: "<<transformed2_pt[0] << ", "<<transformed2_pt[1] 
-			       <<std::endl;
-		      std::cout<<sensorID<<": X_calc: "<< X_mid <<" Y_calc: "<< Y_mid
-			       <<std::endl;
-		    }
-		    
-		    //This was changed to take in the positions based on the pixGeo mapping
-		    //store all the position information in the GeometricPixel
-		    hitPixel.setPosX( X_mid);//transformed2_pt[0]
-		    hitPixel.setPosY( Y_mid);//transformed2_pt[1]
 		    //and push this pixel back
 		    hitPixelVec.push_back( hitPixel );
 		  }
 		
-		
-		std::vector<EUTelGeometricPixel> newlyAdded;
-		//We now cluster those hits together
-		while( !hitPixelVec.empty() )
+		//build the spatial index, neighbour candidates are then only searched in the adjacent cells
+		_pixelIndex.build( hitPixelVec );
+		std::vector<char> isClustered( hitPixelVec.size(), 0 );
+		std::vector<int> clusterMembers;
+		clusterMembers.reserve( hitPixelVec.size() );
+		std::vector<int> candidates;
+
+		//We now cluster those hits together, seeds are taken in input order
+		for( size_t seed = 0; seed < hitPixelVec.size(); ++seed )
 		  {
+		    if( isClustered[seed] ) continue;
+
 		    // prepare a TrackerData to store the cluster candidate
 		    std::unique_ptr<TrackerDataImpl> zsCluster = std::make_unique<TrackerDataImpl>();
 		    // prepare a reimplementation of sparsified cluster
 		    std::unique_ptr<EUTelGenericSparseClusterImpl<EUTelGeometricPixel> > sparseCluster = std::make_unique<EUTelGenericSparseClusterImpl<EUTelGeometricPixel> >(zsCluster.get());
 		    
-		    //First we need to take any pixel, so let's take the first one
-		    //Add it to the cluster as well as the newly added pixels
-		    newlyAdded.push_back( hitPixelVec.front() );
-		    sparseCluster->addSparsePixel( &hitPixelVec.front() );
-		    //And remove it from the original collection
-		    hitPixelVec.erase( hitPixelVec.begin() );
+		    //Add the seed to the cluster, the member list is at the same time the queue of pixels
+		    //whose neighbours still have to be searched
+		    clusterMembers.clear();
+		    clusterMembers.push_back( seed );
+		    isClustered[seed] = 1;
 		    
-		    //Now process all newly added pixels, initially this is the just previously added one
-		    //but in the process of neighbour finding we continue to add new pixels
-		    while( !newlyAdded.empty() )
+		    for( size_t front = 0; front < clusterMembers.size(); ++front )
 		      {
-			bool newlyDone = true;
-			float x1, x2, y1, y2, dX, dY, cx1, cy1, cx2, cy2, cutX, cutY, t1 , t2, dT;
-			
-			//check against all pixels in the hitPixelVec
-			for( std::vector<EUTelGeometricPixel>::iterator hitVec = hitPixelVec.begin(); hitVec != hitPixelVec.end(); ++hitVec )
+			EUTelGeometricPixel const& newlyAdded = hitPixelVec[ clusterMembers[front] ];
+
+			candidates.clear();
+			_pixelIndex.getCandidates( clusterMembers[front], candidates );
+
+			//neighbours are added in input order, exactly as the former linear scan over all remaining pixels did
+			std::sort( candidates.begin(), candidates.end() );
+			for( size_t iCandidate = 0; iCandidate < candidates.size(); ++iCandidate )
 			  {
-			    //get the relevant infos from the newly added pixel
-			    x1 = newlyAdded.front().getPosX();
-			    y1 = newlyAdded.front().getPosY();
-			    t1 =  newlyAdded.front().getTime();
-			    cx1 = newlyAdded.front().getBoundaryX();
-			    cy1 = newlyAdded.front().getBoundaryY();
-			    
-			    //and the pixel we test against
-			    x2 = hitVec->getPosX();
-			    y2 = hitVec->getPosY();
-			    t2 = hitVec->getTime();
-			    cx2 = hitVec->getBoundaryX();
-			    cy2 = hitVec->getBoundaryY();
-			    
-			    dX = x1 - x2;
-			    dY = y1 - y2;
-			    dT = t1 - t2;
-			    cutX = (cx1+cx2)*1.01; //this additional 1% is accounting for precision
-			    cutY = (cy1+cy2)*1.01; //uncertainty with the geo framework
-			    
-			    //if they pass the spatial and temporal cuts, we add them
-			    //ie. if dx^2<=(pitchX*1.01)^2
-			    if(	(dX*dX <= cutX*cutX) && (dY*dY <= cutY*cutY) && (dT*dT <= _cutT*_cutT) )//NEEDS TO BE EDITED FOR R0 SENSOR
+			    int const other = candidates[iCandidate];
+			    if( isClustered[other] ) continue;
+			    if( pixelsTouch( newlyAdded, hitPixelVec[other] ) )
 			      {
-				//add them to the cluster as well as to the newly added ones
-				newlyAdded.push_back( *hitVec );
-				sparseCluster->addSparsePixel( &(*hitVec) );
-				//and remove it from the original collection
-				hitPixelVec.erase( hitVec );
-				//for the pixel we test there might be other neighbours, we still have to check
-				newlyDone = false;
-				break;
+				clusterMembers.push_back( other );
+				isClustered[other] = 1;
 			      }
 			  }
-			
-			//if no neighbours are found, we can delete the pixel from the newly added
-			//we tested against _ALL_ non cluster pixels, there are no other pixels
-			//which could be neighbours
-			if(newlyDone) newlyAdded.erase( newlyAdded.begin() );
-		      }	
+		      }
+
+		    for( size_t iMember = 0; iMember < clusterMembers.size(); ++iMember )
+		      {
+			sparseCluster->addSparsePixel( &hitPixelVec[ clusterMembers[iMember] ] );
+		      }
 		    
 		    //Now we need to process the found cluster
 		    if ( sparseCluster->size() > 0 ) 
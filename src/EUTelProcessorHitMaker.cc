@@ -15,6 +15,7 @@
 #include "EUTelGeometryTelescopeGeoDescription.h"
 
 #include "EUTelProcessorHitMaker.h"
+#include "EUTelHistogramBooking.h"
 #include "EUTelRunHeaderImpl.h"
 #include "EUTelEventImpl.h"
 #include "EUTELESCOPE.h"
@@ -518,7 +519,8 @@ void EUTelProcessorHitMaker::end()
 void EUTelProcessorHitMaker::bookHistos(int sensorID) {
 
 #if defined(USE_AIDA) || defined(MARLIN_USE_AIDA)
-
+  // new sensors can show up in any event, also when running event parallel
+  std::lock_guard<std::recursive_mutex> lock( histogramBookingMutex() );
 
   string tempHistoName;
   string basePath = "plane_" + to_string( sensorID ) ;
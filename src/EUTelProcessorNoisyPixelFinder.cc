@@ -12,6 +12,7 @@
 #include "EUTELESCOPE.h"
 #include "EUTelRunHeaderImpl.h"
 #include "EUTelTrackerDataInterfacerImpl.h"
+#include "EUTelTrackerDataView.h"
 
 // eutelescope geometry
 #include "EUTelGeometryTelescopeGeoDescription.h"
@@ -186,30 +187,34 @@ void EUTelProcessorNoisyPixelFinder::noisyPixelFinder(EUTelEventImpl* evt) {
 			}
 			if(foundexcludedsensor) continue;
 
-			// now prepare the EUTelescope interface to sparsified data.  
-			EUTelBaseSparsePixel* pixel = nullptr;
+			// only the pixel coordinates are needed, read them directly from the
+			// interleaved chargeValues without decoding full pixel objects
 			int pixelType = cellDecoder(zsData)["sparsePixelType"];
-			auto sparseData = Utility::getSparseData(zsData, pixelType);
-
-			// loop over all pixels in the sparseData object, these are the hit pixels!
-			for ( size_t iPixel = 0; iPixel < sparseData->size(); iPixel++ ) {
-				//get the pixel
-				pixel = sparseData->getSparsePixelAt( iPixel, pixel );
+			size_t const nElement = sparsePixelNoOfElements( static_cast<SparsePixelType>(pixelType) );
+			lcio::FloatVec const& chargeValues = zsData->getChargeValues();
+			size_t const nPixel = chargeValues.size()/nElement;
+			if( nPixel == 0 ) continue;
+			EUTelStridedColumn const xColumn( &chargeValues[0], nPixel, nElement );
+			EUTelStridedColumn const yColumn( &chargeValues[1], nPixel, nElement );
+
+			// loop over all pixels in the TrackerData, these are the hit pixels!
+			for ( size_t iPixel = 0; iPixel < nPixel; iPixel++ ) {
+				short const xCoord = static_cast<short>( xColumn[iPixel] );
+				short const yCoord = static_cast<short>( yColumn[iPixel] );
 
 				//compute the address in the array-like-structure, any offset
 				//has to be substracted (array index starts at 0)
-				int indexX = pixel->getXCoord() - currentSensor->offX;
-				int indexY = pixel->getYCoord() - currentSensor->offY;
+				int indexX = xCoord - currentSensor->offX;
+				int indexY = yCoord - currentSensor->offY;
 
 				try {
 					//increment the hit counter for this pixel
 					(hitArray->at(indexX)).at(indexY)++;
 				} catch(std::out_of_range& e) {
-					streamlog_out ( ERROR5 )  << "Pixel: " << pixel->getXCoord() << "|" <<  pixel->getYCoord() << " on plane: " << sensorID << " fired." << std::endl 
+					streamlog_out ( ERROR5 )  << "Pixel: " << xCoord << "|" <<  yCoord << " on plane: " << sensorID << " fired." << std::endl 
 						<< "This pixel is out of the range defined by the geometry. Either your data is corrupted or your pixel geometry not specified correctly!" << std::endl;
 				}
 			}
-			delete pixel;
 		}    
 	} catch (lcio::DataNotAvailableException& e ) {
 		streamlog_out ( WARNING2 )  << "Input collection not found in the current event. Skipping..." << e.what() << std::endl;
@@ -21,6 +21,8 @@
 
 //eutel data specific
 #include "EUTelTrackerDataInterfacerImpl.h"
+#include "EUTelTrackerDataView.h"
+#include "EUTelSparseClusterEngine.h"
 #include "EUTelSparseClusterImpl.h"
 
 //eutel geometry
@@ -85,7 +87,9 @@ EUTelProcessorSparseClustering::EUTelProcessorSparseClustering():
   _sensorIDVec(),
   _zsInputDataCollectionVec(NULL),
   _pulseCollectionVec(NULL),
-  _sparseMinDistanceSquared(2)
+  _sparseMinDistanceSquared(2),
+  _pixelColumns(),
+  _clusterEngineMap()
  {
   
   // modify processor description
@@ -272,6 +276,26 @@ void EUTelProcessorSparseClustering::processEvent (LCEvent * event)
 }
 
 
+EUTelSparseClusterEngine& EUTelProcessorSparseClustering::getClusterEngine(int sensorID)
+{
+	std::map<int, EUTelSparseClusterEngine>::iterator it = _clusterEngineMap.find( sensorID );
+	if( it != _clusterEngineMap.end() ) return it->second;
+
+	EUTelSparseClusterEngine& clusterEngine = _clusterEngineMap[ sensorID ];
+	clusterEngine.setMinDistanceSquared( _sparseMinDistanceSquared );
+
+	//the occupancy grid is sized according to the pixel index range of the sensor
+	geo::EUTelGenericPixGeoDescr* geoDescr = geo::gGeometry().getPixGeoDescr( sensorID );
+	if( geoDescr )
+	{
+		int minX, minY, maxX, maxY;
+		minX = minY = maxX = maxY = 0;
+		geoDescr->getPixelIndexRange( minX, maxX, minY, maxY );
+		clusterEngine.setPixelIndexRange( minX, maxX, minY, maxY );
+	}
+	return clusterEngine;
+}
+
 void EUTelProcessorSparseClustering::sparseClustering(LCEvent* evt, LCCollectionVec* pulseCollection)
 {
 
@@ -325,81 +349,27 @@ void EUTelProcessorSparseClustering::sparseClustering(LCEvent* evt, LCCollection
 		if ( type == kEUTelGenericSparsePixel )
 		{
 
-			// now prepare the EUTelescope interface to sparsified data.
-			std::unique_ptr<EUTelTrackerDataInterfacerImpl<EUTelGenericSparsePixel>> sparseData = std::make_unique<EUTelTrackerDataInterfacerImpl<EUTelGenericSparsePixel>>(zsData);
-
-			int hitPixelsInEvent = sparseData->size();
-			std::vector<EUTelGenericSparsePixel> hitPixelVec;
-			EUTelGenericSparsePixel* pixel = new EUTelGenericSparsePixel;
-
-			//This for-loop loads all the hits of the given event and detector plane and stores them
-			for(int i = 0; i < hitPixelsInEvent; ++i )
-			{
-				//Load the information of the hit pixel into genericPixel
-				sparseData->getSparsePixelAt( i, pixel );
-				EUTelGenericSparsePixel hitPixel( *pixel );
+			// now prepare the read-only view on the sparsified data and decode it
+			EUTelTrackerDataView<EUTelGenericSparsePixel> sparseView( zsData );
+			sparseView.decode( _pixelColumns );
 
-				//and push this pixel back
-				hitPixelVec.push_back( hitPixel );
-			}	
+			//We now cluster those hits together, the engine returns the clusters as lists of pixel indices
+			EUTelSparseClusterEngine& clusterEngine = getClusterEngine( sensorID );
+			size_t noOfClusters = clusterEngine.cluster( _pixelColumns.x.data(), _pixelColumns.y.data(), _pixelColumns.size() );
 
-			std::vector<EUTelGenericSparsePixel> newlyAdded;
-			//We now cluster those hits together
-			while( !hitPixelVec.empty() )
+			for( size_t iCluster = 0; iCluster < noOfClusters; ++iCluster )
 			{
                            	// prepare a TrackerData to store the cluster candidate
 				std::unique_ptr<TrackerDataImpl> zsCluster = std::make_unique<TrackerDataImpl>();
 				// prepare a reimplementation of sparsified cluster
 				std::unique_ptr<EUTelSparseClusterImpl<EUTelGenericSparsePixel>> sparseCluster = std::make_unique<EUTelSparseClusterImpl<EUTelGenericSparsePixel>>(zsCluster.get());
 
-				//First we need to take any pixel, so let's take the first one
-				//Add it to the cluster as well as the newly added pixels
-				newlyAdded.push_back( hitPixelVec.front() );
-				sparseCluster->addSparsePixel( &(hitPixelVec.front()) );
-				//And remove it from the original collection
-				hitPixelVec.erase( hitPixelVec.begin() );
-
-				//Now process all newly added pixels, initially this is the just previously added one
-				//but in the process of neighbour finding we continue to add new pixels
-				while( !newlyAdded.empty() )
+				for( int const* iPixel = clusterEngine.clusterBegin( iCluster ); iPixel != clusterEngine.clusterEnd( iCluster ); ++iPixel )
 				{
-					bool newlyDone = true;
-					int  x1, x2, y1, y2, dX, dY;
-
-					//check against all pixels in the hitPixelVec
-					for( std::vector<EUTelGenericSparsePixel>::iterator hitVec = hitPixelVec.begin(); hitVec != hitPixelVec.end(); ++hitVec )
-					{
-						//get the relevant infos from the newly added pixel
-						x1 = newlyAdded.front().getXCoord();
-						y1 = newlyAdded.front().getYCoord();
-
-						//and the pixel we test against
-						x2 = hitVec->getXCoord();
-						y2 = hitVec->getYCoord();
-
-						dX = x1 - x2;
-						dY = y1 - y2;
-						int distance = dX*dX+dY*dY;
-						//if they pass the spatial and temporal cuts, we add them
-						if( distance <= _sparseMinDistanceSquared )
-						{
-							//add them to the cluster as well as to the newly added ones
-							newlyAdded.push_back( *hitVec );
-							sparseCluster->addSparsePixel( &(*hitVec) );
-							//and remove it from the original collection
-							hitPixelVec.erase( hitVec );
-							//for the pixel we test there might be other neighbours, we still have to check
-							newlyDone = false;
-							break;
-						}
-					}
-
-					//if no neighbours are found, we can delete the pixel from the newly added
-					//we tested against _ALL_ non cluster pixels, there are no other pixels
-					//which could be neighbours
-					if(newlyDone) newlyAdded.erase( newlyAdded.begin() );
+					EUTelGenericSparsePixel hitPixel( _pixelColumns.x[*iPixel], _pixelColumns.y[*iPixel], _pixelColumns.signal[*iPixel], _pixelColumns.time[*iPixel] );
+					sparseCluster->addSparsePixel( &hitPixel );
 				}
-				
+
 				//Now we need to process the found cluster
 				if (  sparseCluster->size() > 0 )
 				{
@@ -432,8 +402,6 @@ void EUTelProcessorSparseClustering::sparseClustering(LCEvent* evt, LCCollection
 					//forget about them, the memory should be automatically cleaned by smart ptr's
 				}
 			} //loop over all found clusters
-
-			delete pixel;
 		}
 		else
 		{
@@ -0,0 +1,153 @@
+/* 
+ * File:   EUTelRadLengthTable.cpp
+ * 
+ */
+#include "EUTelRadLengthTable.h"
+
+// C++
+#include <algorithm>
+#include <cmath>
+
+using namespace eutelescope;
+using namespace geo;
+
+EUTelRadLengthTable::EUTelRadLengthTable():
+_entries(),
+_index(),
+_centres(),
+_normals(),
+_thickness(),
+_maxSlope(0),
+_nBins(0),
+_step(0)
+{}
+
+void EUTelRadLengthTable::clear() {
+	_entries.clear();
+	_index.clear();
+	_centres.clear();
+	_normals.clear();
+	_thickness.clear();
+}
+
+void EUTelRadLengthTable::integrate( size_t i, double tx, double ty, Integrator const& integrate, double& plane, double& gap ) const {
+	Eigen::Vector3d direction( tx, ty, 1 );
+	direction.normalize();
+
+	//Cross the whole plane plus a minor safety margin, as for the plane radiation lengths at normal incidence
+	double const cosIncidence = std::max( std::abs( direction.dot(_normals[i]) ), 1.e-3 );
+	double const halfPath = 0.51*_thickness[i]/cosIncidence;
+	plane = integrate( _centres[i] - halfPath*direction, _centres[i] + halfPath*direction );
+
+	gap = 0;
+	if( i+1 < _centres.size() ) {
+		double const cosNext = std::max( std::abs( direction.dot(_normals[i+1]) ), 1.e-3 );
+		double const halfPathNext = 0.51*_thickness[i+1]/cosNext;
+		double nextPlane = integrate( _centres[i+1] - halfPathNext*direction, _centres[i+1] + halfPathNext*direction );
+
+		Eigen::Vector3d end = _centres[i] + direction*( (_centres[i+1](2) - _centres[i](2))/direction(2) );
+		double total = integrate( _centres[i], end );
+		gap = std::max( 0., total - 0.5*plane - 0.5*nextPlane );
+	}
+}
+
+void EUTelRadLengthTable::fill( std::vector<int> const& sensorIDs, std::vector<Eigen::Vector3d> const& centres,
+				std::vector<Eigen::Vector3d> const& normals, std::vector<double> const& thickness,
+				double maxSlope, int nBins, Integrator const& integrate ) {
+	clear();
+	_centres = centres;
+	_normals = normals;
+	_thickness = thickness;
+	_maxSlope = maxSlope;
+	_nBins = std::max( nBins, 2 );
+	_step = 2*_maxSlope/(_nBins-1);
+
+	_entries.resize( sensorIDs.size() );
+	for( size_t i = 0; i < sensorIDs.size(); ++i ) {
+		Entry& entry = _entries[i];
+		entry.sensorID = sensorIDs[i];
+		entry.plane.resize( _nBins*_nBins );
+		entry.gap.resize( _nBins*_nBins );
+		for( int iy = 0; iy < _nBins; ++iy ) {
+			for( int ix = 0; ix < _nBins; ++ix ) {
+				this->integrate( i, -_maxSlope + ix*_step, -_maxSlope + iy*_step, integrate, entry.plane[iy*_nBins+ix], entry.gap[iy*_nBins+ix] );
+			}
+		}
+		_index[entry.sensorID] = i;
+	}
+}
+
+double EUTelRadLengthTable::check( Integrator const& integrate ) const {
+	double maxDeviation = 0;
+	for( size_t i = 0; i < _entries.size(); ++i ) {
+		for( int iy = 0; iy+1 < _nBins; ++iy ) {
+			for( int ix = 0; ix+1 < _nBins; ++ix ) {
+				double const tx = -_maxSlope + (ix+0.5)*_step;
+				double const ty = -_maxSlope + (iy+0.5)*_step;
+				double plane, gap;
+				this->integrate( i, tx, ty, integrate, plane, gap );
+				double const exact[2] = { plane, gap };
+				double const table[2] = { interpolate( _entries[i].plane, tx, ty ), interpolate( _entries[i].gap, tx, ty ) };
+				for( int k = 0; k < 2; ++k ) {
+					double deviation = std::abs( table[k] - exact[k] );
+					if( exact[k] > 0 ) deviation /= exact[k];
+					maxDeviation = std::max( maxDeviation, deviation );
+				}
+			}
+		}
+	}
+	return maxDeviation;
+}
+
+double EUTelRadLengthTable::interpolate( std::vector<double> const& values, double tx, double ty ) const {
+	double const u = (tx + _maxSlope)/_step;
+	double const v = (ty + _maxSlope)/_step;
+	int const ix = std::min( std::max( static_cast<int>(u), 0 ), _nBins-2 );
+	int const iy = std::min( std::max( static_cast<int>(v), 0 ), _nBins-2 );
+	double const fx = u - ix;
+	double const fy = v - iy;
+	double const* row = &values[iy*_nBins + ix];
+	return (1-fy)*( (1-fx)*row[0] + fx*row[1] ) + fy*( (1-fx)*row[_nBins] + fx*row[_nBins+1] );
+}
+
+double EUTelRadLengthTable::planeRadLength( int sensorID, double tx, double ty ) const {
+	return interpolate( getEntry(sensorID).plane, tx, ty );
+}
+
+double EUTelRadLengthTable::gapRadLength( int sensorID, double tx, double ty ) const {
+	return interpolate( getEntry(sensorID).gap, tx, ty );
+}
+
+float EUTelRadLengthTable::findRad( std::map<int,int> const& sensorIDToZOrderWithoutExcludedPlanes, double tx, double ty,
+				    std::map<const int,double>& sensors, std::map<const int,double>& air ) const {
+	int const firstSensorID = sensorIDToZOrderWithoutExcludedPlanes.at(0);
+	int const lastSensorID = sensorIDToZOrderWithoutExcludedPlanes.at( sensorIDToZOrderWithoutExcludedPlanes.size()-1 );
+	bool foundFirstPlane = false;
+	int sensorLeftSide = 0;
+	double total = 0;
+
+	for( size_t i = 0; i < _entries.size(); ++i ) {
+		int const sensorID = _entries[i].sensorID;
+		if( sensorID == firstSensorID ) foundFirstPlane = true;
+		if( !foundFirstPlane ) continue;
+
+		double const rad = interpolate( _entries[i].plane, tx, ty );
+		total += rad;
+		if( sensorID == lastSensorID ) {
+			sensors[sensorID] = sensors[sensorID] + rad;
+			return total;
+		}
+
+		double const gap = interpolate( _entries[i].gap, tx, ty );
+		total += gap;
+		if( sensorIDToZOrderWithoutExcludedPlanes.find(sensorID) != sensorIDToZOrderWithoutExcludedPlanes.end() ) {
+			sensors[sensorID] = sensors[sensorID] + rad;
+			sensorLeftSide = sensorID;
+			air[sensorID] = gap;
+		} else {
+			//Excluded planes are dead material in front of the next included plane
+			air[sensorLeftSide] = air[sensorLeftSide] + rad + gap;
+		}
+	}
+	return 0;
+}
@@ -0,0 +1,57 @@
+/* 
+ * File:   EUTelSensorLookup.cpp
+ * 
+ */
+#include "EUTelSensorLookup.h"
+
+// C++
+#include <algorithm>
+#include <cmath>
+
+using namespace eutelescope;
+using namespace geo;
+
+EUTelSensorLookup::EUTelSensorLookup():
+_slabs()
+{}
+
+void EUTelSensorLookup::clear() {
+	_slabs.clear();
+}
+
+void EUTelSensorLookup::addSensor( int sensorID, EUTelSensorTransform const& transform, const double halfSize[] ) {
+	Slab slab;
+	slab.sensorID = sensorID;
+	slab.transform = transform;
+
+	//z extent of the oriented box in the global frame
+	double zHalf = 0;
+	for( int i = 0; i < 3; ++i ) {
+		slab.halfSize[i] = halfSize[i];
+		zHalf += std::fabs( transform.rot[6+i] )*halfSize[i];
+	}
+	slab.zMin = transform.tr[2] - zHalf;
+	slab.zMax = transform.tr[2] + zHalf;
+
+	_slabs.insert( std::upper_bound( _slabs.begin(), _slabs.end(), slab, lowerZ ), slab );
+}
+
+int EUTelSensorLookup::findSensor( const double globalPos[] ) const {
+	double const z = globalPos[2];
+	for( std::vector<Slab>::const_iterator it = _slabs.begin(); it != _slabs.end() && it->zMin <= z; ++it ) {
+		if( z > it->zMax ) continue;
+
+		double local[3];
+		it->transform.master2Local( globalPos, local );
+		if( std::fabs(local[0]) <= it->halfSize[0] && std::fabs(local[1]) <= it->halfSize[1] && std::fabs(local[2]) <= it->halfSize[2] ) {
+			return it->sensorID;
+		}
+	}
+	return -999;
+}
+
+void EUTelSensorLookup::findSensor( size_t nPoints, const double globalPos[], int sensorIDs[] ) const {
+	for( size_t i = 0; i < nPoints; ++i ) {
+		sensorIDs[i] = findSensor( globalPos+3*i );
+	}
+}
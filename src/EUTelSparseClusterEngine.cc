@@ -0,0 +1,159 @@
+/*
+ *   This source code is part of the Eutelescope package of Marlin.
+ *   You are free to use this source files for your own development as
+ *   long as it stays in a public research context. You are not
+ *   allowed to use it for commercial purpose. You must put this
+ *   header with author names in all development based on this file.
+ *
+ */
+
+// eutelescope includes ".h"
+#include "EUTelSparseClusterEngine.h"
+
+// system includes <>
+#include <algorithm>
+
+using namespace eutelescope;
+
+EUTelSparseClusterEngine::EUTelSparseClusterEngine():
+  _minX(0),
+  _minY(0),
+  _nX(0),
+  _nY(0),
+  _distanceSquared(-1),
+  _offsetX(),
+  _offsetY(),
+  _cellHead(),
+  _nextInCell(),
+  _assigned(),
+  _clusterPixel(),
+  _clusterStart(1, 0),
+  _neighbours()
+{
+  setMinDistanceSquared(2);
+}
+
+void EUTelSparseClusterEngine::setPixelIndexRange(int minX, int maxX, int minY, int maxY)
+{
+  _minX = minX;
+  _minY = minY;
+  _nX = maxX - minX + 1;
+  _nY = maxY - minY + 1;
+  if( _nX < 0 ) _nX = 0;
+  if( _nY < 0 ) _nY = 0;
+  _cellHead.assign( static_cast<size_t>(_nX)*_nY, -1 );
+}
+
+void EUTelSparseClusterEngine::setMinDistanceSquared(int distanceSquared)
+{
+  _distanceSquared = distanceSquared;
+  _offsetX.clear();
+  _offsetY.clear();
+  if( distanceSquared < 0 ) return;
+
+  int reach = 0;
+  while( (reach+1)*(reach+1) <= distanceSquared ) ++reach;
+
+  for( int dY = -reach; dY <= reach; ++dY )
+  {
+    for( int dX = -reach; dX <= reach; ++dX )
+    {
+      if( dX*dX + dY*dY <= distanceSquared )
+      {
+        _offsetX.push_back( dX );
+        _offsetY.push_back( dY );
+      }
+    }
+  }
+}
+
+void EUTelSparseClusterEngine::adjustGrid(short const* x, short const* y, size_t nPixel)
+{
+  int loX = _minX, hiX = _minX + _nX - 1;
+  int loY = _minY, hiY = _minY + _nY - 1;
+  bool grow = ( _nX == 0 || _nY == 0 );
+  if( grow )
+  {
+    loX = hiX = x[0];
+    loY = hiY = y[0];
+  }
+
+  for( size_t i = 0; i < nPixel; ++i )
+  {
+    if( x[i] < loX ) { loX = x[i]; grow = true; }
+    if( x[i] > hiX ) { hiX = x[i]; grow = true; }
+    if( y[i] < loY ) { loY = y[i]; grow = true; }
+    if( y[i] > hiY ) { hiY = y[i]; grow = true; }
+  }
+
+  //the grid is rebuilt only if data outside of the known range show up
+  if( grow ) setPixelIndexRange( loX, hiX, loY, hiY );
+}
+
+size_t EUTelSparseClusterEngine::cluster(short const* x, short const* y, size_t nPixel)
+{
+  _clusterPixel.clear();
+  _clusterStart.assign( 1, 0 );
+  if( nPixel == 0 ) return 0;
+
+  adjustGrid( x, y, nPixel );
+
+  _nextInCell.resize( nPixel );
+  _assigned.assign( nPixel, 0 );
+  _clusterPixel.reserve( nPixel );
+
+  //fill the grid backwards so that every cell lists its pixels in input order
+  for( size_t i = nPixel; i-- > 0; )
+  {
+    size_t cell = cellIndex( x[i], y[i] );
+    _nextInCell[i] = _cellHead[cell];
+    _cellHead[cell] = static_cast<int>( i );
+  }
+
+  for( size_t seed = 0; seed < nPixel; ++seed )
+  {
+    if( _assigned[seed] ) continue;
+
+    _assigned[seed] = 1;
+    _clusterPixel.push_back( static_cast<int>(seed) );
+
+    //the cluster itself is the breadth-first queue
+    for( size_t front = _clusterStart.back(); front < _clusterPixel.size(); ++front )
+    {
+      int const current = _clusterPixel[front];
+      int const cX = x[current];
+      int const cY = y[current];
+
+      _neighbours.clear();
+      for( size_t iOffset = 0; iOffset < _offsetX.size(); ++iOffset )
+      {
+        int const nX = cX + _offsetX[iOffset];
+        int const nY = cY + _offsetY[iOffset];
+        if( nX < _minX || nX >= _minX + _nX || nY < _minY || nY >= _minY + _nY ) continue;
+
+        for( int other = _cellHead[cellIndex(nX, nY)]; other != -1; other = _nextInCell[other] )
+        {
+          if( !_assigned[other] ) _neighbours.push_back( other );
+        }
+      }
+
+      //neighbours are added in input order, as the original algorithm does
+      std::sort( _neighbours.begin(), _neighbours.end() );
+      for( size_t iNeighbour = 0; iNeighbour < _neighbours.size(); ++iNeighbour )
+      {
+        _assigned[_neighbours[iNeighbour]] = 1;
+        _clusterPixel.push_back( _neighbours[iNeighbour] );
+      }
+    }
+
+    _clusterStart.push_back( _clusterPixel.size() );
+  }
+
+  //only reset the cells which have been touched
+  for( size_t i = 0; i < nPixel; ++i )
+  {
+    _cellHead[cellIndex( x[i], y[i] )] = -1;
+  }
+
+  return getNumberOfClusters();
+}
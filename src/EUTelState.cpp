@@ -84,7 +84,7 @@ TVectorD EUTelState::getStateVec(){
 	streamlog_out( DEBUG1 ) << "EUTelState::getTrackStateVec()------------------------END" << std::endl;
  	return stateVec;
 }
-TMatrixDSym EUTelState::getScatteringVarianceInLocalFrame(){
+Eigen::Matrix2d EUTelState::getScatteringVarianceInLocalFrame(){
 	streamlog_out( DEBUG1 ) << "EUTelState::getScatteringVarianceInLocalFrame(Sensor)----------------------------BEGIN" << std::endl;
 	streamlog_out(DEBUG1) << "Variance (Sensor):  " << std::scientific << getRadFracSensor() << "  Plane: " << getLocation()  << std::endl;
 	if(getRadFracSensor() == 0){
@@ -97,15 +97,16 @@ TMatrixDSym EUTelState::getScatteringVarianceInLocalFrame(){
 	//c1 and c2 come from Claus's paper GBL
 	float c1 = 	unitMomentumLocalFrame[0]; float c2 =	unitMomentumLocalFrame[1];
 	streamlog_out( DEBUG1 ) << "The component in the x/y direction: "<< c1 <<"  "<<c2 << std::endl;
-	TMatrixDSym precisionMatrix(2);
+	//Only the lower triangle is filled, as GBL always received it
+	Eigen::Matrix2d precisionMatrix = Eigen::Matrix2d::Zero();
 	float factor = scatPrecision/pow((1-pow(c1,2)-pow(c2,2)),2);
 	streamlog_out( DEBUG1 ) << "The factor: "<< factor << std::endl;
-	precisionMatrix[0][0]=factor*(1-pow(c2,2));
-  precisionMatrix[1][0]=factor*c1*c2;				precisionMatrix[1][1]=factor*(1-pow(c1,2));
+	precisionMatrix(0,0)=factor*(1-pow(c2,2));
+  precisionMatrix(1,0)=factor*c1*c2;				precisionMatrix(1,1)=factor*(1-pow(c1,2));
 	streamlog_out( DEBUG1 ) << "EUTelState::getScatteringVarianceInLocalFrame(Sensor)----------------------------END" << std::endl;
 	return precisionMatrix;
 }
-TMatrixDSym EUTelState::getScatteringVarianceInLocalFrame(float  variance){
+Eigen::Matrix2d EUTelState::getScatteringVarianceInLocalFrame(float  variance){
 	streamlog_out( DEBUG1 ) << "EUTelState::getScatteringVarianceInLocalFrame(Scatter)----------------------------BEGIN" << std::endl;
 	streamlog_out(DEBUG5)<<"Variance (AIR Fraction): " <<std::scientific  <<  variance <<std::endl; 
 	float scatPrecision = 1.0 /variance;
@@ -115,35 +116,19 @@ TMatrixDSym EUTelState::getScatteringVarianceInLocalFrame(float  variance){
 	//c1 and c2 come from Claus's paper GBL
 	float c1 = 	unitMomentumLocalFrame[0]; float c2 = 	unitMomentumLocalFrame[1];
 	streamlog_out( DEBUG1 ) << "The component in the x/y direction: "<< c1 <<"  "<<c2 << std::endl;
-	TMatrixDSym precisionMatrix(2);
+	//Only the lower triangle is filled, as GBL always received it
+	Eigen::Matrix2d precisionMatrix = Eigen::Matrix2d::Zero();
 	float factor = scatPrecision/pow((1-pow(c1,2)-pow(c2,2)),2);
 	streamlog_out( DEBUG1 ) << "The factor: "<< factor << std::endl;
-	precisionMatrix[0][0]=factor*(1-pow(c2,2));
-  precisionMatrix[1][0]=factor*c1*c2;				precisionMatrix[1][1]=factor*(1-pow(c1,2));
+	precisionMatrix(0,0)=factor*(1-pow(c2,2));
+  precisionMatrix(1,0)=factor*c1*c2;				precisionMatrix(1,1)=factor*(1-pow(c1,2));
 	streamlog_out( DEBUG1 ) << "EUTelState::getScatteringVarianceInLocalFrame(Scatter)----------------------------END" << std::endl;
 
 	return precisionMatrix;
 }
-TMatrixDSym EUTelState::getStateCov() const {
-
-//	streamlog_out( DEBUG1 ) << "EUTelState::getTrackStateCov()----------------------------BEGIN" << std::endl;
-	TMatrixDSym C(5);   
-//	const EVENT::FloatVec& trkCov = getCovMatrix();        
-	C.Zero();
-            
-//	C[0][0] = trkCov[0]; 
-//	C[1][0] = trkCov[1];  C[1][1] = trkCov[2]; 
-//	C[2][0] = trkCov[3];  C[2][1] = trkCov[4];  C[2][2] = trkCov[5]; 
-//	C[3][0] = trkCov[6];  C[3][1] = trkCov[7];  C[3][2] = trkCov[8];  C[3][3] = trkCov[9]; 
-//	C[4][0] = trkCov[10]; C[4][1] = trkCov[11]; C[4][2] = trkCov[12]; C[4][3] = trkCov[13]; C[4][4] = trkCov[14]; 
-//        
-//	if ( streamlog_level(DEBUG0) ){
-//		streamlog_out( DEBUG0 ) << "Track state covariance matrix:" << std::endl;
-//		C.Print();
-//	}
-//        
-	return C;
-//	streamlog_out( DEBUG1 ) << "EUTelState::getTrackStateCov()----------------------------END" << std::endl;
+//The state covariance is not tracked yet, it is always zero
+Matrix5d EUTelState::getStateCov() const {
+	return Matrix5d::Zero();
 }
 bool EUTelState::getStateHasHit() const {
     return _stateHasHit;
@@ -155,13 +140,9 @@ void EUTelState::getCombinedHitAndStateCovMatrixInLocalFrame( double (&cov)[4] )
 	cov[2] = _covCombinedMatrix[2];
 	cov[3] = _covCombinedMatrix[3];
 }
-TMatrixD EUTelState::getProjectionMatrix() const {
-	TMatrixD projection(5,5);
-	projection.Zero();
-	TMatrixD proM2l(2, 2);
-	proM2l.UnitMatrix();
-	projection.SetSub(3, 3, proM2l);
-	return proM2l;
+//The measurement is the local position, which is the (x,y) part of the state
+Eigen::Matrix2d EUTelState::getProjectionMatrix() const {
+	return Eigen::Matrix2d::Identity();
 }
 TVector3 EUTelState::getMomLocal(){
 	TVector3 pVecUnitLocal;
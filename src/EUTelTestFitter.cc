@@ -176,11 +176,9 @@ EUTelTestFitter::EUTelTestFitter()
   _fitEx(NULL),
   _fitY(NULL),
   _fitEy(NULL),
-  _fitArray(NULL),
-  _nominalFitArrayX(NULL),
   _nominalErrorX(NULL),
-  _nominalFitArrayY(NULL),
   _nominalErrorY(NULL),
+  _brokenLineFit(),
   _noOfEventWOInputHit(0),
   _noOfEventWOTrack(0),
   _noOfTracks(0),
@@ -712,16 +710,10 @@ void EUTelTestFitter::init() {
   _fitY  = new double[_nTelPlanes];
   _fitEy = new double[_nTelPlanes];
 
-  int arrayDim = _nTelPlanes * _nTelPlanes;
-
-  _fitArray = new double[arrayDim];
-  _nominalFitArrayX = new double[arrayDim];
   _nominalErrorX = new double[_nTelPlanes];
-
-  _nominalFitArrayY = new double[arrayDim];
   _nominalErrorY = new double[_nTelPlanes];
 
-  // Fill nominal fit matrices and
+  // Set up the track fit and
   // calculate expected precision of track fitting
 
   // Planes are ordered in position along the beam line !
@@ -772,17 +764,23 @@ void EUTelTestFitter::init() {
 
   totalScatAngle = sqrt(totalScatAngle);
 
-  // Fit with nominal parameters for X direction
+  _brokenLineFit.setPlanes(_nTelPlanes, _planeDist, _planeScat, _useBeamConstraint, _beamSlopeX, _beamSlopeY);
 
-  int status = DoAnalFit(_fitX,_nominalErrorX,_beamSlopeX);
+  // Fit with nominal parameters, only the errors are used
 
-  if(status) {
-    streamlog_out( ERROR2 ) << "\n Fit in X with nominal geometry failed !?!" << endl;
+  for(int ipl=0; ipl<_nTelPlanes ; ipl++) {
+    if(_isActive[ipl]) {
+      _brokenLineFit.setMeasurement(ipl, 0., _nominalErrorX[ipl], 0., _nominalErrorY[ipl]);
+    } else {
+      _brokenLineFit.setMeasurement(ipl, 0., 0., 0., 0.);
+    }
   }
-  // Store fit matrix
 
-  for(int imx=0; imx<arrayDim; imx++) {
-    _nominalFitArrayX[imx] = _fitArray[imx];
+  if(_brokenLineFit.getChi2() < 0.) {
+    streamlog_out( ERROR2 ) << "\n Fit with nominal geometry failed !?!" << endl;
+    for(int ipl=0; ipl<_nTelPlanes ; ipl++) _nominalErrorX[ipl] = _nominalErrorY[ipl] = 0.;
+  } else {
+    _brokenLineFit.getFit(_fitX, _nominalErrorX, _fitY, _nominalErrorY);
   }
 
   stringstream ss;
@@ -801,19 +799,6 @@ void EUTelTestFitter::init() {
   streamlog_out ( MESSAGE2 ) << ss.str() << endl;
 
 
-  // Fit with nominal parameters for Y direction
-
-  status = DoAnalFit(_fitY,_nominalErrorY,_beamSlopeY);
-
-  if(status) {
-    streamlog_out( ERROR2 ) << "\n Fit in Y with nominal geometry failed !?!" << endl;
-  }
-  // Store fit matrix
-
-  for(int imx=0; imx<arrayDim; imx++) {
-    _nominalFitArrayY[imx] = _fitArray[imx];
-  }
-
 // Check if slope-based preselection parameter values are not too small
 
   if( _UseSlope && 
@@ -1565,17 +1550,15 @@ void EUTelTestFitter::processEvent( LCEvent * event ) {
      
 
  
-      // Select fit method
-      // "Nominal" fit only if all active planes used
+      // Fit the selected hits. Consecutive hit selections differ
+      // in the last planes only, the fit restarts from the first
+      // plane which changed. Fitted positions are only calculated
+      // for the tracks which are kept.
 
-      
-      if(_useNominalResolution && (nChoiceFired == _nActivePlanes)) 
-      {
-        choiceChi2 = NominalFit();
-      } else {
-        if(_useNominalResolution && _beamSlopeX==_beamSlopeY) choiceChi2 = SingleFit();
-        else choiceChi2 = MatrixFit();
-      }
+      for(int ipl=0;ipl<_nTelPlanes;ipl++)
+        _brokenLineFit.setMeasurement(ipl, _planeX[ipl], _planeEx[ipl], _planeY[ipl], _planeEy[ipl]);
+
+      choiceChi2 = _brokenLineFit.getChi2();
 
 
       // Fit failed ?
@@ -1642,6 +1625,8 @@ void EUTelTestFitter::processEvent( LCEvent * event ) {
         fittedPenalty.push_back(penalty); 
         fittedFired.push_back(nChoiceFired);
 
+        _brokenLineFit.getFit(_fitX, _fitEx, _fitY, _fitEy);
+
         for(int ipl=0;ipl<_nTelPlanes;ipl++)  
         {
             int jhit=-1;
@@ -2132,12 +2117,9 @@ void EUTelTestFitter::end(){
   delete [] _fitEx ;
   delete [] _fitY ;
   delete [] _fitEy ;
-  delete [] _fitArray ;
 
-  delete [] _nominalFitArrayX ;
   delete [] _nominalErrorX ;
 
-  delete [] _nominalFitArrayY ;
   delete [] _nominalErrorY ;
 }
 
@@ -2427,355 +2409,6 @@ void EUTelTestFitter::bookHistos()
 //
 
 
-double EUTelTestFitter::MatrixFit()
-{
-  for(int ipl=0; ipl<_nTelPlanes;ipl++)
-    {
-      _fitX[ipl]=_planeX[ipl];
-      _fitEx[ipl]=_planeEx[ipl];
-      _fitY[ipl]=_planeY[ipl];
-      _fitEy[ipl]=_planeEy[ipl];
-    }
-
-  int status = DoAnalFit(_fitX,_fitEx,_beamSlopeX);
-
-  if(status)return -1. ;
-
-  status = DoAnalFit(_fitY,_fitEy,_beamSlopeY);
-
-  if(status)return -1. ;
-
-  double chi2=GetFitChi2();
-
-  return chi2 ;
-}
-
-double EUTelTestFitter::SingleFit()
-{
-
-  for(int ipl=0; ipl<_nTelPlanes;ipl++)
-    {
-      _fitX[ipl]=_planeX[ipl];
-      _fitEx[ipl]=_planeEx[ipl];
-    }
-
-  int status = DoAnalFit(_fitX,_fitEx,_beamSlopeX);
-
-  if(status)return -1. ;
-
-  // Use same matrix to solve equation in Y
-
-  for(int ipl=0; ipl<_nTelPlanes;ipl++)
-    {
-      _fitEy[ipl]=_fitEx[ipl];
-
-      _fitY[ipl]=0. ;
-      for(int jpl=0; jpl<_nTelPlanes;jpl++)
-        if(_planeEy[jpl]>0.)
-          _fitY[ipl]+=_fitArray[ipl+jpl*_nTelPlanes]*_planeY[jpl]/_planeEy[jpl]/_planeEy[jpl];
-    }
-
-  double chi2=GetFitChi2();
-
-  return chi2 ;
-}
-
-double EUTelTestFitter::NominalFit()
-{
-  for(int ipl=0; ipl<_nTelPlanes;ipl++)
-    {
-      _fitEx[ipl]=_nominalErrorX[ipl];
-      _fitEy[ipl]=_nominalErrorY[ipl];
-
-      _fitX[ipl]=0. ;
-      _fitY[ipl]=0. ;
-
-      for(int jpl=0; jpl<_nTelPlanes;jpl++)
-        {
-          if(_planeEx[jpl]>0.)
-            _fitX[ipl]+=_nominalFitArrayX[ipl+jpl*_nTelPlanes]*_planeX[jpl]/_planeEx[jpl]/_planeEx[jpl];
-          if(_planeEy[jpl]>0.)
-            _fitY[ipl]+=_nominalFitArrayY[ipl+jpl*_nTelPlanes]*_planeY[jpl]/_planeEy[jpl]/_planeEy[jpl];
-        }
-
-      // Correction for beam slope
-
-    if(_useBeamConstraint && _beamSlopeX!=0.)
-      {
-	_fitX[ipl]-=_nominalFitArrayX[ipl]*_beamSlopeX*_planeDist[0]*_planeScat[0];
-	_fitX[ipl]+=_nominalFitArrayX[ipl+_nTelPlanes]*_beamSlopeX*_planeDist[0]*_planeScat[0];
-      }
-
-    if(_useBeamConstraint && _beamSlopeY!=0.)
-      {
-	_fitY[ipl]-=_nominalFitArrayY[ipl]*_beamSlopeY*_planeDist[0]*_planeScat[0];
-	_fitY[ipl]+=_nominalFitArrayY[ipl+_nTelPlanes]*_beamSlopeY*_planeDist[0]*_planeScat[0];
-      }
-
-    }
-
-  double chi2=GetFitChi2();
-
-  return chi2 ;
-}
-
-
-int EUTelTestFitter::DoAnalFit(double * pos, double *err, double slope)
-{
-  for(int ipl=0; ipl<_nTelPlanes;ipl++)
-    {
-      if(_isActive[ipl] && err[ipl]>0)
-        err[ipl]=1./err[ipl]/err[ipl] ;
-      else
-        err[ipl] = 0. ;
-
-      pos[ipl]*=err[ipl];
-    }
-
-  // To take into account beam tilt
-
-  if(_useBeamConstraint && slope!=0.)
-    {
-      pos[0] -= slope*_planeDist[0]*_planeScat[0];
-      pos[1] += slope*_planeDist[0]*_planeScat[0];
-    }
-
-
-  for(int ipl=0; ipl<_nTelPlanes;ipl++)
-  {
-    for(int jpl=0; jpl<_nTelPlanes;jpl++)
-      {
-        int imx=ipl+jpl*_nTelPlanes;
-
-      
-        _fitArray[imx] = 0.;
-
-        if(jpl==ipl-2)
-          _fitArray[imx] += _planeDist[ipl-2]*_planeDist[ipl-1]*_planeScat[ipl-1] ;
-
-        if(jpl==ipl+2)
-          _fitArray[imx] += _planeDist[ipl]*_planeDist[ipl+1]*_planeScat[ipl+1] ;
-
-        if(jpl==ipl-1)
-          {
-            if(ipl>0 &&  ipl < _nTelPlanes-1)
-              _fitArray[imx] -= _planeDist[ipl-1]*(_planeDist[ipl]+_planeDist[ipl-1])*_planeScat[ipl] ;
-            if(ipl>1)
-              _fitArray[imx] -= _planeDist[ipl-1]*(_planeDist[ipl-1]+_planeDist[ipl-2])*_planeScat[ipl-1] ;
-          }
-
-        if(jpl==ipl+1)
-          {
-            if(ipl>0 && ipl < _nTelPlanes-1)
-              _fitArray[imx] -= _planeDist[ipl]*(_planeDist[ipl]+_planeDist[ipl-1])*_planeScat[ipl] ;
-            if(ipl < _nTelPlanes-2)
-              _fitArray[imx] -= _planeDist[ipl]*(_planeDist[ipl+1]+_planeDist[ipl])*_planeScat[ipl+1] ;
-          }
-
-        if(jpl==ipl)
-          {
-            _fitArray[imx] += err[ipl] ;
-
-            if(ipl>0 && ipl<_nTelPlanes-1)
-              _fitArray[imx] += _planeScat[ipl]*(_planeDist[ipl]+_planeDist[ipl-1])*(_planeDist[ipl]+_planeDist[ipl-1]) ;
-
-            if(ipl > 1 )
-              _fitArray[imx] += _planeScat[ipl-1]*_planeDist[ipl-1]*_planeDist[ipl-1] ;
-
-            if(ipl < _nTelPlanes-2)
-              _fitArray[imx] += _planeScat[ipl+1]*_planeDist[ipl]*_planeDist[ipl] ;
-          }
-
-        // For beam constraint
-
-        if(ipl==jpl && ipl<2 && _useBeamConstraint)
-          _fitArray[imx] += _planeScat[0]*_planeDist[0]*_planeDist[0] ;
-
-        if(ipl+jpl==1 && _useBeamConstraint)
-          _fitArray[imx] -= _planeScat[0]*_planeDist[0]*_planeDist[0] ;        
-      }
-  }
-
-  int status=GaussjSolve(_fitArray,pos,_nTelPlanes) ;
-
-  if(status)
-    {
-      cerr << "Singular matrix in track fitting algorithm ! " << endl;
-      for(int ipl=0;ipl<_nTelPlanes;ipl++)
-        err[ipl]=0. ;
-    }
-  else
-    for(int ipl=0;ipl<_nTelPlanes;ipl++)
-      err[ipl]=sqrt(_fitArray[ipl+ipl*_nTelPlanes]);
-
-  return status ;
-}
-
-
-
-double EUTelTestFitter::GetFitChi2()
-{
-  double chi2=0. ;
-
-  // Measurements
-
-  for(int ipl=0; ipl<_nTelPlanes;ipl++)
-    if(_isActive[ipl])
-      {
-        if(_planeEx[ipl]>0.)
-          chi2+=(_fitX[ipl]-_planeX[ipl])*(_fitX[ipl]-_planeX[ipl])/_planeEx[ipl]/_planeEx[ipl] ;
-
-        if(_planeEy[ipl]>0.)
-          chi2+=(_fitY[ipl]-_planeY[ipl])*(_fitY[ipl]-_planeY[ipl])/_planeEy[ipl]/_planeEy[ipl] ;
-
-      }
-
-  // Scattering angles
-  // Use approximate formulas, corresponding to the approximation
-  // used in fitting algorithm
-
-  for(int ipl=1; ipl<_nTelPlanes-1;ipl++)
-    {
-      double th1,th2,dth;
-
-      th2=(_fitX[ipl+1]-_fitX[ipl])*_planeDist[ipl] ;
-      th1=(_fitX[ipl]-_fitX[ipl-1])*_planeDist[ipl-1] ;
-      //    dth=atan(th2)-atan(th1) ;
-      dth= th2 - th1 ;
-      chi2 += _planeScat[ipl] * dth * dth;
-
-      th2=(_fitY[ipl+1]-_fitY[ipl])*_planeDist[ipl] ;
-      th1=(_fitY[ipl]-_fitY[ipl-1])*_planeDist[ipl-1] ;
-      //    dth=atan(th2)-atan(th1) ;
-      dth= th2 - th1 ;
-      chi2 += _planeScat[ipl] * dth * dth;
-    }
-
-  // Beam constraint
-  // Beam slope taken into account.
-
-  if(_useBeamConstraint)
-    {
-      double dth;
-
-      // Use small angle approximation: atan(x) = x
-      // Should be:
-      //    dth=atan((_fitX[1]-_fitX[0])*_planeDist[0]) ;
-      dth=(_fitX[1]-_fitX[0])*_planeDist[0]  -  _beamSlopeX;
-      chi2 += _planeScat[0] * dth * dth;
-
-      dth=(_fitY[1]-_fitY[0])*_planeDist[0]  -  _beamSlopeY ;
-      chi2 += _planeScat[0] * dth * dth;
-    }
-
-
-  return chi2 ;
-}
-
-
-
-int EUTelTestFitter::GaussjSolve(double *alfa,double *beta,int n)
-{
-  int *ipiv;
-  int *indxr;
-  int *indxc;
-  int i,j,k;
-  int irow=0;
-  int icol=0;
-  double abs,big,help,pivinv;
-
-  ipiv = new int[n];
-  indxr = new int[n];
-  indxc = new int[n];
-
-  for(i=0;i<n;i++)ipiv[i]=0;
-
-  for(i=0;i<n;i++)
-    {
-      big=0.;
-      for(j=0;j<n;j++)
-        {
-          if(ipiv[j]==1)continue;
-          for(k=0;k<n;k++)
-            {
-              if(ipiv[k]!=0)continue;
-              abs=fabs(alfa[n*j+k]);
-              if(abs>big)
-                {
-                  big=abs;
-                  irow=j;
-                  icol=k;
-                }
-            }
-        }
-      ipiv[icol]++;
-
-      if(ipiv[icol]>1){
-	// first clean up then bail out
-	delete[] ipiv;
-	delete[] indxr;
-	delete[] indxc;
-        return 1;
-      }
-
-      if(irow!=icol)
-        {
-          help=beta[irow];
-          beta[irow]=beta[icol];
-          beta[icol]=help;
-          for(j=0;j<n;j++)
-            {
-              help=alfa[n*irow+j];
-              alfa[n*irow+j]=alfa[n*icol+j];
-              alfa[n*icol+j]=help;
-            }
-        }
-      indxr[i]=irow;
-      indxc[i]=icol;
-
-      if(alfa[n*icol+icol]==0.){
-	// first clean up then bail out
-	delete[] ipiv;
-	delete[] indxr;
-	delete[] indxc;
-        return 1;}
-
-      help=alfa[n*icol+icol];
-      pivinv=1./help;
-      alfa[n*icol+icol]=1.;
-      for(j=0;j<n;j++) alfa[n*icol+j]*=pivinv;
-
-      beta[icol]*=pivinv;
-
-      for(j=0;j<n;j++)
-        {
-          if(j==icol)continue;
-          help=alfa[n*j+icol];
-          alfa[n*j+icol]=0.;
-          for(k=0;k<n;k++)
-            alfa[n*j+k]-=alfa[n*icol+k]*help;
-          beta[j]-=beta[icol]*help;
-        }
-    }
-
-  for(i=n-1;i>=0;i--)
-    {
-      if(indxr[i]==indxc[i])continue;
-      for(j=0;j<n;j++)
-        {
-          help=alfa[n*j+indxr[i]];
-          alfa[n*j+indxr[i]]=alfa[n*j+indxc[i]];
-          alfa[n*j+indxc[i]]=help;
-        }
-    }
-
-  delete [] ipiv;
-  delete [] indxr;
-  delete [] indxc;
-
-  return 0;
-}
-
 void EUTelTestFitter::getFastTrackImpactPoint(double & x, double & y, double & z, Track * /* tr */, LCEvent * /* ev */) {
 
     // given maps:
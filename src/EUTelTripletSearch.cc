@@ -0,0 +1,287 @@
+/*
+ *   This source code is part of the Eutelescope package of Marlin.
+ *   You are free to use this source files for your own development as
+ *   long as it stays in a public research context. You are not
+ *   allowed to use it for commercial purpose. You must put this
+ *   header with author names in all development based on this file.
+ *
+ */
+
+// eutelescope includes ".h"
+#include "EUTelTripletSearch.h"
+
+// system includes <>
+#include <algorithm>
+#include <cmath>
+
+using namespace eutelescope;
+
+namespace {
+  bool lessX(double x, std::pair<double, int> const& hit) { return x < hit.first; }
+  bool lessPairX(std::pair<double, int> const& hit, double x) { return hit.first < x; }
+
+  // a seed slope this uncertain does not bias the filter
+  const double unknownSlopeVariance = 1.;
+}
+
+EUTelTripletSearch::EUTelTripletSearch():
+  _maxSlope(0.01),
+  _tripletCut(0.1),
+  _matchCut(0.3),
+  _matchSlopeCut(0.005),
+  _resolution(0.005),
+  _scatteringAngle(0.001),
+  _extensionChi2Cut(25.),
+  _nPlanes(0),
+  _upstreamArm(),
+  _downstreamArm(),
+  _planes(),
+  _planeZ(),
+  _upstream(),
+  _downstream(),
+  _downstreamX(),
+  _candidates(),
+  _order(),
+  _usedHits(),
+  _tracks()
+{}
+
+void EUTelTripletSearch::Line::propagate(double dz)
+{
+  pos += slope*dz;
+  c00 += dz*( 2*c01 + dz*c11 );
+  c01 += dz*c11;
+}
+
+double EUTelTripletSearch::Line::update(double measurement, double variance)
+{
+  double const residual = measurement - pos;
+  double const s = c00 + variance;
+  double const k0 = c00/s;
+  double const k1 = c01/s;
+  pos += k0*residual;
+  slope += k1*residual;
+  c11 -= k1*c01;
+  c01 -= k1*c00;
+  c00 -= k0*c00;
+  return residual*residual/s;
+}
+
+void EUTelTripletSearch::window(int plane, double xMin, double xMax, PlaneHit const*& first, PlaneHit const*& last) const
+{
+  std::vector<PlaneHit> const& hits = _planes[plane];
+  PlaneHit const* begin = hits.empty() ? 0 : &hits[0];
+  PlaneHit const* end = begin + hits.size();
+  first = std::lower_bound( begin, end, xMin, []( PlaneHit const& hit, double x ) { return hit.x < x; } );
+  last = std::upper_bound( first, end, xMax, []( double x, PlaneHit const& hit ) { return x < hit.x; } );
+}
+
+void EUTelTripletSearch::search(std::vector< std::vector<Hit> > const& hits)
+{
+  _nPlanes = static_cast<int>( hits.size() );
+  _tracks.clear();
+  _candidates.clear();
+  _upstream.clear();
+  _downstream.clear();
+  if( _nPlanes < 3 ) return;
+
+  _planes.resize( _nPlanes );
+  _planeZ.assign( _nPlanes, 0. );
+  _usedHits.resize( _nPlanes );
+  for( int plane = 0; plane < _nPlanes; ++plane ) {
+    std::vector<PlaneHit>& planeHits = _planes[plane];
+    planeHits.clear();
+    for( size_t i = 0; i < hits[plane].size(); ++i ) {
+      Hit const& hit = hits[plane][i];
+      PlaneHit planeHit = { hit.x, hit.y, hit.z, static_cast<int>(i) };
+      planeHits.push_back( planeHit );
+      _planeZ[plane] += hit.z;
+    }
+    if( !planeHits.empty() ) _planeZ[plane] /= planeHits.size();
+    std::sort( planeHits.begin(), planeHits.end(), []( PlaneHit const& a, PlaneHit const& b ) { return a.x < b.x; } );
+  }
+
+  for( int i = 0; i < 3; ++i ) {
+    _upstreamArm[i] = i;
+    _downstreamArm[i] = _nPlanes - 3 + i;
+  }
+  bool const twoArms = ( _nPlanes >= 6 );
+
+  findTriplets( _upstreamArm, _upstream );
+  if( twoArms ) {
+    findTriplets( _downstreamArm, _downstream );
+
+    // the downstream triplets sorted by their x in the middle of the telescope
+    double const zMatch = 0.5*( _planeZ[_upstreamArm[2]] + _planeZ[_downstreamArm[0]] );
+    _downstreamX.clear();
+    for( size_t i = 0; i < _downstream.size(); ++i ) {
+      Triplet const& triplet = _downstream[i];
+      _downstreamX.push_back( std::make_pair( triplet.x + triplet.tx*( zMatch - triplet.z ), static_cast<int>(i) ) );
+    }
+    std::sort( _downstreamX.begin(), _downstreamX.end() );
+
+    for( size_t i = 0; i < _upstream.size(); ++i ) {
+      Triplet const& up = _upstream[i];
+      double const xUp = up.x + up.tx*( zMatch - up.z );
+      double const yUp = up.y + up.ty*( zMatch - up.z );
+      std::vector< std::pair<double, int> >::iterator first =
+        std::lower_bound( _downstreamX.begin(), _downstreamX.end(), xUp - _matchCut, lessPairX );
+      std::vector< std::pair<double, int> >::iterator last =
+        std::upper_bound( first, _downstreamX.end(), xUp + _matchCut, lessX );
+      for( ; first != last; ++first ) {
+        Triplet const& down = _downstream[first->second];
+        double const yDown = down.y + down.ty*( zMatch - down.z );
+        if( std::abs( yDown - yUp ) > _matchCut ) continue;
+        if( std::abs( down.tx - up.tx ) > _matchSlopeCut || std::abs( down.ty - up.ty ) > _matchSlopeCut ) continue;
+        _candidates.push_back( Track() );
+        followTrack( up, &down, _candidates.back() );
+      }
+    }
+  } else {
+    for( size_t i = 0; i < _upstream.size(); ++i ) {
+      _candidates.push_back( Track() );
+      followTrack( _upstream[i], 0, _candidates.back() );
+    }
+  }
+
+  resolveAmbiguities();
+}
+
+void EUTelTripletSearch::findTriplets(int const arm[3], std::vector<Triplet>& triplets) const
+{
+  std::vector<PlaneHit> const& firstHits = _planes[arm[0]];
+  double const dzOuter = std::abs( _planeZ[arm[2]] - _planeZ[arm[0]] );
+  double const slopeWindow = _maxSlope*dzOuter;
+
+  for( size_t i = 0; i < firstHits.size(); ++i ) {
+    PlaneHit const& a = firstHits[i];
+    PlaneHit const* c = 0;
+    PlaneHit const* cEnd = 0;
+    window( arm[2], a.x - slopeWindow, a.x + slopeWindow, c, cEnd );
+    for( ; c != cEnd; ++c ) {
+      if( std::abs( c->y - a.y ) > slopeWindow ) continue;
+      double const dz = c->z - a.z;
+      if( dz == 0 ) continue;
+      double const tx = ( c->x - a.x )/dz;
+      double const ty = ( c->y - a.y )/dz;
+
+      // the middle hit has to be close to the line through the outer ones
+      double const xMiddle = a.x + tx*( _planeZ[arm[1]] - a.z );
+      PlaneHit const* b = 0;
+      PlaneHit const* bEnd = 0;
+      window( arm[1], xMiddle - _tripletCut, xMiddle + _tripletCut, b, bEnd );
+      for( ; b != bEnd; ++b ) {
+        double const dx = b->x - ( a.x + tx*( b->z - a.z ) );
+        double const dy = b->y - ( a.y + ty*( b->z - a.z ) );
+        if( std::abs(dx) > _tripletCut || std::abs(dy) > _tripletCut ) continue;
+        Triplet triplet = { { static_cast<int>(i), static_cast<int>( b - &_planes[arm[1]][0] ), static_cast<int>( c - &_planes[arm[2]][0] ) },
+                            b->x, b->y, b->z, tx, ty };
+        triplets.push_back( triplet );
+      }
+    }
+  }
+}
+
+void EUTelTripletSearch::followTrack(Triplet const& upstream, Triplet const* downstream, Track& track) const
+{
+  // hits fixed by the seeds, planes are visited in order so only these are set when a plane is reached
+  track.hits.assign( _nPlanes, -1 );
+  for( int i = 0; i < 3; ++i ) {
+    track.hits[_upstreamArm[i]] = upstream.hits[i];
+    if( downstream ) track.hits[_downstreamArm[i]] = downstream->hits[i];
+  }
+
+  double const variance = _resolution*_resolution;
+  double const scattering = _scatteringAngle*_scatteringAngle;
+  Line lineX = { 0., upstream.tx, variance, 0., unknownSlopeVariance };
+  Line lineY = { 0., upstream.ty, variance, 0., unknownSlopeVariance };
+  double z = 0.;
+  track.nHits = 0;
+  track.chi2 = 0.;
+
+  for( int plane = 0; plane < _nPlanes; ++plane ) {
+    if( track.hits[plane] >= 0 ) {
+      PlaneHit const* planeHit = &_planes[plane][track.hits[plane]];
+      if( track.nHits == 0 ) {
+        lineX.pos = planeHit->x;
+        lineY.pos = planeHit->y;
+      } else {
+        lineX.propagate( planeHit->z - z );
+        lineY.propagate( planeHit->z - z );
+        track.chi2 += lineX.update( planeHit->x, variance ) + lineY.update( planeHit->y, variance );
+      }
+      z = planeHit->z;
+      ++track.nHits;
+    } else if( !_planes[plane].empty() && track.nHits > 0 ) {
+      // the hit closest to the prediction, if it is compatible
+      lineX.propagate( _planeZ[plane] - z );
+      lineY.propagate( _planeZ[plane] - z );
+      z = _planeZ[plane];
+      double const windowX = std::sqrt( _extensionChi2Cut*( lineX.c00 + variance ) );
+      PlaneHit const* candidate = 0;
+      PlaneHit const* candidateEnd = 0;
+      window( plane, lineX.pos - windowX, lineX.pos + windowX, candidate, candidateEnd );
+      PlaneHit const* best = 0;
+      double bestChi2 = _extensionChi2Cut;
+      for( ; candidate != candidateEnd; ++candidate ) {
+        double const dz = candidate->z - z;
+        double const rx = candidate->x - ( lineX.pos + lineX.slope*dz );
+        double const ry = candidate->y - ( lineY.pos + lineY.slope*dz );
+        double const chi2 = rx*rx/( lineX.c00 + variance ) + ry*ry/( lineY.c00 + variance );
+        if( chi2 < bestChi2 ) {
+          bestChi2 = chi2;
+          best = candidate;
+        }
+      }
+      if( best ) {
+        lineX.propagate( best->z - z );
+        lineY.propagate( best->z - z );
+        z = best->z;
+        track.chi2 += lineX.update( best->x, variance ) + lineY.update( best->y, variance );
+        track.hits[plane] = static_cast<int>( best - &_planes[plane][0] );
+        ++track.nHits;
+      }
+    } else {
+      continue;
+    }
+    // the material of the plane
+    lineX.c11 += scattering;
+    lineY.c11 += scattering;
+  }
+  track.ndf = 2*track.nHits - 4;
+}
+
+void EUTelTripletSearch::resolveAmbiguities()
+{
+  _order.resize( _candidates.size() );
+  for( size_t i = 0; i < _order.size(); ++i ) _order[i] = i;
+  std::vector<Track> const& candidates = _candidates;
+  std::sort( _order.begin(), _order.end(), [&candidates]( size_t a, size_t b ) {
+      Track const& first = candidates[a];
+      Track const& second = candidates[b];
+      if( first.nHits != second.nHits ) return first.nHits > second.nHits;
+      double const firstChi2 = first.ndf > 0 ? first.chi2/first.ndf : 0.;
+      double const secondChi2 = second.ndf > 0 ? second.chi2/second.ndf : 0.;
+      if( firstChi2 != secondChi2 ) return firstChi2 < secondChi2;
+      return a < b;
+    } );
+
+  // candidates refer to the sorted hits, the tracks to the input
+  for( int plane = 0; plane < _nPlanes; ++plane ) _usedHits[plane].assign( _planes[plane].size(), 0 );
+  for( size_t i = 0; i < _order.size(); ++i ) {
+    Track const& candidate = _candidates[_order[i]];
+    bool free = true;
+    for( int plane = 0; plane < _nPlanes && free; ++plane ) {
+      if( candidate.hits[plane] >= 0 && _usedHits[plane][candidate.hits[plane]] ) free = false;
+    }
+    if( !free ) continue;
+    for( int plane = 0; plane < _nPlanes; ++plane ) {
+      if( candidate.hits[plane] >= 0 ) _usedHits[plane][candidate.hits[plane]] = 1;
+    }
+    _tracks.push_back( candidate );
+    for( int plane = 0; plane < _nPlanes; ++plane ) {
+      int& hit = _tracks.back().hits[plane];
+      if( hit >= 0 ) hit = _planes[plane][hit].index;
+    }
+  }
+}
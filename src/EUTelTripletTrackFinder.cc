@@ -0,0 +1,62 @@
+/*
+ *   This source code is part of the Eutelescope package of Marlin.
+ *   You are free to use this source files for your own development as
+ *   long as it stays in a public research context. You are not
+ *   allowed to use it for commercial purpose. You must put this
+ *   header with author names in all development based on this file.
+ *
+ */
+
+// eutelescope includes ".h"
+#include "EUTelTripletTrackFinder.h"
+#include "EUTELESCOPE.h"
+
+namespace eutelescope {
+
+    EUTelTripletTrackFinder::EUTelTripletTrackFinder() : EUTelTrackFinder("TripletTrackFinder"),
+                                                         _search(),
+                                                         _hitPositions() { }
+
+    EUTelTripletTrackFinder::EUTelTripletTrackFinder( std::string name ) : EUTelTrackFinder(name),
+                                                                           _search(),
+                                                                           _hitPositions() { }
+
+    EUTelTripletTrackFinder::~EUTelTripletTrackFinder() {
+    }
+
+    EUTelTrackFinder::SearchResult EUTelTripletTrackFinder::DoTrackSearch() {
+        _trackCandidates.clear();
+        if( _allHits.size() < 3 ) {
+            streamlog_out( ERROR ) << "Track finder " << _name << " needs the hits of at least three planes, got "
+                                   << _allHits.size() << std::endl;
+            return kFailed;
+        }
+
+        _hitPositions.resize( _allHits.size() );
+        for( size_t plane = 0; plane < _allHits.size(); ++plane ) {
+            std::vector<EUTelTripletSearch::Hit>& positions = _hitPositions[plane];
+            positions.clear();
+            for( size_t i = 0; i < _allHits[plane].size(); ++i ) {
+                const double* position = _allHits[plane][i]->getPosition();
+                EUTelTripletSearch::Hit hit = { position[0], position[1], position[2] };
+                positions.push_back( hit );
+            }
+        }
+
+        _search.search( _hitPositions );
+
+        std::vector<EUTelTripletSearch::Track> const& tracks = _search.getTracks();
+        for( size_t iTrack = 0; iTrack < tracks.size(); ++iTrack ) {
+            EVENT::TrackerHitVec candidate;
+            for( size_t plane = 0; plane < tracks[iTrack].hits.size(); ++plane ) {
+                int const hit = tracks[iTrack].hits[plane];
+                if( hit >= 0 ) candidate.push_back( _allHits[plane][hit] );
+            }
+            _trackCandidates.push_back( candidate );
+        }
+        streamlog_out( DEBUG1 ) << "Track finder " << _name << " found " << _trackCandidates.size() << " tracks" << std::endl;
+
+        return kSuccess;
+    }
+
+}
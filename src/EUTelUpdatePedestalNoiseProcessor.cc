@@ -15,6 +15,8 @@
 #include "EUTELESCOPE.h"
 #include "EUTelEventImpl.h"
 #include "EUTelRunHeaderImpl.h"
+#include "EUTelPixelAccumulator.h"
+#include "EUTelPedestalTracker.h"
 
 // marlin includes ".h"
 #include "marlin/Processor.h"
@@ -27,6 +29,7 @@
 #include <AIDA/IMeasurement.h>
 
 #include <AIDA/IHistogramFactory.h>
+#include <AIDA/IHistogram1D.h>
 #endif
 
 // lcio includes <.h>
@@ -40,6 +43,7 @@
 #include <cmath>
 #include <memory>
 #include <cstdlib>
+#include <sstream>
 
 using namespace std;
 using namespace marlin;
@@ -60,6 +64,9 @@ EUTelUpdatePedestalNoiseProcessor::EUTelUpdatePedestalNoiseProcessor ()
   _monitoredPixelNoise(),
   _updateFrequency(0),
   _fixedWeight(0),
+  _hitRejectionCut(0.),
+  _trackerMap(),
+  _driftMap(),
   _iRun(0),
   _iEvt(0),
   _noOfConsecutiveMissing(0){
@@ -94,9 +101,13 @@ EUTelUpdatePedestalNoiseProcessor::EUTelUpdatePedestalNoiseProcessor ()
                              _updateFrequency, static_cast<int>(10));
 
   registerOptionalParameter("FixedWeightValue",
-                            "The value of the fixed weight (only for fixed weight algorithm",
+                            "The value of the fixed weight (fixed weight algorithm) or the time constant in events (exponential weight algorithm)",
                             _fixedWeight, static_cast<int>(100));
 
+  registerOptionalParameter("HitRejectionCut",
+                            "Threshold of pixel SNR for hit rejection (only for exponential weight algorithm)",
+                            _hitRejectionCut, static_cast<float>(3.5));
+
   IntVec monitorPixelExample;
   monitorPixelExample.push_back(0);
   monitorPixelExample.push_back(10);
@@ -114,7 +125,7 @@ void EUTelUpdatePedestalNoiseProcessor::init () {
   // usually a good idea to
   printParameters ();
 
-  if ( _updateAlgo == EUTELESCOPE::FIXEDWEIGHT ) {
+  if ( _updateAlgo == EUTELESCOPE::FIXEDWEIGHT || _updateAlgo == EUTELESCOPE::EXPONENTIALWEIGHT ) {
     if ( _fixedWeight <= 0 ) {
       throw InvalidParameterException("FixedWeightValue has to be a positive integer number");
     }
@@ -132,6 +143,8 @@ void EUTelUpdatePedestalNoiseProcessor::init () {
   // reset vectors
   _monitoredPixelPedestal.clear();
   _monitoredPixelNoise.clear();
+  _trackerMap.clear();
+  _driftMap.clear();
 
 #ifdef MARLINDEBUG
   vector<int >::iterator iter = _monitoredPixel.begin();
@@ -213,7 +226,13 @@ void EUTelUpdatePedestalNoiseProcessor::processEvent (LCEvent * event) {
 
 
 
-  if ( _iEvt % _updateFrequency == 0 ) {
+  if ( _updateAlgo == EUTELESCOPE::EXPONENTIALWEIGHT ) {
+
+    // the tracker follows every event, only the snapshots are
+    // published with the update frequency
+    trackPedestal(evt, _iEvt % _updateFrequency == 0 );
+
+  } else if ( _iEvt % _updateFrequency == 0 ) {
 
     if ( _updateAlgo == EUTELESCOPE::FIXEDWEIGHT )
       fixedWeightUpdate(evt);
@@ -284,15 +303,73 @@ void EUTelUpdatePedestalNoiseProcessor::fixedWeightUpdate(LCEvent * evt) {
       TrackerDataImpl    * noise    = dynamic_cast < TrackerDataImpl * >    (noiseCollection->getElementAt(iDetector));
       TrackerDataImpl    * pedestal = dynamic_cast < TrackerDataImpl * >    (pedestalCollection->getElementAt(iDetector));
 
-      for (unsigned int iPixel = 0; iPixel < status->adcValues().size(); iPixel++) {
+      // only the good pixels are updated
+      eutelescope::fixedWeightUpdate( status->adcValues().size(), &rawData->getADCValues()[0], &status->adcValues()[0],
+                         _fixedWeight, &pedestal->chargeValues()[0], &noise->chargeValues()[0] );
+    }
+  }  catch ( DataNotAvailableException& e) {
+    if ( _noOfConsecutiveMissing <= _maxNoOfConsecutiveMissing ) {
+      streamlog_out( WARNING2 )  << "Collection not available in this event " << endl;
+      if ( _noOfConsecutiveMissing == _maxNoOfConsecutiveMissing ) {
+        streamlog_out ( MESSAGE2 ) << "Assuming the run was taken in ZS. Not issuing any other warning" << endl;
+      }
+      ++_noOfConsecutiveMissing;
+    }
+  }
 
-        if ( status->adcValues()[iPixel] == EUTELESCOPE::GOODPIXEL ) {
-          pedestal->chargeValues()[iPixel] = ( (_fixedWeight - 1) * pedestal->chargeValues()[iPixel] +
-                                               rawData->getADCValues()[iPixel] ) / _fixedWeight;
-          noise->chargeValues()[iPixel]    = sqrt( ( (_fixedWeight - 1) * pow( noise->chargeValues()[iPixel], 2 ) +
-                                                     pow( rawData->getADCValues()[iPixel] - pedestal->chargeValues()[iPixel], 2) ) /
-                                                   _fixedWeight );
-        }
+}
+
+
+
+void EUTelUpdatePedestalNoiseProcessor::trackPedestal(LCEvent * evt, bool publish) {
+
+  try {
+
+    LCCollectionVec * pedestalCollection = dynamic_cast < LCCollectionVec * > (evt->getCollection(_pedestalCollectionName));
+    LCCollectionVec * noiseCollection    = dynamic_cast < LCCollectionVec * > (evt->getCollection(_noiseCollectionName));
+    LCCollectionVec * statusCollection   = dynamic_cast < LCCollectionVec * > (evt->getCollection(_statusCollectionName));
+    LCCollectionVec * rawDataCollection  = dynamic_cast < LCCollectionVec * > (evt->getCollection(_rawDataCollectionName));
+    CellIDDecoder<TrackerRawDataImpl>      rawDataDecoder( rawDataCollection );
+
+    _noOfConsecutiveMissing = 0;
+
+    for (int i = 0; i < rawDataCollection->getNumberOfElements(); i++) {
+
+      TrackerRawDataImpl * rawData  = dynamic_cast < TrackerRawDataImpl * > (rawDataCollection->getElementAt(i));
+      int iDetector = static_cast<int > ( rawDataDecoder( rawData )["sensorID"] ) ;
+
+      TrackerRawDataImpl * status   = dynamic_cast < TrackerRawDataImpl * > (statusCollection->getElementAt(iDetector));
+      TrackerDataImpl    * noise    = dynamic_cast < TrackerDataImpl * >    (noiseCollection->getElementAt(iDetector));
+      TrackerDataImpl    * pedestal = dynamic_cast < TrackerDataImpl * >    (pedestalCollection->getElementAt(iDetector));
+
+      // the pedestal and noise found with the first event are the
+      // starting point and the reference for the drift
+      EUTelPedestalTracker & tracker = _trackerMap[ iDetector ];
+      if ( tracker.size() == 0 ) {
+        tracker.start( pedestal->chargeValues().size(), &pedestal->chargeValues()[0], &noise->chargeValues()[0],
+                       _fixedWeight, _hitRejectionCut );
+      }
+
+      if ( tracker.size() != rawData->getADCValues().size() ||
+           tracker.size() != status->getADCValues().size() ) {
+        stringstream ss;
+        ss << "Input data and pedestal are incompatible\n"
+           << "Detector " << iDetector << " has " << rawData->getADCValues().size() << " pixels in the input data \n"
+           << "while " << tracker.size() << " in the pedestal data " << endl;
+        throw IncompatibleDataSetException(ss.str());
+      }
+
+      tracker.update( &rawData->getADCValues()[0], &status->getADCValues()[0] );
+
+      if ( publish ) {
+        tracker.snapshot( &pedestal->chargeValues()[0], &noise->chargeValues()[0] );
+
+        EUTelPedestalDrift drift = tracker.getDrift();
+        _driftMap[ iDetector ].push_back( drift );
+        streamlog_out( MESSAGE4 ) << "Detector " << iDetector << " after " << drift.noOfEvents << " events: pedestal shift "
+                                  << drift.meanShift << " +/- " << drift.rmsShift << " (max " << drift.maxShift << "), noise ratio "
+                                  << drift.meanNoiseRatio << ", " << drift.noOfDriftedPixel << " drifted pixels, "
+                                  << 100 * drift.updatedFraction << "% of the pixels updated" << endl;
       }
     }
   }  catch ( DataNotAvailableException& e) {
@@ -307,10 +384,54 @@ void EUTelUpdatePedestalNoiseProcessor::fixedWeightUpdate(LCEvent * evt) {
 
 }
 
+#if defined(USE_AIDA) || defined(MARLIN_USE_AIDA)
+void EUTelUpdatePedestalNoiseProcessor::saveDrift() {
+
+  map< int, vector< EUTelPedestalDrift > >::iterator iter = _driftMap.begin();
+  while ( iter != _driftMap.end() ) {
+    int noOfSnapshot = iter->second.size();
+    string shiftName = "MeanPedestalShift_d" + to_string( iter->first );
+    string ratioName = "MeanNoiseRatio_d" + to_string( iter->first );
+
+    AIDA::IHistogram1D * shiftHisto =
+      AIDAProcessor::histogramFactory(this)->createHistogram1D( shiftName.c_str(), noOfSnapshot, -0.5, noOfSnapshot - 0.5 );
+    AIDA::IHistogram1D * ratioHisto =
+      AIDAProcessor::histogramFactory(this)->createHistogram1D( ratioName.c_str(), noOfSnapshot, -0.5, noOfSnapshot - 0.5 );
+    if ( !shiftHisto || !ratioHisto ) {
+      streamlog_out ( ERROR1 ) << "Problem booking the drift histograms of detector " << iter->first << ".\n"
+                               << "Continuing without them" << endl;
+      return;
+    }
+    shiftHisto->setTitle( "Mean pedestal shift vs snapshot" );
+    ratioHisto->setTitle( "Mean noise ratio vs snapshot" );
 
+    for ( int iSnapshot = 0; iSnapshot < noOfSnapshot; ++iSnapshot ) {
+      shiftHisto->fill( iSnapshot, iter->second[iSnapshot].meanShift );
+      ratioHisto->fill( iSnapshot, iter->second[iSnapshot].meanNoiseRatio );
+    }
+    ++iter;
+  }
+
+}
+#endif
 
 void EUTelUpdatePedestalNoiseProcessor::end() {
 
+  if ( !_driftMap.empty() ) {
+    map< int, vector< EUTelPedestalDrift > >::iterator iter = _driftMap.begin();
+    while ( iter != _driftMap.end() ) {
+      const EUTelPedestalDrift & drift = iter->second.back();
+      streamlog_out( MESSAGE5 ) << "Detector " << iter->first << ": " << iter->second.size() << " snapshots, final pedestal shift "
+                                << drift.meanShift << " +/- " << drift.rmsShift << " (max " << drift.maxShift << "), noise ratio "
+                                << drift.meanNoiseRatio << ", " << drift.noOfDriftedPixel << " drifted pixels" << endl;
+      ++iter;
+    }
+#if defined(USE_AIDA) || defined(MARLIN_USE_AIDA)
+    saveDrift();
+#endif
+  }
+
+
   if ( _monitoredPixelPedestal.size() == 0 ) {
     streamlog_out( ERROR5 ) <<  "The update procedure failed." << endl;
   } else {
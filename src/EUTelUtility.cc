@@ -175,9 +175,12 @@ namespace eutelescope {
             streamlog_out( DEBUG ) << "FillNotExcludedPlanesIndices" << std::endl;
         }
         
-        bool HitContainsHotPixels( const IMPL::TrackerHitImpl* hit, const std::map<std::string, bool >& hotPixelMap ) {
+        bool HitContainsHotPixels( const IMPL::TrackerHitImpl* hit, const EUTelHotPixelMask& hotPixelMask ) {
             bool skipHit = false;
 
+            // if no hot pixel map was loaded, just return here
+            if( hotPixelMask.empty() ) return false;
+
             try {
                 try {
                     LCObjectVec clusterVector = hit->getRawHits();
@@ -198,19 +201,10 @@ namespace eutelescope {
                         for (unsigned int iPixel = 0; iPixel < cluster->size(); iPixel++) {
                             EUTelGenericSparsePixel m26Pixel;
                             cluster->getSparsePixelAt(iPixel, &m26Pixel);
-                            {
-                                char ix[100];
-                                sprintf(ix, "%d,%d,%d", sensorID, m26Pixel.getXCoord(), m26Pixel.getYCoord());
-                                std::map < std::string, bool >::const_iterator z = hotPixelMap.find(ix);
-                                if (z != hotPixelMap.end() && hotPixelMap.at(ix) == true) {
-                                    skipHit = true;
-                                    streamlog_out(DEBUG3) << "Skipping hit as it was found in the hot pixel map." << std::endl;
-                                    break;
-//                                    delete cluster;
-//                                    return true; // if TRUE  this hit will be skipped
-                                } else {
-                                    skipHit = false;
-                                }
+                            if (hotPixelMask.isHot(sensorID, m26Pixel.getXCoord(), m26Pixel.getYCoord())) {
+                                skipHit = true;
+                                streamlog_out(DEBUG3) << "Skipping hit as it was found in the hot pixel map." << std::endl;
+                                break;
                             }
                         }
                         delete cluster;
@@ -302,19 +296,29 @@ namespace eutelescope {
             return -1;
         }     
  
-        std::map<std::string, bool > FillHotPixelMap( EVENT::LCEvent *event, const std::string& hotPixelCollectionName ) {
+        /**
+         * Reads the hot pixel collection into a per sensor bitmask. This is the
+         * loader shared by all processors which skip hits with hot pixels.
+         *
+         * @param event event holding the hot pixel collection
+         * @param hotPixelCollectionName name of the collection
+         * @return the mask, empty if the collection is not available
+         */
+        EUTelHotPixelMask FillHotPixelMask( EVENT::LCEvent *event, const std::string& hotPixelCollectionName ) {
             
-            std::map < std::string, bool > hotPixelMap;
+            EUTelHotPixelMask hotPixelMask;
+            if( hotPixelCollectionName.empty() ) return hotPixelMask;
             
             LCCollectionVec *hotPixelCollectionVec = 0;
             try {
                 hotPixelCollectionVec = static_cast<LCCollectionVec*> (event->getCollection(hotPixelCollectionName));
             } catch (...) {
-                streamlog_out( MESSAGE4 ) << "hotPixelCollectionName " << hotPixelCollectionName.c_str() << " not found" << std::endl;
-                return hotPixelMap;
+                streamlog_out( WARNING4 ) << "hotPixelCollectionName " << hotPixelCollectionName.c_str() << " not found" << std::endl;
+                return hotPixelMask;
             }
 
             CellIDDecoder<TrackerDataImpl> cellDecoder(hotPixelCollectionVec);
+            std::map<int, std::vector<std::pair<int, int> > > hotPixels;
 
             for (int i = 0; i < hotPixelCollectionVec -> getNumberOfElements(); i++) {
                 TrackerDataImpl* hotPixelData = dynamic_cast<TrackerDataImpl*> (hotPixelCollectionVec->getElementAt(i));
@@ -324,26 +328,21 @@ namespace eutelescope {
 
                 if (type == kEUTelGenericSparsePixel) {
                     std::unique_ptr<EUTelSparseClusterImpl<EUTelGenericSparsePixel>> m26Data = std::make_unique<EUTelSparseClusterImpl<EUTelGenericSparsePixel>>(hotPixelData);
-                    std::vector<EUTelGenericSparsePixel*> m26PixelVec;
                     EUTelGenericSparsePixel m26Pixel;
 
-                    //Push all single Pixels of one plane in the m26PixelVec
                     for (unsigned int iPixel = 0; iPixel < m26Data->size(); iPixel++) {
-                        std::vector<int> m26ColVec();
                         m26Data->getSparsePixelAt(iPixel, &m26Pixel);
                         streamlog_out(DEBUG0) << iPixel << " of " << m26Data->size() << " HotPixelInfo:  " << m26Pixel.getXCoord() << " " << m26Pixel.getYCoord() << " " << m26Pixel.getSignal() << std::endl;
-                        try {
-                            char ix[100];
-                            sprintf(ix, "%d,%d,%d", sensorID, m26Pixel.getXCoord(), m26Pixel.getYCoord());
-                            hotPixelMap[ix] = true;
-                        } catch (...) {
-                            std::cout << "can not add pixel " << std::endl;
-                            std::cout << sensorID << " " << m26Pixel.getXCoord() << " " << m26Pixel.getYCoord() << " " << std::endl;
-                        }
+                        hotPixels[sensorID].push_back( std::make_pair(m26Pixel.getXCoord(), m26Pixel.getYCoord()) );
                     }
                 }
             }
-            return hotPixelMap;
+
+            for (std::map<int, std::vector<std::pair<int, int> > >::const_iterator it = hotPixels.begin(); it != hotPixels.end(); ++it) {
+                hotPixelMask.setHotPixels(it->first, it->second);
+            }
+            streamlog_out( MESSAGE4 ) << hotPixelMask.size() << " hot pixels read from " << hotPixelCollectionName << std::endl;
+            return hotPixelMask;
         }
 
         /** Highland's formula for multiple scattering 
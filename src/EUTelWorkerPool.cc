@@ -0,0 +1,102 @@
+/*
+ *   This source code is part of the Eutelescope package of Marlin.
+ *   You are free to use this source files for your own development as
+ *   long as it stays in a public research context. You are not
+ *   allowed to use it for commercial purpose. You must put this
+ *   header with author names in all development based on this file.
+ *
+ */
+
+// eutelescope includes ".h"
+#include "EUTelWorkerPool.h"
+
+using namespace eutelescope;
+
+EUTelWorkerPool::EUTelWorkerPool(int nThreads):
+  _threads(),
+  _mutex(),
+  _start(),
+  _done(),
+  _task(0),
+  _nTasks(0),
+  _next(0),
+  _busy(0),
+  _batch(0),
+  _stop(false),
+  _error()
+{
+  for( int thread = 1; thread < nThreads; ++thread ) {
+    _threads.push_back( std::thread( &EUTelWorkerPool::work, this, thread ) );
+  }
+}
+
+EUTelWorkerPool::~EUTelWorkerPool()
+{
+  {
+    std::lock_guard<std::mutex> lock( _mutex );
+    _stop = true;
+  }
+  _start.notify_all();
+  for( size_t i = 0; i < _threads.size(); ++i ) _threads[i].join();
+}
+
+void EUTelWorkerPool::run(size_t nTasks, Task const& task)
+{
+  if( _threads.empty() ) {
+    for( size_t i = 0; i < nTasks; ++i ) task( i, 0 );
+    return;
+  }
+  if( nTasks == 0 ) return;
+
+  {
+    std::lock_guard<std::mutex> lock( _mutex );
+    _task = &task;
+    _nTasks = nTasks;
+    _next = 0;
+    _busy = static_cast<int>( _threads.size() );
+    _error = std::exception_ptr();
+    ++_batch;
+  }
+  _start.notify_all();
+
+  process( 0 );
+
+  std::exception_ptr error;
+  {
+    std::unique_lock<std::mutex> lock( _mutex );
+    _done.wait( lock, [this]{ return _busy == 0; } );
+    _task = 0;
+    error = _error;
+  }
+  if( error ) std::rethrow_exception( error );
+}
+
+void EUTelWorkerPool::work(int thread)
+{
+  unsigned long lastBatch = 0;
+  for( ;; ) {
+    {
+      std::unique_lock<std::mutex> lock( _mutex );
+      _start.wait( lock, [this, lastBatch]{ return _stop || _batch != lastBatch; } );
+      if( _stop ) return;
+      lastBatch = _batch;
+    }
+
+    process( thread );
+
+    std::lock_guard<std::mutex> lock( _mutex );
+    if( --_busy == 0 ) _done.notify_one();
+  }
+}
+
+void EUTelWorkerPool::process(int thread)
+{
+  for( size_t i = _next++; i < _nTasks; i = _next++ ) {
+    try {
+      ( *_task )( i, thread );
+    } catch( ... ) {
+      std::lock_guard<std::mutex> lock( _mutex );
+      if( !_error ) _error = std::current_exception();
+    }
+  }
+}
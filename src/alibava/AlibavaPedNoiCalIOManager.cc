@@ -24,6 +24,7 @@
 #include <IMPL/TrackerDataImpl.h>
 
 // system includes <>
+#include <map>
 #include <string>
 #include <sys/stat.h>
 
@@ -130,6 +131,14 @@ void AlibavaPedNoiCalIOManager::createFile(string filename, IMPL::LCRunHeaderImp
 
 void AlibavaPedNoiCalIOManager::addToFile( string filename, string collectionName, int chipnum, EVENT::FloatVec datavec){
 
+	CollectionData data;
+	data[collectionName][chipnum] = datavec;
+	addToFile(filename, data);
+
+}
+
+void AlibavaPedNoiCalIOManager::addToFile( string filename, const CollectionData& data){
+
 	// if file doesn't exist
 	if (!doesFileExist(filename)) {
 		streamlog_out( WARNING5 ) << " The AlibavaPedNoiCalFile: "<<filename<<" doesn't exist. "<< endl ;
@@ -141,9 +150,6 @@ void AlibavaPedNoiCalIOManager::addToFile( string filename, string collectionNam
 	LCRunHeaderImpl* runHeader = getRunHeader(filename);
 	LCEventImpl*  evt = getEvent(filename);
 	
-	FloatVec tmp_vec;
-	tmp_vec.clear();
-		
 	LCWriter * lcWriter = LCFactory::getInstance()->createLCWriter();
 	// we will write a new lcio file with the copied run header and event
 	try {
@@ -152,38 +158,46 @@ void AlibavaPedNoiCalIOManager::addToFile( string filename, string collectionNam
 		// first write runheader
 		lcWriter->writeRunHeader(runHeader);
 		
-		// check if the collection exists
-		LCCollectionVec* newCol = new LCCollectionVec(LCIO::TRACKERDATA);
+		CollectionData::const_iterator colIter;
+		for (colIter = data.begin(); colIter != data.end(); ++colIter) {
+			const string & collectionName = colIter->first;
 
+			// check if the collection exists
+			LCCollectionVec* newCol = new LCCollectionVec(LCIO::TRACKERDATA);
 
-		if (doesCollectionExist(evt,collectionName)){
-			LCCollectionVec* col = dynamic_cast < LCCollectionVec * > (evt->getCollection(collectionName));
-			*newCol = *col;
-			evt->removeCollection(collectionName);
-		}
+			if (doesCollectionExist(evt,collectionName)){
+				LCCollectionVec* col = dynamic_cast < LCCollectionVec * > (evt->getCollection(collectionName));
+				*newCol = *col;
+				evt->removeCollection(collectionName);
+			}
 
-		// check if the data exists for this chip in this event
-		// if exists remove it
-		int ielement=0;
-		do {
-			ielement= getElementNumberOfChip(newCol,chipnum);
-			if (ielement!=-1)
-				newCol->removeElementAt(ielement);
-		} while (ielement!=-1);
-
-				
-		// now, add data vector to the collecton
-		TrackerDataImpl * tmp_data = new TrackerDataImpl();
-		tmp_data->setChargeValues(datavec);
-		
-		// set Cell ID encode
-		CellIDEncoder<TrackerDataImpl> chipIDEncoder(ALIBAVA::ALIBAVADATA_ENCODE,newCol);
-		
-		chipIDEncoder[ALIBAVA::ALIBAVADATA_ENCODE_CHIPNUM] = chipnum;
-		chipIDEncoder.setCellID(tmp_data);
+			map< int, FloatVec >::const_iterator chipIter;
+			for (chipIter = colIter->second.begin(); chipIter != colIter->second.end(); ++chipIter) {
+				int chipnum = chipIter->first;
+
+				// check if the data exists for this chip in this event
+				// if exists remove it
+				int ielement=0;
+				do {
+					ielement= getElementNumberOfChip(newCol,chipnum);
+					if (ielement!=-1)
+						newCol->removeElementAt(ielement);
+				} while (ielement!=-1);
+
+				// now, add data vector to the collecton
+				TrackerDataImpl * tmp_data = new TrackerDataImpl();
+				tmp_data->setChargeValues(chipIter->second);
 
-		newCol->push_back(tmp_data);
-		evt->addCollection(newCol, collectionName);
+				// set Cell ID encode
+				CellIDEncoder<TrackerDataImpl> chipIDEncoder(ALIBAVA::ALIBAVADATA_ENCODE,newCol);
+
+				chipIDEncoder[ALIBAVA::ALIBAVADATA_ENCODE_CHIPNUM] = chipnum;
+				chipIDEncoder.setCellID(tmp_data);
+
+				newCol->push_back(tmp_data);
+			}
+			evt->addCollection(newCol, collectionName);
+		}
 		
 		lcWriter->writeEvent(evt);
 		lcWriter->close();
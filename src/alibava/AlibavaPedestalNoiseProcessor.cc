@@ -13,6 +13,9 @@
 #include "ALIBAVA.h"
 #include "AlibavaPedNoiCalIOManager.h"
 
+// eutelescope includes ".h"
+#include "EUTelWorkerPool.h"
+
 // marlin includes ".h"
 #include "marlin/Processor.h"
 #include "marlin/Exceptions.h"
@@ -39,12 +42,19 @@
 #include "TROOT.h"
 #include "TCanvas.h"
 #include "TSystem.h"
+#include "Math/MinimizerOptions.h"
+#include "Fit/DataRange.h"
+#include "HFitInterface.h"
+#include "Foption.h"
 
 // system includes <>
 #include <string>
 #include <iostream>
 #include <sstream>
 #include <memory>
+#include <cmath>
+#include <algorithm>
+#include <thread>
 
 
 using namespace std;
@@ -52,6 +62,44 @@ using namespace lcio;
 using namespace marlin;
 using namespace alibava;
 
+namespace {
+
+	// mean and sigma of a histogram within nSigma sigma of the mean, iterated until the range
+	// does not change. sigma is corrected for the tails of a gaussian which are cut away.
+	void trimmedMoments(TH1D * histo, double nSigma, double & mean, double & sigma) {
+		mean = histo->GetMean();
+		sigma = histo->GetRMS();
+		if (sigma <= 0 || nSigma <= 0) return;
+
+		// the RMS of a gaussian within +-k sigma is sigma*sqrt(1 - 2k phi(k)/erf(k/sqrt2))
+		const double phi = exp(-0.5*nSigma*nSigma) / sqrt(2*M_PI);
+		const double truncation = 1 - 2*nSigma*phi / erf(nSigma/sqrt(2.));
+		const double correction = (truncation > 0) ? 1/sqrt(truncation) : 1;
+
+		int firstBin = 0, lastBin = -1;
+		for (int iteration=0; iteration<10; iteration++) {
+			int newFirstBin = max(histo->FindFixBin(mean - nSigma*sigma), 1);
+			int newLastBin = min(histo->FindFixBin(mean + nSigma*sigma), histo->GetNbinsX());
+			if (newFirstBin == firstBin && newLastBin == lastBin) break;
+			firstBin = newFirstBin;
+			lastBin = newLastBin;
+
+			double sum = 0, sumx = 0, sumx2 = 0;
+			for (int ibin=firstBin; ibin<=lastBin; ibin++) {
+				double n = histo->GetBinContent(ibin);
+				double x = histo->GetBinCenter(ibin);
+				sum += n;
+				sumx += n*x;
+				sumx2 += n*x*x;
+			}
+			if (sum <= 0) return;
+			mean = sumx/sum;
+			sigma = sqrt(max(sumx2/sum - mean*mean, 0.)) * correction;
+			if (sigma <= 0) return;
+		}
+	}
+}
+
 
 AlibavaPedestalNoiseProcessor::AlibavaPedestalNoiseProcessor () :
 AlibavaBaseProcessor("AlibavaPedestalNoiseProcessor"),
@@ -59,7 +107,12 @@ _pedestalHistoName ("hpedestal"),
 _noiseHistoName ("hnoise"),
 _temperatureHistoName("htemperature"),
 _chanDataHistoName ("Data_chan"),
-_chanDataFitName ("Fit_chan")
+_chanDataFitName ("Fit_chan"),
+_calculationMethod("Fit"),
+_trimSigma(3.0),
+_nThreads(1),
+_chanDataAccumulator(),
+_chanWeight()
 {
 	
 	// modify processor description
@@ -85,6 +138,18 @@ _chanDataFitName ("Fit_chan")
 										"Noise collection name, better not to change",
 										_noiseCollectionName, string ("noise"));
 
+	registerOptionalParameter ("CalculationMethod",
+										"The method used to calculate pedestal and noise: Fit (gaussian fit of each channel), Moments (mean and RMS of each channel) or TrimmedMoments (mean and RMS within TrimSigma sigma)",
+										_calculationMethod, string ("Fit"));
+
+	registerOptionalParameter ("TrimSigma",
+										"The range in sigma around the mean used by the TrimmedMoments method",
+										_trimSigma, float (3.0));
+
+	registerOptionalParameter ("NumberOfThreads",
+										"Number of threads fitting the channels, 0 for one per core",
+										_nThreads, int (1));
+
 }
 
 
@@ -112,6 +177,19 @@ void AlibavaPedestalNoiseProcessor::init () {
 	else {
 		streamlog_out ( MESSAGE4 ) << "The Global Parameter "<< ALIBAVA::SKIPMASKEDEVENTS <<" is not set! Masked events will be used!" << endl;
 	}
+
+	if (_calculationMethod != "Fit" && _calculationMethod != "Moments" && _calculationMethod != "TrimmedMoments") {
+		streamlog_out ( ERROR5 ) << "Unknown CalculationMethod "<< _calculationMethod <<", the channels will be fitted" << endl;
+		_calculationMethod = "Fit";
+	}
+	if (_nThreads <= 0)
+		_nThreads = max(1u, thread::hardware_concurrency());
+
+	// the fits of several threads need the locks of ROOT, they have to
+	// be enabled before any histogram or function is created
+	if (_nThreads > 1 && _calculationMethod == "Fit")
+		ROOT::EnableThreadSafety();
+
 	// this method is called only once even when the rewind is active
 	// usually a good idea to
 	printParameters ();
@@ -130,6 +208,10 @@ void AlibavaPedestalNoiseProcessor::processRunHeader (LCRunHeader * rdr) {
 	
 	bookHistos();
 
+	// the moments are accumulated again for every run
+	_chanDataAccumulator.clear();
+	_chanWeight.clear();
+
 	// set number of skipped events to zero (defined in AlibavaBaseProcessor)
 	_numberOfSkippedEvents = 0;
 
@@ -187,44 +269,121 @@ void AlibavaPedestalNoiseProcessor::end() {
 }
 
 void AlibavaPedestalNoiseProcessor::calculatePedestalNoise(){
-	string tempHistoName,tempFitName;
 	TCanvas *cc = new TCanvas("cc","cc",800,600);
 	
+	// pedestal and noise of each chip, masked channels are left to 0
+	AlibavaPedNoiCalIOManager::CollectionData data;
+	map<int, FloatVec> & pedestalMap = data[_pedestalCollectionName];
+	map<int, FloatVec> & noiseMap = data[_noiseCollectionName];
+
 	EVENT::IntVec chipSelection = getChipSelection();
+	for (unsigned int i=0; i<chipSelection.size(); i++) {
+		unsigned int ichip=chipSelection[i];
+		pedestalMap[ichip].assign(ALIBAVA::NOOFCHANNELS, 0);
+		noiseMap[ichip].assign(ALIBAVA::NOOFCHANNELS, 0);
+	}
+
+	if (_calculationMethod == "Fit")
+		fitPedestalNoise(pedestalMap, noiseMap);
+	else
+		momentsPedestalNoise(pedestalMap, noiseMap);
+
 	for (unsigned int i=0; i<chipSelection.size(); i++) {
 		unsigned int ichip=chipSelection[i];
 		
 		TH1D * hped = dynamic_cast<TH1D*> (_rootObjectMap[getPedestalHistoName(ichip)]);
 		TH1D * hnoi = dynamic_cast<TH1D*> (_rootObjectMap[getNoiseHistoName(ichip)]);
-		EVENT::FloatVec pedestalVec,noiseVec;
-		
-		
 		for (int ichan=0; ichan<ALIBAVA::NOOFCHANNELS; ichan++) {
-			double ped, noi;
-			// if channel is masked, set pedestal and noise to 0
-			if (isMasked(ichip,ichan)){
-				ped=0; noi=0;
+			if (isMasked(ichip,ichan)) continue;
+			hped->SetBinContent(ichan+1,pedestalMap[ichip][ichan]);
+			hnoi->SetBinContent(ichan+1,noiseMap[ichip][ichan]);
+		}
+	}
+
+	// both collections of all chips are written with a single copy of the file
+	AlibavaPedNoiCalIOManager man;
+	man.addToFile(_pedestalFile, data);
+	delete cc;
+}
+
+void AlibavaPedestalNoiseProcessor::fitPedestalNoise(map<int, FloatVec> & pedestalMap, map<int, FloatVec> & noiseMap){
+
+	// the histograms, fits and results are looked up in the maps here,
+	// since the maps can not be used by several threads
+	struct ChannelFit {
+		TH1D * histo;
+		TF1 * fit;
+		float * pedestal;
+		float * noise;
+	};
+	vector<ChannelFit> fits;
+
+	EVENT::IntVec chipSelection = getChipSelection();
+	for (unsigned int i=0; i<chipSelection.size(); i++) {
+		unsigned int ichip=chipSelection[i];
+		for (int ichan=0; ichan<ALIBAVA::NOOFCHANNELS; ichan++) {
+			if (isMasked(ichip,ichan)) continue;
+			ChannelFit channelFit;
+			channelFit.histo = dynamic_cast<TH1D*> (_rootObjectMap[getChanDataHistoName(ichip, ichan)]);
+			channelFit.fit = dynamic_cast<TF1*> (_rootObjectMap[getChanDataFitName(ichip, ichan)]);
+			channelFit.pedestal = &pedestalMap[ichip][ichan];
+			channelFit.noise = &noiseMap[ichip][ichan];
+			fits.push_back(channelFit);
+		}
+	}
+
+	// the default minimizer of ROOT keeps a global state, Minuit2 can
+	// run in several threads at once. It is chosen for these fits only,
+	// the default of the job is left as it is. The fits are not drawn then.
+	Foption_t fitOption;
+	ROOT::Math::MinimizerOptions minimizerOptions;
+	if (_nThreads > 1) {
+		ROOT::Fit::FitOptionsMake(ROOT::Fit::EFitObjectType::kHistogram, "Q0", fitOption);
+		minimizerOptions.SetMinimizerType("Minuit2");
+	}
+	else
+		ROOT::Fit::FitOptionsMake(ROOT::Fit::EFitObjectType::kHistogram, "Q", fitOption);
+
+	eutelescope::EUTelWorkerPool pool(min<int>(_nThreads, max<size_t>(fits.size(), 1)));
+	pool.run(fits.size(), [&](size_t ifit, int) {
+		ChannelFit & channelFit = fits[ifit];
+		// FitObject takes the options by reference, each fit gets its own copy
+		Foption_t channelOption = fitOption;
+		ROOT::Fit::DataRange range;
+		ROOT::Fit::FitObject(channelFit.histo, channelFit.fit, channelOption, minimizerOptions, "", range);
+		*channelFit.pedestal = channelFit.fit->GetParameter(1);
+		*channelFit.noise = channelFit.fit->GetParameter(2);
+	});
+}
+
+void AlibavaPedestalNoiseProcessor::momentsPedestalNoise(map<int, FloatVec> & pedestalMap, map<int, FloatVec> & noiseMap){
+
+	EVENT::IntVec chipSelection = getChipSelection();
+	for (unsigned int i=0; i<chipSelection.size(); i++) {
+		unsigned int ichip=chipSelection[i];
+
+		FloatVec mean, sigma;
+		if (_calculationMethod == "Moments") {
+			mean = _chanDataAccumulator[ichip].getMean();
+			sigma = _chanDataAccumulator[ichip].getSigma();
+		}
+
+		for (int ichan=0; ichan<ALIBAVA::NOOFCHANNELS; ichan++) {
+			if (isMasked(ichip,ichan)) continue;
+			if (_calculationMethod == "Moments") {
+				if (size_t(ichan) >= mean.size()) continue;
+				pedestalMap[ichip][ichan] = mean[ichan];
+				noiseMap[ichip][ichan] = sigma[ichan];
 			}
 			else {
-				tempFitName = getChanDataFitName(ichip, ichan);
-				tempHistoName = getChanDataHistoName(ichip, ichan);
-				TH1D * histo = dynamic_cast<TH1D*> (_rootObjectMap[tempHistoName]);
-				TF1 * tempfit = dynamic_cast<TF1*> (_rootObjectMap[tempFitName]);
-				histo->Fit(tempfit,"Q");
-				ped = tempfit->GetParameter(1);
-				noi = tempfit->GetParameter(2);
-				hped->SetBinContent(ichan+1,ped);
-				hnoi->SetBinContent(ichan+1,noi);
+				TH1D * histo = dynamic_cast<TH1D*> (_rootObjectMap[getChanDataHistoName(ichip, ichan)]);
+				double ped, noi;
+				trimmedMoments(histo, _trimSigma, ped, noi);
+				pedestalMap[ichip][ichan] = ped;
+				noiseMap[ichip][ichan] = noi;
 			}
-			pedestalVec.push_back(ped);
-			noiseVec.push_back(noi);
 		}
-		
-		AlibavaPedNoiCalIOManager man;
-		man.addToFile(_pedestalFile,_pedestalCollectionName, ichip, pedestalVec);
-		man.addToFile(_pedestalFile,_noiseCollectionName, ichip, noiseVec);
 	}
-	delete cc;
 }
 
 string AlibavaPedestalNoiseProcessor::getChanDataHistoName(unsigned int ichip, unsigned int ichan){
@@ -251,8 +410,7 @@ string AlibavaPedestalNoiseProcessor::getNoiseHistoName(unsigned int ichip){
 
 void AlibavaPedestalNoiseProcessor::fillHistos(TrackerDataImpl * trkdata){
 	
-	FloatVec datavec;
-	datavec = trkdata->getChargeValues();
+	const FloatVec & datavec = trkdata->getChargeValues();
 	
 	int chipnum = getChipNum(trkdata);
 	
@@ -264,6 +422,22 @@ void AlibavaPedestalNoiseProcessor::fillHistos(TrackerDataImpl * trkdata){
 			histo->Fill(datavec[ichan]);
 	}
 
+	// the moments of all channels are updated at once, the masked channels have weight 0
+	if (_calculationMethod == "Moments" && !datavec.empty()) {
+		FloatVec & weight = _chanWeight[chipnum];
+		eutelescope::EUTelPixelAccumulator<double> & accumulator = _chanDataAccumulator[chipnum];
+		if (accumulator.size() != datavec.size()) {
+			weight.resize(datavec.size());
+			for (size_t ichan=0; ichan<datavec.size();ichan++)
+				weight[ichan] = isMasked(chipnum, ichan) ? 0 : 1;
+			// the moments of the histogram, the variance of the population
+			accumulator.setExactVariance(true);
+			accumulator.start(datavec.size(), &datavec[0]);
+		}
+		else
+			accumulator.add(&datavec[0], &weight[0]);
+	}
+
 }
 
 
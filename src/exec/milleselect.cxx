@@ -0,0 +1,90 @@
+// eutelescope includes ""
+#include "anyoption.h"
+#include "EUTelMilleWriter.h"
+
+//system includes <>
+#include <cstdlib>
+#include <iostream>
+#include <memory>
+#include <string>
+
+using namespace std;
+using namespace eutelescope;
+
+
+int main( int argc, char ** argv ) {
+
+  auto_ptr< AnyOption > option( new AnyOption );
+
+  string usageString =
+    "\n"
+    "This program copies the tracks of a Millepede binary passing tighter cuts\n"
+    "into a new binary, for the next pede iteration without running Marlin again.\n"
+    "It needs the index written by EUTelMille next to the input binary.\n"
+    "\n"
+    "milleselect [options] -o output.bin input.bin\n"
+    "\n"
+    "-h --help                Print this help\n"
+    "-o --output file         The new binary, its index is written next to it\n"
+    "-c --max-chi2ndf value   Keep tracks with chi2/ndf below value\n"
+    "-n --min-ndf value       Keep tracks with at least value degrees of freedom\n"
+    "-t --topology mask       Keep tracks with measurements on all planes in mask\n"
+    "-r --run number          Keep tracks of this run only\n"
+    "-z --compress            Write a gzip compressed binary\n";
+
+  option->addUsage( usageString.c_str() );
+  option->setFlag( "help", 'h' );
+  option->setOption( "output", 'o' );
+  option->setOption( "max-chi2ndf", 'c' );
+  option->setOption( "min-ndf", 'n' );
+  option->setOption( "topology", 't' );
+  option->setOption( "run", 'r' );
+  option->setFlag( "compress", 'z' );
+
+  option->processCommandArgs( argc,  argv );
+
+  if ( option->getFlag( 'h' ) || option->getFlag( "help" ) ) {
+    option->printUsage();
+    return 0;
+  }
+
+  if ( option->getValue( "output" ) == NULL || option->getArgc() != 1 ) {
+    cerr << "Please provide one input binary and an output file name using -o option" << endl;
+    return 2;
+  }
+
+  string const inputFileName = option->getArgv( 0 );
+  string const outputFileName = option->getValue( "output" );
+
+  double const maxChi2Ndf = option->getValue( "max-chi2ndf" ) ? atof( option->getValue( "max-chi2ndf" ) ) : -1.;
+  int const minNdf = option->getValue( "min-ndf" ) ? atoi( option->getValue( "min-ndf" ) ) : 0;
+  unsigned int const topology = option->getValue( "topology" ) ? strtoul( option->getValue( "topology" ), NULL, 0 ) : 0;
+  bool const selectRun = option->getValue( "run" ) != NULL;
+  int const run = selectRun ? atoi( option->getValue( "run" ) ) : 0;
+
+  EUTelMilleWriter::Selection selection = [=]( EUTelMilleWriter::RecordInfo const& info ) {
+    if ( info.ndf < minNdf ) return false;
+    if ( maxChi2Ndf >= 0. && ( info.ndf <= 0 || info.chi2 / info.ndf >= maxChi2Ndf ) ) return false;
+    if ( ( info.topology & topology ) != topology ) return false;
+    if ( selectRun && info.run != run ) return false;
+    return true;
+  };
+
+  vector< EUTelMilleWriter::RecordInfo > records;
+  string errorMessage;
+  if ( !EUTelMilleWriter::readIndex( EUTelMilleWriter::indexFileName( inputFileName ), records, errorMessage ) ) {
+    cerr << errorMessage << endl;
+    return 1;
+  }
+
+  long const copied = EUTelMilleWriter::copyRecords( inputFileName, outputFileName, selection,
+                                                     option->getFlag( 'z' ) || option->getFlag( "compress" ), errorMessage );
+  if ( copied < 0 ) {
+    cerr << errorMessage << endl;
+    return 1;
+  }
+
+  cout << "Copied " << copied << " of " << records.size() << " tracks from " << inputFileName
+       << " to " << outputFileName << endl;
+  return 0;
+}
@@ -0,0 +1,31 @@
+/*
+ *   This source code is part of the Eutelescope package of Marlin.
+ *   You are free to use this source files for your own development as
+ *   long as it stays in a public research context. You are not
+ *   allowed to use it for commercial purpose. You must put this
+ *   header with author names in all development based on this file.
+ *
+ */
+#ifndef EUTELBENCHMARK_H
+#define EUTELBENCHMARK_H
+
+// system includes <>
+#include <chrono>
+#include <cstdlib>
+
+namespace benchmark {
+
+  //! Milliseconds of wall clock time since start
+  inline double since(std::chrono::steady_clock::time_point start) {
+    return std::chrono::duration<double, std::milli>( std::chrono::steady_clock::now() - start ).count();
+  }
+
+  //! The first argument of the program as a number, e.g. of events, or defaultValue
+  inline int firstArgument(int argc, char ** argv, int defaultValue) {
+    if( argc > 1 ) return std::atoi( argv[1] );
+    return defaultValue;
+  }
+
+} //namespace
+
+#endif
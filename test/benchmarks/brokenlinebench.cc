@@ -0,0 +1,77 @@
+/*
+ *   This source code is part of the Eutelescope package of Marlin.
+ *   You are free to use this source files for your own development as
+ *   long as it stays in a public research context. You are not
+ *   allowed to use it for commercial purpose. You must put this
+ *   header with author names in all development based on this file.
+ *
+ */
+
+// personal include ".h"
+#include "EUTelBrokenLineFit.h"
+#include "EUTelBenchmark.h"
+#include "BrokenLineReference.h"
+
+// system include <>
+#include <cmath>
+#include <iomanip>
+#include <iostream>
+#include <random>
+#include <vector>
+
+using namespace std;
+using namespace eutelescope;
+using namespace reference;
+
+int main( int argc, char ** argv ) {
+
+  int const nEvents = benchmark::firstArgument( argc, argv, 200 );
+
+  mt19937 generator( 4711 );
+
+  cout << setw(6) << "beam" << setw(8) << "tracks" << setw(12) << "fits/event" << setw(12) << "dense [us]"
+       << setw(14) << "band [us]" << setw(10) << "speedup" << setw(12) << "dchi2/chi2" << endl;
+
+  for( int beam = 0; beam < 2; beam++ ) {
+    DenseFit dense( beam );
+    EUTelBrokenLineFit band;
+    band.setPlanes( testFitterPlanes, &dense._planeDist[0], &dense._planeScat[0], beam, testFitterSlopeX, testFitterSlopeY );
+
+    for( int nTracks = 1; nTracks <= 4; nTracks++ ) {
+      double denseTime = 0., bandTime = 0., denseSum = 0., bandSum = 0.;
+      long nFits = 0;
+      for( int i = 0; i < nEvents; ++i ) {
+        vector< vector<TestFitterHit> > hits = generateTestFitterEvent( generator, nTracks );
+
+        // the dense fit of every hit selection
+        chrono::steady_clock::time_point start = chrono::steady_clock::now();
+        denseSum += loopChoices( hits, [&]( vector<TestFitterHit> const& sel, vector<bool> const& used ) {
+            for( int ipl = 0; ipl < testFitterPlanes; ipl++ ) {
+              dense.planeX[ipl] = used[ipl] ? sel[ipl].x : 0.;
+              dense.planeY[ipl] = used[ipl] ? sel[ipl].y : 0.;
+              dense.planeEx[ipl] = dense.planeEy[ipl] = used[ipl] ? testFitterResolution : 0.;
+            }
+            ++nFits;
+            return dense.matrixFit();
+          } );
+        denseTime += 1000. * benchmark::since( start );
+
+        // the band fit, restarted from the first changed plane
+        start = chrono::steady_clock::now();
+        bandSum += loopChoices( hits, [&]( vector<TestFitterHit> const& sel, vector<bool> const& used ) {
+            for( int ipl = 0; ipl < testFitterPlanes; ipl++ ) {
+              if( used[ipl] ) band.setMeasurement( ipl, sel[ipl].x, testFitterResolution, sel[ipl].y, testFitterResolution );
+              else band.setMeasurement( ipl, 0., 0., 0., 0. );
+            }
+            return band.getChi2();
+          } );
+        bandTime += 1000. * benchmark::since( start );
+      }
+      cout << setw(6) << ( beam ? "yes" : "no" ) << setw(8) << nTracks << setw(12) << nFits/nEvents
+           << setw(12) << fixed << setprecision(1) << denseTime/nEvents << setw(14) << bandTime/nEvents
+           << setw(10) << denseTime/bandTime << setw(12) << scientific << setprecision(1)
+           << fabs( denseSum - bandSum )/denseSum << endl;
+    }
+  }
+  return 0;
+}
@@ -0,0 +1,75 @@
+/*
+ *   This source code is part of the Eutelescope package of Marlin.
+ *   You are free to use this source files for your own development as
+ *   long as it stays in a public research context. You are not
+ *   allowed to use it for commercial purpose. You must put this
+ *   header with author names in all development based on this file.
+ *
+ */
+
+// personal include ".h"
+#include "EUTelDafTrackerSystem.h"
+#include "EUTelBenchmark.h"
+#include "DafReference.h"
+
+// system include <>
+#include <iomanip>
+#include <iostream>
+#include <random>
+#include <vector>
+
+using namespace std;
+using namespace reference;
+
+int main( int argc, char ** argv ) {
+
+  int const nEvents = benchmark::firstArgument( argc, argv, 200 );
+
+  size_t const beamWidths[] = { 64, 256, 1024 };
+  size_t const nWidths = sizeof(beamWidths)/sizeof(size_t);
+  vector<DafSystem> beams( nWidths );
+  for( size_t w = 0; w < nWidths; ++w ) setupCKF( beams[w], beamWidths[w] );
+  DafSystem depthFirst;
+  setupCKF( depthFirst, 0 );
+
+  cout << setw(8) << "tracks" << setw(22) << "depth first [us] eff";
+  for( size_t w = 0; w < nWidths; ++w ) cout << setw(14) << "beam " << setw(4) << beamWidths[w] << " [us] eff";
+  cout << endl;
+
+  mt19937 generator( 4711 );
+  int const multiplicities[] = { 1, 2, 4, 8, 16, 32, 64, 128 };
+  for( size_t m = 0; m < sizeof(multiplicities)/sizeof(int); ++m ) {
+    int const nTracks = multiplicities[m];
+    vector<DafEvent> events;
+    for( int i = 0; i < nEvents; ++i ) events.push_back( generateDafEvent( generator, nTracks ) );
+
+    int const nTrue = nTracks*nEvents;
+    int found = 0;
+    chrono::steady_clock::time_point start = chrono::steady_clock::now();
+    for( int i = 0; i < nEvents; ++i ) {
+      fillDafEvent( depthFirst, events[i] );
+      depthFirst.combinatorialKF();
+      vector< vector<int> > tracks;
+      for( size_t t = 0; t < depthFirst.getNtracks(); ++t ) tracks.push_back( depthFirst.tracks[t].indexes );
+      found += countFound( events[i], tracks );
+    }
+    double time = 1000. * benchmark::since( start ) / nEvents;
+    cout << setw(8) << nTracks << setw(14) << fixed << setprecision(1) << time << setw(8) << setprecision(4) << double(found)/nTrue;
+
+    for( size_t w = 0; w < nWidths; ++w ) {
+      found = 0;
+      start = chrono::steady_clock::now();
+      for( int i = 0; i < nEvents; ++i ) {
+        fillDafEvent( beams[w], events[i] );
+        beams[w].combinatorialKF();
+        vector< vector<int> > tracks;
+        for( size_t t = 0; t < beams[w].getNtracks(); ++t ) tracks.push_back( beams[w].tracks[t].indexes );
+        found += countFound( events[i], tracks );
+      }
+      time = 1000. * benchmark::since( start ) / nEvents;
+      cout << setw(14) << setprecision(1) << time << setw(13) << setprecision(4) << double(found)/nTrue;
+    }
+    cout << endl;
+  }
+  return 0;
+}
@@ -0,0 +1,59 @@
+/*
+ *   This source code is part of the Eutelescope package of Marlin.
+ *   You are free to use this source files for your own development as
+ *   long as it stays in a public research context. You are not
+ *   allowed to use it for commercial purpose. You must put this
+ *   header with author names in all development based on this file.
+ *
+ */
+
+// personal include ".h"
+#include "EUTelDafTrackerSystem.h"
+#include "EUTelBenchmark.h"
+#include "DafReference.h"
+
+// system include <>
+#include <iomanip>
+#include <iostream>
+#include <random>
+
+using namespace std;
+using namespace daffitter;
+using namespace reference;
+
+int main( int argc, char ** argv ) {
+
+  int const nEvents = benchmark::firstArgument( argc, argv, 500 );
+
+  DafSystem scalar, batched;
+  setupClusterTracker( scalar );
+  setupClusterTracker( batched );
+
+  cout << "lanes " << batchLanes << endl;
+  cout << setw(8) << "tracks" << setw(14) << "scalar [us]" << setw(15) << "batched [us]" << setw(10) << "speedup" << endl;
+
+  mt19937 generator( 4711 );
+  int const multiplicities[] = { 1, 2, 4, 8, 16, 32, 64 };
+  for( size_t m = 0; m < sizeof(multiplicities)/sizeof(int); ++m ) {
+    int const nTracks = multiplicities[m];
+    double scalarTime = 0., batchedTime = 0.;
+    for( int i = 0; i < nEvents; ++i ) {
+      DafEvent const event = generateDafEvent( generator, nTracks );
+      fillDafEvent( scalar, event );
+      fillDafEvent( batched, event );
+      scalar.clusterTracker();
+      batched.clusterTracker();
+
+      chrono::steady_clock::time_point start = chrono::steady_clock::now();
+      fitDafScalar( scalar );
+      scalarTime += 1000.*benchmark::since( start );
+
+      start = chrono::steady_clock::now();
+      batched.fitPlanesInfoDafBatched();
+      batchedTime += 1000.*benchmark::since( start );
+    }
+    cout << setw(8) << nTracks << setw(14) << fixed << setprecision(2) << scalarTime/nEvents
+         << setw(15) << batchedTime/nEvents << setw(10) << scalarTime/batchedTime << endl;
+  }
+  return 0;
+}
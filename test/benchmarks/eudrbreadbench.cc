@@ -0,0 +1,170 @@
+/*
+ *   This source code is part of the Eutelescope package of Marlin.
+ *   You are free to use this source files for your own development as
+ *   long as it stays in a public research context. You are not
+ *   allowed to use it for commercial purpose. You must put this
+ *   header with author names in all development based on this file.
+ *
+ */
+
+// personal include ".h"
+#include "EUTelEUDRBDecoder.h"
+#include "EUTelMappedFile.h"
+#include "EUTelBenchmark.h"
+
+// system include <>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <random>
+#include <string>
+#include <vector>
+
+using namespace std;
+using namespace eutelescope;
+
+const int nDetector          = 1;
+const int nChannel           = 4;
+const int xNPixel            = 66;
+const int yNPixel            = 256;
+const int nFrame             = 3;
+const string algo            = "CDS32";
+const size_t readAhead       = 64 << 20;
+
+// the EUDRB debug format as written by test/eudrbtest, filled with random records
+void generateFile(string const& fileName, size_t sizeMB) {
+  EUDRBFileHeader fileHeader;
+  fileHeader.numberOfDetector = nDetector;
+  fileHeader.nXPixel          = xNPixel;
+  fileHeader.nYPixel          = yNPixel;
+  fileHeader.dataSize         = ( xNPixel * yNPixel * nChannel * nFrame ) / 2 * sizeof(int);
+  fileHeader.eventSize        = sizeof(EUDRBEventHeader) + fileHeader.dataSize + sizeof(EUDRBTrailer);
+  fileHeader.numberOfEvent    = static_cast<int>( ( sizeMB << 20 ) / fileHeader.eventSize );
+  fileHeader.chACBitMask      = 0x0FFF0000;
+  fileHeader.chACRightShift   = 16;
+  fileHeader.chBDBitMask      = 0x00000FFF;
+  fileHeader.chBDRightShift   = 0;
+
+  ofstream file( fileName.c_str(), ios::out | ios::binary );
+  file.write( reinterpret_cast<char*>( &fileHeader ), sizeof(fileHeader) );
+
+  mt19937 generator( 12345 );
+  uniform_int_distribution<int> adc( 0, 4095 );
+  vector<int> block( fileHeader.dataSize / sizeof(int) );
+  EUDRBTrailer trailer;
+  trailer.trailer = 0x89abcdef;
+
+  for( int iEvent = 0; iEvent < fileHeader.numberOfEvent; ++iEvent ) {
+    EUDRBEventHeader eventHeader;
+    eventHeader.eventNumber   = iEvent;
+    eventHeader.triggerNumber = iEvent;
+    // only a few records change from event to event, this keeps the generation fast
+    if( iEvent == 0 ) {
+      for( size_t i = 0; i < block.size(); ++i ) block[i] = ( adc( generator ) << 16 ) | adc( generator );
+    } else {
+      for( int i = 0; i < 64; ++i ) block[ generator() % block.size() ] = ( adc( generator ) << 16 ) | adc( generator );
+    }
+    file.write( reinterpret_cast<char*>( &eventHeader ), sizeof(eventHeader) );
+    file.write( reinterpret_cast<char*>( &block[0] ), fileHeader.dataSize );
+    file.write( reinterpret_cast<char*>( &trailer ), sizeof(trailer) );
+  }
+}
+
+// every event gets fresh channel vectors, as fresh TrackerRawData are created by the reader
+long long decodeEvent(EUTelEUDRBDecoder const& decoder, int const* block) {
+  vector<short> a, b, c, d;
+  decoder.decode( block, a, b, c, d );
+  long long sum = 0;
+  for( size_t i = 0; i < a.size(); ++i ) sum += a[i] + 3*b[i] + 5*c[i] + 7*d[i];
+  return sum;
+}
+
+// the original EUTelEUDRBReader input: ifstream reads into a buffer
+long long readStream(string const& fileName, size_t& bytes) {
+  ifstream file( fileName.c_str(), ios::in | ios::binary );
+  EUDRBFileHeader fileHeader;
+  file.read( reinterpret_cast<char*>( &fileHeader ), sizeof(fileHeader) );
+  EUTelEUDRBDecoder decoder;
+  decoder.configure( fileHeader, algo );
+
+  vector<int> buffer( fileHeader.dataSize / sizeof(int) );
+  long long checksum = 0;
+  bytes = sizeof(fileHeader);
+  for( int iEvent = 0; iEvent < fileHeader.numberOfEvent; ++iEvent ) {
+    EUDRBEventHeader eventHeader;
+    EUDRBTrailer trailer;
+    file.read( reinterpret_cast<char*>( &eventHeader ), sizeof(eventHeader) );
+    file.read( reinterpret_cast<char*>( &buffer[0] ), fileHeader.dataSize );
+    file.read( reinterpret_cast<char*>( &trailer ), sizeof(trailer) );
+    if( !file ) break;
+    checksum += decodeEvent( decoder, &buffer[0] );
+    bytes += sizeof(eventHeader) + fileHeader.dataSize + sizeof(trailer);
+  }
+  return checksum;
+}
+
+// the memory mapped input: records are decoded in place
+long long readMapped(string const& fileName, size_t& bytes) {
+  EUTelMappedFile file;
+  if( !file.open( fileName, readAhead ) ) {
+    cerr << file.getErrorMessage() << endl;
+    exit( 2 );
+  }
+  EUDRBFileHeader fileHeader;
+  memcpy( &fileHeader, file.data(), sizeof(fileHeader) );
+  EUTelEUDRBDecoder decoder;
+  decoder.configure( fileHeader, algo );
+
+  size_t const eventSize = sizeof(EUDRBEventHeader) + fileHeader.dataSize + sizeof(EUDRBTrailer);
+  long long checksum = 0;
+  size_t offset = sizeof(fileHeader);
+  for( int iEvent = 0; iEvent < fileHeader.numberOfEvent && offset + eventSize <= file.size(); ++iEvent ) {
+    checksum += decodeEvent( decoder, reinterpret_cast<int const*>( file.data() + offset + sizeof(EUDRBEventHeader) ) );
+    offset += eventSize;
+    file.consumed( offset );
+  }
+  bytes = offset;
+  return checksum;
+}
+
+int main( int argc, char ** argv ) {
+
+  size_t const sizeMB = benchmark::firstArgument( argc, argv, 2048 );
+  string const fileName = argc > 2 ? argv[2] : "eudrbreadbench.dat";
+
+  cout << "Generating " << sizeMB << " MB in " << fileName << endl;
+  generateFile( fileName, sizeMB );
+
+  cout << setw(10) << "pass" << setw(18) << "ifstream [MB/s]" << setw(18) << "mmap [MB/s]" << setw(12) << "speed-up" << endl;
+
+  bool identical = true;
+  // the first pass may find the file partly in the page cache after writing it
+  for( int pass = 1; pass <= 2; ++pass ) {
+    size_t streamBytes = 0, mappedBytes = 0;
+
+    chrono::steady_clock::time_point start = chrono::steady_clock::now();
+    long long streamSum = readStream( fileName, streamBytes );
+    double streamTime = benchmark::since( start ) / 1000.;
+
+    start = chrono::steady_clock::now();
+    long long mappedSum = readMapped( fileName, mappedBytes );
+    double mappedTime = benchmark::since( start ) / 1000.;
+
+    if( streamSum != mappedSum || streamBytes != mappedBytes ) {
+      cerr << "Decoded data differ in pass " << pass << endl;
+      identical = false;
+    }
+
+    double streamRate = streamBytes / streamTime / ( 1 << 20 );
+    double mappedRate = mappedBytes / mappedTime / ( 1 << 20 );
+    cout << setw(10) << pass << setw(18) << fixed << setprecision(1) << streamRate
+         << setw(18) << mappedRate << setw(12) << setprecision(2) << mappedRate / streamRate << endl;
+  }
+
+  remove( fileName.c_str() );
+  return identical ? 0 : 1;
+}
@@ -0,0 +1,108 @@
+/*
+ *   This source code is part of the Eutelescope package of Marlin.
+ *   You are free to use this source files for your own development as
+ *   long as it stays in a public research context. You are not
+ *   allowed to use it for commercial purpose. You must put this
+ *   header with author names in all development based on this file.
+ *
+ */
+
+// personal include ".h"
+#include "EUTelMilleWriter.h"
+#include "EUTelBenchmark.h"
+#include "MilleReference.h"
+
+// system include <>
+#include <cstdio>
+#include <cstdlib>
+#include <iomanip>
+#include <iostream>
+#include <string>
+#include <vector>
+
+using namespace std;
+using namespace eutelescope;
+using namespace reference;
+
+// stands for the track finding and fitting of the processor between two records
+void process(double microseconds) {
+  chrono::steady_clock::time_point const start = chrono::steady_clock::now();
+  while( chrono::duration<double, micro>( chrono::steady_clock::now() - start ).count() < microseconds ) {}
+}
+
+int main( int argc, char ** argv ) {
+
+  int const nTracks = benchmark::firstArgument( argc, argv, 200000 );
+  double work = 20.;
+  if( argc > 2 ) work = atof( argv[2] );
+
+  vector<MilleTrack> const tracks = generateMilleTracks( nTracks );
+
+  // Mille in the processor thread
+  chrono::steady_clock::time_point start = chrono::steady_clock::now();
+  {
+    SyncMille mille( "sync.bin" );
+    for( int t = 0; t < nTracks; ++t ) {
+      process( work );
+      addMilleTrack( mille, tracks[t] );
+      mille.end();
+    }
+  }
+  double const syncTime = benchmark::since( start );
+
+  cout << "processing time per track " << work << " us" << endl;
+  cout << setw(12) << "writer" << setw(16) << "records [ms]" << setw(14) << "close [ms]"
+       << setw(12) << "queue full" << setw(14) << "size [MB]" << endl;
+  cout << setw(12) << "Mille" << setw(16) << fixed << setprecision(1) << syncTime - nTracks * work / 1000. << setw(14) << 0.
+       << setw(12) << 0 << setw(14) << readFile( "sync.bin" ).size() / 1e6 << endl;
+
+  // the writer with its I/O thread, plain and compressed
+  for( int compress = 0; compress < 2; ++compress ) {
+    string const fileName = compress ? "async.bin.gz" : "async.bin";
+    EUTelMilleWriter writer;
+    if( !writer.open( fileName, compress ) ) {
+      cerr << writer.getErrorMessage() << endl;
+      return 1;
+    }
+    start = chrono::steady_clock::now();
+    for( int t = 0; t < nTracks; ++t ) {
+      process( work );
+      addMilleTrack( writer, tracks[t] );
+      writer.setRecordInfo( 1, t, ( 1 << millePlanes ) - 1, tracks[t].chi2, tracks[t].ndf );
+      writer.end();
+    }
+    double const recordTime = benchmark::since( start ) - nTracks * work / 1000.;
+    start = chrono::steady_clock::now();
+    if( !writer.close() ) {
+      cerr << writer.getErrorMessage() << endl;
+      return 1;
+    }
+    double const closeTime = benchmark::since( start );
+    cout << setw(12) << ( compress ? "async gzip" : "async" ) << setw(16) << recordTime << setw(14) << closeTime
+         << setw(12) << writer.getNQueueFull() << setw(14) << readFile( fileName ).size() / 1e6 << endl;
+  }
+
+  // a tighter cut for the next iteration, copied with the help of the index
+  float const maxChi2Ndf = 1.5;
+  EUTelMilleWriter::Selection selection = [=]( EUTelMilleWriter::RecordInfo const& info ) {
+    return info.chi2 / info.ndf < maxChi2Ndf;
+  };
+  for( int compress = 0; compress < 2; ++compress ) {
+    string const input = compress ? "async.bin.gz" : "async.bin";
+    string errorMessage;
+    start = chrono::steady_clock::now();
+    long const copied = EUTelMilleWriter::copyRecords( input, "selected.bin", selection, false, errorMessage );
+    double const copyTime = benchmark::since( start );
+    if( copied < 0 ) {
+      cerr << errorMessage << endl;
+      return 1;
+    }
+    cout << "copied " << copied << " of " << nTracks << " tracks from " << input << " in " << copyTime << " ms" << endl;
+  }
+
+  char const* files[] = { "sync.bin", "async.bin", "async.bin.idx", "async.bin.gz", "async.bin.gz.idx",
+                          "selected.bin", "selected.bin.idx" };
+  for( size_t i = 0; i < sizeof( files ) / sizeof( files[0] ); ++i ) remove( files[i] );
+
+  return 0;
+}
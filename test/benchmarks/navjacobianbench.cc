@@ -0,0 +1,179 @@
+/*
+ *   This source code is part of the Eutelescope package of Marlin.
+ *   You are free to use this source files for your own development as
+ *   long as it stays in a public research context. You are not
+ *   allowed to use it for commercial purpose. You must put this
+ *   header with author names in all development based on this file.
+ *
+ */
+
+// personal include ".h"
+#include "EUTelNavMatrix.h"
+#include "EUTelBenchmark.h"
+#include "NavJacobianReference.h"
+
+// ROOT
+#include "TMatrixD.h"
+#include "TMatrixDSym.h"
+#include "TVector3.h"
+
+// system include <>
+#include <cmath>
+#include <iomanip>
+#include <iostream>
+#include <random>
+#include <vector>
+
+using namespace std;
+using namespace eutelescope;
+
+// six telescope planes and a tilted DUT in the middle
+const int    nPlanes             = 7;
+const double planeZ[nPlanes]     = { 0., 150., 300., 450., 600., 750., 900. };
+const double planeTilt[nPlanes]  = { 0., 0., 0., 0.5236, 0., 0., 0. };
+const double planeSpin[nPlanes]  = { 0.01, -0.02, 0.015, 0., 0.005, -0.01, 0.02 };
+const double bFieldTesla[3]      = { 0.5, 0., 0. };
+const double beamEnergy          = 4.;
+const double minJacobian         = 1e-4;
+const double radFracSensor       = 1e-3;
+const double radFracAir          = 5e-4;
+
+struct Plane {
+  TMatrixD rotRoot;
+  Eigen::Matrix3d rot;
+  Plane(): rotRoot(3,3), rot() {}
+};
+
+// what is handed to GBL for every point, summed up so that nothing is optimised away
+struct GBLInput {
+  double sum;
+  GBLInput(): sum(0) {}
+  void add(TMatrixD const& mat) { for( int i = 0; i < mat.GetNrows(); ++i ) for( int j = 0; j < mat.GetNcols(); ++j ) sum += mat[i][j]; }
+  void add(TMatrixDSym const& mat) { for( int i = 0; i < mat.GetNrows(); ++i ) for( int j = 0; j < mat.GetNcols(); ++j ) sum += mat[i][j]; }
+};
+
+vector<Plane> makeGeometry() {
+  vector<Plane> planes( nPlanes );
+  for( int i = 0; i < nPlanes; ++i ) {
+    Eigen::Matrix3d tilt, spin;
+    tilt << cos( planeTilt[i] ), 0, sin( planeTilt[i] ), 0, 1, 0, -sin( planeTilt[i] ), 0, cos( planeTilt[i] );
+    spin << cos( planeSpin[i] ), -sin( planeSpin[i] ), 0, sin( planeSpin[i] ), cos( planeSpin[i] ), 0, 0, 0, 1;
+    planes[i].rot = tilt*spin;
+    for( int r = 0; r < 3; ++r ) for( int c = 0; c < 3; ++c ) planes[i].rotRoot[r][c] = planes[i].rot(r,c);
+  }
+  return planes;
+}
+
+// the original matrices of EUTelGBLFitter
+void referenceTrack(vector<Plane> const& planes, TVector3 const& mom, GBLInput& gbl) {
+  const TVector3 b( bFieldTesla[0], bFieldTesla[1], bFieldTesla[2] );
+  const double scatterers[3] = { 0.2, 0.8, 1. };
+  TMatrixD jacPointToPoint(5,5);
+  jacPointToPoint.UnitMatrix();
+  for( int i = 0; i < nPlanes; ++i ) {
+    gbl.add( jacPointToPoint );
+    TVector3 momLocal = reference::toLocal( mom, planes[i].rotRoot );
+    gbl.add( reference::scatteringPrecision( momLocal, radFracSensor ) );
+    gbl.add( reference::projection() );
+    if( i == nPlanes-1 ) break;
+
+    std::vector<TMatrixD> scattererJacobians;
+    double last = 0;
+    for( int j = 0; j < 3; ++j ) {
+      double distance = ( planeZ[i+1] - planeZ[i] )*( scatterers[j] - last );
+      last = scatterers[j];
+      Plane const& end = ( j == 2 ) ? planes[i+1] : planes[i];
+      scattererJacobians.push_back( reference::fullJacobian( mom, planes[i].rotRoot, end.rotRoot, distance, b, minJacobian ) );
+    }
+    for( int j = 0; j < 2; ++j ) {
+      gbl.add( scattererJacobians[j] );
+      gbl.add( reference::scatteringPrecision( momLocal, radFracAir ) );
+    }
+    jacPointToPoint = scattererJacobians.back();
+  }
+}
+
+// the same with EUTelNavMatrix, ROOT matrices are only created for GBL
+Matrix5d fullJacobian(Eigen::Vector3d const& mom, Plane const& start, Plane const& end, double distance) {
+  const Eigen::Vector3d b( bFieldTesla[0], bFieldTesla[1], bFieldTesla[2] );
+  const Matrix5d simpleJacobian = EUTelNavMatrix::propagationJacobianGlobalToGlobal( distance, mom.normalized(), b );
+  const Matrix5d localToGlobalJacobianStart = EUTelNavMatrix::measToGlobal( start.rot.transpose()*mom, start.rot );
+  const Matrix5d localToGlobalJacobianEnd = EUTelNavMatrix::measToGlobal( end.rot.transpose()*mom, end.rot );
+  Matrix5d localToNextLocalJacobian = localToGlobalJacobianEnd.inverse()*simpleJacobian*localToGlobalJacobianStart;
+  EUTelNavMatrix::setPrecision( localToNextLocalJacobian, minJacobian );
+  return localToNextLocalJacobian;
+}
+
+Eigen::Matrix2d precision(Eigen::Vector3d const& momLocal, double variance) {
+  Eigen::Vector3d unit = momLocal.normalized();
+  float c1 = unit[0]; float c2 = unit[1];
+  Eigen::Matrix2d precisionMatrix = Eigen::Matrix2d::Zero();
+  float factor = (1.0/variance)/pow((1-pow(c1,2)-pow(c2,2)),2);
+  precisionMatrix(0,0)=factor*(1-pow(c2,2));
+  precisionMatrix(1,0)=factor*c1*c2;				precisionMatrix(1,1)=factor*(1-pow(c1,2));
+  return precisionMatrix;
+}
+
+void fixedSizeTrack(vector<Plane> const& planes, Eigen::Vector3d const& mom, std::vector<Matrix5d>& scattererJacobians, GBLInput& gbl) {
+  const double scatterers[3] = { 0.2, 0.8, 1. };
+  Matrix5d jacPointToPoint = Matrix5d::Identity();
+  for( int i = 0; i < nPlanes; ++i ) {
+    gbl.add( Utility::toTMatrixD( jacPointToPoint ) );
+    const Eigen::Vector3d momLocal = planes[i].rot.transpose()*mom;
+    gbl.add( Utility::toTMatrixDSym( precision( momLocal, radFracSensor ) ) );
+    gbl.add( Utility::toTMatrixD( Eigen::Matrix2d::Identity() ) );
+    if( i == nPlanes-1 ) break;
+
+    scattererJacobians.clear();
+    double last = 0;
+    for( int j = 0; j < 3; ++j ) {
+      double distance = ( planeZ[i+1] - planeZ[i] )*( scatterers[j] - last );
+      last = scatterers[j];
+      Plane const& end = ( j == 2 ) ? planes[i+1] : planes[i];
+      scattererJacobians.push_back( fullJacobian( mom, planes[i], end, distance ) );
+    }
+    for( int j = 0; j < 2; ++j ) {
+      gbl.add( Utility::toTMatrixD( scattererJacobians[j] ) );
+      gbl.add( Utility::toTMatrixDSym( precision( momLocal, radFracAir ) ) );
+    }
+    jacPointToPoint = scattererJacobians.back();
+  }
+}
+
+int main( int argc, char ** argv ) {
+
+  int const nTracks = benchmark::firstArgument( argc, argv, 200000 );
+
+  vector<Plane> planes = makeGeometry();
+
+  mt19937 generator( 12345 );
+  normal_distribution<double> slope( 0., 2e-3 );
+  vector<Eigen::Vector3d> momenta( nTracks );
+  for( int i = 0; i < nTracks; ++i ) {
+    momenta[i] = Eigen::Vector3d( slope( generator ), slope( generator ), 1. ).normalized()*beamEnergy;
+  }
+
+  GBLInput reference;
+  chrono::steady_clock::time_point start = chrono::steady_clock::now();
+  for( int i = 0; i < nTracks; ++i ) {
+    referenceTrack( planes, TVector3( momenta[i][0], momenta[i][1], momenta[i][2] ), reference );
+  }
+  double referenceTime = benchmark::since( start ) / 1000.;
+
+  GBLInput fixedSize;
+  std::vector<Matrix5d> scattererJacobians;
+  start = chrono::steady_clock::now();
+  for( int i = 0; i < nTracks; ++i ) {
+    fixedSizeTrack( planes, momenta[i], scattererJacobians, fixedSize );
+  }
+  double fixedSizeTime = benchmark::since( start ) / 1000.;
+
+  cout << nTracks << " tracks through " << nPlanes << " planes" << endl;
+  cout << setw(20) << "TMatrixD [tracks/s]" << setw(20) << "Eigen [tracks/s]" << setw(12) << "speed-up" << endl;
+  cout << setw(20) << fixed << setprecision(0) << nTracks/referenceTime
+       << setw(20) << nTracks/fixedSizeTime
+       << setw(12) << setprecision(2) << referenceTime/fixedSizeTime << endl;
+  cout << "sum of the GBL input " << scientific << setprecision(9) << reference.sum << " and " << fixedSize.sum << endl;
+
+  return 0;
+}
@@ -0,0 +1,108 @@
+/*
+ *   This source code is part of the Eutelescope package of Marlin.
+ *   You are free to use this source files for your own development as
+ *   long as it stays in a public research context. You are not
+ *   allowed to use it for commercial purpose. You must put this
+ *   header with author names in all development based on this file.
+ *
+ */
+
+// personal include ".h"
+#include "EUTelPedeDriver.h"
+#include "EUTelBenchmark.h"
+#include "PedeReference.h"
+
+// system include <>
+#include <cstdio>
+#include <cstdlib>
+#include <ctime>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <sys/stat.h>
+#include <unistd.h>
+#include <vector>
+
+using namespace std;
+using namespace eutelescope;
+using namespace reference;
+
+double cpuTime() {
+  return 1000. * clock() / CLOCKS_PER_SEC;
+}
+
+int main( int argc, char ** argv ) {
+
+  int const nFits = benchmark::firstArgument( argc, argv, 4 );
+  double pause = 0.2;
+  if( argc > 2 ) pause = atof( argv[2] );
+
+  char cwd[4096];
+  if( !getcwd( cwd, sizeof( cwd ) ) ) return 1;
+  string const fakePede = string( cwd ) + "/fakepede";
+  writeFakePede( fakePede, pause );
+
+  cout << setw(26) << "" << setw(12) << "wall [ms]" << setw(12) << "cpu [ms]" << endl;
+
+  // one fit through the busy polling loop
+  {
+    ofstream( "steer.txt" ) << "0.5";
+    string output;
+    double const cpu = cpuTime();
+    chrono::steady_clock::time_point const start = chrono::steady_clock::now();
+    runPStream( fakePede + " steer.txt", output );
+    cout << setw(26) << "ipstream, busy polling" << setw(12) << fixed << setprecision(1) << benchmark::since( start )
+         << setw(12) << cpuTime() - cpu << endl;
+  }
+
+  // one fit through the driver
+  {
+    EUTelPedeDriver driver;
+    double const cpu = cpuTime();
+    chrono::steady_clock::time_point const start = chrono::steady_clock::now();
+    if( !driver.start( "steer.txt", "", fakePede ) ) {
+      cerr << driver.getErrorMessage() << endl;
+      return 1;
+    }
+    driver.wait();
+    cout << setw(26) << "driver" << setw(12) << benchmark::since( start ) << setw(12) << cpuTime() - cpu << endl;
+  }
+
+  // independent fits in their own directories at the same time
+  {
+    vector<EUTelPedeDriver*> drivers;
+    double const cpu = cpuTime();
+    chrono::steady_clock::time_point const start = chrono::steady_clock::now();
+    for( int i = 0; i < nFits; ++i ) {
+      stringstream directory;
+      directory << "fit" << i;
+      mkdir( directory.str().c_str(), 0755 );
+      ofstream( ( directory.str() + "/steer.txt" ).c_str() ) << 0.1 * i;
+      drivers.push_back( new EUTelPedeDriver );
+      if( !drivers.back()->start( "steer.txt", directory.str(), fakePede ) ) {
+        cerr << drivers.back()->getErrorMessage() << endl;
+        return 1;
+      }
+    }
+    for( int i = 0; i < nFits; ++i ) drivers[i]->wait();
+    stringstream label;
+    label << nFits << " drivers concurrently";
+    cout << setw(26) << label.str() << setw(12) << benchmark::since( start ) << setw(12) << cpuTime() - cpu << endl;
+    for( int i = 0; i < nFits; ++i ) {
+      remove( drivers[i]->getResultFileName().c_str() );
+      stringstream directory;
+      directory << "fit" << i;
+      remove( ( directory.str() + "/steer.txt" ).c_str() );
+      rmdir( directory.str().c_str() );
+      delete drivers[i];
+    }
+  }
+
+  remove( "steer.txt" );
+  remove( "millepede.res" );
+  remove( fakePede.c_str() );
+
+  return 0;
+}
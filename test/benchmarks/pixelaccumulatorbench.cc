@@ -0,0 +1,190 @@
+/*
+ *   This source code is part of the Eutelescope package of Marlin.
+ *   You are free to use this source files for your own development as
+ *   long as it stays in a public research context. You are not
+ *   allowed to use it for commercial purpose. You must put this
+ *   header with author names in all development based on this file.
+ *
+ */
+
+// personal include ".h"
+#include "EUTelPixelAccumulator.h"
+#include "EUTelPedestalTracker.h"
+#include "EUTelBenchmark.h"
+#include "PixelAccumulatorReference.h"
+
+// system include <>
+#include <algorithm>
+#include <cmath>
+#include <cstdlib>
+#include <iomanip>
+#include <iostream>
+#include <vector>
+
+using namespace std;
+using namespace eutelescope;
+using namespace reference;
+
+// One Mimosa26 sensor, read as a full frame
+int const nXPixel = 1152;
+int const nYPixel = 576;
+int const nPixel  = nXPixel * nYPixel;
+
+int main( int argc, char ** argv ) {
+
+  int const nEvents = benchmark::firstArgument( argc, argv, 50 );
+
+  srand( 4711 );
+  PixelFrames const data = generatePixelFrames( nPixel, nEvents );
+  vector<float> const& truePede = data.truePede;
+  vector<float> const& trueNoise = data.trueNoise;
+  vector< vector<short> > const& frames = data.frames;
+  vector<short> const& status = data.status;
+
+  cout << nEvents << " full frames of " << nXPixel << " x " << nYPixel << " pixels\n"
+       << setw(36) << "" << setw(14) << "old [ms/evt]" << setw(14) << "new [ms/evt]" << setw(10) << "speed up" << endl;
+  cout << fixed << setprecision(3);
+
+  // MeanRMS: the deviations from the old loop, and of both from the
+  // exact mean and RMS of every pixel
+  {
+    vector<float> pede( frames[0].begin(), frames[0].end() ), noise( nPixel, 0. );
+    vector<int> entries( nPixel, 1 );
+    chrono::steady_clock::time_point start = chrono::steady_clock::now();
+    for( int iEvent = 1; iEvent < nEvents; ++iEvent ) oldMeanRMS( frames[iEvent], pede, noise, entries );
+    double const oldTime = benchmark::since( start ) / ( nEvents - 1 );
+
+    vector<float> const weight( nPixel, 1. );
+    EUTelPixelAccumulator<double> accumulator;
+    start = chrono::steady_clock::now();
+    accumulator.start( nPixel, &frames[0][0] );
+    for( int iEvent = 1; iEvent < nEvents; ++iEvent ) accumulator.add( &frames[iEvent][0], &weight[0] );
+    double const newTime = benchmark::since( start ) / ( nEvents - 1 );
+
+    EUTelPixelAccumulator<float> floatAccumulator;
+    start = chrono::steady_clock::now();
+    floatAccumulator.start( nPixel, &frames[0][0] );
+    for( int iEvent = 1; iEvent < nEvents; ++iEvent ) floatAccumulator.add( &frames[iEvent][0], &weight[0] );
+    double const floatTime = benchmark::since( start ) / ( nEvents - 1 );
+
+    EUTelPixelAccumulator<double> exactAccumulator;
+    exactAccumulator.setExactVariance( true );
+    start = chrono::steady_clock::now();
+    exactAccumulator.start( nPixel, &frames[0][0] );
+    for( int iEvent = 1; iEvent < nEvents; ++iEvent ) exactAccumulator.add( &frames[iEvent][0], &weight[0] );
+    double const exactTime = benchmark::since( start ) / ( nEvents - 1 );
+
+    double oldNewPedeError = 0., oldNewNoiseError = 0., oldFloatNoiseError = 0.;
+    double oldPedeError = 0., newPedeError = 0., oldNoiseError = 0., newNoiseError = 0.;
+    for( int iPixel = 0; iPixel < nPixel; ++iPixel ) {
+      double sum = 0., sum2 = 0.;
+      for( int iEvent = 0; iEvent < nEvents; ++iEvent ) sum += frames[iEvent][iPixel];
+      double const mean = sum / nEvents;
+      for( int iEvent = 0; iEvent < nEvents; ++iEvent ) sum2 += pow( frames[iEvent][iPixel] - mean, 2 );
+      double const rms = sqrt( sum2 / nEvents );
+      oldNewPedeError    = max( oldNewPedeError, fabs( accumulator.mean()[iPixel] - pede[iPixel] ) );
+      oldNewNoiseError   = max( oldNewNoiseError, fabs( sqrt( accumulator.variance()[iPixel] ) - noise[iPixel] ) );
+      oldFloatNoiseError = max( oldFloatNoiseError, fabs( sqrt( static_cast<double>( floatAccumulator.variance()[iPixel] ) ) - noise[iPixel] ) );
+      oldPedeError    = max( oldPedeError, fabs( pede[iPixel] - mean ) );
+      newPedeError    = max( newPedeError, fabs( exactAccumulator.mean()[iPixel] - mean ) );
+      oldNoiseError   = max( oldNoiseError, fabs( noise[iPixel] - rms ) );
+      newNoiseError   = max( newNoiseError, fabs( sqrt( exactAccumulator.variance()[iPixel] ) - rms ) );
+    }
+    cout << setw(36) << "MeanRMS update, double" << setw(14) << oldTime << setw(14) << newTime << setw(10) << oldTime / newTime << "\n"
+         << setw(36) << "MeanRMS update, float" << setw(14) << oldTime << setw(14) << floatTime << setw(10) << oldTime / floatTime << "\n"
+         << setw(36) << "exact variance update, double" << setw(14) << oldTime << setw(14) << exactTime << setw(10) << oldTime / exactTime << "\n"
+         << setprecision(6)
+         << "  largest deviation of the accumulator from the old loop [ADC]\n"
+         << "    pedestal " << oldNewPedeError << ", noise " << oldNewNoiseError
+         << " (float accumulator noise " << oldFloatNoiseError << ")\n"
+         << "  largest deviation from the exact mean and RMS [ADC]\n"
+         << "    old pedestal " << oldPedeError << ", noise " << oldNoiseError << "\n"
+         << "    exact variance pedestal " << newPedeError << ", noise " << newNoiseError << setprecision(3) << endl;
+  }
+
+  // row wise common mode
+  {
+    vector<float> oldCorrection, newCorrection;
+    int oldSkipped = 0, newSkipped = 0;
+    chrono::steady_clock::time_point start = chrono::steady_clock::now();
+    for( int iEvent = 0; iEvent < nEvents; ++iEvent ) oldSkipped += oldRowWise( frames[iEvent], truePede, trueNoise, status, nXPixel, 3.5, oldCorrection );
+    double const oldTime = benchmark::since( start ) / nEvents;
+    start = chrono::steady_clock::now();
+    for( int iEvent = 0; iEvent < nEvents; ++iEvent ) newSkipped += newRowWise( frames[iEvent], truePede, trueNoise, status, nXPixel, 3.5, newCorrection );
+    double const newTime = benchmark::since( start ) / nEvents;
+    cout << setw(36) << "row wise common mode" << setw(14) << oldTime << setw(14) << newTime << setw(10) << oldTime / newTime << "\n"
+         << "  " << oldSkipped << " and " << newSkipped << " rows skipped" << endl;
+  }
+
+  // fixed weight update
+  {
+    vector<float> oldPede( truePede ), oldNoise( trueNoise ), newPede( truePede ), newNoise( trueNoise );
+    chrono::steady_clock::time_point start = chrono::steady_clock::now();
+    for( int iEvent = 0; iEvent < nEvents; ++iEvent ) oldFixedWeight( frames[iEvent], status, 100, oldPede, oldNoise );
+    double const oldTime = benchmark::since( start ) / nEvents;
+    start = chrono::steady_clock::now();
+    for( int iEvent = 0; iEvent < nEvents; ++iEvent ) fixedWeightUpdate( nPixel, &frames[iEvent][0], &status[0], 100, &newPede[0], &newNoise[0] );
+    double const newTime = benchmark::since( start ) / nEvents;
+    cout << setw(36) << "fixed weight update" << setw(14) << oldTime << setw(14) << newTime << setw(10) << oldTime / newTime << endl;
+  }
+
+  // exponential weight tracking, every event, against the fixed
+  // weight update; then on a small detector whose pedestal drifts by
+  // 10 ADC in 20000 events
+  {
+    vector<float> pede( truePede ), noise( trueNoise );
+    chrono::steady_clock::time_point start = chrono::steady_clock::now();
+    for( int iEvent = 0; iEvent < nEvents; ++iEvent ) oldFixedWeight( frames[iEvent], status, 100, pede, noise );
+    double const oldTime = benchmark::since( start ) / nEvents;
+    EUTelPedestalTracker tracker;
+    tracker.start( nPixel, &truePede[0], &trueNoise[0], 100, 3.5 );
+    start = chrono::steady_clock::now();
+    for( int iEvent = 0; iEvent < nEvents; ++iEvent ) tracker.update( &frames[iEvent][0], &status[0] );
+    double const newTime = benchmark::since( start ) / nEvents;
+    cout << setw(36) << "exponential weight tracking" << setw(14) << oldTime << setw(14) << newTime << setw(10) << oldTime / newTime << endl;
+
+    int const nSmall = 1000, nDriftEvents = 20000;
+    vector<float> smallPede( truePede.begin(), truePede.begin() + nSmall ), smallNoise( trueNoise.begin(), trueNoise.begin() + nSmall );
+    vector<short> smallStatus( nSmall, 0 ), smallFrame( nSmall );
+    tracker.start( nSmall, &smallPede[0], &smallNoise[0], 100, 3.5 );
+    EUTelPedestalDrift drift = tracker.getDrift();
+    for( int iEvent = 0; iEvent < nDriftEvents; ++iEvent ) {
+      double const offset = 10. * iEvent / nDriftEvents;
+      for( int iPixel = 0; iPixel < nSmall; ++iPixel ) {
+        smallFrame[iPixel] = pixelSignal( smallPede[iPixel] + offset, smallNoise[iPixel], 1000 );
+      }
+      tracker.update( &smallFrame[0], &smallStatus[0] );
+      if( ( iEvent + 1 ) % 5000 == 0 ) {
+        drift = tracker.getDrift();
+        cout << setprecision(2) << "  after " << setw(5) << drift.noOfEvents << " events: shift " << drift.meanShift
+             << " +/- " << drift.rmsShift << " (true " << 10. * iEvent / nDriftEvents << "), noise ratio "
+             << drift.meanNoiseRatio << ", " << 100 * drift.updatedFraction << "% updated" << setprecision(3) << endl;
+      }
+    }
+  }
+
+  // calibration and zero suppression, the fused version without the
+  // calibrated frame
+  {
+    vector<float> corrected, oldSparse, newSparse, signal;
+    vector<unsigned int> selected;
+    size_t oldSize = 0, newSize = 0;
+    chrono::steady_clock::time_point start = chrono::steady_clock::now();
+    for( int iEvent = 0; iEvent < nEvents; ++iEvent ) {
+      oldCalibrateSparsify( frames[iEvent], truePede, trueNoise, status, nXPixel, 0.5, 3., corrected, oldSparse );
+      oldSize += oldSparse.size();
+    }
+    double const oldTime = benchmark::since( start ) / nEvents;
+    start = chrono::steady_clock::now();
+    for( int iEvent = 0; iEvent < nEvents; ++iEvent ) {
+      newCalibrateSparsify( frames[iEvent], truePede, trueNoise, status, nXPixel, 0.5, 3., selected, signal, newSparse );
+      newSize += newSparse.size();
+    }
+    double const newTime = benchmark::since( start ) / nEvents;
+    cout << setw(36) << "calibrate and zero suppress" << setw(14) << oldTime << setw(14) << newTime << setw(10) << oldTime / newTime << endl;
+    cout << "  " << oldSize / 4 / nEvents << " and " << newSize / 4 / nEvents << " pixels per event, " << nPixel * sizeof( float ) / 1024
+         << " kB calibrated frame not written" << endl;
+  }
+
+  return 0;
+}
@@ -0,0 +1,69 @@
+/*
+ *   This source code is part of the Eutelescope package of Marlin.
+ *   You are free to use this source files for your own development as
+ *   long as it stays in a public research context. You are not
+ *   allowed to use it for commercial purpose. You must put this
+ *   header with author names in all development based on this file.
+ *
+ */
+
+// personal include ".h"
+#include "EUTelSparseClusterEngine.h"
+#include "EUTelBenchmark.h"
+#include "SparseClusterReference.h"
+
+// system include <>
+#include <algorithm>
+#include <iostream>
+#include <iomanip>
+#include <random>
+#include <vector>
+
+using namespace std;
+using namespace eutelescope;
+
+const int xNPixel            = 1152;
+const int yNPixel            = 576;
+const int minDistanceSquared = 2;
+const int occupancy[]        = { 10, 100, 1000, 5000, 20000 };
+
+int main( int argc, char ** argv ) {
+
+  int const nFrame = benchmark::firstArgument( argc, argv, 100 );
+
+  mt19937 generator( 12345 );
+
+  EUTelSparseClusterEngine engine;
+  engine.setPixelIndexRange( 0, xNPixel - 1, 0, yNPixel - 1 );
+  engine.setMinDistanceSquared( minDistanceSquared );
+
+  cout << setw(10) << "pixels" << setw(12) << "clusters" << setw(18) << "reference [us]" << setw(18) << "grid [us]" << setw(12) << "speed-up" << endl;
+
+  for( size_t iOcc = 0; iOcc < sizeof(occupancy)/sizeof(occupancy[0]); ++iOcc ) {
+    vector<vector<short> > xFrames( nFrame ), yFrames( nFrame );
+    for( int iFrame = 0; iFrame < nFrame; ++iFrame ) {
+      reference::generateSparseFrame( generator, xNPixel, yNPixel, occupancy[iOcc], xFrames[iFrame], yFrames[iFrame] );
+    }
+
+    // the quadratic reference is only run on a subset for the highest occupancies
+    int nReference = occupancy[iOcc] > 1000 ? min( nFrame, 5 ) : nFrame;
+
+    chrono::steady_clock::time_point start = chrono::steady_clock::now();
+    for( int iFrame = 0; iFrame < nReference; ++iFrame ) {
+      reference::sparseClustering( xFrames[iFrame], yFrames[iFrame], minDistanceSquared );
+    }
+    double referenceTime = 1000. * benchmark::since( start ) / nReference;
+
+    start = chrono::steady_clock::now();
+    size_t nClusters = 0;
+    for( int iFrame = 0; iFrame < nFrame; ++iFrame ) {
+      nClusters += engine.cluster( &xFrames[iFrame][0], &yFrames[iFrame][0], xFrames[iFrame].size() );
+    }
+    double gridTime = 1000. * benchmark::since( start ) / nFrame;
+
+    cout << setw(10) << occupancy[iOcc] << setw(12) << nClusters / nFrame << setw(18) << fixed << setprecision(1) << referenceTime
+         << setw(18) << gridTime << setw(12) << referenceTime / gridTime << endl;
+  }
+
+  return 0;
+}
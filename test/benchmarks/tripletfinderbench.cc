@@ -0,0 +1,67 @@
+/*
+ *   This source code is part of the Eutelescope package of Marlin.
+ *   You are free to use this source files for your own development as
+ *   long as it stays in a public research context. You are not
+ *   allowed to use it for commercial purpose. You must put this
+ *   header with author names in all development based on this file.
+ *
+ */
+
+// personal include ".h"
+#include "EUTelTripletSearch.h"
+#include "EUTelBenchmark.h"
+#include "TripletReference.h"
+
+// system include <>
+#include <iomanip>
+#include <iostream>
+#include <random>
+#include <vector>
+
+using namespace std;
+using namespace eutelescope;
+using namespace reference;
+
+int main( int argc, char ** argv ) {
+
+  int const nEvents = benchmark::firstArgument( argc, argv, 200 );
+
+  EUTelTripletSearch search;
+  search.setResolution( resolution );
+  search.setScatteringAngle( scattering );
+
+  int const multiplicities[] = { 1, 2, 4, 8, 16, 32, 64, 128 };
+  cout << setw(8) << "tracks" << setw(16) << "triplet [us]" << setw(14) << "efficiency"
+       << setw(16) << "brute [us]" << setw(14) << "efficiency" << endl;
+
+  mt19937 generator( 4711 );
+  for( size_t m = 0; m < sizeof(multiplicities)/sizeof(int); ++m ) {
+    int const nTracks = multiplicities[m];
+    vector<GeneratedEvent> events;
+    for( int i = 0; i < nEvents; ++i ) events.push_back( generateEvent( generator, nTracks ) );
+
+    int findable = 0, tripletFound = 0, bruteFound = 0;
+    chrono::steady_clock::time_point start = chrono::steady_clock::now();
+    for( int i = 0; i < nEvents; ++i ) {
+      search.search( events[i].hits );
+      vector< vector<int> > tracks;
+      for( size_t t = 0; t < search.getTracks().size(); ++t ) tracks.push_back( search.getTracks()[t].hits );
+      tripletFound += countFound( events[i], tracks );
+      findable += countFindable( events[i] );
+    }
+    double const tripletTime = 1000.*benchmark::since( start )/nEvents;
+    double const tripletEfficiency = findable > 0 ? double(tripletFound)/findable : 1.;
+    cout << setw(8) << nTracks << setw(16) << fixed << setprecision(1) << tripletTime
+         << setw(14) << setprecision(4) << tripletEfficiency;
+
+    if( nTracks <= maxBruteForceTracks ) {
+      start = chrono::steady_clock::now();
+      for( int i = 0; i < nEvents; ++i ) bruteFound += countFound( events[i], bruteForce( events[i].hits ) );
+      double const bruteTime = 1000.*benchmark::since( start )/nEvents;
+      double const bruteEfficiency = findable > 0 ? double(bruteFound)/findable : 1.;
+      cout << setw(16) << setprecision(1) << bruteTime << setw(14) << setprecision(4) << bruteEfficiency;
+    }
+    cout << endl;
+  }
+  return 0;
+}
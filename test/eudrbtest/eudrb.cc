@@ -11,7 +11,7 @@
 
 
 // personal include ".h"
-#include "EUTelEUDRBReader.h"
+#include "EUTelEUDRBDecoder.h"
 
 #ifdef USE_GSL
 // gsl include <.h>
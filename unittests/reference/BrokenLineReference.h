@@ -0,0 +1,230 @@
+/*
+ *   This source code is part of the Eutelescope package of Marlin.
+ *   You are free to use this source files for your own development as
+ *   long as it stays in a public research context. You are not
+ *   allowed to use it for commercial purpose. You must put this
+ *   header with author names in all development based on this file.
+ *
+ */
+#ifndef BROKENLINEREFERENCE_H
+#define BROKENLINEREFERENCE_H
+
+// system includes <>
+#include <algorithm>
+#include <cmath>
+#include <random>
+#include <vector>
+
+namespace reference {
+
+  //! Six telescope planes and a DUT which is not used in the fit, positions in mm as in EUTelTestFitter
+  const int testFitterPlanes          = 7;
+  const int testFitterDut             = 3;
+  const double testFitterZ[]          = { 0., 150., 300., 450., 600., 750., 900. };
+  const double testFitterResolution   = 0.0043;
+  const double testFitterScatter      = 0.0005;
+  const double testFitterBeamSpread   = 0.001;
+  const double testFitterSlopeX       = 0.0004;
+  const double testFitterSlopeY       = -0.0002;
+
+  //! The dense fit of EUTelTestFitter: normal matrix, Gauss-Jordan inversion and chi2
+  class DenseFit {
+  public:
+    DenseFit(bool useBeamConstraint) : _useBeamConstraint( useBeamConstraint ),
+                                       _planeDist( testFitterPlanes ), _planeScat( testFitterPlanes ),
+                                       _fitArray( testFitterPlanes*testFitterPlanes ),
+                                       planeX( testFitterPlanes ), planeEx( testFitterPlanes ), planeY( testFitterPlanes ), planeEy( testFitterPlanes ),
+                                       fitX( testFitterPlanes ), fitEx( testFitterPlanes ), fitY( testFitterPlanes ), fitEy( testFitterPlanes ) {
+      for( int ipl = 0; ipl < testFitterPlanes; ipl++ ) {
+        if( ipl > 0 ) _planeDist[ipl-1] = 1./( testFitterZ[ipl] - testFitterZ[ipl-1] );
+        if( ipl == 0 && _useBeamConstraint ) _planeScat[ipl] = 1./( testFitterScatter*testFitterScatter + testFitterBeamSpread*testFitterBeamSpread );
+        else _planeScat[ipl] = 1./( testFitterScatter*testFitterScatter );
+      }
+    }
+
+    double matrixFit() {
+      for( int ipl = 0; ipl < testFitterPlanes; ipl++ ) {
+        fitX[ipl] = planeX[ipl];
+        fitEx[ipl] = planeEx[ipl];
+        fitY[ipl] = planeY[ipl];
+        fitEy[ipl] = planeEy[ipl];
+      }
+      if( doAnalFit( &fitX[0], &fitEx[0], testFitterSlopeX ) ) return -1.;
+      if( doAnalFit( &fitY[0], &fitEy[0], testFitterSlopeY ) ) return -1.;
+      return getFitChi2();
+    }
+
+    bool _useBeamConstraint;
+    std::vector<double> _planeDist, _planeScat, _fitArray;
+    std::vector<double> planeX, planeEx, planeY, planeEy;
+    std::vector<double> fitX, fitEx, fitY, fitEy;
+
+  private:
+    int doAnalFit(double * pos, double * err, double slope) {
+      for( int ipl = 0; ipl < testFitterPlanes; ipl++ ) {
+        err[ipl] = ( err[ipl] > 0 ) ? 1./err[ipl]/err[ipl] : 0.;
+        pos[ipl] *= err[ipl];
+      }
+      if( _useBeamConstraint && slope != 0. ) {
+        pos[0] -= slope*_planeDist[0]*_planeScat[0];
+        pos[1] += slope*_planeDist[0]*_planeScat[0];
+      }
+      for( int ipl = 0; ipl < testFitterPlanes; ipl++ ) {
+        for( int jpl = 0; jpl < testFitterPlanes; jpl++ ) {
+          int imx = ipl + jpl*testFitterPlanes;
+          _fitArray[imx] = 0.;
+          if( jpl == ipl-2 ) _fitArray[imx] += _planeDist[ipl-2]*_planeDist[ipl-1]*_planeScat[ipl-1];
+          if( jpl == ipl+2 ) _fitArray[imx] += _planeDist[ipl]*_planeDist[ipl+1]*_planeScat[ipl+1];
+          if( jpl == ipl-1 ) {
+            if( ipl > 0 && ipl < testFitterPlanes-1 ) _fitArray[imx] -= _planeDist[ipl-1]*( _planeDist[ipl] + _planeDist[ipl-1] )*_planeScat[ipl];
+            if( ipl > 1 ) _fitArray[imx] -= _planeDist[ipl-1]*( _planeDist[ipl-1] + _planeDist[ipl-2] )*_planeScat[ipl-1];
+          }
+          if( jpl == ipl+1 ) {
+            if( ipl > 0 && ipl < testFitterPlanes-1 ) _fitArray[imx] -= _planeDist[ipl]*( _planeDist[ipl] + _planeDist[ipl-1] )*_planeScat[ipl];
+            if( ipl < testFitterPlanes-2 ) _fitArray[imx] -= _planeDist[ipl]*( _planeDist[ipl+1] + _planeDist[ipl] )*_planeScat[ipl+1];
+          }
+          if( jpl == ipl ) {
+            _fitArray[imx] += err[ipl];
+            if( ipl > 0 && ipl < testFitterPlanes-1 ) _fitArray[imx] += _planeScat[ipl]*( _planeDist[ipl] + _planeDist[ipl-1] )*( _planeDist[ipl] + _planeDist[ipl-1] );
+            if( ipl > 1 ) _fitArray[imx] += _planeScat[ipl-1]*_planeDist[ipl-1]*_planeDist[ipl-1];
+            if( ipl < testFitterPlanes-2 ) _fitArray[imx] += _planeScat[ipl+1]*_planeDist[ipl]*_planeDist[ipl];
+          }
+          if( ipl == jpl && ipl < 2 && _useBeamConstraint ) _fitArray[imx] += _planeScat[0]*_planeDist[0]*_planeDist[0];
+          if( ipl + jpl == 1 && _useBeamConstraint ) _fitArray[imx] -= _planeScat[0]*_planeDist[0]*_planeDist[0];
+        }
+      }
+      int status = gaussjSolve( &_fitArray[0], pos, testFitterPlanes );
+      for( int ipl = 0; ipl < testFitterPlanes; ipl++ ) err[ipl] = status ? 0. : std::sqrt( _fitArray[ipl + ipl*testFitterPlanes] );
+      return status;
+    }
+
+    double getFitChi2() {
+      double chi2 = 0.;
+      for( int ipl = 0; ipl < testFitterPlanes; ipl++ ) {
+        if( planeEx[ipl] > 0. ) chi2 += ( fitX[ipl] - planeX[ipl] )*( fitX[ipl] - planeX[ipl] )/planeEx[ipl]/planeEx[ipl];
+        if( planeEy[ipl] > 0. ) chi2 += ( fitY[ipl] - planeY[ipl] )*( fitY[ipl] - planeY[ipl] )/planeEy[ipl]/planeEy[ipl];
+      }
+      for( int ipl = 1; ipl < testFitterPlanes-1; ipl++ ) {
+        double dth = ( fitX[ipl+1] - fitX[ipl] )*_planeDist[ipl] - ( fitX[ipl] - fitX[ipl-1] )*_planeDist[ipl-1];
+        chi2 += _planeScat[ipl]*dth*dth;
+        dth = ( fitY[ipl+1] - fitY[ipl] )*_planeDist[ipl] - ( fitY[ipl] - fitY[ipl-1] )*_planeDist[ipl-1];
+        chi2 += _planeScat[ipl]*dth*dth;
+      }
+      if( _useBeamConstraint ) {
+        double dth = ( fitX[1] - fitX[0] )*_planeDist[0] - testFitterSlopeX;
+        chi2 += _planeScat[0]*dth*dth;
+        dth = ( fitY[1] - fitY[0] )*_planeDist[0] - testFitterSlopeY;
+        chi2 += _planeScat[0]*dth*dth;
+      }
+      return chi2;
+    }
+
+    int gaussjSolve(double * alfa, double * beta, int n) {
+      std::vector<int> ipiv( n, 0 ), indxr( n ), indxc( n );
+      int irow = 0, icol = 0;
+      for( int i = 0; i < n; i++ ) {
+        double big = 0.;
+        for( int j = 0; j < n; j++ ) {
+          if( ipiv[j] == 1 ) continue;
+          for( int k = 0; k < n; k++ ) {
+            if( ipiv[k] != 0 ) continue;
+            if( std::fabs( alfa[n*j+k] ) > big ) {
+              big = std::fabs( alfa[n*j+k] );
+              irow = j;
+              icol = k;
+            }
+          }
+        }
+        if( ++ipiv[icol] > 1 ) return 1;
+        if( irow != icol ) {
+          std::swap( beta[irow], beta[icol] );
+          for( int j = 0; j < n; j++ ) std::swap( alfa[n*irow+j], alfa[n*icol+j] );
+        }
+        indxr[i] = irow;
+        indxc[i] = icol;
+        if( alfa[n*icol+icol] == 0. ) return 1;
+        double pivinv = 1./alfa[n*icol+icol];
+        alfa[n*icol+icol] = 1.;
+        for( int j = 0; j < n; j++ ) alfa[n*icol+j] *= pivinv;
+        beta[icol] *= pivinv;
+        for( int j = 0; j < n; j++ ) {
+          if( j == icol ) continue;
+          double help = alfa[n*j+icol];
+          alfa[n*j+icol] = 0.;
+          for( int k = 0; k < n; k++ ) alfa[n*j+k] -= alfa[n*icol+k]*help;
+          beta[j] -= beta[icol]*help;
+        }
+      }
+      for( int i = n-1; i >= 0; i-- ) {
+        if( indxr[i] == indxc[i] ) continue;
+        for( int j = 0; j < n; j++ ) std::swap( alfa[n*j+indxr[i]], alfa[n*j+indxc[i]] );
+      }
+      return 0;
+    }
+  };
+
+  //! A hit of a generated event, in mm
+  struct TestFitterHit {
+    double x;
+    double y;
+  };
+
+  //! Hits of one event: a few tracks and no noise, every plane sees every track
+  inline std::vector< std::vector<TestFitterHit> > generateTestFitterEvent(std::mt19937& generator, int nTracks) {
+    std::normal_distribution<double> gauss( 0., 1. );
+    std::uniform_real_distribution<double> flat( -5., 5. );
+    std::vector< std::vector<TestFitterHit> > hits( testFitterPlanes );
+    for( int iTrack = 0; iTrack < nTracks; ++iTrack ) {
+      double x = flat( generator ), y = flat( generator );
+      double tx = testFitterSlopeX + testFitterBeamSpread*gauss( generator ), ty = testFitterSlopeY + testFitterBeamSpread*gauss( generator );
+      for( int ipl = 0; ipl < testFitterPlanes; ++ipl ) {
+        if( ipl > 0 ) {
+          x += tx*( testFitterZ[ipl] - testFitterZ[ipl-1] );
+          y += ty*( testFitterZ[ipl] - testFitterZ[ipl-1] );
+        }
+        TestFitterHit hit = { x + testFitterResolution*gauss( generator ), y + testFitterResolution*gauss( generator ) };
+        hits[ipl].push_back( hit );
+        tx += testFitterScatter*gauss( generator );
+        ty += testFitterScatter*gauss( generator );
+      }
+    }
+    return hits;
+  }
+
+  //! Loop over all hit selections in the order of EUTelTestFitter, the first plane changes slowest
+  /*! Every plane has one choice more than hits for a missing hit, fit
+   *  is called for every selection with at least two hits and the sum of
+   *  the values it returns is returned.
+   */
+  template <class Fit>
+  double loopChoices(std::vector< std::vector<TestFitterHit> > const& hits, Fit fit) {
+    std::vector<long> planeMod( testFitterPlanes, 1 );
+    for( int ipl = testFitterPlanes-2; ipl >= 0; ipl-- ) {
+      int const nChoice = ( ipl+1 == testFitterDut ) ? 1 : hits[ipl+1].size() + 1;
+      planeMod[ipl] = planeMod[ipl+1]*nChoice;
+    }
+    long const nChoice = planeMod[0]*( hits[0].size() + 1 );
+    double sum = 0.;
+    std::vector<TestFitterHit> selection( testFitterPlanes );
+    std::vector<bool> used( testFitterPlanes );
+    for( long ichoice = nChoice-1; ichoice >= 0; ichoice-- ) {
+      int nFired = 0;
+      for( int ipl = 0; ipl < testFitterPlanes; ipl++ ) {
+        used[ipl] = false;
+        if( ipl == testFitterDut ) continue;
+        size_t const ihit = ( ichoice/planeMod[ipl] ) % ( hits[ipl].size() + 1 );
+        if( ihit < hits[ipl].size() ) {
+          selection[ipl] = hits[ipl][ihit];
+          used[ipl] = true;
+          nFired++;
+        }
+      }
+      if( nFired < 2 ) continue;
+      sum += fit( selection, used );
+    }
+    return sum;
+  }
+
+} //namespace
+
+#endif
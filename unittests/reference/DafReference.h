@@ -0,0 +1,238 @@
+/*
+ *   This source code is part of the Eutelescope package of Marlin.
+ *   You are free to use this source files for your own development as
+ *   long as it stays in a public research context. You are not
+ *   allowed to use it for commercial purpose. You must put this
+ *   header with author names in all development based on this file.
+ *
+ */
+#ifndef DAFREFERENCE_H
+#define DAFREFERENCE_H
+
+// eutelescope includes ".h"
+#include "EUTelDafTrackerSystem.h"
+
+// system includes <>
+#include <algorithm>
+#include <cmath>
+#include <random>
+#include <vector>
+
+namespace reference {
+
+  typedef daffitter::TrackerSystem<float,4> DafSystem;
+
+  //! Six telescope planes, positions in um as in EUTelDafBase
+  const int dafPlanes            = 6;
+  const float dafPlaneDistance   = 150000.;
+  const float dafResolution      = 4.3;
+  const float dafScatterVar      = 3e-9;
+  const float dafBeamDivergence  = 1e-4;
+  const float dafNoisePerPlane   = 2.;
+  const float dafEfficiency      = 0.99;
+
+  //! The hits of an event and the true tracks
+  struct DafEvent {
+    std::vector< std::vector<float> > x, y;
+    // index of the hit of every true track on every plane, -1 if inefficient
+    std::vector< std::vector<int> > truth;
+  };
+
+  //! An event of nTracks tracks with multiple scattering, 99% plane efficiency and two noise hits per plane
+  inline DafEvent generateDafEvent(std::mt19937& generator, int nTracks) {
+    std::normal_distribution<float> gauss( 0., 1. );
+    std::uniform_real_distribution<float> flat( 0., 1. );
+    DafEvent event;
+    event.x.resize( dafPlanes );
+    event.y.resize( dafPlanes );
+    event.truth.assign( nTracks, std::vector<int>( dafPlanes, -1 ) );
+    for( int iTrack = 0; iTrack < nTracks; ++iTrack ) {
+      float x = 20000.*( flat( generator ) - 0.5 ), y = 10000.*( flat( generator ) - 0.5 );
+      float tx = dafBeamDivergence*gauss( generator ), ty = dafBeamDivergence*gauss( generator );
+      for( int plane = 0; plane < dafPlanes; ++plane ) {
+        if( plane > 0 ) {
+          x += tx*dafPlaneDistance;
+          y += ty*dafPlaneDistance;
+        }
+        if( flat( generator ) < dafEfficiency ) {
+          event.truth[iTrack][plane] = static_cast<int>( event.x[plane].size() );
+          event.x[plane].push_back( x + dafResolution*gauss( generator ) );
+          event.y[plane].push_back( y + dafResolution*gauss( generator ) );
+        }
+        tx += std::sqrt( dafScatterVar )*gauss( generator );
+        ty += std::sqrt( dafScatterVar )*gauss( generator );
+      }
+    }
+    std::poisson_distribution<int> noise( dafNoisePerPlane );
+    for( int plane = 0; plane < dafPlanes; ++plane ) {
+      for( int i = noise( generator ); i > 0; --i ) {
+        event.x[plane].push_back( 20000.f*( flat( generator ) - 0.5f ) );
+        event.y[plane].push_back( 10000.f*( flat( generator ) - 0.5f ) );
+      }
+    }
+    return event;
+  }
+
+  //! Add the planes to a system, init() is still to be called
+  inline void addDafPlanes(DafSystem& system) {
+    for( int plane = 0; plane < dafPlanes; ++plane ) {
+      system.addPlane( plane, plane*dafPlaneDistance, dafResolution, dafResolution, dafScatterVar, false );
+    }
+  }
+
+  //! A system finding its candidates with clusterTracker, as used for the batched DAF fit
+  inline void setupClusterTracker(DafSystem& system) {
+    addDafPlanes( system );
+    system.setMaxCandidates( 1000 );
+    system.init( true );
+    system.setClusterRadius( 300. );
+    system.setMinClusterSize( 4 );
+    system.setDAFChi2Cut( 300. );
+  }
+
+  //! Clear the system and add the hits of the event
+  inline void fillDafEvent(DafSystem& system, DafEvent const& event) {
+    system.clear();
+    for( int plane = 0; plane < dafPlanes; ++plane ) {
+      for( size_t i = 0; i < event.x[plane].size(); ++i ) {
+        system.addMeasurement( plane, event.x[plane][i], event.y[plane][i], plane*dafPlaneDistance, true, plane );
+      }
+    }
+  }
+
+  //! Fit the candidates of the system one at a time, as EUTelDafFitter does without BatchedFit
+  inline void fitDafScalar(DafSystem& system) {
+    for( size_t t = 0; t < system.getNtracks(); ++t ) {
+      system.fitPlanesInfoDaf( system.tracks[t] );
+    }
+  }
+
+  //! Track finding with combinatorialKF()
+  const float ckfChi2Cut         = 25.;
+  const size_t ckfMaxCandidates  = 100;
+  // TrackerSystem skips at most two planes
+  const size_t ckfSkipMax        = 2;
+
+  //! A system finding its candidates with combinatorialKF(), the beam search of the given width, 0 for the depth first search
+  inline void setupCKF(DafSystem& system, size_t beamWidth) {
+    addDafPlanes( system );
+    system.setMaxCandidates( ckfMaxCandidates );
+    system.init( true );
+    system.setCKFChi2Cut( ckfChi2Cut );
+    system.setChi2OverNdofCut( 9999. );
+    if( beamWidth > 0 ) {
+      system.setCKFBeamSearch( true );
+      system.setCKFBeamWidth( beamWidth );
+    }
+  }
+
+  //! The depth first search of combinatorialKF() without the beam search, the first candidates found are kept
+  struct DepthFirst {
+    DafSystem& system;
+    std::vector< std::vector<int> > tracks;
+    std::vector< daffitter::TrackCandidate<float,4> > candidates;
+    explicit DepthFirst(DafSystem& s) : system(s) {}
+
+    void finalize(daffitter::TrackEstimate<float,4>& est, std::vector<int> const& indexes, int nMeas, float chi2) {
+      daffitter::fastInvert( est.cov );
+      est.params = est.cov * est.params;
+      if( std::fabs( est.getXdz() - system.getNominalXdz() ) > system.getXdzMaxDeviance() or
+          std::fabs( est.getYdz() - system.getNominalYdz() ) > system.getYdzMaxDeviance() ) return;
+      if( chi2/( nMeas*2 - 4 ) > system.getChi2OverNdofCut() ) return;
+      daffitter::TrackCandidate<float,4> candidate( dafPlanes );
+      candidate.ndof = nMeas*2 - 4;
+      candidate.chi2 = chi2;
+      candidate.indexes = indexes;
+      system.indexToWeight( candidate );
+      candidates.push_back( candidate );
+      tracks.push_back( indexes );
+    }
+
+    void permutation(int plane, daffitter::TrackEstimate<float,4>& est, size_t nSkipped, std::vector<int>& indexes, int nMeas, float chi2) {
+      if( tracks.size() >= ckfMaxCandidates ) return;
+      if( plane == dafPlanes ) {
+        finalize( est, indexes, nMeas, chi2 );
+        return;
+      }
+      std::vector< daffitter::FitPlane<float> >& planes = system.planes;
+      if( nMeas > 1 ) system.m_fitter.addScatteringInfo( planes[plane - 1], est );
+      system.m_fitter.predictInfo( planes[plane - 1], planes[plane], est );
+      size_t nTracks = tracks.size();
+      Eigen::Matrix<float,2,1> resv, errv;
+      Eigen::Matrix<float,4,1> state;
+      double chi2m = 0, oldX = 0, oldY = 0, oldZ = 0;
+      if( nMeas > 1 ) {
+        Eigen::Matrix<float,4,4> tmp4x4 = est.cov;
+        daffitter::fastInvert( tmp4x4 );
+        state = tmp4x4 * est.params;
+        errv = planes[plane].getSigmas().array().square() + tmp4x4.diagonal().head(2).array();
+      }
+      if( nMeas == 1 ) {
+        for( int ii = 0; ii < plane; ii++ ) {
+          if( indexes[ii] >= 0 ) {
+            oldX = planes[ii].meas[indexes[ii]].getX();
+            oldY = planes[ii].meas[indexes[ii]].getY();
+            oldZ = planes[ii].getZpos();
+            break;
+          }
+        }
+      }
+      for( int hit = 0; hit < (int)planes[plane].meas.size(); hit++ ) {
+        daffitter::Measurement<float>& mm = planes[plane].meas[hit];
+        bool filterMeas = false;
+        if( nMeas > 1 ) {
+          resv = ( state.head(2) - mm.getM() ).array().square();
+          chi2m = ( resv.array()/errv.array() ).sum();
+          filterMeas = chi2m < system.getCKFChi2Cut();
+        } else {
+          double newZ = planes[plane].getZpos();
+          filterMeas = std::fabs( ( mm.getX() - oldX )/( newZ - oldZ ) - system.getNominalXdz() ) < system.getXdzMaxDeviance() and
+                       std::fabs( ( mm.getY() - oldY )/( newZ - oldZ ) - system.getNominalYdz() ) < system.getYdzMaxDeviance();
+        }
+        if( filterMeas ) {
+          daffitter::TrackEstimate<float,4> clone( est );
+          system.m_fitter.updateInfo( planes[plane], hit, clone );
+          indexes[plane] = hit;
+          permutation( plane + 1, clone, nSkipped, indexes, nMeas + 1, chi2 + chi2m );
+        }
+      }
+      if( nTracks == tracks.size() and nSkipped < ckfSkipMax ) {
+        indexes[plane] = -1;
+        permutation( plane + 1, est, nSkipped + 1, indexes, nMeas, chi2 );
+      }
+    }
+
+    void search() {
+      tracks.clear();
+      candidates.clear();
+      std::vector<int> indexes( dafPlanes, -1 );
+      daffitter::TrackEstimate<float,4> e;
+      for( size_t ii = 0; ii < ckfSkipMax + 1; ii++ ) {
+        if( ii > 0 ) indexes[ii - 1] = -1;
+        for( size_t hit = 0; hit < system.planes[ii].meas.size(); hit++ ) {
+          bool used = false;
+          for( size_t t = 0; t < tracks.size() and ii > 0; t++ ) {
+            if( tracks[t][ii] == static_cast<int>(hit) ) used = true;
+          }
+          if( used ) continue;
+          e.makeSeedInfo();
+          indexes[ii] = hit;
+          system.m_fitter.updateInfo( system.planes[ii], hit, e );
+          permutation( ii + 1, e, ii, indexes, 1, 0.0f );
+        }
+      }
+    }
+  };
+
+  //! True tracks found by a search, a candidate must have all the hits of the track
+  inline int countFound(DafEvent const& event, std::vector< std::vector<int> > const& tracks) {
+    int found = 0;
+    for( size_t iTrue = 0; iTrue < event.truth.size(); ++iTrue ) {
+      if( std::find( tracks.begin(), tracks.end(), event.truth[iTrue] ) != tracks.end() ) ++found;
+    }
+    return found;
+  }
+
+} //namespace
+
+#endif
@@ -0,0 +1,137 @@
+/*
+ *   This source code is part of the Eutelescope package of Marlin.
+ *   You are free to use this source files for your own development as
+ *   long as it stays in a public research context. You are not
+ *   allowed to use it for commercial purpose. You must put this
+ *   header with author names in all development based on this file.
+ *
+ */
+#ifndef MILLEREFERENCE_H
+#define MILLEREFERENCE_H
+
+// system includes <>
+#include <fstream>
+#include <iterator>
+#include <random>
+#include <string>
+#include <vector>
+
+namespace reference {
+
+  //! Tracks of six planes as written by EUTelMille in AlignMode 2
+  /*! 4 local and 12 global parameters, an X and a Y measurement per plane
+   */
+  const int millePlanes = 6;
+  const int milleLocal  = 4;
+  const int milleGlobal = 2 * millePlanes;
+
+  //! Writes records like Mille does: the record is built in a buffer and written from the calling thread by end()
+  class SyncMille {
+  public:
+    explicit SyncMille(std::string const& fileName) : _file( fileName.c_str(), std::ios::binary | std::ios::out ), _floats(), _ints() {}
+
+    void mille(int nLocal, float const* derLocal, int nGlobal, float const* derGlobal,
+               int const* label, float measurement, float sigma) {
+      if( sigma <= 0. ) return;
+      if( _floats.empty() ) {
+        _floats.push_back( 0. );
+        _ints.push_back( 0 );
+      }
+      _floats.push_back( measurement );
+      _ints.push_back( 0 );
+      for( int i = 0; i < nLocal; ++i ) {
+        if( derLocal[i] ) {
+          _floats.push_back( derLocal[i] );
+          _ints.push_back( i + 1 );
+        }
+      }
+      _floats.push_back( sigma );
+      _ints.push_back( 0 );
+      for( int i = 0; i < nGlobal; ++i ) {
+        if( derGlobal[i] && label[i] > 0 ) {
+          _floats.push_back( derGlobal[i] );
+          _ints.push_back( label[i] );
+        }
+      }
+    }
+
+    void end() {
+      if( _floats.size() > 1 ) {
+        int const words = 2 * _floats.size();
+        _file.write( reinterpret_cast<char const*>( &words ), sizeof( words ) );
+        _file.write( reinterpret_cast<char const*>( &_floats[0] ), _floats.size() * sizeof( float ) );
+        _file.write( reinterpret_cast<char const*>( &_ints[0] ), _ints.size() * sizeof( int ) );
+      }
+      _floats.clear();
+      _ints.clear();
+    }
+
+  private:
+    std::ofstream _file;
+    std::vector<float> _floats;
+    std::vector<int> _ints;
+  };
+
+  //! The residuals of a track on every plane, in um
+  struct MilleTrack {
+    float residual[2 * millePlanes];
+    float z[millePlanes];
+    float chi2;
+    int ndf;
+  };
+
+  //! Tracks with a resolution of 3.5 um, always the same ones
+  inline std::vector<MilleTrack> generateMilleTracks(int nTracks) {
+    std::mt19937 generator( 4711 );
+    std::normal_distribution<float> gauss( 0., 1. );
+    std::vector<MilleTrack> tracks( nTracks );
+    for( int t = 0; t < nTracks; ++t ) {
+      tracks[t].chi2 = 0.;
+      for( int i = 0; i < 2 * millePlanes; ++i ) {
+        tracks[t].residual[i] = 3.5f * gauss( generator );
+        tracks[t].chi2 += tracks[t].residual[i] * tracks[t].residual[i] / 3.5f / 3.5f;
+      }
+      for( int i = 0; i < millePlanes; ++i ) tracks[t].z[i] = 150000.f * i;
+      tracks[t].ndf = 2 * millePlanes - 4;
+    }
+    return tracks;
+  }
+
+  //! The measurements of one track, as in EUTelMille::processEvent
+  template <class Writer>
+  void addMilleTrack(Writer& writer, MilleTrack const& track) {
+    float derLC[milleLocal] = { 0., 0., 0., 0. };
+    float derGL[milleGlobal];
+    int label[milleGlobal];
+    for( int i = 0; i < milleGlobal; ++i ) {
+      derGL[i] = 0.;
+      label[i] = i + 1;
+    }
+    for( int plane = 0; plane < millePlanes; ++plane ) {
+      derGL[2 * plane] = -1;
+      derLC[0] = 1;
+      derLC[2] = track.z[plane];
+      writer.mille( milleLocal, derLC, milleGlobal, derGL, label, track.residual[2 * plane], 3.5 );
+      derGL[2 * plane] = 0;
+      derLC[0] = 0;
+      derLC[2] = 0;
+
+      derGL[2 * plane + 1] = -1;
+      derLC[1] = 1;
+      derLC[3] = track.z[plane];
+      writer.mille( milleLocal, derLC, milleGlobal, derGL, label, track.residual[2 * plane + 1], 3.5 );
+      derGL[2 * plane + 1] = 0;
+      derLC[1] = 0;
+      derLC[3] = 0;
+    }
+  }
+
+  //! The whole content of a file
+  inline std::string readFile(std::string const& fileName) {
+    std::ifstream file( fileName.c_str(), std::ios::binary );
+    return std::string( std::istreambuf_iterator<char>( file ), std::istreambuf_iterator<char>() );
+  }
+
+} //namespace
+
+#endif
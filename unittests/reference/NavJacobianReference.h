@@ -0,0 +1,137 @@
+/*
+ *   This source code is part of the Eutelescope package of Marlin.
+ *   You are free to use this source files for your own development as
+ *   long as it stays in a public research context. You are not
+ *   allowed to use it for commercial purpose. You must put this
+ *   header with author names in all development based on this file.
+ *
+ */
+#ifndef NAVJACOBIANREFERENCE_H
+#define NAVJACOBIANREFERENCE_H
+
+// ROOT
+#include "TMatrixD.h"
+#include "TMatrixDSym.h"
+#include "TVector3.h"
+
+// system includes <>
+#include <cmath>
+#include <vector>
+
+namespace reference {
+
+  //! The original EUTelNav::getMeasToGlobal, with the rotation passed in
+  inline TMatrixD measToGlobal(TVector3 t1w, TMatrixD const& rotation) {
+    TMatrixD transM2l(5,5);
+    transM2l.UnitMatrix();
+    std::vector<double> slope;
+    slope.push_back(t1w[0]/t1w[2]); slope.push_back(t1w[1]/t1w[2]);
+    double norm = std::sqrt(pow(slope.at(0),2) + pow(slope.at(1),2) + 1);
+    TVector3 direction;
+    direction[0] = (slope.at(0)/norm); direction[1] =(slope.at(1)/norm);	direction[2] = (1.0/norm);
+    TMatrixD xyDir(2, 3);
+    xyDir[0][0] = 1; xyDir[0][1]=0.0; xyDir[0][2]=-slope.at(0);
+    xyDir[1][0] = 0; xyDir[1][1]=1.0; xyDir[1][2]=-slope.at(1);
+    TMatrixD TRotMatrix(3,3);
+    TRotMatrix = rotation;
+    TVector3 normalVec;
+    normalVec[0] = TRotMatrix[0][2];	normalVec[1] = TRotMatrix[1][2];	normalVec[2] = TRotMatrix[2][2];
+    double cosInc = direction*normalVec;
+    TMatrixD measDir(3,2);
+    measDir[0][0] = TRotMatrix[0][0];	measDir[0][1] = TRotMatrix[0][1];
+    measDir[1][0] = TRotMatrix[1][0];	measDir[1][1] = TRotMatrix[1][1];
+    measDir[2][0] = TRotMatrix[2][0];	measDir[2][1] = TRotMatrix[2][1];
+    double scaleFactor = cosInc/direction[2];
+    TMatrixD proM2l(2,2);
+    proM2l = xyDir*measDir;
+    TMatrixD proM2lInc = scaleFactor*proM2l;
+    transM2l.SetSub(1,1,proM2lInc);
+    transM2l.SetSub(3,3,proM2l);
+    return transM2l;
+  }
+
+  //! The original EUTelNav::getPropagationJacobianGlobalToGlobal, with the field passed in
+  inline TMatrixD globalToGlobal(float ds, TVector3 t1w, TVector3 const& b) {
+    std::vector<double> slope;
+    slope.push_back(t1w[0]/t1w[2]); slope.push_back(t1w[1]/t1w[2]);
+    double norm = std::sqrt(pow(slope.at(0),2) + pow(slope.at(1),2) + 1);
+    TVector3 direction;
+    direction[0] = (slope.at(0)/norm); direction[1] =(slope.at(1)/norm);	direction[2] = (1.0/norm);
+    double sinLambda = direction[2];
+    TVector3 BxT = b.Cross(direction);
+    TMatrixD xyDir(2, 3);
+    xyDir[0][0] = 1.0; xyDir[0][1]=0.0; xyDir[0][2]=-slope.at(0);
+    xyDir[1][0] = 0; xyDir[1][1]=1.0; xyDir[1][2]=-slope.at(1);
+    TMatrixD bFac(2,1);
+    TMatrixD BxTMatrix(3,1);
+    BxTMatrix.Zero();
+    BxTMatrix[0][0] =BxT[0];	BxTMatrix[1][0] =BxT[1];	BxTMatrix[2][0] =BxT[2];
+    bFac = -0.0002998 * (xyDir*BxTMatrix);
+    TMatrixD ajac(5, 5);
+    ajac.UnitMatrix();
+    if(b.Mag() < 0.001 ){
+      ajac[3][2] = ds * std::sqrt(t1w[0] * t1w[0] + t1w[2] * t1w[2]);
+      ajac[4][1] = ds;
+    }else{
+      ajac[1][0] = bFac[0][0]*ds/sinLambda;
+      ajac[2][0] = bFac[1][0]*ds/sinLambda;
+      ajac[3][0] = 0.5*bFac[0][0]*ds*ds;
+      ajac[4][0] = 0.5*bFac[1][0]*ds*ds;
+      ajac[3][1] = ds*sinLambda;
+      ajac[4][2] = ds*sinLambda;
+    }
+    return ajac;
+  }
+
+  //! The original EUTelNav::setPrecision
+  inline TMatrixD setPrecision(TMatrixD mat, double mod) {
+    for(int i=0; i < mat.GetNrows(); i++){
+      for(int j=0; j < mat.GetNcols(); j++){
+        if(std::abs(mat[j][i]) < mod) mat[j][i] = 0;
+      }
+    }
+    return mat;
+  }
+
+  //! A global vector in the frame of a plane with the given rotation
+  inline TVector3 toLocal(TVector3 const& global, TMatrixD const& rotation) {
+    TVector3 local;
+    for( int i = 0; i < 3; ++i ) local[i] = rotation[0][i]*global[0] + rotation[1][i]*global[1] + rotation[2][i]*global[2];
+    return local;
+  }
+
+  //! The original EUTelGBLFitter::getFullJacobian, with the rotations of both planes and the field passed in
+  inline TMatrixD fullJacobian(TVector3 mom, TMatrixD const& startRotation, TMatrixD const& endRotation, double distance,
+                               TVector3 const& b, double minJacobian) {
+    TMatrixD simpleJacobian = globalToGlobal(distance, mom.Unit(), b);
+    TMatrixD localToGlobalJacobianStart = measToGlobal(toLocal(mom, startRotation), startRotation);
+    TMatrixD localToGlobalJacobianEnd = measToGlobal(toLocal(mom, endRotation), endRotation);
+    TMatrixD globalToLocalJacobianEnd = localToGlobalJacobianEnd.Invert();
+    TMatrixD localToNextLocalJacobian = globalToLocalJacobianEnd*simpleJacobian*localToGlobalJacobianStart;
+    return setPrecision(localToNextLocalJacobian, minJacobian);
+  }
+
+  //! The original EUTelState::getScatteringVarianceInLocalFrame
+  inline TMatrixDSym scatteringPrecision(TVector3 const& momLocal, double variance) {
+    TVector3 unit = momLocal.Unit();
+    float c1 = unit[0]; float c2 = unit[1];
+    TMatrixDSym precisionMatrix(2);
+    float factor = (1.0/variance)/pow((1-pow(c1,2)-pow(c2,2)),2);
+    precisionMatrix[0][0]=factor*(1-pow(c2,2));
+    precisionMatrix[1][0]=factor*c1*c2;				precisionMatrix[1][1]=factor*(1-pow(c1,2));
+    return precisionMatrix;
+  }
+
+  //! The original EUTelState::getProjectionMatrix, which returns the 2x2 unit matrix
+  inline TMatrixD projection() {
+    TMatrixD projection(5,5);
+    projection.Zero();
+    TMatrixD proM2l(2, 2);
+    proM2l.UnitMatrix();
+    projection.SetSub(3, 3, proM2l);
+    return proM2l;
+  }
+
+} //namespace
+
+#endif
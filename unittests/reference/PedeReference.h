@@ -0,0 +1,81 @@
+/*
+ *   This source code is part of the Eutelescope package of Marlin.
+ *   You are free to use this source files for your own development as
+ *   long as it stays in a public research context. You are not
+ *   allowed to use it for commercial purpose. You must put this
+ *   header with author names in all development based on this file.
+ *
+ */
+#ifndef PEDEREFERENCE_H
+#define PEDEREFERENCE_H
+
+// eutelescope includes ".h"
+#include "EUTelPStream.h"
+
+// system includes <>
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <sys/stat.h>
+
+namespace reference {
+
+  //! Write a shell script standing for pede
+  /*! It prints output like pede in several pieces, with a pause in
+   *  seconds in between, and writes a millepede.res with the X shift
+   *  read from the steering file, the Y shift fixed. 12 lines go to
+   *  stdout, one to stderr.
+   */
+  inline void writeFakePede(std::string const& fileName, double pause) {
+    std::ofstream script( fileName.c_str() );
+    script << "#!/bin/sh\n"
+           << "shift=`cat $1`\n"
+           << "echo ' NREC =      50000  = number of records'\n"
+           << "for i in 1 2 3 4 5; do sleep " << pause << "; echo \" it $i  fc 4711.0\"; done\n"
+           << "echo ' warning: a message on stderr' >&2\n"
+           << "echo ' Data rejected in last iteration:   '\n"
+           << "echo '            0  (rank deficit/NaN)            0  (Ndf=0)   '\n"
+           << "echo '           12  (huge)                       35  (large)'\n"
+           << "echo ' Sum(Chi^2)/Sum(Ndf) =      45123.4'\n"
+           << "echo '                     / (     48000 -    24 ) =      0.9405'\n"
+           << "echo ' Parameter   ! first 3 elements per line are significant (if used as input)' > millepede.res\n"
+           << "echo \"        1  $shift      0.0000     $shift   0.1234E-02\" >> millepede.res\n"
+           << "echo '        2  0.0000000     -1.0000' >> millepede.res\n"
+           << "exit 0\n";
+    script.close();
+    chmod( fileName.c_str(), 0755 );
+  }
+
+  //! The loop of EUTelMille::end before EUTelPedeDriver, polls stdout and stderr until pede exits
+  /*! @return The exit status of the command, its stdout in output
+   */
+  inline int runPStream(std::string const& command, std::string& output) {
+    redi::ipstream pede( command.c_str(), redi::pstreams::pstdout|redi::pstreams::pstderr );
+    char buf[1024];
+    std::streamsize n;
+    std::stringstream pedeoutput;
+    bool finished[2] = { false, false };
+    while( !finished[0] || !finished[1] ) {
+      if( !finished[0] ) {
+        while( ( n = pede.err().readsome( buf, sizeof( buf ) ) ) > 0 ) {}
+        if( pede.eof() ) {
+          finished[0] = true;
+          if( !finished[1] ) pede.clear();
+        }
+      }
+      if( !finished[1] ) {
+        while( ( n = pede.out().readsome( buf, sizeof( buf ) ) ) > 0 ) pedeoutput << std::string( buf, n );
+        if( pede.eof() ) {
+          finished[1] = true;
+          if( !finished[0] ) pede.clear();
+        }
+      }
+    }
+    pede.close();
+    output = pedeoutput.str();
+    return pede.rdbuf()->status();
+  }
+
+} //namespace
+
+#endif
@@ -0,0 +1,178 @@
+/*
+ *   This source code is part of the Eutelescope package of Marlin.
+ *   You are free to use this source files for your own development as
+ *   long as it stays in a public research context. You are not
+ *   allowed to use it for commercial purpose. You must put this
+ *   header with author names in all development based on this file.
+ *
+ */
+#ifndef PIXELACCUMULATORREFERENCE_H
+#define PIXELACCUMULATORREFERENCE_H
+
+// eutelescope includes ".h"
+#include "EUTelPixelAccumulator.h"
+
+// system includes <>
+#include <algorithm>
+#include <cmath>
+#include <cstdlib>
+#include <vector>
+
+namespace reference {
+
+  //! Full frames of a sensor with the true pedestal and noise of every pixel
+  struct PixelFrames {
+    std::vector<float> truePede;
+    std::vector<float> trueNoise;
+    std::vector< std::vector<short> > frames;
+    //! Every 997th pixel is bad
+    std::vector<short> status;
+  };
+
+  //! The signal of a pixel, rounded to ADC counts, with a hit of 200 ADC in one of hitOneIn events
+  inline short pixelSignal(double pedestal, double noise, int hitOneIn) {
+    double const gauss = ( std::rand() % 1000 + std::rand() % 1000 + std::rand() % 1000 - 1498.5 ) / 500.;
+    double signal = pedestal + noise * gauss;
+    if( std::rand() % hitOneIn == 0 ) signal += 200;
+    return static_cast<short>( std::floor( signal + 0.5 ) );
+  }
+
+  //! Pedestals between 50 and 150 ADC, noise 2 to 4 ADC, a common mode per event and a few hits, from std::rand()
+  inline PixelFrames generatePixelFrames(int nPixel, int nEvents) {
+    PixelFrames data;
+    data.truePede.resize( nPixel );
+    data.trueNoise.resize( nPixel );
+    for( int iPixel = 0; iPixel < nPixel; ++iPixel ) {
+      data.truePede[iPixel]  = 50 + std::rand() % 100;
+      data.trueNoise[iPixel] = 2 + 2. * std::rand() / RAND_MAX;
+    }
+    data.frames.assign( nEvents, std::vector<short>( nPixel ) );
+    for( int iEvent = 0; iEvent < nEvents; ++iEvent ) {
+      double const commonMode = 4. * std::rand() / RAND_MAX - 2.;
+      for( int iPixel = 0; iPixel < nPixel; ++iPixel ) {
+        data.frames[iEvent][iPixel] = pixelSignal( data.truePede[iPixel] + commonMode, data.trueNoise[iPixel], 10000 );
+      }
+    }
+    data.status.assign( nPixel, 0 );
+    for( int iPixel = 0; iPixel < nPixel; iPixel += 997 ) data.status[iPixel] = 1;
+    return data;
+  }
+
+  //! The MeanRMS update of EUTelPedestalNoiseProcessor::firstLoop before EUTelPixelAccumulator, including the copy of the ADC values
+  inline void oldMeanRMS(std::vector<short> const& frame, std::vector<float>& pede, std::vector<float>& noise, std::vector<int>& entries) {
+    std::vector<short> adcValues = frame;
+    for( size_t iPixel = 0; iPixel < adcValues.size(); ++iPixel ) {
+      short currentVal = adcValues[iPixel];
+      entries[iPixel] = entries[iPixel] + 1;
+      pede[iPixel]    = ( ( entries[iPixel] - 1 ) * pede[iPixel] + currentVal ) / entries[iPixel];
+      noise[iPixel]   = std::sqrt( ( ( entries[iPixel] - 1 ) * std::pow( noise[iPixel], 2 ) + std::pow( currentVal - pede[iPixel], 2 ) ) / entries[iPixel] );
+    }
+  }
+
+  //! The row wise common mode of EUTelCalibrateEventProcessor before commonModeSum, including the copies of the ancillary vectors
+  /*! @return The number of skipped rows
+   */
+  inline int oldRowWise(std::vector<short> const& frame, std::vector<float> const& pede, std::vector<float> const& noise,
+                        std::vector<short> const& status, int nXPixel, float cut, std::vector<float>& commonModeCorVec) {
+    std::vector<short> adcValues = frame;
+    std::vector<float> pedestal = pede;
+    std::vector<short> statusVec = status;
+    std::vector<float> noiseVec = noise;
+    commonModeCorVec.clear();
+    int const nYPixel = adcValues.size() / nXPixel;
+    int iPixel = 0, skippedRow = 0;
+    for( int y = 0; y < nYPixel; ++y ) {
+      double pixelSum = 0.;
+      int goodPixel = 0, skippedPixelPerRow = 0;
+      for( int x = 0; x < nXPixel; ++x ) {
+        bool isHit  = ( adcValues[iPixel] - pedestal[iPixel] ) > cut * noiseVec[iPixel];
+        bool isGood = statusVec[iPixel] == 0;
+        if( !isHit && isGood ) {
+          pixelSum += adcValues[iPixel] - pedestal[iPixel];
+          ++goodPixel;
+        } else if( isHit ) {
+          ++skippedPixelPerRow;
+        }
+        ++iPixel;
+      }
+      if( skippedPixelPerRow < 5 && goodPixel != 0 ) {
+        commonModeCorVec.insert( commonModeCorVec.begin() + y * nXPixel, nXPixel, pixelSum / goodPixel );
+      } else {
+        commonModeCorVec.insert( commonModeCorVec.begin() + y * nXPixel, nXPixel, 0. );
+        ++skippedRow;
+      }
+    }
+    return skippedRow;
+  }
+
+  //! The row wise common mode as EUTelCalibrateEventProcessor calculates it with commonModeSum
+  inline int newRowWise(std::vector<short> const& frame, std::vector<float> const& pede, std::vector<float> const& noise,
+                        std::vector<short> const& status, int nXPixel, float cut, std::vector<float>& commonModeCorVec) {
+    int const nPixel = frame.size();
+    commonModeCorVec.assign( nPixel, 0. );
+    int skippedRow = 0;
+    for( int first = 0; first < nPixel; first += nXPixel ) {
+      eutelescope::EUTelCommonModeSum row = eutelescope::commonModeSum( nXPixel, &frame[first], &pede[first], &noise[first], &status[first], cut );
+      if( row.skippedPixel < 5 && row.goodPixel != 0 ) {
+        std::fill( commonModeCorVec.begin() + first, commonModeCorVec.begin() + first + nXPixel, row.sum / row.goodPixel );
+      } else {
+        ++skippedRow;
+      }
+    }
+    return skippedRow;
+  }
+
+  //! EUTelCalibrateEventProcessor writing the calibrated frame followed by the zero suppression loop of EUTelRawDataSparsifier
+  /*! Every selected pixel is x, y, signal and time.
+   */
+  inline void oldCalibrateSparsify(std::vector<short> const& frame, std::vector<float> const& pede, std::vector<float> const& noise,
+                                   std::vector<short> const& status, int nXPixel, float commonMode, float sigmaCut,
+                                   std::vector<float>& corrected, std::vector<float>& sparse) {
+    int const nPixel = frame.size();
+    corrected.clear();
+    for( int iPixel = 0; iPixel < nPixel; ++iPixel ) {
+      corrected.push_back( static_cast<double>( frame[iPixel] - pede[iPixel] ) - commonMode );
+    }
+    sparse.clear();
+    for( int iPixel = 0; iPixel < nPixel; ++iPixel ) {
+      if( status[iPixel] == 0 && corrected[iPixel] > sigmaCut * noise[iPixel] ) {
+        sparse.push_back( iPixel % nXPixel );
+        sparse.push_back( iPixel / nXPixel );
+        sparse.push_back( static_cast<short>( corrected[iPixel] ) );
+        sparse.push_back( 0 );
+      }
+    }
+  }
+
+  //! The same with calibrateAndSelect, as EUTelCalibrateEventProcessor does when the calibrated frame is not written
+  inline void newCalibrateSparsify(std::vector<short> const& frame, std::vector<float> const& pede, std::vector<float> const& noise,
+                                   std::vector<short> const& status, int nXPixel, float commonMode, float sigmaCut,
+                                   std::vector<unsigned int>& selected, std::vector<float>& signal, std::vector<float>& sparse) {
+    size_t const nPixel = frame.size();
+    selected.resize( nPixel );
+    signal.resize( nPixel );
+    size_t noOfSelected = eutelescope::calibrateAndSelect( nPixel, &frame[0], &pede[0], &noise[0], &status[0], commonMode, sigmaCut, 0,
+                                                           &selected[0], &signal[0] );
+    sparse.clear();
+    for( size_t iSelected = 0; iSelected < noOfSelected; ++iSelected ) {
+      sparse.push_back( selected[iSelected] % nXPixel );
+      sparse.push_back( selected[iSelected] / nXPixel );
+      sparse.push_back( static_cast<short>( signal[iSelected] ) );
+      sparse.push_back( 0 );
+    }
+  }
+
+  //! The fixed weight update of EUTelUpdatePedestalNoiseProcessor before fixedWeightUpdate
+  inline void oldFixedWeight(std::vector<short> const& frame, std::vector<short> const& status, int weight,
+                             std::vector<float>& pede, std::vector<float>& noise) {
+    for( size_t iPixel = 0; iPixel < frame.size(); ++iPixel ) {
+      if( status[iPixel] == 0 ) {
+        pede[iPixel]  = ( ( weight - 1 ) * pede[iPixel] + frame[iPixel] ) / weight;
+        noise[iPixel] = std::sqrt( ( ( weight - 1 ) * std::pow( noise[iPixel], 2 ) + std::pow( frame[iPixel] - pede[iPixel], 2 ) ) / weight );
+      }
+    }
+  }
+
+} //namespace
+
+#endif
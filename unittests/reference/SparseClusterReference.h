@@ -0,0 +1,95 @@
+/*
+ *   This source code is part of the Eutelescope package of Marlin.
+ *   You are free to use this source files for your own development as
+ *   long as it stays in a public research context. You are not
+ *   allowed to use it for commercial purpose. You must put this
+ *   header with author names in all development based on this file.
+ *
+ */
+#ifndef SPARSECLUSTERREFERENCE_H
+#define SPARSECLUSTERREFERENCE_H
+
+// system includes <>
+#include <algorithm>
+#include <random>
+#include <vector>
+
+namespace reference {
+
+  //! Clusters as lists of pixel indices, in the order they are found
+  typedef std::vector<std::vector<int> > ClusterList;
+
+  //! The original algorithm of EUTelProcessorSparseClustering, working on pixel indices
+  /*! Every newly added cluster member re-scans all the remaining
+   *  pixels, the time grows with the square of the number of pixels.
+   */
+  inline ClusterList sparseClustering(std::vector<short> const& x, std::vector<short> const& y, int minDistanceSquared) {
+    ClusterList clusters;
+    std::vector<int> hitPixelVec;
+    for( size_t i = 0; i < x.size(); ++i ) hitPixelVec.push_back( i );
+
+    std::vector<int> newlyAdded;
+    while( !hitPixelVec.empty() ) {
+      std::vector<int> cluster;
+      newlyAdded.push_back( hitPixelVec.front() );
+      cluster.push_back( hitPixelVec.front() );
+      hitPixelVec.erase( hitPixelVec.begin() );
+
+      while( !newlyAdded.empty() ) {
+        bool newlyDone = true;
+        for( std::vector<int>::iterator hitVec = hitPixelVec.begin(); hitVec != hitPixelVec.end(); ++hitVec ) {
+          int dX = x[newlyAdded.front()] - x[*hitVec];
+          int dY = y[newlyAdded.front()] - y[*hitVec];
+          if( dX*dX + dY*dY <= minDistanceSquared ) {
+            newlyAdded.push_back( *hitVec );
+            cluster.push_back( *hitVec );
+            hitPixelVec.erase( hitVec );
+            newlyDone = false;
+            break;
+          }
+        }
+        if( newlyDone ) newlyAdded.erase( newlyAdded.begin() );
+      }
+      clusters.push_back( cluster );
+    }
+    return clusters;
+  }
+
+  //! A frame of nXPixel x nYPixel pixels with nPixel fired pixels, grouped in clusters of 1 to 4 pixels
+  /*! The pixels are shuffled, the readout order is not correlated
+   *  with the clusters.
+   */
+  inline void generateSparseFrame(std::mt19937& generator, int nXPixel, int nYPixel, int nPixel,
+                                  std::vector<short>& x, std::vector<short>& y) {
+    std::uniform_int_distribution<int> xDist( 0, nXPixel - 1 );
+    std::uniform_int_distribution<int> yDist( 0, nYPixel - 1 );
+    std::uniform_int_distribution<int> sizeDist( 1, 4 );
+    std::uniform_int_distribution<int> stepDist( -1, 1 );
+
+    x.clear();
+    y.clear();
+    while( static_cast<int>( x.size() ) < nPixel ) {
+      int cX = xDist( generator );
+      int cY = yDist( generator );
+      int size = sizeDist( generator );
+      for( int i = 0; i < size && static_cast<int>( x.size() ) < nPixel; ++i ) {
+        x.push_back( static_cast<short>( std::max( 0, std::min( nXPixel - 1, cX + stepDist( generator ) ) ) ) );
+        y.push_back( static_cast<short>( std::max( 0, std::min( nYPixel - 1, cY + stepDist( generator ) ) ) ) );
+      }
+    }
+
+    std::vector<int> order( x.size() );
+    for( size_t i = 0; i < order.size(); ++i ) order[i] = i;
+    std::shuffle( order.begin(), order.end(), generator );
+    std::vector<short> xOrdered( x.size() ), yOrdered( y.size() );
+    for( size_t i = 0; i < order.size(); ++i ) {
+      xOrdered[i] = x[order[i]];
+      yOrdered[i] = y[order[i]];
+    }
+    x.swap( xOrdered );
+    y.swap( yOrdered );
+  }
+
+} //namespace
+
+#endif
@@ -0,0 +1,196 @@
+/*
+ *   This source code is part of the Eutelescope package of Marlin.
+ *   You are free to use this source files for your own development as
+ *   long as it stays in a public research context. You are not
+ *   allowed to use it for commercial purpose. You must put this
+ *   header with author names in all development based on this file.
+ *
+ */
+#ifndef TRIPLETREFERENCE_H
+#define TRIPLETREFERENCE_H
+
+// eutelescope includes ".h"
+#include "EUTelTripletSearch.h"
+
+// system includes <>
+#include <algorithm>
+#include <cmath>
+#include <random>
+#include <vector>
+
+namespace reference {
+
+  typedef std::vector< std::vector<eutelescope::EUTelTripletSearch::Hit> > Event;
+
+  //! Six telescope planes and a DUT in the middle, positions in mm
+  const double planeZ[]        = { 0., 150., 300., 450., 600., 750., 900. };
+  const int nPlanes            = 7;
+  const int dutPlane           = 3;
+  const double resolution      = 0.0045;
+  const double scattering      = 0.0003;
+  const double beamDivergence  = 0.0005;
+  const double noisePerPlane   = 2.;
+  const double efficiency      = 0.99;
+
+  // a straight line ignores the scattering, the brute force search inflates the errors instead
+  const double lineVariance    = resolution*resolution + 150.*scattering*150.*scattering;
+
+  // the brute force search only uses the telescope planes and gets too slow above this
+  const int maxBruteForceTracks = 8;
+
+  //! The hits of an event and the true tracks
+  struct GeneratedEvent {
+    Event hits;
+    // index of the hit of every true track on every plane, -1 if inefficient
+    std::vector< std::vector<int> > truth;
+  };
+
+  //! An event of nTracks tracks with multiple scattering, 99% plane efficiency and a few noise hits per plane
+  inline GeneratedEvent generateEvent(std::mt19937& generator, int nTracks) {
+    std::normal_distribution<double> gauss( 0., 1. );
+    std::uniform_real_distribution<double> flat( 0., 1. );
+    GeneratedEvent event;
+    event.hits.resize( nPlanes );
+    event.truth.assign( nTracks, std::vector<int>( nPlanes, -1 ) );
+    for( int iTrack = 0; iTrack < nTracks; ++iTrack ) {
+      double x = 20.*( flat( generator ) - 0.5 ), y = 10.*( flat( generator ) - 0.5 );
+      double tx = beamDivergence*gauss( generator ), ty = beamDivergence*gauss( generator );
+      for( int plane = 0; plane < nPlanes; ++plane ) {
+        if( plane > 0 ) {
+          double const dz = planeZ[plane] - planeZ[plane-1];
+          x += tx*dz;
+          y += ty*dz;
+        }
+        if( flat( generator ) < efficiency ) {
+          eutelescope::EUTelTripletSearch::Hit hit = { x + resolution*gauss( generator ), y + resolution*gauss( generator ), planeZ[plane] };
+          event.truth[iTrack][plane] = static_cast<int>( event.hits[plane].size() );
+          event.hits[plane].push_back( hit );
+        }
+        tx += scattering*gauss( generator );
+        ty += scattering*gauss( generator );
+      }
+    }
+    std::poisson_distribution<int> noise( noisePerPlane );
+    for( int plane = 0; plane < nPlanes; ++plane ) {
+      for( int i = noise( generator ); i > 0; --i ) {
+        eutelescope::EUTelTripletSearch::Hit hit = { 20.*( flat( generator ) - 0.5 ), 10.*( flat( generator ) - 0.5 ), planeZ[plane] };
+        event.hits[plane].push_back( hit );
+      }
+    }
+    return event;
+  }
+
+  //! One hit per telescope plane and the chi2 of the straight line through them
+  struct Combination {
+    std::vector<int> hits;
+    double chi2;
+  };
+
+  inline double lineChi2(Event const& hits, std::vector<int> const& combination) {
+    double sz = 0, szz = 0, sx = 0, sxz = 0, sy = 0, syz = 0;
+    int n = 0;
+    for( int plane = 0; plane < nPlanes; ++plane ) {
+      if( combination[plane] < 0 ) continue;
+      eutelescope::EUTelTripletSearch::Hit const& hit = hits[plane][combination[plane]];
+      sz += hit.z; szz += hit.z*hit.z; sx += hit.x; sxz += hit.x*hit.z; sy += hit.y; syz += hit.y*hit.z;
+      ++n;
+    }
+    double const det = n*szz - sz*sz;
+    double const bx = ( n*sxz - sz*sx )/det, ax = ( sx - bx*sz )/n;
+    double const by = ( n*syz - sz*sy )/det, ay = ( sy - by*sz )/n;
+    double chi2 = 0;
+    for( int plane = 0; plane < nPlanes; ++plane ) {
+      if( combination[plane] < 0 ) continue;
+      eutelescope::EUTelTripletSearch::Hit const& hit = hits[plane][combination[plane]];
+      double const rx = hit.x - ax - bx*hit.z, ry = hit.y - ay - by*hit.z;
+      chi2 += ( rx*rx + ry*ry )/lineVariance;
+    }
+    return chi2;
+  }
+
+  inline void enumerate(Event const& hits, int plane, std::vector<int>& combination, std::vector<Combination>& accepted) {
+    if( plane == nPlanes ) {
+      double const chi2 = lineChi2( hits, combination );
+      if( chi2 < 50. ) {
+        Combination found = { combination, chi2 };
+        accepted.push_back( found );
+      }
+      return;
+    }
+    if( plane == dutPlane ) {
+      combination[plane] = -1;
+      enumerate( hits, plane + 1, combination, accepted );
+      return;
+    }
+    for( size_t i = 0; i < hits[plane].size(); ++i ) {
+      combination[plane] = static_cast<int>(i);
+      enumerate( hits, plane + 1, combination, accepted );
+    }
+  }
+
+  //! The recursive search of EUTelMille
+  /*! Every combination of one hit per telescope plane is fitted with a
+   *  straight line, the best ones not sharing hits are kept.
+   */
+  inline std::vector< std::vector<int> > bruteForce(Event const& hits) {
+    std::vector<Combination> accepted;
+    std::vector<int> combination( nPlanes, -1 );
+    enumerate( hits, 0, combination, accepted );
+    std::sort( accepted.begin(), accepted.end(), []( Combination const& a, Combination const& b ) { return a.chi2 < b.chi2; } );
+    std::vector< std::vector<char> > used( nPlanes );
+    for( int plane = 0; plane < nPlanes; ++plane ) used[plane].assign( hits[plane].size(), 0 );
+    std::vector< std::vector<int> > tracks;
+    for( size_t i = 0; i < accepted.size(); ++i ) {
+      bool free = true;
+      for( int plane = 0; plane < nPlanes; ++plane ) {
+        if( accepted[i].hits[plane] >= 0 && used[plane][accepted[i].hits[plane]] ) free = false;
+      }
+      if( !free ) continue;
+      for( int plane = 0; plane < nPlanes; ++plane ) {
+        if( accepted[i].hits[plane] >= 0 ) used[plane][accepted[i].hits[plane]] = 1;
+      }
+      tracks.push_back( accepted[i].hits );
+    }
+    return tracks;
+  }
+
+  //! A true track is found if a track has all its telescope hits
+  inline int countFound(GeneratedEvent const& event, std::vector< std::vector<int> > const& tracks) {
+    int found = 0;
+    for( size_t iTrue = 0; iTrue < event.truth.size(); ++iTrue ) {
+      std::vector<int> const& truth = event.truth[iTrue];
+      bool complete = true;
+      for( int plane = 0; plane < nPlanes; ++plane ) {
+        if( plane != dutPlane && truth[plane] < 0 ) complete = false;
+      }
+      if( !complete ) continue;
+      for( size_t i = 0; i < tracks.size(); ++i ) {
+        bool same = true;
+        for( int plane = 0; plane < nPlanes && same; ++plane ) {
+          if( plane != dutPlane && tracks[i][plane] != truth[plane] ) same = false;
+        }
+        if( same ) {
+          ++found;
+          break;
+        }
+      }
+    }
+    return found;
+  }
+
+  //! True tracks with a hit on every telescope plane
+  inline int countFindable(GeneratedEvent const& event) {
+    int findable = 0;
+    for( size_t iTrue = 0; iTrue < event.truth.size(); ++iTrue ) {
+      bool complete = true;
+      for( int plane = 0; plane < nPlanes; ++plane ) {
+        if( plane != dutPlane && event.truth[iTrue][plane] < 0 ) complete = false;
+      }
+      if( complete ) ++findable;
+    }
+    return findable;
+  }
+
+} //namespace
+
+#endif
@@ -0,0 +1,73 @@
+//STL
+#include <algorithm>
+#include <random>
+#include <vector>
+
+//GTest
+#include "gtest/gtest.h"
+
+//EUTelescope
+#include "EUTelBrokenLineFit.h"
+
+//Reference
+#include "BrokenLineReference.h"
+
+using eutelescope::EUTelBrokenLineFit;
+using reference::TestFitterHit;
+
+// Compares the band fit of EUTelTestFitter, EUTelBrokenLineFit, with the
+// dense fit it replaced on every hit selection of the track search.
+class EUTelBrokenLineFitTest : public ::testing::Test {
+protected:
+	EUTelBrokenLineFitTest() : generator(4711), nPlanes(reference::testFitterPlanes),
+		fitX(nPlanes), fitEx(nPlanes), fitY(nPlanes), fitEy(nPlanes) {}
+
+	// the selections in the order of EUTelTestFitter, the band fit restarts from the first changed plane
+	void compare(bool useBeamConstraint, int nTracks, int nEvents) {
+		reference::DenseFit dense( useBeamConstraint );
+		EUTelBrokenLineFit band;
+		band.setPlanes( nPlanes, &dense._planeDist[0], &dense._planeScat[0], useBeamConstraint,
+		                reference::testFitterSlopeX, reference::testFitterSlopeY );
+		for(int iEvent = 0; iEvent < nEvents; iEvent++) {
+			std::vector< std::vector<TestFitterHit> > const hits = reference::generateTestFitterEvent( generator, nTracks );
+			reference::loopChoices( hits, [&]( std::vector<TestFitterHit> const& sel, std::vector<bool> const& used ) {
+					for(int ipl = 0; ipl < nPlanes; ipl++) {
+						dense.planeX[ipl] = used[ipl] ? sel[ipl].x : 0.;
+						dense.planeY[ipl] = used[ipl] ? sel[ipl].y : 0.;
+						dense.planeEx[ipl] = dense.planeEy[ipl] = used[ipl] ? reference::testFitterResolution : 0.;
+						band.setMeasurement( ipl, dense.planeX[ipl], dense.planeEx[ipl], dense.planeY[ipl], dense.planeEy[ipl] );
+					}
+					double const denseChi2 = dense.matrixFit();
+					double const bandChi2 = band.getChi2();
+					EXPECT_NEAR( denseChi2, bandChi2, 1e-6*std::max( 1., denseChi2 ) );
+					band.getFit( &fitX[0], &fitEx[0], &fitY[0], &fitEy[0] );
+					// positions in mm
+					for(int ipl = 0; ipl < nPlanes; ipl++) {
+						EXPECT_NEAR( dense.fitX[ipl], fitX[ipl], 1e-7 ) << "plane " << ipl;
+						EXPECT_NEAR( dense.fitY[ipl], fitY[ipl], 1e-7 ) << "plane " << ipl;
+						EXPECT_NEAR( dense.fitEx[ipl], fitEx[ipl], 1e-6*dense.fitEx[ipl] ) << "plane " << ipl;
+						EXPECT_NEAR( dense.fitEy[ipl], fitEy[ipl], 1e-6*dense.fitEy[ipl] ) << "plane " << ipl;
+					}
+					return 0.;
+				} );
+			if( HasFailure() ) return;
+		}
+	}
+
+	std::mt19937 generator;
+	int const nPlanes;
+	std::vector<double> fitX, fitEx, fitY, fitEy;
+};
+
+/** One to four tracks per event, every selection of one or no hit per plane.
+ */
+TEST_F(EUTelBrokenLineFitTest, WithoutBeamConstraint) {
+	for(int nTracks = 1; nTracks <= 4; nTracks++) compare( false, nTracks, 10 );
+}
+
+/** The first segment constrained to the beam slope.
+ */
+TEST_F(EUTelBrokenLineFitTest, WithBeamConstraint) {
+	for(int nTracks = 1; nTracks <= 4; nTracks++) compare( true, nTracks, 10 );
+}
+
@@ -0,0 +1,103 @@
+//STL
+#include <algorithm>
+#include <random>
+#include <vector>
+
+//GTest
+#include "gtest/gtest.h"
+
+//EUTelescope
+#include "EUTelDafTrackerSystem.h"
+
+//Reference
+#include "DafReference.h"
+
+// Compares the beam search of TrackerSystem::combinatorialKF with its
+// default depth first search, by the true tracks both find.
+class EUTelCKFBeamTest : public ::testing::Test {
+protected:
+	EUTelCKFBeamTest() : generator(4711), depthFirst(depthFirstSystem) {}
+
+	virtual void SetUp() {
+		reference::setupCKF( beam, 256 );
+		reference::setupCKF( depthFirstSystem, 0 );
+		reference::setupCKF( defaultSystem, 0 );
+	}
+
+	int findBeam(reference::DafEvent const& event) {
+		reference::fillDafEvent( beam, event );
+		beam.combinatorialKF();
+		std::vector< std::vector<int> > tracks;
+		for(size_t t = 0; t < beam.getNtracks(); t++) tracks.push_back( beam.tracks[t].indexes );
+		return reference::countFound( event, tracks );
+	}
+
+	int findDepthFirst(reference::DafEvent const& event) {
+		reference::fillDafEvent( depthFirstSystem, event );
+		depthFirst.search();
+		return reference::countFound( event, depthFirst.tracks );
+	}
+
+	std::mt19937 generator;
+	reference::DafSystem beam;
+	reference::DafSystem depthFirstSystem;
+	reference::DepthFirst depthFirst;
+	reference::DafSystem defaultSystem;
+};
+
+/** Without the beam search combinatorialKF is the depth first search,
+ *  it finds the same candidates in the same order.
+ */
+TEST_F(EUTelCKFBeamTest, DepthFirstByDefault) {
+	EXPECT_FALSE( defaultSystem.getCKFBeamSearch() );
+	int const multiplicities[] = { 1, 4, 16, 64 };
+	for(size_t m = 0; m < sizeof(multiplicities)/sizeof(int); m++) {
+		for(int iEvent = 0; iEvent < 20; iEvent++) {
+			reference::DafEvent const event = reference::generateDafEvent( generator, multiplicities[m] );
+			reference::fillDafEvent( defaultSystem, event );
+			defaultSystem.combinatorialKF();
+			reference::fillDafEvent( depthFirstSystem, event );
+			depthFirst.search();
+			ASSERT_EQ( depthFirst.tracks.size(), defaultSystem.getNtracks() ) << multiplicities[m] << " tracks";
+			for(size_t t = 0; t < defaultSystem.getNtracks(); t++) {
+				EXPECT_EQ( depthFirst.tracks[t], defaultSystem.tracks[t].indexes );
+			}
+		}
+	}
+}
+
+/** A single track with a hit on every plane and no noise is found.
+ */
+TEST_F(EUTelCKFBeamTest, SingleTrack) {
+	reference::DafEvent event;
+	event.x.resize( reference::dafPlanes );
+	event.y.resize( reference::dafPlanes );
+	event.truth.assign( 1, std::vector<int>( reference::dafPlanes, 0 ) );
+	for(int plane = 0; plane < reference::dafPlanes; plane++) {
+		event.x[plane].push_back( 100.f + 0.001f*plane*reference::dafPlaneDistance );
+		event.y[plane].push_back( -50.f );
+	}
+	EXPECT_EQ( 1, findBeam( event ) );
+	ASSERT_GE( beam.getNtracks(), 1u );
+	EXPECT_EQ( event.truth[0], beam.tracks[0].indexes );
+}
+
+/** The beam of the default width finds as many true tracks as the depth first search,
+ *  at least 95% of those fitting into the candidates.
+ */
+TEST_F(EUTelCKFBeamTest, Efficiency) {
+	int const multiplicities[] = { 1, 4, 16, 64, 128 };
+	int const nEvents = 50;
+	for(size_t m = 0; m < sizeof(multiplicities)/sizeof(int); m++) {
+		int const nTracks = multiplicities[m];
+		int foundBeam = 0, foundDepthFirst = 0;
+		for(int iEvent = 0; iEvent < nEvents; iEvent++) {
+			reference::DafEvent const event = reference::generateDafEvent( generator, nTracks );
+			foundBeam += findBeam( event );
+			foundDepthFirst += findDepthFirst( event );
+		}
+		double const nTrue = nTracks*nEvents;
+		EXPECT_GE( foundBeam/nTrue, 0.95*std::min( 1., double(reference::ckfMaxCandidates)/nTracks ) ) << nTracks << " tracks";
+		EXPECT_GE( foundBeam/nTrue, foundDepthFirst/nTrue - 0.005 ) << nTracks << " tracks";
+	}
+}
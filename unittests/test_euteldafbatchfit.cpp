@@ -0,0 +1,82 @@
+//STL
+#include <algorithm>
+#include <cmath>
+#include <random>
+
+//GTest
+#include "gtest/gtest.h"
+
+//EUTelescope
+#include "EUTelDafTrackerSystem.h"
+
+//Reference
+#include "DafReference.h"
+
+using daffitter::TrackCandidate;
+
+// Compares the batched DAF fit, TrackerSystem::fitPlanesInfoDafBatched,
+// with the fit of one candidate at a time on the same candidates.
+class EUTelDafBatchFitTest : public ::testing::Test {
+protected:
+	EUTelDafBatchFitTest() : generator(4711) {}
+
+	virtual void SetUp() {
+		reference::setupClusterTracker( scalar );
+		reference::setupClusterTracker( batched );
+	}
+
+	void fit(reference::DafEvent const& event) {
+		reference::fillDafEvent( scalar, event );
+		reference::fillDafEvent( batched, event );
+		scalar.clusterTracker();
+		batched.clusterTracker();
+		reference::fitDafScalar( scalar );
+		batched.fitPlanesInfoDafBatched();
+	}
+
+	// positions in um
+	void expectSameFits() {
+		ASSERT_EQ( scalar.getNtracks(), batched.getNtracks() );
+		for(size_t t = 0; t < scalar.getNtracks(); t++) {
+			TrackCandidate<float,4>& a = scalar.tracks[t];
+			TrackCandidate<float,4>& b = batched.tracks[t];
+			EXPECT_NEAR( a.ndof, b.ndof, 1e-3 ) << "candidate " << t;
+			EXPECT_NEAR( a.chi2, b.chi2, 1e-3*std::max( 1.f, std::fabs( a.chi2 ) ) ) << "candidate " << t;
+			if( a.ndof < -1.9f ) continue;
+			EXPECT_EQ( a.indexes, b.indexes ) << "candidate " << t;
+			for(int plane = 0; plane < reference::dafPlanes; plane++) {
+				EXPECT_NEAR( a.estimates[plane].getX(), b.estimates[plane].getX(), 0.01 );
+				EXPECT_NEAR( a.estimates[plane].getY(), b.estimates[plane].getY(), 0.01 );
+				EXPECT_NEAR( a.estimates[plane].getXdz(), b.estimates[plane].getXdz(), 1e-7 );
+				EXPECT_NEAR( a.estimates[plane].getYdz(), b.estimates[plane].getYdz(), 1e-7 );
+				EXPECT_NEAR( a.measZ[plane], b.measZ[plane], 0.01 );
+			}
+		}
+	}
+
+	std::mt19937 generator;
+	reference::DafSystem scalar;
+	reference::DafSystem batched;
+};
+
+/** Fewer candidates than lanes, the rest of the batch is empty.
+ */
+TEST_F(EUTelDafBatchFitTest, PartialBatch) {
+	for(int iEvent = 0; iEvent < 20; iEvent++) {
+		fit( reference::generateDafEvent( generator, 1 ) );
+		expectSameFits();
+	}
+}
+
+/** Several batches per event, with noise candidates failing the fit.
+ */
+TEST_F(EUTelDafBatchFitTest, ManyCandidates) {
+	int const multiplicities[] = { 4, 16, 64 };
+	for(size_t m = 0; m < sizeof(multiplicities)/sizeof(int); m++) {
+		for(int iEvent = 0; iEvent < 10; iEvent++) {
+			fit( reference::generateDafEvent( generator, multiplicities[m] ) );
+			ASSERT_GT( scalar.getNtracks(), 0u );
+			expectSameFits();
+		}
+	}
+}
@@ -280,4 +280,32 @@ TEST_F(eutelgeotestTest, radLengthTest1) {
 	std::cout << "Rad: " << eugeo::gGeometry().FindRad(begin3, end3) << std::endl;
 }
 
+/** The tabulated radiation lengths must agree with the TGeo integration through each plane
+ *  for slopes between the grid points, or the table must have been switched off by its own check.
+ */
+TEST_F(eutelgeotestTest, radLengthTableTest) {
+	double const rel_err = 0.01;
+	if( !eugeo::gGeometry().useRadLengthTable(true, 0.05, 21, rel_err) ) return;
+
+	auto const& table = eugeo::gGeometry().getRadLengthTable();
+	std::uniform_real_distribution<double> distribution(-0.05,0.05);
+
+	auto sensorIDVec = eugeo::gGeometry().sensorIDsVec();
+	for( auto sensorID: sensorIDVec ) {
+		TVector3 normalT = eugeo::gGeometry().siPlaneNormal( sensorID );
+		Eigen::Vector3d normal( normalT[0], normalT[1], normalT[2] );
+		Eigen::Vector3d centre( eugeo::gGeometry().siPlaneXPosition(sensorID), eugeo::gGeometry().siPlaneYPosition(sensorID), eugeo::gGeometry().siPlaneZPosition(sensorID) );
+		for(size_t i = 0; i < 10; i++) {
+			double tx = distribution(generator);
+			double ty = distribution(generator);
+			Eigen::Vector3d direction( tx, ty, 1 );
+			direction.normalize();
+			double halfPath = 0.51*eugeo::gGeometry().siPlaneZSize(sensorID)/std::abs(direction.dot(normal));
+			double exact = eugeo::gGeometry().FindRad( centre - halfPath*direction, centre + halfPath*direction );
+			ASSERT_NEAR(table.planeRadLength(sensorID, tx, ty), exact, rel_err*exact);
+		}
+	}
+	eugeo::gGeometry().useRadLengthTable(false);
+}
+
 // }  // namespace - could surround eutelgeotestTest in a namespace
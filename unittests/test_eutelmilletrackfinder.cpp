@@ -0,0 +1,168 @@
+//STL
+#include <algorithm>
+#include <cmath>
+#include <random>
+#include <vector>
+
+//GTest
+#include "gtest/gtest.h"
+
+//EUTelescope
+#include "EUTelMilleTrackFinder.h"
+
+using eutelescope::EUTelMilleTrackFinder;
+
+typedef std::vector<std::vector<int> > Candidates;
+
+// Compares the original recursive track candidate search of EUTelMille with
+// the pruned one, selected with PrunedTrackSearch.
+class EUTelMilleTrackFinderTest : public ::testing::Test {
+protected:
+	EUTelMilleTrackFinderTest() : nPlanes(6), planeDistance(150.), residualCut(0.5) {}
+
+	virtual void SetUp() {
+		std::vector<float> residualMin( nPlanes, -residualCut );
+		std::vector<float> residualMax( nPlanes, residualCut );
+		finder.setResidualCuts( residualMin, residualMax, residualMin, residualMax );
+		finder.setMaxTrackCandidates( 1000000 );
+		hits.assign( nPlanes, std::vector<EUTelMilleTrackFinder::HitsInPlane>() );
+	}
+
+	// straight track through all planes except the skipped one
+	void addTrack(double x, double y, double slopeX, double slopeY, int skippedPlane = -1) {
+		for(int i = 0; i < nPlanes; i++) {
+			if( i == skippedPlane ) continue;
+			double const z = i * planeDistance;
+			hits[i].push_back( EUTelMilleTrackFinder::HitsInPlane( x + slopeX*z, y + slopeY*z, z ) );
+		}
+	}
+
+	// the residuals passed to the finders are absolute values, the minimal cut is never active
+	bool passesCut(int plane, int hit, int previousPlane, int previousHit) const {
+		EUTelMilleTrackFinder::HitsInPlane const& a = hits[plane][hit];
+		EUTelMilleTrackFinder::HitsInPlane const& b = hits[previousPlane][previousHit];
+		return std::abs( a.measuredX - b.measuredX ) <= residualCut && std::abs( a.measuredY - b.measuredY ) <= residualCut;
+	}
+
+	static bool hasAllHits(std::vector<int> const& candidate) {
+		return std::find( candidate.begin(), candidate.end(), -1 ) == candidate.end();
+	}
+
+	int const nPlanes;
+	double const planeDistance;
+	float const residualCut;
+	EUTelMilleTrackFinder finder;
+	EUTelMilleTrackFinder::HitsArray hits;
+};
+
+/** Well separated tracks with a hit on every plane are found once by the pruned search.
+ *  The original search combines each of them with every hit on the last plane.
+ */
+TEST_F(EUTelMilleTrackFinderTest, SeparatedTracks) {
+	addTrack( -5., 1., 0.001, 0. );
+	addTrack( 0., 0., 0., 0.001 );
+	addTrack( 5., -1., -0.001, -0.001 );
+
+	Candidates legacy, pruned;
+	finder.findLegacy( hits, legacy );
+	finder.findPruned( hits, pruned );
+
+	ASSERT_EQ( 9u, legacy.size() );
+	Candidates legacyPassing;
+	for(size_t k = 0; k < legacy.size(); k++) {
+		if( passesCut( nPlanes-1, legacy[k][nPlanes-1], nPlanes-2, legacy[k][nPlanes-2] ) ) legacyPassing.push_back( legacy[k] );
+	}
+	std::sort( legacyPassing.begin(), legacyPassing.end() );
+	std::sort( pruned.begin(), pruned.end() );
+	ASSERT_EQ( 3u, pruned.size() );
+	EXPECT_EQ( legacyPassing, pruned );
+}
+
+/** On random events the candidates with a hit on every plane differ only by the cut
+ *  on the last plane, which the original search does not apply.
+ */
+TEST_F(EUTelMilleTrackFinderTest, RandomEventsFullCandidates) {
+	std::mt19937 generator( 4711 );
+	std::uniform_real_distribution<double> position( -3., 3. );
+	std::uniform_int_distribution<int> nHits( 0, 4 );
+
+	for(int iEvent = 0; iEvent < 200; iEvent++) {
+		SetUp();
+		for(int i = 0; i < nPlanes; i++) {
+			int const n = nHits( generator );
+			for(int j = 0; j < n; j++) {
+				hits[i].push_back( EUTelMilleTrackFinder::HitsInPlane( position( generator ), position( generator ), i * planeDistance ) );
+			}
+		}
+
+		Candidates legacy, pruned;
+		finder.findLegacy( hits, legacy );
+		finder.findPruned( hits, pruned );
+
+		Candidates legacyFull, prunedFull;
+		for(size_t k = 0; k < legacy.size(); k++) {
+			std::vector<int> const& c = legacy[k];
+			if( static_cast<int>( c.size() ) == nPlanes && hasAllHits( c ) && passesCut( nPlanes-1, c[nPlanes-1], nPlanes-2, c[nPlanes-2] ) ) {
+				legacyFull.push_back( c );
+			}
+		}
+		for(size_t k = 0; k < pruned.size(); k++) {
+			if( hasAllHits( pruned[k] ) ) prunedFull.push_back( pruned[k] );
+		}
+		std::sort( legacyFull.begin(), legacyFull.end() );
+		std::sort( prunedFull.begin(), prunedFull.end() );
+		ASSERT_EQ( legacyFull, prunedFull ) << "event " << iEvent;
+	}
+}
+
+/** A rejected hit on the last but one plane gives a second, incomplete copy of the
+ *  track in the original search only.
+ */
+TEST_F(EUTelMilleTrackFinderTest, RejectedHitDuplicatesLegacyCandidate) {
+	finder.setAllowedMissingHits( 1 );
+	addTrack( 0., 0., 0., 0. );
+	hits[nPlanes-2].push_back( EUTelMilleTrackFinder::HitsInPlane( 10., 10., (nPlanes-2) * planeDistance ) );
+
+	Candidates legacy, pruned;
+	finder.findLegacy( hits, legacy );
+	finder.findPruned( hits, pruned );
+
+	ASSERT_EQ( 2u, legacy.size() );
+	EXPECT_TRUE( hasAllHits( legacy[0] ) );
+	EXPECT_EQ( -1, legacy[1][nPlanes-2] );
+
+	ASSERT_EQ( 1u, pruned.size() );
+	EXPECT_EQ( legacy[0], pruned[0] );
+}
+
+/** After a missed plane the original search rejects every following hit, the pruned
+ *  one compares them with the last hit of the candidate.
+ */
+TEST_F(EUTelMilleTrackFinderTest, MissedPlane) {
+	finder.setAllowedMissingHits( 1 );
+	addTrack( 0., 0., 0.001, 0.001, 2 );
+
+	Candidates legacy, pruned;
+	finder.findLegacy( hits, legacy );
+	finder.findPruned( hits, pruned );
+
+	EXPECT_TRUE( legacy.empty() );
+	ASSERT_EQ( 1u, pruned.size() );
+	EXPECT_EQ( -1, pruned[0][2] );
+	EXPECT_EQ( nPlanes - 1, std::count_if( pruned[0].begin(), pruned[0].end(), [](int hit) { return hit >= 0; } ) );
+}
+
+/** The original search keeps the hit on the last plane even if it fails the cut.
+ */
+TEST_F(EUTelMilleTrackFinderTest, CutOnLastPlane) {
+	addTrack( 0., 0., 0., 0., nPlanes-1 );
+	hits[nPlanes-1].push_back( EUTelMilleTrackFinder::HitsInPlane( 10., 10., (nPlanes-1) * planeDistance ) );
+
+	Candidates legacy, pruned;
+	finder.findLegacy( hits, legacy );
+	finder.findPruned( hits, pruned );
+
+	ASSERT_EQ( 1u, legacy.size() );
+	EXPECT_TRUE( hasAllHits( legacy[0] ) );
+	EXPECT_TRUE( pruned.empty() );
+}
@@ -0,0 +1,114 @@
+//STL
+#include <cstdio>
+#include <string>
+#include <vector>
+
+//GTest
+#include "gtest/gtest.h"
+
+//EUTelescope
+#include "EUTelMilleWriter.h"
+
+//Reference
+#include "MilleReference.h"
+
+using eutelescope::EUTelMilleWriter;
+
+// Compares the binaries of EUTelMilleWriter, written from its I/O thread,
+// with those of Mille, written from the processor.
+class EUTelMilleWriterTest : public ::testing::Test {
+protected:
+	EUTelMilleWriterTest() : nTracks(2000), tracks(reference::generateMilleTracks(nTracks)), maxChi2Ndf(1.5),
+		prefix(::testing::TempDir() + "eutelmillewriter-") {}
+
+	virtual void TearDown() {
+		char const* files[] = { "sync.bin", "sync-selected.bin", "async.bin", "async.bin.idx",
+		                        "selected.bin", "selected.bin.idx" };
+		for(size_t i = 0; i < sizeof(files)/sizeof(files[0]); i++) std::remove( file( files[i] ).c_str() );
+	}
+
+	std::string file(std::string const& name) const { return prefix + name; }
+
+	// Mille with the records below maxChi2Ndf or all records
+	void writeSync(std::string const& name, bool selected) {
+		reference::SyncMille mille( file( name ) );
+		for(int t = 0; t < nTracks; t++) {
+			if( selected and tracks[t].chi2/tracks[t].ndf >= maxChi2Ndf ) continue;
+			reference::addMilleTrack( mille, tracks[t] );
+			mille.end();
+		}
+	}
+
+	void writeAsync(std::string const& name, bool compress, size_t queueSize) {
+		EUTelMilleWriter writer;
+		ASSERT_TRUE( writer.open( file( name ), compress, true, queueSize ) ) << writer.getErrorMessage();
+		for(int t = 0; t < nTracks; t++) {
+			reference::addMilleTrack( writer, tracks[t] );
+			writer.setRecordInfo( 1, t, ( 1 << reference::millePlanes ) - 1, tracks[t].chi2, tracks[t].ndf );
+			writer.end();
+		}
+		EXPECT_EQ( size_t(nTracks), writer.getNRecords() );
+		ASSERT_TRUE( writer.close() ) << writer.getErrorMessage();
+	}
+
+	int const nTracks;
+	std::vector<reference::MilleTrack> const tracks;
+	float const maxChi2Ndf;
+	std::string const prefix;
+};
+
+/** The binary of the writer is identical to that of Mille.
+ */
+TEST_F(EUTelMilleWriterTest, SameBinary) {
+	writeSync( "sync.bin", false );
+	writeAsync( "async.bin", false, 1024 );
+	std::string const expected = reference::readFile( file( "sync.bin" ) );
+	ASSERT_FALSE( expected.empty() );
+	EXPECT_TRUE( expected == reference::readFile( file( "async.bin" ) ) );
+}
+
+/** A queue of one record makes the processor wait for the I/O thread.
+ */
+TEST_F(EUTelMilleWriterTest, FullQueue) {
+	writeSync( "sync.bin", false );
+	writeAsync( "async.bin", false, 1 );
+	EXPECT_TRUE( reference::readFile( file( "sync.bin" ) ) == reference::readFile( file( "async.bin" ) ) );
+}
+
+/** The index lists every record with the information given to the writer.
+ */
+TEST_F(EUTelMilleWriterTest, Index) {
+	writeAsync( "async.bin", false, 1024 );
+	std::vector<EUTelMilleWriter::RecordInfo> records;
+	std::string errorMessage;
+	ASSERT_TRUE( EUTelMilleWriter::readIndex( EUTelMilleWriter::indexFileName( file( "async.bin" ) ), records, errorMessage ) ) << errorMessage;
+	ASSERT_EQ( size_t(nTracks), records.size() );
+	uint64_t offset = 0;
+	for(int t = 0; t < nTracks; t++) {
+		EXPECT_EQ( offset, records[t].offset );
+		EXPECT_EQ( t, records[t].event );
+		EXPECT_EQ( tracks[t].ndf, records[t].ndf );
+		EXPECT_FLOAT_EQ( tracks[t].chi2, records[t].chi2 );
+		offset += records[t].size;
+	}
+	EXPECT_EQ( reference::readFile( file( "async.bin" ) ).size(), offset );
+}
+
+/** The records copied with a cut are those Mille writes with the cut, from the plain and the compressed binary.
+ */
+TEST_F(EUTelMilleWriterTest, SelectedRecords) {
+	writeSync( "sync-selected.bin", true );
+	std::string const expected = reference::readFile( file( "sync-selected.bin" ) );
+	float const cut = maxChi2Ndf;
+	EUTelMilleWriter::Selection selection = [=]( EUTelMilleWriter::RecordInfo const& info ) {
+		return info.chi2/info.ndf < cut;
+	};
+	for(int compress = 0; compress < 2; compress++) {
+		writeAsync( "async.bin", compress, 1024 );
+		std::string errorMessage;
+		long const copied = EUTelMilleWriter::copyRecords( file( "async.bin" ), file( "selected.bin" ), selection, false, errorMessage );
+		ASSERT_GT( copied, 0 ) << errorMessage;
+		EXPECT_LT( copied, nTracks );
+		EXPECT_TRUE( expected == reference::readFile( file( "selected.bin" ) ) ) << ( compress ? "compressed" : "plain" );
+	}
+}
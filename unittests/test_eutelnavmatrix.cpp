@@ -0,0 +1,129 @@
+//STL
+#include <cmath>
+#include <random>
+#include <vector>
+
+//GTest
+#include "gtest/gtest.h"
+
+//EUTelescope
+#include "EUTelNavMatrix.h"
+
+//Reference
+#include "NavJacobianReference.h"
+
+using eutelescope::EUTelNavMatrix;
+using eutelescope::Matrix5d;
+
+// Compares the fixed size jacobians of EUTelNavMatrix with the original
+// TMatrixD code of EUTelNav and EUTelGBLFitter, element by element.
+class EUTelNavMatrixTest : public ::testing::Test {
+protected:
+	EUTelNavMatrixTest() : generator(12345), slope(0., 2e-3), beamEnergy(4.), minJacobian(1e-4) {}
+
+	// a plane tilted around y and rotated around the beam axis
+	static Eigen::Matrix3d rotation(double tilt, double spin) {
+		Eigen::Matrix3d tiltMatrix, spinMatrix;
+		tiltMatrix << std::cos(tilt), 0, std::sin(tilt), 0, 1, 0, -std::sin(tilt), 0, std::cos(tilt);
+		spinMatrix << std::cos(spin), -std::sin(spin), 0, std::sin(spin), std::cos(spin), 0, 0, 0, 1;
+		return tiltMatrix*spinMatrix;
+	}
+
+	static TMatrixD toRoot(Eigen::Matrix3d const& rot) {
+		TMatrixD out(3,3);
+		for(int r = 0; r < 3; r++) for(int c = 0; c < 3; c++) out[r][c] = rot(r,c);
+		return out;
+	}
+
+	static TVector3 toRoot(Eigen::Vector3d const& vec) {
+		return TVector3( vec[0], vec[1], vec[2] );
+	}
+
+	Eigen::Vector3d momentum() {
+		return Eigen::Vector3d( slope( generator ), slope( generator ), 1. ).normalized()*beamEnergy;
+	}
+
+	static void expectNear(TMatrixD const& expected, Matrix5d const& actual, double tolerance) {
+		ASSERT_EQ( 5, expected.GetNrows() );
+		ASSERT_EQ( 5, expected.GetNcols() );
+		for(int i = 0; i < 5; i++) {
+			for(int j = 0; j < 5; j++) {
+				EXPECT_NEAR( expected[i][j], actual(i,j), tolerance*std::max( 1., std::abs( expected[i][j] ) ) ) << "element " << i << " " << j;
+			}
+		}
+	}
+
+	std::mt19937 generator;
+	std::normal_distribution<double> slope;
+	double const beamEnergy;
+	double const minJacobian;
+};
+
+/** Planes tilted up to 30 degrees and slightly rotated around the beam axis.
+ */
+TEST_F(EUTelNavMatrixTest, MeasToGlobal) {
+	double const tilts[] = { 0., 0.1, 0.5236 };
+	double const spins[] = { 0., 0.01, -0.02 };
+	for(size_t iTilt = 0; iTilt < 3; iTilt++) {
+		for(size_t iSpin = 0; iSpin < 3; iSpin++) {
+			Eigen::Matrix3d const rot = rotation( tilts[iTilt], spins[iSpin] );
+			for(int iTrack = 0; iTrack < 20; iTrack++) {
+				Eigen::Vector3d const local = rot.transpose()*momentum();
+				expectNear( reference::measToGlobal( toRoot( local ), toRoot( rot ) ), EUTelNavMatrix::measToGlobal( local, rot ), 1e-12 );
+			}
+		}
+	}
+}
+
+/** With a field along x and without field, which uses the straight line jacobian.
+ */
+TEST_F(EUTelNavMatrixTest, GlobalToGlobal) {
+	Eigen::Vector3d const fields[] = { Eigen::Vector3d( 0.5, 0., 0. ), Eigen::Vector3d( 0., 1., 0.2 ), Eigen::Vector3d::Zero() };
+	for(size_t iField = 0; iField < 3; iField++) {
+		for(int iTrack = 0; iTrack < 20; iTrack++) {
+			Eigen::Vector3d const direction = momentum().normalized();
+			double const ds = 30. + 10.*iTrack;
+			expectNear( reference::globalToGlobal( ds, toRoot( direction ), toRoot( fields[iField] ) ),
+			            EUTelNavMatrix::propagationJacobianGlobalToGlobal( ds, direction, fields[iField] ), 1e-12 );
+		}
+	}
+}
+
+/** Elements below the cut are set to zero, the others are kept.
+ */
+TEST_F(EUTelNavMatrixTest, SetPrecision) {
+	std::uniform_real_distribution<double> element( -2e-4, 2e-4 );
+	Matrix5d mat;
+	TMatrixD root(5,5);
+	for(int i = 0; i < 5; i++) for(int j = 0; j < 5; j++) root[i][j] = mat(i,j) = element( generator );
+	EUTelNavMatrix::setPrecision( mat, minJacobian );
+	expectNear( reference::setPrecision( root, minJacobian ), mat, 0. );
+}
+
+/** The chain of EUTelGBLFitter::getFullJacobian from a plane to the next tilted one.
+ */
+TEST_F(EUTelNavMatrixTest, FullJacobian) {
+	Eigen::Vector3d const b( 0.5, 0., 0. );
+	Eigen::Matrix3d const start = rotation( 0., 0.01 );
+	Eigen::Matrix3d const end = rotation( 0.5236, -0.02 );
+	for(int iTrack = 0; iTrack < 20; iTrack++) {
+		Eigen::Vector3d const mom = momentum();
+		double const distance = 150.;
+
+		Matrix5d const simpleJacobian = EUTelNavMatrix::propagationJacobianGlobalToGlobal( distance, mom.normalized(), b );
+		Matrix5d const localToGlobalJacobianStart = EUTelNavMatrix::measToGlobal( start.transpose()*mom, start );
+		Matrix5d const localToGlobalJacobianEnd = EUTelNavMatrix::measToGlobal( end.transpose()*mom, end );
+		Matrix5d jacobian = localToGlobalJacobianEnd.inverse()*simpleJacobian*localToGlobalJacobianStart;
+		EUTelNavMatrix::setPrecision( jacobian, minJacobian );
+
+		expectNear( reference::fullJacobian( toRoot( mom ), toRoot( start ), toRoot( end ), distance, toRoot( b ), minJacobian ), jacobian, 1e-9 );
+	}
+}
+
+/** The conversion for GBL keeps every element.
+ */
+TEST_F(EUTelNavMatrixTest, ToTMatrixD) {
+	Matrix5d mat;
+	for(int i = 0; i < 5; i++) for(int j = 0; j < 5; j++) mat(i,j) = i - 0.1*j;
+	expectNear( eutelescope::Utility::toTMatrixD( mat ), mat, 0. );
+}
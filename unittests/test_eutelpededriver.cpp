@@ -0,0 +1,129 @@
+//STL
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <vector>
+
+//System
+#include <sys/stat.h>
+#include <unistd.h>
+
+//GTest
+#include "gtest/gtest.h"
+
+//EUTelescope
+#include "EUTelPedeDriver.h"
+
+//Reference
+#include "PedeReference.h"
+
+using eutelescope::EUTelPedeDriver;
+
+// Runs EUTelPedeDriver on a shell script standing for pede, in a
+// temporary directory, and compares it with the polling loop it replaced.
+class EUTelPedeDriverTest : public ::testing::Test {
+protected:
+	virtual void SetUp() {
+		std::string pattern = ::testing::TempDir() + "eutelpededriver-XXXXXX";
+		ASSERT_TRUE( mkdtemp( &pattern[0] ) != 0 );
+		directory = pattern;
+		fakePede = directory + "/fakepede";
+		reference::writeFakePede( fakePede, 0.02 );
+	}
+
+	virtual void TearDown() {
+		for(size_t i = 0; i < subdirectories.size(); i++) {
+			std::remove( ( subdirectories[i] + "/steer.txt" ).c_str() );
+			std::remove( ( subdirectories[i] + "/millepede.res" ).c_str() );
+			rmdir( subdirectories[i].c_str() );
+		}
+		std::remove( fakePede.c_str() );
+		rmdir( directory.c_str() );
+	}
+
+	// a directory with a steering file holding the X shift
+	std::string makeFitDirectory(std::string const& name, double shift) {
+		std::string const path = directory + "/" + name;
+		mkdir( path.c_str(), 0755 );
+		subdirectories.push_back( path );
+		std::ofstream( ( path + "/steer.txt" ).c_str() ) << shift;
+		return path;
+	}
+
+	static void expectFit(EUTelPedeDriver const& driver, double shift, int nLines) {
+		EUTelPedeDriver::Statistics const statistics = driver.getStatistics();
+		EXPECT_TRUE( statistics.finished );
+		EXPECT_EQ( 0, statistics.exitStatus );
+		EXPECT_EQ( 50000, statistics.nRecords );
+		EXPECT_EQ( 0, statistics.rejected[0] );
+		EXPECT_EQ( 0, statistics.rejected[1] );
+		EXPECT_EQ( 12, statistics.rejected[2] );
+		EXPECT_EQ( 35, statistics.rejected[3] );
+		EXPECT_FALSE( statistics.tooManyRejects );
+		EXPECT_TRUE( statistics.hasChi2Ndf );
+		EXPECT_DOUBLE_EQ( 0.9405, statistics.chi2Ndf );
+		EXPECT_EQ( 1, statistics.nErrorLines );
+		EXPECT_EQ( 12, nLines );
+
+		std::vector<EUTelPedeDriver::Parameter> const& parameters = driver.getParameters();
+		ASSERT_EQ( 2u, parameters.size() );
+		EXPECT_EQ( 1, parameters[0].label );
+		EXPECT_NEAR( shift, parameters[0].value, 1e-9 );
+		EXPECT_FALSE( parameters[0].fixed );
+		EXPECT_NEAR( 0.1234E-02, parameters[0].error, 1e-9 );
+		EXPECT_EQ( 2, parameters[1].label );
+		EXPECT_TRUE( parameters[1].fixed );
+	}
+
+	std::string directory;
+	std::string fakePede;
+	std::vector<std::string> subdirectories;
+};
+
+/** The statistics and parameters of one fit, and its stdout as read by the polling loop.
+ */
+TEST_F(EUTelPedeDriverTest, SingleFit) {
+	std::string const path = makeFitDirectory( "fit", 0.5 );
+	EUTelPedeDriver driver;
+	ASSERT_TRUE( driver.start( "steer.txt", path, fakePede ) ) << driver.getErrorMessage();
+	int nLines = 0;
+	std::stringstream output;
+	driver.wait( [&]( std::string const& line, bool isError ) {
+			++nLines;
+			if( !isError ) output << line << "\n";
+		} );
+	expectFit( driver, 0.5, nLines );
+
+	std::string pstreamOutput;
+	EXPECT_EQ( 0, reference::runPStream( "cd " + path + " && " + fakePede + " steer.txt", pstreamOutput ) );
+	EXPECT_EQ( pstreamOutput, output.str() );
+}
+
+/** Independent fits in their own directories at the same time.
+ */
+TEST_F(EUTelPedeDriverTest, ConcurrentFits) {
+	int const nFits = 3;
+	std::vector<EUTelPedeDriver> drivers( nFits );
+	for(int i = 0; i < nFits; i++) {
+		std::stringstream name;
+		name << "fit" << i;
+		std::string const path = makeFitDirectory( name.str(), 0.1*i );
+		ASSERT_TRUE( drivers[i].start( "steer.txt", path, fakePede ) ) << drivers[i].getErrorMessage();
+	}
+	for(int i = 0; i < nFits; i++) {
+		int nLines = 0;
+		drivers[i].wait( [&nLines]( std::string const&, bool ) { ++nLines; } );
+		expectFit( drivers[i], 0.1*i, nLines );
+	}
+}
+
+/** A missing program shows up as exit status 127.
+ */
+TEST_F(EUTelPedeDriverTest, MissingPede) {
+	EUTelPedeDriver driver;
+	ASSERT_TRUE( driver.start( "steer.txt", directory, "eutelescope-no-such-pede" ) ) << driver.getErrorMessage();
+	EXPECT_EQ( 127, driver.wait().exitStatus );
+	EXPECT_TRUE( driver.getParameters().empty() );
+}
@@ -0,0 +1,144 @@
+//STL
+#include <cmath>
+#include <cstdlib>
+#include <vector>
+
+//GTest
+#include "gtest/gtest.h"
+
+//EUTelescope
+#include "EUTelPixelAccumulator.h"
+#include "EUTelPedestalTracker.h"
+
+//Reference
+#include "PixelAccumulatorReference.h"
+
+using eutelescope::EUTelPixelAccumulator;
+using eutelescope::EUTelPedestalTracker;
+using eutelescope::EUTelPedestalDrift;
+
+// Compares the per pixel loops of the pedestal, noise and calibration
+// processors with the loops they replaced, on small generated frames.
+class EUTelPixelAccumulatorTest : public ::testing::Test {
+protected:
+	EUTelPixelAccumulatorTest() : nXPixel(64), nPixel(64*32), nEvents(50) {}
+
+	virtual void SetUp() {
+		std::srand( 4711 );
+		data = reference::generatePixelFrames( nPixel, nEvents );
+	}
+
+	template <typename T>
+	void accumulate(EUTelPixelAccumulator<T>& accumulator) {
+		std::vector<float> const weight( nPixel, 1. );
+		accumulator.start( nPixel, &data.frames[0][0] );
+		for(int iEvent = 1; iEvent < nEvents; iEvent++) accumulator.add( &data.frames[iEvent][0], &weight[0] );
+	}
+
+	int const nXPixel;
+	int const nPixel;
+	int const nEvents;
+	reference::PixelFrames data;
+};
+
+/** The accumulator in double and in float reproduces the MeanRMS loop of EUTelPedestalNoiseProcessor.
+ */
+TEST_F(EUTelPixelAccumulatorTest, MeanRMS) {
+	std::vector<float> pede( data.frames[0].begin(), data.frames[0].end() ), noise( nPixel, 0. );
+	std::vector<int> entries( nPixel, 1 );
+	for(int iEvent = 1; iEvent < nEvents; iEvent++) reference::oldMeanRMS( data.frames[iEvent], pede, noise, entries );
+
+	EUTelPixelAccumulator<double> accumulator;
+	accumulate( accumulator );
+	EUTelPixelAccumulator<float> floatAccumulator;
+	accumulate( floatAccumulator );
+	for(int iPixel = 0; iPixel < nPixel; iPixel++) {
+		ASSERT_NEAR( pede[iPixel], accumulator.mean()[iPixel], 1e-3 ) << "pixel " << iPixel;
+		ASSERT_NEAR( noise[iPixel], std::sqrt( accumulator.variance()[iPixel] ), 1e-3 ) << "pixel " << iPixel;
+		ASSERT_NEAR( noise[iPixel], std::sqrt( static_cast<double>( floatAccumulator.variance()[iPixel] ) ), 1e-2 ) << "pixel " << iPixel;
+	}
+}
+
+/** With the exact variance the accumulator gives the mean and RMS of every pixel.
+ */
+TEST_F(EUTelPixelAccumulatorTest, ExactVariance) {
+	EUTelPixelAccumulator<double> accumulator;
+	accumulator.setExactVariance( true );
+	accumulate( accumulator );
+	for(int iPixel = 0; iPixel < nPixel; iPixel++) {
+		double sum = 0., sum2 = 0.;
+		for(int iEvent = 0; iEvent < nEvents; iEvent++) sum += data.frames[iEvent][iPixel];
+		double const mean = sum / nEvents;
+		for(int iEvent = 0; iEvent < nEvents; iEvent++) sum2 += std::pow( data.frames[iEvent][iPixel] - mean, 2 );
+		ASSERT_NEAR( mean, accumulator.mean()[iPixel], 1e-9 ) << "pixel " << iPixel;
+		ASSERT_NEAR( std::sqrt( sum2 / nEvents ), std::sqrt( accumulator.variance()[iPixel] ), 1e-9 ) << "pixel " << iPixel;
+	}
+}
+
+/** The row wise common mode skips the same rows, here the first row of the first event with six hits.
+ */
+TEST_F(EUTelPixelAccumulatorTest, CommonMode) {
+	for(int x = 1; x < 7; x++) data.frames[0][x] += 200;
+	std::vector<float> oldCorrection, newCorrection;
+	for(int iEvent = 0; iEvent < nEvents; iEvent++) {
+		int const oldSkipped = reference::oldRowWise( data.frames[iEvent], data.truePede, data.trueNoise, data.status, nXPixel, 3.5, oldCorrection );
+		int const newSkipped = reference::newRowWise( data.frames[iEvent], data.truePede, data.trueNoise, data.status, nXPixel, 3.5, newCorrection );
+		if( iEvent == 0 ) {
+			EXPECT_GE( oldSkipped, 1 );
+		}
+		ASSERT_EQ( oldSkipped, newSkipped ) << "event " << iEvent;
+		for(int iPixel = 0; iPixel < nPixel; iPixel++) {
+			ASSERT_NEAR( oldCorrection[iPixel], newCorrection[iPixel], 1e-5 ) << "event " << iEvent << ", pixel " << iPixel;
+		}
+	}
+}
+
+/** The fixed weight update of EUTelUpdatePedestalNoiseProcessor, bad pixels are left alone.
+ */
+TEST_F(EUTelPixelAccumulatorTest, FixedWeight) {
+	std::vector<float> oldPede( data.truePede ), oldNoise( data.trueNoise ), newPede( data.truePede ), newNoise( data.trueNoise );
+	for(int iEvent = 0; iEvent < nEvents; iEvent++) {
+		reference::oldFixedWeight( data.frames[iEvent], data.status, 100, oldPede, oldNoise );
+		eutelescope::fixedWeightUpdate( nPixel, &data.frames[iEvent][0], &data.status[0], 100, &newPede[0], &newNoise[0] );
+	}
+	for(int iPixel = 0; iPixel < nPixel; iPixel++) {
+		ASSERT_NEAR( oldPede[iPixel], newPede[iPixel], 1e-3 ) << "pixel " << iPixel;
+		ASSERT_NEAR( oldNoise[iPixel], newNoise[iPixel], 1e-3 ) << "pixel " << iPixel;
+	}
+	EXPECT_EQ( data.truePede[0], newPede[0] );
+}
+
+/** calibrateAndSelect keeps the pixels the zero suppression of EUTelRawDataSparsifier keeps.
+ */
+TEST_F(EUTelPixelAccumulatorTest, CalibrateAndSelect) {
+	std::vector<float> corrected, oldSparse, newSparse, signal;
+	std::vector<unsigned int> selected;
+	size_t nSelected = 0;
+	for(int iEvent = 0; iEvent < nEvents; iEvent++) {
+		reference::oldCalibrateSparsify( data.frames[iEvent], data.truePede, data.trueNoise, data.status, nXPixel, 0.5, 3., corrected, oldSparse );
+		reference::newCalibrateSparsify( data.frames[iEvent], data.truePede, data.trueNoise, data.status, nXPixel, 0.5, 3., selected, signal, newSparse );
+		ASSERT_EQ( oldSparse, newSparse ) << "event " << iEvent;
+		nSelected += oldSparse.size() / 4;
+	}
+	EXPECT_GT( nSelected, 0u );
+}
+
+/** The exponential weight tracker follows a pedestal drifting by 10 ADC in 20000 events.
+ */
+TEST_F(EUTelPixelAccumulatorTest, PedestalTrackerDrift) {
+	int const nSmall = 200, nDriftEvents = 20000;
+	std::vector<float> pede( data.truePede.begin(), data.truePede.begin() + nSmall ), noise( data.trueNoise.begin(), data.trueNoise.begin() + nSmall );
+	std::vector<short> status( nSmall, 0 ), frame( nSmall );
+	EUTelPedestalTracker tracker;
+	tracker.start( nSmall, &pede[0], &noise[0], 100, 3.5 );
+	for(int iEvent = 0; iEvent < nDriftEvents; iEvent++) {
+		double const offset = 10. * iEvent / nDriftEvents;
+		for(int iPixel = 0; iPixel < nSmall; iPixel++) frame[iPixel] = reference::pixelSignal( pede[iPixel] + offset, noise[iPixel], 1000 );
+		tracker.update( &frame[0], &status[0] );
+	}
+	// the tracker lags by about weight events, i.e. 0.05 ADC here
+	EUTelPedestalDrift const drift = tracker.getDrift();
+	EXPECT_EQ( nDriftEvents, int(drift.noOfEvents) );
+	EXPECT_NEAR( 10., drift.meanShift, 0.2 );
+	EXPECT_NEAR( 1., drift.meanNoiseRatio, 0.05 );
+}
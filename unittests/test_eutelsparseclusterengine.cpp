@@ -0,0 +1,86 @@
+//STL
+#include <random>
+#include <vector>
+
+//GTest
+#include "gtest/gtest.h"
+
+//EUTelescope
+#include "EUTelSparseClusterEngine.h"
+
+//Reference
+#include "SparseClusterReference.h"
+
+using eutelescope::EUTelSparseClusterEngine;
+
+// Compares the grid based clustering of EUTelProcessorSparseClustering
+// with the original algorithm, cluster by cluster and pixel by pixel.
+class EUTelSparseClusterEngineTest : public ::testing::Test {
+protected:
+	EUTelSparseClusterEngineTest() : nXPixel(1152), nYPixel(576), minDistanceSquared(2) {}
+
+	virtual void SetUp() {
+		engine.setPixelIndexRange( 0, nXPixel - 1, 0, nYPixel - 1 );
+		engine.setMinDistanceSquared( minDistanceSquared );
+	}
+
+	reference::ClusterList cluster(std::vector<short> const& x, std::vector<short> const& y) {
+		size_t const n = engine.cluster( x.empty() ? 0 : &x[0], y.empty() ? 0 : &y[0], x.size() );
+		reference::ClusterList clusters;
+		for(size_t i = 0; i < n; i++) clusters.push_back( std::vector<int>( engine.clusterBegin( i ), engine.clusterEnd( i ) ) );
+		return clusters;
+	}
+
+	int const nXPixel;
+	int const nYPixel;
+	int const minDistanceSquared;
+	EUTelSparseClusterEngine engine;
+};
+
+/** Diagonal neighbours are joined, pixels two columns apart are not.
+ */
+TEST_F(EUTelSparseClusterEngineTest, Neighbours) {
+	std::vector<short> x = { 10, 11, 13, 100, 12 };
+	std::vector<short> y = { 10, 11, 11, 100, 13 };
+
+	reference::ClusterList clusters = cluster( x, y );
+	ASSERT_EQ( 4u, clusters.size() );
+	EXPECT_EQ( std::vector<int>({ 0, 1 }), clusters[0] );
+	EXPECT_EQ( reference::sparseClustering( x, y, minDistanceSquared ), clusters );
+}
+
+/** Pixels outside the announced index range enlarge the grid.
+ */
+TEST_F(EUTelSparseClusterEngineTest, OutsideRange) {
+	std::vector<short> x = { -3, -2, 2000, 2001, 0 };
+	std::vector<short> y = { 5, 6, 900, 900, 0 };
+
+	EXPECT_EQ( reference::sparseClustering( x, y, minDistanceSquared ), cluster( x, y ) );
+}
+
+/** Random frames, from a few pixels to a high occupancy.
+ */
+TEST_F(EUTelSparseClusterEngineTest, RandomFrames) {
+	std::mt19937 generator( 12345 );
+	int const occupancy[] = { 0, 1, 10, 100, 1000 };
+	for(size_t iOcc = 0; iOcc < sizeof(occupancy)/sizeof(occupancy[0]); iOcc++) {
+		for(int iFrame = 0; iFrame < 10; iFrame++) {
+			std::vector<short> x, y;
+			reference::generateSparseFrame( generator, nXPixel, nYPixel, occupancy[iOcc], x, y );
+			ASSERT_EQ( reference::sparseClustering( x, y, minDistanceSquared ), cluster( x, y ) )
+				<< occupancy[iOcc] << " pixels, frame " << iFrame;
+		}
+	}
+}
+
+/** A larger clustering distance joins the pixels two columns apart.
+ */
+TEST_F(EUTelSparseClusterEngineTest, LargerDistance) {
+	engine.setMinDistanceSquared( 4 );
+	std::mt19937 generator( 4711 );
+	for(int iFrame = 0; iFrame < 10; iFrame++) {
+		std::vector<short> x, y;
+		reference::generateSparseFrame( generator, 64, 64, 200, x, y );
+		ASSERT_EQ( reference::sparseClustering( x, y, 4 ), cluster( x, y ) ) << "frame " << iFrame;
+	}
+}
@@ -0,0 +1,83 @@
+//STL
+#include <random>
+#include <vector>
+
+//GTest
+#include "gtest/gtest.h"
+
+//EUTelescope
+#include "EUTelTripletSearch.h"
+
+//Reference
+#include "TripletReference.h"
+
+using eutelescope::EUTelTripletSearch;
+
+// The triplet seeded search of EUTelTripletTrackFinder on generated
+// telescope events, compared with the combinatorial search of EUTelMille.
+class EUTelTripletSearchTest : public ::testing::Test {
+protected:
+	EUTelTripletSearchTest() : generator(4711) {}
+
+	virtual void SetUp() {
+		search.setResolution( reference::resolution );
+		search.setScatteringAngle( reference::scattering );
+	}
+
+	std::vector< std::vector<int> > findTracks(reference::Event const& hits) {
+		search.search( hits );
+		std::vector< std::vector<int> > tracks;
+		for(size_t t = 0; t < search.getTracks().size(); t++) tracks.push_back( search.getTracks()[t].hits );
+		return tracks;
+	}
+
+	std::mt19937 generator;
+	EUTelTripletSearch search;
+};
+
+/** A single track with a hit on every plane is found with all its hits, the DUT included.
+ */
+TEST_F(EUTelTripletSearchTest, SingleTrack) {
+	reference::Event hits( reference::nPlanes );
+	for(int plane = 0; plane < reference::nPlanes; plane++) {
+		EUTelTripletSearch::Hit hit = { 1. + 1e-4*reference::planeZ[plane], -2. - 2e-4*reference::planeZ[plane], reference::planeZ[plane] };
+		hits[plane].push_back( hit );
+	}
+
+	std::vector< std::vector<int> > tracks = findTracks( hits );
+	ASSERT_EQ( 1u, tracks.size() );
+	EXPECT_EQ( std::vector<int>( reference::nPlanes, 0 ), tracks[0] );
+	EXPECT_EQ( reference::nPlanes, search.getTracks()[0].nHits );
+}
+
+/** Noise hits alone make no track.
+ */
+TEST_F(EUTelTripletSearchTest, NoiseOnly) {
+	for(int iEvent = 0; iEvent < 20; iEvent++) {
+		reference::GeneratedEvent event = reference::generateEvent( generator, 0 );
+		EXPECT_TRUE( findTracks( event.hits ).empty() ) << "event " << iEvent;
+	}
+}
+
+/** At least 95% of the findable tracks are found up to high multiplicities, and at
+ *  low multiplicities at least as many as by the combinatorial search.
+ */
+TEST_F(EUTelTripletSearchTest, Efficiency) {
+	int const multiplicities[] = { 1, 2, 4, 8, 32, 128 };
+	for(size_t m = 0; m < sizeof(multiplicities)/sizeof(int); m++) {
+		int const nTracks = multiplicities[m];
+		int const nEvents = nTracks > 8 ? 10 : 50;
+		int findable = 0, tripletFound = 0, bruteFound = 0;
+		for(int i = 0; i < nEvents; i++) {
+			reference::GeneratedEvent event = reference::generateEvent( generator, nTracks );
+			findable += reference::countFindable( event );
+			tripletFound += reference::countFound( event, findTracks( event.hits ) );
+			if( nTracks <= 4 ) bruteFound += reference::countFound( event, reference::bruteForce( event.hits ) );
+		}
+		ASSERT_GT( findable, 0 );
+		EXPECT_GE( double(tripletFound)/findable, 0.95 ) << nTracks << " tracks";
+		if( nTracks <= 4 ) {
+			EXPECT_GE( tripletFound, bruteFound ) << nTracks << " tracks";
+		}
+	}
+}